@@ -61,9 +61,20 @@ public:
 	static std::string get_default_html_sheet();
 
 	void add_default_html_sheet();
+
+	/// \brief Adds a style sheet
+	///
+	/// The sheet can be either CSS text or the output of compile_sheet.
 	void add_sheet(CSSSheetOrigin origin, const std::string &filename, const FileSystem &fs = FileSystem());
 	void add_sheet(CSSSheetOrigin origin, IODevice &iodevice, const std::string &base_uri);
 
+	/// \brief Compiles a CSS style sheet, including its imports, into a binary form
+	///
+	/// A compiled sheet contains the parsed selectors, the declarations as tokens and a prebuilt
+	/// selector index. Loading it with add_sheet skips tokenizing the CSS text and building the index.
+	static void compile_sheet(const std::string &filename, IODevice &output, const FileSystem &fs = FileSystem());
+	static void compile_sheet(IODevice &iodevice, const std::string &base_uri, IODevice &output);
+
 	CSSSelectResult select(const DomElement &node, const std::string &pseudo_element = std::string());
 	CSSSelectResult select(CSSSelectNode *node, const std::string &pseudo_element = std::string());
 
@@ -28,6 +28,10 @@
 
 #pragma once
 
+#include "../api_csslayout.h"
+#include <memory>
+#include <vector>
+
 namespace clan
 {
 /// \addtogroup clanCSSLayout_Document clanCSSLayout Document
@@ -36,7 +40,8 @@ namespace clan
 class CSSPropertyValue;
 class CSSStyleProperties_Impl;
 
-class CSSStyleProperties
+/// \brief Property values parsed from a CSS style attribute
+class CL_API_CSSLAYOUT CSSStyleProperties
 {
 public:
 	CSSStyleProperties();
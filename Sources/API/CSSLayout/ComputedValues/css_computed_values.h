@@ -54,6 +54,7 @@ class CSSStyleProperties;
 class CSSPropertyValue;
 class CSSComputedValues_Impl;
 class CSSResourceCache;
+class WorkQueue;
 
 class CL_API_CSSLAYOUT CSSComputedValues
 {
@@ -68,6 +69,14 @@ public:
 	void set_specified_values(const CSSSelectResult &selected_values, const std::string &style_values);
 	void set_specified_values(const CSSSelectResult &selected_values, const CSSStyleProperties &style_values);
 
+	/// \brief Computes the values of this node and all its descendants now rather than on first access
+	///
+	/// When a work queue is passed, the top of the tree is computed on the calling thread until there are
+	/// enough independent subtrees to keep the worker threads busy. The subtrees are then computed in parallel.
+	/// Siblings are always computed in document order by the same thread, so the result is identical to a
+	/// serial update.
+	void update_tree(WorkQueue *work_queue = 0);
+
 	const CSSComputedBox &get_box() const;
 	int get_box_generation() const;
 
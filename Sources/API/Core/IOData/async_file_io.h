@@ -0,0 +1,221 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "../api_core.h"
+#include "../Signals/callback_v1.h"
+#include "file.h"
+#include <vector>
+#include <memory>
+
+namespace clan
+{
+/// \addtogroup clanCore_I_O_Data clanCore I/O Data
+/// \{
+
+class AsyncFileIO_Impl;
+class AsyncFileOperation_Impl;
+
+/// \brief Description of a single asynchronous read or write.
+class CL_API_CORE AsyncFileRequest
+{
+public:
+	AsyncFileRequest() : offset(0), buffer(0), length(0) { }
+
+	AsyncFileRequest(const File &file, byte64 offset, void *buffer, int length)
+	: file(file), offset(offset), buffer(buffer), length(length) { }
+
+	/// \brief File to read from or write to
+	File file;
+
+	/// \brief Position in the file where the transfer starts
+	byte64 offset;
+
+	/// \brief Memory to read into or write from. It must stay valid until the operation has completed
+	void *buffer;
+
+	/// \brief Number of bytes to transfer
+	int length;
+};
+
+/// \brief Handle to a queued asynchronous file operation.
+///
+/// The handle can be polled or waited on like a future. The completion callback is invoked by
+/// the thread that created the AsyncFileIO object, when it calls KeepAlive::process() or AsyncFileIO::wait_all().
+class CL_API_CORE AsyncFileOperation
+{
+/// \name Construction
+/// \{
+
+public:
+	/// \brief Constructs a null instance.
+	AsyncFileOperation();
+
+	AsyncFileOperation(const std::shared_ptr<AsyncFileOperation_Impl> &impl);
+
+/// \}
+/// \name Attributes
+/// \{
+
+public:
+	/// \brief Returns true if this object is invalid.
+	bool is_null() const { return !impl; }
+
+	/// \brief Throw an exception if this object is invalid.
+	void throw_if_null() const;
+
+	/// \brief Returns the request this operation was created for.
+	const AsyncFileRequest &get_request() const;
+
+	/// \brief Returns true once the transfer has finished, successfully or not.
+	bool is_completed() const;
+
+	/// \brief Returns true if the transfer finished with an error.
+	bool is_failed() const;
+
+	/// \brief Returns the number of bytes transferred.
+	///
+	/// Waits for the transfer to finish. Short reads and writes are continued until the full
+	/// length is transferred, with every backend. Fewer bytes than requested are only returned
+	/// when a read reaches the end of the file. An error part way through fails the whole
+	/// operation. Throws an exception if the transfer failed.
+	int get_bytes_transferred() const;
+
+	/// \brief Returns the operating system error code, or 0 if the transfer succeeded or has not finished.
+	int get_error_code() const;
+
+/// \}
+/// \name Operations
+/// \{
+
+public:
+	/// \brief Blocks until the transfer has finished.
+	///
+	/// This does not invoke the completion callback.
+	void wait() const;
+
+	/// \brief Callback invoked on the owning thread when the transfer has finished.
+	Callback_v1<AsyncFileOperation &> &func_completed();
+
+/// \}
+/// \name Implementation
+/// \{
+
+private:
+	std::shared_ptr<AsyncFileOperation_Impl> impl;
+/// \}
+};
+
+/// \brief Asynchronous file I/O engine.
+///
+/// Reads and writes at explicit file offsets without blocking the calling thread. Operations are
+/// collected until submit() is called, so a batch of requests reaches the operating system together.
+/// Up to get_queue_depth() operations are in flight at a time, also when they target the same file.
+///
+/// On Linux the io_uring interface of the kernel is used when available. Other platforms, and kernels
+/// without io_uring, use a pool of worker threads doing positional reads and writes.
+///
+/// The files must be opened with File. Do not use the read, write or seek functions of a File
+/// while it has operations in flight, as the thread pool backend can move its file position on Windows.
+class CL_API_CORE AsyncFileIO
+{
+/// \name Construction
+/// \{
+
+public:
+	enum Backend
+	{
+		backend_auto,
+		backend_io_uring,
+		backend_thread_pool
+	};
+
+	/// \brief Constructs an asynchronous I/O engine.
+	///
+	/// \param queue_depth = Maximum number of operations in flight. For the thread pool backend this is the number of worker threads
+	/// \param backend = Backend to use. backend_auto picks io_uring when the kernel supports it. Requesting io_uring explicitly throws an exception if it is not available
+	AsyncFileIO(int queue_depth = 32, Backend backend = backend_auto);
+
+	/// \brief Destroys the engine when the last copy goes away.
+	///
+	/// Waits for the operations in flight. Operations not started yet fail with a cancelled error code (ECANCELED, or ERROR_OPERATION_ABORTED on Windows).
+	~AsyncFileIO();
+
+/// \}
+/// \name Attributes
+/// \{
+
+public:
+	/// \brief Returns the backend in use.
+	Backend get_backend() const;
+
+	/// \brief Returns the maximum number of operations in flight.
+	int get_queue_depth() const;
+
+	/// \brief Returns the number of operations queued or in flight, whose completion has not been processed yet.
+	int get_pending_count() const;
+
+/// \}
+/// \name Operations
+/// \{
+
+public:
+	/// \brief Queues a read. The read starts when submit() is called.
+	AsyncFileOperation read(const File &file, byte64 offset, void *buffer, int length);
+
+	/// \brief Queues a write. The write starts when submit() is called.
+	AsyncFileOperation write(const File &file, byte64 offset, const void *buffer, int length);
+
+	/// \brief Queues and submits a batch of reads.
+	std::vector<AsyncFileOperation> read(const std::vector<AsyncFileRequest> &requests);
+
+	/// \brief Starts all queued operations.
+	void submit();
+
+	/// \brief Submits queued operations, blocks until all operations have finished and invokes their completion callbacks.
+	void wait_all();
+
+	/// \brief Invokes the completion callbacks of finished operations.
+	///
+	/// KeepAlive::process() does this automatically on the thread that created the engine.
+	void process();
+
+/// \}
+/// \name Implementation
+/// \{
+
+private:
+	std::shared_ptr<AsyncFileIO_Impl> impl;
+/// \}
+};
+
+}
+
+/// \}
@@ -110,12 +110,21 @@ public:
 	};
 
 	/// \brief Optimization Flags.
+	///
+	/// flag_random_access and flag_sequential_scan are passed on to the operating
+	/// system as access pattern hints. Memory mapped files use them with madvise.
 	enum Flags
 	{
 		flag_write_through   = 1,
 		flag_no_buffering    = 2,
 		flag_random_access   = 4,
-		flag_sequential_scan = 8
+		flag_sequential_scan = 8,
+
+		/// \brief Map the file into memory and serve reads from the mapping.
+		///
+		/// Only used for files opened with access_read. If the file cannot be
+		/// mapped it is read normally.
+		flag_memory_mapped   = 16
 	};
 
 /// \}
@@ -149,6 +158,12 @@ public:
 /// \{
 
 public:
+	/// \brief Returns the contents of a memory mapped file.
+	///
+	/// Gives direct access to the data without copying it. Returns null if the
+	/// file is not memory mapped or is empty. The pointer is valid until the file
+	/// is closed, and get_size() returns the length of the data.
+	const char *get_mapped_data() const;
 
 /// \}
 /// \name Operations
@@ -96,12 +96,12 @@ public:
 	/// \brief Returns the size of data stream.
 	/** <p>Returns -1 if the size is unknown.</p>
 	    \return The size (-1 if size is unknown)*/
-	int get_size() const;
+	byte64 get_size() const;
 
 	/// \brief Returns the position in the data stream.
 	/** <p>Returns -1 if the position is unknown.</p>
 	    \return The size (-1 if position is unknown)*/
-	int get_position() const;
+	byte64 get_position() const;
 
 	/// \brief Returns true if the input source is in little endian mode.
 	/** \return true if little endian*/
@@ -147,7 +147,7 @@ public:
 	/// \param position Position to use (usage depends on the seek mode)
 	/// \param mode Seek mode
 	/// \return false = Failed
-	bool seek(int position, SeekMode mode = seek_set);
+	bool seek(byte64 position, SeekMode mode = seek_set);
 
 	/// \brief Alias for receive(data, len, receive_all)
 	///
@@ -223,6 +223,32 @@ public:
 	/// Warning, this is not portable.
 	void write_float(float data);
 
+	/// \brief Writes an array of unsigned 16 bit integers to output source.
+	///
+	/// \param data Integers to write
+	/// \param count Number of integers
+	void write_uint16_array(const ubyte16 *data, int count);
+
+	/// \brief Writes an array of unsigned 32 bit integers to output source.
+	///
+	/// \param data Integers to write
+	/// \param count Number of integers
+	void write_uint32_array(const ubyte32 *data, int count);
+
+	/// \brief Writes an array of unsigned 64 bit integers to output source.
+	///
+	/// \param data Integers to write
+	/// \param count Number of integers
+	void write_uint64_array(const ubyte64 *data, int count);
+
+	/// \brief Writes an array of floats to output source.
+	///
+	/// \param data Floats to write
+	/// \param count Number of floats
+	///
+	/// Warning, this is not portable.
+	void write_float_array(const float *data, int count);
+
 	/// \brief  Writes a string to the output source.
 	///
 	/// \param str String to write
@@ -284,6 +310,34 @@ public:
 	    \return The float read.*/
 	float read_float();
 
+	/// \brief Reads an array of unsigned 16 bit integers from input source.
+	///
+	/// The whole array is read with a single call to the device.
+	/// \param data Array receiving the integers
+	/// \param count Number of integers to read
+	void read_uint16_array(ubyte16 *data, int count);
+
+	/// \brief Reads an array of unsigned 32 bit integers from input source.
+	///
+	/// The whole array is read with a single call to the device.
+	/// \param data Array receiving the integers
+	/// \param count Number of integers to read
+	void read_uint32_array(ubyte32 *data, int count);
+
+	/// \brief Reads an array of unsigned 64 bit integers from input source.
+	///
+	/// The whole array is read with a single call to the device.
+	/// \param data Array receiving the integers
+	/// \param count Number of integers to read
+	void read_uint64_array(ubyte64 *data, int count);
+
+	/// \brief Reads an array of floats from input source.
+	///
+	/// Warning, this is not portable.
+	/// \param data Array receiving the floats
+	/// \param count Number of floats to read
+	void read_float_array(float *data, int count);
+
 	/// \brief Reads a string from the input source.
 	/** <p>The binary format expected in the input source is first an uint32 telling the length of the
 	    string, and then the string itself.</p>
@@ -316,6 +370,9 @@ public:
 
 protected:
 	std::shared_ptr<IODevice_Impl> impl;
+
+private:
+	void write_array(const void *data, int element_size, int count);
 /// \}
 };
 
@@ -0,0 +1,89 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "../api_core.h"
+#include "iodevice.h"
+
+namespace clan
+{
+/// \addtogroup clanCore_I_O_Data clanCore I/O Data
+/// \{
+
+/// \brief Buffered I/O device.
+///
+/// Wraps another device, reading ahead and collecting written data in buffers so that
+/// small reads and writes, such as read_uint32(), do not each reach the underlying device.
+///
+/// Reading ahead moves the position of the wrapped device past the data returned so far.
+/// Use the position of the buffered device instead, and call flush() before using the
+/// wrapped device directly.
+class CL_API_CORE IODevice_Buffered : public IODevice
+{
+/// \name Construction
+/// \{
+
+public:
+	/// \brief Constructs a buffered I/O device.
+	///
+	/// \param device = Device to read from and write to
+	/// \param read_buffer_size = Amount of data read ahead from the device. 0 disables read buffering
+	/// \param write_buffer_size = Amount of written data collected before it is sent to the device. 0 disables write buffering
+	IODevice_Buffered(IODevice &device, int read_buffer_size = 64*1024, int write_buffer_size = 64*1024);
+
+/// \}
+/// \name Attributes
+/// \{
+
+public:
+	/// \brief Returns the wrapped device.
+	IODevice get_device() const;
+
+/// \}
+/// \name Operations
+/// \{
+
+public:
+	/// \brief Sends buffered written data to the wrapped device.
+	///
+	/// This also happens when the buffered device is seeked, read from or destroyed.
+	void flush();
+
+/// \}
+/// \name Implementation
+/// \{
+
+private:
+/// \}
+};
+
+}
+
+/// \}
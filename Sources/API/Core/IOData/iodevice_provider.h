@@ -53,11 +53,11 @@ public:
 public:
 	/// \brief Returns the size of data stream.
 	/** <p>Returns -1 if the size is unknown.</p>*/
-	virtual int get_size() const { return -1; }
+	virtual byte64 get_size() const { return -1; }
 
 	/// \brief Returns the position in the data stream.
 	/** <p>Returns -1 if the position is unknown.</p>*/
-	virtual int get_position() const { return -1; }
+	virtual byte64 get_position() const { return -1; }
 
 /// \}
 /// \name Operations
@@ -77,7 +77,7 @@ public:
 	virtual IODeviceProvider *duplicate() = 0;
 
 	/// \brief Seek in data stream.
-	virtual bool seek(int /*position*/, IODevice::SeekMode /*mode*/) { return false; }
+	virtual bool seek(byte64 /*position*/, IODevice::SeekMode /*mode*/) { return false; }
 
 /// \}
 /// \name Implementation
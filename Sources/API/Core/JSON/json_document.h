@@ -0,0 +1,163 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "json_value.h"
+#include <memory>
+#include <string>
+
+namespace clan
+{
+/// \addtogroup clanCore_JSON clanCore JSON
+/// \{
+
+class IODevice;
+class JsonDocument;
+class JsonDocument_Impl;
+struct JsonDocumentNode;
+
+/// \brief Read-only handle to a value in a JsonDocument
+///
+/// Nodes are only valid while the document they came from exists and has not been reloaded.
+class JsonNode
+{
+/// \name Construction
+/// \{
+public:
+	/// \brief Constructs a null node
+	JsonNode() : doc(0), node(0) { }
+/// \}
+
+/// \name Attributes
+/// \{
+public:
+	/// \brief Get value type
+	JsonValue::Type get_type() const;
+
+	/// \brief Get number of object members, array items or string bytes
+	size_t get_size() const;
+
+	bool is_null() const { return get_type() == JsonValue::type_null; }
+	bool is_object() const { return get_type() == JsonValue::type_object; }
+	bool is_array() const { return get_type() == JsonValue::type_array; }
+	bool is_string() const { return get_type() == JsonValue::type_string; }
+	bool is_number() const { return get_type() == JsonValue::type_number; }
+	bool is_boolean() const { return get_type() == JsonValue::type_boolean; }
+
+	/// \brief Convert value to a different type
+	///
+	/// Throws JsonException if the node is of a different type.
+	std::string to_string() const;
+	int to_int() const;
+	float to_float() const;
+	double to_double() const;
+	bool to_boolean() const;
+
+	/// \brief Returns an array item, or the value of an object member, by index
+	JsonNode get_item(size_t index) const;
+
+	/// \brief Returns the name of an object member by index
+	std::string get_key(size_t index) const;
+
+	/// \brief Returns the value of an object member
+	///
+	/// Members keep the order they had in the JSON. Returns a null node if the member does not exist.
+	/// When a name appears more than once the last member wins.
+	JsonNode get_member(const std::string &key) const;
+
+	JsonNode operator[](const char *key) const { return get_member(key); }
+	JsonNode operator[](const std::string &key) const { return get_member(key); }
+	JsonNode operator[](int index) const { return get_item(index); }
+
+	/// \brief Copies the node and its children into a JsonValue
+	JsonValue to_value() const;
+/// \}
+
+/// \name Implementation
+/// \{
+private:
+	JsonNode(const JsonDocument_Impl *doc, const JsonDocumentNode *node) : doc(doc), node(node) { }
+	const JsonDocumentNode *get_children() const;
+
+	const JsonDocument_Impl *doc;
+	const JsonDocumentNode *node;
+
+	friend class JsonDocument;
+	friend class JsonDocument_Impl;
+/// \}
+};
+
+/// \brief Read-only JSON document
+///
+/// Stores a parsed JSON file compactly: every value is a small fixed-size record,
+/// children of an object or array are stored next to each other, and strings are
+/// kept in large shared blocks. Uses much less memory than a JsonValue tree.
+class JsonDocument
+{
+/// \name Construction
+/// \{
+public:
+	/// \brief Constructs an empty document
+	JsonDocument();
+
+	/// \brief Constructs a document from UTF-8 JSON read from a device
+	JsonDocument(IODevice &input);
+
+	~JsonDocument();
+/// \}
+
+/// \name Attributes
+/// \{
+public:
+	/// \brief Returns the top level value
+	JsonNode get_root() const;
+/// \}
+
+/// \name Operations
+/// \{
+public:
+	/// \brief Replaces the document with UTF-8 JSON read from a device
+	void load(IODevice &input);
+
+	/// \brief Writes the document as UTF-8 JSON
+	void save(IODevice &output) const;
+
+	/// \brief Copies the document into a JsonValue
+	JsonValue to_value() const;
+/// \}
+
+/// \name Implementation
+/// \{
+private:
+	std::shared_ptr<JsonDocument_Impl> impl;
+/// \}
+};
+
+/// \}
+}
@@ -0,0 +1,130 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace clan
+{
+/// \addtogroup clanCore_JSON clanCore JSON
+/// \{
+
+class IODevice;
+class JsonReader_Impl;
+
+/// \brief Streaming JSON reader.
+///
+/// Reads JSON from an IODevice as a sequence of events, without building a tree.
+/// Only a small buffer and the current string are kept in memory, so files of any
+/// size can be processed.
+class JsonReader
+{
+public:
+	/// \brief Reader events
+	enum Event
+	{
+		event_end,
+		event_begin_object,
+		event_end_object,
+		event_begin_array,
+		event_end_array,
+		event_key,
+		event_string,
+		event_number,
+		event_boolean,
+		event_null
+	};
+
+/// \name Construction
+/// \{
+public:
+	/// \brief Constructs a JSON reader
+	///
+	/// \param input = Device to read UTF-8 JSON from
+	/// \param buffer_size = Size of the chunks read from the device
+	JsonReader(IODevice &input, int buffer_size = 64*1024);
+
+	~JsonReader();
+/// \}
+
+/// \name Attributes
+/// \{
+public:
+	/// \brief Returns the last event returned by next()
+	Event get_event() const;
+
+	/// \brief Returns the member name for event_key, or the value for event_string
+	///
+	/// The string is reused by the next call to next().
+	const std::string &get_string() const;
+
+	/// \brief Returns the value for event_number
+	double get_number() const;
+
+	/// \brief Returns the value for event_boolean
+	bool get_boolean() const;
+
+	/// \brief Returns the number of objects and arrays the reader is currently inside
+	int get_depth() const;
+/// \}
+
+/// \name Operations
+/// \{
+public:
+	/// \brief Reads the next event
+	///
+	/// Returns event_end after the top level value has been read.
+	/// Throws JsonException if the input is not valid JSON.
+	Event next();
+
+	/// \brief Skips the rest of the object or array that was just begun
+	///
+	/// Does nothing if the last event was not event_begin_object or event_begin_array.
+	void skip();
+
+	/// \brief Parses a JSON number
+	///
+	/// Uses a fast exact path for common numbers and does not depend on the C locale.
+	/// \return false if the text is not a valid JSON number
+	static bool parse_number(const char *text, std::string::size_type length, double &out_value);
+/// \}
+
+/// \name Implementation
+/// \{
+private:
+	JsonReader(const JsonReader &);
+	JsonReader &operator=(const JsonReader &);
+
+	std::shared_ptr<JsonReader_Impl> impl;
+/// \}
+};
+
+/// \}
+}
@@ -36,6 +36,10 @@ namespace clan
 /// \addtogroup clanCore_JSON clanCore JSON
 /// \{
 
+class IODevice;
+class JsonReader;
+class JsonWriter;
+
 /// \brief Exception class thrown for JSON exceptions.
 class JsonException : public Exception
 {
@@ -83,6 +87,9 @@ public:
 	/// \brief Create a value from UTF-8 JSON string
 	static JsonValue from_json(const std::string &json);
 
+	/// \brief Create a value from UTF-8 JSON read from a device
+	static JsonValue from_json(IODevice &input);
+
 	/// \brief Constructs a value
 	JsonValue() : type(type_null), value_number(), value_boolean() { }
 	JsonValue(Type type) : type(type), value_number(), value_boolean() { }
@@ -204,24 +211,16 @@ public:
 	/// \brief Create an UTF-8 JSON string for the value
 	std::string to_json() const;
 	void to_json(std::string &result) const;
+
+	/// \brief Write the value as UTF-8 JSON to a device
+	void to_json(IODevice &output) const;
 /// \}
 
 /// \name Implementation
 /// \{
 private:
-	void write(std::string &json) const;
-	void write_array(std::string &json) const;
-	void write_object(std::string &json) const;
-	static void write_string(const std::string &str, std::string &json);
-	void write_number(std::string &json) const;
-
-	static JsonValue read(const std::string &json, size_t &pos);
-	static JsonValue read_object(const std::string &json, size_t &pos);
-	static JsonValue read_array(const std::string &json, size_t &pos);
-	static std::string read_string(const std::string &json, size_t &pos);
-	static JsonValue read_number(const std::string &json, size_t &pos);
-	static JsonValue read_boolean(const std::string &json, size_t &pos);
-	static void read_whitespace(const std::string &json, size_t &pos);
+	void write(JsonWriter &writer) const;
+	static void read(JsonReader &reader, JsonValue &out_value);
 
 	Type type;
 	std::map<std::string, JsonValue> members;
@@ -0,0 +1,108 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace clan
+{
+/// \addtogroup clanCore_JSON clanCore JSON
+/// \{
+
+class IODevice;
+class JsonWriter_Impl;
+
+/// \brief Streaming JSON writer.
+///
+/// Writes JSON as a sequence of calls, either to an IODevice through a buffer of
+/// a fixed size or appended to a string. Commas are inserted automatically and
+/// strings are escaped.
+class JsonWriter
+{
+/// \name Construction
+/// \{
+public:
+	/// \brief Constructs a writer that sends the JSON to a device
+	///
+	/// \param output = Device to write UTF-8 JSON to
+	/// \param buffer_size = Amount of JSON collected before it is written to the device
+	JsonWriter(IODevice &output, int buffer_size = 64*1024);
+
+	/// \brief Constructs a writer that appends the JSON to a string
+	JsonWriter(std::string &output);
+
+	/// \brief Flushes any buffered output
+	~JsonWriter();
+/// \}
+
+/// \name Operations
+/// \{
+public:
+	void begin_object();
+	void end_object();
+	void begin_array();
+	void end_array();
+
+	/// \brief Writes the name of the next object member
+	void write_key(const std::string &key);
+	void write_key(const char *key, std::string::size_type length);
+
+	void write_string(const std::string &value);
+	void write_string(const char *value, std::string::size_type length);
+	void write_number(int value);
+	void write_number(double value);
+	void write_boolean(bool value);
+	void write_null();
+
+	/// \brief Writes buffered output to the device
+	void flush();
+
+	/// \brief Appends a number in JSON notation, independent of the C locale
+	///
+	/// Integers are written without decimals. Other values use the shortest
+	/// text that reads back as the same double.
+	static void format_number(double value, std::string &out_json);
+
+	/// \brief Appends a quoted and escaped JSON string
+	static void format_string(const char *value, std::string::size_type length, std::string &out_json);
+/// \}
+
+/// \name Implementation
+/// \{
+private:
+	JsonWriter(const JsonWriter &);
+	JsonWriter &operator=(const JsonWriter &);
+
+	std::shared_ptr<JsonWriter_Impl> impl;
+/// \}
+};
+
+/// \}
+}
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "../System/exception.h"
+#include "callback_storage.h"
 #include <memory>
 
 namespace clan
@@ -157,82 +158,110 @@ class Callback_0
 {
 public:
 	Callback_0()
+	: invoke_func(0)
 	{
 	}
 
 	Callback_0(const Callback_0 &copy)
-	: impl(copy.impl)
+	: storage(copy.storage), invoke_func(copy.invoke_func)
 	{
 	}
 
 	Callback_0(Callback_Impl_0<RetVal> *impl)
-	: impl(impl)
+	: invoke_func(0)
 	{
+		storage.set(std::shared_ptr< Callback_Impl_0<RetVal> >(impl));
+		invoke_func = &invoke_shared;
 	}
 
 	Callback_0(RetVal (*function)())
-	: impl(new Callback_Impl_0_static<RetVal>(function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_0_static<RetVal>(function));
 	}
 
 	template<typename UserData>
 	Callback_0(RetVal (*function)(UserData), const UserData &user_data)
-	: impl(new Callback_Impl_0_static_user<RetVal, UserData>(function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_0_static_user<RetVal, UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	Callback_0(InstanceClass *instance, RetVal (InstanceClass::*function)())
-	: impl(new Callback_Impl_0_member<RetVal, InstanceClass>(instance, function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_0_member<RetVal, InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	Callback_0(InstanceClass *instance, RetVal (InstanceClass::*function)(UserData), const UserData &user_data)
-	: impl(new Callback_Impl_0_member_user<RetVal, InstanceClass, UserData>(instance, function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_0_member_user<RetVal, InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void set(RetVal (*function)())
 	{
-		impl = std::shared_ptr< Callback_Impl_0<RetVal> >(new Callback_Impl_0_static<RetVal>(function));
+		set_impl(Callback_Impl_0_static<RetVal>(function));
 	}
 
 	template<typename UserData>
 	void set(RetVal (*function)(UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_0<RetVal> >(new Callback_Impl_0_static_user<RetVal, UserData>(function, user_data));
+		set_impl(Callback_Impl_0_static_user<RetVal, UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	void set(InstanceClass *instance, RetVal (InstanceClass::*function)())
 	{
-		impl = std::shared_ptr< Callback_Impl_0<RetVal> >(new Callback_Impl_0_member<RetVal, InstanceClass>(instance, function));
+		set_impl(Callback_Impl_0_member<RetVal, InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	void set(InstanceClass *instance, RetVal (InstanceClass::*function)(UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_0<RetVal> >(new Callback_Impl_0_member_user<RetVal, InstanceClass, UserData>(instance, function, user_data));
+		set_impl(Callback_Impl_0_member_user<RetVal, InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void clear()
 	{
-		impl = std::shared_ptr< Callback_Impl_0<RetVal> >();
+		storage.clear();
+		invoke_func = 0;
 	}
 
 	RetVal invoke() const
 	{
-		return impl->invoke();
+		return invoke_func(storage);
 	}
 
 	bool is_null() const
 	{
-		return !impl;
+		return invoke_func == 0;
+	}
+
+protected:
+	template<class Impl>
+	void set_impl(const Impl &impl)
+	{
+		storage.set(impl);
+		invoke_func = &invoke_impl<Impl>;
 	}
 
 private:
-	std::shared_ptr< Callback_Impl_0<RetVal> > impl;
+	template<class Impl>
+	static RetVal invoke_impl(const CallbackStorage &storage)
+	{
+		return storage.get<Impl>()->Impl::invoke();
+	}
+
+	static RetVal invoke_shared(const CallbackStorage &storage)
+	{
+		return (*storage.get< std::shared_ptr< Callback_Impl_0<RetVal> > >())->invoke();
+	}
+
+	CallbackStorage storage;
+	RetVal (*invoke_func)(const CallbackStorage &storage);
 };
 
 /// \brief Callback_0_functor
@@ -252,8 +281,8 @@ public:
 
 	template<class Functor>
 	Callback_0_functor(Functor functor)
-	: Callback_0<RetVal>(new Callback_Impl_0_functor<RetVal, Functor>(functor))
 	{
+		this->set_impl(Callback_Impl_0_functor<RetVal, Functor>(functor));
 	}
 
 };
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "../System/exception.h"
+#include "callback_storage.h"
 #include <memory>
 
 namespace clan
@@ -157,82 +158,110 @@ class Callback_1
 {
 public:
 	Callback_1()
+	: invoke_func(0)
 	{
 	}
 
 	Callback_1(const Callback_1 &copy)
-	: impl(copy.impl)
+	: storage(copy.storage), invoke_func(copy.invoke_func)
 	{
 	}
 
 	Callback_1(Callback_Impl_1<RetVal, P1> *impl)
-	: impl(impl)
+	: invoke_func(0)
 	{
+		storage.set(std::shared_ptr< Callback_Impl_1<RetVal, P1> >(impl));
+		invoke_func = &invoke_shared;
 	}
 
 	Callback_1(RetVal (*function)(P1))
-	: impl(new Callback_Impl_1_static<RetVal, P1>(function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_1_static<RetVal, P1>(function));
 	}
 
 	template<typename UserData>
 	Callback_1(RetVal (*function)(P1, UserData), const UserData &user_data)
-	: impl(new Callback_Impl_1_static_user<RetVal, P1, UserData>(function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_1_static_user<RetVal, P1, UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	Callback_1(InstanceClass *instance, RetVal (InstanceClass::*function)(P1))
-	: impl(new Callback_Impl_1_member<RetVal, P1, InstanceClass>(instance, function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_1_member<RetVal, P1, InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	Callback_1(InstanceClass *instance, RetVal (InstanceClass::*function)(P1, UserData), const UserData &user_data)
-	: impl(new Callback_Impl_1_member_user<RetVal, P1, InstanceClass, UserData>(instance, function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_1_member_user<RetVal, P1, InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void set(RetVal (*function)(P1))
 	{
-		impl = std::shared_ptr< Callback_Impl_1<RetVal, P1> >(new Callback_Impl_1_static<RetVal, P1>(function));
+		set_impl(Callback_Impl_1_static<RetVal, P1>(function));
 	}
 
 	template<typename UserData>
 	void set(RetVal (*function)(P1, UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_1<RetVal, P1> >(new Callback_Impl_1_static_user<RetVal, P1, UserData>(function, user_data));
+		set_impl(Callback_Impl_1_static_user<RetVal, P1, UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	void set(InstanceClass *instance, RetVal (InstanceClass::*function)(P1))
 	{
-		impl = std::shared_ptr< Callback_Impl_1<RetVal, P1> >(new Callback_Impl_1_member<RetVal, P1, InstanceClass>(instance, function));
+		set_impl(Callback_Impl_1_member<RetVal, P1, InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	void set(InstanceClass *instance, RetVal (InstanceClass::*function)(P1, UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_1<RetVal, P1> >(new Callback_Impl_1_member_user<RetVal, P1, InstanceClass, UserData>(instance, function, user_data));
+		set_impl(Callback_Impl_1_member_user<RetVal, P1, InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void clear()
 	{
-		impl = std::shared_ptr< Callback_Impl_1<RetVal, P1> >();
+		storage.clear();
+		invoke_func = 0;
 	}
 
 	RetVal invoke(P1 p1) const
 	{
-		return impl->invoke(p1);
+		return invoke_func(storage, p1);
 	}
 
 	bool is_null() const
 	{
-		return !impl;
+		return invoke_func == 0;
+	}
+
+protected:
+	template<class Impl>
+	void set_impl(const Impl &impl)
+	{
+		storage.set(impl);
+		invoke_func = &invoke_impl<Impl>;
 	}
 
 private:
-	std::shared_ptr< Callback_Impl_1<RetVal, P1> > impl;
+	template<class Impl>
+	static RetVal invoke_impl(const CallbackStorage &storage, P1 p1)
+	{
+		return storage.get<Impl>()->Impl::invoke(p1);
+	}
+
+	static RetVal invoke_shared(const CallbackStorage &storage, P1 p1)
+	{
+		return (*storage.get< std::shared_ptr< Callback_Impl_1<RetVal, P1> > >())->invoke(p1);
+	}
+
+	CallbackStorage storage;
+	RetVal (*invoke_func)(const CallbackStorage &storage, P1 p1);
 };
 
 /// \brief Callback_1_functor
@@ -252,8 +281,8 @@ public:
 
 	template<class Functor>
 	Callback_1_functor(Functor functor)
-	: Callback_1<RetVal, P1>(new Callback_Impl_1_functor<RetVal, P1, Functor>(functor))
 	{
+		this->set_impl(Callback_Impl_1_functor<RetVal, P1, Functor>(functor));
 	}
 
 };
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "../System/exception.h"
+#include "callback_storage.h"
 #include <memory>
 
 namespace clan
@@ -157,82 +158,110 @@ class Callback_4
 {
 public:
 	Callback_4()
+	: invoke_func(0)
 	{
 	}
 
 	Callback_4(const Callback_4 &copy)
-	: impl(copy.impl)
+	: storage(copy.storage), invoke_func(copy.invoke_func)
 	{
 	}
 
 	Callback_4(Callback_Impl_4<RetVal, P1, P2, P3, P4> *impl)
-	: impl(impl)
+	: invoke_func(0)
 	{
+		storage.set(std::shared_ptr< Callback_Impl_4<RetVal, P1, P2, P3, P4> >(impl));
+		invoke_func = &invoke_shared;
 	}
 
 	Callback_4(RetVal (*function)(P1, P2, P3, P4))
-	: impl(new Callback_Impl_4_static<RetVal, P1, P2, P3, P4>(function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_4_static<RetVal, P1, P2, P3, P4>(function));
 	}
 
 	template<typename UserData>
 	Callback_4(RetVal (*function)(P1, P2, P3, P4, UserData), const UserData &user_data)
-	: impl(new Callback_Impl_4_static_user<RetVal, P1, P2, P3, P4, UserData>(function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_4_static_user<RetVal, P1, P2, P3, P4, UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	Callback_4(InstanceClass *instance, RetVal (InstanceClass::*function)(P1, P2, P3, P4))
-	: impl(new Callback_Impl_4_member<RetVal, P1, P2, P3, P4, InstanceClass>(instance, function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_4_member<RetVal, P1, P2, P3, P4, InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	Callback_4(InstanceClass *instance, RetVal (InstanceClass::*function)(P1, P2, P3, P4, UserData), const UserData &user_data)
-	: impl(new Callback_Impl_4_member_user<RetVal, P1, P2, P3, P4, InstanceClass, UserData>(instance, function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_4_member_user<RetVal, P1, P2, P3, P4, InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void set(RetVal (*function)(P1, P2, P3, P4))
 	{
-		impl = std::shared_ptr< Callback_Impl_4<RetVal, P1, P2, P3, P4> >(new Callback_Impl_4_static<RetVal, P1, P2, P3, P4>(function));
+		set_impl(Callback_Impl_4_static<RetVal, P1, P2, P3, P4>(function));
 	}
 
 	template<typename UserData>
 	void set(RetVal (*function)(P1, P2, P3, P4, UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_4<RetVal, P1, P2, P3, P4> >(new Callback_Impl_4_static_user<RetVal, P1, P2, P3, P4, UserData>(function, user_data));
+		set_impl(Callback_Impl_4_static_user<RetVal, P1, P2, P3, P4, UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	void set(InstanceClass *instance, RetVal (InstanceClass::*function)(P1, P2, P3, P4))
 	{
-		impl = std::shared_ptr< Callback_Impl_4<RetVal, P1, P2, P3, P4> >(new Callback_Impl_4_member<RetVal, P1, P2, P3, P4, InstanceClass>(instance, function));
+		set_impl(Callback_Impl_4_member<RetVal, P1, P2, P3, P4, InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	void set(InstanceClass *instance, RetVal (InstanceClass::*function)(P1, P2, P3, P4, UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_4<RetVal, P1, P2, P3, P4> >(new Callback_Impl_4_member_user<RetVal, P1, P2, P3, P4, InstanceClass, UserData>(instance, function, user_data));
+		set_impl(Callback_Impl_4_member_user<RetVal, P1, P2, P3, P4, InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void clear()
 	{
-		impl = std::shared_ptr< Callback_Impl_4<RetVal, P1, P2, P3, P4> >();
+		storage.clear();
+		invoke_func = 0;
 	}
 
 	RetVal invoke(P1 p1, P2 p2, P3 p3, P4 p4) const
 	{
-		return impl->invoke(p1, p2, p3, p4);
+		return invoke_func(storage, p1, p2, p3, p4);
 	}
 
 	bool is_null() const
 	{
-		return !impl;
+		return invoke_func == 0;
+	}
+
+protected:
+	template<class Impl>
+	void set_impl(const Impl &impl)
+	{
+		storage.set(impl);
+		invoke_func = &invoke_impl<Impl>;
 	}
 
 private:
-	std::shared_ptr< Callback_Impl_4<RetVal, P1, P2, P3, P4> > impl;
+	template<class Impl>
+	static RetVal invoke_impl(const CallbackStorage &storage, P1 p1, P2 p2, P3 p3, P4 p4)
+	{
+		return storage.get<Impl>()->Impl::invoke(p1, p2, p3, p4);
+	}
+
+	static RetVal invoke_shared(const CallbackStorage &storage, P1 p1, P2 p2, P3 p3, P4 p4)
+	{
+		return (*storage.get< std::shared_ptr< Callback_Impl_4<RetVal, P1, P2, P3, P4> > >())->invoke(p1, p2, p3, p4);
+	}
+
+	CallbackStorage storage;
+	RetVal (*invoke_func)(const CallbackStorage &storage, P1 p1, P2 p2, P3 p3, P4 p4);
 };
 
 /// \brief Callback_4_functor
@@ -252,8 +281,8 @@ public:
 
 	template<class Functor>
 	Callback_4_functor(Functor functor)
-	: Callback_4<RetVal, P1, P2, P3, P4>(new Callback_Impl_4_functor<RetVal, P1, P2, P3, P4, Functor>(functor))
 	{
+		this->set_impl(Callback_Impl_4_functor<RetVal, P1, P2, P3, P4, Functor>(functor));
 	}
 
 };
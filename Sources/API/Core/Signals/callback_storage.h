@@ -0,0 +1,160 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <new>
+#include <type_traits>
+
+namespace clan
+{
+/// \addtogroup clanCore_Signals clanCore Signals
+/// \{
+
+/// (Internal ClanLib Class)
+///
+/// Holds the function object of a callback. Objects up to four pointers in size are stored
+/// inside the CallbackStorage itself, larger ones are allocated on the heap. Copies of the
+/// storage copy the function object.
+class CallbackStorage
+{
+public:
+	CallbackStorage()
+	: manager(0), object(0)
+	{
+	}
+
+	CallbackStorage(const CallbackStorage &copy)
+	: manager(0), object(0)
+	{
+		if (copy.manager)
+			copy.manager(op_copy, copy, *this);
+	}
+
+	~CallbackStorage()
+	{
+		clear();
+	}
+
+	CallbackStorage &operator =(const CallbackStorage &copy)
+	{
+		if (this != &copy)
+		{
+			clear();
+			if (copy.manager)
+				copy.manager(op_copy, copy, *this);
+		}
+		return *this;
+	}
+
+	template<class Object>
+	void set(const Object &new_object)
+	{
+		clear();
+		if (is_inline<Object>())
+			object = new (buffer.data) Object(new_object);
+		else
+			object = new Object(new_object);
+		manager = &manage<Object>;
+	}
+
+	void clear()
+	{
+		if (manager)
+		{
+			manager(op_destroy, *this, *this);
+			manager = 0;
+			object = 0;
+		}
+	}
+
+	bool is_null() const
+	{
+		return manager == 0;
+	}
+
+	template<class Object>
+	Object *get() const
+	{
+		return static_cast<Object *>(object);
+	}
+
+private:
+	enum Operation
+	{
+		op_copy,
+		op_destroy
+	};
+
+	enum { buffer_size = 4 * sizeof(void *) };
+
+	union Buffer
+	{
+		void *align_pointer;
+		double align_double;
+		long long align_long_long;
+		unsigned char data[buffer_size];
+	};
+
+	template<class Object>
+	static bool is_inline()
+	{
+		return sizeof(Object) <= buffer_size && std::alignment_of<Object>::value <= std::alignment_of<Buffer>::value;
+	}
+
+	template<class Object>
+	static void manage(Operation operation, const CallbackStorage &source, CallbackStorage &dest)
+	{
+		if (operation == op_copy)
+		{
+			if (is_inline<Object>())
+				dest.object = new (dest.buffer.data) Object(*source.get<Object>());
+			else
+				dest.object = new Object(*source.get<Object>());
+			dest.manager = source.manager;
+		}
+		else
+		{
+			if (is_inline<Object>())
+				dest.get<Object>()->~Object();
+			else
+				delete dest.get<Object>();
+		}
+	}
+
+	typedef void (*Manager)(Operation operation, const CallbackStorage &source, CallbackStorage &dest);
+
+	Manager manager;
+	void *object;
+	Buffer buffer;
+};
+
+}
+
+/// \}
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "../System/exception.h"
+#include "callback_storage.h"
 #include <memory>
 
 namespace clan
@@ -153,82 +154,110 @@ class Callback_v0
 {
 public:
 	Callback_v0()
+	: invoke_func(0)
 	{
 	}
 
 	Callback_v0(const Callback_v0 &copy)
-	: impl(copy.impl)
+	: storage(copy.storage), invoke_func(copy.invoke_func)
 	{
 	}
 
 	Callback_v0(Callback_Impl_v0 *impl)
-	: impl(impl)
+	: invoke_func(0)
 	{
+		storage.set(std::shared_ptr< Callback_Impl_v0 >(impl));
+		invoke_func = &invoke_shared;
 	}
 
 	Callback_v0(void (*function)())
-	: impl(new Callback_Impl_v0_static(function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v0_static(function));
 	}
 
 	template<typename UserData>
 	Callback_v0(void (*function)(UserData), const UserData &user_data)
-	: impl(new Callback_Impl_v0_static_user<UserData>(function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v0_static_user<UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	Callback_v0(InstanceClass *instance, void (InstanceClass::*function)())
-	: impl(new Callback_Impl_v0_member<InstanceClass>(instance, function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v0_member<InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	Callback_v0(InstanceClass *instance, void (InstanceClass::*function)(UserData), const UserData &user_data)
-	: impl(new Callback_Impl_v0_member_user<InstanceClass, UserData>(instance, function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v0_member_user<InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void set(void (*function)())
 	{
-		impl = std::shared_ptr< Callback_Impl_v0 >(new Callback_Impl_v0_static(function));
+		set_impl(Callback_Impl_v0_static(function));
 	}
 
 	template<typename UserData>
 	void set(void (*function)(UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_v0 >(new Callback_Impl_v0_static_user<UserData>(function, user_data));
+		set_impl(Callback_Impl_v0_static_user<UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	void set(InstanceClass *instance, void (InstanceClass::*function)())
 	{
-		impl = std::shared_ptr< Callback_Impl_v0 >(new Callback_Impl_v0_member<InstanceClass>(instance, function));
+		set_impl(Callback_Impl_v0_member<InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	void set(InstanceClass *instance, void (InstanceClass::*function)(UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_v0 >(new Callback_Impl_v0_member_user<InstanceClass, UserData>(instance, function, user_data));
+		set_impl(Callback_Impl_v0_member_user<InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void clear()
 	{
-		impl = std::shared_ptr< Callback_Impl_v0 >();
+		storage.clear();
+		invoke_func = 0;
 	}
 
 	void invoke() const
 	{
-		impl->invoke();
+		invoke_func(storage);
 	}
 
 	bool is_null() const
 	{
-		return !impl;
+		return invoke_func == 0;
+	}
+
+protected:
+	template<class Impl>
+	void set_impl(const Impl &impl)
+	{
+		storage.set(impl);
+		invoke_func = &invoke_impl<Impl>;
 	}
 
 private:
-	std::shared_ptr< Callback_Impl_v0 > impl;
+	template<class Impl>
+	static void invoke_impl(const CallbackStorage &storage)
+	{
+		storage.get<Impl>()->Impl::invoke();
+	}
+
+	static void invoke_shared(const CallbackStorage &storage)
+	{
+		(*storage.get< std::shared_ptr< Callback_Impl_v0 > >())->invoke();
+	}
+
+	CallbackStorage storage;
+	void (*invoke_func)(const CallbackStorage &storage);
 };
 
 /// \brief Callback_v0_functor
@@ -246,8 +275,8 @@ public:
 
 	template<class Functor>
 	Callback_v0_functor(Functor functor)
-	: Callback_v0(new Callback_Impl_v0_functor<Functor>(functor))
 	{
+		this->set_impl(Callback_Impl_v0_functor<Functor>(functor));
 	}
 
 };
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "../System/exception.h"
+#include "callback_storage.h"
 #include <memory>
 
 namespace clan
@@ -157,82 +158,110 @@ class Callback_v1
 {
 public:
 	Callback_v1()
+	: invoke_func(0)
 	{
 	}
 
 	Callback_v1(const Callback_v1 &copy)
-	: impl(copy.impl)
+	: storage(copy.storage), invoke_func(copy.invoke_func)
 	{
 	}
 
 	Callback_v1(Callback_Impl_v1<P1> *impl)
-	: impl(impl)
+	: invoke_func(0)
 	{
+		storage.set(std::shared_ptr< Callback_Impl_v1<P1> >(impl));
+		invoke_func = &invoke_shared;
 	}
 
 	Callback_v1(void (*function)(P1))
-	: impl(new Callback_Impl_v1_static<P1>(function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v1_static<P1>(function));
 	}
 
 	template<typename UserData>
 	Callback_v1(void (*function)(P1, UserData), const UserData &user_data)
-	: impl(new Callback_Impl_v1_static_user<P1, UserData>(function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v1_static_user<P1, UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	Callback_v1(InstanceClass *instance, void (InstanceClass::*function)(P1))
-	: impl(new Callback_Impl_v1_member<P1, InstanceClass>(instance, function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v1_member<P1, InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	Callback_v1(InstanceClass *instance, void (InstanceClass::*function)(P1, UserData), const UserData &user_data)
-	: impl(new Callback_Impl_v1_member_user<P1, InstanceClass, UserData>(instance, function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v1_member_user<P1, InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void set(void (*function)(P1))
 	{
-		impl = std::shared_ptr< Callback_Impl_v1<P1> >(new Callback_Impl_v1_static<P1>(function));
+		set_impl(Callback_Impl_v1_static<P1>(function));
 	}
 
 	template<typename UserData>
 	void set(void (*function)(P1, UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_v1<P1> >(new Callback_Impl_v1_static_user<P1, UserData>(function, user_data));
+		set_impl(Callback_Impl_v1_static_user<P1, UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	void set(InstanceClass *instance, void (InstanceClass::*function)(P1))
 	{
-		impl = std::shared_ptr< Callback_Impl_v1<P1> >(new Callback_Impl_v1_member<P1, InstanceClass>(instance, function));
+		set_impl(Callback_Impl_v1_member<P1, InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	void set(InstanceClass *instance, void (InstanceClass::*function)(P1, UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_v1<P1> >(new Callback_Impl_v1_member_user<P1, InstanceClass, UserData>(instance, function, user_data));
+		set_impl(Callback_Impl_v1_member_user<P1, InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void clear()
 	{
-		impl = std::shared_ptr< Callback_Impl_v1<P1> >();
+		storage.clear();
+		invoke_func = 0;
 	}
 
 	void invoke(P1 p1) const
 	{
-		impl->invoke(p1);
+		invoke_func(storage, p1);
 	}
 
 	bool is_null() const
 	{
-		return !impl;
+		return invoke_func == 0;
+	}
+
+protected:
+	template<class Impl>
+	void set_impl(const Impl &impl)
+	{
+		storage.set(impl);
+		invoke_func = &invoke_impl<Impl>;
 	}
 
 private:
-	std::shared_ptr< Callback_Impl_v1<P1> > impl;
+	template<class Impl>
+	static void invoke_impl(const CallbackStorage &storage, P1 p1)
+	{
+		storage.get<Impl>()->Impl::invoke(p1);
+	}
+
+	static void invoke_shared(const CallbackStorage &storage, P1 p1)
+	{
+		(*storage.get< std::shared_ptr< Callback_Impl_v1<P1> > >())->invoke(p1);
+	}
+
+	CallbackStorage storage;
+	void (*invoke_func)(const CallbackStorage &storage, P1 p1);
 };
 
 /// \brief Callback_v1_functor
@@ -252,8 +281,8 @@ public:
 
 	template<class Functor>
 	Callback_v1_functor(Functor functor)
-	: Callback_v1<P1>(new Callback_Impl_v1_functor<P1, Functor>(functor))
 	{
+		this->set_impl(Callback_Impl_v1_functor<P1, Functor>(functor));
 	}
 };
 
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "../System/exception.h"
+#include "callback_storage.h"
 #include <memory>
 
 namespace clan
@@ -157,82 +158,110 @@ class Callback_v2
 {
 public:
 	Callback_v2()
+	: invoke_func(0)
 	{
 	}
 
 	Callback_v2(const Callback_v2 &copy)
-	: impl(copy.impl)
+	: storage(copy.storage), invoke_func(copy.invoke_func)
 	{
 	}
 
 	Callback_v2(Callback_Impl_v2<P1, P2> *impl)
-	: impl(impl)
+	: invoke_func(0)
 	{
+		storage.set(std::shared_ptr< Callback_Impl_v2<P1, P2> >(impl));
+		invoke_func = &invoke_shared;
 	}
 
 	Callback_v2(void (*function)(P1, P2))
-	: impl(new Callback_Impl_v2_static<P1, P2>(function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v2_static<P1, P2>(function));
 	}
 
 	template<typename UserData>
 	Callback_v2(void (*function)(P1, P2, UserData), const UserData &user_data)
-	: impl(new Callback_Impl_v2_static_user<P1, P2, UserData>(function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v2_static_user<P1, P2, UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	Callback_v2(InstanceClass *instance, void (InstanceClass::*function)(P1, P2))
-	: impl(new Callback_Impl_v2_member<P1, P2, InstanceClass>(instance, function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v2_member<P1, P2, InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	Callback_v2(InstanceClass *instance, void (InstanceClass::*function)(P1, P2, UserData), const UserData &user_data)
-	: impl(new Callback_Impl_v2_member_user<P1, P2, InstanceClass, UserData>(instance, function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v2_member_user<P1, P2, InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void set(void (*function)(P1, P2))
 	{
-		impl = std::shared_ptr< Callback_Impl_v2<P1, P2> >(new Callback_Impl_v2_static<P1, P2>(function));
+		set_impl(Callback_Impl_v2_static<P1, P2>(function));
 	}
 
 	template<typename UserData>
 	void set(void (*function)(P1, P2, UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_v2<P1, P2> >(new Callback_Impl_v2_static_user<P1, P2, UserData>(function, user_data));
+		set_impl(Callback_Impl_v2_static_user<P1, P2, UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	void set(InstanceClass *instance, void (InstanceClass::*function)(P1, P2))
 	{
-		impl = std::shared_ptr< Callback_Impl_v2<P1, P2> >(new Callback_Impl_v2_member<P1, P2, InstanceClass>(instance, function));
+		set_impl(Callback_Impl_v2_member<P1, P2, InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	void set(InstanceClass *instance, void (InstanceClass::*function)(P1, P2, UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_v2<P1, P2> >(new Callback_Impl_v2_member_user<P1, P2, InstanceClass, UserData>(instance, function, user_data));
+		set_impl(Callback_Impl_v2_member_user<P1, P2, InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void clear()
 	{
-		impl = std::shared_ptr< Callback_Impl_v2<P1, P2> >();
+		storage.clear();
+		invoke_func = 0;
 	}
 
 	void invoke(P1 p1, P2 p2) const
 	{
-		impl->invoke(p1, p2);
+		invoke_func(storage, p1, p2);
 	}
 
 	bool is_null() const
 	{
-		return !impl;
+		return invoke_func == 0;
+	}
+
+protected:
+	template<class Impl>
+	void set_impl(const Impl &impl)
+	{
+		storage.set(impl);
+		invoke_func = &invoke_impl<Impl>;
 	}
 
 private:
-	std::shared_ptr< Callback_Impl_v2<P1, P2> > impl;
+	template<class Impl>
+	static void invoke_impl(const CallbackStorage &storage, P1 p1, P2 p2)
+	{
+		storage.get<Impl>()->Impl::invoke(p1, p2);
+	}
+
+	static void invoke_shared(const CallbackStorage &storage, P1 p1, P2 p2)
+	{
+		(*storage.get< std::shared_ptr< Callback_Impl_v2<P1, P2> > >())->invoke(p1, p2);
+	}
+
+	CallbackStorage storage;
+	void (*invoke_func)(const CallbackStorage &storage, P1 p1, P2 p2);
 };
 
 /// \brief Callback_v2_functor
@@ -252,8 +281,8 @@ public:
 
 	template<class Functor>
 	Callback_v2_functor(Functor functor)
-	: Callback_v2<P1, P2>(new Callback_Impl_v2_functor<P1, P2, Functor>(functor))
 	{
+		this->set_impl(Callback_Impl_v2_functor<P1, P2, Functor>(functor));
 	}
 
 };
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "../System/exception.h"
+#include "callback_storage.h"
 #include <memory>
 
 namespace clan
@@ -157,82 +158,110 @@ class Callback_v3
 {
 public:
 	Callback_v3()
+	: invoke_func(0)
 	{
 	}
 
 	Callback_v3(const Callback_v3 &copy)
-	: impl(copy.impl)
+	: storage(copy.storage), invoke_func(copy.invoke_func)
 	{
 	}
 
 	Callback_v3(Callback_Impl_v3<P1, P2, P3> *impl)
-	: impl(impl)
+	: invoke_func(0)
 	{
+		storage.set(std::shared_ptr< Callback_Impl_v3<P1, P2, P3> >(impl));
+		invoke_func = &invoke_shared;
 	}
 
 	Callback_v3(void (*function)(P1, P2, P3))
-	: impl(new Callback_Impl_v3_static<P1, P2, P3>(function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v3_static<P1, P2, P3>(function));
 	}
 
 	template<typename UserData>
 	Callback_v3(void (*function)(P1, P2, P3, UserData), const UserData &user_data)
-	: impl(new Callback_Impl_v3_static_user<P1, P2, P3, UserData>(function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v3_static_user<P1, P2, P3, UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	Callback_v3(InstanceClass *instance, void (InstanceClass::*function)(P1, P2, P3))
-	: impl(new Callback_Impl_v3_member<P1, P2, P3, InstanceClass>(instance, function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v3_member<P1, P2, P3, InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	Callback_v3(InstanceClass *instance, void (InstanceClass::*function)(P1, P2, P3, UserData), const UserData &user_data)
-	: impl(new Callback_Impl_v3_member_user<P1, P2, P3, InstanceClass, UserData>(instance, function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v3_member_user<P1, P2, P3, InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void set(void (*function)(P1, P2, P3))
 	{
-		impl = std::shared_ptr< Callback_Impl_v3<P1, P2, P3> >(new Callback_Impl_v3_static<P1, P2, P3>(function));
+		set_impl(Callback_Impl_v3_static<P1, P2, P3>(function));
 	}
 
 	template<typename UserData>
 	void set(void (*function)(P1, P2, P3, UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_v3<P1, P2, P3> >(new Callback_Impl_v3_static_user<P1, P2, P3, UserData>(function, user_data));
+		set_impl(Callback_Impl_v3_static_user<P1, P2, P3, UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	void set(InstanceClass *instance, void (InstanceClass::*function)(P1, P2, P3))
 	{
-		impl = std::shared_ptr< Callback_Impl_v3<P1, P2, P3> >(new Callback_Impl_v3_member<P1, P2, P3, InstanceClass>(instance, function));
+		set_impl(Callback_Impl_v3_member<P1, P2, P3, InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	void set(InstanceClass *instance, void (InstanceClass::*function)(P1, P2, P3, UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_v3<P1, P2, P3> >(new Callback_Impl_v3_member_user<P1, P2, P3, InstanceClass, UserData>(instance, function, user_data));
+		set_impl(Callback_Impl_v3_member_user<P1, P2, P3, InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void clear()
 	{
-		impl = std::shared_ptr< Callback_Impl_v3<P1, P2, P3> >();
+		storage.clear();
+		invoke_func = 0;
 	}
 
 	void invoke(P1 p1, P2 p2, P3 p3) const
 	{
-		impl->invoke(p1, p2, p3);
+		invoke_func(storage, p1, p2, p3);
 	}
 
 	bool is_null() const
 	{
-		return !impl;
+		return invoke_func == 0;
+	}
+
+protected:
+	template<class Impl>
+	void set_impl(const Impl &impl)
+	{
+		storage.set(impl);
+		invoke_func = &invoke_impl<Impl>;
 	}
 
 private:
-	std::shared_ptr< Callback_Impl_v3<P1, P2, P3> > impl;
+	template<class Impl>
+	static void invoke_impl(const CallbackStorage &storage, P1 p1, P2 p2, P3 p3)
+	{
+		storage.get<Impl>()->Impl::invoke(p1, p2, p3);
+	}
+
+	static void invoke_shared(const CallbackStorage &storage, P1 p1, P2 p2, P3 p3)
+	{
+		(*storage.get< std::shared_ptr< Callback_Impl_v3<P1, P2, P3> > >())->invoke(p1, p2, p3);
+	}
+
+	CallbackStorage storage;
+	void (*invoke_func)(const CallbackStorage &storage, P1 p1, P2 p2, P3 p3);
 };
 
 /// \brief Callback_v3_functor
@@ -252,8 +281,8 @@ public:
 
 	template<class Functor>
 	Callback_v3_functor(Functor functor)
-	: Callback_v3<P1, P2, P3>(new Callback_Impl_v3_functor<P1, P2, P3, Functor>(functor))
 	{
+		this->set_impl(Callback_Impl_v3_functor<P1, P2, P3, Functor>(functor));
 	}
 
 };
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "../System/exception.h"
+#include "callback_storage.h"
 #include <memory>
 
 namespace clan
@@ -157,82 +158,110 @@ class Callback_v4
 {
 public:
 	Callback_v4()
+	: invoke_func(0)
 	{
 	}
 
 	Callback_v4(const Callback_v4 &copy)
-	: impl(copy.impl)
+	: storage(copy.storage), invoke_func(copy.invoke_func)
 	{
 	}
 
 	Callback_v4(Callback_Impl_v4<P1, P2, P3, P4> *impl)
-	: impl(impl)
+	: invoke_func(0)
 	{
+		storage.set(std::shared_ptr< Callback_Impl_v4<P1, P2, P3, P4> >(impl));
+		invoke_func = &invoke_shared;
 	}
 
 	Callback_v4(void (*function)(P1, P2, P3, P4))
-	: impl(new Callback_Impl_v4_static<P1, P2, P3, P4>(function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v4_static<P1, P2, P3, P4>(function));
 	}
 
 	template<typename UserData>
 	Callback_v4(void (*function)(P1, P2, P3, P4, UserData), const UserData &user_data)
-	: impl(new Callback_Impl_v4_static_user<P1, P2, P3, P4, UserData>(function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v4_static_user<P1, P2, P3, P4, UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	Callback_v4(InstanceClass *instance, void (InstanceClass::*function)(P1, P2, P3, P4))
-	: impl(new Callback_Impl_v4_member<P1, P2, P3, P4, InstanceClass>(instance, function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v4_member<P1, P2, P3, P4, InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	Callback_v4(InstanceClass *instance, void (InstanceClass::*function)(P1, P2, P3, P4, UserData), const UserData &user_data)
-	: impl(new Callback_Impl_v4_member_user<P1, P2, P3, P4, InstanceClass, UserData>(instance, function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v4_member_user<P1, P2, P3, P4, InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void set(void (*function)(P1, P2, P3, P4))
 	{
-		impl = std::shared_ptr< Callback_Impl_v4<P1, P2, P3, P4> >(new Callback_Impl_v4_static<P1, P2, P3, P4>(function));
+		set_impl(Callback_Impl_v4_static<P1, P2, P3, P4>(function));
 	}
 
 	template<typename UserData>
 	void set(void (*function)(P1, P2, P3, P4, UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_v4<P1, P2, P3, P4> >(new Callback_Impl_v4_static_user<P1, P2, P3, P4, UserData>(function, user_data));
+		set_impl(Callback_Impl_v4_static_user<P1, P2, P3, P4, UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	void set(InstanceClass *instance, void (InstanceClass::*function)(P1, P2, P3, P4))
 	{
-		impl = std::shared_ptr< Callback_Impl_v4<P1, P2, P3, P4> >(new Callback_Impl_v4_member<P1, P2, P3, P4, InstanceClass>(instance, function));
+		set_impl(Callback_Impl_v4_member<P1, P2, P3, P4, InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	void set(InstanceClass *instance, void (InstanceClass::*function)(P1, P2, P3, P4, UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_v4<P1, P2, P3, P4> >(new Callback_Impl_v4_member_user<P1, P2, P3, P4, InstanceClass, UserData>(instance, function, user_data));
+		set_impl(Callback_Impl_v4_member_user<P1, P2, P3, P4, InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void clear()
 	{
-		impl = std::shared_ptr< Callback_Impl_v4<P1, P2, P3, P4> >();
+		storage.clear();
+		invoke_func = 0;
 	}
 
 	void invoke(P1 p1, P2 p2, P3 p3, P4 p4) const
 	{
-		impl->invoke(p1, p2, p3, p4);
+		invoke_func(storage, p1, p2, p3, p4);
 	}
 
 	bool is_null() const
 	{
-		return !impl;
+		return invoke_func == 0;
+	}
+
+protected:
+	template<class Impl>
+	void set_impl(const Impl &impl)
+	{
+		storage.set(impl);
+		invoke_func = &invoke_impl<Impl>;
 	}
 
 private:
-	std::shared_ptr< Callback_Impl_v4<P1, P2, P3, P4> > impl;
+	template<class Impl>
+	static void invoke_impl(const CallbackStorage &storage, P1 p1, P2 p2, P3 p3, P4 p4)
+	{
+		storage.get<Impl>()->Impl::invoke(p1, p2, p3, p4);
+	}
+
+	static void invoke_shared(const CallbackStorage &storage, P1 p1, P2 p2, P3 p3, P4 p4)
+	{
+		(*storage.get< std::shared_ptr< Callback_Impl_v4<P1, P2, P3, P4> > >())->invoke(p1, p2, p3, p4);
+	}
+
+	CallbackStorage storage;
+	void (*invoke_func)(const CallbackStorage &storage, P1 p1, P2 p2, P3 p3, P4 p4);
 };
 
 /// \brief Callback_v4_functor
@@ -252,8 +281,8 @@ public:
 
 	template<class Functor>
 	Callback_v4_functor(Functor functor)
-	: Callback_v4<P1, P2, P3, P4>(new Callback_Impl_v4_functor<P1, P2, P3, P4, Functor>(functor))
 	{
+		this->set_impl(Callback_Impl_v4_functor<P1, P2, P3, P4, Functor>(functor));
 	}
 
 };
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "../System/exception.h"
+#include "callback_storage.h"
 #include <memory>
 
 namespace clan
@@ -157,82 +158,110 @@ class Callback_v6
 {
 public:
 	Callback_v6()
+	: invoke_func(0)
 	{
 	}
 
 	Callback_v6(const Callback_v6 &copy)
-	: impl(copy.impl)
+	: storage(copy.storage), invoke_func(copy.invoke_func)
 	{
 	}
 
 	Callback_v6(Callback_Impl_v6<P1, P2, P3, P4, P5, P6> *impl)
-	: impl(impl)
+	: invoke_func(0)
 	{
+		storage.set(std::shared_ptr< Callback_Impl_v6<P1, P2, P3, P4, P5, P6> >(impl));
+		invoke_func = &invoke_shared;
 	}
 
 	Callback_v6(void (*function)(P1, P2, P3, P4, P5, P6))
-	: impl(new Callback_Impl_v6_static<P1, P2, P3, P4, P5, P6>(function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v6_static<P1, P2, P3, P4, P5, P6>(function));
 	}
 
 	template<typename UserData>
 	Callback_v6(void (*function)(P1, P2, P3, P4, P5, P6, UserData), const UserData &user_data)
-	: impl(new Callback_Impl_v6_static_user<P1, P2, P3, P4, P5, P6, UserData>(function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v6_static_user<P1, P2, P3, P4, P5, P6, UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	Callback_v6(InstanceClass *instance, void (InstanceClass::*function)(P1, P2, P3, P4, P5, P6))
-	: impl(new Callback_Impl_v6_member<P1, P2, P3, P4, P5, P6, InstanceClass>(instance, function))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v6_member<P1, P2, P3, P4, P5, P6, InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	Callback_v6(InstanceClass *instance, void (InstanceClass::*function)(P1, P2, P3, P4, P5, P6, UserData), const UserData &user_data)
-	: impl(new Callback_Impl_v6_member_user<P1, P2, P3, P4, P5, P6, InstanceClass, UserData>(instance, function, user_data))
+	: invoke_func(0)
 	{
+		set_impl(Callback_Impl_v6_member_user<P1, P2, P3, P4, P5, P6, InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void set(void (*function)(P1, P2, P3, P4, P5, P6))
 	{
-		impl = std::shared_ptr< Callback_Impl_v6<P1, P2, P3, P4, P5, P6> >(new Callback_Impl_v6_static<P1, P2, P3, P4, P5, P6>(function));
+		set_impl(Callback_Impl_v6_static<P1, P2, P3, P4, P5, P6>(function));
 	}
 
 	template<typename UserData>
 	void set(void (*function)(P1, P2, P3, P4, P5, P6, UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_v6<P1, P2, P3, P4, P5, P6> >(new Callback_Impl_v6_static_user<P1, P2, P3, P4, P5, P6, UserData>(function, user_data));
+		set_impl(Callback_Impl_v6_static_user<P1, P2, P3, P4, P5, P6, UserData>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	void set(InstanceClass *instance, void (InstanceClass::*function)(P1, P2, P3, P4, P5, P6))
 	{
-		impl = std::shared_ptr< Callback_Impl_v6<P1, P2, P3, P4, P5, P6> >(new Callback_Impl_v6_member<P1, P2, P3, P4, P5, P6, InstanceClass>(instance, function));
+		set_impl(Callback_Impl_v6_member<P1, P2, P3, P4, P5, P6, InstanceClass>(instance, function));
 	}
 
 	template<class InstanceClass, typename UserData>
 	void set(InstanceClass *instance, void (InstanceClass::*function)(P1, P2, P3, P4, P5, P6, UserData), const UserData &user_data)
 	{
-		impl = std::shared_ptr< Callback_Impl_v6<P1, P2, P3, P4, P5, P6> >(new Callback_Impl_v6_member_user<P1, P2, P3, P4, P5, P6, InstanceClass, UserData>(instance, function, user_data));
+		set_impl(Callback_Impl_v6_member_user<P1, P2, P3, P4, P5, P6, InstanceClass, UserData>(instance, function, user_data));
 	}
 
 	void clear()
 	{
-		impl = std::shared_ptr< Callback_Impl_v6<P1, P2, P3, P4, P5, P6> >();
+		storage.clear();
+		invoke_func = 0;
 	}
 
 	void invoke(P1 p1, P2 p2, P3 p3, P4 p4, P5 p5, P6 p6) const
 	{
-		impl->invoke(p1, p2, p3, p4, p5, p6);
+		invoke_func(storage, p1, p2, p3, p4, p5, p6);
 	}
 
 	bool is_null() const
 	{
-		return !impl;
+		return invoke_func == 0;
+	}
+
+protected:
+	template<class Impl>
+	void set_impl(const Impl &impl)
+	{
+		storage.set(impl);
+		invoke_func = &invoke_impl<Impl>;
 	}
 
 private:
-	std::shared_ptr< Callback_Impl_v6<P1, P2, P3, P4, P5, P6> > impl;
+	template<class Impl>
+	static void invoke_impl(const CallbackStorage &storage, P1 p1, P2 p2, P3 p3, P4 p4, P5 p5, P6 p6)
+	{
+		storage.get<Impl>()->Impl::invoke(p1, p2, p3, p4, p5, p6);
+	}
+
+	static void invoke_shared(const CallbackStorage &storage, P1 p1, P2 p2, P3 p3, P4 p4, P5 p5, P6 p6)
+	{
+		(*storage.get< std::shared_ptr< Callback_Impl_v6<P1, P2, P3, P4, P5, P6> > >())->invoke(p1, p2, p3, p4, p5, p6);
+	}
+
+	CallbackStorage storage;
+	void (*invoke_func)(const CallbackStorage &storage, P1 p1, P2 p2, P3 p3, P4 p4, P5 p5, P6 p6);
 };
 
 /// \brief Callback_v6_functor
@@ -252,8 +281,8 @@ public:
 
 	template<class Functor>
 	Callback_v6_functor(Functor functor)
-	: Callback_v6<P1, P2, P3, P4, P5, P6>(new Callback_Impl_v6_functor<P1, P2, P3, P4, P5, P6, Functor>(functor))
 	{
+		this->set_impl(Callback_Impl_v6_functor<P1, P2, P3, P4, P5, P6, Functor>(functor));
 	}
 };
 
@@ -32,6 +32,7 @@
 #include "../api_core.h"
 #include "slot.h"
 #include "signals_impl.h"
+#include "callback_v0.h"
 
 namespace clan
 {
@@ -39,68 +40,13 @@ namespace clan
 /// \{
 
 /// (Internal ClanLib Class)
-class CL_API_CORE SlotCallback_v0 : public SlotCallback
+class SlotCallback_v0 : public SlotCallback
 {
 public:
-	virtual void invoke() = 0;
-};
-
-/// (Internal ClanLib Class)
-class CL_API_CORE SlotCallback_v0_static : public SlotCallback_v0
-{
-public:
-	SlotCallback_v0_static(void (*static_func)())
-	: static_func(static_func) { return; }
-	void invoke() { static_func(); }
-	void (*static_func)();
-};
-
-/// (Internal ClanLib Class)
-template <class UserData>
-class SlotCallback_v0_static_user : public SlotCallback_v0
-{
-public:
-	SlotCallback_v0_static_user(void (*static_func)(UserData), const UserData &user_data)
-	: static_func(static_func), user_data(user_data) { return; }
-	void invoke() { static_func(user_data); }
-	void (*static_func)(UserData);
-	UserData user_data;
-};
-
-/// (Internal ClanLib Class)
-template <class InstanceClass>
-class SlotCallback_v0_member : public SlotCallback_v0
-{
-public:
-	SlotCallback_v0_member(InstanceClass *instance, void (InstanceClass::*member_func)())
-	: instance(instance), member_func(member_func) { return; }
-	void invoke() { (instance->*member_func)(); }
-	InstanceClass *instance;
-	void (InstanceClass::*member_func)();
-};
-
-/// (Internal ClanLib Class)
-template <class InstanceClass, class UserData>
-class SlotCallback_v0_member_user : public SlotCallback_v0
-{
-public:
-	SlotCallback_v0_member_user(InstanceClass *instance, void (InstanceClass::*member_func)(UserData), const UserData &user_data)
-	: instance(instance), member_func(member_func), user_data(user_data) { return; }
-	void invoke() { (instance->*member_func)(user_data); }
-	InstanceClass *instance;
-	void (InstanceClass::*member_func)(UserData);
-	UserData user_data;
-};
+	SlotCallback_v0(const Callback_v0 &callback)
+	: callback(callback) { return; }
 
-/// (Internal ClanLib Class)
-template <class Functor>
-class SlotCallback_v0_functor : public SlotCallback_v0
-{
-public:
-	SlotCallback_v0_functor(const Functor &functor)
-	: functor(functor) { return; }
-	void invoke() { functor(); }
-	Functor functor;
+	Callback_v0 callback;
 };
 
 /// \brief Signal_v0
@@ -111,7 +57,7 @@ class CL_API_CORE Signal_v0
 
 public:
 	Signal_v0()
-	: impl(new Signal_Impl) { return; }
+	: impl(new Signal_Impl, &Signal_Impl::destroy) { return; }
 
 	Signal_v0(const Signal_v0 &copy)
 	: impl(copy.impl) { return; }
@@ -124,61 +70,44 @@ public:
 public:
 	Slot connect(void (*function)())
 	{
-		clean_up();
-		std::shared_ptr<SlotCallback> callback(
-			new SlotCallback_v0_static(function));
-		impl->connected_slots.push_back(callback);
-		return Slot(callback);
+		return connect_callback(Callback_v0(function));
 	}
 
 	template<class UserData>
 	Slot connect(void (*function)(UserData), const UserData &user_data)
 	{
-		clean_up();
-		std::shared_ptr<SlotCallback> callback(
-			new SlotCallback_v0_static_user<UserData>(function, user_data));
-		impl->connected_slots.push_back(callback);
-		return Slot(callback);
+		return connect_callback(Callback_v0(function, user_data));
 	}
 
 	template<class InstanceClass>
 	Slot connect(InstanceClass *instance, void (InstanceClass::*function)())
 	{
-		clean_up();
-		std::shared_ptr<SlotCallback> callback(
-			new SlotCallback_v0_member<InstanceClass>(instance, function));
-		impl->connected_slots.push_back(callback);
-		return Slot(callback);
+		return connect_callback(Callback_v0(instance, function));
 	}
 
 	template<class InstanceClass, class UserData>
 	Slot connect(InstanceClass *instance, void (InstanceClass::*function)(UserData), const UserData &user_data)
 	{
-		clean_up();
-		std::shared_ptr<SlotCallback> callback(
-			new SlotCallback_v0_member_user<InstanceClass, UserData>(instance, function, user_data));
-		impl->connected_slots.push_back(callback);
-		return Slot(callback);
+		return connect_callback(Callback_v0(instance, function, user_data));
 	}
 
 	template<class Functor>
 	Slot connect_functor(const Functor &functor)
 	{
-		clean_up();
-		std::shared_ptr<SlotCallback> callback(
-			new SlotCallback_v0_functor<Functor>(functor));
-		impl->connected_slots.push_back(callback);
-		return Slot(callback);
+		return connect_callback(Callback_v0_functor(functor));
 	}
 
 	void invoke() const
 	{
-		std::vector< std::shared_ptr<SlotCallback> > callbacks = impl->connected_slots;
-		std::vector< std::shared_ptr<SlotCallback> >::size_type i, size;
-		size = callbacks.size();
-		for (i = 0; i < size; i++)
-			if (callbacks[i]->valid && callbacks[i]->enabled)
-				((SlotCallback_v0 *) callbacks[i].get())->invoke();
+		Signal_Impl *signal = impl.get();
+		SignalInvokeGuard guard(signal);
+		for (SlotCallback *callback = signal->first; callback; callback = callback->next)
+		{
+			if (callback->valid && callback->enabled)
+				static_cast<SlotCallback_v0 *>(callback)->callback.invoke();
+			if (callback == guard.last)
+				break;
+		}
 	}
 
 
@@ -187,19 +116,11 @@ public:
 /// \{
 
 private:
-	void clean_up()
+	Slot connect_callback(const Callback_v0 &callback)
 	{
-		std::vector< std::shared_ptr<SlotCallback> >::size_type i, size;
-		size = impl->connected_slots.size();
-		for (i = 0; i < size; i++)
-		{
-			if (!impl->connected_slots[i]->valid)
-			{
-				impl->connected_slots.erase(impl->connected_slots.begin()+i);
-				i--;
-				size--;
-			}
-		}
+		SlotCallback_v0 *slot_callback = new SlotCallback_v0(callback);
+		impl->add(slot_callback);
+		return Slot(slot_callback);
 	}
 
 	std::shared_ptr<Signal_Impl> impl;
@@ -31,6 +31,7 @@
 
 #include "slot.h"
 #include "signals_impl.h"
+#include "callback_v3.h"
 
 namespace clan
 {
@@ -42,66 +43,10 @@ template <class Param1, class Param2, class Param3>
 class SlotCallback_v3 : public SlotCallback
 {
 public:
-	virtual void invoke(Param1 param1, Param2 param2, Param3 param3) = 0;
-};
-
-/// (Internal ClanLib Class)
-template <class Param1, class Param2, class Param3>
-class SlotCallback_v3_static : public SlotCallback_v3<Param1, Param2, Param3>
-{
-public:
-	SlotCallback_v3_static(void (*static_func)(Param1, Param2, Param3))
-	: static_func(static_func) { return; }
-	void invoke(Param1 param1, Param2 param2, Param3 param3) { static_func(param1, param2, param3); }
-	void (*static_func)(Param1, Param2, Param3);
-};
+	SlotCallback_v3(const Callback_v3<Param1, Param2, Param3> &callback)
+	: callback(callback) { return; }
 
-/// (Internal ClanLib Class)
-template <class Param1, class Param2, class Param3, class UserData>
-class SlotCallback_v3_static_user : public SlotCallback_v3<Param1, Param2, Param3>
-{
-public:
-	SlotCallback_v3_static_user(void (*static_func)(Param1, Param2, Param3, UserData), const UserData &user_data)
-	: static_func(static_func), user_data(user_data) { return; }
-	void invoke(Param1 param1, Param2 param2, Param3 param3) { static_func(param1, param2, param3, user_data); }
-	void (*static_func)(Param1, Param2, Param3, UserData);
-	UserData user_data;
-};
-
-/// (Internal ClanLib Class)
-template <class Param1, class Param2, class Param3, class InstanceClass>
-class SlotCallback_v3_member : public SlotCallback_v3<Param1, Param2, Param3>
-{
-public:
-	SlotCallback_v3_member(InstanceClass *instance, void (InstanceClass::*member_func)(Param1, Param2, Param3))
-	: instance(instance), member_func(member_func) { return; }
-	void invoke(Param1 param1, Param2 param2, Param3 param3) { (instance->*member_func)(param1, param2, param3); }
-	InstanceClass *instance;
-	void (InstanceClass::*member_func)(Param1, Param2, Param3);
-};
-
-/// (Internal ClanLib Class)
-template <class Param1, class Param2, class Param3, class InstanceClass, class UserData>
-class SlotCallback_v3_member_user : public SlotCallback_v3<Param1, Param2, Param3>
-{
-public:
-	SlotCallback_v3_member_user(InstanceClass *instance, void (InstanceClass::*member_func)(Param1, Param2, Param3, UserData), const UserData &user_data)
-	: instance(instance), member_func(member_func), user_data(user_data) { return; }
-	void invoke(Param1 param1, Param2 param2, Param3 param3) { (instance->*member_func)(param1, param2, param3, user_data); }
-	InstanceClass *instance;
-	void (InstanceClass::*member_func)(Param1, Param2, Param3, UserData);
-	UserData user_data;
-};
-
-/// (Internal ClanLib Class)
-template <class Param1, class Param2, class Param3, class Functor>
-class SlotCallback_v3_functor : public SlotCallback_v3<Param1, Param2, Param3>
-{
-public:
-	SlotCallback_v3_functor(const Functor &functor)
-	: functor(functor) { return; }
-	void invoke(Param1 param1, Param2 param2, Param3 param3) { functor(param1, param2, param3); }
-	Functor functor;
+	Callback_v3<Param1, Param2, Param3> callback;
 };
 
 /// \brief Signal_v3
@@ -114,7 +59,7 @@ class Signal_v3
 
 public:
 	Signal_v3()
-	: impl(new Signal_Impl) { return; }
+	: impl(new Signal_Impl, &Signal_Impl::destroy) { return; }
 
 	Signal_v3(const Signal_v3<Param1, Param2, Param3> &copy)
 	: impl(copy.impl) { return; }
@@ -127,61 +72,44 @@ public:
 public:
 	Slot connect(void (*function)(Param1, Param2, Param3))
 	{
-		clean_up();
-		std::shared_ptr<SlotCallback> callback(
-			new SlotCallback_v3_static<Param1, Param2, Param3>(function));
-		impl->connected_slots.push_back(callback);
-		return Slot(callback);
+		return connect_callback(Callback_v3<Param1, Param2, Param3>(function));
 	}
 
 	template<class UserData>
 	Slot connect(void (*function)(Param1, Param2, Param3, UserData), const UserData &user_data)
 	{
-		clean_up();
-		std::shared_ptr<SlotCallback> callback(
-			new SlotCallback_v3_static_user<Param1, Param2, Param3, UserData>(function, user_data));
-		impl->connected_slots.push_back(callback);
-		return Slot(callback);
+		return connect_callback(Callback_v3<Param1, Param2, Param3>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	Slot connect(InstanceClass *instance, void (InstanceClass::*function)(Param1, Param2, Param3))
 	{
-		clean_up();
-		std::shared_ptr<SlotCallback> callback(
-			new SlotCallback_v3_member<Param1, Param2, Param3, InstanceClass>(instance, function));
-		impl->connected_slots.push_back(callback);
-		return Slot(callback);
+		return connect_callback(Callback_v3<Param1, Param2, Param3>(instance, function));
 	}
 
 	template<class InstanceClass, class UserData>
 	Slot connect(InstanceClass *instance, void (InstanceClass::*function)(Param1, Param2, Param3, UserData), const UserData &user_data)
 	{
-		clean_up();
-		std::shared_ptr<SlotCallback> callback(
-			new SlotCallback_v3_member_user<Param1, Param2, Param3, InstanceClass, UserData>(instance, function, user_data));
-		impl->connected_slots.push_back(callback);
-		return Slot(callback);
+		return connect_callback(Callback_v3<Param1, Param2, Param3>(instance, function, user_data));
 	}
 
 	template<class Functor>
 	Slot connect_functor(const Functor &functor)
 	{
-		clean_up();
-		std::shared_ptr<SlotCallback> callback(
-			new SlotCallback_v3_functor<Param1, Param2, Param3, Functor>(functor));
-		impl->connected_slots.push_back(callback);
-		return Slot(callback);
+		return connect_callback(Callback_v3_functor<Param1, Param2, Param3>(functor));
 	}
 
 	void invoke(Param1 param1, Param2 param2, Param3 param3) const
 	{
-		std::vector< std::shared_ptr<SlotCallback> > callbacks = impl->connected_slots;
-		std::vector< std::shared_ptr<SlotCallback> >::size_type i, size;
-		size = callbacks.size();
-		for (i = 0; i < size; i++)
-			if (callbacks[i]->valid && callbacks[i]->enabled)
-				((SlotCallback_v3<Param1, Param2, Param3> *) callbacks[i].get())->invoke(param1, param2, param3);
+		Signal_Impl *signal = impl.get();
+		SignalInvokeGuard guard(signal);
+		for (SlotCallback *callback = signal->first; callback; callback = callback->next)
+		{
+			if (callback->valid && callback->enabled)
+				static_cast<SlotCallback_v3<Param1, Param2, Param3> *>(callback)->callback.invoke(param1, param2, param3);
+			if (callback == guard.last)
+				break;
+		}
 	}
 
 
@@ -190,19 +118,11 @@ public:
 /// \{
 
 private:
-	void clean_up()
+	Slot connect_callback(const Callback_v3<Param1, Param2, Param3> &callback)
 	{
-		std::vector< std::shared_ptr<SlotCallback> >::size_type i, size;
-		size = impl->connected_slots.size();
-		for (i = 0; i < size; i++)
-		{
-			if (!impl->connected_slots[i]->valid)
-			{
-				impl->connected_slots.erase(impl->connected_slots.begin()+i);
-				i--;
-				size--;
-			}
-		}
+		SlotCallback_v3<Param1, Param2, Param3> *slot_callback = new SlotCallback_v3<Param1, Param2, Param3>(callback);
+		impl->add(slot_callback);
+		return Slot(slot_callback);
 	}
 
 	std::shared_ptr<Signal_Impl> impl;
@@ -31,6 +31,7 @@
 
 #include "slot.h"
 #include "signals_impl.h"
+#include "callback_v6.h"
 
 namespace clan
 {
@@ -42,66 +43,10 @@ template <class Param1, class Param2, class Param3, class Param4, class Param5,
 class SlotCallback_v6 : public SlotCallback
 {
 public:
-	virtual void invoke(Param1 param1, Param2 param2, Param3 param3, Param4 param4, Param5 param5, Param6 param6) = 0;
-};
-
-/// (Internal ClanLib Class)
-template <class Param1, class Param2, class Param3, class Param4, class Param5, class Param6>
-class SlotCallback_v6_static : public SlotCallback_v6<Param1, Param2, Param3, Param4, Param5, Param6>
-{
-public:
-	SlotCallback_v6_static(void (*static_func)(Param1, Param2, Param3, Param4, Param5, Param6))
-	: static_func(static_func) { return; }
-	void invoke(Param1 param1, Param2 param2, Param3 param3, Param4 param4, Param5 param5, Param6 param6) { static_func(param1, param2, param3, param4, param5, param6); }
-	void (*static_func)(Param1, Param2, Param3, Param4, Param5, Param6);
-};
-
-/// (Internal ClanLib Class)
-template <class Param1, class Param2, class Param3, class Param4, class Param5, class Param6, class UserData>
-class SlotCallback_v6_static_user : public SlotCallback_v6<Param1, Param2, Param3, Param4, Param5, Param6>
-{
-public:
-	SlotCallback_v6_static_user(void (*static_func)(Param1, Param2, Param3, Param4, Param5, Param6, UserData), const UserData &user_data)
-	: static_func(static_func), user_data(user_data) { return; }
-	void invoke(Param1 param1, Param2 param2, Param3 param3, Param4 param4, Param5 param5, Param6 param6) { static_func(param1, param2, param3, param4, param5, param6, user_data); }
-	void (*static_func)(Param1, Param2, Param3, Param4, Param5, Param6, UserData);
-	UserData user_data;
-};
-
-/// (Internal ClanLib Class)
-template <class Param1, class Param2, class Param3, class Param4, class Param5, class Param6, class InstanceClass>
-class SlotCallback_v6_member : public SlotCallback_v6<Param1, Param2, Param3, Param4, Param5, Param6>
-{
-public:
-	SlotCallback_v6_member(InstanceClass *instance, void (InstanceClass::*member_func)(Param1, Param2, Param3, Param4, Param5, Param6))
-	: instance(instance), member_func(member_func) { return; }
-	void invoke(Param1 param1, Param2 param2, Param3 param3, Param4 param4, Param5 param5, Param6 param6) { (instance->*member_func)(param1, param2, param3, param4, param5, param6); }
-	InstanceClass *instance;
-	void (InstanceClass::*member_func)(Param1, Param2, Param3, Param4, Param5, Param6);
-};
+	SlotCallback_v6(const Callback_v6<Param1, Param2, Param3, Param4, Param5, Param6> &callback)
+	: callback(callback) { return; }
 
-/// (Internal ClanLib Class)
-template <class Param1, class Param2, class Param3, class Param4, class Param5, class Param6, class InstanceClass, class UserData>
-class SlotCallback_v6_member_user : public SlotCallback_v6<Param1, Param2, Param3, Param4, Param5, Param6>
-{
-public:
-	SlotCallback_v6_member_user(InstanceClass *instance, void (InstanceClass::*member_func)(Param1, Param2, Param3, Param4, Param5, Param6, UserData), const UserData &user_data)
-	: instance(instance), member_func(member_func), user_data(user_data) { return; }
-	void invoke(Param1 param1, Param2 param2, Param3 param3, Param4 param4, Param5 param5, Param6 param6) { (instance->*member_func)(param1, param2, param3, param4, param5, param6, user_data); }
-	InstanceClass *instance;
-	void (InstanceClass::*member_func)(Param1, Param2, Param3, Param4, Param5, Param6, UserData);
-	UserData user_data;
-};
-
-/// (Internal ClanLib Class)
-template <class Param1, class Param2, class Param3, class Param4, class Param5, class Param6, class Functor>
-class SlotCallback_v6_functor : public SlotCallback_v6<Param1, Param2, Param3, Param4, Param5, Param6>
-{
-public:
-	SlotCallback_v6_functor(const Functor &functor)
-	: functor(functor) { return; }
-	void invoke(Param1 param1, Param2 param2, Param3 param3, Param4 param4, Param5 param5, Param6 param6) { functor(param1, param2, param3, param4, param5, param6); }
-	Functor functor;
+	Callback_v6<Param1, Param2, Param3, Param4, Param5, Param6> callback;
 };
 
 /// \brief Signal_v6
@@ -114,7 +59,7 @@ class Signal_v6
 
 public:
 	Signal_v6()
-	: impl(new Signal_Impl) { return; }
+	: impl(new Signal_Impl, &Signal_Impl::destroy) { return; }
 
 	Signal_v6(const Signal_v6<Param1, Param2, Param3, Param4, Param5, Param6> &copy)
 	: impl(copy.impl) { return; }
@@ -127,81 +72,57 @@ public:
 public:
 	Slot connect(void (*function)(Param1, Param2, Param3, Param4, Param5, Param6))
 	{
-		clean_up();
-		std::shared_ptr<SlotCallback> callback(
-			new SlotCallback_v6_static<Param1, Param2, Param3, Param4, Param5, Param6>(function));
-		impl->connected_slots.push_back(callback);
-		return Slot(callback);
+		return connect_callback(Callback_v6<Param1, Param2, Param3, Param4, Param5, Param6>(function));
 	}
 
 	template<class UserData>
 	Slot connect(void (*function)(Param1, Param2, Param3, Param4, Param5, Param6, UserData), const UserData &user_data)
 	{
-		clean_up();
-		std::shared_ptr<SlotCallback> callback(
-			new SlotCallback_v6_static_user<Param1, Param2, Param3, Param4, Param5, Param6, UserData>(function, user_data));
-		impl->connected_slots.push_back(callback);
-		return Slot(callback);
+		return connect_callback(Callback_v6<Param1, Param2, Param3, Param4, Param5, Param6>(function, user_data));
 	}
 
 	template<class InstanceClass>
 	Slot connect(InstanceClass *instance, void (InstanceClass::*function)(Param1, Param2, Param3, Param4, Param5, Param6))
 	{
-		clean_up();
-		std::shared_ptr<SlotCallback> callback(
-			new SlotCallback_v6_member<Param1, Param2, Param3, Param4, Param5, Param6, InstanceClass>(instance, function));
-		impl->connected_slots.push_back(callback);
-		return Slot(callback);
+		return connect_callback(Callback_v6<Param1, Param2, Param3, Param4, Param5, Param6>(instance, function));
 	}
 
 	template<class InstanceClass, class UserData>
 	Slot connect(InstanceClass *instance, void (InstanceClass::*function)(Param1, Param2, Param3, Param4, Param5, Param6, UserData), const UserData &user_data)
 	{
-		clean_up();
-		std::shared_ptr<SlotCallback> callback(
-			new SlotCallback_v6_member_user<Param1, Param2, Param3, Param4, Param5, Param6, InstanceClass, UserData>(instance, function, user_data));
-		impl->connected_slots.push_back(callback);
-		return Slot(callback);
+		return connect_callback(Callback_v6<Param1, Param2, Param3, Param4, Param5, Param6>(instance, function, user_data));
 	}
 
 	template<class Functor>
 	Slot connect_functor(const Functor &functor)
 	{
-		clean_up();
-		std::shared_ptr<SlotCallback> callback(
-			new SlotCallback_v6_functor<Param1, Param2, Param3, Param4, Param5, Param6, Functor>(functor));
-		impl->connected_slots.push_back(callback);
-		return Slot(callback);
+		return connect_callback(Callback_v6_functor<Param1, Param2, Param3, Param4, Param5, Param6>(functor));
 	}
 
 	void invoke(Param1 param1, Param2 param2, Param3 param3, Param4 param4, Param5 param5, Param6 param6) const
 	{
-		std::vector< std::shared_ptr<SlotCallback> > callbacks = impl->connected_slots;
-		std::vector< std::shared_ptr<SlotCallback> >::size_type i, size;
-		size = callbacks.size();
-		for (i = 0; i < size; i++)
-			if (callbacks[i]->valid && callbacks[i]->enabled)
-				((SlotCallback_v6<Param1, Param2, Param3, Param4, Param5, Param6> *) callbacks[i].get())->invoke(param1, param2, param3, param4, param5, param6);
+		Signal_Impl *signal = impl.get();
+		SignalInvokeGuard guard(signal);
+		for (SlotCallback *callback = signal->first; callback; callback = callback->next)
+		{
+			if (callback->valid && callback->enabled)
+				static_cast<SlotCallback_v6<Param1, Param2, Param3, Param4, Param5, Param6> *>(callback)->callback.invoke(param1, param2, param3, param4, param5, param6);
+			if (callback == guard.last)
+				break;
+		}
 	}
 
+
 /// \}
 /// \name Implementation
 /// \{
 
 private:
-	void clean_up()
+	Slot connect_callback(const Callback_v6<Param1, Param2, Param3, Param4, Param5, Param6> &callback)
 	{
-		std::vector< std::shared_ptr<SlotCallback> >::size_type i, size;
-		size = impl->connected_slots.size();
-		for (i = 0; i < size; i++)
-		{
-			if (!impl->connected_slots[i]->valid)
-			{
-				impl->connected_slots.erase(impl->connected_slots.begin()+i);
-				i--;
-				size--;
-			}
-		}
+		SlotCallback_v6<Param1, Param2, Param3, Param4, Param5, Param6> *slot_callback = new SlotCallback_v6<Param1, Param2, Param3, Param4, Param5, Param6>(callback);
+		impl->add(slot_callback);
+		return Slot(slot_callback);
 	}
 
 	std::shared_ptr<Signal_Impl> impl;
@@ -31,38 +31,173 @@
 
 #include "../api_core.h"
 #include <memory>
-#include <vector>
 
 namespace clan
 {
 
+class Signal_Impl;
+
 /// (Internal ClanLib Class)
+///
+/// Node in the intrusive slot list of a signal. The list holds one reference and each
+/// Slot handle holds one. When the last Slot handle goes away the node is disconnected.
 class CL_API_CORE SlotCallback
 {
 public:
-	SlotCallback() : valid(true), enabled(true) { return; }
+	SlotCallback() : valid(true), enabled(true), signal(0), prev(0), next(0), ref_count(1), slot_count(0) { return; }
 
 	virtual ~SlotCallback() { return; }
 
+	void add_ref() { ref_count++; }
+
+	void release() { if (--ref_count == 0) delete this; }
+
+	inline void disconnect();
+
 	bool valid;
 
 	bool enabled;
+
+	Signal_Impl *signal;
+
+	SlotCallback *prev;
+
+	SlotCallback *next;
+
+	int ref_count;
+
+	int slot_count;
 };
 
 /// (Internal ClanLib Class)
-class CL_API_CORE Slot_Impl
+///
+/// Slots disconnected while the signal is being invoked stay linked until the outermost
+/// invoke returns. Likewise, deleting the signal from within one of its callbacks is
+/// deferred until the invoke is done.
+class CL_API_CORE Signal_Impl
 {
 public:
-	~Slot_Impl() { if (callback) callback->valid = false; }
+	Signal_Impl() : first(0), last(0), invoke_depth(0), remove_pending(false), destroyed(false) { return; }
+
+	~Signal_Impl()
+	{
+		while (first)
+			unlink(first);
+	}
+
+	static void destroy(Signal_Impl *impl)
+	{
+		if (impl->invoke_depth > 0)
+			impl->destroyed = true;
+		else
+			delete impl;
+	}
+
+	void add(SlotCallback *callback)
+	{
+		callback->signal = this;
+		callback->prev = last;
+		callback->next = 0;
+		if (last)
+			last->next = callback;
+		else
+			first = callback;
+		last = callback;
+	}
+
+	void remove(SlotCallback *callback)
+	{
+		if (invoke_depth > 0)
+			remove_pending = true;
+		else
+			unlink(callback);
+	}
+
+	void begin_invoke()
+	{
+		invoke_depth++;
+	}
+
+	void end_invoke()
+	{
+		if (--invoke_depth == 0)
+		{
+			if (destroyed)
+			{
+				delete this;
+			}
+			else if (remove_pending)
+			{
+				remove_pending = false;
+				SlotCallback *callback = first;
+				while (callback)
+				{
+					SlotCallback *next = callback->next;
+					if (!callback->valid)
+						unlink(callback);
+					callback = next;
+				}
+			}
+		}
+	}
 
-	std::shared_ptr<SlotCallback> callback;
+	SlotCallback *first;
+
+	SlotCallback *last;
+
+	int invoke_depth;
+
+	bool remove_pending;
+
+	bool destroyed;
+
+private:
+	Signal_Impl(const Signal_Impl &);
+	Signal_Impl &operator =(const Signal_Impl &);
+
+	void unlink(SlotCallback *callback)
+	{
+		if (callback->prev)
+			callback->prev->next = callback->next;
+		else
+			first = callback->next;
+		if (callback->next)
+			callback->next->prev = callback->prev;
+		else
+			last = callback->prev;
+		callback->signal = 0;
+		callback->prev = 0;
+		callback->next = 0;
+		callback->release();
+	}
 };
 
+inline void SlotCallback::disconnect()
+{
+	valid = false;
+	if (signal)
+		signal->remove(this);
+}
+
 /// (Internal ClanLib Class)
-class CL_API_CORE Signal_Impl
+///
+/// Marks a signal as being invoked for the lifetime of the guard, also when a callback throws.
+/// Slots connected after the guard was created are not called by that invoke.
+class SignalInvokeGuard
 {
 public:
-	std::vector< std::shared_ptr<SlotCallback> > connected_slots;
+	SignalInvokeGuard(Signal_Impl *signal) : signal(signal), last(signal->last) { signal->begin_invoke(); }
+
+	~SignalInvokeGuard() { signal->end_invoke(); }
+
+	Signal_Impl *signal;
+
+	SlotCallback *last;
+
+private:
+	SignalInvokeGuard(const SignalInvokeGuard &);
+	SignalInvokeGuard &operator =(const SignalInvokeGuard &);
 };
 
 }
+
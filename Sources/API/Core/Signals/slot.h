@@ -45,10 +45,26 @@ class CL_API_CORE Slot
 
 public:
 	Slot()
-	{ return; }
+	: callback(0) { return; }
 
-	Slot(const std::shared_ptr<SlotCallback> &callback)
-	: impl(new Slot_Impl) { impl->callback = callback; }
+	Slot(SlotCallback *callback)
+	: callback(callback) { attach(); }
+
+	Slot(const Slot &copy)
+	: callback(copy.callback) { attach(); }
+
+	~Slot() { detach(); }
+
+	Slot &operator =(const Slot &copy)
+	{
+		if (callback != copy.callback)
+		{
+			detach();
+			callback = copy.callback;
+			attach();
+		}
+		return *this;
+	}
 
 
 /// \}
@@ -58,20 +74,20 @@ public:
 public:
 	void destroy()
 	{
-		if (impl && impl->callback)
-			impl->callback->valid = false;
+		if (callback)
+			callback->disconnect();
 	}
 
 	void enable()
 	{
-		if (impl && impl->callback)
-			impl->callback->enabled = true;
+		if (callback)
+			callback->enabled = true;
 	}
 
 	void disable()
 	{
-		if (impl && impl->callback)
-			impl->callback->enabled = false;
+		if (callback)
+			callback->enabled = false;
 	}
 
 
@@ -79,8 +95,28 @@ public:
 /// \name Implementation
 /// \{
 
-public:
-	std::shared_ptr<Slot_Impl> impl;
+private:
+	void attach()
+	{
+		if (callback)
+		{
+			callback->add_ref();
+			callback->slot_count++;
+		}
+	}
+
+	void detach()
+	{
+		if (callback)
+		{
+			if (--callback->slot_count == 0)
+				callback->disconnect();
+			callback->release();
+			callback = 0;
+		}
+	}
+
+	SlotCallback *callback;
 /// \}
 };
 
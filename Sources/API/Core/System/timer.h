@@ -36,6 +36,7 @@ namespace clan
 
 class Timer_Impl;
 class Callback_v0;
+class WorkQueue;
 
 /// \brief Timer class that invokes a callback on a specified interval
 class CL_API_CORE Timer
@@ -71,6 +72,9 @@ public:
 
 	/// \brief Stop the timer.
 	void stop();
+
+	/// \brief Invoke func_expired on a worker thread of the work queue instead of from KeepAlive::process
+	void set_work_queue(const WorkQueue &queue);
 /// \}
 
 /// \name Implementation
@@ -57,11 +57,19 @@ class CL_API_CORE WorkQueue
 {
 public:
 	/// \brief Constructs a work queue
-	WorkQueue();
+	///
+	/// \param max_threads = Number of worker threads to start. Zero uses one less than the number of cores.
+	WorkQueue(int max_threads = 0);
 	~WorkQueue();
 
+	/// \brief Returns the number of worker threads used by the queue
+	int get_thread_count() const;
+
 	void queue(WorkItem *item); // transfers ownership
 
+	/// \brief Blocks until all queued work has been processed and then completes it on the calling thread
+	void finish();
+
 private:
 	std::shared_ptr<WorkQueue_Impl> impl;
 };
@@ -63,14 +63,20 @@ public:
 
 public:
 	/// \brief Log text to file.
+	///
+	/// The text is collected in memory until flush() is called or 64 KB have been collected.
 	void log(const std::string &type, const std::string &text);
 
+	/// \brief Writes the collected text to the file.
+	void flush();
+
 /// \}
 /// \name Implementation
 /// \{
 
 private:
 	File *file;
+	std::string buffer;
 /// \}
 };
 
@@ -0,0 +1,115 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "../api_core.h"
+#include <memory>
+
+namespace clan
+{
+/// \addtogroup clanCore_Text clanCore Text
+/// \{
+
+class LogQueue_Impl;
+
+/// \brief Moves logging to a background writer thread.
+///
+/// While a LogQueue exists, log_event stores the event in a fixed size lock-free queue and returns.
+/// The writer thread formats the queued events and passes them to the enabled loggers in batches,
+/// calling Logger::flush() after each batch. Loggers add the time when the event is written, which can
+/// be up to the flush interval after log_event was called.
+///
+/// Only one LogQueue can exist at a time. Destroy it after the threads that log have stopped.
+class CL_API_CORE LogQueue
+{
+/// \name Construction
+/// \{
+
+public:
+	/// \brief What log_event does when the queue is full
+	enum FullPolicy
+	{
+		/// \brief The event is discarded and counted by get_dropped_count()
+		drop_event,
+
+		/// \brief The calling thread waits until the writer thread has made room
+		wait_for_space
+	};
+
+	/// \brief Constructs a log queue and starts its writer thread.
+	///
+	/// \param capacity = Number of events the queue can hold. Rounded up to a power of two
+	/// \param policy = What to do when the queue is full
+	/// \param flush_interval = Longest time (ms) an event waits in the queue before the writer thread picks it up
+	LogQueue(int capacity = 8192, FullPolicy policy = drop_event, int flush_interval = 50);
+
+	/// \brief Writes the remaining events and returns log_event to logging on the calling thread.
+	~LogQueue();
+
+/// \}
+/// \name Attributes
+/// \{
+
+public:
+	/// \brief Returns the number of events the queue can hold.
+	int get_capacity() const;
+
+	/// \brief Returns the number of events accepted by the queue.
+	int get_queued_count() const;
+
+	/// \brief Returns the number of events passed to the loggers.
+	int get_written_count() const;
+
+	/// \brief Returns the number of events discarded because the queue was full.
+	int get_dropped_count() const;
+
+	/// \brief Returns the number of batches written.
+	int get_batch_count() const;
+
+/// \}
+/// \name Operations
+/// \{
+
+public:
+	/// \brief Blocks until the events queued before this call have been written.
+	void flush();
+
+/// \}
+/// \name Implementation
+/// \{
+
+private:
+	std::shared_ptr<LogQueue_Impl> impl;
+/// \}
+};
+
+}
+
+/// \}
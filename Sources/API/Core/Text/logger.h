@@ -33,6 +33,7 @@
 #include "string_format.h"
 #include "string_help.h"
 #include "../System/mutex.h"
+#include "../System/exception.h"
 
 namespace clan
 {
@@ -76,45 +77,156 @@ public:
 	/// \brief Log text.
 	virtual void log(const std::string &type, const std::string &text);
 
+	/// \brief Writes out text buffered by log().
+	///
+	/// log_event calls this after every event, or after every batch of events when a LogQueue is active.
+	virtual void flush() { }
+
+/// \}
+/// \name Implementation
+/// \{
+
+protected:
+	/// \brief Returns a log line with the current UTC time, such as "Tue Nov 16 11:34:15 2004 UTC [type] text", including the line break.
+	static std::string get_log_line(const std::string &type, const std::string &text);
+
+/// \}
+};
+
+/// \brief Format string and arguments of a log event, not yet formatted.
+///
+/// The log_event templates use this so that formatting can be left to the LogQueue writer thread.
+/// String arguments are kept as pointers, so the object must not outlive its arguments.
+class CL_API_CORE LogEventFormat
+{
+/// \name Construction
+/// \{
+
+public:
+	LogEventFormat(const std::string &format) : format(format), num_args(0) { }
+
+/// \}
+/// \name Attributes
+/// \{
+
+public:
+	enum ArgType
+	{
+		arg_text,
+		arg_c_text,
+		arg_int,
+		arg_uint,
+		arg_ulong,
+		arg_longlong,
+		arg_ulonglong,
+		arg_float,
+		arg_double
+	};
+
+	struct Arg
+	{
+		ArgType type;
+		union
+		{
+			const std::string *text;
+			const char *c_text;
+			long long int_value;
+			unsigned long long uint_value;
+			double double_value;
+		};
+	};
+
+	enum { max_args = 7 };
+
+	const std::string &get_format() const { return format; }
+
+	/// \brief Returns the number of arguments, which is the highest index set.
+	int get_num_args() const { return num_args; }
+
+	/// \brief Returns the argument with the given index, starting at 1.
+	const Arg &get_arg(int index) const { return args[index - 1]; }
+
+	/// \brief Formats the text. Arguments not set are left as they are in the format string.
+	std::string get_result() const { return format_text(format, num_args, args); }
+
+	/// \brief Formats a format string with the given arguments.
+	static std::string format_text(const std::string &format, int num_args, const Arg *args);
+
+/// \}
+/// \name Operations
+/// \{
+
+public:
+	void set_arg(int index, const std::string &text) { Arg &arg = create_arg(index, arg_text); arg.text = &text; }
+	void set_arg(int index, const char *text) { Arg &arg = create_arg(index, arg_c_text); arg.c_text = text; }
+	void set_arg(int index, int value) { Arg &arg = create_arg(index, arg_int); arg.int_value = value; }
+	void set_arg(int index, unsigned int value) { Arg &arg = create_arg(index, arg_uint); arg.uint_value = value; }
+	void set_arg(int index, long unsigned int value) { Arg &arg = create_arg(index, arg_ulong); arg.uint_value = value; }
+	void set_arg(int index, long long value) { Arg &arg = create_arg(index, arg_longlong); arg.int_value = value; }
+	void set_arg(int index, unsigned long long value) { Arg &arg = create_arg(index, arg_ulonglong); arg.uint_value = value; }
+	void set_arg(int index, float value) { Arg &arg = create_arg(index, arg_float); arg.double_value = value; }
+	void set_arg(int index, double value) { Arg &arg = create_arg(index, arg_double); arg.double_value = value; }
+
 /// \}
 /// \name Implementation
 /// \{
 
 private:
+	Arg &create_arg(int index, ArgType type)
+	{
+		if (index < 1 || index > max_args)
+			throw Exception("Log event argument index out of range");
+		while (num_args < index)
+		{
+			args[num_args].type = arg_c_text;
+			args[num_args].c_text = 0;
+			num_args++;
+		}
+		args[index - 1].type = type;
+		return args[index - 1];
+	}
+
+	const std::string &format;
+	int num_args;
+	Arg args[max_args];
 /// \}
 };
 
 /// \brief Log text to logger.
 ///
+/// While a LogQueue exists the event is queued for its writer thread instead.
 CL_API_CORE void log_event(const std::string &type, const std::string &text);
 
+/// \brief Log text to logger, formatting it when the loggers are called.
+CL_API_CORE void log_event(const std::string &type, const LogEventFormat &format);
+
 template <class Arg1>
 void log_event(const std::string &type, const std::string &format, Arg1 arg1)
-{ StringFormat f(format); f.set_arg(1, arg1); log_event(type, f.get_result()); }
+{ LogEventFormat f(format); f.set_arg(1, arg1); log_event(type, f); }
 
 template <class Arg1, class Arg2>
 void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2)
-{ StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); log_event(type, f.get_result()); }
+{ LogEventFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); log_event(type, f); }
 
 template <class Arg1, class Arg2, class Arg3>
 void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3)
-{ StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); log_event(type, f.get_result()); }
+{ LogEventFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); log_event(type, f); }
 
 template <class Arg1, class Arg2, class Arg3, class Arg4>
 void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4)
-{ StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); log_event(type, f.get_result()); }
+{ LogEventFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); log_event(type, f); }
 
 template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5>
 void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5)
-{ StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); f.set_arg(5, arg5); log_event(type, f.get_result()); }
+{ LogEventFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); f.set_arg(5, arg5); log_event(type, f); }
 
 template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5, class Arg6>
 void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6)
-{ StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); f.set_arg(5, arg5); f.set_arg(6, arg6); log_event(type, f.get_result()); }
+{ LogEventFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); f.set_arg(5, arg5); f.set_arg(6, arg6); log_event(type, f); }
 
 template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5, class Arg6, class Arg7>
 void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6, Arg7 arg7)
-{ StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); f.set_arg(5, arg5); f.set_arg(6, arg6); f.set_arg(7, arg7); log_event(type, f.get_result()); }
+{ LogEventFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); f.set_arg(5, arg5); f.set_arg(6, arg6); f.set_arg(7, arg7); log_event(type, f); }
 
 }
 
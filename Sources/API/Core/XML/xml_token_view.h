@@ -0,0 +1,150 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "../api_core.h"
+#include "xml_token.h"
+#include <vector>
+#include <utility>
+#include <string>
+
+namespace clan
+{
+/// \addtogroup clanCore_XML clanCore XML
+/// \{
+
+/// \brief Range of characters inside the buffer of a XMLTokenizer.
+///
+/// The view is only valid until the next call to XMLTokenizer::next. Entities
+/// (&amp;lt; etc.) are not decoded until the text is converted to a string.
+class CL_API_CORE XMLStringView
+{
+/// \name Construction
+/// \{
+
+public:
+	XMLStringView() : data(0), length(0), escaped(false)
+	{
+	}
+
+	XMLStringView(const char *data, std::string::size_type length, bool escaped) : data(data), length(length), escaped(escaped)
+	{
+	}
+
+/// \}
+/// \name Attributes
+/// \{
+
+public:
+	/// \brief First character of the range.
+	const char *data;
+
+	/// \brief Number of characters in the range.
+	std::string::size_type length;
+
+	/// \brief True if the range contains entities that must be decoded.
+	bool escaped;
+
+	/// \brief Returns true if the range is empty.
+	bool empty() const { return length == 0; }
+
+	/// \brief Returns true if the undecoded range equals the string.
+	bool equals(const char *str) const;
+
+	/// \brief Returns true if the undecoded range equals the string.
+	bool equals(const std::string &str) const { return str.length() == length && (length == 0 || str.compare(0, length, data, length) == 0); }
+
+	/// \brief Returns the undecoded characters.
+	std::string get_raw() const { return std::string(data, length); }
+
+	/// \brief Returns the characters with entities decoded.
+	std::string to_string() const;
+
+/// \}
+/// \name Operations
+/// \{
+
+public:
+	/// \brief Decodes the characters into an existing string, reusing its memory.
+	void to_string(std::string &out_text) const;
+
+/// \}
+};
+
+/// \brief XML token pointing into the buffer of a XMLTokenizer.
+///
+/// This is the allocation free counterpart of XMLToken. The views are only
+/// valid until the next call to XMLTokenizer::next.
+class CL_API_CORE XMLTokenView
+{
+/// \name Construction
+/// \{
+
+public:
+	XMLTokenView() : type(XMLToken::NULL_TOKEN), variant(XMLToken::SINGLE)
+	{
+	}
+
+/// \}
+/// \name Attributes
+/// \{
+
+public:
+	// Attribute name/value pair.
+	typedef std::pair<XMLStringView, XMLStringView> Attribute;
+
+	/// \brief The token type.
+	XMLToken::TokenType type;
+
+	/// \brief The token variant.
+	XMLToken::TokenVariant variant;
+
+	/// \brief The name of the token.
+	XMLStringView name;
+
+	/// \brief The value of the token.
+	XMLStringView value;
+
+	/// \brief All the attributes attached to the token.
+	std::vector<Attribute> attributes;
+
+/// \}
+/// \name Operations
+/// \{
+
+public:
+	/// \brief Copies the token into a XMLToken, decoding all entities.
+	void to_token(XMLToken &out_token) const;
+
+/// \}
+};
+
+}
+
+/// \}
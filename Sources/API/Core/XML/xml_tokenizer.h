@@ -39,9 +39,13 @@ namespace clan
 
 class IODevice;
 class XMLToken;
+class XMLTokenView;
 class XMLTokenizer_Impl;
 
 /// \brief The XML Tokenizer breaks a XML file into XML tokens.
+///
+/// The input is read in chunks as the tokens are requested, so memory use is
+/// bounded by the buffer size and the largest single token in the file.
 class CL_API_CORE XMLTokenizer
 {
 /// \name Construction
@@ -60,6 +64,12 @@ public:
 	/// \param input = IODevice
 	XMLTokenizer(IODevice &input);
 
+	/// \brief Constructs a XMLTokenizer
+	///
+	/// \param input = IODevice
+	/// \param buffer_size = Number of bytes read from the input at a time
+	XMLTokenizer(IODevice &input, int buffer_size);
+
 	virtual ~XMLTokenizer();
 
 /// \}
@@ -86,6 +96,12 @@ public:
 	/// \param out_token = XMLToken
 	void next(XMLToken *out_token);
 
+	/// \brief Returns the next token as views into the tokenizer buffer.
+	///
+	/// The views stay valid until the next call to next(). Entities are only
+	/// decoded if the caller converts a view to a string.
+	void next(XMLTokenView *out_token);
+
 /// \}
 /// \name Implementation
 /// \{
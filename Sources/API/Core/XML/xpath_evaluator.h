@@ -38,6 +38,7 @@ namespace clan
 /// \{
 
 class DomNode;
+class CompiledXPath;
 class XPathEvaluator_Impl;
 
 /// \brief XPath evaluator.
@@ -63,6 +64,25 @@ public:
 	/// \return XPath Object
 	XPathObject evaluate(const std::string &expression, const DomNode &context_node) const;
 
+	/// \brief Evaluate a compiled expression
+	///
+	/// \param expression = Compiled XPath expression
+	/// \param context_node = Dom Node
+	///
+	/// \return XPath Object
+	XPathObject evaluate(const CompiledXPath &expression, const DomNode &context_node) const;
+
+	/// \brief Returns the compiled form of an expression
+	///
+	/// Recently used expressions are kept in a cache shared by all evaluators, so
+	/// repeated queries with the same expression text are only compiled once.
+	static CompiledXPath compile(const std::string &expression);
+
+	/// \brief Sets how many compiled expressions the cache keeps (default is 64)
+	///
+	/// A size of 0 disables the cache.
+	static void set_cache_size(unsigned int max_expressions);
+
 /// \}
 /// \name Implementation
 /// \{
@@ -34,6 +34,7 @@
 
 #include "../api_display.h"
 #include "../Render/graphic_context.h"
+#include "canvas_batch_statistics.h"
 
 namespace clan
 {
@@ -46,6 +47,7 @@ class PrimitivesArray;
 class Sprite_Impl;
 class Image;
 class GlyphCache;
+class CanvasCommandList;
 class Draw;
 class RenderBatcher;
 class Colorf;
@@ -91,6 +93,16 @@ public:
 	/// \brief Create a copy of a canvas
 	Canvas create();
 
+	/// \brief Creates a canvas for recording command lists on a worker thread
+	///
+	/// The worker canvas has its own render batchers and vertex storage. It can only be drawn on between
+	/// CanvasCommandList::begin() and end(), which never touch the graphic context, so one worker canvas per
+	/// thread can record at the same time. Draw the recorded lists on this canvas in the order they should appear.
+	///
+	/// Create worker canvases on the thread owning this canvas. Text is not safe to record on a worker canvas,
+	/// as drawing new glyphs uploads them to the glyph cache textures.
+	Canvas create_worker();
+
 	/// \brief Returns true if this object is invalid.
 	bool is_null() const { return !impl; }
 
@@ -128,6 +140,12 @@ public:
 	/// \brief Return the content of the read buffer into a pixel buffer.
 	PixelBuffer get_pixeldata(TextureFormat texture_format = tf_rgba8, bool clamp = true);
 
+	/// \brief Returns true if draw calls are recorded and sorted before they are drawn
+	bool is_deferred_batching() const;
+
+	/// \brief Returns the draw call counters collected in deferred batching mode
+	CanvasBatchStatistics get_batch_statistics() const;
+
 /// \}
 /// \name Operations
 /// \{
@@ -273,6 +291,16 @@ public:
 	/// \brief Flushes the render batcher currently active.
 	void flush();
 
+	/// \brief Enables or disables deferred batching
+	///
+	/// In deferred mode draw calls are recorded until the canvas is flushed. They are then grouped by
+	/// batcher and texture into as few batches as possible, while draws that overlap keep their order.
+	/// The mode is shared by all canvases created from this canvas.
+	void set_deferred_batching(bool enable);
+
+	/// \brief Resets the deferred batching draw call counters
+	void reset_batch_statistics();
+
 	/// \brief Draw a point.
 	void draw_point(float x1, float y1, const Colorf &color);
 
@@ -479,6 +507,7 @@ private:
 	friend class Sprite_Impl;
 	friend class Image;
 	friend class GlyphCache;
+	friend class CanvasCommandList;
 /// \}
 };
 
@@ -0,0 +1,62 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "../api_display.h"
+#include "../../Core/System/cl_platform.h"
+
+namespace clan
+{
+/// \addtogroup clanDisplay_Display clanDisplay Display
+/// \{
+
+/// \brief Draw call counters for a canvas in deferred batching mode
+///
+/// The counters are shared by all canvases sharing the same render batchers.
+class CanvasBatchStatistics
+{
+public:
+	CanvasBatchStatistics() : draws_recorded(0), lists_submitted(0), batches_in_draw_order(0), batches_submitted(0) { }
+
+	/// \brief Number of draw calls recorded into the deferred draw list
+	ubyte64 draws_recorded;
+
+	/// \brief Number of times the deferred draw list was sorted and submitted
+	ubyte64 lists_submitted;
+
+	/// \brief Number of batches the recorded draws would have needed when submitted in the order they were drawn
+	ubyte64 batches_in_draw_order;
+
+	/// \brief Number of batches submitted to the graphic context after sorting
+	ubyte64 batches_submitted;
+};
+
+}
+
+/// \}
@@ -0,0 +1,113 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "../api_display.h"
+#include <memory>
+
+namespace clan
+{
+/// \addtogroup clanDisplay_2D clanDisplay 2D
+/// \{
+
+class Canvas;
+class CanvasCommandList_Impl;
+
+/// \brief Retained list of canvas draw calls
+///
+/// Everything drawn on a canvas between begin() and end() is tessellated and transformed once and kept
+/// in vertex buffers. Drawing the list replays it relative to the canvas transform in effect when it was
+/// recorded, so a list recorded at the origin can be moved around with the modelview matrix.
+///
+/// Only geometry is recorded. Clip rectangles, blend states and other render state changes made while
+/// recording are applied to the canvas as usual but are not part of the list.
+class CL_API_DISPLAY CanvasCommandList
+{
+/// \name Construction
+/// \{
+public:
+	/// \brief Constructs a null instance.
+	CanvasCommandList();
+
+	/// \brief Constructs an empty command list to be recorded on the canvas
+	///
+	/// The list can be drawn on any canvas using the same graphic context. A list recorded on a worker canvas
+	/// (see Canvas::create_worker) can be recorded on another thread and drawn on the main canvas afterwards.
+	explicit CanvasCommandList(Canvas &canvas);
+
+	~CanvasCommandList();
+
+/// \}
+/// \name Attributes
+/// \{
+public:
+	/// \brief Returns true if this object is invalid.
+	bool is_null() const { return !impl; }
+
+	/// \brief Throw an exception if this object is invalid.
+	void throw_if_null() const;
+
+	/// \brief Returns true between begin() and end()
+	bool is_recording() const;
+
+	/// \brief Returns true if the list has been recorded and not invalidated since
+	bool is_recorded() const;
+
+	/// \brief Returns the number of batches needed to draw the list
+	int get_batch_count() const;
+
+/// \}
+/// \name Operations
+/// \{
+public:
+	/// \brief Starts recording all draw calls made on the canvas, replacing the previous contents
+	void begin(Canvas &canvas);
+
+	/// \brief Stops recording
+	void end(Canvas &canvas);
+
+	/// \brief Draws the recorded list using the current canvas transform
+	void draw(Canvas &canvas);
+
+	/// \brief Discards the recorded contents
+	///
+	/// A list is never updated automatically. Call this (or begin() again) when what it shows has changed.
+	void invalidate();
+
+/// \}
+/// \name Implementation
+/// \{
+private:
+	std::shared_ptr<CanvasCommandList_Impl> impl;
+/// \}
+};
+
+}
+
+/// \}
@@ -49,6 +49,7 @@ enum ListViewDisplayMode
 #include "listview_selected_item.h"
 #include "listview_column_header.h"
 #include "listview_icon_list.h"
+#include "listview_data_provider.h"
 
 namespace clan
 {
@@ -134,6 +135,12 @@ public:
 	/// \return display_mode
 	ListViewDisplayMode get_display_mode() const;
 
+	/// \brief Returns the data provider, or a null pointer if the list view is not in virtual mode
+	std::shared_ptr<ListViewDataProvider> get_data_provider() const;
+
+	/// \brief Returns the selected row in virtual mode, or -1 if no row is selected
+	int get_selected_row() const;
+
 /// \}
 /// \name Operations
 /// \{
@@ -193,6 +200,36 @@ public:
 	/// \brief Returns a ListViewItem with the userdata 'ptr', or a NULL item if none found.
 	ListViewItem find(std::shared_ptr<ListViewItemUserData> userdata, bool recursive=true);
 
+	/// \brief Switches the list view to virtual mode
+	///
+	/// In virtual mode the rows are fetched from the data provider when they are shown,
+	/// so the cost of layout and painting only depends on the number of visible rows.
+	/// Virtual mode requires listview_mode_details. Pass a null provider to leave virtual mode.
+	///
+	/// \param provider = Data provider
+	/// \param variable_row_heights = When true, ListViewDataProvider::get_row_height() is called for every row
+	void set_data_provider(const std::shared_ptr<ListViewDataProvider> &provider, bool variable_row_heights = false);
+
+	/// \brief Tells the list view that the row count or the contents of the data provider has changed
+	void data_changed();
+
+	/// \brief Tells the list view that the contents of a range of rows has changed
+	///
+	/// Only the heights of the rows in the range are fetched again. Use data_changed() if the row count changed.
+	///
+	/// \param first_row = First changed row
+	/// \param count = Number of changed rows
+	void data_changed(int first_row, int count);
+
+	/// \brief Tells the list view that the height of a row has changed
+	void row_height_changed(int row);
+
+	/// \brief Selects a row in virtual mode. Pass -1 to clear the selection.
+	void set_selected_row(int row);
+
+	/// \brief Scrolls the list view until the row is visible
+	void scroll_to_row(int row);
+
 /// \}
 /// \name Events
 /// \{
@@ -225,6 +262,12 @@ public:
 	/// \brief Callback called when the user begins a drag'n'drop action
 	Callback_v0 &func_begin_drag();
 
+	/// \brief Invoked when the selected row changes in virtual mode
+	Callback_v1<int> &func_row_selection_changed();
+
+	/// \brief Invoked on double clicking a row in virtual mode
+	Callback_v1<int> &func_row_doubleclick();
+
 /// \}
 /// \name Implementation
 /// \{
@@ -0,0 +1,69 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "../api_gui.h"
+#include <string>
+
+namespace clan
+{
+/// \addtogroup clanGUI_Components clanGUI Components
+/// \{
+
+/// \brief Supplies the rows of a ListView in virtual mode.
+///
+/// In virtual mode the ListView creates no ListViewItem objects. It only asks the
+/// data provider for the rows that are currently visible.
+class ListViewDataProvider
+{
+public:
+	virtual ~ListViewDataProvider() { }
+
+	/// \brief Returns the number of rows
+	virtual int get_row_count() = 0;
+
+	/// \brief Returns the text of a cell
+	///
+	/// \param row = Row index
+	/// \param column_id = Column ID, as passed to ListViewHeader::create_column()
+	virtual std::string get_cell_text(int row, const std::string &column_id) = 0;
+
+	/// \brief Returns the icon of a row, as an index into the ListView icon list. Zero means no icon.
+	virtual int get_icon(int row) { return 0; }
+
+	/// \brief Returns the height of a row in pixels. Zero uses the row height of the theme.
+	///
+	/// This is only called when ListView::set_data_provider() is called with variable_row_heights set.
+	virtual int get_row_height(int row) { return 0; }
+};
+
+}
+
+/// \}
@@ -339,6 +339,9 @@ public:
 	/// \brief Enabled whether the GUI will constantly repaint this component when there are no other messages to process
 	bool get_constant_repaint() const;
 
+	/// \brief Returns true if this component and its children are rendered through a cached layer
+	bool get_cached_layer() const;
+
 	/// \brief Gets the font
 	Font get_font() const;
 
@@ -524,6 +527,8 @@ public:
 	void set_selected_in_component_group(bool selected);
 
 	/// \brief Create child components from a GUI definition file.
+	///
+	/// Files and devices may contain either GUI XML or the output of compile_components.
 	void create_components(const DomDocument &gui_xml);
 
 	/// \brief Create components
@@ -542,6 +547,12 @@ public:
 	/// \param dir = Virtual Directory
 	void create_components(const std::string &filename, const FileSystem &fs);
 
+	/// \brief Compiles a GUI definition into a binary form that create_components loads without parsing XML
+	///
+	/// \param gui_xml = GUI XML document
+	/// \param output = Device receiving the compiled definition
+	static void compile_components(const DomDocument &gui_xml, IODevice &output);
+
 	// Request an asynchronous redraw of the specified area.
 	void request_repaint();
 
@@ -599,6 +610,12 @@ public:
 	/// \brief Enabled whether the GUI will constantly repaint this component when there are no other messages to process
 	void set_constant_repaint(bool enable);
 
+	/// \brief Render this component and its children to an offscreen texture that is reused until one of them requests a repaint
+	///
+	/// Intended for static parts of a window, such as toolbars and frames. Each cached layer uses a texture
+	/// the size of the component, and children outside the component are clipped.
+	void set_cached_layer(bool enable);
+
 	Rect render_text_span(Canvas &canvas, const std::string &text, const Rect &content_rect);
 	Rect render_text(Canvas &canvas, const std::string &text);
 	Rect render_text(Canvas &canvas, const std::string &text, int xpos, int baseline);
@@ -38,6 +38,8 @@
 #include "../Core/Signals/signal_v1.h"
 #include "../Core/Math/point.h"
 #include "accelerator_table.h"
+#include "gui_paint_statistics.h"
+#include "gui_profile_entry.h"
 #include <memory>
 
 namespace clan
@@ -81,18 +83,24 @@ public:
 	/// \brief Fully constructs a gui manager with a system window manager, a css theme and resources.
 	///
 	/// \param path_to_theme = Path to theme directory. It has to contain resources.xml and theme.css.
+	///
+	/// If the directory also contains theme.cssc, a compiled version of theme.css, it is loaded instead.
 	GUIManager(const std::string &path_to_theme);
 
 	/// \brief Fully constructs a gui manager with a texture window manager, a css theme and resources.
 	///
 	/// \param display_window = display window to attach gui to.
 	/// \param path_to_theme = Path to theme directory. It has to contain resources.xml and theme.css.
+	///
+	/// If the directory also contains theme.cssc, a compiled version of theme.css, it is loaded instead.
 	GUIManager(const DisplayWindow &display_window, const std::string &path_to_theme);
 
 	/// \brief Fully constructs a gui manager with a custom window manager, a css theme and resources.
 	///
 	/// \param window_manager = Window manager
 	/// \param path_to_theme = Path to theme directory. It has to contain resources.xml and theme.css.
+	///
+	/// If the directory also contains theme.cssc, a compiled version of theme.css, it is loaded instead.
 	GUIManager(GUIWindowManager &window_manager, const std::string &path_to_theme);
 
 	/// \brief Constructs a GUIManager
@@ -132,6 +140,18 @@ public:
 	/// \return clipboard_text
 	std::string get_clipboard_text() const;
 
+	/// \brief Returns the paint statistics collected since the last call to reset_paint_statistics()
+	GUIPaintStatistics get_paint_statistics() const;
+
+	/// \brief Returns true if pointer move and resize messages are coalesced
+	bool is_message_coalescing_enabled() const;
+
+	/// \brief Returns true if the profiler is recording
+	bool is_profiling_enabled() const;
+
+	/// \brief Returns the time spent per component since the last call to reset_profile(), most expensive first
+	std::vector<GUIProfileEntry> get_profile() const;
+
 /// \}
 /// \name Events
 /// \{
@@ -148,6 +168,8 @@ public:
 public:
 	/// \brief Adds a GUI theme directory.
 	/// \param path_to_theme = Path to theme directory. It has to contain resources.xml and theme.css.
+	///
+	/// If the directory also contains theme.cssc, a compiled version of theme.css, it is loaded instead.
 	void add_theme(const std::string &path_to_theme);
 
 	/// \brief Sets the CSS document.
@@ -209,6 +231,36 @@ public:
 	/// \brief Set the accelerator table.
 	void set_accelerator_table(const AcceleratorTable &table);
 
+	/// \brief Resolve the CSS styles of independent component subtrees on worker threads before layout
+	///
+	/// \param enable = Use worker threads for the styles
+	/// \param max_threads = Number of worker threads. Zero uses one less than the number of cores.
+	void set_parallel_style_resolution(bool enable, int max_threads = 0);
+
+	/// \brief Sets all paint statistics to zero
+	void reset_paint_statistics();
+
+	/// \brief Coalesce pointer move and resize messages until the next frame
+	///
+	/// When enabled, only the last pointer move and resize received for a window is delivered.
+	/// Pending messages are delivered by process_messages() and render_windows(), or before any
+	/// other message for the same window, so the order of events is kept.
+	void set_message_coalescing(bool enable);
+
+	/// \brief Delivers pointer move and resize messages held back by message coalescing
+	void flush_coalesced_messages();
+
+	/// \brief Records the time spent in message handlers, layout and render callbacks per component
+	void set_profiling_enabled(bool enable);
+
+	/// \brief Discards everything recorded by the profiler
+	void reset_profile();
+
+	/// \brief Writes the events recorded by the profiler to a file in the Chrome trace event format
+	///
+	/// The file can be inspected with chrome://tracing.
+	void write_profile_trace(const std::string &filename) const;
+
 /// \}
 /// \name Implementation
 /// \{
@@ -0,0 +1,71 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "api_gui.h"
+#include "../Core/System/cl_platform.h"
+
+namespace clan
+{
+/// \addtogroup clanGUI_System clanGUI System
+/// \{
+
+/// \brief Painting statistics collected by the GUI manager.
+class GUIPaintStatistics
+{
+/// \name Construction
+/// \{
+public:
+	GUIPaintStatistics() : paint_count(0), painted_pixels(0), paint_time(0), layer_hits(0), layer_updates(0) { }
+
+/// \}
+/// \name Attributes
+/// \{
+public:
+	/// \brief Number of update rectangles painted
+	int paint_count;
+
+	/// \brief Number of window pixels covered by the painted update rectangles
+	ubyte64 painted_pixels;
+
+	/// \brief Time spent painting, in microseconds
+	ubyte64 paint_time;
+
+	/// \brief Number of times a cached layer was drawn without rendering its components
+	int layer_hits;
+
+	/// \brief Number of times a cached layer had to be rendered again
+	int layer_updates;
+/// \}
+};
+
+}
+
+/// \}
@@ -0,0 +1,82 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "api_gui.h"
+#include "../Core/System/cl_platform.h"
+
+namespace clan
+{
+/// \addtogroup clanGUI_System clanGUI System
+/// \{
+
+/// \brief Time the GUI spent on behalf of a component while profiling was enabled.
+///
+/// Times are in microseconds and include any nested work, such as messages
+/// dispatched or layout done from within a message handler.
+class GUIProfileEntry
+{
+/// \name Construction
+/// \{
+public:
+	GUIProfileEntry() : message_count(0), message_time(0), layout_count(0), layout_time(0), render_count(0), render_time(0) { }
+
+/// \}
+/// \name Attributes
+/// \{
+public:
+	/// \brief Tag name of the component, followed by #id if it has an id
+	std::string component;
+
+	/// \brief Number of messages delivered to the component
+	int message_count;
+
+	/// \brief Time spent in the message handlers of the component
+	ubyte64 message_time;
+
+	/// \brief Number of times the content of the component was laid out or its resized callback invoked
+	int layout_count;
+
+	/// \brief Time spent laying out the component
+	ubyte64 layout_time;
+
+	/// \brief Number of times the render callback of the component was invoked
+	int render_count;
+
+	/// \brief Time spent in the render callback of the component
+	ubyte64 render_time;
+
+	/// \brief Total time spent on behalf of the component
+	ubyte64 get_total_time() const { return message_time + layout_time + render_time; }
+/// \}
+};
+
+}
+
+/// \}
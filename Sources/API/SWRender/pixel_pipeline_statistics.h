@@ -0,0 +1,133 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "api_swrender.h"
+#include "../Core/System/cl_platform.h"
+#include <string>
+#include <vector>
+
+namespace clan
+{
+/// \addtogroup clanSWRender_Display clanSWRender Display
+/// \{
+
+/// \brief Time spent by one pixel pipeline worker thread
+class PixelPipelineWorkerStatistics
+{
+public:
+	PixelPipelineWorkerStatistics() : busy_microseconds(0), wait_microseconds(0), commands_processed(0), wakeups(0) { }
+
+	/// \brief Time spent running commands
+	ubyte64 busy_microseconds;
+
+	/// \brief Time spent waiting for more commands
+	ubyte64 wait_microseconds;
+
+	/// \brief Number of commands run by this worker
+	ubyte64 commands_processed;
+
+	/// \brief Number of times the worker was woken up to process commands
+	ubyte64 wakeups;
+};
+
+/// \brief Execution time histogram for one type of pixel command
+///
+/// Only collected while command profiling is enabled.
+class PixelPipelineCommandStatistics
+{
+public:
+	PixelPipelineCommandStatistics() : count(0), total_microseconds(0) { }
+
+	enum { num_buckets = 32 };
+
+	/// \brief Class name of the command
+	std::string name;
+
+	/// \brief Number of times the command was run, summed over all workers
+	ubyte64 count;
+
+	/// \brief Time spent in the command, summed over all workers
+	ubyte64 total_microseconds;
+
+	/// \brief Run count per duration bucket
+	///
+	/// Bucket N counts runs that took between 2^N and 2^(N+1) nanoseconds.
+	std::vector<ubyte64> histogram;
+};
+
+/// \brief Pixel pipeline performance counters
+///
+/// Producer times are measured on the thread queueing the commands.
+class PixelPipelineStatistics
+{
+public:
+	PixelPipelineStatistics()
+	: elapsed_microseconds(0), queue_microseconds(0), set_event_microseconds(0), wait_for_space_microseconds(0),
+	  wait_for_workers_microseconds(0), alloc_microseconds(0), commands_queued(0), wait_for_space_stalls(0), allocated_blocks(0)
+	{
+	}
+
+	/// \brief Time since the pipeline was created or the statistics were last reset
+	ubyte64 elapsed_microseconds;
+
+	/// \brief Time spent inserting commands into the queue, including set_event_microseconds
+	ubyte64 queue_microseconds;
+
+	/// \brief Time spent waking up idle workers
+	ubyte64 set_event_microseconds;
+
+	/// \brief Time spent waiting for the workers to free up space in a full queue
+	ubyte64 wait_for_space_microseconds;
+
+	/// \brief Time spent waiting for the workers to finish all queued commands
+	ubyte64 wait_for_workers_microseconds;
+
+	/// \brief Time spent allocating and freeing command memory
+	ubyte64 alloc_microseconds;
+
+	/// \brief Number of commands queued
+	ubyte64 commands_queued;
+
+	/// \brief Number of times the queue was full when queueing a command
+	ubyte64 wait_for_space_stalls;
+
+	/// \brief Number of command memory blocks allocated
+	ubyte64 allocated_blocks;
+
+	/// \brief Per worker thread counters
+	std::vector<PixelPipelineWorkerStatistics> workers;
+
+	/// \brief Per command type histograms
+	std::vector<PixelPipelineCommandStatistics> commands;
+};
+
+}
+
+/// \}
@@ -53,6 +53,7 @@ public:
 	virtual int get_attribute_count() const = 0;
 	virtual int get_attribute_index(const std::string &name) const = 0;
 	virtual Vec4f get_attribute_default(int index) { return Vec4f(0.0f, 0.0f, 1.0f, 1.0f); }
+	virtual int get_uniform_location(const std::string &name) const { return 0; }
 	virtual void set_uniform(int location, const Vec4f &vec) = 0;
 	virtual void set_uniform_matrix(int location, const Mat4f &mat) = 0;
 
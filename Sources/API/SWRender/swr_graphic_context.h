@@ -30,7 +30,7 @@
 #pragma once
 
 #include "api_swrender.h"
-
+#include "pixel_pipeline_statistics.h"
 
 #include "../Display/Render/graphic_context.h"
 
@@ -67,6 +67,11 @@ public:
 	/// \brief Returns the pixel pipeline class needed to allocated PixelCommand objects.
 	PixelPipeline *get_pipeline() const;
 
+	/// \brief Returns the pixel pipeline performance counters collected since the last reset.
+	///
+	/// Waits for all queued commands to finish before reading the counters.
+	PixelPipelineStatistics get_pipeline_statistics() const;
+
 //!Operations
 public:
 	void draw_pixels(float x, float y, float zoom_x, float zoom_y, const PixelBuffer &pixel_buffer, const Rect &src_rect, const Colorf &color);
@@ -77,6 +82,20 @@ public:
 	void queue_command(T *command) { queue_command(std::unique_ptr<T>(command)); }
 	void queue_command(std::unique_ptr<PixelCommand> &command);
 
+	/// \brief Clears the pixel pipeline performance counters and the recorded trace
+	void reset_pipeline_statistics();
+
+	/// \brief Enables the per command type execution time histograms
+	///
+	/// This adds a timer read around every command run by the worker threads.
+	void set_pipeline_command_profiling(bool enable);
+
+	/// \brief Enables recording of producer stalls and worker activity for save_pipeline_trace
+	void set_pipeline_tracing(bool enable);
+
+	/// \brief Saves the recorded pipeline trace as a Chrome trace event JSON file (chrome://tracing)
+	void save_pipeline_trace(const std::string &filename);
+
 //!Implementation
 private:
 	std::shared_ptr<GraphicContext_SWRender_Impl> impl;
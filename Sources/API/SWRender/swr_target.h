@@ -59,6 +59,9 @@ public:
 	/// This may change after a display window has been created
 	static bool is_current();
 
+	/// \brief Returns the directory where compiled GLSL shaders are cached
+	static std::string get_shader_cache_path();
+
 /// \}
 /// \name Operations
 /// \{
@@ -67,6 +70,12 @@ public:
 	/// \brief Set this display target to be the current target
 	static void set_current();
 
+	/// \brief Sets the directory where compiled GLSL shaders are cached
+	///
+	/// Shaders found in the cache are not compiled again, which keeps application startup fast.
+	/// The cache is disabled by default. Setting an empty path disables it again.
+	static void set_shader_cache_path(const std::string &path);
+
 /// \}
 /// \name Implementation
 /// \{
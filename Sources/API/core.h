@@ -65,6 +65,7 @@
 #include "Core/Text/console.h"
 #include "Core/Text/console_logger.h"
 #include "Core/Text/logger.h"
+#include "Core/Text/log_queue.h"
 #include "Core/Text/string_format.h"
 #include "Core/Text/string_help.h"
 #include "Core/Text/utf8_reader.h"
@@ -124,6 +125,9 @@
 #include "Core/Resources/xml_resource_document.h"
 #include "Core/Resources/xml_resource_manager.h"
 #include "Core/JSON/json_value.h"
+#include "Core/JSON/json_reader.h"
+#include "Core/JSON/json_writer.h"
+#include "Core/JSON/json_document.h"
 #include "Core/XML/dom_processing_instruction.h"
 #include "Core/XML/dom_entity_reference.h"
 #include "Core/XML/dom_notation.h"
@@ -146,7 +150,9 @@
 #include "Core/XML/xml_tokenizer.h"
 #include "Core/XML/xml_writer.h"
 #include "Core/XML/xml_token.h"
+#include "Core/XML/xml_token_view.h"
 #include "Core/XML/xpath_evaluator.h"
+#include "Core/XML/compiled_xpath.h"
 #include "Core/XML/xpath_object.h"
 #include "Core/IOData/file.h"
 #include "Core/IOData/file_help.h"
@@ -162,6 +168,8 @@
 #include "Core/IOData/file_system_provider.h"
 #include "Core/IOData/directory_listing.h"
 #include "Core/IOData/iodevice_memory.h"
+#include "Core/IOData/iodevice_buffered.h"
+#include "Core/IOData/async_file_io.h"
 #include "Core/IOData/html_url.h"
 #include "Core/Zip/zip_archive.h"
 #include "Core/Zip/zip_writer.h"
@@ -40,6 +40,7 @@
 #include "CSSLayout/CSSDocument/css_document.h"
 #include "CSSLayout/CSSDocument/css_property.h"
 #include "CSSLayout/CSSDocument/css_select_node.h"
+#include "CSSLayout/CSSDocument/css_style_properties.h"
 #include "CSSLayout/CSSDocument/dom_select_node.h"
 #include "CSSLayout/ComputedValues/css_computed_values.h"
 #include "CSSLayout/ComputedValues/css_computed_box.h"
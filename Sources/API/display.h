@@ -43,6 +43,8 @@
 #include "Display/screen_info.h"
 #include "Display/Resources/display_cache.h"
 #include "Display/2D/canvas.h"
+#include "Display/2D/canvas_batch_statistics.h"
+#include "Display/2D/canvas_command_list.h"
 #include "Display/2D/color.h"
 #include "Display/2D/color_hsv.h"
 #include "Display/2D/color_hsl.h"
@@ -53,6 +53,8 @@
 #include "GUI/gui_message_close.h"
 #include "GUI/gui_message_pointer.h"
 #include "GUI/gui_manager.h"
+#include "GUI/gui_paint_statistics.h"
+#include "GUI/gui_profile_entry.h"
 #include "GUI/gui_window_manager.h"
 #include "GUI/gui_window_manager_system.h"
 #include "GUI/gui_window_manager_texture.h"
@@ -69,6 +71,7 @@
 #include "GUI/Components/listview.h"
 #include "GUI/Components/listview_header.h"
 #include "GUI/Components/listview_column_data.h"
+#include "GUI/Components/listview_data_provider.h"
 #include "GUI/Components/menubar.h"
 #include "GUI/Components/message_box.h"
 #include "GUI/Components/openfiledialog.h"
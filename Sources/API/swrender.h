@@ -40,6 +40,7 @@
 #include "SWRender/setup_swrender.h"
 #include "SWRender/swr_graphic_context.h"
 #include "SWRender/pixel_command.h"
+#include "SWRender/pixel_pipeline_statistics.h"
 #include "SWRender/pixel_thread_context.h"
 #include "SWRender/pixel_buffer_data.h"
 #include "SWRender/blit_argb8_sse.h"
@@ -0,0 +1,173 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "CSSLayout/precomp.h"
+#include "css_binary.h"
+#include <cstring>
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// CSSBinaryWriter Attributes:
+
+const char CSSBinaryWriter::magic[8] = { 'C', 'L', 'C', 'S', 'S', 'B', 'I', '1' };
+
+/////////////////////////////////////////////////////////////////////////////
+// CSSBinaryWriter Operations:
+
+void CSSBinaryWriter::write_uint8(unsigned char value)
+{
+	data.push_back((char)value);
+}
+
+void CSSBinaryWriter::write_uint(unsigned int value)
+{
+	append_uint(data, value);
+}
+
+void CSSBinaryWriter::write_string(const std::string &value)
+{
+	std::map<std::string, unsigned int>::iterator it = string_indexes.find(value);
+	if (it != string_indexes.end())
+	{
+		write_uint(it->second);
+	}
+	else
+	{
+		unsigned int index = strings.size();
+		strings.push_back(value);
+		string_indexes[value] = index;
+		write_uint(index);
+	}
+}
+
+void CSSBinaryWriter::save(IODevice &output)
+{
+	std::string header(magic, sizeof(magic));
+	append_uint(header, strings.size());
+	for (size_t i = 0; i < strings.size(); i++)
+	{
+		append_uint(header, strings[i].length());
+		header.append(strings[i]);
+	}
+	output.write(header.data(), header.length());
+	output.write(data.data(), data.length());
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CSSBinaryWriter Implementation:
+
+void CSSBinaryWriter::append_uint(std::string &buffer, unsigned int value)
+{
+	while (value >= 0x80)
+	{
+		buffer.push_back((char)((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	buffer.push_back((char)value);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CSSBinaryReader Construction:
+
+CSSBinaryReader::CSSBinaryReader(const char *data, size_t size)
+: pos(data), end(data + size)
+{
+	if (!is_compiled(data, size))
+		throw Exception("Not a compiled CSS file");
+	pos += sizeof(CSSBinaryWriter::magic);
+
+	unsigned int count = read_count(1);
+	strings.reserve(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int length = read_uint();
+		need(length);
+		strings.push_back(std::string(pos, length));
+		pos += length;
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CSSBinaryReader Attributes:
+
+bool CSSBinaryReader::is_compiled(const char *data, size_t size)
+{
+	return size >= sizeof(CSSBinaryWriter::magic) && memcmp(data, CSSBinaryWriter::magic, sizeof(CSSBinaryWriter::magic)) == 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CSSBinaryReader Operations:
+
+unsigned char CSSBinaryReader::read_uint8()
+{
+	need(1);
+	return (unsigned char)*(pos++);
+}
+
+unsigned int CSSBinaryReader::read_uint()
+{
+	unsigned int value = 0;
+	for (int shift = 0; shift < 35; shift += 7)
+	{
+		need(1);
+		unsigned char c = (unsigned char)*(pos++);
+		value |= (unsigned int)(c & 0x7f) << shift;
+		if ((c & 0x80) == 0)
+			return value;
+	}
+	throw Exception("Invalid integer in compiled CSS file");
+}
+
+const std::string &CSSBinaryReader::read_string()
+{
+	unsigned int index = read_uint();
+	if (index >= strings.size())
+		throw Exception("Invalid string reference in compiled CSS file");
+	return strings[index];
+}
+
+unsigned int CSSBinaryReader::read_count(size_t min_item_size)
+{
+	unsigned int count = read_uint();
+	if (count > (size_t)(end - pos) / min_item_size)
+		throw Exception("Compiled CSS file is truncated");
+	return count;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CSSBinaryReader Implementation:
+
+void CSSBinaryReader::need(size_t bytes)
+{
+	if ((size_t)(end - pos) < bytes)
+		throw Exception("Compiled CSS file is truncated");
+}
+
+}
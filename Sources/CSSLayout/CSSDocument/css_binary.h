@@ -0,0 +1,88 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <map>
+
+namespace clan
+{
+
+class IODevice;
+
+/// Compact binary encoding used by compiled style sheets.
+///
+/// All strings are stored once in a table at the start of the file and referenced by index.
+/// Integers are stored seven bits at a time, least significant group first, so small counts and
+/// indexes only take a single byte.
+class CSSBinaryWriter
+{
+public:
+	void write_uint8(unsigned char value);
+	void write_uint(unsigned int value);
+	void write_string(const std::string &value);
+
+	/// \brief Writes the magic header, the string table and the encoded data to the device
+	void save(IODevice &output);
+
+	static const char magic[8];
+
+private:
+	static void append_uint(std::string &buffer, unsigned int value);
+
+	std::string data;
+	std::vector<std::string> strings;
+	std::map<std::string, unsigned int> string_indexes;
+};
+
+class CSSBinaryReader
+{
+public:
+	/// \brief Reads the magic header and string table. Throws if the data is not a compiled style sheet.
+	CSSBinaryReader(const char *data, size_t size);
+
+	unsigned char read_uint8();
+	unsigned int read_uint();
+	const std::string &read_string();
+
+	/// \brief Reads an item count and checks that the remaining input can hold that many items
+	///
+	/// \param min_item_size Fewest bytes a single item can be encoded in.
+	unsigned int read_count(size_t min_item_size);
+
+	static bool is_compiled(const char *data, size_t size);
+
+private:
+	void need(size_t bytes);
+
+	const char *pos;
+	const char *end;
+	std::vector<std::string> strings;
+};
+
+}
@@ -29,7 +29,6 @@
 #include "CSSLayout/precomp.h"
 #include "API/CSSLayout/CSSDocument/css_document.h"
 #include "API/CSSLayout/CSSDocument/css_select_result.h"
-#include "API/Core/IOData/path_help.h"
 #include "API/Core/IOData/iodevice_memory.h"
 #include "css_document_impl.h"
 #include "css_document_sheet.h"
@@ -57,31 +56,26 @@ void CSSDocument::add_default_html_sheet()
 
 void CSSDocument::add_sheet(CSSSheetOrigin origin, const std::string &filename, const FileSystem &fs)
 {
-	// Load the css document:
-	IODevice file = fs.open_file(filename);
-	DataBuffer file_data(file.get_size());
-	file.read(file_data.get_data(), file_data.get_size());
-	std::string css_text(file_data.get_data(), file_data.get_size());
-
-	// Find the base URI for this css document:
-	std::string base_uri = PathHelp::get_fullpath(filename);
-
-	// Find import directives and load those first:
-	std::vector<std::string> import_urls = CSSTokenizer(css_text).read_import_urls();
-	for (size_t i = 0; i < import_urls.size(); i++)
-	{
-		add_sheet(origin, PathHelp::combine(base_uri, import_urls[i]), fs);
-	}
-
-	// Add the css sheet:
-	CSSTokenizer tokenizer(css_text);
-	impl->sheets.push_back(std::shared_ptr<CSSDocumentSheet>(new CSSDocumentSheet(origin, tokenizer, base_uri)));
+	impl->add_sheet(origin, filename, fs, false);
 }
 
 void CSSDocument::add_sheet(CSSSheetOrigin origin, IODevice &iodevice, const std::string &base_uri)
 {
-	CSSTokenizer tokenizer(iodevice);
-	impl->sheets.push_back(std::shared_ptr<CSSDocumentSheet>(new CSSDocumentSheet(origin, tokenizer, base_uri)));
+	impl->add_sheet(origin, iodevice, base_uri, false);
+}
+
+void CSSDocument::compile_sheet(const std::string &filename, IODevice &output, const FileSystem &fs)
+{
+	CSSDocument_Impl document;
+	document.add_sheet(author_sheet_origin, filename, fs, true);
+	document.write_compiled_sheets(output);
+}
+
+void CSSDocument::compile_sheet(IODevice &iodevice, const std::string &base_uri, IODevice &output)
+{
+	CSSDocument_Impl document;
+	document.add_sheet(author_sheet_origin, iodevice, base_uri, true);
+	document.write_compiled_sheets(output);
 }
 
 CSSSelectResult CSSDocument::select(const DomElement &node, const std::string &pseudo_element)
@@ -30,19 +30,91 @@
 #include "css_document_impl.h"
 #include "css_ruleset_match.h"
 #include "API/Core/IOData/html_url.h"
+#include "API/Core/IOData/path_help.h"
+#include "API/Core/IOData/iodevice_memory.h"
+#include "css_binary.h"
 
 namespace clan
 {
 
 std::vector<CSSRulesetMatch> CSSDocument_Impl::select_rulesets(CSSSelectNode *node, const std::string &pseudo_element)
 {
+	// Walk the ancestors once and share the result between all sheets and selectors:
+	CSSAncestorFilter ancestor_filter;
+	ancestor_filter.add_ancestors(node);
+
 	std::vector<CSSRulesetMatch> matches;
 	for (size_t i = 0; i < sheets.size(); i++)
 	{
-		std::vector<CSSRulesetMatch> sheet_matches = sheets[i]->select_rulesets(node, pseudo_element);
+		std::vector<CSSRulesetMatch> sheet_matches = sheets[i]->select_rulesets(node, pseudo_element, &ancestor_filter);
 		matches.insert(matches.end(), sheet_matches.begin(), sheet_matches.end());
 	}
 	return matches;
 }
 
+void CSSDocument_Impl::add_sheet(CSSSheetOrigin origin, const std::string &filename, const FileSystem &fs, bool keep_declarations)
+{
+	// Load the css document:
+	IODevice file = fs.open_file(filename);
+	DataBuffer file_data(file.get_size());
+	file.read(file_data.get_data(), file_data.get_size());
+
+	// Compiled sheets already contain their imports:
+	if (CSSBinaryReader::is_compiled(file_data.get_data(), file_data.get_size()))
+	{
+		add_compiled_sheets(origin, file_data, keep_declarations);
+		return;
+	}
+
+	std::string css_text(file_data.get_data(), file_data.get_size());
+
+	// Find the base URI for this css document:
+	std::string base_uri = PathHelp::get_fullpath(filename);
+
+	// Find import directives and load those first:
+	std::vector<std::string> import_urls = CSSTokenizer(css_text).read_import_urls();
+	for (size_t i = 0; i < import_urls.size(); i++)
+	{
+		add_sheet(origin, PathHelp::combine(base_uri, import_urls[i]), fs, keep_declarations);
+	}
+
+	// Add the css sheet:
+	CSSTokenizer tokenizer(css_text);
+	sheets.push_back(std::shared_ptr<CSSDocumentSheet>(new CSSDocumentSheet(origin, tokenizer, base_uri, keep_declarations)));
+}
+
+void CSSDocument_Impl::add_sheet(CSSSheetOrigin origin, IODevice &iodevice, const std::string &base_uri, bool keep_declarations)
+{
+	DataBuffer data(iodevice.get_size());
+	iodevice.receive(data.get_data(), data.get_size(), true);
+
+	if (CSSBinaryReader::is_compiled(data.get_data(), data.get_size()))
+	{
+		add_compiled_sheets(origin, data, keep_declarations);
+	}
+	else
+	{
+		IODevice_Memory memory(data);
+		CSSTokenizer tokenizer(memory);
+		sheets.push_back(std::shared_ptr<CSSDocumentSheet>(new CSSDocumentSheet(origin, tokenizer, base_uri, keep_declarations)));
+	}
+}
+
+void CSSDocument_Impl::add_compiled_sheets(CSSSheetOrigin origin, const DataBuffer &data, bool keep_declarations)
+{
+	CSSBinaryReader reader(data.get_data(), data.get_size());
+	unsigned int num_sheets = reader.read_uint();
+	for (unsigned int i = 0; i < num_sheets; i++)
+		sheets.push_back(std::shared_ptr<CSSDocumentSheet>(new CSSDocumentSheet(origin, reader, keep_declarations)));
+}
+
+void CSSDocument_Impl::write_compiled_sheets(IODevice &output) const
+{
+	CSSBinaryWriter writer;
+	writer.write_uint(sheets.size());
+	for (size_t i = 0; i < sheets.size(); i++)
+		sheets[i]->write(writer);
+	writer.save(output);
+}
+
 }
@@ -38,6 +38,11 @@ class CSSDocument_Impl
 public:
 	std::vector<CSSRulesetMatch> select_rulesets(CSSSelectNode *node, const std::string &pseudo_element);
 
+	void add_sheet(CSSSheetOrigin origin, const std::string &filename, const FileSystem &fs, bool keep_declarations);
+	void add_sheet(CSSSheetOrigin origin, IODevice &iodevice, const std::string &base_uri, bool keep_declarations);
+	void add_compiled_sheets(CSSSheetOrigin origin, const DataBuffer &data, bool keep_declarations);
+	void write_compiled_sheets(IODevice &output) const;
+
 	std::vector<std::shared_ptr<CSSDocumentSheet> > sheets;
 };
 
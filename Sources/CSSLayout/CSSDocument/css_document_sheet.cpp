@@ -29,34 +29,100 @@
 #include "CSSLayout/precomp.h"
 #include "css_document_sheet.h"
 #include "css_ruleset_match.h"
+#include "css_binary.h"
 #include "API/Core/IOData/html_url.h"
 
 namespace clan
 {
 
-CSSDocumentSheet::CSSDocumentSheet(CSSSheetOrigin origin, CSSTokenizer &tokenizer, const std::string &base_uri)
-: origin(origin), base_uri(base_uri)
+CSSDocumentSheet::CSSDocumentSheet(CSSSheetOrigin origin, CSSTokenizer &tokenizer, const std::string &base_uri, bool keep_declarations)
+: origin(origin), base_uri(base_uri), keep_declarations(keep_declarations)
 {
 	read_stylesheet(tokenizer);
+	build_selector_index();
 }
 
-std::vector<CSSRulesetMatch> CSSDocumentSheet::select_rulesets(CSSSelectNode *node, const std::string &pseudo_element)
+CSSDocumentSheet::CSSDocumentSheet(CSSSheetOrigin origin, CSSBinaryReader &reader, bool keep_declarations)
+: origin(origin), keep_declarations(keep_declarations)
 {
-	std::vector<CSSRulesetMatch> matched_rulesets;
+	// Selectors and the selector index are restored as is. Property values still go
+	// through the property parsers, but from ready made tokens instead of CSS text.
+	base_uri = reader.read_string();
+
+	unsigned int num_rulesets = reader.read_count(2);
+	rulesets.reserve(num_rulesets);
+	for (unsigned int i = 0; i < num_rulesets; i++)
+	{
+		std::shared_ptr<CSSRuleset> ruleset(new CSSRuleset(this));
+
+		unsigned int num_selectors = reader.read_count(2);
+		ruleset->selectors.resize(num_selectors);
+		for (unsigned int j = 0; j < num_selectors; j++)
+			read_selector_chain(reader, ruleset->selectors[j]);
+
+		unsigned int num_declarations = reader.read_count(3);
+		for (unsigned int j = 0; j < num_declarations; j++)
+		{
+			CSSProperty property;
+			read_declaration(reader, property);
+			add_declaration(ruleset.get(), property);
+		}
+
+		rulesets.push_back(ruleset);
+	}
+
+	selector_index.read(reader);
+}
+
+void CSSDocumentSheet::write(CSSBinaryWriter &writer) const
+{
+	if (!keep_declarations)
+		throw Exception("Style sheet was not loaded for compilation");
+
+	writer.write_string(base_uri);
+
+	writer.write_uint(rulesets.size());
 	for (size_t i = 0; i < rulesets.size(); i++)
 	{
-		CSSRuleset *cur_ruleset = rulesets[i].get();
-		for (size_t j = 0; j < cur_ruleset->selectors.size(); j++)
+		const CSSRuleset *ruleset = rulesets[i].get();
+
+		writer.write_uint(ruleset->selectors.size());
+		for (size_t j = 0; j < ruleset->selectors.size(); j++)
+			write_selector_chain(writer, ruleset->selectors[j]);
+
+		writer.write_uint(ruleset->declarations.size());
+		for (size_t j = 0; j < ruleset->declarations.size(); j++)
+			write_declaration(writer, ruleset->declarations[j]);
+	}
+
+	selector_index.write(writer);
+}
+
+std::vector<CSSRulesetMatch> CSSDocumentSheet::select_rulesets(CSSSelectNode *node, const std::string &pseudo_element, const CSSAncestorFilter *ancestor_filter)
+{
+	std::vector<CSSRulesetMatch> matched_rulesets;
+
+	// Only test selectors whose rightmost id, class or tag can match this node.
+	// Candidates are in document order, so the first matching selector of a ruleset is found first.
+	std::vector<CSSSelectorIndexEntry> candidates;
+	selector_index.find_candidates(node, ancestor_filter, candidates);
+	size_t last_matched_ruleset = rulesets.size();
+	for (size_t i = 0; i < candidates.size(); i++)
+	{
+		size_t ruleset_index = candidates[i].ruleset_index;
+		if (ruleset_index == last_matched_ruleset)
+			continue;
+
+		CSSRuleset *cur_ruleset = rulesets[ruleset_index].get();
+		size_t selector = candidates[i].selector_index;
+		const CSSSelectorChain &chain = cur_ruleset->selectors[selector];
+		if (equals(chain.pseudo_element, pseudo_element))
 		{
-			const CSSSelectorChain &chain = cur_ruleset->selectors[j];
-			if (equals(chain.pseudo_element, pseudo_element))
+			bool matches = try_match_chain(chain, node, chain.links.size());
+			if (matches)
 			{
-				bool matches = try_match_chain(chain, node, chain.links.size());
-				if (matches)
-				{
-					matched_rulesets.push_back(CSSRulesetMatch(cur_ruleset, j, matched_rulesets.size()));
-					break;
-				}
+				matched_rulesets.push_back(CSSRulesetMatch(cur_ruleset, selector, matched_rulesets.size()));
+				last_matched_ruleset = ruleset_index;
 			}
 		}
 	}
@@ -64,6 +130,16 @@ std::vector<CSSRulesetMatch> CSSDocumentSheet::select_rulesets(CSSSelectNode *no
 	return matched_rulesets;
 }
 
+void CSSDocumentSheet::build_selector_index()
+{
+	selector_index.clear();
+	for (size_t i = 0; i < rulesets.size(); i++)
+	{
+		for (size_t j = 0; j < rulesets[i]->selectors.size(); j++)
+			selector_index.add(rulesets[i]->selectors[j], i, j);
+	}
+}
+
 bool CSSDocumentSheet::try_match_chain(const CSSSelectorChain &chain, CSSSelectNode *node, size_t chain_index)
 {
 	bool matches = false;
@@ -619,12 +695,7 @@ void CSSDocumentSheet::read_statement(CSSTokenizer &tokenizer, CSSToken &token)
 					property.set_name(property_name);
 					bool end_of_scope = read_property_value(tokenizer, token, property, base_uri);
 					if (!property.get_value_tokens().empty())
-					{
-						if (property.is_important())
-							parsers.parse(property, ruleset->important_values);
-						else
-							parsers.parse(property, ruleset->values);
-					}
+						add_declaration(ruleset.get(), property);
 					if (end_of_scope)
 						break;
 				}
@@ -717,6 +788,107 @@ bool CSSDocumentSheet::read_property_value(CSSTokenizer &tokenizer, CSSToken &to
 	return curly_count < 0;
 }
 
+void CSSDocumentSheet::add_declaration(CSSRuleset *ruleset, const CSSProperty &property)
+{
+	if (property.is_important())
+		parsers.parse(property, ruleset->important_values);
+	else
+		parsers.parse(property, ruleset->values);
+
+	if (keep_declarations)
+		ruleset->declarations.push_back(property);
+}
+
+void CSSDocumentSheet::write_selector_chain(CSSBinaryWriter &writer, const CSSSelectorChain &chain)
+{
+	writer.write_string(chain.pseudo_element);
+	writer.write_uint(chain.links.size());
+	for (size_t i = 0; i < chain.links.size(); i++)
+	{
+		const CSSSelectorLink &link = chain.links[i];
+		writer.write_uint8(link.type);
+		writer.write_string(link.element_name);
+		writer.write_string(link.element_lang);
+		writer.write_string(link.element_id);
+
+		writer.write_uint(link.element_classes.size());
+		for (size_t j = 0; j < link.element_classes.size(); j++)
+			writer.write_string(link.element_classes[j]);
+
+		writer.write_uint(link.pseudo_classes.size());
+		for (size_t j = 0; j < link.pseudo_classes.size(); j++)
+			writer.write_string(link.pseudo_classes[j]);
+
+		writer.write_uint(link.attribute_selectors.size());
+		for (size_t j = 0; j < link.attribute_selectors.size(); j++)
+		{
+			writer.write_uint8(link.attribute_selectors[j].type);
+			writer.write_string(link.attribute_selectors[j].name);
+			writer.write_string(link.attribute_selectors[j].value);
+		}
+	}
+}
+
+void CSSDocumentSheet::read_selector_chain(CSSBinaryReader &reader, CSSSelectorChain &out_selector_chain)
+{
+	out_selector_chain.pseudo_element = reader.read_string();
+	out_selector_chain.links.resize(reader.read_count(7));
+	for (size_t i = 0; i < out_selector_chain.links.size(); i++)
+	{
+		CSSSelectorLink &link = out_selector_chain.links[i];
+		link.type = (CSSSelectorLink::Type)reader.read_uint8();
+		link.element_name = reader.read_string();
+		link.element_lang = reader.read_string();
+		link.element_id = reader.read_string();
+
+		link.element_classes.resize(reader.read_count(1));
+		for (size_t j = 0; j < link.element_classes.size(); j++)
+			link.element_classes[j] = reader.read_string();
+
+		link.pseudo_classes.resize(reader.read_count(1));
+		for (size_t j = 0; j < link.pseudo_classes.size(); j++)
+			link.pseudo_classes[j] = reader.read_string();
+
+		link.attribute_selectors.resize(reader.read_count(3));
+		for (size_t j = 0; j < link.attribute_selectors.size(); j++)
+		{
+			link.attribute_selectors[j].type = (CSSAttributeSelector::Type)reader.read_uint8();
+			link.attribute_selectors[j].name = reader.read_string();
+			link.attribute_selectors[j].value = reader.read_string();
+		}
+	}
+}
+
+void CSSDocumentSheet::write_declaration(CSSBinaryWriter &writer, const CSSProperty &property)
+{
+	writer.write_string(property.get_name());
+	writer.write_uint8(property.is_important() ? 1 : 0);
+
+	const std::vector<CSSToken> &tokens = property.get_value_tokens();
+	writer.write_uint(tokens.size());
+	for (size_t i = 0; i < tokens.size(); i++)
+	{
+		writer.write_uint8(tokens[i].type);
+		writer.write_string(tokens[i].value);
+		writer.write_string(tokens[i].dimension);
+	}
+}
+
+void CSSDocumentSheet::read_declaration(CSSBinaryReader &reader, CSSProperty &out_property)
+{
+	out_property.set_name(reader.read_string());
+	out_property.set_important(reader.read_uint8() != 0);
+
+	std::vector<CSSToken> &tokens = out_property.get_value_tokens();
+	tokens.resize(reader.read_count(3));
+	for (size_t i = 0; i < tokens.size(); i++)
+	{
+		tokens[i].type = (CSSToken::Type)reader.read_uint8();
+		tokens[i].value = reader.read_string();
+		tokens[i].dimension = reader.read_string();
+	}
+}
+
 bool CSSDocumentSheet::read_end_of_statement(CSSTokenizer &tokenizer, CSSToken &token)
 {
 	int curly_count = 0;
@@ -9,18 +9,26 @@
 #include "css_ruleset.h"
 #include "css_selector_chain.h"
 #include "css_selector_link.h"
+#include "css_selector_index.h"
 #include <algorithm>
 
 namespace clan
 {
 
 class CSSRulesetMatch;
+class CSSBinaryWriter;
+class CSSBinaryReader;
 
 class CSSDocumentSheet
 {
 public:
-	CSSDocumentSheet(CSSSheetOrigin origin, CSSTokenizer &tokenizer, const std::string &base_uri);
-	std::vector<CSSRulesetMatch> select_rulesets(CSSSelectNode *node, const std::string &pseudo_element);
+	CSSDocumentSheet(CSSSheetOrigin origin, CSSTokenizer &tokenizer, const std::string &base_uri, bool keep_declarations = false);
+	CSSDocumentSheet(CSSSheetOrigin origin, CSSBinaryReader &reader, bool keep_declarations = false);
+
+	/// \brief Stores the parsed selectors, declarations and selector index. Requires keep_declarations.
+	void write(CSSBinaryWriter &writer) const;
+
+	std::vector<CSSRulesetMatch> select_rulesets(CSSSelectNode *node, const std::string &pseudo_element, const CSSAncestorFilter *ancestor_filter = 0);
 
 	CSSSheetOrigin origin;
 
@@ -31,16 +39,24 @@ private:
 	bool try_match_chain(const CSSSelectorChain &chain, CSSSelectNode *node, size_t chain_index);
 	bool try_match_link(const CSSSelectorLink &link, CSSSelectNode *node);
 	void read_stylesheet(CSSTokenizer &tokenizer);
+	void build_selector_index();
 	void read_at_rule(CSSTokenizer &tokenizer, CSSToken &token);
 	void read_statement(CSSTokenizer &tokenizer, CSSToken &token);
 	void read_end_of_at_rule(CSSTokenizer &tokenizer, CSSToken &token);
 	bool read_selector_chain(CSSTokenizer &tokenizer, CSSToken &token, CSSSelectorChain &out_selector_chain);
+	void add_declaration(CSSRuleset *ruleset, const CSSProperty &property);
+	static void write_selector_chain(CSSBinaryWriter &writer, const CSSSelectorChain &chain);
+	static void read_selector_chain(CSSBinaryReader &reader, CSSSelectorChain &out_selector_chain);
+	static void write_declaration(CSSBinaryWriter &writer, const CSSProperty &property);
+	static void read_declaration(CSSBinaryReader &reader, CSSProperty &out_property);
 	std::string to_string(const CSSToken &token);
 	static bool equals(const std::string &s1, const std::string &s2);
 	static std::string make_absolute_uri(std::string uri, std::string base_uri);
 
 	std::string base_uri;
 	std::vector<std::shared_ptr<CSSRuleset> > rulesets;
+	CSSSelectorIndex selector_index;
+	bool keep_declarations;
 
 	CSSPropertyParsers parsers;
 };
@@ -3,6 +3,7 @@
 
 #include "css_selector_chain.h"
 #include "API/CSSLayout/CSSDocument/css_property_value.h"
+#include "API/CSSLayout/CSSDocument/css_property.h"
 
 namespace clan
 {
@@ -16,6 +17,7 @@ public:
 	std::vector<CSSSelectorChain> selectors;
 	std::vector<std::unique_ptr<CSSPropertyValue> > important_values;
 	std::vector<std::unique_ptr<CSSPropertyValue> > values;
+	std::vector<CSSProperty> declarations; // Only kept for sheets that are going to be compiled
 	CSSDocumentSheet *sheet;
 };
 
@@ -0,0 +1,329 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "CSSLayout/precomp.h"
+#include "css_selector_index.h"
+#include "css_selector_chain.h"
+#include "css_binary.h"
+#include "API/CSSLayout/CSSDocument/css_select_node.h"
+#include <algorithm>
+#include <cstring>
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// CSSAncestorFilter Construction:
+
+CSSAncestorFilter::CSSAncestorFilter()
+{
+	clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CSSAncestorFilter Attributes:
+
+bool CSSAncestorFilter::may_contain(unsigned int hash) const
+{
+	unsigned int bit1 = hash & key_mask;
+	unsigned int bit2 = (hash >> key_bits) & key_mask;
+	return (bits[bit1 >> 5] & (1 << (bit1 & 31))) && (bits[bit2 >> 5] & (1 << (bit2 & 31)));
+}
+
+unsigned int CSSAncestorFilter::hash_tag(const std::string &name)
+{
+	return hash('<', name, true);
+}
+
+unsigned int CSSAncestorFilter::hash_id(const std::string &id)
+{
+	return hash('#', id, false);
+}
+
+unsigned int CSSAncestorFilter::hash_class(const std::string &name)
+{
+	return hash('.', name, true);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CSSAncestorFilter Operations:
+
+void CSSAncestorFilter::clear()
+{
+	memset(bits, 0, sizeof(bits));
+}
+
+void CSSAncestorFilter::add_ancestors(CSSSelectNode *node)
+{
+	node->push();
+	while (node->parent())
+		add_element(node);
+	node->pop();
+}
+
+void CSSAncestorFilter::add_element(CSSSelectNode *node)
+{
+	add(hash_tag(node->name()));
+
+	std::string id = node->id();
+	if (!id.empty())
+		add(hash_id(id));
+
+	std::vector<std::string> classes = node->element_classes();
+	for (size_t i = 0; i < classes.size(); i++)
+		add(hash_class(classes[i]));
+}
+
+void CSSAncestorFilter::add(unsigned int hash)
+{
+	unsigned int bit1 = hash & key_mask;
+	unsigned int bit2 = (hash >> key_bits) & key_mask;
+	bits[bit1 >> 5] |= 1 << (bit1 & 31);
+	bits[bit2 >> 5] |= 1 << (bit2 & 31);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CSSAncestorFilter Implementation:
+
+unsigned int CSSAncestorFilter::hash(char salt, const std::string &text, bool case_insensitive)
+{
+	// FNV-1a, with ASCII case folding done inline to avoid an allocation per key
+	unsigned int h = 2166136261u;
+	h = (h ^ (unsigned char)salt) * 16777619u;
+	for (size_t i = 0; i < text.length(); i++)
+	{
+		unsigned char c = text[i];
+		if (case_insensitive)
+		{
+			if (c >= 0x80)
+				return hash(salt, CSSSelectorIndex::fold_case(text), false);
+			else if (c >= 'A' && c <= 'Z')
+				c += 'a' - 'A';
+		}
+		h = (h ^ c) * 16777619u;
+	}
+
+	// Zero terminates CSSSelectorIndexEntry::ancestor_hashes
+	return h != 0 ? h : 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CSSSelectorIndex Operations:
+
+void CSSSelectorIndex::clear()
+{
+	id_buckets.clear();
+	class_buckets.clear();
+	tag_buckets.clear();
+	universal_bucket.clear();
+}
+
+void CSSSelectorIndex::add(const CSSSelectorChain &chain, size_t ruleset_index, size_t selector_index)
+{
+	CSSSelectorIndexEntry entry;
+	entry.ruleset_index = ruleset_index;
+	entry.selector_index = selector_index;
+
+	// Collect keys that must be present on some ancestor. A compound selector left of a child or
+	// descendant combinator describes an ancestor, while one left of a sibling combinator does not.
+	int num_hashes = 0;
+	bool is_ancestor = false;
+	for (size_t i = chain.links.size(); i > 1 && num_hashes < CSSSelectorIndexEntry::max_ancestor_hashes; i--)
+	{
+		const CSSSelectorLink &link = chain.links[i - 2];
+		if (link.type == CSSSelectorLink::type_child_combinator || link.type == CSSSelectorLink::type_descendant_combinator)
+		{
+			is_ancestor = true;
+		}
+		else if (link.type == CSSSelectorLink::type_next_sibling_combinator)
+		{
+			is_ancestor = false;
+		}
+		else if (is_ancestor)
+		{
+			if (!link.element_id.empty() && num_hashes < CSSSelectorIndexEntry::max_ancestor_hashes)
+				entry.ancestor_hashes[num_hashes++] = CSSAncestorFilter::hash_id(link.element_id);
+			for (size_t k = 0; k < link.element_classes.size() && num_hashes < CSSSelectorIndexEntry::max_ancestor_hashes; k++)
+				entry.ancestor_hashes[num_hashes++] = CSSAncestorFilter::hash_class(link.element_classes[k]);
+			if (link.type == CSSSelectorLink::type_simple_selector && num_hashes < CSSSelectorIndexEntry::max_ancestor_hashes)
+				entry.ancestor_hashes[num_hashes++] = CSSAncestorFilter::hash_tag(link.element_name);
+		}
+	}
+	if (num_hashes < CSSSelectorIndexEntry::max_ancestor_hashes)
+		entry.ancestor_hashes[num_hashes] = 0;
+
+	// Bucket by the most selective key of the rightmost compound selector:
+	if (chain.links.empty())
+	{
+		universal_bucket.push_back(entry);
+		return;
+	}
+
+	const CSSSelectorLink &subject = chain.links.back();
+	if (!subject.element_id.empty())
+		id_buckets[subject.element_id].push_back(entry);
+	else if (!subject.element_classes.empty())
+		class_buckets[fold_case(subject.element_classes.front())].push_back(entry);
+	else if (subject.type == CSSSelectorLink::type_simple_selector)
+		tag_buckets[fold_case(subject.element_name)].push_back(entry);
+	else
+		universal_bucket.push_back(entry);
+}
+
+void CSSSelectorIndex::find_candidates(CSSSelectNode *node, const CSSAncestorFilter *filter, std::vector<CSSSelectorIndexEntry> &out_candidates) const
+{
+	out_candidates.clear();
+
+	if (!id_buckets.empty())
+	{
+		Buckets::const_iterator it = id_buckets.find(node->id());
+		if (it != id_buckets.end())
+			add_bucket(it->second, filter, out_candidates);
+	}
+
+	if (!class_buckets.empty())
+	{
+		std::vector<std::string> classes = node->element_classes();
+		for (size_t i = 0; i < classes.size(); i++)
+		{
+			Buckets::const_iterator it = class_buckets.find(fold_case(classes[i]));
+			if (it != class_buckets.end())
+				add_bucket(it->second, filter, out_candidates);
+		}
+	}
+
+	if (!tag_buckets.empty())
+	{
+		Buckets::const_iterator it = tag_buckets.find(fold_case(node->name()));
+		if (it != tag_buckets.end())
+			add_bucket(it->second, filter, out_candidates);
+	}
+
+	add_bucket(universal_bucket, filter, out_candidates);
+
+	// A node listing the same class twice pulls its bucket in twice:
+	std::sort(out_candidates.begin(), out_candidates.end());
+	out_candidates.erase(std::unique(out_candidates.begin(), out_candidates.end()), out_candidates.end());
+}
+
+void CSSSelectorIndex::write(CSSBinaryWriter &writer) const
+{
+	write_buckets(writer, id_buckets);
+	write_buckets(writer, class_buckets);
+	write_buckets(writer, tag_buckets);
+	write_bucket(writer, universal_bucket);
+}
+
+void CSSSelectorIndex::read(CSSBinaryReader &reader)
+{
+	clear();
+	read_buckets(reader, id_buckets);
+	read_buckets(reader, class_buckets);
+	read_buckets(reader, tag_buckets);
+	read_bucket(reader, universal_bucket);
+}
+
+std::string CSSSelectorIndex::fold_case(const std::string &text)
+{
+	std::string folded = text;
+	for (size_t i = 0; i < folded.length(); i++)
+	{
+		unsigned char c = folded[i];
+		if (c >= 0x80)
+			return StringHelp::text_to_lower(text);
+		else if (c >= 'A' && c <= 'Z')
+			folded[i] = c + ('a' - 'A');
+	}
+	return folded;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CSSSelectorIndex Implementation:
+
+void CSSSelectorIndex::write_buckets(CSSBinaryWriter &writer, const Buckets &buckets)
+{
+	writer.write_uint(buckets.size());
+	for (Buckets::const_iterator it = buckets.begin(); it != buckets.end(); ++it)
+	{
+		writer.write_string(it->first);
+		write_bucket(writer, it->second);
+	}
+}
+
+void CSSSelectorIndex::read_buckets(CSSBinaryReader &reader, Buckets &buckets)
+{
+	unsigned int count = reader.read_count(2);
+	buckets.rehash(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const std::string &key = reader.read_string();
+		read_bucket(reader, buckets[key]);
+	}
+}
+
+void CSSSelectorIndex::write_bucket(CSSBinaryWriter &writer, const std::vector<CSSSelectorIndexEntry> &bucket)
+{
+	writer.write_uint(bucket.size());
+	for (size_t i = 0; i < bucket.size(); i++)
+	{
+		writer.write_uint(bucket[i].ruleset_index);
+		writer.write_uint(bucket[i].selector_index);
+
+		// Slots after the zero terminator are uninitialized. Write zeros to keep the output reproducible.
+		bool terminated = false;
+		for (int j = 0; j < CSSSelectorIndexEntry::max_ancestor_hashes; j++)
+		{
+			terminated = terminated || bucket[i].ancestor_hashes[j] == 0;
+			writer.write_uint(terminated ? 0 : bucket[i].ancestor_hashes[j]);
+		}
+	}
+}
+
+void CSSSelectorIndex::read_bucket(CSSBinaryReader &reader, std::vector<CSSSelectorIndexEntry> &bucket)
+{
+	unsigned int count = reader.read_count(2 + CSSSelectorIndexEntry::max_ancestor_hashes);
+	bucket.resize(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		bucket[i].ruleset_index = reader.read_uint();
+		bucket[i].selector_index = reader.read_uint();
+		for (int j = 0; j < CSSSelectorIndexEntry::max_ancestor_hashes; j++)
+			bucket[i].ancestor_hashes[j] = reader.read_uint();
+	}
+}
+
+void CSSSelectorIndex::add_bucket(const std::vector<CSSSelectorIndexEntry> &bucket, const CSSAncestorFilter *filter, std::vector<CSSSelectorIndexEntry> &out_candidates)
+{
+	for (size_t i = 0; i < bucket.size(); i++)
+	{
+		if (filter == 0 || bucket[i].may_match(*filter))
+			out_candidates.push_back(bucket[i]);
+	}
+}
+
+}
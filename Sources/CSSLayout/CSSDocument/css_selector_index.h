@@ -0,0 +1,135 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <unordered_map>
+
+namespace clan
+{
+
+class CSSSelectNode;
+class CSSSelectorChain;
+class CSSBinaryWriter;
+class CSSBinaryReader;
+
+/// Bloom filter of the tag names, ids and classes of an element's ancestors.
+///
+/// False positives are possible, false negatives are not. A selector that requires
+/// an ancestor key the filter has never seen can therefore be rejected without walking the tree.
+class CSSAncestorFilter
+{
+public:
+	CSSAncestorFilter();
+
+	void clear();
+	void add_ancestors(CSSSelectNode *node);
+	void add_element(CSSSelectNode *node);
+	void add(unsigned int hash);
+	bool may_contain(unsigned int hash) const;
+
+	static unsigned int hash_tag(const std::string &name);
+	static unsigned int hash_id(const std::string &id);
+	static unsigned int hash_class(const std::string &name);
+
+private:
+	static unsigned int hash(char salt, const std::string &text, bool case_insensitive);
+
+	enum { key_bits = 12, bit_count = 1 << key_bits, key_mask = bit_count - 1 };
+	unsigned int bits[bit_count / 32];
+};
+
+class CSSSelectorIndexEntry
+{
+public:
+	CSSSelectorIndexEntry() : ruleset_index(0), selector_index(0) { ancestor_hashes[0] = 0; }
+
+	bool operator<(const CSSSelectorIndexEntry &other) const
+	{
+		if (ruleset_index != other.ruleset_index)
+			return ruleset_index < other.ruleset_index;
+		else
+			return selector_index < other.selector_index;
+	}
+
+	bool operator==(const CSSSelectorIndexEntry &other) const
+	{
+		return ruleset_index == other.ruleset_index && selector_index == other.selector_index;
+	}
+
+	bool may_match(const CSSAncestorFilter &filter) const
+	{
+		for (int i = 0; i < max_ancestor_hashes && ancestor_hashes[i] != 0; i++)
+		{
+			if (!filter.may_contain(ancestor_hashes[i]))
+				return false;
+		}
+		return true;
+	}
+
+	enum { max_ancestor_hashes = 4 };
+
+	unsigned int ruleset_index;
+	unsigned int selector_index;
+	unsigned int ancestor_hashes[max_ancestor_hashes]; // Zero terminated unless full
+};
+
+/// Rulesets bucketed by the id, class or tag name of the rightmost compound selector.
+class CSSSelectorIndex
+{
+public:
+	void clear();
+	void add(const CSSSelectorChain &chain, size_t ruleset_index, size_t selector_index);
+
+	/// \brief Returns the selectors that could match the node, sorted in document order
+	void find_candidates(CSSSelectNode *node, const CSSAncestorFilter *filter, std::vector<CSSSelectorIndexEntry> &out_candidates) const;
+
+	/// \brief Stores the index in a compiled style sheet
+	void write(CSSBinaryWriter &writer) const;
+
+	/// \brief Restores an index stored by write
+	void read(CSSBinaryReader &reader);
+
+	static std::string fold_case(const std::string &text);
+
+private:
+	typedef std::unordered_map<std::string, std::vector<CSSSelectorIndexEntry> > Buckets;
+
+	static void write_buckets(CSSBinaryWriter &writer, const Buckets &buckets);
+	static void read_buckets(CSSBinaryReader &reader, Buckets &buckets);
+	static void write_bucket(CSSBinaryWriter &writer, const std::vector<CSSSelectorIndexEntry> &bucket);
+	static void read_bucket(CSSBinaryReader &reader, std::vector<CSSSelectorIndexEntry> &bucket);
+	static void add_bucket(const std::vector<CSSSelectorIndexEntry> &bucket, const CSSAncestorFilter *filter, std::vector<CSSSelectorIndexEntry> &out_candidates);
+
+	Buckets id_buckets;
+	Buckets class_buckets;
+	Buckets tag_buckets;
+	std::vector<CSSSelectorIndexEntry> universal_bucket;
+};
+
+}
@@ -59,10 +59,13 @@ void CSSTokenizer::read(CSSToken &token, bool eat_whitespace, bool eat_comments)
 			CSSToken next_token;
 			while (true)
 			{
-				impl->peek(next_token);
+				size_t next_pos = impl->get_position();
+				impl->read(next_token);
 				if (next_token.type != CSSToken::type_whitespace && next_token.type != CSSToken::type_comment)
+				{
+					impl->set_position(next_pos);
 					break;
-				impl->read(next_token);
+				}
 				if (next_token.type == CSSToken::type_comment)
 				{
 					next_token.type = CSSToken::type_whitespace;
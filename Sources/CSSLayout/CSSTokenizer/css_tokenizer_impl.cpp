@@ -148,14 +148,20 @@ void CSSTokenizer_Impl::read(CSSToken &token)
 	if (token.type != CSSToken::type_null)
 		return;
 
-	read_function(token);
-	if (token.type != CSSToken::type_null)
-		return;
-
-	pos = read_ident(pos, token.value);
+	// Functions and identifiers share the same start, so scan the name only once
+	size_t end_pos = read_ident(pos, token.value);
 	if (!token.value.empty())
 	{
-		token.type = CSSToken::type_ident;
+		if (end_pos < doc.length() && doc[end_pos] == '(')
+		{
+			token.type = CSSToken::type_function;
+			pos = end_pos+1;
+		}
+		else
+		{
+			token.type = CSSToken::type_ident;
+			pos = end_pos;
+		}
 		return;
 	}
 
@@ -258,6 +264,22 @@ void CSSTokenizer_Impl::read_hash(CSSToken &token)
 
 size_t CSSTokenizer_Impl::read_ident(size_t p, std::string &out_ident)
 {
+	// Fast path: identifiers without escapes are copied straight from the document
+	size_t end_pos = p;
+	if (end_pos < doc.length() && doc[end_pos] == '-')
+		end_pos++;
+	if (end_pos < doc.length() && is_plain_nmstart(doc[end_pos]))
+	{
+		end_pos++;
+		while (end_pos < doc.length() && is_plain_nmchar(doc[end_pos]))
+			end_pos++;
+		if (end_pos == doc.length() || doc[end_pos] != '\\')
+		{
+			out_ident.assign(doc, p, end_pos - p);
+			return end_pos;
+		}
+	}
+
 	out_ident.clear();
 	std::string::value_type c = 0;
 	size_t len = 0;
@@ -293,6 +315,15 @@ size_t CSSTokenizer_Impl::read_ident(size_t p, std::string &out_ident)
 
 size_t CSSTokenizer_Impl::read_name(size_t p, std::string &out_ident)
 {
+	size_t end_pos = p;
+	while (end_pos < doc.length() && is_plain_nmchar(doc[end_pos]))
+		end_pos++;
+	if (end_pos == doc.length() || doc[end_pos] != '\\')
+	{
+		out_ident.assign(doc, p, end_pos - p);
+		return end_pos;
+	}
+
 	out_ident.clear();
 	std::string::value_type c;
 	size_t len = read_nmchar(p, c);
@@ -388,19 +419,6 @@ void CSSTokenizer_Impl::read_uri(CSSToken &token)
 	}
 }
 
-void CSSTokenizer_Impl::read_function(CSSToken &token)
-{
-	size_t end_pos = read_ident(pos, token.value);
-	if (end_pos != pos)
-	{
-		if (end_pos+1 <= doc.length() && doc[end_pos] == '(')
-		{
-			pos = end_pos+1;
-			token.type = CSSToken::type_function;
-		}
-	}
-}
-
 void CSSTokenizer_Impl::read_whitespace(CSSToken &token)
 {
 	if (pos+1 <= doc.length() && is_whitespace(doc[pos]))
@@ -522,6 +540,16 @@ size_t CSSTokenizer_Impl::read_nmchar(size_t p, std::string::value_type &out_c)
 	}
 }
 
+bool CSSTokenizer_Impl::is_plain_nmstart(std::string::value_type c)
+{
+	return c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || ((unsigned char)c) > 177;
+}
+
+bool CSSTokenizer_Impl::is_plain_nmchar(std::string::value_type c)
+{
+	return is_plain_nmstart(c) || (c >= '0' && c <= '9') || c == '-';
+}
+
 bool CSSTokenizer_Impl::is_whitespace(std::string::value_type c)
 {
 	switch (c)
@@ -539,8 +567,18 @@ bool CSSTokenizer_Impl::is_whitespace(std::string::value_type c)
 
 size_t CSSTokenizer_Impl::read_string(size_t p, std::string &out_str, std::string::value_type str_char) const
 {
-	out_str.clear();
+	// Fast path: strings without escapes are copied straight from the document
 	size_t end_pos = p;
+	while (end_pos < doc.length() && doc[end_pos] != str_char && doc[end_pos] != '\\' && doc[end_pos] != '\n' && doc[end_pos] != '\r')
+		end_pos++;
+	if (end_pos < doc.length() && doc[end_pos] == str_char)
+	{
+		out_str.assign(doc, p, end_pos - p);
+		return end_pos+1;
+	}
+
+	out_str.clear();
+	end_pos = p;
 	while (end_pos < doc.length() && doc[end_pos] != str_char)
 	{
 		if (doc[end_pos] == '\\')
@@ -42,6 +42,9 @@ public:
 	void read(CSSToken &out_token);
 	void peek(CSSToken &out_token);
 
+	size_t get_position() const { return pos; }
+	void set_position(size_t new_pos) { pos = new_pos; }
+
 private:
 	void read_atkeyword(CSSToken &out_token);
 	void read_hash(CSSToken &out_token);
@@ -49,7 +52,6 @@ private:
 	void read_cdc(CSSToken &out_token);
 	void read_comment(CSSToken &out_token);
 	void read_uri(CSSToken &out_token);
-	void read_function(CSSToken &out_token);
 	void read_whitespace(CSSToken &out_token);
 	void read_includes(CSSToken &out_token);
 	void read_dashmatch(CSSToken &out_token);
@@ -61,6 +63,8 @@ private:
 	size_t read_string(size_t p, std::string &out_str, std::string::value_type str_char) const;
 	size_t read_invalid(size_t p) const;
 	size_t read_uri_nonquoted_string(size_t p, std::string &out_str) const;
+	inline static bool is_plain_nmstart(std::string::value_type c);
+	inline static bool is_plain_nmchar(std::string::value_type c);
 	inline static bool is_whitespace(std::string::value_type c);
 
 	std::string doc;
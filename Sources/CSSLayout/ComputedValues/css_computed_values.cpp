@@ -28,11 +28,24 @@
 
 #include "CSSLayout/precomp.h"
 #include "API/CSSLayout/ComputedValues/css_computed_values.h"
+#include "API/Core/System/work_queue.h"
 #include "css_computed_values_impl.h"
 
 namespace clan
 {
 
+class CSSComputedValuesSubtreeUpdate : public WorkItem
+{
+public:
+	CSSComputedValuesSubtreeUpdate(CSSComputedValues_Impl *subtree) : subtree(subtree) { }
+	void process_work() { subtree->update_descendants(); }
+
+private:
+	CSSComputedValues_Impl *subtree;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
 CSSComputedValues::CSSComputedValues()
 {
 }
@@ -69,10 +82,46 @@ void CSSComputedValues::set_specified_values(const CSSSelectResult &selected_val
 	impl->set_specified_values_changed();
 }
 
+void CSSComputedValues::update_tree(WorkQueue *work_queue)
+{
+	impl->update_if_changed();
+	if (work_queue == 0)
+	{
+		impl->update_descendants();
+		return;
+	}
+
+	// Split the tree breadth first. A node shares its style cache with its siblings, so the
+	// roots of the subtrees are updated here and only their descendants go to the workers.
+	size_t min_subtrees = work_queue->get_thread_count() * 4;
+	std::vector<CSSComputedValues_Impl *> subtrees(1, impl.get());
+	while (subtrees.size() < min_subtrees)
+	{
+		std::vector<CSSComputedValues_Impl *> next_level;
+		for (size_t i = 0; i < subtrees.size(); i++)
+		{
+			const std::vector<CSSComputedValues_Impl *> &children = subtrees[i]->children;
+			for (size_t j = 0; j < children.size(); j++)
+			{
+				children[j]->update_if_changed();
+				if (!children[j]->children.empty())
+					next_level.push_back(children[j]);
+			}
+		}
+		subtrees.swap(next_level);
+		if (subtrees.empty())
+			return;
+	}
+
+	for (size_t i = 0; i < subtrees.size(); i++)
+		work_queue->queue(new CSSComputedValuesSubtreeUpdate(subtrees[i]));
+	work_queue->finish();
+}
+
 const CSSComputedBox &CSSComputedValues::get_box() const
 {
 	const_cast<CSSComputedValues*>(this)->impl->update_if_changed();
-	return impl->box;
+	return impl->style->box;
 }
 
 int CSSComputedValues::get_box_generation() const
@@ -84,7 +133,7 @@ int CSSComputedValues::get_box_generation() const
 const CSSComputedBackground &CSSComputedValues::get_background() const
 {
 	const_cast<CSSComputedValues*>(this)->impl->update_if_changed();
-	return impl->background;
+	return impl->style->background;
 }
 
 int CSSComputedValues::get_background_generation() const
@@ -96,7 +145,7 @@ int CSSComputedValues::get_background_generation() const
 const CSSComputedBorder &CSSComputedValues::get_border() const
 {
 	const_cast<CSSComputedValues*>(this)->impl->update_if_changed();
-	return impl->border;
+	return impl->style->border;
 }
 
 int CSSComputedValues::get_border_generation() const
@@ -108,7 +157,7 @@ int CSSComputedValues::get_border_generation() const
 const CSSComputedCounter &CSSComputedValues::get_counter() const
 {
 	const_cast<CSSComputedValues*>(this)->impl->update_if_changed();
-	return impl->counter;
+	return impl->style->counter;
 }
 
 int CSSComputedValues::get_counter_generation() const
@@ -120,7 +169,7 @@ int CSSComputedValues::get_counter_generation() const
 const CSSComputedFlex &CSSComputedValues::get_flex() const
 {
 	const_cast<CSSComputedValues*>(this)->impl->update_if_changed();
-	return impl->flex;
+	return impl->style->flex;
 }
 
 int CSSComputedValues::get_flex_generation() const
@@ -132,7 +181,7 @@ int CSSComputedValues::get_flex_generation() const
 const CSSComputedFont &CSSComputedValues::get_font() const
 {
 	const_cast<CSSComputedValues*>(this)->impl->update_if_changed();
-	return impl->font;
+	return impl->style->font;
 }
 
 int CSSComputedValues::get_font_generation() const
@@ -144,7 +193,7 @@ int CSSComputedValues::get_font_generation() const
 const CSSComputedGeneric &CSSComputedValues::get_generic() const
 {
 	const_cast<CSSComputedValues*>(this)->impl->update_if_changed();
-	return impl->generic_values;
+	return impl->style->generic_values;
 }
 
 int CSSComputedValues::get_generic_generation() const
@@ -156,7 +205,7 @@ int CSSComputedValues::get_generic_generation() const
 const CSSComputedListStyle &CSSComputedValues::get_list_style() const
 {
 	const_cast<CSSComputedValues*>(this)->impl->update_if_changed();
-	return impl->list_style;
+	return impl->style->list_style;
 }
 
 int CSSComputedValues::get_list_style_generation() const
@@ -168,7 +217,7 @@ int CSSComputedValues::get_list_style_generation() const
 const CSSComputedMargin &CSSComputedValues::get_margin() const
 {
 	const_cast<CSSComputedValues*>(this)->impl->update_if_changed();
-	return impl->margin;
+	return impl->style->margin;
 }
 
 int CSSComputedValues::get_margin_generation() const
@@ -180,7 +229,7 @@ int CSSComputedValues::get_margin_generation() const
 const CSSComputedMiscReset &CSSComputedValues::get_misc_reset() const
 {
 	const_cast<CSSComputedValues*>(this)->impl->update_if_changed();
-	return impl->misc_reset;
+	return impl->style->misc_reset;
 }
 
 int CSSComputedValues::get_misc_reset_generation() const
@@ -192,7 +241,7 @@ int CSSComputedValues::get_misc_reset_generation() const
 const CSSComputedMiscInherit &CSSComputedValues::get_misc_inherit() const
 {
 	const_cast<CSSComputedValues*>(this)->impl->update_if_changed();
-	return impl->misc_inherit;
+	return impl->style->misc_inherit;
 }
 
 int CSSComputedValues::get_misc_inherit_generation() const
@@ -204,7 +253,7 @@ int CSSComputedValues::get_misc_inherit_generation() const
 const CSSComputedOutline &CSSComputedValues::get_outline() const
 {
 	const_cast<CSSComputedValues*>(this)->impl->update_if_changed();
-	return impl->outline;
+	return impl->style->outline;
 }
 
 int CSSComputedValues::get_outline_generation() const
@@ -216,7 +265,7 @@ int CSSComputedValues::get_outline_generation() const
 const CSSComputedPadding &CSSComputedValues::get_padding() const
 {
 	const_cast<CSSComputedValues*>(this)->impl->update_if_changed();
-	return impl->padding;
+	return impl->style->padding;
 }
 
 int CSSComputedValues::get_padding_generation() const
@@ -228,7 +277,7 @@ int CSSComputedValues::get_padding_generation() const
 const CSSComputedTableReset &CSSComputedValues::get_table_reset() const
 {
 	const_cast<CSSComputedValues*>(this)->impl->update_if_changed();
-	return impl->table_reset;
+	return impl->style->table_reset;
 }
 
 int CSSComputedValues::get_table_reset_generation() const
@@ -240,7 +289,7 @@ int CSSComputedValues::get_table_reset_generation() const
 const CSSComputedTableInherit &CSSComputedValues::get_table_inherit() const
 {
 	const_cast<CSSComputedValues*>(this)->impl->update_if_changed();
-	return impl->table_inherit;
+	return impl->style->table_inherit;
 }
 
 int CSSComputedValues::get_table_inherit_generation() const
@@ -252,7 +301,7 @@ int CSSComputedValues::get_table_inherit_generation() const
 const CSSComputedTextReset &CSSComputedValues::get_text_reset() const
 {
 	const_cast<CSSComputedValues*>(this)->impl->update_if_changed();
-	return impl->text_reset;
+	return impl->style->text_reset;
 }
 
 int CSSComputedValues::get_text_reset_generation() const
@@ -264,7 +313,7 @@ int CSSComputedValues::get_text_reset_generation() const
 const CSSComputedTextInherit &CSSComputedValues::get_text_inherit() const
 {
 	const_cast<CSSComputedValues*>(this)->impl->update_if_changed();
-	return impl->text_inherit;
+	return impl->style->text_inherit;
 }
 
 int CSSComputedValues::get_text_inherit_generation() const
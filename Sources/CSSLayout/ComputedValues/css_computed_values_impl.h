@@ -51,6 +51,35 @@
 namespace clan
 {
 
+/// Computed style data. Immutable once computed, so equivalent siblings can share one instance.
+class CSSComputedStyle
+{
+public:
+	CSSComputedStyle() : resource_cache(0) { }
+
+	CSSComputedBox box;
+	CSSComputedBackground background;
+	CSSComputedBorder border;
+	CSSComputedCounter counter;
+	CSSComputedFlex flex;
+	CSSComputedFont font;
+	CSSComputedGeneric generic_values;
+	CSSComputedListStyle list_style;
+	CSSComputedMargin margin;
+	CSSComputedMiscReset misc_reset;
+	CSSComputedMiscInherit misc_inherit;
+	CSSComputedOutline outline;
+	CSSComputedPadding padding;
+	CSSComputedTableReset table_reset;
+	CSSComputedTableInherit table_inherit;
+	CSSComputedTextReset text_reset;
+	CSSComputedTextInherit text_inherit;
+
+	// Sharing key: two elements with the same parent, resource cache and selected values compute the same style
+	std::vector<CSSPropertyValue *> selected_values;
+	CSSResourceCache *resource_cache;
+};
+
 class CSSComputedValues_Impl
 {
 public:
@@ -60,63 +89,35 @@ public:
 	void set_parent(const CSSComputedValues &parent);
 	void set_specified_values_changed();
 	void update_if_changed();
+	void update_descendants();
 
 	CSSComputedValues parent;
 	std::vector<CSSComputedValues_Impl *> children;
 
 	bool specified_values_changed;
 
-	CSSComputedBox box;
+	std::shared_ptr<CSSComputedStyle> style;
 	int box_generation;
-
-	CSSComputedBackground background;
 	int background_generation;
-
-	CSSComputedBorder border;
 	int border_generation;
-
-	CSSComputedCounter counter;
 	int counter_generation;
-
-	CSSComputedFlex flex;
 	int flex_generation;
-
-	CSSComputedFont font;
 	int font_generation;
-
-	CSSComputedGeneric generic_values;
 	int generic_generation;
-
-	CSSComputedListStyle list_style;
 	int list_style_generation;
-
-	CSSComputedMargin margin;
 	int margin_generation;
-
-	CSSComputedMiscReset misc_reset;
 	int misc_reset_generation;
-
-	CSSComputedMiscInherit misc_inherit;
 	int misc_inherit_generation;
-
-	CSSComputedOutline outline;
 	int outline_generation;
-
-	CSSComputedPadding padding;
 	int padding_generation;
-
-	CSSComputedTableReset table_reset;
 	int table_reset_generation;
-
-	CSSComputedTableInherit table_inherit;
 	int table_inherit_generation;
-
-	CSSComputedTextReset text_reset;
 	int text_reset_generation;
-
-	CSSComputedTextInherit text_inherit;
 	int text_inherit_generation;
 
+	// Recently computed child styles that siblings with the same selected values can share
+	std::vector<std::shared_ptr<CSSComputedStyle> > shared_child_styles;
+
 	CSSSelectResult selected_values;
 	CSSStyleProperties style_values;
 
@@ -124,290 +125,178 @@ public:
 
 private:
 	void detach_from_parent();
+	bool is_style_shareable() const;
+	std::shared_ptr<CSSComputedStyle> find_shared_style() const;
+	void add_shared_style(const std::shared_ptr<CSSComputedStyle> &shared_style);
+	void increment_generations();
+
+	enum { max_shared_child_styles = 8 };
 };
 
 class CSSComputedValuesUpdateSession : public CSSComputedValuesUpdater
 {
 public:
 	CSSComputedValuesUpdateSession(CSSComputedValues_Impl *values)
-		: values(values), box_updated(false), background_updated(false), border_updated(false), counter_updated(false),
+		: values(values), style(new CSSComputedStyle()), box_updated(false), background_updated(false), border_updated(false), counter_updated(false),
 		flex_updated(false), font_updated(false), generic_updated(false), list_style_updated(false), margin_updated(false),
 		misc_reset_updated(false), misc_inherit_updated(false), outline_updated(false), padding_updated(false),
 		table_reset_updated(false), table_inherit_updated(false), text_reset_updated(false), text_inherit_updated(false)
 	{
+		style->resource_cache = values->resource_cache;
+		if (!values->selected_values.is_null())
+			style->selected_values = values->selected_values.get_values();
 	}
 
 	CSSComputedBox &get_box()
 	{
-		if (!box_updated)
-		{
-			values->box = CSSComputedBox();
-			box_updated = true;
-		}
-		return values->box;
+		box_updated = true;
+		return style->box;
 	}
 
 	CSSComputedBackground &get_background()
 	{
-		if (!background_updated)
-		{
-			values->background = CSSComputedBackground();
-			background_updated = true;
-		}
-		return values->background;
+		background_updated = true;
+		return style->background;
 	}
 
 	CSSComputedBorder &get_border()
 	{
-		if (!border_updated)
-		{
-			values->border = CSSComputedBorder();
-			border_updated = true;
-		}
-		return values->border;
+		border_updated = true;
+		return style->border;
 	}
 
 	CSSComputedCounter &get_counter()
 	{
-		if (!counter_updated)
-		{
-			values->counter = CSSComputedCounter();
-			counter_updated = true;
-		}
-		return values->counter;
+		counter_updated = true;
+		return style->counter;
 	}
 
 	CSSComputedFlex &get_flex()
 	{
-		if (!flex_updated)
-		{
-			values->flex = CSSComputedFlex();
-			flex_updated = true;
-		}
-		return values->flex;
+		flex_updated = true;
+		return style->flex;
 	}
 
 	CSSComputedFont &get_font()
 	{
-		if (!font_updated)
-		{
-			values->font = CSSComputedFont();
-			font_updated = true;
-		}
-		return values->font;
+		font_updated = true;
+		return style->font;
 	}
 
 	CSSComputedGeneric &get_generic()
 	{
-		if (!generic_updated)
-		{
-			values->generic_values = CSSComputedGeneric();
-			generic_updated = true;
-		}
-		return values->generic_values;
+		generic_updated = true;
+		return style->generic_values;
 	}
 
 	CSSComputedListStyle &get_list_style()
 	{
-		if (!list_style_updated)
-		{
-			values->list_style = CSSComputedListStyle();
-			list_style_updated = true;
-		}
-		return values->list_style;
+		list_style_updated = true;
+		return style->list_style;
 	}
 
 	CSSComputedMargin &get_margin()
 	{
-		if (!margin_updated)
-		{
-			values->margin = CSSComputedMargin();
-			margin_updated = true;
-		}
-		return values->margin;
+		margin_updated = true;
+		return style->margin;
 	}
 
 	CSSComputedMiscReset &get_misc_reset()
 	{
-		if (!misc_reset_updated)
-		{
-			values->misc_reset = CSSComputedMiscReset();
-			misc_reset_updated = true;
-		}
-		return values->misc_reset;
+		misc_reset_updated = true;
+		return style->misc_reset;
 	}
 
 	CSSComputedMiscInherit &get_misc_inherit()
 	{
-		if (!misc_inherit_updated)
-		{
-			values->misc_inherit = CSSComputedMiscInherit();
-			misc_inherit_updated = true;
-		}
-		return values->misc_inherit;
+		misc_inherit_updated = true;
+		return style->misc_inherit;
 	}
 
 	CSSComputedOutline &get_outline()
 	{
-		if (!outline_updated)
-		{
-			values->outline = CSSComputedOutline();
-			outline_updated = true;
-		}
-		return values->outline;
+		outline_updated = true;
+		return style->outline;
 	}
 
 	CSSComputedPadding &get_padding()
 	{
-		if (!padding_updated)
-		{
-			values->padding = CSSComputedPadding();
-			padding_updated = true;
-		}
-		return values->padding;
+		padding_updated = true;
+		return style->padding;
 	}
 
 	CSSComputedTableReset &get_table_reset()
 	{
-		if (!table_reset_updated)
-		{
-			values->table_reset = CSSComputedTableReset();
-			table_reset_updated = true;
-		}
-		return values->table_reset;
+		table_reset_updated = true;
+		return style->table_reset;
 	}
 
 	CSSComputedTableInherit &get_table_inherit()
 	{
-		if (!table_inherit_updated)
-		{
-			values->table_inherit = CSSComputedTableInherit();
-			table_inherit_updated = true;
-		}
-		return values->table_inherit;
+		table_inherit_updated = true;
+		return style->table_inherit;
 	}
 
 	CSSComputedTextReset &get_text_reset()
 	{
-		if (!text_reset_updated)
-		{
-			values->text_reset = CSSComputedTextReset();
-			text_reset_updated = true;
-		}
-		return values->text_reset;
+		text_reset_updated = true;
+		return style->text_reset;
 	}
 
 	CSSComputedTextInherit &get_text_inherit()
 	{
-		if (!text_inherit_updated)
-		{
-			values->text_inherit = CSSComputedTextInherit();
-			text_inherit_updated = true;
-		}
-		return values->text_inherit;
+		text_inherit_updated = true;
+		return style->text_inherit;
 	}
 
 	void compute()
 	{
 		// To do: use the updated booleans to only partially compute properties
 
-		// Until the above to do has been implemented we must initialize all existing structures:
-
-		if (!box_updated)
-			values->box = CSSComputedBox();
-		if (!background_updated)
-			values->background = CSSComputedBackground();
-		if (!border_updated)
-			values->border = CSSComputedBorder();
-		if (!counter_updated)
-			values->counter = CSSComputedCounter();
-		if (!flex_updated)
-			values->flex = CSSComputedFlex();
-		if (!font_updated)
-			values->font = CSSComputedFont();
-		if (!generic_updated)
-			values->generic_values = CSSComputedGeneric();
-		if (!list_style_updated)
-			values->list_style = CSSComputedListStyle();
-		if (!margin_updated)
-			values->margin = CSSComputedMargin();
-		if (!misc_reset_updated)
-			values->misc_reset = CSSComputedMiscReset();
-		if (!misc_inherit_updated)
-			values->misc_inherit = CSSComputedMiscInherit();
-		if (!outline_updated)
-			values->outline = CSSComputedOutline();
-		if (!padding_updated)
-			values->padding = CSSComputedPadding();
-		if (!table_reset_updated)
-			values->table_reset = CSSComputedTableReset();
-		if (!table_inherit_updated)
-			values->table_inherit = CSSComputedTableInherit();
-		if (!text_reset_updated)
-			values->text_reset = CSSComputedTextReset();
-		if (!text_inherit_updated)
-			values->text_inherit = CSSComputedTextInherit();
-
 		// Compute everything:
 
-		values->font.compute(values->parent, values->resource_cache);
-		values->font_generation++;
+		style->font.compute(values->parent, values->resource_cache);
 
-		float em_size = values->font.font_size.length.value;
+		float em_size = style->font.font_size.length.value;
 		float ex_size = em_size * 0.5f;
 
 		bool is_before_or_after_pseudo_element = false;
 
-		values->box.compute(values->parent, values->resource_cache, em_size, ex_size);
-		values->box_generation++;
+		style->box.compute(values->parent, values->resource_cache, em_size, ex_size);
 
-		values->background.compute(values->parent, values->resource_cache, em_size, ex_size);
-		values->background_generation++;
+		style->background.compute(values->parent, values->resource_cache, em_size, ex_size);
 
-		values->text_reset.compute(values->parent, values->resource_cache, em_size, ex_size, values->font.line_height);
-		values->text_reset_generation++;
+		style->text_reset.compute(values->parent, values->resource_cache, em_size, ex_size, style->font.line_height);
 
-		values->text_inherit.compute(values->parent, values->resource_cache, em_size, ex_size);
-		values->text_inherit_generation++;
+		style->text_inherit.compute(values->parent, values->resource_cache, em_size, ex_size);
 
-		values->border.compute(values->parent, values->resource_cache, em_size, ex_size, values->text_inherit.color.color);
-		values->border_generation++;
+		style->border.compute(values->parent, values->resource_cache, em_size, ex_size, style->text_inherit.color.color);
 
-		values->counter.compute(values->parent, values->resource_cache, em_size, ex_size);
-		values->counter_generation++;
+		style->counter.compute(values->parent, values->resource_cache, em_size, ex_size);
 
-		values->flex.compute(values->parent, values->resource_cache, em_size, ex_size);
-		values->flex_generation++;
+		style->flex.compute(values->parent, values->resource_cache, em_size, ex_size);
 
-		values->generic_values.compute(values->parent, values->resource_cache, em_size, ex_size);
-		values->generic_generation++;
+		style->generic_values.compute(values->parent, values->resource_cache, em_size, ex_size);
 
-		values->list_style.compute(values->parent, values->resource_cache, em_size, ex_size);
-		values->list_style_generation++;
+		style->list_style.compute(values->parent, values->resource_cache, em_size, ex_size);
 
-		values->margin.compute(values->parent, values->resource_cache, em_size, ex_size);
-		values->margin_generation++;
+		style->margin.compute(values->parent, values->resource_cache, em_size, ex_size);
 
-		values->misc_reset.compute(values->parent, values->resource_cache, em_size, ex_size, is_before_or_after_pseudo_element);
-		values->misc_reset_generation++;
+		style->misc_reset.compute(values->parent, values->resource_cache, em_size, ex_size, is_before_or_after_pseudo_element);
 
-		values->misc_inherit.compute(values->parent, values->resource_cache, em_size, ex_size);
-		values->misc_inherit_generation++;
+		style->misc_inherit.compute(values->parent, values->resource_cache, em_size, ex_size);
 
-		values->outline.compute(values->parent, values->resource_cache, em_size, ex_size);
-		values->outline_generation++;
+		style->outline.compute(values->parent, values->resource_cache, em_size, ex_size);
 
-		values->padding.compute(values->parent, values->resource_cache, em_size, ex_size);
-		values->padding_generation++;
+		style->padding.compute(values->parent, values->resource_cache, em_size, ex_size);
 
-		values->table_reset.compute(values->parent, values->resource_cache, em_size, ex_size);
-		values->table_reset_generation++;
+		style->table_reset.compute(values->parent, values->resource_cache, em_size, ex_size);
 
-		values->table_inherit.compute(values->parent, values->resource_cache, em_size, ex_size);
-		values->table_inherit_generation++;
+		style->table_inherit.compute(values->parent, values->resource_cache, em_size, ex_size);
 	}
 
 	CSSComputedValues_Impl *values;
+	std::shared_ptr<CSSComputedStyle> style;
 	bool box_updated;
 	bool background_updated;
 	bool border_updated;
@@ -476,6 +365,7 @@ inline void CSSComputedValues_Impl::detach_from_parent()
 inline void CSSComputedValues_Impl::set_specified_values_changed()
 {
 	specified_values_changed = true;
+	shared_child_styles.clear();
 	for (size_t i = 0; i < children.size(); i++)
 		children[i]->set_specified_values_changed();
 }
@@ -484,30 +374,104 @@ inline void CSSComputedValues_Impl::update_if_changed()
 {
 	if (specified_values_changed)
 	{
-		CSSComputedValuesUpdateSession updater(this);
+		bool shareable = is_style_shareable();
+		std::shared_ptr<CSSComputedStyle> shared_style;
+		if (shareable)
+			shared_style = find_shared_style();
 
-		if (!selected_values.is_null())
+		if (shared_style)
+		{
+			style = shared_style;
+		}
+		else
 		{
-			const std::vector<CSSPropertyValue *> &selected_values_vector = selected_values.get_values();
-			for (size_t i = selected_values_vector.size(); i > 0; --i)
+			CSSComputedValuesUpdateSession updater(this);
+
+			if (!selected_values.is_null())
 			{
-				selected_values_vector[i-1]->apply(&updater);
+				const std::vector<CSSPropertyValue *> &selected_values_vector = selected_values.get_values();
+				for (size_t i = selected_values_vector.size(); i > 0; --i)
+				{
+					selected_values_vector[i-1]->apply(&updater);
+				}
 			}
-		}
 
-		if (!style_values.is_null())
-		{
-			const std::vector<std::unique_ptr<CSSPropertyValue> > &style_values_vector = style_values.get_values();
-			for (size_t i = style_values_vector.size(); i > 0; --i)
+			if (!style_values.is_null())
 			{
-				style_values_vector[i-1]->apply(&updater);
+				const std::vector<std::unique_ptr<CSSPropertyValue> > &style_values_vector = style_values.get_values();
+				for (size_t i = style_values_vector.size(); i > 0; --i)
+				{
+					style_values_vector[i-1]->apply(&updater);
+				}
 			}
-		}
 
-		updater.compute();
+			updater.compute();
+			style = updater.style;
 
+			if (shareable)
+				add_shared_style(style);
+		}
+
+		increment_generations();
 		specified_values_changed = false;
 	}
 }
 
+inline void CSSComputedValues_Impl::update_descendants()
+{
+	for (size_t i = 0; i < children.size(); i++)
+	{
+		children[i]->update_if_changed();
+		children[i]->update_descendants();
+	}
+}
+
+inline bool CSSComputedValues_Impl::is_style_shareable() const
+{
+	// Inline style declarations are unique to the element, and without a parent there are no siblings
+	return parent.impl && !selected_values.is_null() && (style_values.is_null() || style_values.get_values().empty());
+}
+
+inline std::shared_ptr<CSSComputedStyle> CSSComputedValues_Impl::find_shared_style() const
+{
+	const std::vector<CSSPropertyValue *> &values = selected_values.get_values();
+	const std::vector<std::shared_ptr<CSSComputedStyle> > &candidates = parent.impl->shared_child_styles;
+	for (size_t i = candidates.size(); i > 0; --i)
+	{
+		const CSSComputedStyle *candidate = candidates[i-1].get();
+		if (candidate->resource_cache == resource_cache && candidate->selected_values == values)
+			return candidates[i-1];
+	}
+	return std::shared_ptr<CSSComputedStyle>();
+}
+
+inline void CSSComputedValues_Impl::add_shared_style(const std::shared_ptr<CSSComputedStyle> &shared_style)
+{
+	std::vector<std::shared_ptr<CSSComputedStyle> > &cache = parent.impl->shared_child_styles;
+	if (cache.size() == max_shared_child_styles)
+		cache.erase(cache.begin());
+	cache.push_back(shared_style);
+}
+
+inline void CSSComputedValues_Impl::increment_generations()
+{
+	box_generation++;
+	background_generation++;
+	border_generation++;
+	counter_generation++;
+	flex_generation++;
+	font_generation++;
+	generic_generation++;
+	list_style_generation++;
+	margin_generation++;
+	misc_reset_generation++;
+	misc_inherit_generation++;
+	outline_generation++;
+	padding_generation++;
+	table_reset_generation++;
+	table_inherit_generation++;
+	text_reset_generation++;
+	text_inherit_generation++;
+}
+
 }
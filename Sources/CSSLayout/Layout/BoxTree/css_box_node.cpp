@@ -34,7 +34,7 @@ namespace clan
 {
 
 CSSBoxNode::CSSBoxNode()
-: parent(0), next(0), prev(0), first_child(0), last_child(0)
+: parent(0), next(0), prev(0), first_child(0), last_child(0), layout_dirty(true)
 {
 }
 
@@ -60,6 +60,8 @@ void CSSBoxNode::insert(CSSBoxNode *new_child, CSSBoxNode *insert_point)
 	if (insert_point && insert_point->parent != this)
 		throw Exception("CSSBoxNode::insert misuse!");
 
+	set_layout_dirty();
+
 	new_child->parent = this;
 	if (insert_point)
 	{
@@ -87,6 +89,9 @@ void CSSBoxNode::insert(CSSBoxNode *new_child, CSSBoxNode *insert_point)
 
 void CSSBoxNode::remove()
 {
+	if (parent)
+		parent->set_layout_dirty();
+
 	if (prev)
 		prev->next = next;
 
@@ -119,4 +124,25 @@ const CSSLayoutUserData *CSSBoxNode::get_user_data() const
 	return user_data.get();
 }
 
+void CSSBoxNode::set_layout_dirty()
+{
+	// A dirty node always has dirty ancestors, so the walk can stop at the first one already flagged
+	CSSBoxNode *cur = this;
+	while (cur && !cur->layout_dirty)
+	{
+		cur->layout_dirty = true;
+		cur = cur->parent;
+	}
+}
+
+void CSSBoxNode::clear_layout_dirty()
+{
+	if (layout_dirty)
+	{
+		layout_dirty = false;
+		for (CSSBoxNode *child = first_child; child; child = child->next)
+			child->clear_layout_dirty();
+	}
+}
+
 }
@@ -49,6 +49,11 @@ public:
 	CSSLayoutUserData *get_user_data();
 	const CSSLayoutUserData *get_user_data() const;
 
+	/// \brief Flags this node as changed since the last layout, along with all its ancestors
+	void set_layout_dirty();
+	void clear_layout_dirty();
+	bool is_layout_dirty() const { return layout_dirty; }
+
 	CSSBoxNode *get_parent() { return parent; }
 	CSSBoxNode *get_next_sibling() { return next; }
 	CSSBoxNode *get_prev_sibling() { return prev; }
@@ -68,6 +73,7 @@ private:
 	CSSBoxNode *first_child;
 	CSSBoxNode *last_child;
 	std::unique_ptr<CSSLayoutUserData> user_data;
+	bool layout_dirty;
 };
 
 }
@@ -39,6 +39,7 @@ void CSSBoxText::set_text(const std::string &new_text)
 	processed_text = text;
 	processed_selection_start = selection_start;
 	processed_selection_end = selection_end;
+	set_layout_dirty();
 }
 
 const CSSBoxElement *CSSBoxText::get_parent_element() const
@@ -47,6 +47,7 @@ public:
 	std::string text;
 	std::string::size_type selection_start, selection_end;
 	std::string processed_text;
+	std::string last_processed_text; // processed_text of the previous layout, only valid during CSSBoxTree::prepare
 	std::string::size_type processed_selection_start, processed_selection_end;
 
 	const CSSBoxElement *get_parent_element() const;
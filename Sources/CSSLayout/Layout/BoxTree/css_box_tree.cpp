@@ -77,9 +77,16 @@ void CSSBoxTree::prepare(CSSResourceCache *resource_cache)
 	propagate_html_body();
 	convert_run_in_blocks(root_element);
 	CSSWhitespaceEraser::remove_whitespace(root_element);
+	detect_processed_text_changes();
 	filter_table(resource_cache);
 }
 
+void CSSBoxTree::clear_layout_dirty()
+{
+	if (root_element)
+		root_element->clear_layout_dirty();
+}
+
 void CSSBoxTree::clean(CSSBoxNode *node)
 {
 	if (node == 0)
@@ -87,7 +94,10 @@ void CSSBoxTree::clean(CSSBoxNode *node)
 
 	CSSBoxText *text = dynamic_cast<CSSBoxText*>(node);
 	if (text)
+	{
+		text->last_processed_text.swap(text->processed_text);
 		text->processed_text = text->text;
+	}
 	
 	CSSBoxNode *child = node->get_first_child();
 	while (child)
@@ -97,6 +107,29 @@ void CSSBoxTree::clean(CSSBoxNode *node)
 	}
 }
 
+void CSSBoxTree::detect_processed_text_changes(CSSBoxNode *node)
+{
+	if (node == 0)
+		node = root_element;
+
+	// Whitespace collapsing depends on the neighbouring text, so an edit can change
+	// the processed text of nodes that were not touched themselves.
+	CSSBoxText *text = dynamic_cast<CSSBoxText*>(node);
+	if (text)
+	{
+		if (text->processed_text != text->last_processed_text)
+			text->set_layout_dirty();
+		std::string().swap(text->last_processed_text);
+	}
+
+	CSSBoxNode *child = node->get_first_child();
+	while (child)
+	{
+		detect_processed_text_changes(child);
+		child = child->get_next_sibling();
+	}
+}
+
 void CSSBoxTree::clear()
 {
 	delete root_element;
@@ -49,6 +49,7 @@ public:
 	void set_root_element(CSSBoxElement *new_root_element);
 	void set_html_body_element(CSSBoxElement *new_html_body_element);
 	void prepare(CSSResourceCache *resource_cache);
+	void clear_layout_dirty();
 	void set_selection(CSSBoxNode *start, size_t start_text_offset, CSSBoxNode *end, size_t end_text_offset);
 
 	CSSDocument css;
@@ -59,6 +60,7 @@ public:
 
 private:
 	void clean(CSSBoxNode *node = 0);
+	void detect_processed_text_changes(CSSBoxNode *node = 0);
 	CSSBoxNode *create_node(const DomNode &node, CSSBoxNode *parent = 0);
 	void create_pseudo_element(CSSBoxElement *box_element, const DomElement &dom_element, const std::string &pseudo_element);
 	void propagate_html_body();
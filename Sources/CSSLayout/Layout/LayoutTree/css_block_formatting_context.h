@@ -57,6 +57,7 @@ public:
 	int get_local_x() const { return x; }
 	int get_local_y() const { return y; }
 	CSSBlockFormattingContext *get_parent() { return parent; }
+	void set_parent(CSSBlockFormattingContext *new_parent) { parent = new_parent; }
 
 private:
 	static bool is_null(const Rect &box);
@@ -57,14 +57,25 @@ void CSSLayoutTree::clear()
 {
 	delete root_stacking_context;
 	root_stacking_context = 0;
-	delete root_layout;
+	for (LayoutMap::iterator it = layouts.begin(); it != layouts.end(); ++it)
+		delete it->second;
+	layouts.clear();
 	root_layout = 0;
 }
 
 void CSSLayoutTree::create(CSSBoxElement *element)
 {
-	clear();
+	delete root_stacking_context;
+	root_stacking_context = 0;
+
+	// Layout nodes for subtrees that did not change since the last create are moved over
+	// to the new tree with their cached layout. Everything left behind is deleted.
+	previous_layouts.swap(layouts);
 	root_layout = create_layout(element);
+
+	for (LayoutMap::iterator it = previous_layouts.begin(); it != previous_layouts.end(); ++it)
+		delete it->second;
+	previous_layouts.clear();
 }
 
 void CSSLayoutTree::layout(CSSLayoutGraphics *graphics, CSSResourceCache *resource_cache, const Size &viewport)
@@ -114,6 +125,10 @@ Rect CSSLayoutTree::get_content_box(CSSBoxElement *element)
 
 CSSLayoutTreeNode *CSSLayoutTree::create_layout(CSSBoxElement *element)
 {
+	CSSLayoutTreeNode *reused_layout = reuse_layout(element);
+	if (reused_layout)
+		return reused_layout;
+
 	if (element->is_block_level() || element->is_inline_block_level())
 	{
 		if (dynamic_cast<CSSBoxObject*>(element))
@@ -165,6 +180,7 @@ CSSTableLayout *CSSLayoutTree::create_table_level_layout(CSSBoxElement *element)
 	*/
 
 	CSSTableLayout *table = new CSSTableLayout(element);
+	layouts[element] = table;
 	// bool in_table_row = false;
 
 	CSSBoxNodeWalker walker(element->get_first_child(), false);
@@ -229,12 +245,19 @@ CSSTableLayout *CSSLayoutTree::create_table_level_layout(CSSBoxElement *element)
 
 CSSReplacedLayout *CSSLayoutTree::create_replaced_level_layout(CSSBoxObject *object)
 {
-	return new CSSReplacedLayout(object);
+	CSSReplacedLayout *replaced = static_cast<CSSReplacedLayout*>(reuse_layout(object));
+	if (replaced == 0)
+	{
+		replaced = new CSSReplacedLayout(object);
+		layouts[object] = replaced;
+	}
+	return replaced;
 }
 
 CSSInlineLayout *CSSLayoutTree::create_inline_level_layout(CSSBoxElement *element)
 {
 	CSSInlineLayout *inline_layout = new CSSInlineLayout(element);
+	layouts[element] = inline_layout;
 
 	CSSBoxNode *cur = element->get_first_child();
 	while (cur)
@@ -292,4 +315,40 @@ CSSInlineGeneratedBox *CSSLayoutTree::create_inline_generated_box(CSSBoxNode *cu
 	}
 }
 
+CSSLayoutTreeNode *CSSLayoutTree::reuse_layout(CSSBoxElement *element)
+{
+	if (element->is_layout_dirty())
+		return 0;
+
+	LayoutMap::iterator it = previous_layouts.find(element);
+	if (it == previous_layouts.end())
+		return 0;
+
+	CSSLayoutTreeNode *layout = it->second;
+	previous_layouts.erase(it);
+	layouts[element] = layout;
+
+	// The subtree is clean, so the nested layout nodes are still wired up exactly as before
+	adopt_descendant_layouts(element);
+	return layout;
+}
+
+void CSSLayoutTree::adopt_descendant_layouts(CSSBoxNode *node)
+{
+	for (CSSBoxNode *child = node->get_first_child(); child; child = child->get_next_sibling())
+	{
+		CSSBoxElement *child_element = dynamic_cast<CSSBoxElement*>(child);
+		if (child_element)
+		{
+			LayoutMap::iterator it = previous_layouts.find(child_element);
+			if (it != previous_layouts.end())
+			{
+				layouts[child_element] = it->second;
+				previous_layouts.erase(it);
+			}
+		}
+		adopt_descendant_layouts(child);
+	}
+}
+
 }
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <map>
+
 namespace clan
 {
 
@@ -65,8 +67,14 @@ private:
 	CSSInlineGeneratedBox *create_inline_generated_box(CSSBoxNode *cur);
 	CSSReplacedLayout *create_replaced_level_layout(CSSBoxObject *object);
 	CSSTableLayout *create_table_level_layout(CSSBoxElement *element);
+	CSSLayoutTreeNode *reuse_layout(CSSBoxElement *element);
+	void adopt_descendant_layouts(CSSBoxNode *node);
+
+	typedef std::map<CSSBoxElement *, CSSLayoutTreeNode *> LayoutMap;
 
 	CSSLayoutTreeNode *root_layout;
+	LayoutMap layouts; // Owns all layout nodes in the tree
+	LayoutMap previous_layouts; // Layout nodes from the previous tree while create is running
 	CSSStackingContext *root_stacking_context;
 };
 
@@ -58,9 +58,9 @@ CSSLayoutTreeNode::~CSSLayoutTreeNode()
 void CSSLayoutTreeNode::prepare(CSSBlockFormattingContext *current_formatting_context, CSSStackingContext *current_stacking_context)
 {
 	if (current_formatting_context == 0 || element_node->is_inline_block_level() || element_node->is_float() || element_node->is_table() || element_node->is_table_cell() || is_replaced() || element_node->is_absolute() || !element_node->is_overflow_visible())
-		set_formatting_context(new CSSBlockFormattingContext(current_formatting_context), true);
+		set_root_formatting_context(current_formatting_context);
 	else if (element_node->is_fixed())
-		set_formatting_context(new CSSBlockFormattingContext(0), true);
+		set_root_formatting_context(0);
 	else
 		set_formatting_context(current_formatting_context, false);
 	establish_stacking_context_if_needed(current_stacking_context);
@@ -647,7 +647,7 @@ void CSSLayoutTreeNode::set_root_content_position(int x, int y)
 
 void CSSLayoutTreeNode::calc_preferred(CSSLayoutGraphics *graphics, CSSResourceCache *resources)
 {
-	if (!preferred_width_calculated)
+	if (!preferred_width_calculated || preferred_containing_width.value != containing_width.value || preferred_containing_width.expanding != containing_width.expanding)
 	{
 		calculate_top_down_widths(preferred_strategy);
 		calculate_top_down_heights();
@@ -657,7 +657,7 @@ void CSSLayoutTreeNode::calc_preferred(CSSLayoutGraphics *graphics, CSSResourceC
 
 void CSSLayoutTreeNode::calc_minimum(CSSLayoutGraphics *graphics, CSSResourceCache *resources)
 {
-	if (!min_width_calculated)
+	if (!min_width_calculated || min_containing_width.value != containing_width.value || min_containing_width.expanding != containing_width.expanding)
 	{
 		calculate_top_down_widths(minimum_strategy);
 		calculate_top_down_heights();
@@ -880,6 +880,14 @@ void CSSLayoutTreeNode::layout_formatting_root_helper(CSSLayoutGraphics *graphic
 		Sleep(1);
 	}*/
 
+	if (strategy == normal_strategy && is_layout_cache_hit())
+	{
+		height.value = layout_cache.result_height;
+		content_box = Size(used_to_actual(width.value), used_to_actual(height.value));
+		return;
+	}
+
+	CSSUsedHeight height_input = height;
 	formatting_context->clear();
 
 	CSSLayoutCursor cursor;
@@ -896,11 +904,13 @@ void CSSLayoutTreeNode::layout_formatting_root_helper(CSSLayoutGraphics *graphic
 	{
 		preferred_width = width.value;
 		preferred_width_calculated = true;
+		preferred_containing_width = containing_width;
 	}
 	else if (strategy == minimum_strategy)
 	{
 		min_width = width.value;
 		min_width_calculated = true;
+		min_containing_width = containing_width;
 	}
 
 	if (height.use_content)
@@ -916,6 +926,21 @@ void CSSLayoutTreeNode::layout_formatting_root_helper(CSSLayoutGraphics *graphic
 	}
 
 	content_box = Size(used_to_actual(width.value), used_to_actual(height.value));
+
+	layout_cache.valid = (strategy == normal_strategy);
+	layout_cache.width = width;
+	layout_cache.height = height_input;
+	layout_cache.relative_x = relative_x;
+	layout_cache.relative_y = relative_y;
+	layout_cache.result_height = height.value;
+}
+
+bool CSSLayoutTreeNode::is_layout_cache_hit() const
+{
+	return layout_cache.valid &&
+		layout_cache.width.value == width.value && layout_cache.width.expanding == width.expanding &&
+		layout_cache.height.value == height.value && layout_cache.height.use_content == height.use_content &&
+		layout_cache.relative_x == relative_x && layout_cache.relative_y == relative_y;
 }
 
 void CSSLayoutTreeNode::layout_normal(CSSLayoutGraphics *graphics, CSSLayoutCursor &cursor, LayoutStrategy strategy)
@@ -1093,6 +1118,15 @@ bool CSSLayoutTreeNode::add_margin_top(CSSLayoutCursor &cursor)
 	}
 }
 
+void CSSLayoutTreeNode::set_root_formatting_context(CSSBlockFormattingContext *parent_formatting_context)
+{
+	// Keep our own context (and the floats placed in it) when the node is reused from a previous layout
+	if (formatting_context_root)
+		formatting_context->set_parent(parent_formatting_context);
+	else
+		set_formatting_context(new CSSBlockFormattingContext(parent_formatting_context), true);
+}
+
 void CSSLayoutTreeNode::set_formatting_context(CSSBlockFormattingContext *new_formatting_context, bool is_root)
 {
 	if (formatting_context_root)
@@ -120,6 +120,8 @@ public:
 	CSSUsedValue min_width;
 	bool preferred_width_calculated;
 	bool min_width_calculated;
+	CSSUsedWidth preferred_containing_width;
+	CSSUsedWidth min_containing_width;
 	CSSUsedValue relative_x, relative_y;
 
 	Rect content_box;
@@ -151,8 +153,24 @@ protected:
 	CSSStackingContext *stacking_context;
 	bool stacking_context_root;
 
+	// Inputs and result of the last normal layout of this formatting root.
+	// A layout node is only kept between layouts while its box subtree is unchanged, so the
+	// content can be reused as long as the inputs are the same.
+	struct LayoutCache
+	{
+		LayoutCache() : valid(false), relative_x(0.0f), relative_y(0.0f), result_height(0.0f) { }
+		bool valid;
+		CSSUsedWidth width;
+		CSSUsedHeight height;
+		CSSUsedValue relative_x, relative_y;
+		CSSUsedValue result_height;
+	};
+	LayoutCache layout_cache;
+
 private:
+	bool is_layout_cache_hit() const;
 	void set_formatting_context(CSSBlockFormattingContext *formatting_context, bool is_root);
+	void set_root_formatting_context(CSSBlockFormattingContext *parent_formatting_context);
 	void establish_stacking_context_if_needed(CSSStackingContext *current_stacking_context);
 
 	void layout_shrink_to_fit(CSSLayoutGraphics *graphics, CSSResourceCache *resources, CSSUsedValue available_width);
@@ -52,18 +52,7 @@ CSSTableLayout::CSSTableLayout(CSSBoxElement *block_element)
 
 CSSTableLayout::~CSSTableLayout()
 {
-	for (size_t i = 0; i < columns.size(); i++)
-	{
-		for (size_t j = 0; j < columns[i].rows.size(); j++)
-		{
-			delete columns[i].rows[j].layout;
-		}
-	}
-
-	for (size_t i = 0; i < captions.size(); i++)
-	{
-		delete captions[i];
-	}
+	// Cell and caption layouts are owned by CSSLayoutTree
 }
 
 void CSSTableLayout::add_row(CSSBoxElement *row_element)
@@ -58,6 +58,7 @@ void CSSLayout::set_dpi(float new_dpi)
 {
 	impl->throw_if_disposed();
 	impl->resource_cache.set_dpi(new_dpi);
+	impl->layout_tree.clear();
 }
 
 void CSSLayout::layout(Canvas &canvas, const Rect &viewport)
@@ -68,6 +69,7 @@ void CSSLayout::layout(Canvas &canvas, const Rect &viewport)
 	impl->box_tree.prepare(&impl->resource_cache);
 	impl->layout_tree.create(impl->box_tree.get_root_element());
 	impl->layout_tree.layout(&graphics, &impl->resource_cache, viewport.get_size());
+	impl->box_tree.clear_layout_dirty();
 	impl->viewport = viewport;
 }
 
@@ -55,19 +55,28 @@ std::string CSSLayoutElement::get_name() const
 void CSSLayoutElement::set_name(const std::string &name)
 {
 	if (!is_null())
+	{
 		static_cast<CSSBoxElement*>(impl->box_node)->name = name;
+		impl->box_node->set_layout_dirty();
+	}
 }
 
 void CSSLayoutElement::set_col_span(int span)
 {
 	if (!is_null())
+	{
 		static_cast<CSSBoxElement*>(impl->box_node)->col_span = span;
+		impl->box_node->set_layout_dirty();
+	}
 }
 
 void CSSLayoutElement::set_row_span(int span)
 {
 	if (!is_null())
+	{
 		static_cast<CSSBoxElement*>(impl->box_node)->row_span = span;
+		impl->box_node->set_layout_dirty();
+	}
 }
 /*
 void CSSLayoutElement::apply_properties(const std::vector<CSSPropertyValue *> &properties)
@@ -52,6 +52,7 @@ void CSSLayoutObject::set_intrinsic_width(int width)
 	{
 		component->intrinsic_has_width = true;
 		component->intrinsic_width = width;
+		impl->box_node->set_layout_dirty();
 	}
 }
 
@@ -64,6 +65,7 @@ void CSSLayoutObject::set_intrinsic_height(int height)
 	{
 		component->intrinsic_has_height = true;
 		component->intrinsic_height = height;
+		impl->box_node->set_layout_dirty();
 	}
 }
 
@@ -76,6 +78,7 @@ void CSSLayoutObject::set_intrinsic_ratio(float ratio)
 	{
 		component->intrinsic_has_ratio = true;
 		component->intrinsic_ratio = ratio;
+		impl->box_node->set_layout_dirty();
 	}
 }
 
@@ -85,7 +88,10 @@ void CSSLayoutObject::set_no_intrinsic_width()
 	if (!is_null())
 		component = static_cast<CSSBoxObject*>(impl->box_node)->get_component();
 	if (component)
+	{
 		component->intrinsic_has_width = false;
+		impl->box_node->set_layout_dirty();
+	}
 }
 
 void CSSLayoutObject::set_no_intrinsic_height()
@@ -94,7 +100,10 @@ void CSSLayoutObject::set_no_intrinsic_height()
 	if (!is_null())
 		component = static_cast<CSSBoxObject*>(impl->box_node)->get_component();
 	if (component)
+	{
 		component->intrinsic_has_height = false;
+		impl->box_node->set_layout_dirty();
+	}
 }
 
 void CSSLayoutObject::set_no_intrinsic_ratio()
@@ -103,13 +112,19 @@ void CSSLayoutObject::set_no_intrinsic_ratio()
 	if (!is_null())
 		component = static_cast<CSSBoxObject*>(impl->box_node)->get_component();
 	if (component)
+	{
 		component->intrinsic_has_ratio = false;
+		impl->box_node->set_layout_dirty();
+	}
 }
 
 void CSSLayoutObject::set_component_private(CSSReplacedComponent *component)
 {
 	if (!is_null())
+	{
 		static_cast<CSSBoxObject*>(impl->box_node)->set_component(component);
+		impl->box_node->set_layout_dirty();
+	}
 	else
 		delete component;
 }
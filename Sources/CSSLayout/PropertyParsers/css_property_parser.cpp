@@ -383,6 +383,18 @@ bool CSSPropertyParser::equals(const std::string &s1, const std::string &s2)
 	return StringHelp::compare(s1, s2, true) == 0;
 }
 
+bool CSSPropertyParser::equals(const std::string &s1, const std::string::value_type *s2)
+{
+	// Keywords are compared against literals all over the parsers, so avoid creating a string for each
+	size_t i;
+	for (i = 0; i < s1.length() && s2[i] != 0; i++)
+	{
+		if (tolower((unsigned char)s1[i]) != tolower((unsigned char)s2[i]))
+			return false;
+	}
+	return i == s1.length() && s2[i] == 0;
+}
+
 void CSSPropertyParser::debug_parse_error(const std::string &name, const std::vector<CSSToken> &tokens)
 {
 	std::string s = string_format("Parse error for %1:", name);
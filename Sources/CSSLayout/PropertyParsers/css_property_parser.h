@@ -50,6 +50,7 @@ protected:
 	bool parse_integer(const std::string &value, int &out_int);
 	bool parse_color(const std::vector<CSSToken> &tokens, size_t &in_out_pos, Colorf &out_color);
 	static bool equals(const std::string &s1, const std::string &s2);
+	static bool equals(const std::string &s1, const std::string::value_type *s2);
 	void debug_parse_error(const std::string &name, const std::vector<CSSToken> &tokens);
 
 private:
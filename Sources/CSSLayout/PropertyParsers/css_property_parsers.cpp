@@ -30,6 +30,7 @@
 #include "css_property_parsers.h"
 #include "css_property_parser.h"
 #include "API/CSSLayout/CSSDocument/css_property.h"
+#include <algorithm>
 #include "AlignContent/css_parser_align_content.h"
 #include "AlignItems/css_parser_align_items.h"
 #include "AlignSelf/css_parser_align_self.h"
@@ -241,6 +242,7 @@ CSSPropertyParsers::CSSPropertyParsers()
 	add(new CSSParserAlignItems());
 	add(new CSSParserAlignSelf());
 	add(new CSSParserAlignContent());
+	build_name_table();
 }
 
 CSSPropertyParsers::~CSSPropertyParsers()
@@ -251,12 +253,10 @@ CSSPropertyParsers::~CSSPropertyParsers()
 
 void CSSPropertyParsers::parse(const CSSProperty &property, std::vector<std::unique_ptr<CSSPropertyValue> > &inout_values)
 {
-	
-	std::string name = StringHelp::text_to_lower(property.get_name());
-	std::map<std::string, CSSPropertyParser *>::iterator it = name_to_parser.find(name);
-	if (it != name_to_parser.end())
+	CSSPropertyParser *parser = find_parser(property.get_name());
+	if (parser)
 	{
-		it->second->parse(property.get_name(), property.get_value_tokens(), inout_values);
+		parser->parse(property.get_name(), property.get_value_tokens(), inout_values);
 	}
 	else
 	{
@@ -273,4 +273,104 @@ void CSSPropertyParsers::add(CSSPropertyParser *parser)
 		name_to_parser[names[i]] = parser;
 }
 
+void CSSPropertyParsers::build_name_table()
+{
+	size_t num_names = name_to_parser.size();
+	size_t num_buckets = max(num_names / 2, (size_t)1);
+
+	std::vector<std::vector<std::map<std::string, CSSPropertyParser *>::iterator> > buckets(num_buckets);
+	for (std::map<std::string, CSSPropertyParser *>::iterator it = name_to_parser.begin(); it != name_to_parser.end(); ++it)
+		buckets[hash_name(it->first, 0) % num_buckets].push_back(it);
+
+	// Place the largest buckets first while the table is still mostly empty
+	std::vector<size_t> bucket_order(num_buckets);
+	for (size_t i = 0; i < num_buckets; i++)
+		bucket_order[i] = i;
+	for (size_t i = 1; i < num_buckets; i++)
+	{
+		size_t j = i;
+		while (j > 0 && buckets[bucket_order[j - 1]].size() < buckets[bucket_order[j]].size())
+		{
+			std::swap(bucket_order[j - 1], bucket_order[j]);
+			j--;
+		}
+	}
+
+	name_bucket_seeds.assign(num_buckets, 0);
+	name_table.assign(num_names + num_names / 4 + 1, NameTableEntry());
+	for (size_t i = 0; i < num_buckets; i++)
+	{
+		const std::vector<std::map<std::string, CSSPropertyParser *>::iterator> &bucket = buckets[bucket_order[i]];
+		if (bucket.empty())
+			break;
+
+		for (unsigned int seed = 1; ; seed++)
+		{
+			std::vector<size_t> slots;
+			for (size_t j = 0; j < bucket.size(); j++)
+			{
+				size_t slot = hash_name(bucket[j]->first, seed) % name_table.size();
+				if (name_table[slot].parser || std::find(slots.begin(), slots.end(), slot) != slots.end())
+					break;
+				slots.push_back(slot);
+			}
+
+			if (slots.size() == bucket.size())
+			{
+				for (size_t j = 0; j < bucket.size(); j++)
+				{
+					name_table[slots[j]].name = bucket[j]->first;
+					name_table[slots[j]].parser = bucket[j]->second;
+				}
+				name_bucket_seeds[bucket_order[i]] = seed;
+				break;
+			}
+		}
+	}
+
+	name_to_parser.clear();
+}
+
+CSSPropertyParser *CSSPropertyParsers::find_parser(const std::string &name) const
+{
+	unsigned int seed = name_bucket_seeds[hash_name(name, 0) % name_bucket_seeds.size()];
+	if (seed == 0)
+		return 0;
+
+	const NameTableEntry &entry = name_table[hash_name(name, seed) % name_table.size()];
+	if (entry.parser && equals_lowercase(name, entry.name))
+		return entry.parser;
+	else
+		return 0;
+}
+
+unsigned int CSSPropertyParsers::hash_name(const std::string &name, unsigned int seed)
+{
+	// FNV-1a over the ASCII lowercase name
+	unsigned int hash = 2166136261U ^ (seed * 16777619U);
+	for (size_t i = 0; i < name.length(); i++)
+	{
+		unsigned char c = name[i];
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+		hash = (hash ^ c) * 16777619U;
+	}
+	return hash;
+}
+
+bool CSSPropertyParsers::equals_lowercase(const std::string &name, const std::string &lowercase_name)
+{
+	if (name.length() != lowercase_name.length())
+		return false;
+	for (size_t i = 0; i < name.length(); i++)
+	{
+		char c = name[i];
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+		if (c != lowercase_name[i])
+			return false;
+	}
+	return true;
+}
+
 }
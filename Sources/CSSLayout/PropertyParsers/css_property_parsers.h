@@ -21,9 +21,25 @@ public:
 
 private:
 	void add(CSSPropertyParser *parser);
+	void build_name_table();
+	CSSPropertyParser *find_parser(const std::string &name) const;
+	static unsigned int hash_name(const std::string &name, unsigned int seed);
+	static bool equals_lowercase(const std::string &name, const std::string &lowercase_name);
+
+	struct NameTableEntry
+	{
+		NameTableEntry() : parser(0) { }
+		std::string name;
+		CSSPropertyParser *parser;
+	};
 
 	std::vector<CSSPropertyParser *> parsers;
 	std::map<std::string, CSSPropertyParser *> name_to_parser;
+
+	// Perfect hash of the property names (hash and displace). The first hash picks a
+	// bucket, the bucket seed gives the slot. Every name has a unique slot.
+	std::vector<unsigned int> name_bucket_seeds;
+	std::vector<NameTableEntry> name_table;
 };
 
 }
@@ -0,0 +1,336 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "async_file_io_uring.h"
+
+#ifdef CL_ASYNC_FILE_IO_URING
+
+#include "API/Core/System/system.h"
+#include "API/Core/Text/string_format.h"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+namespace clan
+{
+
+// user_data of the no-op that stops the completion thread
+static const unsigned long long stop_user_data = ~0ULL;
+
+/////////////////////////////////////////////////////////////////////////////
+// AsyncFileIO_Uring Construction:
+
+AsyncFileIO_Uring::AsyncFileIO_Uring(int queue_depth)
+: AsyncFileIO_Impl(queue_depth), ring_fd(-1),
+  sq_ring(MAP_FAILED), sq_ring_size(0), sq_head(0), sq_tail(0), sq_mask(0), sq_entries(0), sq_array(0), sqes((io_uring_sqe *) MAP_FAILED), sqes_size(0),
+  cq_ring(MAP_FAILED), cq_ring_size(0), cq_head(0), cq_tail(0), cq_mask(0), cqes(0),
+  kernel_operations(0), ring_error(0)
+{
+	io_uring_params params;
+	memset(&params, 0, sizeof(io_uring_params));
+	ring_fd = syscall(__NR_io_uring_setup, queue_depth, &params);
+	if (ring_fd < 0)
+		throw Exception(string_format("io_uring_setup failed with error code %1", errno));
+
+	sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+	bool single_mmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+	single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#endif
+	if (single_mmap)
+		sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+
+	sq_ring = mmap(0, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+	if (sq_ring != MAP_FAILED)
+	{
+		if (single_mmap)
+			cq_ring = sq_ring;
+		else
+			cq_ring = mmap(0, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+	}
+	if (cq_ring != MAP_FAILED)
+		sqes = (io_uring_sqe *) mmap(0, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+
+	if (sqes == (io_uring_sqe *) MAP_FAILED)
+	{
+		int error = errno;
+		unmap_rings();
+		::close(ring_fd);
+		throw Exception(string_format("Unable to map the io_uring rings (error code %1)", error));
+	}
+
+	char *sq = (char *) sq_ring;
+	sq_head = (unsigned *) (sq + params.sq_off.head);
+	sq_tail = (unsigned *) (sq + params.sq_off.tail);
+	sq_mask = *(unsigned *) (sq + params.sq_off.ring_mask);
+	sq_entries = params.sq_entries;
+	sq_array = (unsigned *) (sq + params.sq_off.array);
+
+	char *cq = (char *) cq_ring;
+	cq_head = (unsigned *) (cq + params.cq_off.head);
+	cq_tail = (unsigned *) (cq + params.cq_off.tail);
+	cq_mask = *(unsigned *) (cq + params.cq_off.ring_mask);
+	cqes = (io_uring_cqe *) (cq + params.cq_off.cqes);
+
+	slots.resize(queue_depth);
+	free_slots.reserve(queue_depth);
+	for (int i = queue_depth - 1; i >= 0; i--)
+		free_slots.push_back(i);
+
+	completion_thread.start(this, &AsyncFileIO_Uring::completion_thread_main);
+}
+
+AsyncFileIO_Uring::~AsyncFileIO_Uring()
+{
+	cancel_and_wait();
+
+	// Nothing else uses the ring at this point, so keep trying until the stop marker is accepted
+	MutexSection mutex_lock(&mutex);
+	while (ring_error == 0)
+	{
+		io_uring_sqe *sqe = begin_sqe();
+		sqe->opcode = IORING_OP_NOP;
+		sqe->user_data = stop_user_data;
+		end_sqe();
+		if (submit_sqes())
+			break;
+		mutex_lock.unlock();
+		System::sleep(1);
+		mutex_lock.lock();
+	}
+	mutex_lock.unlock();
+
+	completion_thread.join();
+	unmap_rings();
+	::close(ring_fd);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// AsyncFileIO_Uring Implementation:
+
+void AsyncFileIO_Uring::start_operation(const std::shared_ptr<AsyncFileOperation_Impl> &operation)
+{
+	if (ring_error != 0)
+	{
+		operation_finished(operation, -ring_error);
+		return;
+	}
+
+	// The base class never has more than queue_depth operations in flight
+	int index = free_slots.back();
+	free_slots.pop_back();
+
+	slots[index].operation = operation;
+	slots[index].transferred = 0;
+	queue_transfer(index);
+}
+
+void AsyncFileIO_Uring::queue_transfer(int index)
+{
+	Slot &slot = slots[index];
+	const AsyncFileRequest &request = slot.operation->request;
+	slot.iov.iov_base = (char *) request.buffer + slot.transferred;
+	slot.iov.iov_len = request.length - slot.transferred;
+
+	io_uring_sqe *sqe = begin_sqe();
+	sqe->opcode = slot.operation->is_write ? IORING_OP_WRITEV : IORING_OP_READV;
+	sqe->fd = slot.operation->handle;
+	sqe->off = request.offset + slot.transferred;
+	sqe->addr = (unsigned long) &slot.iov;
+	sqe->len = 1;
+	sqe->user_data = index;
+	end_sqe();
+}
+
+void AsyncFileIO_Uring::flush_started_operations()
+{
+	submit_sqes();
+}
+
+bool AsyncFileIO_Uring::submit_sqes()
+{
+	while (true)
+	{
+		unsigned to_submit = *sq_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+		if (to_submit == 0)
+			return true;
+
+		int result = syscall(__NR_io_uring_enter, ring_fd, to_submit, 0, 0, 0, 0);
+		if (result > 0)
+		{
+			kernel_operations += result;
+		}
+		else if (result < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		else if (kernel_operations > 0)
+		{
+			// Out of resources. The completion thread submits the rest once the kernel finishes something
+			return true;
+		}
+		else
+		{
+			// Nothing in the kernel will ever complete and retry the submission, so fail what is left
+			fail_unsubmitted_operations(result < 0 ? errno : EIO);
+			return false;
+		}
+	}
+}
+
+void AsyncFileIO_Uring::fail_unsubmitted_operations(int error_code)
+{
+	unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+	unsigned tail = *sq_tail;
+	for (unsigned i = head; i != tail; i++)
+	{
+		unsigned long long user_data = sqes[sq_array[i & sq_mask]].user_data;
+		if (user_data != stop_user_data)
+			fail_slot((int) user_data, error_code);
+	}
+	__atomic_store_n(sq_tail, head, __ATOMIC_RELEASE);
+}
+
+void AsyncFileIO_Uring::fail_slot(int index, int error_code)
+{
+	std::shared_ptr<AsyncFileOperation_Impl> operation;
+	operation.swap(slots[index].operation);
+	free_slots.push_back(index);
+	operation_finished(operation, -error_code);
+}
+
+io_uring_sqe *AsyncFileIO_Uring::begin_sqe()
+{
+	// Only this engine writes the tail, and there are never more operations in flight than ring entries
+	unsigned tail = *sq_tail;
+	io_uring_sqe *sqe = &sqes[tail & sq_mask];
+	memset(sqe, 0, sizeof(io_uring_sqe));
+	return sqe;
+}
+
+void AsyncFileIO_Uring::end_sqe()
+{
+	unsigned tail = *sq_tail;
+	sq_array[tail & sq_mask] = tail & sq_mask;
+	__atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+void AsyncFileIO_Uring::completion_thread_main()
+{
+	bool stop = false;
+	while (!stop)
+	{
+		int result = syscall(__NR_io_uring_enter, ring_fd, 0, 1, IORING_ENTER_GETEVENTS, 0, 0);
+		if (result < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+		{
+			fail_ring(errno);
+			break;
+		}
+
+		MutexSection mutex_lock(&mutex);
+		bool requeued = false;
+		unsigned head = *cq_head;
+		unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+		while (head != tail)
+		{
+			io_uring_cqe *cqe = &cqes[head & cq_mask];
+			head++;
+
+			if (cqe->user_data == stop_user_data)
+			{
+				stop = true;
+				continue;
+			}
+
+			int index = (int) cqe->user_data;
+			Slot &slot = slots[index];
+			int result = cqe->res;
+			kernel_operations--;
+
+			// Transfer the rest after a short read or write, like the thread pool backend does.
+			// Only the end of the file or an error ends a transfer early.
+			if (result == -EINTR || result == -EAGAIN || (result > 0 && slot.transferred + result < slot.operation->request.length))
+			{
+				if (result > 0)
+					slot.transferred += result;
+				queue_transfer(index);
+				requeued = true;
+				continue;
+			}
+			if (result >= 0)
+				result += slot.transferred;
+
+			std::shared_ptr<AsyncFileOperation_Impl> operation;
+			operation.swap(slot.operation);
+			free_slots.push_back(index);
+			operation_finished(operation, result);
+		}
+		__atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+
+		if (requeued)
+			submit_sqes();
+
+		start_submitted_operations();
+	}
+}
+
+void AsyncFileIO_Uring::fail_ring(int error_code)
+{
+	// No completions can be reaped anymore. Fail everything still in the ring, so that
+	// waiters and cancel_and_wait see the operations finish, and fail later operations right away.
+	MutexSection mutex_lock(&mutex);
+	ring_error = error_code;
+	fail_unsubmitted_operations(error_code);
+	for (size_t i = 0; i < slots.size(); i++)
+	{
+		if (slots[i].operation)
+			fail_slot((int) i, error_code);
+	}
+	kernel_operations = 0;
+	start_submitted_operations();
+}
+
+void AsyncFileIO_Uring::unmap_rings()
+{
+	if (sqes != (io_uring_sqe *) MAP_FAILED)
+		munmap(sqes, sqes_size);
+	if (cq_ring != MAP_FAILED && cq_ring != sq_ring)
+		munmap(cq_ring, cq_ring_size);
+	if (sq_ring != MAP_FAILED)
+		munmap(sq_ring, sq_ring_size);
+}
+
+}
+
+#endif
@@ -0,0 +1,125 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#if defined(__linux__) && defined(__NR_io_uring_setup)
+
+#define CL_ASYNC_FILE_IO_URING
+
+#include "../async_file_io_impl.h"
+#include "API/Core/System/thread.h"
+#include <sys/uio.h>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace clan
+{
+
+/// \brief Asynchronous file I/O using the io_uring interface of the Linux kernel
+///
+/// Operations are written to the submission ring under the engine mutex, and a completion
+/// thread blocks in io_uring_enter until the kernel posts their results.
+class AsyncFileIO_Uring : public AsyncFileIO_Impl
+{
+/// \name Construction
+/// \{
+
+public:
+	/// \brief Sets up the rings. Throws an exception if the kernel does not provide io_uring
+	AsyncFileIO_Uring(int queue_depth);
+	~AsyncFileIO_Uring();
+
+/// \}
+/// \name Attributes
+/// \{
+
+public:
+	AsyncFileIO::Backend get_backend() const { return AsyncFileIO::backend_io_uring; }
+
+/// \}
+/// \name Implementation
+/// \{
+
+private:
+	struct Slot
+	{
+		std::shared_ptr<AsyncFileOperation_Impl> operation;
+		struct iovec iov;
+		int transferred;
+	};
+
+	void start_operation(const std::shared_ptr<AsyncFileOperation_Impl> &operation);
+	void queue_transfer(int index);
+	void flush_started_operations();
+	bool submit_sqes();
+	void fail_unsubmitted_operations(int error_code);
+	void fail_slot(int index, int error_code);
+	io_uring_sqe *begin_sqe();
+	void end_sqe();
+	void completion_thread_main();
+	void fail_ring(int error_code);
+	void unmap_rings();
+
+	int ring_fd;
+
+	void *sq_ring;
+	size_t sq_ring_size;
+	unsigned *sq_head;
+	unsigned *sq_tail;
+	unsigned sq_mask;
+	unsigned sq_entries;
+	unsigned *sq_array;
+	io_uring_sqe *sqes;
+	size_t sqes_size;
+
+	void *cq_ring;
+	size_t cq_ring_size;
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	unsigned cq_mask;
+	io_uring_cqe *cqes;
+
+	std::vector<Slot> slots;
+	std::vector<int> free_slots;
+	int kernel_operations;
+	int ring_error;		// Set when the completion thread could no longer reap completions
+
+	Thread completion_thread;
+/// \}
+};
+
+}
+
+#endif
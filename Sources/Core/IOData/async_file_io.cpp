@@ -0,0 +1,410 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/IOData/async_file_io.h"
+#include "API/Core/Text/string_format.h"
+#include "async_file_io_impl.h"
+#include "async_file_io_thread_pool.h"
+#include "iodevice_provider_file.h"
+#ifndef WIN32
+#include "Unix/async_file_io_uring.h"
+#include <errno.h>
+#endif
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// AsyncFileOperation Construction:
+
+AsyncFileOperation::AsyncFileOperation()
+{
+}
+
+AsyncFileOperation::AsyncFileOperation(const std::shared_ptr<AsyncFileOperation_Impl> &impl)
+: impl(impl)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// AsyncFileOperation Attributes:
+
+void AsyncFileOperation::throw_if_null() const
+{
+	if (!impl)
+		throw Exception("AsyncFileOperation is null");
+}
+
+const AsyncFileRequest &AsyncFileOperation::get_request() const
+{
+	throw_if_null();
+	return impl->request;
+}
+
+bool AsyncFileOperation::is_completed() const
+{
+	throw_if_null();
+	return impl->completed.get() != 0;
+}
+
+bool AsyncFileOperation::is_failed() const
+{
+	throw_if_null();
+	return impl->completed.get() != 0 && impl->error_code != 0;
+}
+
+int AsyncFileOperation::get_bytes_transferred() const
+{
+	wait();
+	if (impl->error_code != 0)
+		throw Exception(string_format("Asynchronous file %1 failed with error code %2", impl->is_write ? "write" : "read", impl->error_code));
+	return impl->bytes_transferred;
+}
+
+int AsyncFileOperation::get_error_code() const
+{
+	throw_if_null();
+	return impl->completed.get() != 0 ? impl->error_code : 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// AsyncFileOperation Operations:
+
+void AsyncFileOperation::wait() const
+{
+	throw_if_null();
+	if (impl->completed.get() == 0)
+		impl->engine->wait(impl.get());
+}
+
+Callback_v1<AsyncFileOperation &> &AsyncFileOperation::func_completed()
+{
+	throw_if_null();
+	return impl->func_completed;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// AsyncFileIO Construction:
+
+AsyncFileIO::AsyncFileIO(int queue_depth, Backend backend)
+{
+	if (queue_depth < 1)
+		throw Exception("Invalid queue depth");
+
+	if (backend == backend_auto || backend == backend_io_uring)
+	{
+#ifdef CL_ASYNC_FILE_IO_URING
+		try
+		{
+			impl = std::shared_ptr<AsyncFileIO_Impl>(new AsyncFileIO_Uring(queue_depth));
+		}
+		catch (Exception &)
+		{
+			if (backend == backend_io_uring)
+				throw;
+		}
+#else
+		if (backend == backend_io_uring)
+			throw Exception("io_uring is not available on this platform");
+#endif
+	}
+
+	if (!impl)
+		impl = std::shared_ptr<AsyncFileIO_Impl>(new AsyncFileIO_ThreadPool(queue_depth));
+}
+
+AsyncFileIO::~AsyncFileIO()
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// AsyncFileIO Attributes:
+
+AsyncFileIO::Backend AsyncFileIO::get_backend() const
+{
+	return impl->get_backend();
+}
+
+int AsyncFileIO::get_queue_depth() const
+{
+	return impl->get_queue_depth();
+}
+
+int AsyncFileIO::get_pending_count() const
+{
+	return impl->get_pending_count();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// AsyncFileIO Operations:
+
+AsyncFileOperation AsyncFileIO::read(const File &file, byte64 offset, void *buffer, int length)
+{
+	return impl->queue_operation(AsyncFileRequest(file, offset, buffer, length), false);
+}
+
+AsyncFileOperation AsyncFileIO::write(const File &file, byte64 offset, const void *buffer, int length)
+{
+	return impl->queue_operation(AsyncFileRequest(file, offset, const_cast<void*>(buffer), length), true);
+}
+
+std::vector<AsyncFileOperation> AsyncFileIO::read(const std::vector<AsyncFileRequest> &requests)
+{
+	std::vector<AsyncFileOperation> operations;
+	operations.reserve(requests.size());
+	for (size_t i = 0; i < requests.size(); i++)
+		operations.push_back(impl->queue_operation(requests[i], false));
+	impl->submit();
+	return operations;
+}
+
+void AsyncFileIO::submit()
+{
+	impl->submit();
+}
+
+void AsyncFileIO::wait_all()
+{
+	impl->wait_all();
+}
+
+void AsyncFileIO::process()
+{
+	impl->process();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// AsyncFileOperation_Impl Construction:
+
+AsyncFileOperation_Impl::AsyncFileOperation_Impl(AsyncFileIO_Impl *engine, const AsyncFileRequest &request, bool is_write)
+: engine(engine), request(request), is_write(is_write), bytes_transferred(0), error_code(0)
+{
+	if (request.length < 0 || request.offset < 0 || (request.length > 0 && request.buffer == 0))
+		throw Exception("Invalid asynchronous file request");
+
+	IODeviceProvider_File *provider = dynamic_cast<IODeviceProvider_File*>(this->request.file.get_provider());
+	if (provider == 0)
+		throw Exception("Asynchronous file requests need a file opened with File");
+	handle = provider->get_handle();
+#ifdef WIN32
+	if (handle == INVALID_HANDLE_VALUE)
+#else
+	if (handle == -1)
+#endif
+		throw Exception("Asynchronous file request for a file that is not open");
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// AsyncFileIO_Impl Construction:
+
+AsyncFileIO_Impl::AsyncFileIO_Impl(int queue_depth)
+: queue_depth(queue_depth), operations_in_flight(0), pending_count(0), waiting_threads(0)
+{
+}
+
+AsyncFileIO_Impl::~AsyncFileIO_Impl()
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// AsyncFileIO_Impl Attributes:
+
+int AsyncFileIO_Impl::get_pending_count() const
+{
+	MutexSection mutex_lock(&mutex);
+	return pending_count;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// AsyncFileIO_Impl Operations:
+
+AsyncFileOperation AsyncFileIO_Impl::queue_operation(const AsyncFileRequest &request, bool is_write)
+{
+	std::shared_ptr<AsyncFileOperation_Impl> operation(new AsyncFileOperation_Impl(this, request, is_write));
+	MutexSection mutex_lock(&mutex);
+	queued_operations.push_back(operation);
+	pending_count++;
+	return AsyncFileOperation(operation);
+}
+
+void AsyncFileIO_Impl::submit()
+{
+	MutexSection mutex_lock(&mutex);
+	if (!queued_operations.empty())
+	{
+		submitted_operations.insert(submitted_operations.end(), queued_operations.begin(), queued_operations.end());
+		queued_operations.clear();
+		start_submitted_operations();
+	}
+}
+
+void AsyncFileIO_Impl::wait(const AsyncFileOperation_Impl *operation)
+{
+	// The operation might still sit in the queue of the caller
+	submit();
+
+	while (true)
+	{
+		MutexSection mutex_lock(&mutex);
+		if (operation->completed.get() != 0)
+			break;
+		finished_event.reset();
+		waiting_threads++;
+		mutex_lock.unlock();
+		finished_event.wait();
+		mutex_lock.lock();
+		waiting_threads--;
+	}
+}
+
+void AsyncFileIO_Impl::wait_all()
+{
+	submit();
+
+	while (true)
+	{
+		MutexSection mutex_lock(&mutex);
+		if (operations_in_flight == 0 && submitted_operations.empty())
+			break;
+		finished_event.reset();
+		waiting_threads++;
+		mutex_lock.unlock();
+		finished_event.wait();
+		mutex_lock.lock();
+		waiting_threads--;
+	}
+
+	all_operations_finished();
+	process();
+}
+
+void AsyncFileIO_Impl::process()
+{
+	MutexSection mutex_lock(&mutex);
+	std::vector<std::shared_ptr<AsyncFileOperation_Impl> > operations;
+	operations.swap(finished_operations);
+	mutex_lock.unlock();
+
+	for (size_t i = 0; i < operations.size(); i++)
+	{
+		mutex_lock.lock();
+		pending_count--;
+		mutex_lock.unlock();
+
+		if (!operations[i]->func_completed.is_null())
+		{
+			try
+			{
+				AsyncFileOperation operation(operations[i]);
+				operations[i]->func_completed.invoke(operation);
+			}
+			catch (...)
+			{
+				mutex_lock.lock();
+				finished_operations.insert(finished_operations.begin(), operations.begin() + i + 1, operations.end());
+				throw;
+			}
+		}
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// AsyncFileIO_Impl Implementation:
+
+void AsyncFileIO_Impl::start_submitted_operations()
+{
+	while (true)
+	{
+		bool started = false;
+		while (operations_in_flight < queue_depth && !submitted_operations.empty())
+		{
+			std::shared_ptr<AsyncFileOperation_Impl> operation = submitted_operations.front();
+			submitted_operations.pop_front();
+			operations_in_flight++;
+			start_operation(operation);
+			started = true;
+		}
+
+		if (!started)
+			break;
+
+		// A backend failing operations while starting them makes room for more
+		flush_started_operations();
+	}
+}
+
+void AsyncFileIO_Impl::operation_finished(const std::shared_ptr<AsyncFileOperation_Impl> &operation, int result)
+{
+	if (result < 0)
+		operation->error_code = -result;
+	else
+		operation->bytes_transferred = result;
+	operation->completed.set(1);
+
+	operations_in_flight--;
+
+	// Both events cost a system call, so only flag them when someone will look
+	if (waiting_threads > 0)
+		finished_event.set();
+	if (finished_operations.empty())
+		set_wakeup_event();
+	finished_operations.push_back(operation);
+}
+
+void AsyncFileIO_Impl::cancel_and_wait()
+{
+	MutexSection mutex_lock(&mutex);
+
+	// Complete the operations that never reached the backend, so their handles never wait on the engine
+	std::vector<std::shared_ptr<AsyncFileOperation_Impl> > cancelled;
+	cancelled.swap(queued_operations);
+	cancelled.insert(cancelled.end(), submitted_operations.begin(), submitted_operations.end());
+	submitted_operations.clear();
+	for (size_t i = 0; i < cancelled.size(); i++)
+	{
+		operations_in_flight++;
+#ifdef WIN32
+		operation_finished(cancelled[i], -ERROR_OPERATION_ABORTED);
+#else
+		operation_finished(cancelled[i], -ECANCELED);
+#endif
+	}
+
+	while (operations_in_flight > 0)
+	{
+		finished_event.reset();
+		waiting_threads++;
+		mutex_lock.unlock();
+		finished_event.wait();
+		mutex_lock.lock();
+		waiting_threads--;
+	}
+}
+
+}
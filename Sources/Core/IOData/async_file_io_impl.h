@@ -0,0 +1,139 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Core/IOData/async_file_io.h"
+#include "API/Core/System/keep_alive.h"
+#include "API/Core/System/interlocked_variable.h"
+#include "API/Core/System/event.h"
+#include "API/Core/System/mutex.h"
+#include <deque>
+
+namespace clan
+{
+
+class AsyncFileOperation_Impl
+{
+public:
+	AsyncFileOperation_Impl(AsyncFileIO_Impl *engine, const AsyncFileRequest &request, bool is_write);
+
+	AsyncFileIO_Impl *engine;
+	AsyncFileRequest request;
+	bool is_write;
+
+#ifdef WIN32
+	HANDLE handle;
+#else
+	int handle;
+#endif
+
+	// Set to 1 by the thread finishing the transfer, after bytes_transferred and error_code
+	InterlockedVariable completed;
+	int bytes_transferred;
+	int error_code;
+
+	Callback_v1<AsyncFileOperation &> func_completed;
+};
+
+class AsyncFileIO_Impl : public KeepAliveObject
+{
+/// \name Construction
+/// \{
+
+public:
+	AsyncFileIO_Impl(int queue_depth);
+	virtual ~AsyncFileIO_Impl();
+
+/// \}
+/// \name Attributes
+/// \{
+
+public:
+	virtual AsyncFileIO::Backend get_backend() const = 0;
+
+	int get_queue_depth() const { return queue_depth; }
+
+	int get_pending_count() const;
+
+/// \}
+/// \name Operations
+/// \{
+
+public:
+	AsyncFileOperation queue_operation(const AsyncFileRequest &request, bool is_write);
+
+	void submit();
+
+	void wait(const AsyncFileOperation_Impl *operation);
+
+	void wait_all();
+
+	void process();
+
+/// \}
+/// \name Implementation
+/// \{
+
+protected:
+	/// \brief Hands an operation to the backend. Called with the mutex locked.
+	virtual void start_operation(const std::shared_ptr<AsyncFileOperation_Impl> &operation) = 0;
+
+	/// \brief Makes the backend begin the operations started since the last call. Called with the mutex locked.
+	virtual void flush_started_operations() { }
+
+	/// \brief Called after wait_all() found no more operations in flight
+	virtual void all_operations_finished() { }
+
+	/// \brief Starts submitted operations until the queue depth is reached. Called with the mutex locked.
+	void start_submitted_operations();
+
+	/// \brief Records the result of an operation. Called with the mutex locked.
+	///
+	/// \param result = Bytes transferred, or a negated operating system error code
+	void operation_finished(const std::shared_ptr<AsyncFileOperation_Impl> &operation, int result);
+
+	/// \brief Fails operations not yet started with a cancelled error and waits for the ones in flight. Backends call this before shutting down.
+	void cancel_and_wait();
+
+	int queue_depth;
+	mutable Mutex mutex;
+
+private:
+	std::vector<std::shared_ptr<AsyncFileOperation_Impl> > queued_operations;
+	std::deque<std::shared_ptr<AsyncFileOperation_Impl> > submitted_operations;
+	std::vector<std::shared_ptr<AsyncFileOperation_Impl> > finished_operations;
+	int operations_in_flight;
+	int pending_count;
+	int waiting_threads;
+	Event finished_event;
+/// \}
+};
+
+}
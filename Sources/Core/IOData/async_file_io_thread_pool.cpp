@@ -0,0 +1,148 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "async_file_io_thread_pool.h"
+
+#ifndef WIN32
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+namespace clan
+{
+
+class AsyncFileIO_ThreadPool_WorkItem : public WorkItem
+{
+public:
+	AsyncFileIO_ThreadPool_WorkItem(AsyncFileIO_ThreadPool *engine, const std::shared_ptr<AsyncFileOperation_Impl> &operation)
+	: engine(engine), operation(operation)
+	{
+	}
+
+	void process_work()
+	{
+		engine->transfer(operation);
+
+		// The work queue keeps finished items until its thread gets to them
+		operation.reset();
+	}
+
+private:
+	AsyncFileIO_ThreadPool *engine;
+	std::shared_ptr<AsyncFileOperation_Impl> operation;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// AsyncFileIO_ThreadPool Construction:
+
+AsyncFileIO_ThreadPool::AsyncFileIO_ThreadPool(int queue_depth)
+: AsyncFileIO_Impl(queue_depth), work_queue(queue_depth)
+{
+}
+
+AsyncFileIO_ThreadPool::~AsyncFileIO_ThreadPool()
+{
+	cancel_and_wait();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// AsyncFileIO_ThreadPool Implementation:
+
+void AsyncFileIO_ThreadPool::start_operation(const std::shared_ptr<AsyncFileOperation_Impl> &operation)
+{
+	work_queue.queue(new AsyncFileIO_ThreadPool_WorkItem(this, operation));
+}
+
+void AsyncFileIO_ThreadPool::all_operations_finished()
+{
+	// Release the finished work items, in case the owning thread never runs KeepAlive::process()
+	work_queue.finish();
+}
+
+void AsyncFileIO_ThreadPool::transfer(const std::shared_ptr<AsyncFileOperation_Impl> &operation)
+{
+	int result = transfer_blocking(operation.get());
+
+	MutexSection mutex_lock(&mutex);
+	operation_finished(operation, result);
+	start_submitted_operations();
+}
+
+int AsyncFileIO_ThreadPool::transfer_blocking(AsyncFileOperation_Impl *operation)
+{
+	char *data = (char *) operation->request.buffer;
+	int length = operation->request.length;
+	byte64 offset = operation->request.offset;
+
+#ifdef WIN32
+	// Synchronous handles accept an offset in the OVERLAPPED structure too
+	OVERLAPPED overlapped;
+	memset(&overlapped, 0, sizeof(OVERLAPPED));
+	overlapped.Offset = (DWORD) offset;
+	overlapped.OffsetHigh = (DWORD) (offset >> 32);
+	DWORD bytes = 0;
+	BOOL result;
+	if (operation->is_write)
+		result = WriteFile(operation->handle, data, length, &bytes, &overlapped);
+	else
+		result = ReadFile(operation->handle, data, length, &bytes, &overlapped);
+	if (result == FALSE)
+	{
+		DWORD error = GetLastError();
+		if (error != ERROR_HANDLE_EOF)
+			return -(int) error;
+	}
+	return (int) bytes;
+#else
+	int pos = 0;
+	while (pos < length)
+	{
+		ssize_t result;
+		if (operation->is_write)
+			result = pwrite(operation->handle, data + pos, length - pos, offset + pos);
+		else
+			result = pread(operation->handle, data + pos, length - pos, offset + pos);
+
+		if (result < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		else if (result == 0)
+		{
+			break;
+		}
+		pos += (int) result;
+	}
+	return pos;
+#endif
+}
+
+}
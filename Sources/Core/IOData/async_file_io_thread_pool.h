@@ -0,0 +1,72 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "async_file_io_impl.h"
+#include "API/Core/System/work_queue.h"
+
+namespace clan
+{
+
+/// \brief Asynchronous file I/O using positional reads and writes on worker threads
+class AsyncFileIO_ThreadPool : public AsyncFileIO_Impl
+{
+/// \name Construction
+/// \{
+
+public:
+	AsyncFileIO_ThreadPool(int queue_depth);
+	~AsyncFileIO_ThreadPool();
+
+/// \}
+/// \name Attributes
+/// \{
+
+public:
+	AsyncFileIO::Backend get_backend() const { return AsyncFileIO::backend_thread_pool; }
+
+/// \}
+/// \name Implementation
+/// \{
+
+private:
+	void start_operation(const std::shared_ptr<AsyncFileOperation_Impl> &operation);
+	void all_operations_finished();
+
+	void transfer(const std::shared_ptr<AsyncFileOperation_Impl> &operation);
+	static int transfer_blocking(AsyncFileOperation_Impl *operation);
+
+	WorkQueue work_queue;
+
+	friend class AsyncFileIO_ThreadPool_WorkItem;
+/// \}
+};
+
+}
@@ -43,12 +43,14 @@ namespace clan
 std::string File::read_text(const std::string &filename)
 {
 	File file(filename);
-	unsigned int file_size = file.get_size();
+	byte64 file_size = file.get_size();
+	if (file_size >= 0x7fffffff)
+		throw Exception("File is too large to be read into memory: " + filename);
 	std::vector<char> text;
 	text.resize(file_size+1);
 	text[file_size] = 0;
 	if (file_size)
-		file.read(&text[0], file_size);
+		file.read(&text[0], (int) file_size);
 	file.close();
 	if (file_size)
 		return std::string(&text[0]);
@@ -59,7 +61,10 @@ std::string File::read_text(const std::string &filename)
 DataBuffer File::read_bytes(const std::string &filename)
 {
 	File file(filename);
-	DataBuffer buffer(file.get_size());
+	byte64 file_size = file.get_size();
+	if (file_size >= 0x7fffffff)
+		throw Exception("File is too large to be read into memory: " + filename);
+	DataBuffer buffer((int) file_size);
 	file.read(buffer.get_data(), buffer.get_size());
 	file.close();
 	return buffer;
@@ -114,6 +119,11 @@ File::~File()
 /////////////////////////////////////////////////////////////////////////////
 // File Attributes:
 
+const char *File::get_mapped_data() const
+{
+	const IODeviceProvider_File *provider = dynamic_cast<const IODeviceProvider_File*>(impl->provider);
+	return provider->get_mapped_data();
+}
 
 /////////////////////////////////////////////////////////////////////////////
 // File Operations:
@@ -31,11 +31,28 @@
 #include "API/Core/IOData/iodevice.h"
 #include "API/Core/IOData/iodevice_provider.h"
 #include "API/Core/IOData/cl_endian.h"
+#include "API/Core/Math/cl_math.h"
 #include "iodevice_impl.h"
 
 namespace clan
 {
 
+// Reverses the byte order of each element in an array
+template<int element_size>
+static void swap_array(void *data, int count)
+{
+	unsigned char *d = (unsigned char *) data;
+	for (int i = 0; i < count; i++, d += element_size)
+	{
+		for (int j = 0; j < element_size / 2; j++)
+		{
+			unsigned char a = d[j];
+			d[j] = d[element_size - 1 - j];
+			d[element_size - 1 - j] = a;
+		}
+	}
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // IODevice Construction:
 
@@ -62,14 +79,14 @@ void IODevice::throw_if_null() const
 		throw Exception("IODevice is null");
 }
 
-int IODevice::get_size() const
+byte64 IODevice::get_size() const
 {
 	if (impl)
 		return impl->provider->get_size();
 	return -1;
 }
 
-int IODevice::get_position() const
+byte64 IODevice::get_position() const
 {
 	if (impl)
 		return impl->provider->get_position();
@@ -117,7 +134,7 @@ int IODevice::peek(void *data, int len)
 	return -1;
 }
 
-bool IODevice::seek(int position, SeekMode mode)
+bool IODevice::seek(byte64 position, SeekMode mode)
 {
 	if (impl)
 		return impl->provider->seek(position, mode);
@@ -257,6 +274,26 @@ void IODevice::write_float(float data)
 	write(&final, sizeof(float));
 }
 
+void IODevice::write_uint16_array(const ubyte16 *data, int count)
+{
+	write_array(data, sizeof(ubyte16), count);
+}
+
+void IODevice::write_uint32_array(const ubyte32 *data, int count)
+{
+	write_array(data, sizeof(ubyte32), count);
+}
+
+void IODevice::write_uint64_array(const ubyte64 *data, int count)
+{
+	write_array(data, sizeof(ubyte64), count);
+}
+
+void IODevice::write_float_array(const float *data, int count)
+{
+	write_array(data, sizeof(float), count);
+}
+
 void IODevice::write_string_a(const std::string &str)
 {
 	int size = str.length();
@@ -414,6 +451,34 @@ float IODevice::read_float()
 	return answer;
 }
 
+void IODevice::read_uint16_array(ubyte16 *data, int count)
+{
+	if (read(data, count * sizeof(ubyte16)) != count * (int) sizeof(ubyte16)) throw Exception("IODevice::read_uint16_array() failed");
+	if (impl->little_endian_mode == Endian::is_system_big())
+		swap_array<sizeof(ubyte16)>(data, count);
+}
+
+void IODevice::read_uint32_array(ubyte32 *data, int count)
+{
+	if (read(data, count * sizeof(ubyte32)) != count * (int) sizeof(ubyte32)) throw Exception("IODevice::read_uint32_array() failed");
+	if (impl->little_endian_mode == Endian::is_system_big())
+		swap_array<sizeof(ubyte32)>(data, count);
+}
+
+void IODevice::read_uint64_array(ubyte64 *data, int count)
+{
+	if (read(data, count * sizeof(ubyte64)) != count * (int) sizeof(ubyte64)) throw Exception("IODevice::read_uint64_array() failed");
+	if (impl->little_endian_mode == Endian::is_system_big())
+		swap_array<sizeof(ubyte64)>(data, count);
+}
+
+void IODevice::read_float_array(float *data, int count)
+{
+	if (read(data, count * sizeof(float)) != count * (int) sizeof(float)) throw Exception("IODevice::read_float_array() failed");
+	if (impl->little_endian_mode == Endian::is_system_big())
+		swap_array<sizeof(float)>(data, count);
+}
+
 std::string IODevice::read_string_a()
 {
 	int size = read_int32();
@@ -448,7 +513,7 @@ std::string IODevice::read_string_text(const char *skip_initial_chars, const cha
 	int size = 0;
 	bool find_flag = true;
 	bool null_found = false;
-	int current_position = get_position();
+	byte64 current_position = get_position();
 
 	// Skip initial unwanted chars
 	if (skip_initial_chars)
@@ -570,4 +635,31 @@ IODevice IODevice::duplicate()
 /////////////////////////////////////////////////////////////////////////////
 // IODevice Implementation:
 
+void IODevice::write_array(const void *data, int element_size, int count)
+{
+	if (impl->little_endian_mode != Endian::is_system_big())
+	{
+		write(data, element_size * count);
+		return;
+	}
+
+	// Swap a copy of the data in blocks:
+	const int block_size = 4096;
+	unsigned char block[block_size];
+	const unsigned char *src = (const unsigned char *) data;
+	int block_count = block_size / element_size;
+	for (int i = 0; i < count; i += block_count)
+	{
+		int length = min(block_count, count - i) * element_size;
+		memcpy(block, src + i * element_size, length);
+		switch (element_size)
+		{
+		case 2: swap_array<2>(block, length / 2); break;
+		case 4: swap_array<4>(block, length / 4); break;
+		case 8: swap_array<8>(block, length / 8); break;
+		}
+		write(block, length);
+	}
+}
+
 }
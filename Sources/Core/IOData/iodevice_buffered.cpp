@@ -0,0 +1,68 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/IOData/iodevice_buffered.h"
+#include "iodevice_impl.h"
+#include "iodevice_provider_buffered.h"
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// IODevice_Buffered Construction:
+
+IODevice_Buffered::IODevice_Buffered(IODevice &device, int read_buffer_size, int write_buffer_size)
+: IODevice(new IODeviceProvider_Buffered(device, read_buffer_size, write_buffer_size))
+{
+	if (!device.is_little_endian())
+		set_big_endian_mode();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// IODevice_Buffered Attributes:
+
+IODevice IODevice_Buffered::get_device() const
+{
+	const IODeviceProvider_Buffered *provider = dynamic_cast<const IODeviceProvider_Buffered*>(impl->provider);
+	return provider->get_device();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// IODevice_Buffered Operations:
+
+void IODevice_Buffered::flush()
+{
+	IODeviceProvider_Buffered *provider = dynamic_cast<IODeviceProvider_Buffered*>(impl->provider);
+	provider->flush();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// IODevice_Buffered Implementation:
+
+}
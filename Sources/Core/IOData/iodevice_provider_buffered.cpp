@@ -0,0 +1,227 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/Math/cl_math.h"
+#include "iodevice_provider_buffered.h"
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// IODeviceProvider_Buffered Construction:
+
+IODeviceProvider_Buffered::IODeviceProvider_Buffered(IODevice &device, int read_buffer_size, int write_buffer_size)
+: device(device), read_buffer_size(max(read_buffer_size, 0)), read_pos(0), read_end(0), write_used(0)
+{
+	device.throw_if_null();
+	read_buffer.resize(this->read_buffer_size);
+	write_buffer.resize(max(write_buffer_size, 0));
+}
+
+IODeviceProvider_Buffered::~IODeviceProvider_Buffered()
+{
+	try
+	{
+		flush();
+	}
+	catch (...)
+	{
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// IODeviceProvider_Buffered Attributes:
+
+byte64 IODeviceProvider_Buffered::get_size() const
+{
+	byte64 size = device.get_size();
+	if (size == -1 || write_used == 0)
+		return size;
+	return max(size, get_position());
+}
+
+byte64 IODeviceProvider_Buffered::get_position() const
+{
+	byte64 position = device.get_position();
+	if (position == -1)
+		return -1;
+	return position - (read_end - read_pos) + write_used;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// IODeviceProvider_Buffered Operations:
+
+int IODeviceProvider_Buffered::send(const void *data, int len, bool send_all)
+{
+	discard_read_buffer();
+
+	if (write_used + len > (int) write_buffer.size())
+		flush();
+
+	// Too large to be worth buffering
+	if (len >= (int) write_buffer.size())
+		return device.send(data, len, send_all);
+
+	memcpy(&write_buffer[write_used], data, len);
+	write_used += len;
+	return len;
+}
+
+int IODeviceProvider_Buffered::receive(void *data, int len, bool receive_all)
+{
+	flush();
+
+	char *dest = (char *) data;
+	int received = 0;
+	while (received < len)
+	{
+		int available = read_end - read_pos;
+		if (available > 0)
+		{
+			int amount = min(available, len - received);
+			memcpy(dest + received, &read_buffer[read_pos], amount);
+			read_pos += amount;
+			received += amount;
+			continue;
+		}
+
+		if (received > 0 && !receive_all)
+			break;
+
+		// Large reads go directly to the destination
+		int remaining = len - received;
+		if (remaining >= read_buffer_size)
+		{
+			int result = device.receive(dest + received, remaining, receive_all);
+			if (result > 0)
+				received += result;
+			break;
+		}
+
+		read_pos = 0;
+		read_end = device.receive(&read_buffer[0], read_buffer_size, false);
+		if (read_end <= 0)
+		{
+			read_end = 0;
+			break;
+		}
+	}
+	return received;
+}
+
+int IODeviceProvider_Buffered::peek(void *data, int len)
+{
+	flush();
+
+	int available = read_end - read_pos;
+	if (available < len)
+	{
+		// Move the unread data to the front and read more after it
+		if (read_pos > 0)
+		{
+			if (available > 0)
+				memmove(&read_buffer[0], &read_buffer[read_pos], available);
+			read_pos = 0;
+			read_end = available;
+		}
+
+		if ((int) read_buffer.size() < len)
+			read_buffer.resize(len);
+
+		while (read_end < len)
+		{
+			int result = device.receive(&read_buffer[read_end], (int) read_buffer.size() - read_end, false);
+			if (result <= 0)
+				break;
+			read_end += result;
+		}
+		available = read_end;
+	}
+
+	int amount = min(len, available);
+	if (amount > 0)
+		memcpy(data, &read_buffer[read_pos], amount);
+	return amount;
+}
+
+bool IODeviceProvider_Buffered::seek(byte64 position, IODevice::SeekMode mode)
+{
+	flush();
+
+	// Seeks within the data already read ahead do not reach the device
+	int unread = read_end - read_pos;
+	if (read_end > 0 && mode != IODevice::seek_end)
+	{
+		byte64 current = (mode == IODevice::seek_set) ? get_position() : 0;
+		byte64 offset = position - current;
+		if (current != -1 && offset >= -read_pos && offset <= unread)
+		{
+			read_pos += (int) offset;
+			return true;
+		}
+	}
+
+	if (mode == IODevice::seek_cur)
+		position -= unread;
+	read_pos = 0;
+	read_end = 0;
+	return device.seek(position, mode);
+}
+
+IODeviceProvider *IODeviceProvider_Buffered::duplicate()
+{
+	IODevice duplicate_device = device.duplicate();
+	return new IODeviceProvider_Buffered(duplicate_device, read_buffer_size, (int) write_buffer.size());
+}
+
+void IODeviceProvider_Buffered::flush()
+{
+	if (write_used > 0)
+	{
+		int size = write_used;
+		write_used = 0;
+		if (device.send(&write_buffer[0], size, true) != size)
+			throw Exception("IODevice_Buffered: Unable to write buffered data");
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// IODeviceProvider_Buffered Implementation:
+
+void IODeviceProvider_Buffered::discard_read_buffer()
+{
+	// Move the device back to the position the reader has reached
+	int unread = read_end - read_pos;
+	read_pos = 0;
+	read_end = 0;
+	if (unread > 0)
+		device.seek(-unread, IODevice::seek_cur);
+}
+
+}
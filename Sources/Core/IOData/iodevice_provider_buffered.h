@@ -0,0 +1,91 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Core/IOData/iodevice_provider.h"
+#include <vector>
+
+namespace clan
+{
+
+class IODeviceProvider_Buffered : public IODeviceProvider
+{
+/// \name Construction
+/// \{
+
+public:
+	IODeviceProvider_Buffered(IODevice &device, int read_buffer_size, int write_buffer_size);
+	~IODeviceProvider_Buffered();
+
+
+/// \}
+/// \name Attributes
+/// \{
+
+public:
+	byte64 get_size() const;
+	byte64 get_position() const;
+
+	const IODevice &get_device() const { return device; }
+
+/// \}
+/// \name Operations
+/// \{
+
+public:
+	int send(const void *data, int len, bool send_all);
+	int receive(void *data, int len, bool receive_all);
+	int peek(void *data, int len);
+	bool seek(byte64 position, IODevice::SeekMode mode);
+	IODeviceProvider *duplicate();
+
+	void flush();
+
+/// \}
+/// \name Implementation
+/// \{
+
+private:
+	void discard_read_buffer();
+
+	IODevice device;
+	int read_buffer_size;
+
+	// Data read ahead from the device. read_pos is the next byte to be returned
+	std::vector<char> read_buffer;
+	int read_pos;
+	int read_end;
+
+	// Data written but not yet sent to the device
+	std::vector<char> write_buffer;
+	int write_used;
+/// \}
+};
+
+}
@@ -39,6 +39,7 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #endif
 
 #ifdef WIN32
@@ -54,7 +55,10 @@ namespace clan
 // IODeviceProvider_File Construction:
 
 IODeviceProvider_File::IODeviceProvider_File()
-: handle(invalid_handle), peeked_data(0)
+: handle(invalid_handle), peeked_data(0), memory_mapped(false), mapped_data(0), mapped_size(0), mapped_position(0)
+#ifdef WIN32
+, mapping_handle(0)
+#endif
 {
 }
 
@@ -64,7 +68,10 @@ IODeviceProvider_File::IODeviceProvider_File(
 	unsigned int access,
 	unsigned int share,
 	unsigned int flags)
-: handle(invalid_handle), peeked_data(0)
+: handle(invalid_handle), peeked_data(0), memory_mapped(false), mapped_data(0), mapped_size(0), mapped_position(0)
+#ifdef WIN32
+, mapping_handle(0)
+#endif
 {
 	bool result = open(filename, open_mode, access, share, flags);
 	if (result == false)
@@ -79,52 +86,48 @@ IODeviceProvider_File::~IODeviceProvider_File()
 /////////////////////////////////////////////////////////////////////////////
 // IODeviceProvider_File Attributes:
 
-int IODeviceProvider_File::get_size() const
+byte64 IODeviceProvider_File::get_size() const
 {
-#ifdef WIN32
 	if (handle == invalid_handle)
 		throw Exception("IODeviceProvider_File::get_size(): Unable to get file size, no file open");
 
-	DWORD size = GetFileSize(handle, 0);
-	if (size == INVALID_FILE_SIZE)
-		throw Exception("IODeviceProvider_File::get_size(): Unable to get file size");
-
-	return size;
-#else
-	if (handle == invalid_handle)
-		throw Exception("IODeviceProvider_File::get_size(): Unable to get file size, no file open");
+	if (memory_mapped)
+		return mapped_size;
 
-	off_t old_pos = lseek(handle, 0, SEEK_CUR);
-	if (old_pos == (off_t) -1)
+#ifdef WIN32
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(handle, &size) == FALSE)
 		throw Exception("IODeviceProvider_File::get_size(): Unable to get file size");
-	off_t size = lseek(handle, 0, SEEK_END);
-	lseek(handle, old_pos, SEEK_SET);
 
-	if (size == (off_t) -1)
+	return size.QuadPart;
+#else
+	struct stat file_status;
+	if (fstat(handle, &file_status) == -1)
 		throw Exception("IODeviceProvider_File::get_size(): Unable to get file size");
 		
-	return (int) size;
+	return file_status.st_size;
 #endif
 }
 
-int IODeviceProvider_File::get_position() const
+byte64 IODeviceProvider_File::get_position() const
 {
-#ifdef WIN32
 	if (handle == invalid_handle)
 		throw Exception("IODeviceProvider_File::get_position(): Unable to get file position pointer, no file open");
 
-	DWORD pos = SetFilePointer(handle, 0, 0, FILE_CURRENT);
-	if (pos == INVALID_SET_FILE_POINTER)
+	if (memory_mapped)
+		return mapped_position;
+
+#ifdef WIN32
+	LARGE_INTEGER distance, pos;
+	distance.QuadPart = 0;
+	if (SetFilePointerEx(handle, distance, &pos, FILE_CURRENT) == FALSE)
 		throw Exception("IODeviceProvider_File::get_position(): Unable to get file position pointer");
 
-	return (int) pos;
+	return pos.QuadPart;
 #else
-	if (handle == invalid_handle)
-		throw Exception("Unable to get file position pointer, no file open");
-
 	off_t pos = lseek(handle, 0, SEEK_CUR);
 	if (pos == (off_t) -1)
-		throw Exception("Unable to get file position pointer");
+		throw Exception("IODeviceProvider_File::get_position(): Unable to get file position pointer");
 
 	return pos;
 #endif
@@ -196,7 +199,13 @@ bool IODeviceProvider_File::open(
 		win32_flags,
 		0);
 
-	return (handle != invalid_handle);
+	if (handle == invalid_handle)
+		return false;
+
+	if ((flags & File::flag_memory_mapped) && access == File::access_read)
+		map_file();
+
+	return true;
 #else
 	int unix_flags = 0;
 	mode_t mode = S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH; // ug+rx, o+r
@@ -223,6 +232,21 @@ bool IODeviceProvider_File::open(
 	handle = ::open(filename_a.c_str(), unix_flags, mode);
 	if (handle == -1)
 		return false;
+
+	if ((flags & File::flag_memory_mapped) && access == File::access_read)
+	{
+		map_file();
+	}
+#ifdef POSIX_FADV_SEQUENTIAL
+	else if (flags & File::flag_sequential_scan)
+	{
+		posix_fadvise(handle, 0, 0, POSIX_FADV_SEQUENTIAL);
+	}
+	else if (flags & File::flag_random_access)
+	{
+		posix_fadvise(handle, 0, 0, POSIX_FADV_RANDOM);
+	}
+#endif
 	
 	return true;
 #endif
@@ -230,6 +254,8 @@ bool IODeviceProvider_File::open(
 
 void IODeviceProvider_File::close()
 {
+	unmap_file();
+
 #ifdef WIN32
 	if (handle != invalid_handle)
 		CloseHandle(handle);
@@ -244,6 +270,17 @@ int IODeviceProvider_File::read(void *buffer, int size, bool read_all)
 {
 	if (size == 0)
 		return 0;
+
+	if (memory_mapped)
+	{
+		if (mapped_position >= mapped_size)
+			return 0;
+		int amount = (int) min((byte64) size, mapped_size - mapped_position);
+		memcpy(buffer, mapped_data + mapped_position, amount);
+		mapped_position += amount;
+		return amount;
+	}
+
 	if (peeked_data.get_size() > 0)
 	{
 		int peek_amount = min(size, peeked_data.get_size());
@@ -261,6 +298,8 @@ int IODeviceProvider_File::write(const void *buffer, int size, bool write_all)
 {
 	if (handle == invalid_handle)
 		throw Exception("IODeviceProvider_File::write(): Unable to write to file, no file open");
+	if (memory_mapped)
+		throw Exception("IODeviceProvider_File::write(): Unable to write to a memory mapped file");
 
 #ifdef WIN32
 	DWORD written = 0;
@@ -287,6 +326,15 @@ int IODeviceProvider_File::receive(void *data, int len, bool receive_all)
 
 int IODeviceProvider_File::peek(void *data, int len)
 {
+	if (memory_mapped)
+	{
+		if (mapped_position >= mapped_size || len <= 0)
+			return 0;
+		int amount = (int) min((byte64) len, mapped_size - mapped_position);
+		memcpy(data, mapped_data + mapped_position, amount);
+		return amount;
+	}
+
 	if (peeked_data.get_size() >= len)
 	{
 		memcpy(data, peeked_data.get_data(), len);
@@ -311,11 +359,24 @@ int IODeviceProvider_File::peek(void *data, int len)
 	}
 }
 
-bool IODeviceProvider_File::seek(int position, IODevice::SeekMode seek_mode)
+bool IODeviceProvider_File::seek(byte64 position, IODevice::SeekMode seek_mode)
 {
 	if (handle == invalid_handle)
 		throw Exception("IODeviceProvider_File::seek(): Unable to get file position pointer, no file open");
 
+	if (memory_mapped)
+	{
+		byte64 new_position = position;
+		if (seek_mode == IODevice::seek_cur)
+			new_position += mapped_position;
+		else if (seek_mode == IODevice::seek_end)
+			new_position += mapped_size;
+		if (new_position < 0)
+			return false;
+		mapped_position = new_position;
+		return true;
+	}
+
 #ifdef WIN32
 	DWORD moveMethod = FILE_BEGIN;
 	switch (seek_mode)
@@ -325,8 +386,9 @@ bool IODeviceProvider_File::seek(int position, IODevice::SeekMode seek_mode)
 	case IODevice::seek_end: moveMethod = FILE_END; break;
 	}
 
-	DWORD new_pos = SetFilePointer(handle, position, 0, moveMethod);
-	return (new_pos != INVALID_FILE_SIZE);
+	LARGE_INTEGER distance;
+	distance.QuadPart = position;
+	return (SetFilePointerEx(handle, distance, 0, moveMethod) == TRUE);
 #else
 	int mode = SEEK_SET;
 	if (seek_mode == File::seek_set)
@@ -336,7 +398,7 @@ bool IODeviceProvider_File::seek(int position, IODevice::SeekMode seek_mode)
 	else if (seek_mode == File::seek_end)
 		mode = SEEK_END;
 	
-	off_t new_pos = lseek(handle, position, mode);
+	off_t new_pos = lseek(handle, (off_t) position, mode);
 	if (new_pos == (off_t) -1)
 		return false;
 	else
@@ -370,4 +432,60 @@ int IODeviceProvider_File::lowlevel_read(void *buffer, int size, bool read_all)
 #endif
 }
 
+void IODeviceProvider_File::map_file()
+{
+	// Files that cannot be mapped, such as files too large for the address space, are read normally
+	byte64 size = get_size();
+	if (size < 0 || (ubyte64) size > (ubyte64) (size_t) -1)
+		return;
+
+	if (size > 0)
+	{
+#ifdef WIN32
+		mapping_handle = CreateFileMapping(handle, 0, PAGE_READONLY, 0, 0, 0);
+		if (mapping_handle == 0)
+			return;
+		mapped_data = (const char *) MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+		if (mapped_data == 0)
+		{
+			CloseHandle(mapping_handle);
+			mapping_handle = 0;
+			return;
+		}
+#else
+		void *data = mmap(0, (size_t) size, PROT_READ, MAP_SHARED, handle, 0);
+		if (data == MAP_FAILED)
+			return;
+		mapped_data = (const char *) data;
+
+		if (flags & File::flag_sequential_scan)
+			madvise(data, (size_t) size, MADV_SEQUENTIAL);
+		else if (flags & File::flag_random_access)
+			madvise(data, (size_t) size, MADV_RANDOM);
+#endif
+	}
+
+	memory_mapped = true;
+	mapped_size = size;
+	mapped_position = 0;
+}
+
+void IODeviceProvider_File::unmap_file()
+{
+	if (mapped_data)
+	{
+#ifdef WIN32
+		UnmapViewOfFile(mapped_data);
+		CloseHandle(mapping_handle);
+		mapping_handle = 0;
+#else
+		munmap((void *) mapped_data, (size_t) mapped_size);
+#endif
+	}
+	memory_mapped = false;
+	mapped_data = 0;
+	mapped_size = 0;
+	mapped_position = 0;
+}
+
 }
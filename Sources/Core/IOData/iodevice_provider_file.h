@@ -59,9 +59,21 @@ public:
 /// \{
 
 public:
-	int get_size() const;
+	byte64 get_size() const;
 
-	int get_position() const;
+	byte64 get_position() const;
+
+	/// \brief Returns the contents of the file, if it is memory mapped
+	const char *get_mapped_data() const { return mapped_data; }
+
+	bool is_memory_mapped() const { return memory_mapped; }
+
+	/// \brief Returns the operating system handle of the file
+#ifdef WIN32
+	HANDLE get_handle() const { return handle; }
+#else
+	int get_handle() const { return handle; }
+#endif
 
 /// \}
 /// \name Operations
@@ -87,7 +99,7 @@ public:
 
 	int peek(void *data, int len);
 
-	bool seek(int position, IODevice::SeekMode mode);
+	bool seek(byte64 position, IODevice::SeekMode mode);
 
 	IODeviceProvider *duplicate();
 
@@ -98,6 +110,8 @@ public:
 
 private:
 	int lowlevel_read(void *buffer, int size, bool read_all);
+	void map_file();
+	void unmap_file();
 
 	std::string filename;
 	File::OpenMode open_mode;
@@ -111,6 +125,15 @@ private:
 	int handle;
 #endif
 	DataBuffer peeked_data;
+
+	// Set when reads are served from a read-only mapping of the whole file
+	bool memory_mapped;
+	const char *mapped_data;
+	byte64 mapped_size;
+	byte64 mapped_position;
+#ifdef WIN32
+	HANDLE mapping_handle;
+#endif
 /// \}
 };
 
@@ -49,12 +49,12 @@ IODeviceProvider_Memory::IODeviceProvider_Memory(DataBuffer &data)
 /////////////////////////////////////////////////////////////////////////////
 // IODeviceProvider_Memory Attributes:
 
-int IODeviceProvider_Memory::get_size() const
+byte64 IODeviceProvider_Memory::get_size() const
 {
 	return data.get_size();
 }
 	
-int IODeviceProvider_Memory::get_position() const
+byte64 IODeviceProvider_Memory::get_position() const
 {
 	validate_position();
 	return position;
@@ -105,10 +105,10 @@ int IODeviceProvider_Memory::peek(void *recv_data, int len)
 	return len;
 }
 
-bool IODeviceProvider_Memory::seek(int requested_position, IODevice::SeekMode mode)
+bool IODeviceProvider_Memory::seek(byte64 requested_position, IODevice::SeekMode mode)
 {
 	validate_position();
-	int new_position = position;
+	byte64 new_position = position;
 	switch (mode)
 	{
 	case IODevice::seek_set:
@@ -126,7 +126,7 @@ bool IODeviceProvider_Memory::seek(int requested_position, IODevice::SeekMode mo
 
 	if (new_position >= 0 && new_position <= data.get_size())
 	{
-		position = new_position;
+		position = (int) new_position;
 		return true;
 	}
 	else
@@ -50,9 +50,9 @@ public:
 /// \{
 
 public:
-	virtual int get_size() const;
+	virtual byte64 get_size() const;
 
-	virtual int get_position() const;
+	virtual byte64 get_position() const;
 
 	const DataBuffer &get_data() const;
 
@@ -70,7 +70,7 @@ public:
 
 	virtual int peek(void *data, int len);
 
-	virtual bool seek(int position, IODevice::SeekMode mode);
+	virtual bool seek(byte64 position, IODevice::SeekMode mode);
 
 	IODeviceProvider *duplicate();
 
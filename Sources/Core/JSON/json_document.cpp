@@ -0,0 +1,400 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/JSON/json_document.h"
+#include "API/Core/JSON/json_reader.h"
+#include "API/Core/JSON/json_writer.h"
+#include "json_document_impl.h"
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonNode Attributes:
+
+JsonValue::Type JsonNode::get_type() const
+{
+	return node ? (JsonValue::Type) node->type : JsonValue::type_null;
+}
+
+size_t JsonNode::get_size() const
+{
+	switch (get_type())
+	{
+	case JsonValue::type_object:
+	case JsonValue::type_array:
+	case JsonValue::type_string:
+		return node->size;
+	default:
+		return 0;
+	}
+}
+
+std::string JsonNode::to_string() const
+{
+	if (get_type() != JsonValue::type_string)
+		throw JsonException("JSON Value is not a string");
+	return std::string(node->string, node->size);
+}
+
+int JsonNode::to_int() const
+{
+	return (int) to_double();
+}
+
+float JsonNode::to_float() const
+{
+	return (float) to_double();
+}
+
+double JsonNode::to_double() const
+{
+	if (get_type() != JsonValue::type_number)
+		throw JsonException("JSON Value is not a number");
+	return node->number;
+}
+
+bool JsonNode::to_boolean() const
+{
+	if (get_type() != JsonValue::type_boolean)
+		throw JsonException("JSON Value is not a boolean");
+	return node->boolean;
+}
+
+JsonNode JsonNode::get_item(size_t index) const
+{
+	JsonValue::Type type = get_type();
+	if (type != JsonValue::type_array && type != JsonValue::type_object)
+		throw JsonException("JSON Value is not an array or object");
+	if (index >= node->size)
+		throw JsonException("JSON index out of range");
+
+	if (type == JsonValue::type_object)
+		return JsonNode(doc, get_children() + index * 2 + 1);
+	else
+		return JsonNode(doc, get_children() + index);
+}
+
+std::string JsonNode::get_key(size_t index) const
+{
+	if (get_type() != JsonValue::type_object)
+		throw JsonException("JSON Value is not an object");
+	if (index >= node->size)
+		throw JsonException("JSON index out of range");
+
+	const JsonDocumentNode &key = get_children()[index * 2];
+	return std::string(key.string, key.size);
+}
+
+JsonNode JsonNode::get_member(const std::string &key) const
+{
+	if (get_type() != JsonValue::type_object)
+		throw JsonException("JSON Value is not an object");
+
+	const JsonDocumentNode *children = get_children();
+	for (size_t i = node->size; i > 0; i--)
+	{
+		const JsonDocumentNode &name = children[(i - 1) * 2];
+		if (name.size == key.length() && memcmp(name.string, key.data(), name.size) == 0)
+			return JsonNode(doc, &children[(i - 1) * 2 + 1]);
+	}
+	return JsonNode();
+}
+
+JsonValue JsonNode::to_value() const
+{
+	if (node)
+		return doc->to_value(*node);
+	else
+		return JsonValue::null();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonNode Implementation:
+
+const JsonDocumentNode *JsonNode::get_children() const
+{
+	return doc->nodes.data() + node->first_child;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonDocument Construction:
+
+JsonDocument::JsonDocument()
+: impl(new JsonDocument_Impl())
+{
+}
+
+JsonDocument::JsonDocument(IODevice &input)
+: impl(new JsonDocument_Impl())
+{
+	load(input);
+}
+
+JsonDocument::~JsonDocument()
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonDocument Attributes:
+
+JsonNode JsonDocument::get_root() const
+{
+	return JsonNode(impl.get(), &impl->root);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonDocument Operations:
+
+void JsonDocument::load(IODevice &input)
+{
+	JsonReader reader(input);
+	try
+	{
+		impl->load(reader);
+	}
+	catch (...)
+	{
+		impl->clear();
+		throw;
+	}
+}
+
+void JsonDocument::save(IODevice &output) const
+{
+	JsonWriter writer(output);
+	impl->write(writer, impl->root);
+	writer.flush();
+}
+
+JsonValue JsonDocument::to_value() const
+{
+	return impl->to_value(impl->root);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonDocument_Impl Construction:
+
+JsonDocument_Impl::JsonDocument_Impl()
+: root(), string_block_pos(string_block_size)
+{
+}
+
+JsonDocument_Impl::~JsonDocument_Impl()
+{
+	clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonDocument_Impl Operations:
+
+void JsonDocument_Impl::clear()
+{
+	for (std::vector<char *>::size_type i = 0; i < string_blocks.size(); i++)
+		delete[] string_blocks[i];
+	string_blocks.clear();
+	string_block_pos = string_block_size;
+
+	root = JsonDocumentNode();
+	nodes.clear();
+}
+
+void JsonDocument_Impl::load(JsonReader &reader)
+{
+	clear();
+
+	// Containers are complete once their end is reached. Until then their children are
+	// collected per depth, and then copied next to each other into the nodes list.
+	std::vector<JsonDocumentNode> open_nodes;
+
+	while (true)
+	{
+		JsonDocumentNode value = JsonDocumentNode();
+		switch (reader.next())
+		{
+		case JsonReader::event_begin_object:
+		case JsonReader::event_begin_array:
+			value.type = (reader.get_event() == JsonReader::event_begin_object) ? JsonValue::type_object : JsonValue::type_array;
+			open_nodes.push_back(value);
+			if (open_children.size() < open_nodes.size())
+				open_children.resize(open_nodes.size());
+			open_children[open_nodes.size() - 1].clear();
+			continue;
+
+		case JsonReader::event_end_object:
+		case JsonReader::event_end_array:
+			{
+				std::vector<JsonDocumentNode> &children = open_children[open_nodes.size() - 1];
+				value = open_nodes.back();
+				open_nodes.pop_back();
+				value.first_child = (unsigned int) nodes.size();
+				value.size = (unsigned int) ((value.type == JsonValue::type_object) ? children.size() / 2 : children.size());
+				nodes.insert(nodes.end(), children.begin(), children.end());
+			}
+			break;
+
+		case JsonReader::event_key:
+		case JsonReader::event_string:
+			set_string(value, reader.get_string());
+			break;
+
+		case JsonReader::event_number:
+			value.type = JsonValue::type_number;
+			value.number = reader.get_number();
+			break;
+
+		case JsonReader::event_boolean:
+			value.type = JsonValue::type_boolean;
+			value.boolean = reader.get_boolean();
+			break;
+
+		case JsonReader::event_null:
+		case JsonReader::event_end:
+			value.type = JsonValue::type_null;
+			break;
+		}
+
+		if (open_nodes.empty())
+		{
+			root = value;
+			break;
+		}
+		open_children[open_nodes.size() - 1].push_back(value);
+	}
+
+	// Checks that nothing follows the top level value
+	reader.next();
+}
+
+void JsonDocument_Impl::write(JsonWriter &writer, const JsonDocumentNode &node) const
+{
+	const JsonDocumentNode *children = nodes.data() + node.first_child;
+	switch (node.type)
+	{
+	default:
+	case JsonValue::type_null:
+		writer.write_null();
+		break;
+	case JsonValue::type_object:
+		writer.begin_object();
+		for (unsigned int i = 0; i < node.size; i++)
+		{
+			writer.write_key(children[i * 2].string, children[i * 2].size);
+			write(writer, children[i * 2 + 1]);
+		}
+		writer.end_object();
+		break;
+	case JsonValue::type_array:
+		writer.begin_array();
+		for (unsigned int i = 0; i < node.size; i++)
+			write(writer, children[i]);
+		writer.end_array();
+		break;
+	case JsonValue::type_string:
+		writer.write_string(node.string, node.size);
+		break;
+	case JsonValue::type_number:
+		writer.write_number(node.number);
+		break;
+	case JsonValue::type_boolean:
+		writer.write_boolean(node.boolean);
+		break;
+	}
+}
+
+JsonValue JsonDocument_Impl::to_value(const JsonDocumentNode &node) const
+{
+	const JsonDocumentNode *children = nodes.data() + node.first_child;
+	switch (node.type)
+	{
+	default:
+	case JsonValue::type_null:
+		return JsonValue::null();
+	case JsonValue::type_object:
+		{
+			JsonValue value = JsonValue::object();
+			for (unsigned int i = 0; i < node.size; i++)
+				value[std::string(children[i * 2].string, children[i * 2].size)] = to_value(children[i * 2 + 1]);
+			return value;
+		}
+	case JsonValue::type_array:
+		{
+			JsonValue value = JsonValue::array();
+			value.get_items().reserve(node.size);
+			for (unsigned int i = 0; i < node.size; i++)
+				value.get_items().push_back(to_value(children[i]));
+			return value;
+		}
+	case JsonValue::type_string:
+		return JsonValue::string(std::string(node.string, node.size));
+	case JsonValue::type_number:
+		return JsonValue::number(node.number);
+	case JsonValue::type_boolean:
+		return JsonValue::boolean(node.boolean);
+	}
+}
+
+const char *JsonDocument_Impl::store_string(const char *data, std::string::size_type length)
+{
+	if (length == 0)
+		return "";
+
+	char *dest;
+	if (length > string_block_size / 4)
+	{
+		// Large strings get a block of their own, so the current block keeps filling up
+		dest = new char[length];
+		string_blocks.insert(string_blocks.begin(), dest);
+	}
+	else
+	{
+		if (string_block_pos + length > string_block_size)
+		{
+			string_blocks.push_back(new char[string_block_size]);
+			string_block_pos = 0;
+		}
+		dest = string_blocks.back() + string_block_pos;
+		string_block_pos += length;
+	}
+
+	memcpy(dest, data, length);
+	return dest;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonDocument_Impl Implementation:
+
+void JsonDocument_Impl::set_string(JsonDocumentNode &node, const std::string &str)
+{
+	node.type = JsonValue::type_string;
+	node.size = (unsigned int) str.length();
+	node.string = store_string(str.data(), str.length());
+}
+
+}
@@ -0,0 +1,102 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Core/JSON/json_document.h"
+#include <vector>
+
+namespace clan
+{
+
+class JsonReader;
+class JsonWriter;
+
+// Fixed-size record for one value in a JsonDocument
+struct JsonDocumentNode
+{
+	// JsonValue::Type
+	unsigned int type;
+
+	// Object member count, array item count or string length
+	unsigned int size;
+
+	union
+	{
+		double number;
+		bool boolean;
+		const char *string;
+
+		// Index in JsonDocument_Impl::nodes. Object members are stored as name and value pairs.
+		unsigned int first_child;
+	};
+};
+
+class JsonDocument_Impl
+{
+/// \name Construction
+/// \{
+public:
+	JsonDocument_Impl();
+	~JsonDocument_Impl();
+/// \}
+
+/// \name Attributes
+/// \{
+public:
+	JsonDocumentNode root;
+	std::vector<JsonDocumentNode> nodes;
+
+	// String values and member names. Memory is only released when the document is cleared
+	std::vector<char *> string_blocks;
+	std::string::size_type string_block_pos;
+/// \}
+
+/// \name Operations
+/// \{
+public:
+	void clear();
+	void load(JsonReader &reader);
+	void write(JsonWriter &writer, const JsonDocumentNode &node) const;
+	JsonValue to_value(const JsonDocumentNode &node) const;
+	const char *store_string(const char *data, std::string::size_type length);
+/// \}
+
+/// \name Implementation
+/// \{
+private:
+	static const std::string::size_type string_block_size = 64*1024;
+
+	void set_string(JsonDocumentNode &node, const std::string &str);
+
+	// Children of the containers currently open while loading, one list per depth
+	std::vector<std::vector<JsonDocumentNode> > open_children;
+/// \}
+};
+
+}
@@ -0,0 +1,617 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/JSON/json_reader.h"
+#include "API/Core/JSON/json_value.h"
+#include "API/Core/IOData/iodevice.h"
+#include "API/Core/Text/string_format.h"
+#include "API/Core/Text/string_help.h"
+#include "API/Core/System/cl_platform.h"
+#include "json_reader_impl.h"
+#include <algorithm>
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonReader Construction:
+
+JsonReader::JsonReader(IODevice &input, int buffer_size)
+: impl(new JsonReader_Impl(input, buffer_size))
+{
+}
+
+JsonReader::~JsonReader()
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonReader Attributes:
+
+JsonReader::Event JsonReader::get_event() const
+{
+	return impl->event;
+}
+
+const std::string &JsonReader::get_string() const
+{
+	return impl->string_value;
+}
+
+double JsonReader::get_number() const
+{
+	return impl->number_value;
+}
+
+bool JsonReader::get_boolean() const
+{
+	return impl->boolean_value;
+}
+
+int JsonReader::get_depth() const
+{
+	return (int) impl->containers.size();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonReader Operations:
+
+JsonReader::Event JsonReader::next()
+{
+	return impl->next();
+}
+
+void JsonReader::skip()
+{
+	if (impl->event != event_begin_object && impl->event != event_begin_array)
+		return;
+
+	std::vector<char>::size_type depth = impl->containers.size();
+	while (impl->containers.size() >= depth)
+		impl->next();
+}
+
+bool JsonReader::parse_number(const char *text, std::string::size_type length, double &out_value)
+{
+	static const double powers_of_ten[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	const char *p = text;
+	const char *end = text + length;
+
+	bool negative = false;
+	if (p != end && *p == '-')
+	{
+		negative = true;
+		p++;
+	}
+
+	// Collect up to 19 significant digits in an integer. Any digit beyond that makes the result inexact.
+	ubyte64 mantissa = 0;
+	int significant_digits = 0;
+	int exponent = 0;
+	bool exact = true;
+
+	if (p == end)
+		return false;
+	if (*p == '0')
+	{
+		p++;
+	}
+	else if (*p >= '1' && *p <= '9')
+	{
+		while (p != end && *p >= '0' && *p <= '9')
+		{
+			if (significant_digits < 19)
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+				significant_digits++;
+			}
+			else
+			{
+				exponent++;
+				exact = false;
+			}
+			p++;
+		}
+	}
+	else
+	{
+		return false;
+	}
+
+	if (p != end && *p == '.')
+	{
+		p++;
+		if (p == end || *p < '0' || *p > '9')
+			return false;
+		while (p != end && *p >= '0' && *p <= '9')
+		{
+			if (significant_digits < 19)
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+				if (mantissa != 0)
+					significant_digits++;
+				exponent--;
+			}
+			else
+			{
+				exact = false;
+			}
+			p++;
+		}
+	}
+
+	if (p != end && (*p == 'e' || *p == 'E'))
+	{
+		p++;
+		bool negative_exponent = false;
+		if (p != end && (*p == '+' || *p == '-'))
+		{
+			negative_exponent = (*p == '-');
+			p++;
+		}
+		if (p == end || *p < '0' || *p > '9')
+			return false;
+		int exponent_value = 0;
+		while (p != end && *p >= '0' && *p <= '9')
+		{
+			if (exponent_value < 100000)
+				exponent_value = exponent_value * 10 + (*p - '0');
+			p++;
+		}
+		exponent += negative_exponent ? -exponent_value : exponent_value;
+	}
+
+	if (p != end)
+		return false;
+
+	// Both the mantissa and the power of ten are exact doubles, so a single multiplication or division rounds correctly:
+	if (exact && mantissa <= (((ubyte64) 1) << 53) && exponent >= -22 && exponent <= 22)
+	{
+		double value = (double) mantissa;
+		if (exponent < 0)
+			value /= powers_of_ten[-exponent];
+		else
+			value *= powers_of_ten[exponent];
+		out_value = negative ? -value : value;
+		return true;
+	}
+
+	// Fall back to strtod, with the decimal point of the current C locale:
+	std::string local_text(text, length);
+	const char *decimal_point = localeconv()->decimal_point;
+	if (decimal_point[0] != '.' && decimal_point[0] != 0)
+		std::replace(local_text.begin(), local_text.end(), '.', decimal_point[0]);
+	out_value = strtod(local_text.c_str(), 0);
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonReader_Impl Construction:
+
+JsonReader_Impl::JsonReader_Impl(IODevice &input, int buffer_size)
+: event(JsonReader::event_end), number_value(0.0), boolean_value(false), input(input), pos(0), size(0), discarded_bytes(0),
+  end_of_input(false), bom_checked(false), expect(expect_value)
+{
+	buffer.resize(std::max(buffer_size, 16));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonReader_Impl Operations:
+
+JsonReader::Event JsonReader_Impl::next()
+{
+	if (!bom_checked)
+		check_bom();
+
+	int c = peek_non_whitespace();
+	switch (expect)
+	{
+	default:
+	case expect_value:
+		return read_value(c);
+
+	case expect_first_member:
+		if (c == '}')
+			return end_container();
+		return read_key(c);
+
+	case expect_first_item:
+		if (c == ']')
+			return end_container();
+		return read_value(c);
+
+	case expect_separator:
+		if (c == ',')
+		{
+			pos++;
+			c = peek_non_whitespace();
+			if (containers.back() == '{')
+				return read_key(c);
+			else
+				return read_value(c);
+		}
+		else if (c == (containers.back() == '{' ? '}' : ']'))
+		{
+			return end_container();
+		}
+		else if (c == -1)
+		{
+			throw_error("Unexpected end of JSON data");
+		}
+		throw_error("Unexpected character in JSON data");
+
+	case expect_end:
+		if (c != -1)
+			throw_error("Unexpected character after JSON data");
+		event = JsonReader::event_end;
+		return event;
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonReader_Impl Implementation:
+
+JsonReader::Event JsonReader_Impl::read_key(int c)
+{
+	if (c == -1)
+		throw_error("Unexpected end of JSON data");
+	else if (c != '"')
+		throw_error("Expected member name in JSON data");
+
+	read_string(string_value);
+
+	c = peek_non_whitespace();
+	if (c == -1)
+		throw_error("Unexpected end of JSON data");
+	else if (c != ':')
+		throw_error("Expected ':' in JSON data");
+	pos++;
+
+	expect = expect_value;
+	event = JsonReader::event_key;
+	return event;
+}
+
+JsonReader::Event JsonReader_Impl::read_value(int c)
+{
+	switch (c)
+	{
+	case -1:
+		throw_error("Unexpected end of JSON data");
+	case '{':
+		pos++;
+		containers.push_back('{');
+		expect = expect_first_member;
+		event = JsonReader::event_begin_object;
+		return event;
+	case '[':
+		pos++;
+		containers.push_back('[');
+		expect = expect_first_item;
+		event = JsonReader::event_begin_array;
+		return event;
+	case '"':
+		read_string(string_value);
+		event = JsonReader::event_string;
+		break;
+	case '-':
+	case '0':
+	case '1':
+	case '2':
+	case '3':
+	case '4':
+	case '5':
+	case '6':
+	case '7':
+	case '8':
+	case '9':
+		read_number();
+		event = JsonReader::event_number;
+		break;
+	case 't':
+		read_literal("true", 4);
+		boolean_value = true;
+		event = JsonReader::event_boolean;
+		break;
+	case 'f':
+		read_literal("false", 5);
+		boolean_value = false;
+		event = JsonReader::event_boolean;
+		break;
+	case 'n':
+		read_literal("null", 4);
+		event = JsonReader::event_null;
+		break;
+	default:
+		throw_error("Unexpected character in JSON data");
+	}
+
+	expect = containers.empty() ? expect_end : expect_separator;
+	return event;
+}
+
+JsonReader::Event JsonReader_Impl::end_container()
+{
+	pos++;
+	event = (containers.back() == '{') ? JsonReader::event_end_object : JsonReader::event_end_array;
+	containers.pop_back();
+	expect = containers.empty() ? expect_end : expect_separator;
+	return event;
+}
+
+void JsonReader_Impl::read_string(std::string &out_string)
+{
+	out_string.clear();
+	pos++;
+
+	while (true)
+	{
+		std::string::size_type start = pos;
+		while (pos < size && buffer[pos] != '"' && buffer[pos] != '\\')
+			pos++;
+		out_string.append(&buffer[0] + start, pos - start);
+
+		if (pos == size)
+		{
+			if (!fill())
+				throw_error("Unexpected end of JSON data");
+		}
+		else if (buffer[pos] == '"')
+		{
+			pos++;
+			return;
+		}
+		else
+		{
+			if (!require(2))
+				throw_error("Unexpected end of JSON data");
+
+			switch (buffer[pos + 1])
+			{
+			case '"':
+				out_string.push_back('"');
+				break;
+			case '\\':
+				out_string.push_back('\\');
+				break;
+			case '/':
+				out_string.push_back('/');
+				break;
+			case 'b':
+				out_string.push_back('\b');
+				break;
+			case 'f':
+				out_string.push_back('\f');
+				break;
+			case 'n':
+				out_string.push_back('\n');
+				break;
+			case 'r':
+				out_string.push_back('\r');
+				break;
+			case 't':
+				out_string.push_back('\t');
+				break;
+			case 'u':
+				read_unicode_escape(out_string);
+				continue;
+			default:
+				throw_error("Invalid escape sequence in JSON data");
+			}
+			pos += 2;
+		}
+	}
+}
+
+void JsonReader_Impl::read_unicode_escape(std::string &out_string)
+{
+	if (!require(6))
+		throw_error("Unexpected end of JSON data");
+	unsigned int code = read_hex4();
+	pos += 6;
+
+	// Combine UTF-16 surrogate pairs:
+	if (code >= 0xd800 && code < 0xdc00)
+	{
+		unsigned int low = 0;
+		if (require(6) && buffer[pos] == '\\' && buffer[pos + 1] == 'u')
+			low = read_hex4();
+
+		if (low >= 0xdc00 && low < 0xe000)
+		{
+			code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+			pos += 6;
+		}
+		else
+		{
+			code = 0xfffd;
+		}
+	}
+	else if (code >= 0xdc00 && code < 0xe000)
+	{
+		code = 0xfffd;
+	}
+
+	if (code < 0x80)
+	{
+		out_string.push_back((char) code);
+	}
+	else if (code < 0x800)
+	{
+		out_string.push_back((char) (0xc0 | (code >> 6)));
+		out_string.push_back((char) (0x80 | (code & 0x3f)));
+	}
+	else if (code < 0x10000)
+	{
+		out_string.push_back((char) (0xe0 | (code >> 12)));
+		out_string.push_back((char) (0x80 | ((code >> 6) & 0x3f)));
+		out_string.push_back((char) (0x80 | (code & 0x3f)));
+	}
+	else
+	{
+		out_string.push_back((char) (0xf0 | (code >> 18)));
+		out_string.push_back((char) (0x80 | ((code >> 12) & 0x3f)));
+		out_string.push_back((char) (0x80 | ((code >> 6) & 0x3f)));
+		out_string.push_back((char) (0x80 | (code & 0x3f)));
+	}
+}
+
+unsigned int JsonReader_Impl::read_hex4()
+{
+	// Reads the four digits of the \uXXXX escape at pos
+	unsigned int code = 0;
+	for (int i = 2; i < 6; i++)
+	{
+		char c = buffer[pos + i];
+		code <<= 4;
+		if (c >= '0' && c <= '9')
+			code += c - '0';
+		else if (c >= 'a' && c <= 'f')
+			code += c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F')
+			code += c - 'A' + 10;
+		else
+			throw_error("Invalid unicode escape in JSON data");
+	}
+	return code;
+}
+
+void JsonReader_Impl::read_number()
+{
+	std::string::size_type start = pos;
+	while (pos < size && is_number_char(buffer[pos]))
+		pos++;
+
+	// Parse directly from the buffer when the whole number is in it:
+	if (pos < size)
+	{
+		if (!JsonReader::parse_number(&buffer[start], pos - start, number_value))
+			throw_error("Invalid number in JSON data");
+		return;
+	}
+
+	number_text.assign(&buffer[0] + start, pos - start);
+	while (fill())
+	{
+		while (pos < size && is_number_char(buffer[pos]))
+			pos++;
+		number_text.append(&buffer[0], pos);
+		if (pos < size)
+			break;
+	}
+
+	if (!JsonReader::parse_number(number_text.data(), number_text.length(), number_value))
+		throw_error("Invalid number in JSON data");
+}
+
+void JsonReader_Impl::read_literal(const char *literal, std::string::size_type length)
+{
+	if (!require(length) || memcmp(&buffer[pos], literal, length) != 0)
+		throw_error("Unexpected character in JSON data");
+	pos += length;
+}
+
+int JsonReader_Impl::peek_non_whitespace()
+{
+	while (true)
+	{
+		while (pos < size)
+		{
+			char c = buffer[pos];
+			if (c != ' ' && c != '\n' && c != '\r' && c != '\t' && c != '\f')
+				return (unsigned char) c;
+			pos++;
+		}
+
+		if (!fill())
+			return -1;
+	}
+}
+
+bool JsonReader_Impl::fill()
+{
+	if (end_of_input)
+		return false;
+
+	// Discard everything already consumed:
+	if (pos > 0)
+	{
+		discarded_bytes += pos;
+		if (size > pos)
+			memmove(&buffer[0], &buffer[pos], size - pos);
+		size -= pos;
+		pos = 0;
+	}
+
+	// The current escape sequence does not fit in the buffer:
+	if (size == buffer.size())
+		buffer.resize(buffer.size() * 2);
+
+	int received = input.receive(&buffer[size], (int) (buffer.size() - size), true);
+	if (received <= 0)
+	{
+		end_of_input = true;
+		return false;
+	}
+	size += received;
+	return true;
+}
+
+bool JsonReader_Impl::require(std::string::size_type length)
+{
+	while (size - pos < length)
+	{
+		if (!fill())
+			return false;
+	}
+	return true;
+}
+
+void JsonReader_Impl::check_bom()
+{
+	bom_checked = true;
+	require(3);
+	if (StringHelp::detect_bom(&buffer[pos], size - pos) == StringHelp::bom_utf8)
+		pos += 3;
+}
+
+void JsonReader_Impl::throw_error(const char *message) const
+{
+	throw JsonException(string_format("%1 at byte %2", message, StringHelp::ull_to_text(discarded_bytes + pos)));
+}
+
+}
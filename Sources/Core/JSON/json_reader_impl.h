@@ -0,0 +1,106 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Core/JSON/json_reader.h"
+#include <vector>
+
+namespace clan
+{
+
+class IODevice;
+
+class JsonReader_Impl
+{
+/// \name Construction
+/// \{
+public:
+	JsonReader_Impl(IODevice &input, int buffer_size);
+/// \}
+
+/// \name Attributes
+/// \{
+public:
+	JsonReader::Event event;
+	std::string string_value;
+	double number_value;
+	bool boolean_value;
+
+	// '{' or '[' for each open container
+	std::vector<char> containers;
+/// \}
+
+/// \name Operations
+/// \{
+public:
+	JsonReader::Event next();
+/// \}
+
+/// \name Implementation
+/// \{
+private:
+	enum Expect
+	{
+		expect_value,
+		expect_first_member,
+		expect_first_item,
+		expect_separator,
+		expect_end
+	};
+
+	JsonReader::Event read_key(int c);
+	JsonReader::Event read_value(int c);
+	JsonReader::Event end_container();
+	void read_string(std::string &out_string);
+	void read_number();
+	void read_literal(const char *literal, std::string::size_type length);
+	void read_unicode_escape(std::string &out_string);
+	unsigned int read_hex4();
+	int peek_non_whitespace();
+
+	bool fill();
+	bool require(std::string::size_type length);
+	void throw_error(const char *message) const;
+	void check_bom();
+
+	static bool is_number_char(char c) { return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E'; }
+
+	IODevice &input;
+	std::vector<char> buffer;
+	std::string::size_type pos;
+	std::string::size_type size;
+	std::string::size_type discarded_bytes;
+	bool end_of_input;
+	bool bom_checked;
+	Expect expect;
+	std::string number_text;
+/// \}
+};
+
+}
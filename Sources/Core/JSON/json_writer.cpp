@@ -0,0 +1,338 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/JSON/json_writer.h"
+#include "API/Core/JSON/json_reader.h"
+#include "API/Core/JSON/json_value.h"
+#include "API/Core/IOData/iodevice.h"
+#include "json_writer_impl.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonWriter Construction:
+
+JsonWriter::JsonWriter(IODevice &output, int buffer_size)
+: impl(new JsonWriter_Impl(&output, 0, buffer_size))
+{
+}
+
+JsonWriter::JsonWriter(std::string &output)
+: impl(new JsonWriter_Impl(0, &output, 0))
+{
+}
+
+JsonWriter::~JsonWriter()
+{
+	try
+	{
+		impl->flush();
+	}
+	catch (...)
+	{
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonWriter Operations:
+
+void JsonWriter::begin_object()
+{
+	impl->begin_container('{');
+}
+
+void JsonWriter::end_object()
+{
+	impl->end_container('{');
+}
+
+void JsonWriter::begin_array()
+{
+	impl->begin_container('[');
+}
+
+void JsonWriter::end_array()
+{
+	impl->end_container('[');
+}
+
+void JsonWriter::write_key(const std::string &key)
+{
+	write_key(key.data(), key.length());
+}
+
+void JsonWriter::write_key(const char *key, std::string::size_type length)
+{
+	if (impl->containers.empty() || impl->containers.back() != '{' || impl->after_key)
+		throw JsonException("JSON member name written outside an object");
+
+	if (!impl->first)
+		impl->target->push_back(',');
+	impl->first = false;
+	format_string(key, length, *impl->target);
+	impl->target->push_back(':');
+	impl->after_key = true;
+	impl->written();
+}
+
+void JsonWriter::write_string(const std::string &value)
+{
+	write_string(value.data(), value.length());
+}
+
+void JsonWriter::write_string(const char *value, std::string::size_type length)
+{
+	impl->begin_value();
+	format_string(value, length, *impl->target);
+	impl->written();
+}
+
+void JsonWriter::write_number(int value)
+{
+	impl->begin_value();
+	char buf[16];
+	char *end = buf + 16;
+	char *p = end;
+	unsigned int v = value < 0 ? 0u - (unsigned int) value : (unsigned int) value;
+	do
+	{
+		*(--p) = '0' + (v % 10);
+		v /= 10;
+	} while (v);
+	if (value < 0)
+		*(--p) = '-';
+	impl->target->append(p, end - p);
+	impl->written();
+}
+
+void JsonWriter::write_number(double value)
+{
+	impl->begin_value();
+	format_number(value, *impl->target);
+	impl->written();
+}
+
+void JsonWriter::write_boolean(bool value)
+{
+	impl->begin_value();
+	if (value)
+		impl->target->append("true", 4);
+	else
+		impl->target->append("false", 5);
+	impl->written();
+}
+
+void JsonWriter::write_null()
+{
+	impl->begin_value();
+	impl->target->append("null", 4);
+	impl->written();
+}
+
+void JsonWriter::flush()
+{
+	impl->flush();
+}
+
+void JsonWriter::format_number(double value, std::string &out_json)
+{
+	// JSON has no representation for NaN and infinity
+	if (value != value || value - value != 0.0)
+	{
+		out_json.append("null", 4);
+		return;
+	}
+
+	char buf[64];
+	if (value > -1e15 && value < 1e15 && value == (double) (long long) value)
+	{
+		char *end = buf + 64;
+		char *p = end;
+		long long integer = (long long) value;
+		unsigned long long v = integer < 0 ? 0ull - (unsigned long long) integer : (unsigned long long) integer;
+		do
+		{
+			*(--p) = '0' + (v % 10);
+			v /= 10;
+		} while (v);
+		if (integer < 0)
+			*(--p) = '-';
+		out_json.append(p, end - p);
+		return;
+	}
+
+	// Use 15 digits when they are enough to read back the same value, and 17 otherwise:
+	for (int precision = 15; precision <= 17; precision += 2)
+	{
+#ifdef WIN32
+		int length = _snprintf(buf, 63, "%.*g", precision, value);
+#else
+		int length = snprintf(buf, 63, "%.*g", precision, value);
+#endif
+		if (length < 0 || length > 63)
+			length = 63;
+		buf[length] = 0;
+
+		// Replace the decimal point of the current C locale:
+		for (int i = 0; i < length; i++)
+		{
+			char c = buf[i];
+			if (!(c >= '0' && c <= '9') && c != '-' && c != '+' && c != 'e')
+				buf[i] = '.';
+		}
+
+		double read_back = 0.0;
+		if (precision == 17 || (JsonReader::parse_number(buf, length, read_back) && read_back == value))
+		{
+			out_json.append(buf, length);
+			return;
+		}
+	}
+}
+
+void JsonWriter::format_string(const char *value, std::string::size_type length, std::string &out_json)
+{
+	static const char hex[] = "0123456789abcdef";
+
+	out_json.push_back('"');
+	std::string::size_type start = 0;
+	for (std::string::size_type i = 0; i < length; i++)
+	{
+		unsigned char c = (unsigned char) value[i];
+		if (c >= 0x20 && c != '"' && c != '\\')
+			continue;
+
+		out_json.append(value + start, i - start);
+		start = i + 1;
+
+		switch (c)
+		{
+		case '"':
+			out_json.append("\\\"", 2);
+			break;
+		case '\\':
+			out_json.append("\\\\", 2);
+			break;
+		case '\b':
+			out_json.append("\\b", 2);
+			break;
+		case '\f':
+			out_json.append("\\f", 2);
+			break;
+		case '\n':
+			out_json.append("\\n", 2);
+			break;
+		case '\r':
+			out_json.append("\\r", 2);
+			break;
+		case '\t':
+			out_json.append("\\t", 2);
+			break;
+		default:
+			{
+				char escape[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 15] };
+				out_json.append(escape, 6);
+			}
+			break;
+		}
+	}
+	out_json.append(value + start, length - start);
+	out_json.push_back('"');
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonWriter_Impl Construction:
+
+JsonWriter_Impl::JsonWriter_Impl(IODevice *output, std::string *target, int buffer_size)
+: output(output), target(target), buffer_size(0), first(true), after_key(false)
+{
+	if (output)
+	{
+		this->target = &buffer;
+		this->buffer_size = (std::string::size_type) std::max(buffer_size, 16);
+		buffer.reserve(this->buffer_size + 64);
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JsonWriter_Impl Operations:
+
+void JsonWriter_Impl::begin_value()
+{
+	if (containers.empty())
+		return;
+
+	if (containers.back() == '{')
+	{
+		if (!after_key)
+			throw JsonException("JSON object member written without a name");
+		after_key = false;
+	}
+	else
+	{
+		if (!first)
+			target->push_back(',');
+		first = false;
+	}
+}
+
+void JsonWriter_Impl::begin_container(char type)
+{
+	begin_value();
+	containers.push_back(type);
+	target->push_back(type);
+	first = true;
+}
+
+void JsonWriter_Impl::end_container(char type)
+{
+	if (containers.empty() || containers.back() != type)
+		throw JsonException(type == '{' ? "JSON object ended outside an object" : "JSON array ended outside an array");
+	if (after_key)
+		throw JsonException("JSON object member has no value");
+
+	containers.pop_back();
+	target->push_back(type == '{' ? '}' : ']');
+	first = false;
+	written();
+}
+
+void JsonWriter_Impl::flush()
+{
+	if (output && !buffer.empty())
+	{
+		output->send(buffer.data(), (int) buffer.size(), true);
+		buffer.clear();
+	}
+}
+
+}
@@ -0,0 +1,80 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Core/JSON/json_writer.h"
+#include <vector>
+
+namespace clan
+{
+
+class IODevice;
+
+class JsonWriter_Impl
+{
+/// \name Construction
+/// \{
+public:
+	JsonWriter_Impl(IODevice *output, std::string *target, int buffer_size);
+/// \}
+
+/// \name Attributes
+/// \{
+public:
+	// Device the buffer is flushed to, or null when writing to a string
+	IODevice *output;
+
+	// String the JSON is appended to. Points at buffer when writing to a device.
+	std::string *target;
+
+	std::string buffer;
+	std::string::size_type buffer_size;
+
+	// '{' or '[' for each open container
+	std::vector<char> containers;
+
+	// No member or item has been written yet in the current container
+	bool first;
+
+	// A member name has been written and its value is expected next
+	bool after_key;
+/// \}
+
+/// \name Operations
+/// \{
+public:
+	void begin_value();
+	void begin_container(char type);
+	void end_container(char type);
+	void written() { if (output && buffer.size() >= buffer_size) flush(); }
+	void flush();
+/// \}
+};
+
+}
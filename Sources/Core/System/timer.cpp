@@ -34,8 +34,10 @@
 #include "API/Core/System/mutex.h"
 #include "API/Core/System/event.h"
 #include "API/Core/System/system.h"
+#include "API/Core/System/work_queue.h"
 #include "API/Core/Signals/callback_v0.h"
-#include <map>
+#include <algorithm>
+#include <vector>
 
 namespace clan
 {
@@ -43,23 +45,53 @@ namespace clan
 class Timer_Object
 {
 public:
-	Timer_Object() : stopped(true) {}
+	Timer_Object() : slot(0), prev(0), next(0), level(0), expire_time(0), timeout(0), repeating(false), serial(0), ref_count(1), removed(false) {}
 
-	bool stopped;
-	ubyte64 end_time;
+	Timer_Object **slot;	// Wheel slot the timer is linked into, or 0 when it is not scheduled
+	Timer_Object *prev;
+	Timer_Object *next;
+	int level;
+
+	ubyte64 expire_time;
 	unsigned int timeout;
 	bool repeating;
+
+	int serial;		// Changed by start and stop, so that expirations already handed out can be discarded
+	int ref_count;	// The Timer_Impl plus each expiration waiting to be dispatched
+	bool removed;
+
+	std::unique_ptr<WorkQueue> work_queue;
 	Callback_v0 func_expired;
 };
 
+class Timer_Expiration
+{
+public:
+	Timer_Expiration(Timer_Object *object) : object(object), serial(object->serial) {}
+
+	Timer_Object *object;
+	int serial;
+};
+
 /////////////////////////////////////////////////////////////////////////////
 // Timer_Thread Class:
 
+// Hierarchical timing wheel with millisecond ticks. The root wheel holds the timers due within
+// the next 256 ms, and each of the three outer wheels covers 64 times the span of the wheel
+// below it. Outer wheel slots are cascaded down as the root wheel wraps around, so starting,
+// stopping and expiring a timer are all constant time operations.
 class Timer_Thread : public KeepAliveObject
 {
 public:
-	Timer_Thread() : timeout(-1), stop_thread(false)
+	Timer_Thread() : stop_thread(false), current_time(System::get_time()), wakeup_time(no_wakeup), root_count(0), outer_count(0)
 	{
+		for (int i = 0; i < root_size; i++)
+			root_slots[i] = 0;
+		for (int level = 0; level < num_levels - 1; level++)
+		{
+			for (int i = 0; i < level_size; i++)
+				level_slots[level][i] = 0;
+		}
 		thread.start(this, &Timer_Thread::timer_main);
 	}
 
@@ -71,107 +103,259 @@ public:
 		update_event.set();
 		thread.join();
 
-		// Delete all timer objects in the map
-		for (std::map<int, Timer_Object* >::iterator it = timer_objects.begin(); it != timer_objects.end(); ++it)
-		{
-			delete it->second;
-		}
+		mutex_lock.lock();
+		for (size_t i = 0; i < pending.size(); i++)
+			release(pending[i].object);
 	}
 
-	void start(int timer_id, unsigned int new_timeout, bool repeat)
+	void start(Timer_Object *object, unsigned int new_timeout, bool repeat)
 	{
 		MutexSection mutex_lock(&mutex);
+		unschedule(object);
+		object->serial++;
+
+		// An empty wheel may not have been advanced for a long time, so move it to the present
+		ubyte64 time = System::get_time();
+		if (root_count == 0 && outer_count == 0)
+			current_time = std::max(current_time, time);
 
-		Timer_Object &object = get_timer_object(timer_id);
-		object.stopped = false;
-		object.end_time = System::get_time() + new_timeout;
-		object.timeout = new_timeout;
-		object.repeating = repeat;
+		object->expire_time = time + new_timeout;
+		object->timeout = new_timeout;
+		object->repeating = repeat;
+		schedule(object);
 
-		if ( (timeout == -1) || (new_timeout < ( (unsigned int) timeout) ) )
+		if (object->expire_time < wakeup_time)
 		{
 			// Only break into the thread when a shorter timeout is required
+			wakeup_time = object->expire_time;
 			update_event.set();
 		}
 	}
 
-	void stop(int timer_id)
+	void stop(Timer_Object *object)
 	{
 		MutexSection mutex_lock(&mutex);
-		Timer_Object &object = get_timer_object(timer_id);
-		object.stopped = true;
+		unschedule(object);
+		object->serial++;
 	}
 
-	void remove_timer(int timer_id)
+	void remove_timer(Timer_Object *object)
 	{
-		// Remove the unused timers, to prevent memory leaks
 		MutexSection mutex_lock(&mutex);
-		std::map<int, Timer_Object *>::iterator it = timer_objects.find(timer_id);
-		if (it != timer_objects.end())
-		{
-			delete it->second;
-			timer_objects.erase(it);
-		}
+		unschedule(object);
+		object->removed = true;
+		release(object);
 	}
 
 	void process()
 	{
 		MutexSection mutex_lock(&mutex);
+		std::vector<Timer_Expiration> expirations;
+		expirations.swap(pending);
 
-		ubyte64 current_time = System::get_time();
+		for (size_t i = 0; i < expirations.size(); i++)
+		{
+			Timer_Object *object = expirations[i].object;
+			if (object->removed || object->serial != expirations[i].serial || object->func_expired.is_null())
+			{
+				release(object);
+				continue;
+			}
 
-		// Scan for events and trigger them
-		for (std::map<int, Timer_Object *>::iterator it = timer_objects.begin(); it != timer_objects.end();)
+			Callback_v0 func_expired = object->func_expired;
+			release(object);
+			mutex_lock.unlock();
+			try
+			{
+				func_expired.invoke();
+			}
+			catch (...)
+			{
+				mutex_lock.lock();
+				pending.insert(pending.begin(), expirations.begin() + i + 1, expirations.end());
+				if (!pending.empty())
+					set_wakeup_event();
+				throw;
+			}
+			mutex_lock.lock();
+		}
+	}
+
+	static void release(Timer_Object *object)
+	{
+		if (--object->ref_count == 0)
+			delete object;
+	}
+
+	/// \brief Guards the wheel and all timer objects
+	static Mutex mutex;
+
+private:
+	static const ubyte64 no_wakeup = ~(ubyte64)0;
+
+	enum
+	{
+		num_levels = 4,
+		root_bits = 8,
+		root_size = 1 << root_bits,
+		root_mask = root_size - 1,
+		level_bits = 6,
+		level_size = 1 << level_bits,
+		level_mask = level_size - 1
+	};
+
+	static ubyte64 get_level_span(int level)
+	{
+		return ((ubyte64)1) << (root_bits + level * level_bits);
+	}
+
+	void schedule(Timer_Object *object)
+	{
+		ubyte64 expire = std::max(object->expire_time, current_time);
+		ubyte64 delta = expire - current_time;
+
+		Timer_Object **slot;
+		int level = 0;
+		if (delta < root_size)
+		{
+			slot = &root_slots[expire & root_mask];
+			root_count++;
+		}
+		else
 		{
-			Timer_Object &object = *(it->second);
-			++it;	// We need to update the iterator here - Because func_expired may remove the timer object
+			level = 1;
+			while (level < num_levels - 1 && delta >= get_level_span(level))
+				level++;
 
-			// Found a timer
-			const int grace_period = 1;	// Allow 1ms grace
-			if (object.end_time <= (current_time + grace_period))
+			// Timers beyond the outermost wheel are parked in its last slot and rescheduled when it cascades
+			if (delta >= get_level_span(num_levels - 1))
+				expire = current_time + get_level_span(num_levels - 1) - 1;
+
+			slot = &level_slots[level - 1][(expire >> (root_bits + (level - 1) * level_bits)) & level_mask];
+			outer_count++;
+		}
+
+		object->slot = slot;
+		object->level = level;
+		object->prev = 0;
+		object->next = *slot;
+		if (object->next)
+			object->next->prev = object;
+		*slot = object;
+	}
+
+	void unschedule(Timer_Object *object)
+	{
+		if (object->slot)
+		{
+			if (object->prev)
+				object->prev->next = object->next;
+			else
+				*object->slot = object->next;
+			if (object->next)
+				object->next->prev = object->prev;
+			if (object->level > 0)
+				outer_count--;
+			else
+				root_count--;
+			object->slot = 0;
+			object->prev = 0;
+			object->next = 0;
+		}
+	}
+
+	void cascade(Timer_Object *&slot)
+	{
+		Timer_Object *object = slot;
+		slot = 0;
+		while (object)
+		{
+			Timer_Object *next = object->next;
+			outer_count--;
+			schedule(object);
+			object = next;
+		}
+	}
+
+	// Expires all timers due at or before the specified time, handing them out in one batch
+	void advance(ubyte64 time)
+	{
+		while (current_time <= time)
+		{
+			// Nothing can expire before the next cascade while the root wheel is empty
+			if (root_count == 0)
 			{
-				if (!object.stopped)
+				ubyte64 cascade_time = (current_time + root_mask) & ~(ubyte64)root_mask;
+				if (outer_count == 0 || cascade_time > time)
 				{
-					if (object.repeating)
-					{
-						object.end_time += object.timeout;
-						if (object.end_time <= current_time)
-						{
-							// An event has been missed, reset the timer
-							object.end_time = current_time + object.timeout;
-						}
-					}
-					else
-					{
-						object.stopped = true;
-					}
-
-					if (!object.func_expired.is_null())
-						object.func_expired.invoke();
+					current_time = time + 1;
+					break;
 				}
+				current_time = cascade_time;
 			}
+
+			int index = (int)(current_time & root_mask);
+			if (index == 0)
+			{
+				for (int level = 1; level < num_levels; level++)
+				{
+					int level_index = (int)((current_time >> (root_bits + (level - 1) * level_bits)) & level_mask);
+					cascade(level_slots[level - 1][level_index]);
+					if (level_index != 0)
+						break;
+				}
+			}
+
+			Timer_Object *object = root_slots[index];
+			root_slots[index] = 0;
+			while (object)
+			{
+				Timer_Object *next = object->next;
+				root_count--;
+				object->slot = 0;
+				object->prev = 0;
+				object->next = 0;
+				expire(object, time);
+				object = next;
+			}
+
+			current_time++;
 		}
 	}
 
-	Callback_v0 &get_func_expired(int timer_id)
+	void expire(Timer_Object *object, ubyte64 time)
 	{
-		MutexSection mutex_lock(&mutex);
-		return get_timer_object(timer_id).func_expired;
+		if (object->repeating)
+		{
+			ubyte64 timeout = std::max(object->timeout, 1u);
+			object->expire_time += timeout;
+			if (object->expire_time <= time)
+			{
+				// An event has been missed, reset the timer
+				object->expire_time = time + timeout;
+			}
+			schedule(object);
+		}
+
+		object->ref_count++;
+		if (object->work_queue)
+			object->work_queue->queue(new Timer_WorkItem(object));
+		else
+			pending.push_back(Timer_Expiration(object));
 	}
 
-private:
-	Timer_Object &get_timer_object(int timer_id)
+	ubyte64 find_next_expiry() const
 	{
-		// Find existing timer
-		std::map<int, Timer_Object* >::iterator it = timer_objects.find(timer_id);
-		if (it != timer_objects.end())
+		// Timers in the outer wheels may be due as soon as the root wheel wraps around and cascades
+		ubyte64 cascade_time = (current_time + root_mask) & ~(ubyte64)root_mask;
+		ubyte64 end_time = (outer_count > 0) ? cascade_time : current_time + root_size;
+
+		for (ubyte64 time = current_time; time < end_time; time++)
 		{
-			return *(it->second);
+			if (root_slots[time & root_mask])
+				return time;
 		}
-
-		Timer_Object *object = new Timer_Object;
-		timer_objects[timer_id] = object;
-		return *object;
+		return (outer_count > 0) ? cascade_time : no_wakeup;
 	}
 
 	void timer_main()
@@ -183,60 +367,76 @@ private:
 			if (stop_thread)
 				break;
 
-			ubyte64 current_time = System::get_time();
-			timeout = -1;
-			bool found_timer = false;
+			ubyte64 time = System::get_time();
+			bool was_pending = !pending.empty();
+			advance(time);
+			bool wakeup = !was_pending && !pending.empty();
 
-			// Scan for timers to find the next one to call
-			for (std::map<int, Timer_Object *>::iterator it = timer_objects.begin(); it != timer_objects.end(); ++it)
-			{
-				Timer_Object &object = *(it->second);
-				if (!object.stopped)
-				{
-					if (!found_timer)
-					{
-						// First timer in the list
-						timeout = object.end_time - current_time;
-						found_timer = true;
-					}
-					else
-					{
-						// Get the smallest timeout
-						int next_timeout = object.end_time - current_time;
-						if (next_timeout < timeout)
-						{
-							timeout = next_timeout;
-						}
-					}
-					// Force update, if a timer was missed
-					if (timeout < 1)
-						timeout = 1;
-				}
-			}
+			wakeup_time = find_next_expiry();
+			int timeout = -1;
+			if (wakeup_time != no_wakeup)
+				timeout = (int)std::min(wakeup_time - time, (ubyte64)0x7fffffff);
 
 			mutex_lock.unlock();
 
-			if (Event::wait(update_event, timeout) == -1)
+			if (wakeup)
 				set_wakeup_event();
+
+			Event::wait(update_event, timeout);
 		}
 	}
 
+	class Timer_WorkItem : public WorkItem
+	{
+	public:
+		Timer_WorkItem(Timer_Object *object) : expiration(object) {}
+
+		void process_work()
+		{
+			MutexSection mutex_lock(&mutex);
+			Timer_Object *object = expiration.object;
+			if (object->removed || object->serial != expiration.serial || object->func_expired.is_null())
+				return;
+			Callback_v0 func_expired = object->func_expired;
+			mutex_lock.unlock();
+
+			func_expired.invoke();
+		}
+
+		void work_completed()
+		{
+			// Released here rather than on the worker thread, as the last reference may own the work queue
+			MutexSection mutex_lock(&mutex);
+			release(expiration.object);
+		}
+
+		Timer_Expiration expiration;
+	};
+
 	Thread thread;
 	Event update_event;
-	Mutex mutex;
-	int timeout;
 	bool stop_thread;
 
-	std::map<int, Timer_Object *> timer_objects;
+	ubyte64 current_time;	// Next tick of the root wheel to be expired
+	ubyte64 wakeup_time;
+	int root_count;			// Number of timers in the root wheel
+	int outer_count;		// Number of timers in the outer wheels
+
+	Timer_Object *root_slots[root_size];
+	Timer_Object *level_slots[num_levels - 1][level_size];
+
+	std::vector<Timer_Expiration> pending;
 };
 
+Mutex Timer_Thread::mutex;
+
 /////////////////////////////////////////////////////////////////////////////
 // Timer_Impl Class:
 
 class Timer_Impl
 {
 public:
-	Timer_Impl() : timeout(0), repeating(false), id(-1)
+	Timer_Impl() : timeout(0), repeating(false), object(new Timer_Object)
 	{
 		// Create a static timer thread if none exist
 		MutexSection mutex_lock(&timer_thread_mutex);
@@ -245,15 +445,13 @@ public:
 			timer_thread = new(Timer_Thread);
 		}
 		timer_thread_instance_count++;
-		timer_thread_max_id++;
-		id = timer_thread_max_id;
 	}
 
 	~Timer_Impl()
 	{
 		// Destroy the static timer thread if this is the last timer
 		MutexSection mutex_lock(&timer_thread_mutex);
-		timer_thread->remove_timer(id);
+		timer_thread->remove_timer(object);
 		timer_thread_instance_count--;
 		if (!timer_thread_instance_count)
 		{
@@ -262,16 +460,23 @@ public:
 		}
 	}
 
+	// The timer thread cannot go away while this timer exists, so no need for timer_thread_mutex here
 	void start(unsigned int new_timeout, bool repeat)
 	{
-		MutexSection mutex_lock(&timer_thread_mutex);
-		timer_thread->start(id, new_timeout, repeat);
+		timeout = new_timeout;
+		repeating = repeat;
+		timer_thread->start(object, new_timeout, repeat);
 	}
 
 	void stop()
 	{
-		MutexSection mutex_lock(&timer_thread_mutex);
-		timer_thread->stop(id);
+		timer_thread->stop(object);
+	}
+
+	void set_work_queue(const WorkQueue &queue)
+	{
+		MutexSection mutex_lock(&Timer_Thread::mutex);
+		object->work_queue.reset(new WorkQueue(queue));
 	}
 
 	bool is_repeating() const { return repeating; }
@@ -279,25 +484,22 @@ public:
 
 	Callback_v0 &func_expired()
 	{
-		MutexSection mutex_lock(&timer_thread_mutex);
-		return timer_thread->get_func_expired(id);
+		return object->func_expired;
 	}
 
 private:
 	static Timer_Thread *timer_thread;
 	static int timer_thread_instance_count;
 	static Mutex timer_thread_mutex;
-	static int timer_thread_max_id;	// Unique timer id
 
 	unsigned int timeout;
 	bool repeating;
-	int id;
+	Timer_Object *object;
 };
 
 Timer_Thread *Timer_Impl::timer_thread = NULL;
 int Timer_Impl::timer_thread_instance_count = 0;
 Mutex Timer_Impl::timer_thread_mutex;
-int Timer_Impl::timer_thread_max_id = 0;
 
 /////////////////////////////////////////////////////////////////////////////
 // Timer Construction:
@@ -342,6 +544,11 @@ void Timer::stop()
 	impl->stop();
 }
 
+void Timer::set_work_queue(const WorkQueue &queue)
+{
+	impl->set_work_queue(queue);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // Timer Implementation:
 
@@ -42,24 +42,28 @@ namespace clan
 class WorkQueue_Impl : public KeepAliveObject
 {
 public:
-	WorkQueue_Impl();
+	WorkQueue_Impl(int max_threads);
 	~WorkQueue_Impl();
 
+	int get_thread_count() const;
 	void queue(WorkItem *item); // transfers ownership
+	void finish();
 
 private:
 	void process();
 	void worker_main();
 
+	int max_threads;
 	std::vector<Thread> threads;
 	Mutex mutex;
-	Event stop_event, work_available_event;
+	Event stop_event, work_available_event, idle_event;
 	std::vector<WorkItem *> queued_items;
 	std::vector<WorkItem *> finished_items;
+	int items_in_progress;
 };
 
-WorkQueue::WorkQueue()
-	: impl(new WorkQueue_Impl())
+WorkQueue::WorkQueue(int max_threads)
+	: impl(new WorkQueue_Impl(max_threads))
 {
 }
 
@@ -67,14 +71,25 @@ WorkQueue::~WorkQueue()
 {
 }
 
+int WorkQueue::get_thread_count() const
+{
+	return impl->get_thread_count();
+}
+
 void WorkQueue::queue(WorkItem *item) // transfers ownership
 {
 	impl->queue(item);
 }
 
+void WorkQueue::finish()
+{
+	impl->finish();
+}
+
 /////////////////////////////////////////////////////////////////////////////
 
-WorkQueue_Impl::WorkQueue_Impl()
+WorkQueue_Impl::WorkQueue_Impl(int max_threads)
+: max_threads(max_threads), idle_event(true, true), items_in_progress(0)
 {
 }
 
@@ -89,12 +104,20 @@ WorkQueue_Impl::~WorkQueue_Impl()
 		delete finished_items[i];
 }
 
+int WorkQueue_Impl::get_thread_count() const
+{
+	if (max_threads > 0)
+		return max_threads;
+	else
+		return std::max(System::get_num_cores() - 1, 1);
+}
+
 void WorkQueue_Impl::queue(WorkItem *item) // transfers ownership
 {
 	if (threads.empty())
 	{
-		int num_cores = std::max(System::get_num_cores() - 1, 1);
-		for (int i = 0; i < num_cores; i++)
+		int num_threads = get_thread_count();
+		for (int i = 0; i < num_threads; i++)
 		{
 			Thread thread;
 			thread.start(this, &WorkQueue_Impl::worker_main);
@@ -104,10 +127,18 @@ void WorkQueue_Impl::queue(WorkItem *item) // transfers ownership
 
 	MutexSection mutex_lock(&mutex);
 	queued_items.push_back(item);
+	items_in_progress++;
+	idle_event.reset();
 	mutex_lock.unlock();
 	work_available_event.set();
 }
 
+void WorkQueue_Impl::finish()
+{
+	idle_event.wait();
+	process();
+}
+
 void WorkQueue_Impl::process()
 {
 	MutexSection mutex_lock(&mutex);
@@ -146,6 +177,8 @@ void WorkQueue_Impl::worker_main()
 			item->process_work();
 			mutex_lock.lock();
 			finished_items.push_back(item);
+			if (--items_in_progress == 0)
+				idle_event.set();
 			mutex_lock.unlock();
 			set_wakeup_event();
 		}
@@ -30,8 +30,6 @@
 #include "API/Core/Text/file_logger.h"
 #include "API/Core/IOData/file.h"
 #include "API/Core/Text/string_help.h"
-#include "API/Core/Text/string_format.h"
-#include "API/Core/System/datetime.h"
 
 namespace clan
 {
@@ -46,6 +44,9 @@ FileLogger::FileLogger(const std::string &filename) : file(0)
 
 FileLogger::~FileLogger()
 {
+	// Stop a LogQueue writer thread from calling log() while the file goes away
+	disable();
+	flush();
 	delete file;
 }
 
@@ -57,54 +58,19 @@ FileLogger::~FileLogger()
 
 void FileLogger::log(const std::string &type, const std::string &text)
 {
-	std::string months[] =
-	{
-		"Jan",
-		"Feb",
-		"Mar",
-		"Apr",
-		"May",
-		"Jun",
-		"Jul",
-		"Aug",
-		"Sep",
-		"Oct",
-		"Nov",
-		"Dec"
-	};
-	
-	std::string days[] =
-	{
-		"Sun",
-		"Mon",
-		"Tue",
-		"Wed",
-		"Thu",
-		"Fri",
-		"Sat"
-	};
-
-	// Tue Nov 16 11:34:15 CET 2004
-	DateTime cur_time = DateTime::get_current_utc_time();
-
-#ifdef WIN32
-	StringFormat format("%1 %2 %3 %4:%5:%6 %7 UTC [%8] %9\r\n");
-#else
-	StringFormat format("%1 %2 %3 %4:%5:%6 %7 UTC [%8] %9\n");
-#endif
-	format.set_arg(1, days[cur_time.get_day_of_week()]);
-	format.set_arg(2, months[cur_time.get_month() - 1]);
-	format.set_arg(3, cur_time.get_day());
-	format.set_arg(4, cur_time.get_hour(), 2);
-	format.set_arg(5, cur_time.get_minutes(), 2);
-	format.set_arg(6, cur_time.get_seconds(), 2);
-	format.set_arg(7, cur_time.get_year());
-	format.set_arg(8, type);
-	format.set_arg(9, text);
-	std::string log_line = StringHelp::text_to_local8(format.get_result());
+	buffer.append(StringHelp::text_to_local8(get_log_line(type, text)));
+	if (buffer.length() >= 64 * 1024)
+		flush();
+}
 
-	file->seek(0, File::seek_end);
-	file->write(log_line.data(), (int) log_line.length());
+void FileLogger::flush()
+{
+	if (!buffer.empty())
+	{
+		file->seek(0, File::seek_end);
+		file->write(buffer.data(), (int) buffer.length());
+		buffer.clear();
+	}
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,294 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/Text/log_queue.h"
+#include "log_queue_impl.h"
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// LogQueue Construction:
+
+LogQueue::LogQueue(int capacity, FullPolicy policy, int flush_interval)
+: impl(new LogQueue_Impl(capacity, policy, flush_interval))
+{
+}
+
+LogQueue::~LogQueue()
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// LogQueue Attributes:
+
+int LogQueue::get_capacity() const
+{
+	return impl->capacity;
+}
+
+int LogQueue::get_queued_count() const
+{
+	return impl->enqueue_position.get();
+}
+
+int LogQueue::get_written_count() const
+{
+	return impl->written_position.get();
+}
+
+int LogQueue::get_dropped_count() const
+{
+	return impl->dropped_count.get();
+}
+
+int LogQueue::get_batch_count() const
+{
+	return impl->batch_count.get();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// LogQueue Operations:
+
+void LogQueue::flush()
+{
+	impl->flush();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// LogQueue_Impl Construction:
+
+LogQueue_Impl *LogQueue_Impl::instance = 0;
+InterlockedVariable LogQueue_Impl::state;
+
+LogQueue_Impl::LogQueue_Impl(int requested_capacity, LogQueue::FullPolicy policy, int flush_interval)
+: capacity(16), policy(policy), flush_interval(flush_interval), dequeue_position(0), wakeup_event(false, false), written_event(false, false)
+{
+	if (!state.compare_and_swap(state_none, state_busy))
+		throw Exception("Only one LogQueue can exist at a time");
+
+	try
+	{
+		while (capacity < requested_capacity)
+			capacity *= 2;
+		mask = capacity - 1;
+
+		// Producers wake the writer thread each time a quarter of the queue has been filled
+		wakeup_mask = capacity / 4 - 1;
+
+		entries.resize(capacity);
+		for (int i = 0; i < capacity; i++)
+			entries[i].sequence.set(i);
+
+		writer_thread.start(this, &LogQueue_Impl::writer_main);
+	}
+	catch (...)
+	{
+		state.set(state_none);
+		throw;
+	}
+
+	instance = this;
+	state.compare_and_swap(state_busy, state_active);
+}
+
+LogQueue_Impl::~LogQueue_Impl()
+{
+	state.compare_and_swap(state_active, state_busy);
+	stop_event.set();
+	writer_thread.join();
+	instance = 0;
+	state.set(state_none);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// LogQueue_Impl Operations:
+
+void LogQueue_Impl::push(const std::string &type, const std::string &text)
+{
+	unsigned int position;
+	Entry *entry = begin_push(position);
+	if (entry)
+	{
+		entry->type = type;
+		entry->text = text;
+		entry->num_args = 0;
+		end_push(entry, position);
+	}
+}
+
+void LogQueue_Impl::push(const std::string &type, const LogEventFormat &format)
+{
+	unsigned int position;
+	Entry *entry = begin_push(position);
+	if (entry)
+	{
+		entry->type = type;
+		entry->text = format.get_format();
+		entry->num_args = format.get_num_args();
+		for (int i = 0; i < entry->num_args; i++)
+		{
+			// Copy string arguments into the entry, as the caller's strings go away when log_event returns
+			LogEventFormat::Arg &arg = entry->args[i];
+			arg = format.get_arg(i + 1);
+			if (arg.type == LogEventFormat::arg_text)
+			{
+				entry->arg_text[i] = *arg.text;
+				arg.text = &entry->arg_text[i];
+			}
+			else if (arg.type == LogEventFormat::arg_c_text && arg.c_text)
+			{
+				entry->arg_text[i] = arg.c_text;
+				arg.type = LogEventFormat::arg_text;
+				arg.text = &entry->arg_text[i];
+			}
+		}
+		end_push(entry, position);
+	}
+}
+
+void LogQueue_Impl::flush()
+{
+	unsigned int target = enqueue_position.get();
+	while ((int) ((unsigned int) written_position.get() - target) < 0)
+	{
+		wakeup_event.set();
+		written_event.wait(flush_interval);
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// LogQueue_Impl Implementation:
+
+LogQueue_Impl::Entry *LogQueue_Impl::begin_push(unsigned int &position)
+{
+	while (true)
+	{
+		unsigned int pos = enqueue_position.get();
+		Entry &entry = entries[pos & mask];
+		int delta = (int) ((unsigned int) entry.sequence.get() - pos);
+		if (delta == 0)
+		{
+			if (enqueue_position.compare_and_swap(pos, pos + 1))
+			{
+				position = pos;
+				return &entry;
+			}
+		}
+		else if (delta < 0)
+		{
+			// The writer thread has not written the event stored here a lap ago
+			if (policy == LogQueue::drop_event)
+			{
+				dropped_count.increment();
+				return 0;
+			}
+			// Reset before checking again, so a batch written in between leaves the event set.
+			// The timeout covers another producer resetting it before this one wakes up
+			space_event.reset();
+			if ((int) ((unsigned int) entry.sequence.get() - pos) < 0)
+			{
+				wakeup_event.set();
+				space_event.wait(flush_interval);
+			}
+		}
+	}
+}
+
+void LogQueue_Impl::end_push(Entry *entry, unsigned int position)
+{
+	entry->sequence.set(position + 1);
+	if ((position & wakeup_mask) == wakeup_mask)
+		wakeup_event.set();
+}
+
+void LogQueue_Impl::writer_main()
+{
+	while (true)
+	{
+		int wakeup_reason = Event::wait(stop_event, wakeup_event, flush_interval);
+		write_batch();
+		if (wakeup_reason == 0)
+			break;
+	}
+}
+
+void LogQueue_Impl::write_batch()
+{
+	unsigned int start_position = dequeue_position;
+
+	MutexSection mutex_lock(&Logger::mutex);
+	while (true)
+	{
+		Entry &entry = entries[dequeue_position & mask];
+		if ((unsigned int) entry.sequence.get() != dequeue_position + 1)
+			break;
+
+		std::string formatted_text;
+		if (entry.num_args > 0)
+			formatted_text = LogEventFormat::format_text(entry.text, entry.num_args, entry.args);
+		const std::string &text = entry.num_args > 0 ? formatted_text : entry.text;
+
+		for (std::vector<Logger*>::iterator il = Logger::instances.begin(); il != Logger::instances.end(); il++)
+		{
+			try
+			{
+				(*il)->log(entry.type, text);
+			}
+			catch (...)
+			{
+				// Nothing to report a failing logger to
+			}
+		}
+
+		entry.sequence.set(dequeue_position + capacity);
+		dequeue_position++;
+	}
+
+	if (dequeue_position != start_position)
+	{
+		for (std::vector<Logger*>::iterator il = Logger::instances.begin(); il != Logger::instances.end(); il++)
+		{
+			try
+			{
+				(*il)->flush();
+			}
+			catch (...)
+			{
+			}
+		}
+
+		batch_count.increment();
+		written_position.set(dequeue_position);
+		written_event.set();
+		space_event.set();
+	}
+}
+
+}
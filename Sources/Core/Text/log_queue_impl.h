@@ -0,0 +1,124 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Core/Text/log_queue.h"
+#include "API/Core/Text/logger.h"
+#include "API/Core/System/interlocked_variable.h"
+#include "API/Core/System/thread.h"
+#include "API/Core/System/event.h"
+
+namespace clan
+{
+
+class LogQueue_Impl
+{
+/// \name Construction
+/// \{
+
+public:
+	LogQueue_Impl(int capacity, LogQueue::FullPolicy policy, int flush_interval);
+	~LogQueue_Impl();
+
+/// \}
+/// \name Attributes
+/// \{
+
+public:
+	/// \brief Returns the queue log_event uses, if any
+	static LogQueue_Impl *get_active() { return state.get() == state_active ? instance : 0; }
+
+	int capacity;
+	LogQueue::FullPolicy policy;
+	int flush_interval;
+
+	InterlockedVariable enqueue_position;
+	InterlockedVariable written_position;
+	InterlockedVariable dropped_count;
+	InterlockedVariable batch_count;
+
+/// \}
+/// \name Operations
+/// \{
+
+public:
+	void push(const std::string &type, const std::string &text);
+	void push(const std::string &type, const LogEventFormat &format);
+
+	void flush();
+
+/// \}
+/// \name Implementation
+/// \{
+
+private:
+	// Queue cell. sequence equals the position when the cell is free for that position,
+	// and the position plus one once the event stored in it can be written.
+	struct Entry
+	{
+		InterlockedVariable sequence;
+		std::string type;
+		std::string text;
+		int num_args;
+		LogEventFormat::Arg args[LogEventFormat::max_args];
+		std::string arg_text[LogEventFormat::max_args];
+	};
+
+	Entry *begin_push(unsigned int &position);
+	void end_push(Entry *entry, unsigned int position);
+
+	void writer_main();
+	void write_batch();
+
+	enum State
+	{
+		state_none,
+		state_busy,
+		state_active
+	};
+
+	// Published by moving state from state_busy to state_active, which orders the write of instance before it
+	static LogQueue_Impl *instance;
+	static InterlockedVariable state;
+
+	std::vector<Entry> entries;
+	unsigned int mask;
+	unsigned int wakeup_mask;
+	unsigned int dequeue_position;
+
+	Thread writer_thread;
+	Event stop_event;
+	Event wakeup_event;
+	Event written_event;
+	Event space_event;
+/// \}
+};
+
+}
@@ -28,6 +28,8 @@
 
 #include "Core/precomp.h"
 #include "API/Core/Text/logger.h"
+#include "API/Core/System/datetime.h"
+#include "log_queue_impl.h"
 #include <algorithm>
 
 namespace clan
@@ -78,14 +80,117 @@ void Logger::log(const std::string &type, const std::string &text)
 
 void log_event(const std::string &type, const std::string &text)
 {
+	LogQueue_Impl *queue = LogQueue_Impl::get_active();
+	if (queue)
+	{
+		queue->push(type, text);
+		return;
+	}
+
 	MutexSection mutex_lock(&Logger::mutex);
 	if (Logger::instances.empty())
 		return;
 	for(std::vector<Logger*>::iterator il = Logger::instances.begin(); il != Logger::instances.end(); il++)
+	{
 		(*il)->log(type, text);
+		(*il)->flush();
+	}
+}
+
+void log_event(const std::string &type, const LogEventFormat &format)
+{
+	LogQueue_Impl *queue = LogQueue_Impl::get_active();
+	if (queue)
+		queue->push(type, format);
+	else
+		log_event(type, format.get_result());
 }
 
 /////////////////////////////////////////////////////////////////////////////
 // Logger Implementation:
 
+static void append_two_digits(std::string &text, int value)
+{
+	text.push_back('0' + value / 10);
+	text.push_back('0' + value % 10);
+}
+
+std::string Logger::get_log_line(const std::string &type, const std::string &text)
+{
+	static const char *months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+	static const char *days[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+
+	// Tue Nov 16 11:34:15 2004 UTC [type] text
+	DateTime cur_time = DateTime::get_current_utc_time();
+	std::string line;
+	line.reserve(32 + type.length() + text.length());
+	line.append(days[cur_time.get_day_of_week()]);
+	line.append(" ");
+	line.append(months[cur_time.get_month() - 1]);
+	line.append(" ");
+	line.append(StringHelp::int_to_text(cur_time.get_day()));
+	line.append(" ");
+	append_two_digits(line, cur_time.get_hour());
+	line.append(":");
+	append_two_digits(line, cur_time.get_minutes());
+	line.append(":");
+	append_two_digits(line, cur_time.get_seconds());
+	line.append(" ");
+	line.append(StringHelp::int_to_text(cur_time.get_year()));
+	line.append(" UTC [");
+	line.append(type);
+	line.append("] ");
+	line.append(text);
+#ifdef WIN32
+	line.append("\r\n");
+#else
+	line.append("\n");
+#endif
+	return line;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// LogEventFormat Attributes:
+
+std::string LogEventFormat::format_text(const std::string &format, int num_args, const Arg *args)
+{
+	StringFormat f(format);
+	for (int i = 0; i < num_args; i++)
+	{
+		const Arg &arg = args[i];
+		switch (arg.type)
+		{
+		case arg_text:
+			f.set_arg(i + 1, *arg.text);
+			break;
+		case arg_c_text:
+			if (arg.c_text)
+				f.set_arg(i + 1, arg.c_text);
+			break;
+		case arg_int:
+			f.set_arg(i + 1, (int) arg.int_value);
+			break;
+		case arg_uint:
+			f.set_arg(i + 1, (unsigned int) arg.uint_value);
+			break;
+		case arg_ulong:
+			f.set_arg(i + 1, (long unsigned int) arg.uint_value);
+			break;
+		case arg_longlong:
+			f.set_arg(i + 1, (long long) arg.int_value);
+			break;
+		case arg_ulonglong:
+			f.set_arg(i + 1, (unsigned long long) arg.uint_value);
+			break;
+		case arg_float:
+			f.set_arg(i + 1, (float) arg.double_value);
+			break;
+		case arg_double:
+			f.set_arg(i + 1, arg.double_value);
+			break;
+		}
+	}
+	return f.get_result();
+}
+
 }
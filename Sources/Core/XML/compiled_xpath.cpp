@@ -0,0 +1,106 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/XML/compiled_xpath.h"
+#include "compiled_xpath_impl.h"
+#include "xpath_evaluator_impl.h"
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// CompiledXPath Construction:
+
+CompiledXPath::CompiledXPath()
+{
+}
+
+CompiledXPath::CompiledXPath(const std::string &expression)
+: impl(new CompiledXPath_Impl(expression))
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CompiledXPath Attributes:
+
+const std::string &CompiledXPath::get_expression() const
+{
+	static std::string empty_string;
+	return impl ? impl->text : empty_string;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CompiledXPath_Impl Construction:
+
+CompiledXPath_Impl::CompiledXPath_Impl(const std::string &expression)
+: text(expression)
+{
+	// The XPath lexical rules depend on the preceding token, so the expression
+	// is read from the start exactly like the evaluator would read it:
+	XPathToken token;
+	while (true)
+	{
+		token = XPathEvaluator_Impl::read_token(text, token);
+		tokens.push_back(token);
+		if (token.type == XPathToken::type_none)
+			break;
+	}
+
+	next_token.resize(text.length() + 1, tokens.size() - 1);
+	next_token[0] = 0;
+	for (std::vector<XPathToken>::size_type i = 0; i + 1 < tokens.size(); i++)
+		next_token[tokens[i].pos + tokens[i].length] = i + 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CompiledXPath_Impl Operations:
+
+const XPathToken &CompiledXPath_Impl::read_token(const XPathToken &previous_token) const
+{
+	std::string::size_type end = previous_token.pos + previous_token.length;
+	if (end < next_token.size())
+		return tokens[next_token[end]];
+	else
+		return tokens.back();
+}
+
+const XPathLocationPath *CompiledXPath_Impl::find_location_path(std::string::size_type pos) const
+{
+	MutexSection mutex_lock(&mutex);
+	std::map<std::string::size_type, XPathLocationPath>::const_iterator it = location_paths.find(pos);
+	return it != location_paths.end() ? &it->second : 0;
+}
+
+const XPathLocationPath *CompiledXPath_Impl::add_location_path(std::string::size_type pos, const XPathLocationPath &path) const
+{
+	MutexSection mutex_lock(&mutex);
+	return &location_paths.insert(std::make_pair(pos, path)).first->second;
+}
+
+}
@@ -0,0 +1,94 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Core/System/mutex.h"
+#include "xpath_token.h"
+#include "xpath_location_step.h"
+#include <map>
+#include <vector>
+
+namespace clan
+{
+
+class XPathLocationPath
+{
+public:
+	std::vector<XPathLocationStep> steps;
+	XPathToken last_token;
+};
+
+class CompiledXPath_Impl
+{
+/// \name Construction
+/// \{
+
+public:
+	CompiledXPath_Impl(const std::string &expression);
+
+
+/// \}
+/// \name Attributes
+/// \{
+
+public:
+	std::string text;
+
+
+/// \}
+/// \name Operations
+/// \{
+
+public:
+	/// \brief Returns the token following previous_token, or a type_none token at the end of the expression
+	const XPathToken &read_token(const XPathToken &previous_token = XPathToken()) const;
+
+	/// \brief Returns the location path starting at the token position, or 0 if it has not been parsed yet
+	const XPathLocationPath *find_location_path(std::string::size_type pos) const;
+
+	const XPathLocationPath *add_location_path(std::string::size_type pos, const XPathLocationPath &path) const;
+
+
+/// \}
+/// \name Implementation
+/// \{
+
+private:
+	// Tokens in expression order, ending with a type_none token
+	std::vector<XPathToken> tokens;
+
+	// Index into tokens for each position a token ends at
+	std::vector<unsigned int> next_token;
+
+	mutable Mutex mutex;
+	mutable std::map<std::string::size_type, XPathLocationPath> location_paths;
+/// \}
+};
+
+}
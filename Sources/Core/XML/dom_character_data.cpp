@@ -78,9 +78,9 @@ void DomCharacterData::append_data(const DomString &arg)
 {
 	if (impl)
 	{
-		DomDocument_Impl *doc = static_cast<DomDocument_Impl *>(impl->owner_document.lock().get());
-		DomString value = impl->get_tree_node()->get_node_value();
-		impl->get_tree_node()->node_value += arg;
+		DomDocument_Impl *doc_impl = static_cast<DomDocument_Impl *>(impl->owner_document.lock().get());
+		DomString value = impl->get_tree_node()->get_node_value(doc_impl);
+		impl->get_tree_node()->set_node_value(doc_impl, value + arg);
 	}
 }
 
@@ -88,11 +88,11 @@ void DomCharacterData::insert_data(unsigned long offset, const DomString &arg)
 {
 	if (impl)
 	{
-		DomDocument_Impl *doc = static_cast<DomDocument_Impl *>(impl->owner_document.lock().get());
-		DomString value = impl->get_tree_node()->get_node_value();
+		DomDocument_Impl *doc_impl = static_cast<DomDocument_Impl *>(impl->owner_document.lock().get());
+		DomString value = impl->get_tree_node()->get_node_value(doc_impl);
 		if (offset > value.length())
 			offset = value.length();
-		impl->get_tree_node()->node_value = value.substr(0, offset) + arg + value.substr(offset);
+		impl->get_tree_node()->set_node_value(doc_impl, value.substr(0, offset) + arg + value.substr(offset));
 	}
 }
 
@@ -100,7 +100,8 @@ void DomCharacterData::delete_data(unsigned long offset, unsigned long count)
 {
 	if (impl)
 	{
-		DomString value = impl->get_tree_node()->get_node_value();
+		DomDocument_Impl *doc_impl = static_cast<DomDocument_Impl *>(impl->owner_document.lock().get());
+		DomString value = impl->get_tree_node()->get_node_value(doc_impl);
 		if (offset > value.length())
 			offset = value.length();
 		if (offset + count > value.length())
@@ -116,7 +117,7 @@ void DomCharacterData::delete_data(unsigned long offset, unsigned long count)
 		{
 			value = DomString();
 		}
-		impl->get_tree_node()->node_value = value;
+		impl->get_tree_node()->set_node_value(doc_impl, value);
 	}
 }
 
@@ -43,7 +43,9 @@
 #include "API/Core/XML/xml_tokenizer.h"
 #include "API/Core/XML/xml_writer.h"
 #include "API/Core/XML/xml_token.h"
+#include "API/Core/XML/xml_token_view.h"
 #include "dom_document_generic.h"
+#include "dom_tree_node.h"
 #include <stack>
 
 namespace clan
@@ -283,52 +285,57 @@ std::vector<DomNode> DomDocument::load(
 	if (insert_point.is_element() == false)
 		insert_point = *this;
 
-	std::vector<DomNode> node_stack;
-	node_stack.push_back(insert_point);
+	DomDocument_Impl *doc_impl = static_cast<DomDocument_Impl *>(impl.get());
+	unsigned int insert_index = insert_point.impl->node_index;
+
+	// The tree is built directly from the token views, names become atoms and
+	// values are copied once into the document string arena.
+	std::vector<unsigned int> node_stack;
+	node_stack.push_back(insert_index);
 
 	std::vector<DomNode> result;
 	try
 	{
-		XMLToken cur_token;
+		XMLTokenView cur_token;
 		tokenizer.next(&cur_token);
 		while (cur_token.type != XMLToken::NULL_TOKEN)
 		{
+			unsigned int parent_index = node_stack.back();
+			unsigned int node_index = cl_null_node_index;
 			switch (cur_token.type)
 			{
 			case XMLToken::TEXT_TOKEN:
-				node_stack.back().append_child(create_text_node(cur_token.value));
-				if (node_stack.back() == insert_point)
-					result.push_back(node_stack.back().get_last_child());
+				node_index = doc_impl->append_tree_node(parent_index, TEXT_NODE);
+				doc_impl->set_tree_node_value(node_index, cur_token.value);
 				break;
 
 			case XMLToken::CDATA_SECTION_TOKEN:
-				node_stack.back().append_child(create_cdata_section(cur_token.value));
-				if (node_stack.back() == insert_point)
-					result.push_back(node_stack.back().get_last_child());
+				node_index = doc_impl->append_tree_node(parent_index, CDATA_SECTION_NODE);
+				doc_impl->set_tree_node_value(node_index, cur_token.value);
 				break;
 
 			case XMLToken::ELEMENT_TOKEN:
 				if (cur_token.variant != XMLToken::END)
 				{
-					DomString namespace_uri = DomDocument_Impl::find_namespace_uri(cur_token.name, cur_token, node_stack.back());
-					DomElement element = create_element_ns(namespace_uri, cur_token.name);
-					node_stack.back().append_child(element);
-					if (node_stack.back() == insert_point)
-						result.push_back(node_stack.back().get_last_child());
+					unsigned int namespace_atom = doc_impl->find_namespace_uri(cur_token.name, cur_token, parent_index);
+					node_index = doc_impl->append_tree_node(parent_index, ELEMENT_NODE);
+					doc_impl->nodes[node_index]->name_atom = doc_impl->find_atom(cur_token.name);
+					doc_impl->nodes[node_index]->namespace_atom = namespace_atom;
 
 					int size = (int) cur_token.attributes.size();
 					for (int i=0; i<size; i++)
 					{
-						XMLToken::Attribute &attribute = cur_token.attributes[i];
-						DomString attribute_namespace_uri = DomDocument_Impl::find_namespace_uri(attribute.first, cur_token, node_stack.back());
-						element.set_attribute_ns(
-							attribute_namespace_uri,
-							attribute.first,
+						XMLTokenView::Attribute &attribute = cur_token.attributes[i];
+						unsigned int attribute_namespace_atom = doc_impl->find_namespace_uri(attribute.first, cur_token, parent_index);
+						doc_impl->set_tree_node_attribute(
+							node_index,
+							attribute_namespace_atom,
+							doc_impl->find_atom(attribute.first),
 							attribute.second);
 					}
-				
+
 					if (cur_token.variant == XMLToken::BEGIN)
-						node_stack.push_back(element);
+						node_stack.push_back(node_index);
 				}
 				else
 				{
@@ -347,9 +354,8 @@ std::vector<DomNode> DomDocument::load(
 				break;
 			
 			case XMLToken::COMMENT_TOKEN:
-				node_stack.back().append_child(create_comment(cur_token.value));
-				if (node_stack.back() == insert_point)
-					result.push_back(node_stack.back().get_last_child());
+				node_index = doc_impl->append_tree_node(parent_index, COMMENT_NODE);
+				doc_impl->set_tree_node_value(node_index, cur_token.value);
 				break;
 
 			case XMLToken::DOCUMENT_TYPE_TOKEN:
@@ -359,12 +365,19 @@ std::vector<DomNode> DomDocument::load(
 				break;
 
 			case XMLToken::PROCESSING_INSTRUCTION_TOKEN:
-				node_stack.back().append_child(create_processing_instruction(cur_token.name, cur_token.value));
-				if (node_stack.back() == insert_point)
-					result.push_back(node_stack.back().get_last_child());
+				node_index = doc_impl->append_tree_node(parent_index, PROCESSING_INSTRUCTION_NODE);
+				doc_impl->nodes[node_index]->name_atom = doc_impl->find_atom(cur_token.name);
+				doc_impl->set_tree_node_value(node_index, cur_token.value);
 				break;
 			}		
 
+			if (node_index != cl_null_node_index && parent_index == insert_index)
+			{
+				DomNode_Impl *dom_node = doc_impl->allocate_dom_node();
+				dom_node->node_index = node_index;
+				result.push_back(DomNode(std::shared_ptr<DomNode_Impl>(dom_node, DomDocument_Impl::NodeDeleter(doc_impl))));
+			}
+
 			tokenizer.next(&cur_token);
 		}
 	}
@@ -27,7 +27,7 @@
 */
 
 #include "Core/precomp.h"
-#include "API/Core/XML/xml_token.h"
+#include "API/Core/XML/xml_token_view.h"
 #include "API/Core/XML/dom_node.h"
 #include "dom_document_generic.h"
 #include "dom_tree_node.h"
@@ -40,18 +40,20 @@ namespace clan
 // DomDocument_Impl construction:
 
 DomDocument_Impl::DomDocument_Impl()
+: string_block_pos(string_block_size), string_bytes_stored(0), string_bytes_dead(0), modification_count(0)
 {
+	find_atom(std::string());
+
 	node_index = DomDocument_Impl::allocate_tree_node();
 	nodes[node_index]->node_type = DomNode::DOCUMENT_NODE;
 }
 
 DomDocument_Impl::~DomDocument_Impl()
 {
-	std::vector<DomNode_Impl *>::size_type pos, size;
-
-	size = nodes.size();
-	for (pos = 0; pos < size; pos++)
-		delete nodes[pos];
+	for (std::vector<char *>::size_type i = 0; i < string_blocks.size(); i++)
+		delete[] string_blocks[i];
+	for (std::vector<char *>::size_type i = 0; i < large_string_blocks.size(); i++)
+		delete[] large_string_blocks[i];
 
 	while (!free_dom_nodes.empty())
 	{
@@ -72,44 +74,251 @@ DomDocument_Impl::~DomDocument_Impl()
 /////////////////////////////////////////////////////////////////////////////
 // DomDocument_Impl operations:
 
-DomString DomDocument_Impl::find_namespace_uri(
-	const DomString &qualified_name,
-	const XMLToken &search_token,
-	const DomNode &search_node)
+unsigned int DomDocument_Impl::find_atom(const std::string &str)
+{
+	std::unordered_map<std::string, unsigned int>::iterator it = atom_lookup.find(str);
+	if (it != atom_lookup.end())
+		return it->second;
+
+	it = atom_lookup.insert(std::make_pair(str, (unsigned int) atoms.size())).first;
+	atoms.push_back(&it->first);
+	return it->second;
+}
+
+unsigned int DomDocument_Impl::find_atom(const XMLStringView &str)
+{
+	str.to_string(decode_buffer);
+	return find_atom(decode_buffer);
+}
+
+bool DomDocument_Impl::find_existing_atom(const std::string &str, unsigned int &out_atom) const
+{
+	std::unordered_map<std::string, unsigned int>::const_iterator it = atom_lookup.find(str);
+	if (it == atom_lookup.end())
+		return false;
+	out_atom = it->second;
+	return true;
+}
+
+void DomDocument_Impl::set_node_value(DomTreeNode *tree_node, const char *data, std::string::size_type length)
+{
+	if (length <= tree_node->node_value_length)
+	{
+		// The new value fits where the old one was
+		string_bytes_dead += tree_node->node_value_length - length;
+		if (length > 0)
+			memmove(const_cast<char *>(tree_node->node_value), data, length);
+		else
+			tree_node->node_value = "";
+	}
+	else
+	{
+		string_bytes_dead += tree_node->node_value_length;
+		tree_node->node_value = store_string(data, length);
+	}
+	tree_node->node_value_length = length;
+
+	if (string_bytes_dead > string_block_size && string_bytes_dead > string_bytes_stored / 2)
+		compact_strings();
+}
+
+unsigned int DomDocument_Impl::find_namespace_uri(
+	const XMLStringView &qualified_name,
+	const XMLTokenView &search_token,
+	unsigned int search_node_index)
 {
 	static DomString xmlns_prefix("xmlns:");
-	DomString name = qualified_name;
+	static DomString xmlns_xml("xml");
+	static DomString xmlns_xmlns("xmlns");
+
+	const char *colon = (const char *) memchr(qualified_name.data, ':', qualified_name.length);
 	DomString prefix;
-	DomString::size_type pos = name.find(':');
-	if (pos != DomString::npos)
-		prefix = name.substr(0, pos);
+	if (colon)
+		prefix.assign(qualified_name.data, colon - qualified_name.data);
 
 	int size = (int) search_token.attributes.size();
 	for (int i=0; i<size; i++)
 	{
+		const XMLStringView &name = search_token.attributes[i].first;
 		if (prefix.empty())
 		{
-			if (search_token.attributes[i].first == "xmlns")
-				return search_token.attributes[i].second;
+			if (name.equals(xmlns_xmlns))
+				return find_atom(search_token.attributes[i].second);
 		}
 		else
 		{
-			if (search_token.attributes[i].first.substr(0, 6) == xmlns_prefix &&
-				search_token.attributes[i].first.substr(6) == prefix)
-				return search_token.attributes[i].second;
+			if (name.length == 6 + prefix.length() &&
+				memcmp(name.data, xmlns_prefix.data(), 6) == 0 &&
+				memcmp(name.data + 6, prefix.data(), prefix.length()) == 0)
+				return find_atom(search_token.attributes[i].second);
 		}
 	}
 
-	return search_node.find_namespace_uri(qualified_name);
+	// Same rules as DomNode::find_namespace_uri:
+	if (prefix == xmlns_xml)
+		return find_atom(xmlns_xml);
+	else if (prefix == xmlns_xmlns || qualified_name.equals(xmlns_xmlns))
+		return find_atom(xmlns_xmlns);
+
+	const DomTreeNode *cur = search_node_index != cl_null_node_index ? nodes[search_node_index] : 0;
+	while (cur)
+	{
+		const DomTreeNode *cur_attr = cur->get_first_attribute(this);
+		while (cur_attr)
+		{
+			const std::string &node_name = cur_attr->get_node_name(this);
+			if (prefix.empty())
+			{
+				if (node_name == xmlns_xmlns)
+					return find_atom(cur_attr->get_node_value(this));
+			}
+			else
+			{
+				if (node_name.length() == 6 + prefix.length() && node_name.compare(0, 6, xmlns_prefix) == 0 && node_name.compare(6, prefix.length(), prefix) == 0)
+					return find_atom(cur_attr->get_node_value(this));
+			}
+			cur_attr = cur_attr->get_next_sibling(this);
+		}
+		cur = cur->get_parent(this);
+	}
+	return 0;
+}
+
+unsigned int DomDocument_Impl::append_tree_node(unsigned int parent_index, unsigned short node_type)
+{
+	unsigned int index = allocate_tree_node();
+	DomTreeNode *tree_node = nodes[index];
+	DomTreeNode *parent = nodes[parent_index];
+	tree_node->node_type = node_type;
+	tree_node->parent = parent_index;
+	if (parent->last_child != cl_null_node_index)
+	{
+		nodes[parent->last_child]->next_sibling = index;
+		tree_node->previous_sibling = parent->last_child;
+	}
+	else
+	{
+		parent->first_child = index;
+	}
+	parent->last_child = index;
+	return index;
+}
+
+void DomDocument_Impl::set_tree_node_attribute(unsigned int element_index, unsigned int namespace_atom, unsigned int name_atom, const XMLStringView &value)
+{
+	// An attribute with the same namespace and local name is replaced, like DomNamedNodeMap::set_named_item_ns
+	const std::string &name = get_atom(name_atom);
+	std::string::size_type local_pos = name.find(':');
+	local_pos = (local_pos == std::string::npos) ? 0 : local_pos + 1;
+
+	DomTreeNode *element = nodes[element_index];
+	unsigned int last_index = cl_null_node_index;
+	unsigned int cur_index = element->first_attribute;
+	while (cur_index != cl_null_node_index)
+	{
+		DomTreeNode *cur_attribute = nodes[cur_index];
+		if (cur_attribute->namespace_atom == namespace_atom)
+		{
+			const std::string &cur_name = get_atom(cur_attribute->name_atom);
+			std::string::size_type cur_local_pos = cur_name.find(':');
+			cur_local_pos = (cur_local_pos == std::string::npos) ? 0 : cur_local_pos + 1;
+			if (cur_name.compare(cur_local_pos, std::string::npos, name, local_pos, std::string::npos) == 0)
+			{
+				cur_attribute->name_atom = name_atom;
+				set_tree_node_value(cur_index, value);
+				return;
+			}
+		}
+		last_index = cur_index;
+		cur_index = cur_attribute->next_sibling;
+	}
+
+	unsigned int index = allocate_tree_node();
+	DomTreeNode *attribute = nodes[index];
+	attribute->node_type = DomNode::ATTRIBUTE_NODE;
+	attribute->name_atom = name_atom;
+	attribute->namespace_atom = namespace_atom;
+	attribute->parent = element_index;
+	attribute->previous_sibling = last_index;
+	if (last_index == cl_null_node_index)
+		element->first_attribute = index;
+	else
+		nodes[last_index]->next_sibling = index;
+	set_tree_node_value(index, value);
+}
+
+void DomDocument_Impl::set_tree_node_value(unsigned int node_index, const XMLStringView &value)
+{
+	DomTreeNode *tree_node = nodes[node_index];
+	if (value.escaped)
+	{
+		value.to_string(decode_buffer);
+		set_node_value(tree_node, decode_buffer.data(), decode_buffer.length());
+	}
+	else
+	{
+		set_node_value(tree_node, value.data, value.length);
+	}
+}
+
+const DomElementIndex &DomDocument_Impl::get_element_index()
+{
+	if (element_index.built && element_index.modification_count == modification_count)
+		return element_index;
+
+	element_index.order.assign(nodes.size(), cl_null_node_index);
+	element_index.subtree_end.assign(nodes.size(), cl_null_node_index);
+	element_index.ordered_nodes.clear();
+	element_index.elements_by_name.resize(atoms.size());
+	for (std::vector<std::vector<unsigned int> >::size_type i = 0; i < element_index.elements_by_name.size(); i++)
+		element_index.elements_by_name[i].clear();
+
+	unsigned int position = 0;
+	unsigned int cur_index = node_index;
+	while (cur_index != cl_null_node_index)
+	{
+		const DomTreeNode *cur = nodes[cur_index];
+		element_index.order[cur_index] = position;
+		element_index.ordered_nodes.push_back(cur_index);
+		if (cur->node_type == DomNode::ELEMENT_NODE)
+			element_index.elements_by_name[cur->name_atom].push_back(position);
+		position++;
+
+		if (cur->first_child != cl_null_node_index)
+		{
+			cur_index = cur->first_child;
+			continue;
+		}
+
+		// Leave the subtrees that ended with this node:
+		while (cur_index != cl_null_node_index)
+		{
+			cur = nodes[cur_index];
+			element_index.subtree_end[cur_index] = position;
+			if (cur_index == node_index)
+				cur_index = cl_null_node_index;
+			else if (cur->next_sibling != cl_null_node_index)
+				break;
+			else
+				cur_index = cur->parent;
+		}
+		if (cur_index != cl_null_node_index)
+			cur_index = cur->next_sibling;
+	}
+
+	element_index.built = true;
+	element_index.modification_count = modification_count;
+	return element_index;
 }
 
 unsigned int DomDocument_Impl::allocate_tree_node()
 {
+	modification_count++;
 	if (free_nodes.empty())
 	{
-		DomTreeNode *node = new (&node_allocator) DomTreeNode();
-		nodes.push_back(node);
-		return nodes.size() - 1;
+		unsigned int index = nodes.allocate();
+		nodes[index]->reset();
+		return index;
 	}
 	else
 	{
@@ -122,6 +331,11 @@ unsigned int DomDocument_Impl::allocate_tree_node()
 
 void DomDocument_Impl::free_tree_node(unsigned int node_index)
 {
+	modification_count++;
+	DomTreeNode *tree_node = nodes[node_index];
+	string_bytes_dead += tree_node->node_value_length;
+	tree_node->node_value = 0;
+	tree_node->node_value_length = 0;
 	free_nodes.push_back(node_index);
 }
 
@@ -179,4 +393,72 @@ void DomDocument_Impl::free_named_node_map(DomNamedNodeMap_Impl *map)
 /////////////////////////////////////////////////////////////////////////////
 // DomDocument_Impl implementation:
 
+const char *DomDocument_Impl::store_string(const char *data, std::string::size_type length)
+{
+	if (length == 0)
+		return "";
+
+	char *dest = 0;
+	if (length > string_block_size / 4)
+	{
+		// Large strings get a block of their own, so the current block keeps filling up
+		dest = new char[length];
+		large_string_blocks.push_back(dest);
+	}
+	else
+	{
+		if (string_block_pos + length > string_block_size)
+		{
+			string_blocks.push_back(new char[string_block_size]);
+			string_block_pos = 0;
+		}
+		dest = string_blocks.back() + string_block_pos;
+		string_block_pos += length;
+	}
+
+	memcpy(dest, data, length);
+	string_bytes_stored += length;
+	return dest;
+}
+
+void DomDocument_Impl::compact_strings()
+{
+	std::vector<char *> old_blocks;
+	std::vector<char *> old_large_blocks;
+	old_blocks.swap(string_blocks);
+	old_large_blocks.swap(large_string_blocks);
+	string_block_pos = string_block_size;
+	string_bytes_stored = 0;
+	string_bytes_dead = 0;
+
+	// Copy the values still referenced into fresh blocks
+	for (unsigned int i = 0; i < nodes.size(); i++)
+	{
+		DomTreeNode *tree_node = nodes[i];
+		if (tree_node->node_value_length > 0)
+			tree_node->node_value = store_string(tree_node->node_value, tree_node->node_value_length);
+	}
+
+	for (std::vector<char *>::size_type i = 0; i < old_blocks.size(); i++)
+		delete[] old_blocks[i];
+	for (std::vector<char *>::size_type i = 0; i < old_large_blocks.size(); i++)
+		delete[] old_large_blocks[i];
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// DomTreeNodeArray:
+
+DomTreeNodeArray::~DomTreeNodeArray()
+{
+	for (std::vector<DomTreeNode *>::size_type i = 0; i < pages.size(); i++)
+		delete[] pages[i];
+}
+
+unsigned int DomTreeNodeArray::allocate()
+{
+	if ((count & (page_size - 1)) == 0)
+		pages.push_back(new DomTreeNode[page_size]);
+	return count++;
+}
+
 }
@@ -30,16 +30,61 @@
 
 #include "dom_node_generic.h"
 #include "API/Core/System/block_allocator.h"
+#include "API/Core/XML/dom_string.h"
 #include <vector>
 #include <stack>
+#include <unordered_map>
 
 namespace clan
 {
 
 class DomTreeNode;
-class XMLToken;
+class XMLTokenView;
+class XMLStringView;
 class DomNamedNodeMap_Impl;
 
+// Tree node records are allocated in pages, so their addresses never change
+class DomTreeNodeArray
+{
+public:
+	DomTreeNodeArray() : count(0) { }
+	~DomTreeNodeArray();
+
+	unsigned int size() const { return count; }
+	DomTreeNode *operator[](unsigned int index) const;
+	unsigned int allocate();
+
+private:
+	DomTreeNodeArray(const DomTreeNodeArray &);
+	DomTreeNodeArray &operator=(const DomTreeNodeArray &);
+
+	enum { page_shift = 12, page_size = 1 << page_shift };
+	std::vector<DomTreeNode *> pages;
+	unsigned int count;
+};
+
+// Elements grouped by name in document order. Used by XPath name tests
+class DomElementIndex
+{
+public:
+	DomElementIndex() : built(false), modification_count(0) { }
+
+	bool built;
+	unsigned int modification_count;
+
+	// Document order position of each tree node, or cl_null_node_index if the node is not in the tree
+	std::vector<unsigned int> order;
+
+	// Document order position following the last descendant of each tree node
+	std::vector<unsigned int> subtree_end;
+
+	// Tree node index at each document order position
+	std::vector<unsigned int> ordered_nodes;
+
+	// Document order positions of the elements using each name atom
+	std::vector<std::vector<unsigned int> > elements_by_name;
+};
+
 class DomDocument_Impl : public DomNode_Impl
 {
 /// \name Construction
@@ -60,8 +105,26 @@ public:
 	std::string system_id;
 	std::string internal_subset;
 	BlockAllocator node_allocator;
-	std::vector<DomTreeNode *> nodes;
+	DomTreeNodeArray nodes;
 	std::vector<int> free_nodes;
+
+	// Element, attribute and namespace names, stored once per document
+	std::vector<const std::string *> atoms;
+	std::unordered_map<std::string, unsigned int> atom_lookup;
+
+	// Node values. Strings longer than a quarter block get a block of their own in large_string_blocks.
+	// Bytes of replaced values are counted as dead and reclaimed by compact_strings()
+	std::vector<char *> string_blocks;
+	std::vector<char *> large_string_blocks;
+	std::string::size_type string_block_pos;
+	std::string::size_type string_bytes_stored;
+	std::string::size_type string_bytes_dead;
+
+	const std::string &get_atom(unsigned int atom) const { return *atoms[atom]; }
+
+	// Incremented whenever tree nodes are allocated, renamed or relinked
+	unsigned int modification_count;
+
 	std::vector<DomNode_Impl *> free_dom_nodes;
 	std::vector<DomNamedNodeMap_Impl *> free_named_node_maps;
 
@@ -70,10 +133,21 @@ public:
 /// \{
 
 public:
-	static DomString find_namespace_uri(
-		const DomString &qualified_name,
-		const XMLToken &search_token,
-		const DomNode &search_node);
+	unsigned int find_atom(const std::string &str);
+	unsigned int find_atom(const XMLStringView &str);
+	bool find_existing_atom(const std::string &str, unsigned int &out_atom) const;
+	void set_node_value(DomTreeNode *tree_node, const char *data, std::string::size_type length);
+
+	unsigned int find_namespace_uri(
+		const XMLStringView &qualified_name,
+		const XMLTokenView &search_token,
+		unsigned int search_node_index);
+
+	unsigned int append_tree_node(unsigned int parent_index, unsigned short node_type);
+	void set_tree_node_attribute(unsigned int element_index, unsigned int namespace_atom, unsigned int name_atom, const XMLStringView &value);
+	void set_tree_node_value(unsigned int node_index, const XMLStringView &value);
+
+	const DomElementIndex &get_element_index();
 
 	unsigned int allocate_tree_node();
 	void free_tree_node(unsigned int node_index);
@@ -99,6 +173,18 @@ public:
 	};
 
 /// \}
+/// \name Implementation
+/// \{
+
+private:
+	static const std::string::size_type string_block_size = 64*1024;
+
+	const char *store_string(const char *data, std::string::size_type length);
+	void compact_strings();
+
+	std::string decode_buffer;
+	DomElementIndex element_index;
+/// \}
 };
 
 }
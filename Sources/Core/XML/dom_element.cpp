@@ -87,7 +87,7 @@ bool DomElement::has_attribute(const DomString &name) const
 		const DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 		while (cur_attribute)
 		{
-			if (cur_attribute->get_node_name() == name)
+			if (cur_attribute->get_node_name(doc_impl) == name)
 				return true;
 
 			cur_index = cur_attribute->next_sibling;
@@ -120,8 +120,8 @@ DomString DomElement::get_attribute(const DomString &name) const
 		const DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 		while (cur_attribute)
 		{
-			if (cur_attribute->get_node_name() == name)
-				return cur_attribute->get_node_value();
+			if (cur_attribute->get_node_name(doc_impl) == name)
+				return cur_attribute->get_node_value(doc_impl);
 
 			cur_index = cur_attribute->next_sibling;
 			cur_attribute = cur_attribute->get_next_sibling(doc_impl);
@@ -141,8 +141,8 @@ DomString DomElement::get_attribute(const DomString &name, const DomString &defa
 		const DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 		while (cur_attribute)
 		{
-			if (cur_attribute->get_node_name() == name)
-				return cur_attribute->get_node_value();
+			if (cur_attribute->get_node_name(doc_impl) == name)
+				return cur_attribute->get_node_value(doc_impl);
 
 			cur_index = cur_attribute->next_sibling;
 			cur_attribute = cur_attribute->get_next_sibling(doc_impl);
@@ -164,13 +164,13 @@ DomString DomElement::get_attribute_ns(
 		const DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 		while (cur_attribute)
 		{
-			std::string lname = cur_attribute->get_node_name();
+			std::string lname = cur_attribute->get_node_name(doc_impl);
 			std::string::size_type lpos = lname.find_first_of(':');
 			if (lpos != std::string::npos)
 				lname = lname.substr(lpos + 1);
 
-			if (cur_attribute->get_namespace_uri() == namespace_uri && lname == local_name)
-				return cur_attribute->get_node_value();
+			if (cur_attribute->get_namespace_uri(doc_impl) == namespace_uri && lname == local_name)
+				return cur_attribute->get_node_value(doc_impl);
 
 			cur_index = cur_attribute->next_sibling;
 			cur_attribute = cur_attribute->get_next_sibling(doc_impl);
@@ -193,13 +193,13 @@ DomString DomElement::get_attribute_ns(
 		const DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 		while (cur_attribute)
 		{
-			std::string lname = cur_attribute->get_node_name();
+			std::string lname = cur_attribute->get_node_name(doc_impl);
 			std::string::size_type lpos = lname.find_first_of(':');
 			if (lpos != std::string::npos)
 				lname = lname.substr(lpos + 1);
 
-			if (cur_attribute->get_namespace_uri() == namespace_uri && lname == local_name)
-				return cur_attribute->get_node_value();
+			if (cur_attribute->get_namespace_uri(doc_impl) == namespace_uri && lname == local_name)
+				return cur_attribute->get_node_value(doc_impl);
 
 			cur_index = cur_attribute->next_sibling;
 			cur_attribute = cur_attribute->get_next_sibling(doc_impl);
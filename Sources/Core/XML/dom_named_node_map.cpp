@@ -91,7 +91,7 @@ DomNode DomNamedNodeMap::get_named_item(const DomString &name) const
 	const DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 	while (cur_attribute)
 	{
-		if (cur_attribute->get_node_name() == name)
+		if (cur_attribute->get_node_name(doc_impl) == name)
 		{
 			DomNode_Impl *dom_node = doc_impl->allocate_dom_node();
 			dom_node->node_index = cur_index;
@@ -115,12 +115,12 @@ DomNode DomNamedNodeMap::get_named_item_ns(
 	const DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 	while (cur_attribute)
 	{
-		std::string lname = cur_attribute->get_node_name();
+		std::string lname = cur_attribute->get_node_name(doc_impl);
 		std::string::size_type lpos = lname.find_first_of(':');
 		if (lpos != std::string::npos)
 			lname = lname.substr(lpos + 1);
 
-		if (cur_attribute->get_namespace_uri() == namespace_uri && lname == local_name)
+		if (cur_attribute->get_namespace_uri(doc_impl) == namespace_uri && lname == local_name)
 		{
 			DomNode_Impl *dom_node = doc_impl->allocate_dom_node();
 			dom_node->node_index = cur_index;
@@ -147,7 +147,7 @@ DomNode DomNamedNodeMap::set_named_item(const DomNode &node)
 	DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 	while (cur_attribute)
 	{
-		if (cur_attribute->get_node_name() == name)
+		if (cur_attribute->get_node_name(doc_impl) == name)
 		{
 			new_tree_node->parent = cur_attribute->parent;
 			new_tree_node->previous_sibling = cur_attribute->previous_sibling;
@@ -200,12 +200,12 @@ DomNode DomNamedNodeMap::set_named_item_ns(const DomNode &node)
 	DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 	while (cur_attribute)
 	{
-		std::string lname = cur_attribute->get_node_name();
+		std::string lname = cur_attribute->get_node_name(doc_impl);
 		std::string::size_type lpos = lname.find_first_of(':');
 		if (lpos != std::string::npos)
 			lname = lname.substr(lpos + 1);
 
-		if (cur_attribute->get_namespace_uri() == namespace_uri && lname == local_name)
+		if (cur_attribute->get_namespace_uri(doc_impl) == namespace_uri && lname == local_name)
 		{
 			new_tree_node->parent = cur_attribute->parent;
 			new_tree_node->previous_sibling = cur_attribute->previous_sibling;
@@ -253,7 +253,7 @@ DomNode DomNamedNodeMap::remove_named_item(const DomString &name)
 	DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 	while (cur_attribute)
 	{
-		if (cur_attribute->get_node_name() == name)
+		if (cur_attribute->get_node_name(doc_impl) == name)
 		{
 			if (cur_attribute->previous_sibling == cl_null_node_index)
 				tree_node->first_attribute = cur_attribute->next_sibling;
@@ -290,12 +290,12 @@ DomNode DomNamedNodeMap::remove_named_item_ns(
 	DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 	while (cur_attribute)
 	{
-		std::string lname = cur_attribute->get_node_name();
+		std::string lname = cur_attribute->get_node_name(doc_impl);
 		std::string::size_type lpos = lname.find_first_of(':');
 		if (lpos != std::string::npos)
 			lname = lname.substr(lpos + 1);
 
-		if (cur_attribute->get_namespace_uri() == namespace_uri && lname == local_name)
+		if (cur_attribute->get_namespace_uri(doc_impl) == namespace_uri && lname == local_name)
 		{
 			if (cur_attribute->previous_sibling == cl_null_node_index)
 				tree_node->first_attribute = cur_attribute->next_sibling;
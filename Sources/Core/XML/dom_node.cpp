@@ -91,6 +91,7 @@ DomString DomNode::get_node_name() const
 {
 	if (impl)
 	{
+		DomDocument_Impl *doc_impl = (DomDocument_Impl *) impl->owner_document.lock().get();
 		const DomTreeNode *tree_node = impl->get_tree_node();
 		switch (tree_node->node_type)
 		{
@@ -112,7 +113,7 @@ DomString DomNode::get_node_name() const
 		case NOTATION_NODE:
 		case PROCESSING_INSTRUCTION_NODE:
 		default:
-			return tree_node->get_node_name();
+			return tree_node->get_node_name(doc_impl);
 		}
 	}
 	return DomString();
@@ -122,6 +123,7 @@ DomString DomNode::get_node_value() const
 {
 	if (impl)
 	{
+		DomDocument_Impl *doc_impl = (DomDocument_Impl *) impl->owner_document.lock().get();
 		const DomTreeNode *tree_node = impl->get_tree_node();
 		switch (tree_node->node_type)
 		{
@@ -138,7 +140,7 @@ DomString DomNode::get_node_value() const
 		case ATTRIBUTE_NODE:
 		case PROCESSING_INSTRUCTION_NODE:
 		default:
-			return tree_node->get_node_value();
+			return tree_node->get_node_value(doc_impl);
 		}
 	}
 	return DomString();
@@ -147,7 +149,10 @@ DomString DomNode::get_node_value() const
 DomString DomNode::get_namespace_uri() const
 {
 	if (impl)
-		return impl->get_tree_node()->get_namespace_uri();
+	{
+		DomDocument_Impl *doc_impl = (DomDocument_Impl *) impl->owner_document.lock().get();
+		return impl->get_tree_node()->get_namespace_uri(doc_impl);
+	}
 	return DomString();
 }
 
@@ -155,7 +160,8 @@ DomString DomNode::get_prefix() const
 {
 	if (impl)
 	{
-		DomString node_name = impl->get_tree_node()->get_node_name();
+		DomDocument_Impl *doc_impl = (DomDocument_Impl *) impl->owner_document.lock().get();
+		DomString node_name = impl->get_tree_node()->get_node_name(doc_impl);
 		DomString::size_type pos = node_name.find(':');
 		if (pos != DomString::npos)
 			return node_name.substr(0, pos);
@@ -168,7 +174,7 @@ void DomNode::set_prefix(const DomString &prefix)
 	if (impl)
 	{
 		DomDocument_Impl *doc_impl = (DomDocument_Impl *) impl->owner_document.lock().get();
-		DomString node_name = impl->get_tree_node()->get_node_name();
+		DomString node_name = impl->get_tree_node()->get_node_name(doc_impl);
 		DomString::size_type pos = node_name.find(':');
 		if (pos == DomString::npos)
 			impl->get_tree_node()->set_node_name(doc_impl, prefix + ':' + node_name);
@@ -181,7 +187,8 @@ DomString DomNode::get_local_name() const
 {
 	if (impl)
 	{
-		DomString node_name = impl->get_tree_node()->get_node_name();
+		DomDocument_Impl *doc_impl = (DomDocument_Impl *) impl->owner_document.lock().get();
+		DomString node_name = impl->get_tree_node()->get_node_name(doc_impl);
 		DomString::size_type pos = node_name.find(':');
 		if (pos != DomString::npos)
 			return node_name.substr(pos + 1);
@@ -449,6 +456,7 @@ DomNode DomNode::insert_before(DomNode &new_child, DomNode &ref_child)
 		DomTreeNode *tree_node = impl->get_tree_node();
 		DomTreeNode *new_tree_node = new_child.impl->get_tree_node();
 		DomTreeNode *ref_tree_node = ref_child.impl->get_tree_node();
+		doc_impl->modification_count++;
 
 		new_tree_node->previous_sibling = ref_tree_node->previous_sibling;
 		new_tree_node->next_sibling = ref_child.impl->node_index;
@@ -468,9 +476,11 @@ DomNode DomNode::replace_child(DomNode &new_child, DomNode &old_child)
 {
 	if (impl && new_child.impl && old_child.impl)
 	{
+		DomDocument_Impl *doc_impl = (DomDocument_Impl *) impl->owner_document.lock().get();
 		DomTreeNode *tree_node = impl->get_tree_node();
 		DomTreeNode *new_tree_node = new_child.impl->get_tree_node();
 		DomTreeNode *old_tree_node = old_child.impl->get_tree_node();
+		doc_impl->modification_count++;
 
 		new_tree_node->previous_sibling = old_tree_node->previous_sibling;
 		new_tree_node->next_sibling = old_tree_node->next_sibling;
@@ -495,6 +505,7 @@ DomNode DomNode::remove_child(DomNode &old_child)
 		DomDocument_Impl *doc_impl = (DomDocument_Impl *) impl->owner_document.lock().get();
 		DomTreeNode *tree_node = impl->get_tree_node();
 		DomTreeNode *old_tree_node = old_child.impl->get_tree_node();
+		doc_impl->modification_count++;
 		unsigned int prev_index = old_tree_node->previous_sibling;
 		unsigned int next_index = old_tree_node->next_sibling;
 		DomTreeNode *prev = old_tree_node->get_previous_sibling(doc_impl);
@@ -521,6 +532,7 @@ DomNode DomNode::append_child(DomNode new_child)
 		DomDocument_Impl *doc_impl = (DomDocument_Impl *) impl->owner_document.lock().get();
 		DomTreeNode *tree_node = impl->get_tree_node();
 		DomTreeNode *new_tree_node = new_child.impl->get_tree_node();
+		doc_impl->modification_count++;
 		if (tree_node->last_child != cl_null_node_index)
 		{
 			DomTreeNode *last_tree_node = tree_node->get_last_child(doc_impl);
@@ -678,16 +690,16 @@ DomString DomNode::find_namespace_uri(const DomString &qualified_name) const
 		const DomTreeNode *cur_attr = cur->get_first_attribute(doc_impl);
 		while (cur_attr)
 		{
-			std::string node_name = cur_attr->get_node_name();
+			std::string node_name = cur_attr->get_node_name(doc_impl);
 			if (prefix.empty())
 			{
 				if (node_name == xmlns_xmlns)
-					return cur_attr->get_node_value();
+					return cur_attr->get_node_value(doc_impl);
 			}
 			else
 			{
 				if (node_name.substr(0, 6) == xmlns_prefix && node_name.substr(6) == prefix)
-					return cur_attr->get_node_value();
+					return cur_attr->get_node_value(doc_impl);
 			}
 			cur_attr = cur_attr->get_next_sibling(doc_impl);
 		}
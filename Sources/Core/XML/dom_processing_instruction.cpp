@@ -64,7 +64,10 @@ DomProcessingInstruction::~DomProcessingInstruction()
 DomString DomProcessingInstruction::get_target() const
 {
 	if (impl)
-		return impl->get_tree_node()->get_node_name();
+	{
+		DomDocument_Impl *doc_impl = (DomDocument_Impl *) impl->owner_document.lock().get();
+		return impl->get_tree_node()->get_node_name(doc_impl);
+	}
 	else
 		return DomString();
 }
@@ -72,7 +75,10 @@ DomString DomProcessingInstruction::get_target() const
 DomString DomProcessingInstruction::get_data() const
 {
 	if (impl)
-		return impl->get_tree_node()->get_node_value();
+	{
+		DomDocument_Impl *doc_impl = (DomDocument_Impl *) impl->owner_document.lock().get();
+		return impl->get_tree_node()->get_node_value(doc_impl);
+	}
 	else
 		return DomString();
 }
@@ -28,7 +28,6 @@
 
 #pragma once
 
-#include "API/Core/System/block_allocator.h"
 #include "dom_document_generic.h"
 
 namespace clan
@@ -38,29 +37,17 @@ namespace clan
 
 class DomDocument_Impl;
 
-class DomTreeNode : public BlockAllocated
+// Fixed-size node record. Names are atoms in the owner document and values
+// point into its string arena, so the record itself owns no memory.
+class DomTreeNode
 {
-/// \name Construction
-/// \{
-public:
-	DomTreeNode()
-	: node_type(0), parent(cl_null_node_index), first_child(cl_null_node_index),
-	  last_child(cl_null_node_index), previous_sibling(cl_null_node_index),
-	  next_sibling(cl_null_node_index), first_attribute(cl_null_node_index)
-	{
-	}
-
-	virtual ~DomTreeNode()
-	{
-	}
-/// \}
-
 /// \name Attributes
 /// \{
 public:
-	std::string node_name;
-	std::string node_value;
-	std::string namespace_uri;
+	unsigned int name_atom;
+	unsigned int namespace_atom;
+	const char *node_value;
+	unsigned int node_value_length;
 	unsigned short node_type;
 	unsigned int parent;
 	unsigned int first_child;
@@ -75,9 +62,10 @@ public:
 public:
 	void reset()
 	{
-		node_name.clear();
-		node_value.clear();
-		namespace_uri.clear();
+		name_atom = 0;
+		namespace_atom = 0;
+		node_value = 0;
+		node_value_length = 0;
 		node_type = 0;
 		parent = cl_null_node_index;
 		first_child = cl_null_node_index;
@@ -87,34 +75,35 @@ public:
 		first_attribute = cl_null_node_index;
 	}
 
-	std::string get_node_name() const
+	const std::string &get_node_name(const DomDocument_Impl *owner_document) const
 	{
-		return node_name;
+		return owner_document->get_atom(name_atom);
 	}
 
-	std::string get_node_value() const
+	std::string get_node_value(const DomDocument_Impl *owner_document) const
 	{
-		return node_value;
+		return std::string(node_value, node_value_length);
 	}
 
-	std::string get_namespace_uri() const
+	const std::string &get_namespace_uri(const DomDocument_Impl *owner_document) const
 	{
-		return namespace_uri;
+		return owner_document->get_atom(namespace_atom);
 	}
 
 	void set_node_name(DomDocument_Impl *owner_document, const DomString &str)
 	{
-		node_name = str;
+		name_atom = owner_document->find_atom(str);
+		owner_document->modification_count++;
 	}
 
 	void set_node_value(DomDocument_Impl *owner_document, const DomString &str)
 	{
-		node_value = str;
+		owner_document->set_node_value(this, str.data(), str.length());
 	}
 
 	void set_namespace_uri(DomDocument_Impl *owner_document, const DomString &str)
 	{
-		namespace_uri = str;
+		namespace_atom = owner_document->find_atom(str);
 	}
 
 	DomTreeNode *get_parent(DomDocument_Impl *owner_document)
@@ -184,4 +173,9 @@ private:
 /// \}
 };
 
+inline DomTreeNode *DomTreeNodeArray::operator[](unsigned int index) const
+{
+	return pages[index >> page_shift] + (index & (page_size - 1));
+}
+
 }
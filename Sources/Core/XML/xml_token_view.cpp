@@ -0,0 +1,82 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/XML/xml_token_view.h"
+#include "xml_tokenizer_generic.h"
+#include <cstring>
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// XMLStringView Attributes:
+
+bool XMLStringView::equals(const char *str) const
+{
+	std::string::size_type str_length = strlen(str);
+	return str_length == length && (length == 0 || memcmp(data, str, length) == 0);
+}
+
+std::string XMLStringView::to_string() const
+{
+	std::string text;
+	to_string(text);
+	return text;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// XMLStringView Operations:
+
+void XMLStringView::to_string(std::string &out_text) const
+{
+	if (escaped)
+		XMLTokenizer_Impl::unescape(out_text, data, length);
+	else
+		out_text.assign(data, length);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// XMLTokenView Operations:
+
+void XMLTokenView::to_token(XMLToken &out_token) const
+{
+	out_token.type = type;
+	out_token.variant = variant;
+	name.to_string(out_token.name);
+	value.to_string(out_token.value);
+
+	out_token.attributes.resize(attributes.size());
+	for (std::vector<Attribute>::size_type i = 0; i < attributes.size(); i++)
+	{
+		attributes[i].first.to_string(out_token.attributes[i].first);
+		attributes[i].second.to_string(out_token.attributes[i].second);
+	}
+}
+
+}
@@ -29,12 +29,12 @@
 #include "Core/precomp.h"
 #include "API/Core/XML/xml_tokenizer.h"
 #include "API/Core/XML/xml_token.h"
-#include "API/Core/System/databuffer.h"
+#include "API/Core/XML/xml_token_view.h"
 #include "API/Core/Text/string_format.h"
 #include "API/Core/Text/string_help.h"
 #include "xml_tokenizer_generic.h"
 #include <algorithm>
-#include <utility>
+#include <cstring>
 
 namespace clan
 {
@@ -50,35 +50,12 @@ XMLTokenizer::XMLTokenizer(const XMLTokenizer &copy) : impl(copy.impl)
 {
 }
 
-XMLTokenizer::XMLTokenizer(IODevice &input) : impl(new XMLTokenizer_Impl)
+XMLTokenizer::XMLTokenizer(IODevice &input) : impl(new XMLTokenizer_Impl(input, 64*1024))
 {
-	impl->input = input;
-	impl->size = input.get_size();
-	impl->pos = 0;
-
-	DataBuffer buffer(impl->size);
-	input.receive(buffer.get_data(), buffer.get_size(), true);
-
-	StringHelp::BOMType bom_type = StringHelp::detect_bom(buffer.get_data(), buffer.get_size());
-	switch (bom_type)
-	{
-	default:
-	case StringHelp::bom_none:
-		impl->data = StringHelp::utf8_to_text(std::string(buffer.get_data(), buffer.get_size()));
-		break;
-	case StringHelp::bom_utf32_be:
-	case StringHelp::bom_utf32_le:
-		throw Exception("UTF-16 XML files not supported yet");
-		break;
-	case StringHelp::bom_utf16_be:
-	case StringHelp::bom_utf16_le:
-		throw Exception("UTF-32 XML files not supported yet");
-		break;
-	case StringHelp::bom_utf8:
-		impl->data = StringHelp::utf8_to_text(std::string(buffer.get_data()+3, buffer.get_size()-3));
-		break;
-	}
+}
 
+XMLTokenizer::XMLTokenizer(IODevice &input, int buffer_size) : impl(new XMLTokenizer_Impl(input, buffer_size))
+{
 }
 
 XMLTokenizer::~XMLTokenizer()
@@ -102,19 +79,30 @@ void XMLTokenizer::set_eat_whitespace(bool enable)
 // XMLTokenizer operations:
 
 void XMLTokenizer::next(XMLToken *out_token)
+{
+	if (impl)
+	{
+		impl->next(&impl->compat_token);
+		impl->compat_token.to_token(*out_token);
+	}
+	else
+	{
+		out_token->type = XMLToken::NULL_TOKEN;
+		out_token->variant = XMLToken::SINGLE;
+		out_token->attributes.clear();
+	}
+}
+
+void XMLTokenizer::next(XMLTokenView *out_token)
 {
 	out_token->type = XMLToken::NULL_TOKEN;
 	out_token->variant = XMLToken::SINGLE;
-//	out_token->attributes.clear();
-	while (!out_token->attributes.empty())
-		out_token->attributes.pop_back();
+	out_token->name = XMLStringView();
+	out_token->value = XMLStringView();
+	out_token->attributes.clear();
 
 	if (impl)
-	{
-		if (impl->next_text_node(out_token))
-			return;
-		impl->next_tag_node(out_token);
-	}
+		impl->next(out_token);
 }
 
 XMLToken XMLTokenizer::next()
@@ -127,18 +115,131 @@ XMLToken XMLTokenizer::next()
 /////////////////////////////////////////////////////////////////////////////
 // XMLTokenizer implementation:
 
-bool XMLTokenizer_Impl::next_text_node(XMLToken *out_token)
+// Character classes used when scanning tags, indexed by character:
+//   char_whitespace: " \r\n\t"
+//   char_name_end: whitespace and "?/>"
+//   char_attribute_name_end: whitespace and "="
+//   char_value_end: whitespace and ">"
+//   char_markup: quotes, "[", "]" and ">"
+const unsigned char XMLTokenizer_Impl::char_classes[256] =
 {
-	while (pos < size && data[pos] != '<')
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 15, 15, 0, 0, 15, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	15, 0, 16, 0, 0, 0, 0, 16, 0, 0, 0, 0, 0, 0, 0, 2,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 26, 2,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 0, 16, 0, 0
+};
+
+XMLTokenizer_Impl::XMLTokenizer_Impl(IODevice &input, int buffer_size)
+: input(input), pos(0), size(0), end_of_input(false), bom_checked(false), eat_whitespace(true), discarded_lines(0)
+{
+	buffer.resize(std::max(buffer_size, 16));
+}
+
+void XMLTokenizer_Impl::next(XMLTokenView *out_token)
+{
+	out_token->type = XMLToken::NULL_TOKEN;
+	out_token->variant = XMLToken::SINGLE;
+	out_token->name = XMLStringView();
+	out_token->value = XMLStringView();
+	out_token->attributes.clear();
+
+	if (!bom_checked)
+		check_bom();
+
+	if (next_text_node(out_token))
+		return;
+	next_tag_node(out_token);
+}
+
+bool XMLTokenizer_Impl::fill()
+{
+	if (end_of_input)
+		return false;
+
+	// Discard everything already consumed:
+	if (pos > 0)
 	{
-		std::string::size_type start_pos = pos;
-		std::string::size_type end_pos = data.find('<', start_pos);
-		if (end_pos == data.npos) end_pos = size;
-		pos = end_pos;
+		discarded_lines += std::count(buffer.begin(), buffer.begin() + pos, '\n');
+		if (size > pos)
+			memmove(&buffer[0], &buffer[pos], size - pos);
+		size -= pos;
+		pos = 0;
+	}
+
+	// The current token does not fit in the buffer:
+	if (size == buffer.size())
+		buffer.resize(buffer.size() * 2);
+
+	int received = input.receive(&buffer[size], (int) (buffer.size() - size), true);
+	if (received <= 0)
+	{
+		end_of_input = true;
+		return false;
+	}
+	size += received;
+	return true;
+}
+
+bool XMLTokenizer_Impl::require(std::string::size_type length)
+{
+	while (size - pos < length)
+	{
+		if (!fill())
+			return false;
+	}
+	return true;
+}
+
+void XMLTokenizer_Impl::check_bom()
+{
+	bom_checked = true;
+	require(4);
+
+	StringHelp::BOMType bom_type = StringHelp::detect_bom(&buffer[pos], size - pos);
+	switch (bom_type)
+	{
+	default:
+	case StringHelp::bom_none:
+		break;
+	case StringHelp::bom_utf32_be:
+	case StringHelp::bom_utf32_le:
+		throw Exception("UTF-16 XML files not supported yet");
+		break;
+	case StringHelp::bom_utf16_be:
+	case StringHelp::bom_utf16_le:
+		throw Exception("UTF-32 XML files not supported yet");
+		break;
+	case StringHelp::bom_utf8:
+		pos += 3;
+		break;
+	}
+}
 
-		std::string text;
-		std::string text_orig = data.substr(start_pos, end_pos-start_pos);
-		unescape(text, text_orig);
+bool XMLTokenizer_Impl::next_text_node(XMLTokenView *out_token)
+{
+	while (true)
+	{
+		if (pos == size && !fill())
+			return false;
+		if (buffer[pos] == '<')
+			return false;
+
+		std::string::size_type end_pos = find('<', pos, size);
+		while (end_pos == std::string::npos)
+		{
+			std::string::size_type scanned = size - pos;
+			if (!fill())
+			{
+				end_pos = size;
+				break;
+			}
+			end_pos = find('<', pos + scanned, size);
+		}
+
+		XMLStringView text = make_view(pos, end_pos, true);
+		pos = end_pos;
 		if (eat_whitespace)
 		{
 			text = trim_whitespace(text);
@@ -150,58 +251,135 @@ bool XMLTokenizer_Impl::next_text_node(XMLToken *out_token)
 		out_token->value = text;
 		return true;
 	}
-	return false;
 }
 
-bool XMLTokenizer_Impl::next_tag_node(XMLToken *out_token)
+bool XMLTokenizer_Impl::next_tag_node(XMLTokenView *out_token)
 {
-	if (pos == size || data[pos] != '<')
+	if (pos == size || buffer[pos] != '<')
 		return false;
 
+	// Make sure the whole tag is in the buffer before parsing it:
+	std::string::size_type end = find_markup_end(pos);
+	parse_tag(out_token, end);
+	return true;
+}
+
+std::string::size_type XMLTokenizer_Impl::find_markup_end(std::string::size_type start)
+{
+	std::string::size_type offset = start - pos;
+	require(offset + 9);
+
+	const char *terminator = 0;
+	bool doctype = false;
+	if (compare(pos + offset, size, "<!--"))
+		terminator = "-->";
+	else if (compare(pos + offset, size, "<![CDATA["))
+		terminator = "]]>";
+	else if (compare(pos + offset, size, "<?"))
+		terminator = "?>";
+	else if (compare(pos + offset, size, "<!DOCTYPE"))
+		doctype = true;
+
+	// Scan state is kept as offsets from pos, since refilling the buffer moves the data:
+	std::string::size_type scan_offset = offset + 1;
+	char quote = 0;
+	int subset_depth = 0;
+	while (true)
+	{
+		if (terminator)
+		{
+			std::string::size_type terminator_length = strlen(terminator);
+			std::string::size_type match = find(terminator, pos + scan_offset, size);
+			if (match != std::string::npos)
+				return match + terminator_length;
+
+			// The terminator might be split between this and the next read:
+			scan_offset = std::max(scan_offset, size - pos - std::min(size - pos, terminator_length - 1));
+		}
+		else
+		{
+			for (std::string::size_type i = pos + scan_offset; i < size; i++)
+			{
+				char c = buffer[i];
+				if (!quote && !(char_classes[(unsigned char) c] & char_markup))
+					continue;
+
+				if (quote)
+				{
+					if (c == quote)
+						quote = 0;
+				}
+				else if (c == '"' || c == '\'')
+				{
+					quote = c;
+				}
+				else if (doctype && c == '[')
+				{
+					subset_depth++;
+				}
+				else if (doctype && c == ']')
+				{
+					subset_depth--;
+				}
+				else if (c == '>' && subset_depth <= 0)
+				{
+					return i + 1;
+				}
+			}
+			scan_offset = size - pos;
+		}
+
+		if (!fill())
+			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+	}
+}
+
+void XMLTokenizer_Impl::parse_tag(XMLTokenView *out_token, std::string::size_type end)
+{
 	pos++;
-	if (pos == size)
+	if (pos == end)
 		XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
 	// Try to early predict what sort of node it might be:
-	bool closing = (data[pos] == '/');
-	bool questionMark = (data[pos] == '?');
-	bool exclamationMark = (data[pos] == '!');
+	bool closing = (buffer[pos] == '/');
+	bool questionMark = (buffer[pos] == '?');
+	bool exclamationMark = (buffer[pos] == '!');
 
 	if (closing || questionMark || exclamationMark)
 	{
 		pos++;
-		if (pos == size)
+		if (pos == end)
 			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 	}
 
 	if (exclamationMark) // check for cdata section, comments or doctype
 	{
-		if (next_exclamation_mark_node(out_token))
-			return true;
+		parse_exclamation_mark_node(out_token, end);
+		return;
 	}
 
 	// Extract the tag name:
 	std::string::size_type start_pos = pos;
-	std::string::size_type end_pos = data.find_first_of(" \r\n\t?/>", start_pos);
-	if (end_pos == data.npos)
+	std::string::size_type end_pos = find_first_of(char_name_end, start_pos, end);
+	if (end_pos == std::string::npos)
 		XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 	pos = end_pos;
 
 	out_token->type = questionMark ? XMLToken::PROCESSING_INSTRUCTION_TOKEN : XMLToken::ELEMENT_TOKEN;
 	out_token->variant = closing ? XMLToken::END : XMLToken::BEGIN;
-	out_token->name = data.substr(start_pos, end_pos - start_pos);
+	out_token->name = make_view(start_pos, end_pos, false);
 
 	if (out_token->type == XMLToken::PROCESSING_INSTRUCTION_TOKEN)
 	{
 		// Strip whitespace:
-		pos = data.find_first_not_of(" \r\n\t", pos);
-		if (pos == data.npos)
+		pos = find_first_not_of(char_whitespace, pos, end);
+		if (pos == std::string::npos)
 			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
-		end_pos = data.find_first_of("?", pos);
-		if (end_pos == data.npos)
+		end_pos = find('?', pos, end);
+		if (end_pos == std::string::npos)
 			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-		out_token->value = data.substr(pos, end_pos - pos);
+		out_token->value = make_view(pos, end_pos, false);
 		pos = end_pos;
 	}
 	else // out_token->type == XMLToken::ELEMENT_TOKEN
@@ -210,268 +388,179 @@ bool XMLTokenizer_Impl::next_tag_node(XMLToken *out_token)
 		while (true)
 		{
 			// Strip whitespace:
-			pos = data.find_first_not_of(" \r\n\t", pos);
-			if (pos == data.npos)
+			pos = find_first_not_of(char_whitespace, pos, end);
+			if (pos == std::string::npos)
 				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
 			// End of tag, stop searching for more attributes:
-			if (data[pos] == '/' || data[pos] == '?' || data[pos] == '>')
+			if (buffer[pos] == '/' || buffer[pos] == '?' || buffer[pos] == '>')
 				break;
 
 			// Extract attribute name:
 			std::string::size_type start_pos = pos;
-			std::string::size_type end_pos = data.find_first_of(" \r\n\t=", start_pos);
-			if (end_pos == data.npos)
+			std::string::size_type end_pos = find_first_of(char_attribute_name_end, start_pos, end);
+			if (end_pos == std::string::npos)
 				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 			pos = end_pos;
 
-			std::string attributeName = data.substr(start_pos, end_pos-start_pos);
+			XMLStringView attribute_name = make_view(start_pos, end_pos, false);
 
 			// Find seperator:
-			pos = data.find_first_not_of(" \r\n\t", pos);
-			if (pos == data.npos || pos == size-1)
+			pos = find_first_not_of(char_whitespace, pos, end);
+			if (pos == std::string::npos || pos == end-1)
 				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-			if (data[pos++] != '=')
-				XMLTokenizer_Impl::throw_exception(string_format("XML error(s), parser confused at line %1 (tag=%2, attributeName=%3)", get_line_number(), out_token->name, attributeName));
+			if (buffer[pos++] != '=')
+				XMLTokenizer_Impl::throw_exception(string_format("XML error(s), parser confused at line %1 (tag=%2, attributeName=%3)", get_line_number(), out_token->name.get_raw(), attribute_name.get_raw()));
 
 			// Strip whitespace:
-			pos = data.find_first_not_of(" \r\n\t", pos);
-			if (pos == data.npos)
+			pos = find_first_not_of(char_whitespace, pos, end);
+			if (pos == std::string::npos)
 				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
 			// Extract attribute value:
-			std::string::value_type const * first_of = " \r\n\t";
-			if (data[pos] == '"')
+			bool quoted = (buffer[pos] == '"' || buffer[pos] == '\'');
+			if (quoted)
 			{
-				first_of = "\"";
 				pos++;
-				if (pos == size)
+				if (pos == end)
 					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 			}
-			else
-				if (data[pos] == '\'')
-				{
-					first_of = "'";
-					pos++;
-					if (pos == size)
-						XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-				}
-
-				start_pos = pos;
-				end_pos = data.find_first_of(first_of, start_pos);
-				if (end_pos == data.npos)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
-				std::string attributeValue;
-				std::string attributeValueOrig = data.substr(start_pos, end_pos-start_pos);
-				unescape(attributeValue, attributeValueOrig);
+			start_pos = pos;
+			end_pos = quoted ? find(buffer[pos-1], start_pos, end) : find_first_of(char_value_end, start_pos, end);
+			if (end_pos == std::string::npos)
+				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
-				pos = end_pos + 1;
-				if (pos == size)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+			pos = quoted ? end_pos + 1 : end_pos;
+			if (pos == end)
+				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
-				// Finally apply attribute to token:
-				out_token->attributes.push_back(XMLToken::Attribute(attributeName, attributeValue));
+			// Finally apply attribute to token:
+			out_token->attributes.push_back(XMLTokenView::Attribute(attribute_name, make_view(start_pos, end_pos, true)));
 		}
 	}
 
 	// Check if its singular:
-	if (data[pos] == '/' || data[pos] == '?')
+	if (buffer[pos] == '/' || buffer[pos] == '?')
 	{
 		out_token->variant = XMLToken::SINGLE;
 		pos++;
-		if (pos == size)
+		if (pos == end)
 			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 	}
 
 	// Data stream should be ending now.
-	if (data[pos] != '>')
+	if (buffer[pos] != '>')
 		XMLTokenizer_Impl::throw_exception(string_format("Error in XML stream, line %1 (expected end of tag)", get_line_number()));
 	pos++;
-
-	return true;
 }
 
-bool XMLTokenizer_Impl::next_exclamation_mark_node(XMLToken *out_token)
+void XMLTokenizer_Impl::parse_exclamation_mark_node(XMLTokenView *out_token, std::string::size_type end)
 {
-	if (pos+2 >= size)
-		XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-	
-	if (data.compare(pos, 2, "--") == 0) // comment block
+	if (compare(pos, end, "--")) // comment block
 	{
 		std::string::size_type start_pos = pos+2;
-		std::string::size_type end_pos = data.find("-->", start_pos);
-		if (end_pos == data.npos)
+		std::string::size_type end_pos = find("-->", start_pos, end);
+		if (end_pos == std::string::npos)
 			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 		pos = end_pos+3;
 
-		std::string text;
-		std::string text_orig = data.substr(start_pos, end_pos-start_pos);
-		unescape(text, text_orig);
+		XMLStringView text = make_view(start_pos, end_pos, true);
 		if (eat_whitespace)
 			text = trim_whitespace(text);
 
 		out_token->type = XMLToken::COMMENT_TOKEN;
 		out_token->variant = XMLToken::SINGLE;
 		out_token->value = text;
-		return true;
 	}
-
-	if (pos+7 >= size)
-		XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-	
-	if (data.compare(pos, 7, "DOCTYPE") == 0)
+	else if (compare(pos, end, "DOCTYPE"))
 	{
 		// Strip whitespace:
-		pos = data.find_first_not_of(" \r\n\t", pos+7);
-		if (pos == data.npos)
+		pos = find_first_not_of(char_whitespace, pos+7, end);
+		if (pos == std::string::npos)
 			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
-		// Find doctype name:				
-		std::string::size_type name_start = pos;
-		std::string::size_type name_end = data.find_first_of(" \r\n\t?/>", name_start);
-		if (name_end == data.npos)
+		// Find doctype name:
+		pos = find_first_of(char_name_end, pos, end);
+		if (pos == std::string::npos)
 			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-		pos = name_end;
-		
+
 		// Strip whitespace:
-		pos = data.find_first_not_of(" \r\n\t", pos);
-		if (pos == data.npos)
+		pos = find_first_not_of(char_whitespace, pos, end);
+		if (pos == std::string::npos)
 			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
-		std::string::size_type public_start = data.npos;
-		std::string::size_type public_end = data.npos;
-		std::string::size_type system_start = data.npos;
-		std::string::size_type system_end = data.npos;
-		std::string::size_type subset_start = data.npos;
-		std::string::size_type subset_end = data.npos;
-
 		// Look for possible external id:
-		if (data[pos] != '[' && data[pos] != '>')
+		if (buffer[pos] != '[' && buffer[pos] != '>')
 		{
-			if (pos+6 >= size)
-				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+			int num_literals = 0;
+			if (compare(pos, end, "SYSTEM"))
+				num_literals = 1;
+			else if (compare(pos, end, "PUBLIC"))
+				num_literals = 2;
+			else
+				XMLTokenizer_Impl::throw_exception(string_format("Error in XML stream, line %1 (unknown external identifier type in DOCTYPE)", get_line_number()));
+			pos += 6;
 
-			if (data.compare(pos, 6, "SYSTEM") == 0)
+			// Skip the public and system literals:
+			for (int i = 0; i < num_literals; i++)
 			{
-				pos+=6;
-				if (pos == size)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-
-				// Strip whitespace:
-				pos = data.find_first_not_of(" \r\n\t", pos);
-				if (pos == data.npos)
+				pos = find_first_not_of(char_whitespace, pos, end);
+				if (pos == std::string::npos)
 					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
-				// Read system literal:
-				std::string::value_type literal_char = data[pos];
+				char literal_char = buffer[pos];
 				if (literal_char != '\'' && literal_char != '"')
 					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
-				system_start = pos+1;
-				system_end = data.find(literal_char, system_start);
-				if (system_end == data.npos)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-				pos = system_end + 1;
-				if (pos >= size)
+				std::string::size_type literal_end = find(literal_char, pos + 1, end);
+				if (literal_end == std::string::npos)
 					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+				pos = literal_end + 1;
 			}
-			else if (data.compare(pos, 6, "PUBLIC") == 0)
-			{
-				pos+=6;
-				if (pos == size)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-
-				// Strip whitespace:
-				pos = data.find_first_not_of(" \r\n\t", pos);
-				if (pos == data.npos)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-
-				// Read public literal:
-				std::string::value_type literal_char = data[pos];
-				if (literal_char != '\'' && literal_char != '"')
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
-				public_start = pos+1;
-				public_end = data.find(literal_char, public_start);
-				if (public_end == data.npos)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-				pos = public_end + 1;
-				if (pos >= size)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-
-				// Strip whitespace:
-				pos = data.find_first_not_of(" \r\n\t", pos);
-				if (pos == data.npos)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-
-				// Read system literal:
-				literal_char = data[pos];
-				if (literal_char != '\'' && literal_char != '"')
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-
-				system_start = pos+1;
-				system_end = data.find(literal_char, system_start);
-				if (system_end == data.npos)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-				pos = system_end + 1;
-				if (pos >= size)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-			}
-			else
-				XMLTokenizer_Impl::throw_exception(string_format("Error in XML stream, line %1 (unknown external identifier type in DOCTYPE)", get_line_number()));
-		
 			// Strip whitespace:
-			pos = data.find_first_not_of(" \r\n\t", pos);
-			if (pos == data.npos)
+			pos = find_first_not_of(char_whitespace, pos, end);
+			if (pos == std::string::npos)
 				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 		}
-		
+
 		// Look for possible internal subset:
-		if (data[pos] == '[')
+		if (buffer[pos] == '[')
 		{
-			subset_start = pos + 1;
-		
 			// Search for the end of the internal subset:
 			// (to avoid parsing it, we search backwards)
-			std::string::size_type end_pos = data.find('>', pos+1);
-			if (end_pos == data.npos)
-				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-			
-			subset_end = data.rfind(']', end_pos);
-			if (subset_end == data.npos)
+			std::string::size_type subset_end = end - 1;
+			while (subset_end > pos && buffer[subset_end] != ']')
+				subset_end--;
+			if (subset_end == pos)
 				XMLTokenizer_Impl::throw_exception(string_format("Error in XML stream, line %1 (expected end of internal subset in DOCTYPE)", get_line_number()));
-				
-			pos = end_pos;
+
+			pos = end - 1;
 		}
-		
+
 		// Expect DOCTYPE tag to end now:
-		if (data[pos] != '>')
+		if (buffer[pos] != '>')
 			XMLTokenizer_Impl::throw_exception(string_format("Error in XML stream, line %1 (expected end of DOCTYPE)", get_line_number()));
 		pos++;
 
 		out_token->type = XMLToken::DOCUMENT_TYPE_TOKEN;
-		return true;
 	}
-	else if (data.compare(pos, 7, "[CDATA[") == 0)
+	else if (compare(pos, end, "[CDATA["))
 	{
 		std::string::size_type start_pos = pos+7;
-		std::string::size_type end_pos = data.find("]]>", start_pos);
-		if (end_pos == data.npos)
+		std::string::size_type end_pos = find("]]>", start_pos, end);
+		if (end_pos == std::string::npos)
 			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 		pos = end_pos+3;
 
-		std::string value = data.substr(start_pos, end_pos-start_pos);
-
 		out_token->type = XMLToken::CDATA_SECTION_TOKEN;
 		out_token->variant = XMLToken::SINGLE;
-		out_token->value = value;
-		return true;
+		out_token->value = make_view(start_pos, end_pos, false);
 	}
 	else
 	{
-		XMLTokenizer_Impl::throw_exception(string_format("Error in XML stream at position %1", static_cast<int>(pos)));
-		return false;
+		XMLTokenizer_Impl::throw_exception(string_format("Error in XML stream, line %1", get_line_number()));
 	}
 }
 
@@ -482,67 +571,111 @@ void XMLTokenizer_Impl::throw_exception(const std::string &str)
 
 int XMLTokenizer_Impl::get_line_number()
 {
-	int line = 1;
-	std::string::size_type tmp_pos = 0;
+	std::string::size_type end = std::min(pos + 1, size);
+	return discarded_lines + 1 + (int) std::count(buffer.begin(), buffer.begin() + end, '\n');
+}
 
-	std::string::const_iterator it;
-	for( it = data.begin(); it != data.end() && tmp_pos <= pos; ++it, tmp_pos++ )
+void XMLTokenizer_Impl::unescape(std::string &text_out, const char *text, std::string::size_type length)
+{
+	static const struct { const char *entity; std::string::size_type length; char replace; } entities[] =
 	{
-		if( (*it) == '\n' )
-			line++;
-	}
+		{ "&quot;", 6, '"' },
+		{ "&apos;", 6, '\'' },
+		{ "&lt;", 4, '<' },
+		{ "&gt;", 4, '>' },
+		{ "&amp;", 5, '&' }
+	};
+
+	text_out.clear();
+	text_out.reserve(length);
+
+	std::string::size_type copy_start = 0;
+	for (std::string::size_type i = 0; i < length; i++)
+	{
+		if (text[i] != '&')
+			continue;
 
-	return line;
+		for (int j = 0; j < 5; j++)
+		{
+			if (length - i >= entities[j].length && memcmp(text + i, entities[j].entity, entities[j].length) == 0)
+			{
+				text_out.append(text + copy_start, i - copy_start);
+				text_out.push_back(entities[j].replace);
+				i += entities[j].length - 1;
+				copy_start = i + 1;
+				break;
+			}
+		}
+	}
+	text_out.append(text + copy_start, length - copy_start);
 }
 
-inline void XMLTokenizer_Impl::unescape(std::string &unescaped, const std::string &text)
+std::string::size_type XMLTokenizer_Impl::find(char c, std::string::size_type start, std::string::size_type end) const
 {
-	static const std::string quot("&quot;");
-	static const std::string apos("&apos;");
-	static const std::string lt("&lt;");
-	static const std::string gt("&gt;");
-	static const std::string amp("&amp;");
-
-	unescaped = text;
-	unescape(unescaped, quot, '"');
-	unescape(unescaped, apos, '\'');
-	unescape(unescaped, lt, '<');
-	unescape(unescaped, gt, '>');
-	unescape(unescaped, amp, '&');
+	if (start >= end)
+		return std::string::npos;
+	const char *match = static_cast<const char *>(memchr(&buffer[start], c, end - start));
+	return match ? match - &buffer[0] : std::string::npos;
 }
 
-inline void XMLTokenizer_Impl::unescape(std::string &text, const std::string &search, std::string::value_type replace)
+std::string::size_type XMLTokenizer_Impl::find(const char *str, std::string::size_type start, std::string::size_type end) const
 {
-	std::string::size_type read_pos = 0;
-	std::string::size_type length = text.length();
-	std::string::size_type search_length = search.length();
-	while (true)
+	std::string::size_type length = strlen(str);
+	while (end - start >= length)
 	{
-		std::string::size_type next_match = text.find(search, read_pos);
-		if (next_match == std::string::npos)
+		std::string::size_type match = find(str[0], start, end - length + 1);
+		if (match == std::string::npos)
 			break;
+		if (memcmp(&buffer[match], str, length) == 0)
+			return match;
+		start = match + 1;
+	}
+	return std::string::npos;
+}
 
-		std::string::size_type copy_size = length - (next_match + search_length);
-		if (copy_size > 0)
-			memcpy(&text[next_match + 1], &text[next_match + search_length], copy_size * sizeof(std::string::value_type));
-		text[next_match] = replace;
-		length -= search_length - 1;
-		read_pos = next_match + 1;
-		if (read_pos > length)
-			break;
+std::string::size_type XMLTokenizer_Impl::find_first_of(int char_class, std::string::size_type start, std::string::size_type end) const
+{
+	for (std::string::size_type i = start; i < end; i++)
+	{
+		if (char_classes[(unsigned char) buffer[i]] & char_class)
+			return i;
+	}
+	return std::string::npos;
+}
+
+std::string::size_type XMLTokenizer_Impl::find_first_not_of(int char_class, std::string::size_type start, std::string::size_type end) const
+{
+	for (std::string::size_type i = start; i < end; i++)
+	{
+		if (!(char_classes[(unsigned char) buffer[i]] & char_class))
+			return i;
 	}
-	text.resize(length);
+	return std::string::npos;
+}
+
+bool XMLTokenizer_Impl::compare(std::string::size_type start, std::string::size_type end, const char *str) const
+{
+	std::string::size_type length = strlen(str);
+	return start <= end && end - start >= length && memcmp(&buffer[start], str, length) == 0;
+}
+
+XMLStringView XMLTokenizer_Impl::make_view(std::string::size_type start, std::string::size_type end, bool unescape) const
+{
+	const char *data = &buffer[0] + start;
+	std::string::size_type length = end - start;
+	bool escaped = unescape && length > 0 && memchr(data, '&', length) != 0;
+	return XMLStringView(data, length, escaped);
 }
 
-inline std::string XMLTokenizer_Impl::trim_whitespace(const std::string &text)
+XMLStringView XMLTokenizer_Impl::trim_whitespace(const XMLStringView &text)
 {
-	std::string::size_type pos_start = text.find_first_not_of(" \t\r\n");
-	if (pos_start == std::string::npos)
-		return std::string();
-	std::string::size_type pos_end = text.find_last_not_of(" \t\r\n");
-	if (pos_end == std::string::npos)
-		return std::string();
-	return text.substr(pos_start, pos_end - pos_start + 1);
+	const char *start = text.data;
+	const char *end = text.data + text.length;
+	while (start != end && (char_classes[(unsigned char) *start] & char_whitespace))
+		start++;
+	while (end != start && (char_classes[(unsigned char) end[-1]] & char_whitespace))
+		end--;
+	return XMLStringView(start, end - start, text.escaped);
 }
 
 }
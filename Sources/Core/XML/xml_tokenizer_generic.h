@@ -29,6 +29,8 @@
 #pragma once
 
 #include "API/Core/IOData/iodevice.h"
+#include "API/Core/XML/xml_token_view.h"
+#include <vector>
 
 namespace clan
 {
@@ -38,37 +40,72 @@ class XMLTokenizer_Impl
 /// \name Construction
 /// \{
 public:
-	XMLTokenizer_Impl() : pos(0), size(0), eat_whitespace(true) { }
+	XMLTokenizer_Impl(IODevice &input, int buffer_size);
 /// \}
 
 /// \name Attributes
 /// \{
 public:
 	IODevice input;
+
+	// Unconsumed input is kept in buffer[pos, size). Everything before pos is
+	// discarded the next time the buffer is refilled.
+	std::vector<char> buffer;
 	std::string::size_type pos, size;
-	std::string data;
+
+	bool end_of_input;
+	bool bom_checked;
 	bool eat_whitespace;
+
+	// Lines in the input already discarded from the buffer
+	int discarded_lines;
+
+	// Token used to implement the XMLToken interface
+	XMLTokenView compat_token;
 /// \}
 
 /// \name Operations
 /// \{
 public:
 	static void throw_exception(const std::string &str);
-	bool next_text_node(XMLToken *out_token);
-	bool next_tag_node(XMLToken *out_token);
-	bool next_exclamation_mark_node(XMLToken *out_token);
+	void next(XMLTokenView *out_token);
 
 	// used to get the line number when there is an error in the xml file
 	int get_line_number();
 
-	void unescape(std::string &text_out, const std::string &text_in);
-	void unescape(std::string &text, const std::string &search, std::string::value_type replace);
-	std::string trim_whitespace(const std::string &text);
+	static void unescape(std::string &text_out, const char *text, std::string::size_type length);
 /// \}
 
 /// \name Implementation
 /// \{
 private:
+	bool fill();
+	bool require(std::string::size_type length);
+	void check_bom();
+
+	bool next_text_node(XMLTokenView *out_token);
+	bool next_tag_node(XMLTokenView *out_token);
+	std::string::size_type find_markup_end(std::string::size_type start);
+	void parse_tag(XMLTokenView *out_token, std::string::size_type end);
+	void parse_exclamation_mark_node(XMLTokenView *out_token, std::string::size_type end);
+
+	std::string::size_type find(char c, std::string::size_type start, std::string::size_type end) const;
+	std::string::size_type find(const char *str, std::string::size_type start, std::string::size_type end) const;
+	std::string::size_type find_first_of(int char_class, std::string::size_type start, std::string::size_type end) const;
+	std::string::size_type find_first_not_of(int char_class, std::string::size_type start, std::string::size_type end) const;
+	bool compare(std::string::size_type start, std::string::size_type end, const char *str) const;
+	XMLStringView make_view(std::string::size_type start, std::string::size_type end, bool unescape) const;
+	static XMLStringView trim_whitespace(const XMLStringView &text);
+
+	enum CharClass
+	{
+		char_whitespace = 1,
+		char_name_end = 2,
+		char_attribute_name_end = 4,
+		char_value_end = 8,
+		char_markup = 16
+	};
+	static const unsigned char char_classes[256];
 /// \}
 };
 
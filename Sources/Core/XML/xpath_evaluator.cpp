@@ -30,13 +30,71 @@
 #include "Core/precomp.h"
 #include "API/Core/XML/xpath_evaluator.h"
 #include "API/Core/XML/xpath_exception.h"
+#include "API/Core/XML/compiled_xpath.h"
 #include "API/Core/XML/dom_node.h"
+#include "API/Core/System/mutex.h"
 #include "xpath_evaluator_impl.h"
+#include "compiled_xpath_impl.h"
 #include "xpath_token.h"
+#include <list>
+#include <unordered_map>
 
 namespace clan
 {
 
+// Least recently used compiled expressions, keyed by expression text
+class XPathCache
+{
+public:
+	XPathCache() : max_size(64) { }
+
+	CompiledXPath find(const std::string &expression)
+	{
+		MutexSection mutex_lock(&mutex);
+		std::unordered_map<std::string, std::list<CompiledXPath>::iterator>::iterator it = lookup.find(expression);
+		if (it == lookup.end())
+			return CompiledXPath();
+
+		entries.splice(entries.begin(), entries, it->second);
+		return *it->second;
+	}
+
+	void add(const CompiledXPath &compiled)
+	{
+		MutexSection mutex_lock(&mutex);
+		if (max_size == 0 || lookup.find(compiled.get_expression()) != lookup.end())
+			return;
+
+		entries.push_front(compiled);
+		lookup[compiled.get_expression()] = entries.begin();
+		shrink(max_size);
+	}
+
+	void set_max_size(unsigned int new_max_size)
+	{
+		MutexSection mutex_lock(&mutex);
+		max_size = new_max_size;
+		shrink(max_size);
+	}
+
+private:
+	void shrink(unsigned int size)
+	{
+		while (entries.size() > size)
+		{
+			lookup.erase(entries.back().get_expression());
+			entries.pop_back();
+		}
+	}
+
+	Mutex mutex;
+	unsigned int max_size;
+	std::list<CompiledXPath> entries;
+	std::unordered_map<std::string, std::list<CompiledXPath>::iterator> lookup;
+};
+
+static XPathCache cl_xpath_cache;
+
 /////////////////////////////////////////////////////////////////////////////
 // XPathEvaluator Construction:
 
@@ -50,12 +108,36 @@ XPathEvaluator::XPathEvaluator()
 
 XPathObject XPathEvaluator::evaluate(const std::string &expression, const DomNode &context_node) const
 {
+	return evaluate(compile(expression), context_node);
+}
+
+XPathObject XPathEvaluator::evaluate(const CompiledXPath &expression, const DomNode &context_node) const
+{
+	if (expression.is_null())
+		throw XPathException("Null compiled XPath expression");
+
 	XPathToken prev_token;
 	std::vector<DomNode> nodelist(1, context_node);
-	XPathEvaluateResult result = impl->evaluate(expression, nodelist, 0, prev_token);
+	XPathEvaluateResult result = impl->evaluate(*expression.impl, nodelist, 0, prev_token);
 	if (result.next_token.type != XPathToken::type_none)
-		throw XPathException("Expected end of expression", expression, result.next_token);
+		throw XPathException("Expected end of expression", expression.get_expression(), result.next_token);
 	return result.result;
 }
 
+CompiledXPath XPathEvaluator::compile(const std::string &expression)
+{
+	CompiledXPath compiled = cl_xpath_cache.find(expression);
+	if (compiled.is_null())
+	{
+		compiled = CompiledXPath(expression);
+		cl_xpath_cache.add(compiled);
+	}
+	return compiled;
+}
+
+void XPathEvaluator::set_cache_size(unsigned int max_expressions)
+{
+	cl_xpath_cache.set_max_size(max_expressions);
+}
+
 }
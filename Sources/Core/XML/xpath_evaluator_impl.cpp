@@ -40,6 +40,10 @@
 #include "xpath_evaluator_impl.h"
 #include "xpath_token.h"
 #include "xpath_location_step.h"
+#include "compiled_xpath_impl.h"
+#include "dom_document_generic.h"
+#include "dom_tree_node.h"
+#include <algorithm>
 #include <cmath>
 #include <limits>
 
@@ -51,7 +55,7 @@ namespace clan
 
 
 XPathEvaluateResult XPathEvaluator_Impl::evaluate(
-	const std::string &expression,
+	const CompiledXPath_Impl &expression,
 	const XPathNodeSet &context,
 	XPathNodeSet::size_type context_node_index,
 	XPathToken prev_token) const
@@ -64,7 +68,7 @@ XPathEvaluateResult XPathEvaluator_Impl::evaluate(
 
 	while (true)
 	{
-		cur_token = read_token(expression, prev_token);
+		cur_token = expression.read_token(prev_token);
 
 		bool end_parenthesis = (
 			cur_token.type == XPathToken::type_operator &&
@@ -109,11 +113,11 @@ XPathEvaluateResult XPathEvaluator_Impl::evaluate(
 		else if (cur_token.type == XPathToken::type_function_name)
 		{
 			std::string function_name = cur_token.value.str;
-			cur_token = read_token(expression, cur_token);
+			cur_token = expression.read_token(cur_token);
 			if (cur_token.type != XPathToken::type_operator ||
 				cur_token.value.oper != XPathToken::operator_parenthesis_begin)
 			{
-				throw XPathException("Expected '(' after function name", expression, cur_token);
+				throw XPathException("Expected '(' after function name", expression.text, cur_token);
 			}
 
 			std::vector<XPathObject> parameters;
@@ -128,7 +132,7 @@ XPathEvaluateResult XPathEvaluator_Impl::evaluate(
 					cur_token.value.oper == XPathToken::operator_parenthesis_end)
 					break;
 				if (cur_token.type != XPathToken::type_comma)
-					throw XPathException("Expected ',' or ')' in function call", expression, cur_token);
+					throw XPathException("Expected ',' or ')' in function call", expression.text, cur_token);
 			}
 
 			XPathObject obj = call_function(context, context_node_index, function_name, parameters);
@@ -137,19 +141,19 @@ XPathEvaluateResult XPathEvaluator_Impl::evaluate(
 		else if (cur_token.type == XPathToken::type_bracket_begin)
 		{
 			if (operand_stack.empty())
-				throw XPathException("Missing operand before predicate", expression, cur_token);
+				throw XPathException("Missing operand before predicate", expression.text, cur_token);
 
 			Operand cur_operand = operand_stack.back();
 			operand_stack.pop_back();
 			if (cur_operand.get_type() != XPathObject::type_node_set)
-				throw XPathException("Expected node-set operand before '['", expression, cur_token);
+				throw XPathException("Expected node-set operand before '['", expression.text, cur_token);
 
 			XPathToken end_token = cur_token;
 			while (end_token.type != XPathToken::type_bracket_end && end_token.type != XPathToken::type_none)
-				end_token = read_token(expression, end_token);
+				end_token = expression.read_token(end_token);
 
 			if (end_token.type == XPathToken::type_none)
-				throw XPathException("Missing matching ']' in expression", expression, cur_token);
+				throw XPathException("Missing matching ']' in expression", expression.text, cur_token);
 
 			XPathLocationStep::Predicate predicate;
 			predicate.pos = cur_token.pos + cur_token.length;
@@ -163,8 +167,8 @@ XPathEvaluateResult XPathEvaluator_Impl::evaluate(
 					filtered_nodes.push_back(nodes[node_index]);
 			}
 
-			cur_token = read_token(expression, end_token);
-			XPathToken next_token = read_token(expression, cur_token);
+			cur_token = expression.read_token(end_token);
+			XPathToken next_token = expression.read_token(cur_token);
 			if (!filtered_nodes.empty() &&
 				(next_token.type == XPathToken::type_axis_name ||
 				next_token.type == XPathToken::type_name_test ||
@@ -203,7 +207,7 @@ XPathEvaluateResult XPathEvaluator_Impl::evaluate(
 		}
 		else
 		{
-			throw XPathException("Unexpected token", expression, cur_token);
+			throw XPathException("Unexpected token", expression.text, cur_token);
 		}
 
 		prev_token = cur_token;
@@ -218,7 +222,7 @@ XPathEvaluateResult XPathEvaluator_Impl::evaluate(
 			cur_token.type == XPathToken::type_operator &&
 			cur_token.value.oper == XPathToken::operator_parenthesis_end))
 	{
-		throw XPathException("Expected operand", expression, cur_token);
+		throw XPathException("Expected operand", expression.text, cur_token);
 	}
 
 	XPathEvaluateResult result;
@@ -856,7 +860,7 @@ bool XPathEvaluator_Impl::compare_string(const Operand &a, const Operand &b, Ope
 }
 
 XPathToken XPathEvaluator_Impl::read_location_path(
-	const std::string &expression,
+	const CompiledXPath_Impl &expression,
 	XPathToken cur_token,
 	const XPathNodeSet &context,
 	XPathNodeSet::size_type context_node_index,
@@ -889,7 +893,7 @@ XPathToken XPathEvaluator_Impl::read_location_path(
 		}
 		else
 		{
-			XPathToken next_token = read_token(expression, cur_token);
+			XPathToken next_token = expression.read_token(cur_token);
 			if (next_token.type == XPathToken::type_axis_name ||
 				next_token.type == XPathToken::type_name_test ||
 				next_token.type == XPathToken::type_node_type ||
@@ -915,53 +919,61 @@ XPathToken XPathEvaluator_Impl::read_location_path(
 }
 
 XPathToken XPathEvaluator_Impl::read_location_steps(
-	const std::string &expression,
+	const CompiledXPath_Impl &expression,
 	XPathToken cur_token,
 	const XPathNodeSet &context,
 	XPathNodeSet::size_type context_node_index,
 	std::vector<XPathEvaluator_Impl::Operand> &operand_stack) const
 {
-	std::vector<XPathLocationStep> steps;
-	while (true)
+	// Location paths are parsed once per compiled expression:
+	std::string::size_type path_pos = cur_token.pos;
+	const XPathLocationPath *path = expression.find_location_path(path_pos);
+	if (path == 0)
 	{
-		XPathLocationStep step;
-		cur_token = read_location_step(expression, cur_token, step);
-		steps.push_back(step);
-
-		XPathToken next_token = read_token(expression, cur_token);
-		if ((next_token.type == XPathToken::type_operator && next_token.value.oper == XPathToken::operator_slash) ||
-			(cur_token.type == XPathToken::type_operator && cur_token.value.oper == XPathToken::operator_double_slash))
+		XPathLocationPath new_path;
+		while (true)
 		{
-			if (next_token.value.oper == XPathToken::operator_slash)
-				next_token = read_token(expression, next_token);
-			if (next_token.type == XPathToken::type_axis_name ||
-				next_token.type == XPathToken::type_name_test ||
-				next_token.type == XPathToken::type_node_type ||
-				next_token.type == XPathToken::type_at_sign ||
-				next_token.type == XPathToken::type_dot ||
-				next_token.type == XPathToken::type_double_dot)
+			XPathLocationStep step;
+			cur_token = read_location_step(expression, cur_token, step);
+			new_path.steps.push_back(step);
+
+			XPathToken next_token = expression.read_token(cur_token);
+			if ((next_token.type == XPathToken::type_operator && next_token.value.oper == XPathToken::operator_slash) ||
+				(cur_token.type == XPathToken::type_operator && cur_token.value.oper == XPathToken::operator_double_slash))
 			{
-				cur_token = next_token;
+				if (next_token.value.oper == XPathToken::operator_slash)
+					next_token = expression.read_token(next_token);
+				if (next_token.type == XPathToken::type_axis_name ||
+					next_token.type == XPathToken::type_name_test ||
+					next_token.type == XPathToken::type_node_type ||
+					next_token.type == XPathToken::type_at_sign ||
+					next_token.type == XPathToken::type_dot ||
+					next_token.type == XPathToken::type_double_dot)
+				{
+					cur_token = next_token;
+				}
+				else
+				{
+					break;
+				}
 			}
 			else
 			{
 				break;
 			}
 		}
-		else
-		{
-			break;
-		}
+		new_path.last_token = cur_token;
+		path = expression.add_location_path(path_pos, new_path);
 	}
 
 	XPathNodeSet nodeset;
-	evaluate_location_step(context, context_node_index, steps, 0, expression, nodeset);
+	evaluate_location_step(context, context_node_index, path->steps, 0, expression, nodeset);
 	operand_stack.push_back(XPathObject(nodeset));
-	return cur_token;
+	return path->last_token;
 }
 
 XPathToken XPathEvaluator_Impl::read_location_step(
-	const std::string &expression,
+	const CompiledXPath_Impl &expression,
 	XPathToken cur_token,
 	XPathLocationStep &step) const
 {
@@ -989,19 +1001,19 @@ XPathToken XPathEvaluator_Impl::read_location_step(
 */
 	if (cur_token.type == XPathToken::type_dot)
 	{
-		step.axis = "self";
+		step.axis = XPathLocationStep::axis_self;
 		step.test_type = XPathLocationStep::type_node;
 		step.node_type = XPathToken::node_type_node;
 	}
 	else if (cur_token.type == XPathToken::type_double_dot)
 	{
-		step.axis = "parent";
+		step.axis = XPathLocationStep::axis_parent;
 		step.test_type = XPathLocationStep::type_node;
 		step.node_type = XPathToken::node_type_node;
 	}
 	else if (cur_token.type == XPathToken::type_operator && cur_token.value.oper == XPathToken::operator_double_slash)
 	{
-		step.axis = "descendant-or-self";
+		step.axis = XPathLocationStep::axis_descendant_or_self;
 		step.test_type = XPathLocationStep::type_node;
 		step.node_type = XPathToken::node_type_node;
 	}
@@ -1010,20 +1022,21 @@ XPathToken XPathEvaluator_Impl::read_location_step(
 		// Read AxisSpecifier:
 		if (cur_token.type == XPathToken::type_axis_name)
 		{
-			step.axis = cur_token.value.str;
-			cur_token = read_token(expression, cur_token);
+			if (!find_axis(cur_token.value.str, step.axis))
+				throw XPathException(string_format("Unknown location step axis %1", cur_token.value.str), expression.text, cur_token);
+			cur_token = expression.read_token(cur_token);
 			if (cur_token.type != XPathToken::type_double_colon)
-				throw XPathException("Expected '::' after axis name", expression, cur_token);
-			cur_token = read_token(expression, cur_token);
+				throw XPathException("Expected '::' after axis name", expression.text, cur_token);
+			cur_token = expression.read_token(cur_token);
 		}
 		else if (cur_token.type == XPathToken::type_at_sign) // Abbreviated axis specifier
 		{
-			step.axis = "attribute";
-			cur_token = read_token(expression, cur_token);
+			step.axis = XPathLocationStep::axis_attribute;
+			cur_token = expression.read_token(cur_token);
 		}
 		else // Abbreviated syntax
 		{
-			step.axis = "child";
+			step.axis = XPathLocationStep::axis_child;
 		}
 
 		// Read Node Test:
@@ -1036,24 +1049,24 @@ XPathToken XPathEvaluator_Impl::read_location_step(
 		{
 			step.test_type = XPathLocationStep::type_node;
 			step.node_type = cur_token.value.node_type;
-			cur_token = read_token(expression, cur_token);
+			cur_token = expression.read_token(cur_token);
 			if (cur_token.type != XPathToken::type_operator || cur_token.value.oper != XPathToken::operator_parenthesis_begin)
-				throw XPathException("Expected '(' after node-type test", expression, cur_token);
-			cur_token = read_token(expression, cur_token);
+				throw XPathException("Expected '(' after node-type test", expression.text, cur_token);
+			cur_token = expression.read_token(cur_token);
 			if (cur_token.type == XPathToken::type_literal && step.node_type == XPathToken::node_type_processing_instruction)
 			{
 				step.test_str = cur_token.value.str;
-				cur_token = read_token(expression, cur_token);
+				cur_token = expression.read_token(cur_token);
 			}
 			if (cur_token.type != XPathToken::type_operator || cur_token.value.oper != XPathToken::operator_parenthesis_end)
-				throw XPathException("Expected ')' after node-type test", expression, cur_token);
+				throw XPathException("Expected ')' after node-type test", expression.text, cur_token);
 		}
 		else
 		{
-			throw XPathException("Unknown node test type", expression, cur_token);
+			throw XPathException("Unknown node test type", expression.text, cur_token);
 		}
 
-		XPathToken next_token = read_token(expression, cur_token);
+		XPathToken next_token = expression.read_token(cur_token);
 		while (next_token.type == XPathToken::type_bracket_begin)
 		{
 			XPathLocationStep::Predicate predicate;
@@ -1061,19 +1074,19 @@ XPathToken XPathEvaluator_Impl::read_location_step(
 			cur_token = skip_predicate_expression(expression, next_token);
 			predicate.length = cur_token.pos - predicate.pos;
 			step.predicates.push_back(predicate);
-			next_token = read_token(expression, cur_token);
+			next_token = expression.read_token(cur_token);
 		}
 	}
 	return cur_token;
 }
 
-XPathToken XPathEvaluator_Impl::skip_predicate_expression(const std::string &expression, const XPathToken &previous_token) const
+XPathToken XPathEvaluator_Impl::skip_predicate_expression(const CompiledXPath_Impl &expression, const XPathToken &previous_token) const
 {
 	int bracket_count = 1;
 	XPathToken cur_token = previous_token;
 	while (true)
 	{
-		cur_token = read_token(expression, cur_token);
+		cur_token = expression.read_token(cur_token);
 		if (cur_token.type == XPathToken::type_bracket_begin)
 		{
 			bracket_count++;
@@ -1092,38 +1105,52 @@ XPathToken XPathEvaluator_Impl::skip_predicate_expression(const std::string &exp
 	return cur_token;
 }
 
-void XPathEvaluator_Impl::evaluate_location_step(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::evaluate_location_step(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &nodes) const
 {
 	if (step_index < steps.size())
 	{
-		if (steps[step_index].axis == "ancestor")
+		switch (steps[step_index].axis)
+		{
+		case XPathLocationStep::axis_ancestor:
 			select_nodes_ancestor(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "ancestor-or-self")
+			break;
+		case XPathLocationStep::axis_ancestor_or_self:
 			select_nodes_ancestor_or_self(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "attribute")
+			break;
+		case XPathLocationStep::axis_attribute:
 			select_nodes_attribute(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "child")
+			break;
+		case XPathLocationStep::axis_child:
 			select_nodes_child(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "descendant")
+			break;
+		case XPathLocationStep::axis_descendant:
 			select_nodes_descendant(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "descendant-or-self")
+			break;
+		case XPathLocationStep::axis_descendant_or_self:
 			select_nodes_descendant_or_self(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "following")
+			break;
+		case XPathLocationStep::axis_following:
 			select_nodes_following(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "follwing-sibling")
+			break;
+		case XPathLocationStep::axis_following_sibling:
 			select_nodes_following_sibling(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "namespace")
+			break;
+		case XPathLocationStep::axis_namespace:
 			select_nodes_namespace(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "parent")
+			break;
+		case XPathLocationStep::axis_parent:
 			select_nodes_parent(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "preceding")
+			break;
+		case XPathLocationStep::axis_preceding:
 			select_nodes_preceding(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "preceding-sibling")
+			break;
+		case XPathLocationStep::axis_preceding_sibling:
 			select_nodes_preceding_sibling(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "self")
+			break;
+		case XPathLocationStep::axis_self:
 			select_nodes_self(context, context_node_index, steps, step_index, expression, nodes);
-		else
-			throw XPathException(string_format("Unknown location step axis", steps[step_index].axis), expression);
+			break;
+		}
 	}
 	else
 	{
@@ -1131,7 +1158,7 @@ void XPathEvaluator_Impl::evaluate_location_step(const XPathNodeSet &context, XP
 	}
 }
 
-void XPathEvaluator_Impl::select_nodes_ancestor(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_ancestor(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNode parent = context[context_node_index].get_parent_node();
@@ -1146,7 +1173,7 @@ void XPathEvaluator_Impl::select_nodes_ancestor(const XPathNodeSet &context, XPa
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_ancestor_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_ancestor_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNode parent = context[context_node_index];
@@ -1161,9 +1188,16 @@ void XPathEvaluator_Impl::select_nodes_ancestor_or_self(const XPathNodeSet &cont
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_attribute(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_attribute(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
+	if (is_name_test(steps[step_index]))
+	{
+		select_named_children(context[context_node_index], steps[step_index].test_str, true, nodeset);
+		evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
+		return;
+	}
+
 	DomNamedNodeMap attributes = context[context_node_index].get_attributes();
 	unsigned long num_attributes = attributes.get_length();
 	for (unsigned long idx = 0; idx < num_attributes; idx++)
@@ -1176,9 +1210,16 @@ void XPathEvaluator_Impl::select_nodes_attribute(const XPathNodeSet &context, XP
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_child(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_child(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
+	if (is_name_test(steps[step_index]))
+	{
+		select_named_children(context[context_node_index], steps[step_index].test_str, false, nodeset);
+		evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
+		return;
+	}
+
 	DomNode cur_node = context[context_node_index].get_first_child();
 	while (!cur_node.is_null())
 	{
@@ -1190,11 +1231,17 @@ void XPathEvaluator_Impl::select_nodes_child(const XPathNodeSet &context, XPathN
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_descendant(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_descendant(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet parentNodes;
 	XPathNodeSet nodeset;
 
+	if (is_name_test(steps[step_index]) && select_descendant_elements(context[context_node_index], steps[step_index].test_str, false, false, nodeset))
+	{
+		evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
+		return;
+	}
+
 	DomNode cur_node = context[context_node_index].get_first_child();
 	while (!cur_node.is_null())
 	{
@@ -1216,11 +1263,47 @@ void XPathEvaluator_Impl::select_nodes_descendant(const XPathNodeSet &context, X
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_descendant_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_descendant_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet parentNodes;
 	XPathNodeSet nodeset;
 
+	if (is_name_test(steps[step_index]) && select_descendant_elements(context[context_node_index], steps[step_index].test_str, true, false, nodeset))
+	{
+		evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
+		return;
+	}
+
+	// '//name' selects the named children of every node in the subtree, which are
+	// the named descendants ordered by their parent:
+	const XPathLocationStep &step = steps[step_index];
+	if (step.test_type == XPathLocationStep::type_node && step.node_type == XPathToken::node_type_node && step.predicates.empty() &&
+		step_index + 1 < steps.size() && steps[step_index + 1].axis == XPathLocationStep::axis_child &&
+		is_name_test(steps[step_index + 1]) &&
+		select_descendant_elements(context[context_node_index], steps[step_index + 1].test_str, false, true, nodeset))
+	{
+		if (steps[step_index + 1].predicates.empty())
+		{
+			evaluate_location_step_predicates(nodeset, steps, step_index + 1, expression, nodes);
+			return;
+		}
+
+		// Predicates of the child step apply to the children of each parent separately:
+		XPathNodeSet::size_type group_begin = 0;
+		while (group_begin < nodeset.size())
+		{
+			unsigned int parent_index = nodeset[group_begin].impl->get_tree_node()->parent;
+			XPathNodeSet::size_type group_end = group_begin + 1;
+			while (group_end < nodeset.size() && nodeset[group_end].impl->get_tree_node()->parent == parent_index)
+				group_end++;
+
+			XPathNodeSet siblings(nodeset.begin() + group_begin, nodeset.begin() + group_end);
+			evaluate_location_step_predicates(siblings, steps, step_index + 1, expression, nodes);
+			group_begin = group_end;
+		}
+		return;
+	}
+
 	DomNode cur_node = context[context_node_index];
 	while (!cur_node.is_null())
 	{
@@ -1242,7 +1325,7 @@ void XPathEvaluator_Impl::select_nodes_descendant_or_self(const XPathNodeSet &co
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_following(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_following(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 
@@ -1278,7 +1361,7 @@ void XPathEvaluator_Impl::select_nodes_following(const XPathNodeSet &context, XP
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_following_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_following_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNode cur_node = context[context_node_index].get_next_sibling();
@@ -1292,11 +1375,11 @@ void XPathEvaluator_Impl::select_nodes_following_sibling(const XPathNodeSet &con
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_namespace(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_namespace(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &nodes) const
 {
 }
 
-void XPathEvaluator_Impl::select_nodes_parent(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_parent(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNode parent = context[context_node_index].get_parent_node();
@@ -1309,7 +1392,7 @@ void XPathEvaluator_Impl::select_nodes_parent(const XPathNodeSet &context, XPath
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_preceding(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_preceding(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 
@@ -1345,7 +1428,7 @@ void XPathEvaluator_Impl::select_nodes_preceding(const XPathNodeSet &context, XP
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_preceding_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_preceding_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNode cur_node = context[context_node_index].get_previous_sibling();
@@ -1359,7 +1442,7 @@ void XPathEvaluator_Impl::select_nodes_preceding_sibling(const XPathNodeSet &con
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &nodes) const
 {
 	DomNode cur_node = context[context_node_index];
 	if (!cur_node.is_null())
@@ -1369,7 +1452,86 @@ void XPathEvaluator_Impl::select_nodes_self(const XPathNodeSet &context, XPathNo
 	}
 }
 
-bool XPathEvaluator_Impl::confirm_step_requirements(const DomNode &node, const XPathLocationStep &step, const std::string &expression) const
+bool XPathEvaluator_Impl::is_name_test(const XPathLocationStep &step)
+{
+	return step.test_type == XPathLocationStep::type_name && step.test_str != "*";
+}
+
+void XPathEvaluator_Impl::select_named_children(const DomNode &node, const std::string &name, bool attributes, XPathNodeSet &out_nodeset) const
+{
+	if (node.is_null())
+		return;
+
+	DomDocument_Impl *doc_impl = (DomDocument_Impl *) node.impl->owner_document.lock().get();
+	unsigned int name_atom = 0;
+	if (!doc_impl->find_existing_atom(name, name_atom))
+		return;
+
+	unsigned short node_type = attributes ? DomNode::ATTRIBUTE_NODE : DomNode::ELEMENT_NODE;
+	const DomTreeNode *tree_node = node.impl->get_tree_node();
+	unsigned int cur_index = attributes ? tree_node->first_attribute : tree_node->first_child;
+	while (cur_index != cl_null_node_index)
+	{
+		const DomTreeNode *cur = doc_impl->nodes[cur_index];
+		if (cur->node_type == node_type && cur->name_atom == name_atom)
+			out_nodeset.push_back(create_node(doc_impl, cur_index));
+		cur_index = cur->next_sibling;
+	}
+}
+
+bool XPathEvaluator_Impl::select_descendant_elements(const DomNode &node, const std::string &name, bool include_self, bool order_by_parent, XPathNodeSet &out_nodeset) const
+{
+	if (node.is_null())
+		return false;
+
+	DomDocument_Impl *doc_impl = (DomDocument_Impl *) node.impl->owner_document.lock().get();
+	const DomElementIndex &index = doc_impl->get_element_index();
+
+	// Nodes outside the document tree are not indexed:
+	unsigned int node_index = node.impl->node_index;
+	if (node_index >= index.order.size() || index.order[node_index] == cl_null_node_index)
+		return false;
+
+	unsigned int name_atom = 0;
+	if (!doc_impl->find_existing_atom(name, name_atom) || name_atom >= index.elements_by_name.size())
+		return true;
+
+	// The subtree of a node is a continuous range in document order:
+	const std::vector<unsigned int> &positions = index.elements_by_name[name_atom];
+	unsigned int first_position = index.order[node_index] + (include_self ? 0 : 1);
+	std::vector<unsigned int>::const_iterator it_begin = std::lower_bound(positions.begin(), positions.end(), first_position);
+	std::vector<unsigned int>::const_iterator it_end = std::lower_bound(it_begin, positions.end(), index.subtree_end[node_index]);
+
+	if (order_by_parent)
+	{
+		std::vector<std::pair<unsigned int, unsigned int> > sorted;
+		sorted.reserve(it_end - it_begin);
+		for (std::vector<unsigned int>::const_iterator it = it_begin; it != it_end; ++it)
+		{
+			unsigned int element_index = index.ordered_nodes[*it];
+			sorted.push_back(std::make_pair(index.order[doc_impl->nodes[element_index]->parent], *it));
+		}
+		std::sort(sorted.begin(), sorted.end());
+
+		for (std::vector<std::pair<unsigned int, unsigned int> >::size_type i = 0; i < sorted.size(); i++)
+			out_nodeset.push_back(create_node(doc_impl, index.ordered_nodes[sorted[i].second]));
+	}
+	else
+	{
+		for (std::vector<unsigned int>::const_iterator it = it_begin; it != it_end; ++it)
+			out_nodeset.push_back(create_node(doc_impl, index.ordered_nodes[*it]));
+	}
+	return true;
+}
+
+DomNode XPathEvaluator_Impl::create_node(DomDocument_Impl *doc_impl, unsigned int node_index)
+{
+	DomNode_Impl *dom_node = doc_impl->allocate_dom_node();
+	dom_node->node_index = node_index;
+	return DomNode(std::shared_ptr<DomNode_Impl>(dom_node, DomDocument_Impl::NodeDeleter(doc_impl)));
+}
+
+bool XPathEvaluator_Impl::confirm_step_requirements(const DomNode &node, const XPathLocationStep &step, const CompiledXPath_Impl &expression) const
 {
 	bool test_passed = false;
 	switch (step.test_type)
@@ -1408,9 +1570,14 @@ bool XPathEvaluator_Impl::confirm_step_requirements(const DomNode &node, const X
 	return test_passed;
 }
 
-bool XPathEvaluator_Impl::confirm_step_predicate(XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const XPathLocationStep::Predicate &predicate, const std::string &expression) const
+bool XPathEvaluator_Impl::confirm_step_predicate(XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const XPathLocationStep::Predicate &predicate, const CompiledXPath_Impl &expression) const
 {
-	XPathEvaluateResult result = evaluate(expression.substr(predicate.pos, predicate.length), context, context_node_index, XPathToken());
+	// The predicate expression ends at its closing bracket:
+	XPathToken bracket_token;
+	bracket_token.type = XPathToken::type_bracket_begin;
+	bracket_token.pos = predicate.pos - 1;
+	bracket_token.length = 1;
+	XPathEvaluateResult result = evaluate(expression, context, context_node_index, bracket_token);
 	bool include_in_nodeset = false;
 	switch (result.result.get_type())
 	{
@@ -1432,7 +1599,7 @@ bool XPathEvaluator_Impl::confirm_step_predicate(XPathNodeSet &context, XPathNod
 	return include_in_nodeset;
 }
 
-void XPathEvaluator_Impl::evaluate_location_step_predicates(const XPathNodeSet &context, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::evaluate_location_step_predicates(const XPathNodeSet &context, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset = context;
 	for (std::vector<XPathLocationStep::Predicate>::const_iterator pit = steps[step_index].predicates.begin(), pEnd = steps[step_index].predicates.end(); pit != pEnd; ++pit)
@@ -1450,9 +1617,39 @@ void XPathEvaluator_Impl::evaluate_location_step_predicates(const XPathNodeSet &
 		evaluate_location_step(nodeset, node_index, steps, step_index+1, expression, nodes);
 }
 
+bool XPathEvaluator_Impl::find_axis(const std::string &axis_name, XPathLocationStep::Axis &out_axis)
+{
+	static const struct { const char *name; XPathLocationStep::Axis axis; } axes[] =
+	{
+		{ "ancestor", XPathLocationStep::axis_ancestor },
+		{ "ancestor-or-self", XPathLocationStep::axis_ancestor_or_self },
+		{ "attribute", XPathLocationStep::axis_attribute },
+		{ "child", XPathLocationStep::axis_child },
+		{ "descendant", XPathLocationStep::axis_descendant },
+		{ "descendant-or-self", XPathLocationStep::axis_descendant_or_self },
+		{ "following", XPathLocationStep::axis_following },
+		{ "following-sibling", XPathLocationStep::axis_following_sibling },
+		{ "namespace", XPathLocationStep::axis_namespace },
+		{ "parent", XPathLocationStep::axis_parent },
+		{ "preceding", XPathLocationStep::axis_preceding },
+		{ "preceding-sibling", XPathLocationStep::axis_preceding_sibling },
+		{ "self", XPathLocationStep::axis_self }
+	};
+
+	for (size_t i = 0; i < sizeof(axes) / sizeof(axes[0]); i++)
+	{
+		if (axis_name == axes[i].name)
+		{
+			out_axis = axes[i].axis;
+			return true;
+		}
+	}
+	return false;
+}
+
 XPathToken XPathEvaluator_Impl::read_token(
 	const std::string &expression,
-	const XPathToken &previous_token) const
+	const XPathToken &previous_token)
 {
 	std::string::size_type pos = previous_token.pos + previous_token.length;
 	pos = expression.find_first_not_of(" \t\r\n", pos);
@@ -36,6 +36,9 @@
 namespace clan
 {
 
+class CompiledXPath_Impl;
+class DomDocument_Impl;
+
 class XPathEvaluateResult
 {
 public:
@@ -50,11 +53,17 @@ public:
 
 public:
 	XPathEvaluateResult evaluate(
-		const std::string &expression,
+		const CompiledXPath_Impl &expression,
 		const XPathNodeSet &context,
 		XPathNodeSet::size_type context_node_index,
 		XPathToken prev_token) const;
 
+	static XPathToken read_token(
+		const std::string &expression,
+		const XPathToken &previous_token = XPathToken());
+
+	static bool find_axis(const std::string &axis_name, XPathLocationStep::Axis &out_axis);
+
 private:
 	typedef XPathToken::Operator Operator;
 	typedef XPathObject Operand;
@@ -77,50 +86,50 @@ private:
 	bool compare_string(const Operand &a, const Operand &b, Operator oper) const;
 
 	XPathToken read_location_path(
-		const std::string &expression,
+		const CompiledXPath_Impl &expression,
 		XPathToken cur_token,
 		const XPathNodeSet &context,
 		XPathNodeSet::size_type context_node_index,
 		std::vector<Operand> &operand_stack) const;
 
 	XPathToken read_location_steps(
-		const std::string &expression,
+		const CompiledXPath_Impl &expression,
 		XPathToken cur_token,
 		const XPathNodeSet &context,
 		XPathNodeSet::size_type context_node_index,
 		std::vector<XPathEvaluator_Impl::Operand> &operand_stack) const;
 
 	XPathToken read_location_step(
-		const std::string &expression,
+		const CompiledXPath_Impl &expression,
 		XPathToken cur_token,
 		XPathLocationStep &step) const;
 
-	XPathToken read_token(
-		const std::string &expression,
-		const XPathToken &previous_token = XPathToken()) const;
-
 	XPathToken skip_predicate_expression(
-		const std::string &expression,
+		const CompiledXPath_Impl &expression,
 		const XPathToken &previous_token = XPathToken()) const;
 
-	void evaluate_location_step(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void evaluate_location_step_predicates(const XPathNodeSet &context, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string & expression, XPathNodeSet & nodes) const;
-
-	void select_nodes_ancestor(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_ancestor_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_attribute(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_child(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_descendant(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_descendant_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_following(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_following_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_namespace(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_parent(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_preceding(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_preceding_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	bool confirm_step_requirements(const DomNode &node, const XPathLocationStep &step, const std::string &expression) const;
-	bool confirm_step_predicate(XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const XPathLocationStep::Predicate &predicate, const std::string &expression) const;
+	void evaluate_location_step(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &out_nodeset) const;
+	void evaluate_location_step_predicates(const XPathNodeSet &context, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet & nodes) const;
+
+	void select_nodes_ancestor(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_ancestor_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_attribute(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_child(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_descendant(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_descendant_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_following(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_following_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_namespace(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_parent(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_preceding(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_preceding_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const CompiledXPath_Impl &expression, XPathNodeSet &out_nodeset) const;
+	void select_named_children(const DomNode &node, const std::string &name, bool attributes, XPathNodeSet &out_nodeset) const;
+	bool select_descendant_elements(const DomNode &node, const std::string &name, bool include_self, bool order_by_parent, XPathNodeSet &out_nodeset) const;
+	static bool is_name_test(const XPathLocationStep &step);
+	static DomNode create_node(DomDocument_Impl *doc_impl, unsigned int node_index);
+	bool confirm_step_requirements(const DomNode &node, const XPathLocationStep &step, const CompiledXPath_Impl &expression) const;
+	bool confirm_step_predicate(XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const XPathLocationStep::Predicate &predicate, const CompiledXPath_Impl &expression) const;
 
 	XPathObject call_function(const XPathNodeSet& context, XPathNodeSet::size_type context_node_index, const std::string &name, const std::vector<XPathObject> &parameters) const;
 	XPathObject get_variable(const std::string &name) const;
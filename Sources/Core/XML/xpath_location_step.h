@@ -37,10 +37,27 @@ class XPathLocationStep
 {
 public:
 	XPathLocationStep()
-	: test_type(type_none)
+	: axis(axis_child), test_type(type_none)
 	{
 	}
 
+	enum Axis
+	{
+		axis_ancestor,
+		axis_ancestor_or_self,
+		axis_attribute,
+		axis_child,
+		axis_descendant,
+		axis_descendant_or_self,
+		axis_following,
+		axis_following_sibling,
+		axis_namespace,
+		axis_parent,
+		axis_preceding,
+		axis_preceding_sibling,
+		axis_self
+	};
+
 	enum TestType
 	{
 		type_none,
@@ -48,7 +65,7 @@ public:
 		type_node,
 	};
 
-	std::string axis;
+	Axis axis;
 	TestType test_type;
 	std::string test_str;
 
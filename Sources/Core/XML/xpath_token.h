@@ -87,6 +87,8 @@ public:
 
 	struct Value
 	{
+		Value() : node_type(node_type_node), oper(operator_parenthesis_begin) { }
+
 		NodeType node_type;
 		Operator oper;
 		std::string str;
@@ -316,13 +316,13 @@ void ZipArchive::load(IODevice &input)
 
 	// Find end of central directory record:
 
-	int size_file = input.get_size();
+	byte64 size_file = input.get_size();
 
 	char buffer[32*1024];
 	if (size_file > 32*1024) input.seek(-32*1024, IODevice::seek_end);
 	int size_buffer = input.read(buffer, 32*1024);
 
-	int end_record_pos = -1;
+	byte64 end_record_pos = -1;
 	for (int pos = size_buffer-4; pos >= 0; pos--)
 	{
 	#ifdef USE_BIG_ENDIAN
@@ -352,7 +352,7 @@ void ZipArchive::load(IODevice &input)
 	Zip64EndOfCentralDirectoryLocator zip64_locator;
 	Zip64EndOfCentralDirectoryRecord zip64_end_of_directory;
 
-	int end64_locator = end_record_pos-20;
+	byte64 end64_locator = end_record_pos-20;
 	input.seek(end64_locator, IODevice::seek_set);
 	if (input.read_uint32() == 0x07064b50)
 	{
@@ -361,7 +361,7 @@ void ZipArchive::load(IODevice &input)
 		input.seek(end64_locator, IODevice::seek_set);
 		zip64_locator.load(input);
 
-		input.seek(int(end64_locator+zip64_locator.relative_offset_of_zip64_end_of_central_directory), IODevice::seek_set);
+		input.seek(end64_locator+zip64_locator.relative_offset_of_zip64_end_of_central_directory, IODevice::seek_set);
 		zip64_end_of_directory.load(input);
 
 		zip64 = true;
@@ -369,8 +369,8 @@ void ZipArchive::load(IODevice &input)
 
 	// Load central directory records:
 
-	if (zip64) input.seek(int(zip64_end_of_directory.offset_to_start_of_central_directory), IODevice::seek_set);
-	else input.seek(int(end_of_directory.offset_to_start_of_central_directory), IODevice::seek_set);
+	if (zip64) input.seek(zip64_end_of_directory.offset_to_start_of_central_directory, IODevice::seek_set);
+	else input.seek(end_of_directory.offset_to_start_of_central_directory, IODevice::seek_set);
 
 	byte64 num_entries = end_of_directory.number_of_entries_in_central_directory;
 	if (zip64) num_entries = zip64_end_of_directory.number_of_entries_in_central_directory;
@@ -55,14 +55,14 @@ ZipIODevice_FileEntry::~ZipIODevice_FileEntry()
 /////////////////////////////////////////////////////////////////////////////
 // ZipIODevice_FileEntry attributes:
 
-int ZipIODevice_FileEntry::get_size() const
+byte64 ZipIODevice_FileEntry::get_size() const
 {
 	return file_header.uncompressed_size;
 }
 
-int ZipIODevice_FileEntry::get_position() const
+byte64 ZipIODevice_FileEntry::get_position() const
 {
-	return (int) pos;
+	return pos;
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -116,7 +116,7 @@ int ZipIODevice_FileEntry::peek(void *data, int len)
 	}
 }
 
-bool ZipIODevice_FileEntry::seek(int seek_pos, IODevice::SeekMode mode)
+bool ZipIODevice_FileEntry::seek(byte64 seek_pos, IODevice::SeekMode mode)
 {
 	byte64 absolute_pos = 0;
 	switch (mode)
@@ -137,7 +137,7 @@ bool ZipIODevice_FileEntry::seek(int seek_pos, IODevice::SeekMode mode)
 	switch (file_header.compression_method)
 	{
 	case zip_compress_store: // no compression
-		iodevice.seek(int(absolute_pos-pos), IODevice::seek_cur);
+		iodevice.seek(absolute_pos-pos, IODevice::seek_cur);
 		break;
 
 	case zip_compress_deflate:
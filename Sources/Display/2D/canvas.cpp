@@ -80,6 +80,15 @@ Canvas Canvas::create()
 	return copy_canvas;
 }
 
+Canvas Canvas::create_worker()
+{
+	Canvas worker_canvas;
+	worker_canvas.impl = std::shared_ptr<Canvas_Impl>(new Canvas_Impl);
+	worker_canvas.impl->init_worker(impl.get());
+	worker_canvas.set_map_mode(map_2d_upper_left);
+	return worker_canvas;
+}
+
 void Canvas::throw_if_null() const
 {
 	if (!impl)
@@ -121,6 +130,16 @@ PixelBuffer Canvas::get_pixeldata(TextureFormat texture_format, bool clamp)
 	return get_gc().get_pixeldata(texture_format, clamp);
 }
 
+bool Canvas::is_deferred_batching() const
+{
+	return impl->batcher.is_deferred();
+}
+
+CanvasBatchStatistics Canvas::get_batch_statistics() const
+{
+	return impl->batcher.get_statistics();
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // Canvas Operations:
 
@@ -235,6 +254,16 @@ void Canvas::flush()
 	impl->flush();
 }
 
+void Canvas::set_deferred_batching(bool enable)
+{
+	impl->batcher.set_deferred(enable);
+}
+
+void Canvas::reset_batch_statistics()
+{
+	impl->batcher.reset_statistics();
+}
+
 void Canvas::set_modelview(const Mat4f &matrix)
 {
 	impl->set_modelview(matrix);
@@ -45,6 +45,10 @@ public:
 	void flush();
 	bool set_batcher(GraphicContext &gc, RenderBatcher *batcher);
 	void update_batcher_matrix(GraphicContext &gc, const Mat4f &modelview, const Mat4f &projection);
+	void set_deferred(bool enable);
+	void begin_recording(GraphicContext &gc, CanvasDrawList *list);
+	void end_recording();
+	void update_draw_lists();
 
 	GraphicContext current_gc;
 
@@ -55,6 +59,10 @@ public:
 	RenderBatchLine render_batcher_line;
 	RenderBatchLineTexture render_batcher_line_texture;
 	RenderBatchPoint render_batcher_point;
+
+	bool deferred;
+	CanvasDrawList draw_list;
+	CanvasDrawList *recording_list;
 };
 
 CanvasBatcher_Impl::CanvasBatcher_Impl(GraphicContext &gc) : active_batcher(0),
@@ -62,7 +70,9 @@ CanvasBatcher_Impl::CanvasBatcher_Impl(GraphicContext &gc) : active_batcher(0),
 	render_batcher_triangle(gc, &render_batcher_buffer),
 	render_batcher_line(gc, &render_batcher_buffer),
 	render_batcher_line_texture(gc, &render_batcher_buffer),
-	render_batcher_point(gc, &render_batcher_buffer)
+	render_batcher_point(gc, &render_batcher_buffer),
+	deferred(false),
+	recording_list(0)
 {
 
 }
@@ -103,9 +113,69 @@ RenderBatchPoint *CanvasBatcher::get_point_batcher()
 	return &impl->render_batcher_point;
 }
 
+bool CanvasBatcher::is_deferred() const
+{
+	return impl->deferred;
+}
+
+void CanvasBatcher::set_deferred(bool enable)
+{
+	impl->set_deferred(enable);
+}
+
+CanvasBatchStatistics CanvasBatcher::get_statistics() const
+{
+	return impl->draw_list.get_statistics();
+}
+
+void CanvasBatcher::reset_statistics()
+{
+	impl->draw_list.reset_statistics();
+}
+
+void CanvasBatcher::begin_recording(GraphicContext &gc, CanvasDrawList *list)
+{
+	impl->begin_recording(gc, list);
+}
+
+void CanvasBatcher::end_recording()
+{
+	impl->end_recording();
+}
+
+bool CanvasBatcher::is_recording() const
+{
+	return impl->recording_list != 0;
+}
+
+DeferredRenderBatcher *CanvasBatcher::get_matching_batcher(CanvasBatcher &other, DeferredRenderBatcher *other_batcher)
+{
+	if (other_batcher == other.get_triangle_batcher())
+		return get_triangle_batcher();
+	else if (other_batcher == other.get_line_batcher())
+		return get_line_batcher();
+	else if (other_batcher == other.get_line_texture_batcher())
+		return get_line_texture_batcher();
+	else if (other_batcher == other.get_point_batcher())
+		return get_point_batcher();
+	else
+		throw Exception("Unknown render batcher");
+}
+
 void CanvasBatcher_Impl::flush()
 {
-	if (active_batcher)
+	if (recording_list)
+	{
+		// Flushing does not end a recording. State changes made while recording are not part of it.
+		active_batcher = 0;
+	}
+	else if (deferred)
+	{
+		// The batchers only record in deferred mode. Their vertex buffers are filled when the list is submitted.
+		active_batcher = 0;
+		draw_list.submit(current_gc);
+	}
+	else if (active_batcher)
 	{
 		RenderBatcher *batcher = active_batcher;
 		active_batcher = 0;
@@ -113,6 +183,48 @@ void CanvasBatcher_Impl::flush()
 	}
 }
 
+void CanvasBatcher_Impl::set_deferred(bool enable)
+{
+	if (deferred != enable)
+	{
+		flush();
+		deferred = enable;
+		update_draw_lists();
+	}
+}
+
+void CanvasBatcher_Impl::begin_recording(GraphicContext &gc, CanvasDrawList *list)
+{
+	if (recording_list)
+		throw Exception("Canvas is already recording a command list");
+
+	if (gc != current_gc)
+	{
+		flush();
+		current_gc = gc;
+	}
+
+	flush();
+	recording_list = list;
+	update_draw_lists();
+}
+
+void CanvasBatcher_Impl::end_recording()
+{
+	active_batcher = 0;
+	recording_list = 0;
+	update_draw_lists();
+}
+
+void CanvasBatcher_Impl::update_draw_lists()
+{
+	CanvasDrawList *list = recording_list ? recording_list : (deferred ? &draw_list : 0);
+	render_batcher_triangle.set_draw_list(list);
+	render_batcher_line.set_draw_list(list);
+	render_batcher_line_texture.set_draw_list(list);
+	render_batcher_point.set_draw_list(list);
+}
+
 void CanvasBatcher_Impl::update_batcher_matrix(GraphicContext &gc, const Mat4f &modelview, const Mat4f &projection)
 {
 	if (gc != current_gc)
@@ -129,6 +241,17 @@ void CanvasBatcher_Impl::update_batcher_matrix(GraphicContext &gc, const Mat4f &
 
 bool CanvasBatcher_Impl::set_batcher(GraphicContext &gc, RenderBatcher *batcher)
 {
+	if ((deferred || recording_list) && gc == current_gc)
+	{
+		// Switching batchers does not end a batch in deferred mode, but the new batcher still needs the current matrix
+		if (active_batcher != batcher)
+		{
+			active_batcher = batcher;
+			return true;
+		}
+		return false;
+	}
+
 	if ( (active_batcher != batcher) || (gc != current_gc) )
 	{
 		flush();
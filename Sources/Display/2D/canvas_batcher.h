@@ -35,6 +35,7 @@
 #include "Display/2D/render_batch_line.h"
 #include "Display/2D/render_batch_line_texture.h"
 #include "Display/2D/render_batch_point.h"
+#include "Display/2D/canvas_draw_list.h"
 #include "API/Display/2D/canvas.h"
 #include "API/Display/Window/display_window.h"
 
@@ -62,6 +63,19 @@ public:
 	RenderBatchLineTexture *get_line_texture_batcher();
 	RenderBatchPoint *get_point_batcher();
 
+	bool is_deferred() const;
+	void set_deferred(bool enable);
+	CanvasBatchStatistics get_statistics() const;
+	void reset_statistics();
+
+	/// \brief Makes all batchers record into the list until end_recording is called
+	void begin_recording(GraphicContext &gc, CanvasDrawList *list);
+	void end_recording();
+	bool is_recording() const;
+
+	/// \brief Returns the batcher of this object doing the same job as a batcher of another CanvasBatcher
+	DeferredRenderBatcher *get_matching_batcher(CanvasBatcher &other, DeferredRenderBatcher *other_batcher);
+
 private:
 
 	std::shared_ptr<CanvasBatcher_Impl> impl;
@@ -0,0 +1,202 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Display/precomp.h"
+#include "API/Display/2D/canvas_command_list.h"
+#include "API/Display/2D/canvas.h"
+#include "canvas_impl.h"
+#include "canvas_draw_list.h"
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// CanvasCommandList_Impl Class:
+
+class CanvasCommandList_Impl
+{
+public:
+	CanvasCommandList_Impl(const CanvasBatcher &batcher) : batcher(batcher), recording(false), recorded(false) { }
+	~CanvasCommandList_Impl()
+	{
+		if (recording)
+			batcher.end_recording();
+	}
+
+	void check_batcher(Canvas_Impl *canvas);
+	void upload(GraphicContext &gc, CanvasRecordedBatch &batch, const Mat4f &transform);
+
+	CanvasBatcher batcher;
+	CanvasDrawList draw_list;
+	std::vector<CanvasRecordedBatch> batches;
+	Mat4f inverse_record_transform;
+	bool recording;
+	bool recorded;
+	std::vector<char> transformed_vertices;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// CanvasCommandList Construction:
+
+CanvasCommandList::CanvasCommandList()
+{
+}
+
+CanvasCommandList::CanvasCommandList(Canvas &canvas) : impl(new CanvasCommandList_Impl(canvas.impl->batcher))
+{
+}
+
+CanvasCommandList::~CanvasCommandList()
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CanvasCommandList Attributes:
+
+void CanvasCommandList::throw_if_null() const
+{
+	if (!impl)
+		throw Exception("CanvasCommandList is null");
+}
+
+bool CanvasCommandList::is_recording() const
+{
+	return impl->recording;
+}
+
+bool CanvasCommandList::is_recorded() const
+{
+	return impl->recorded;
+}
+
+int CanvasCommandList::get_batch_count() const
+{
+	return (int)impl->batches.size();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CanvasCommandList Operations:
+
+void CanvasCommandList::begin(Canvas &canvas)
+{
+	throw_if_null();
+	impl->check_batcher(canvas.impl.get());
+	if (impl->recording)
+		throw Exception("CanvasCommandList is already recording");
+
+	invalidate();
+	canvas.flush();
+
+	// Recorded vertices are in clip space. Keep the way back to the space the list was drawn in.
+	impl->inverse_record_transform = Mat4f::inverse(canvas.get_projection() * canvas.get_modelview());
+
+	impl->batcher.begin_recording(canvas.get_gc(), &impl->draw_list);
+	impl->recording = true;
+}
+
+void CanvasCommandList::end(Canvas &canvas)
+{
+	throw_if_null();
+	if (!impl->recording)
+		throw Exception("CanvasCommandList is not recording");
+
+	impl->draw_list.compile(canvas.get_gc(), impl->batches);
+	impl->batcher.end_recording();
+	impl->recording = false;
+	impl->recorded = true;
+}
+
+void CanvasCommandList::draw(Canvas &canvas)
+{
+	throw_if_null();
+	if (impl->recording)
+		throw Exception("CanvasCommandList cannot be drawn while it is recording");
+
+	if (impl->batches.empty())
+		return;
+
+	canvas.flush();
+
+	GraphicContext &gc = canvas.get_gc();
+	CanvasBatcher &target = canvas.impl->batcher;
+	bool same_batcher = target.get_triangle_batcher() == impl->batcher.get_triangle_batcher();
+
+	Mat4f transform = canvas.get_projection() * canvas.get_modelview() * impl->inverse_record_transform;
+	for (size_t i = 0; i < impl->batches.size(); i++)
+	{
+		CanvasRecordedBatch &batch = impl->batches[i];
+		if (batch.num_vertices == 0)
+			continue;
+
+		if (!batch.uploaded || batch.uploaded_transform != transform)
+			impl->upload(gc, batch, transform);
+
+		// Lists recorded on a worker canvas are drawn by the batchers of the canvas owning the graphic context
+		DeferredRenderBatcher *batcher = same_batcher ? batch.batcher : target.get_matching_batcher(impl->batcher, batch.batcher);
+		batcher->draw_recorded(gc, batch);
+	}
+}
+
+void CanvasCommandList::invalidate()
+{
+	throw_if_null();
+	impl->batches.clear();
+	impl->recorded = false;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CanvasCommandList_Impl Implementation:
+
+void CanvasCommandList_Impl::check_batcher(Canvas_Impl *canvas)
+{
+	if (canvas->batcher.get_triangle_batcher() != batcher.get_triangle_batcher())
+		throw Exception("CanvasCommandList can only be recorded on the canvas it was created for");
+}
+
+void CanvasCommandList_Impl::upload(GraphicContext &gc, CanvasRecordedBatch &batch, const Mat4f &transform)
+{
+	int size = (int)batch.vertices.size();
+	int stride = size / batch.num_vertices;
+
+	transformed_vertices = batch.vertices;
+	for (int i = 0; i < batch.num_vertices; i++)
+	{
+		Vec4f &position = *(Vec4f *)(&transformed_vertices[i * stride]);
+		position = transform * position;
+	}
+
+	if (batch.gpu_vertices.is_null())
+		batch.gpu_vertices = VertexArrayBuffer(gc, &transformed_vertices[0], size, usage_dynamic_draw);
+	else
+		batch.gpu_vertices.upload_data(gc, 0, &transformed_vertices[0], size);
+
+	batch.uploaded_transform = transform;
+	batch.uploaded = true;
+}
+
+}
@@ -0,0 +1,238 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Display/precomp.h"
+#include "canvas_draw_list.h"
+#include "API/Display/Render/graphic_context.h"
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// CanvasDrawList Construction:
+
+CanvasDrawList::CanvasDrawList()
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CanvasDrawList Operations:
+
+void CanvasDrawList::add(const CanvasDrawItem &item)
+{
+	items.push_back(item);
+	statistics.draws_recorded++;
+}
+
+void CanvasDrawList::submit(GraphicContext &gc)
+{
+	if (items.empty())
+		return;
+
+	build_batches(gc);
+
+	for (size_t i = 0; i < batches.size(); i++)
+		batches[i].batcher->draw_deferred(gc, items, batches[i].items);
+
+	statistics.batches_submitted += batches.size();
+	statistics.lists_submitted++;
+
+	clear();
+}
+
+void CanvasDrawList::compile(GraphicContext &gc, std::vector<CanvasRecordedBatch> &out_batches)
+{
+	out_batches.clear();
+	if (items.empty())
+		return;
+
+	build_batches(gc);
+
+	out_batches.resize(batches.size());
+	for (size_t i = 0; i < batches.size(); i++)
+	{
+		CanvasRecordedBatch &out = out_batches[i];
+		out.batcher = batches[i].batcher;
+		out.glyph_program = batches[i].glyph_program;
+		out.constant_color = batches[i].constant_color;
+		out.textures = batches[i].textures;
+		batches[i].batcher->record_deferred(items, batches[i].items, out);
+	}
+
+	clear();
+}
+
+void CanvasDrawList::clear()
+{
+	for (size_t i = 0; i < items.size(); i++)
+		items[i].batcher->clear_deferred();
+	items.clear();
+	batches.clear();
+}
+
+Rectf CanvasDrawList::get_bounds(const Vec4f *first_position, int stride, int count)
+{
+	const char *data = (const char *)first_position;
+	Rectf bounds(1e30f, 1e30f, -1e30f, -1e30f);
+	for (int i = 0; i < count; i++)
+	{
+		const Vec4f &position = *(const Vec4f *)(data + i * stride);
+
+		// Anything crossing the w=0 plane may cover the whole viewport
+		if (position.w <= 0.0f)
+			return Rectf(-1e30f, -1e30f, 1e30f, 1e30f);
+
+		float x = position.x / position.w;
+		float y = position.y / position.w;
+		bounds.left = min(bounds.left, x);
+		bounds.top = min(bounds.top, y);
+		bounds.right = max(bounds.right, x);
+		bounds.bottom = max(bounds.bottom, y);
+	}
+	return bounds;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CanvasDrawList Implementation:
+
+void CanvasDrawList::build_batches(GraphicContext &gc)
+{
+	Size viewport_size = gc.get_size();
+	Sizef pixel_size(2.0f / max(viewport_size.width, 1), 2.0f / max(viewport_size.height, 1));
+
+	Batch in_draw_order;
+	batches.clear();
+
+	for (int index = 0; index < (int)items.size(); index++)
+	{
+		const CanvasDrawItem &item = items[index];
+		Rectf bounds = item.batcher->get_deferred_bounds(item, pixel_size);
+
+		// Count what the draw order alone would have needed:
+		if (in_draw_order.items.empty() || !is_compatible(in_draw_order, item))
+		{
+			statistics.batches_in_draw_order++;
+			in_draw_order = Batch();
+		}
+		add_to_batch(in_draw_order, index, item, bounds);
+
+		// Find the last batch this item has to be drawn after. Batches outside the search window are assumed to overlap.
+		int first_batch = max((int)batches.size() - (int)search_window, 0);
+		int last_overlap = first_batch - 1;
+		for (int i = (int)batches.size() - 1; i >= first_batch; i--)
+		{
+			if (batches[i].bounds.is_overlapped(bounds))
+			{
+				last_overlap = i;
+				break;
+			}
+		}
+
+		// Join the earliest batch with matching state that is not drawn before anything we overlap
+		int target = -1;
+		for (int i = max(last_overlap, 0); i < (int)batches.size(); i++)
+		{
+			if (is_compatible(batches[i], item))
+			{
+				target = i;
+				break;
+			}
+		}
+
+		if (target == -1)
+		{
+			batches.push_back(Batch());
+			target = (int)batches.size() - 1;
+		}
+		add_to_batch(batches[target], index, item, bounds);
+	}
+}
+
+bool CanvasDrawList::is_compatible(const Batch &batch, const CanvasDrawItem &item)
+{
+	if (batch.batcher != item.batcher || batch.glyph_program != item.glyph_program)
+		return false;
+
+	if (batch.glyph_program && batch.constant_color != item.constant_color)
+		return false;
+
+	if (batch.num_vertices + item.num_vertices > item.batcher->get_max_deferred_vertices())
+		return false;
+
+	if (!item.texture.is_null())
+	{
+		bool found = false;
+		for (size_t i = 0; i < batch.textures.size(); i++)
+		{
+			if (batch.textures[i] == item.texture)
+			{
+				found = true;
+				break;
+			}
+		}
+		if (!found && (int)batch.textures.size() >= item.batcher->get_max_deferred_textures())
+			return false;
+	}
+
+	return true;
+}
+
+void CanvasDrawList::add_to_batch(Batch &batch, int index, const CanvasDrawItem &item, const Rectf &bounds)
+{
+	if (batch.items.empty())
+	{
+		batch.batcher = item.batcher;
+		batch.glyph_program = item.glyph_program;
+		batch.constant_color = item.constant_color;
+		batch.bounds = bounds;
+	}
+	else
+	{
+		batch.bounds.bounding_rect(bounds);
+	}
+
+	if (!item.texture.is_null())
+	{
+		bool found = false;
+		for (size_t i = 0; i < batch.textures.size(); i++)
+		{
+			if (batch.textures[i] == item.texture)
+			{
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+			batch.textures.push_back(item.texture);
+	}
+
+	batch.num_vertices += item.num_vertices;
+	batch.items.push_back(index);
+}
+
+}
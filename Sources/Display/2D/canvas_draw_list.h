@@ -0,0 +1,164 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Display/Render/render_batcher.h"
+#include "API/Display/Render/texture_2d.h"
+#include "API/Display/Render/vertex_array_buffer.h"
+#include "API/Display/Render/primitives_array.h"
+#include "API/Display/2D/color.h"
+#include "API/Display/2D/canvas_batch_statistics.h"
+#include "API/Core/Math/rect.h"
+#include "API/Core/Math/vec4.h"
+#include <vector>
+
+namespace clan
+{
+
+class DeferredRenderBatcher;
+
+/// \brief One draw call recorded while a canvas is in deferred batching mode
+///
+/// The vertices are stored, already transformed to clip space, by the batcher that recorded the item.
+class CanvasDrawItem
+{
+public:
+	CanvasDrawItem() : batcher(0), glyph_program(false), constant_color(Colorf::black), first_vertex(0), num_vertices(0) { }
+
+	DeferredRenderBatcher *batcher;
+	Texture2D texture;
+	bool glyph_program;
+	Colorf constant_color;
+	int first_vertex;
+	int num_vertices;
+};
+
+/// \brief Batch kept by a CanvasCommandList, stored in the vertex format of its batcher
+class CanvasRecordedBatch
+{
+public:
+	CanvasRecordedBatch() : batcher(0), glyph_program(false), constant_color(Colorf::black), num_vertices(0), uploaded(false) { }
+
+	DeferredRenderBatcher *batcher;
+	bool glyph_program;
+	Colorf constant_color;
+	std::vector<Texture2D> textures;
+	int num_vertices;
+
+	/// \brief Vertices in clip space at recording time. Every vertex format starts with a Vec4f position.
+	std::vector<char> vertices;
+
+	VertexArrayBuffer gpu_vertices;
+	PrimitivesArray prim_array;
+	Mat4f uploaded_transform;
+	bool uploaded;
+};
+
+/// \brief Render batcher able to record draw calls into a CanvasDrawList and replay them later
+class DeferredRenderBatcher : public RenderBatcher
+{
+public:
+	/// \brief Returns the clip space bounding box of the vertices recorded for an item
+	virtual Rectf get_deferred_bounds(const CanvasDrawItem &item, const Sizef &pixel_size) const = 0;
+
+	/// \brief Returns how many different textures a single batch can use
+	virtual int get_max_deferred_textures() const = 0;
+
+	/// \brief Returns how many vertices a single batch can hold
+	virtual int get_max_deferred_vertices() const = 0;
+
+	/// \brief Draws the listed items as a single batch
+	virtual void draw_deferred(GraphicContext &gc, const std::vector<CanvasDrawItem> &items, const std::vector<int> &batch) = 0;
+
+	/// \brief Copies the listed items into a batch kept by a command list
+	virtual void record_deferred(const std::vector<CanvasDrawItem> &items, const std::vector<int> &batch, CanvasRecordedBatch &out) = 0;
+
+	/// \brief Draws a batch kept by a command list from its vertex buffer
+	virtual void draw_recorded(GraphicContext &gc, CanvasRecordedBatch &batch) = 0;
+
+	/// \brief Discards all recorded vertices
+	virtual void clear_deferred() = 0;
+};
+
+/// \brief Deferred draw list sorting canvas draw calls into as few batches as possible
+///
+/// Items are moved into an earlier batch with matching state as long as they do not overlap
+/// anything drawn in between, which keeps the result identical to drawing in submission order.
+class CanvasDrawList
+{
+public:
+	CanvasDrawList();
+
+	bool is_empty() const { return items.empty(); }
+
+	const CanvasBatchStatistics &get_statistics() const { return statistics; }
+	void reset_statistics() { statistics = CanvasBatchStatistics(); }
+
+	void add(const CanvasDrawItem &item);
+
+	/// \brief Sorts the recorded items, draws them and clears the list
+	void submit(GraphicContext &gc);
+
+	/// \brief Sorts the recorded items into batches kept by a command list and clears the list
+	void compile(GraphicContext &gc, std::vector<CanvasRecordedBatch> &out_batches);
+
+	/// \brief Clears the list without drawing anything
+	void clear();
+
+	/// \brief Bounding box of a run of clip space positions stored with the given byte stride
+	static Rectf get_bounds(const Vec4f *first_position, int stride, int count);
+
+private:
+	struct Batch
+	{
+		Batch() : batcher(0), glyph_program(false), num_vertices(0) { }
+
+		DeferredRenderBatcher *batcher;
+		bool glyph_program;
+		Colorf constant_color;
+		std::vector<Texture2D> textures;
+		int num_vertices;
+		Rectf bounds;
+		std::vector<int> items;
+	};
+
+	void build_batches(GraphicContext &gc);
+
+	static bool is_compatible(const Batch &batch, const CanvasDrawItem &item);
+	static void add_to_batch(Batch &batch, int index, const CanvasDrawItem &item, const Rectf &bounds);
+
+	/// \brief Number of batches searched backwards for a matching state
+	enum { search_window = 64 };
+
+	std::vector<CanvasDrawItem> items;
+	std::vector<Batch> batches;
+	CanvasBatchStatistics statistics;
+};
+
+}
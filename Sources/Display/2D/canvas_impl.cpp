@@ -37,7 +37,7 @@
 namespace clan
 {
 
-Canvas_Impl::Canvas_Impl() : canvas_map_mode(map_user_projection)
+Canvas_Impl::Canvas_Impl() : canvas_map_mode(map_user_projection), worker(false)
 {
 }
 
@@ -63,7 +63,16 @@ void Canvas_Impl::init(DisplayWindow &window)
 	setup(new_gc);
 }
 
-void Canvas_Impl::setup(GraphicContext &new_gc)
+void Canvas_Impl::init_worker(Canvas_Impl *canvas)
+{
+	// A worker canvas has its own batchers and never touches the graphic context after this point.
+	// It does not follow window resizes - CanvasCommandList maps its output to the canvas it is drawn on.
+	GraphicContext new_gc = canvas->get_gc().create();
+	worker = true;
+	setup(new_gc, false);
+}
+
+void Canvas_Impl::setup(GraphicContext &new_gc, bool follow_window)
 {
 	gc = new_gc;
 
@@ -78,7 +87,8 @@ void Canvas_Impl::setup(GraphicContext &new_gc)
 	if (gc.get_write_frame_buffer().is_null())	// No framebuffer attached to canvas
 	{
 		canvas_y_axis = y_axis_top_down;
-		slot_window_resized = gc.get_provider()->sig_window_resized().connect(this, &Canvas_Impl::on_window_resized);
+		if (follow_window)
+			slot_window_resized = gc.get_provider()->sig_window_resized().connect(this, &Canvas_Impl::on_window_resized);
 	}
 	else
 	{
@@ -119,6 +129,9 @@ void Canvas_Impl::update_batcher_matrix()
 
 void Canvas_Impl::set_batcher(Canvas &canvas, RenderBatcher *new_batcher)
 {
+	if (worker && !batcher.is_recording())
+		throw Exception("Worker canvases can only be drawn on while recording a CanvasCommandList");
+
 	if (batcher.set_batcher(canvas, new_batcher))
 		update_batcher_matrix();
 }
@@ -54,6 +54,7 @@ public:
 	void init(Canvas_Impl *canvas);
 	void init(Canvas_Impl *canvas, FrameBuffer &framebuffer);
 	void init(DisplayWindow &window);
+	void init_worker(Canvas_Impl *canvas);
 
 	void clear(const Colorf &color);
 
@@ -87,7 +88,7 @@ public:
 	CanvasBatcher batcher;
 
 private:
-	void setup(GraphicContext &new_gc);
+	void setup(GraphicContext &new_gc, bool follow_window = true);
 	void calculate_map_mode_matrices();
 	MapMode get_top_down_map_mode() const;
 	void on_window_resized(const Size &size);
@@ -112,6 +113,8 @@ private:
 	ClipZRange gc_clip_z_range;
 
 	Slot slot_window_flip;
+
+	bool worker;
 };
 
 }
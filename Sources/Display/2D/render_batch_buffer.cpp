@@ -38,16 +38,16 @@ namespace clan
 
 RenderBatchBuffer::RenderBatchBuffer(GraphicContext &gc) : current_vertex_buffer(0)
 {
-	for (int index=0; index < num_vertex_buffers; index++)
-	{
-		vertex_buffers[index] = VertexArrayBuffer(gc, vertex_buffer_size, usage_stream_draw);
-	}
 }
 
 VertexArrayBuffer RenderBatchBuffer::get_vertex_buffer(GraphicContext &gc, int &out_index)
 {
 	out_index = current_vertex_buffer;
 
+	// Created on first use, so batchers that only ever record (worker canvases) do not allocate any GPU memory
+	if (vertex_buffers[out_index].is_null())
+		vertex_buffers[out_index] = VertexArrayBuffer(gc, vertex_buffer_size, usage_stream_draw);
+
 	current_vertex_buffer++;
 	if (current_vertex_buffer == num_vertex_buffers)
 		current_vertex_buffer = 0;
@@ -36,7 +36,7 @@ namespace clan
 {
 
 RenderBatchLine::RenderBatchLine(GraphicContext &gc, RenderBatchBuffer *batch_buffer)
-: position(0), batch_buffer(batch_buffer)
+: position(0), batch_buffer(batch_buffer), draw_list(0)
 {
 	vertices = (LineVertex *) batch_buffer->buffer;
 }
@@ -100,6 +100,12 @@ void RenderBatchLine::draw_line_strip(Canvas &canvas, const Vec2f *line_position
 
 void RenderBatchLine::set_batcher_active(Canvas &canvas, int num_vertices)
 {
+	if (draw_list)
+	{
+		set_deferred_active(canvas, num_vertices, Texture2D());
+		return;
+	}
+
 	if (position+num_vertices > max_vertices)
 		canvas.flush();
 
@@ -119,11 +125,7 @@ void RenderBatchLine::flush(GraphicContext &gc)
 		VertexArrayVector<LineVertex> gpu_vertices(batch_buffer->get_vertex_buffer(gc, gpu_index));
 
 		if (prim_array[gpu_index].is_null())
-		{
-			prim_array[gpu_index] = PrimitivesArray(gc);
-			prim_array[gpu_index].set_attributes(0, gpu_vertices, cl_offsetof(LineVertex, position));
-			prim_array[gpu_index].set_attributes(1, gpu_vertices, cl_offsetof(LineVertex, color));
-		}
+			prim_array[gpu_index] = create_primitives_array(gc, gpu_vertices);
 
 		gpu_vertices.upload_data(gc, 0, vertices, position);
 
@@ -140,4 +142,98 @@ void RenderBatchLine::matrix_changed(const Mat4f &new_modelview, const Mat4f &ne
 	modelview_projection_matrix = new_projection * new_modelview;
 }
 
+void RenderBatchLine::set_deferred_active(Canvas &canvas, int num_vertices, const Texture2D &texture)
+{
+	if (num_vertices > max_vertices)
+		throw Exception("Too many vertices for RenderBatchLine");
+
+	// An empty item would have no vertex to take its bounds from
+	if (num_vertices == 0)
+		return;
+
+	canvas.set_batcher(this);
+
+	CanvasDrawItem item;
+	item.batcher = this;
+	item.texture = texture;
+	item.first_vertex = (int)deferred_vertices.size();
+	item.num_vertices = num_vertices;
+	draw_list->add(item);
+
+	deferred_vertices.resize(item.first_vertex + num_vertices);
+	vertices = &deferred_vertices[0];
+	position = item.first_vertex;
+}
+
+void RenderBatchLine::set_draw_list(CanvasDrawList *new_draw_list)
+{
+	draw_list = new_draw_list;
+	deferred_vertices.clear();
+	vertices = (LineVertex *) batch_buffer->buffer;
+	position = 0;
+}
+
+Rectf RenderBatchLine::get_deferred_bounds(const CanvasDrawItem &item, const Sizef &pixel_size) const
+{
+	Rectf bounds = CanvasDrawList::get_bounds(&deferred_vertices[item.first_vertex].position, sizeof(LineVertex), item.num_vertices);
+	return bounds.expand(pixel_size.width, pixel_size.height);
+}
+
+void RenderBatchLine::draw_deferred(GraphicContext &gc, const std::vector<CanvasDrawItem> &items, const std::vector<int> &batch)
+{
+	vertices = (LineVertex *) batch_buffer->buffer;
+	position = 0;
+
+	for (size_t i = 0; i < batch.size(); i++)
+	{
+		const CanvasDrawItem &item = items[batch[i]];
+		for (int j = 0; j < item.num_vertices; j++)
+			vertices[position++] = deferred_vertices[item.first_vertex + j];
+	}
+
+	flush(gc);
+}
+
+PrimitivesArray RenderBatchLine::create_primitives_array(GraphicContext &gc, VertexArrayVector<LineVertex> &gpu_vertices)
+{
+	PrimitivesArray prim_array(gc);
+	prim_array.set_attributes(0, gpu_vertices, cl_offsetof(LineVertex, position));
+	prim_array.set_attributes(1, gpu_vertices, cl_offsetof(LineVertex, color));
+	return prim_array;
+}
+
+void RenderBatchLine::record_deferred(const std::vector<CanvasDrawItem> &items, const std::vector<int> &batch, CanvasRecordedBatch &out)
+{
+	out.num_vertices = 0;
+	for (size_t i = 0; i < batch.size(); i++)
+		out.num_vertices += items[batch[i]].num_vertices;
+	out.vertices.resize(out.num_vertices * sizeof(LineVertex));
+
+	LineVertex *dest = (LineVertex *) &out.vertices[0];
+	for (size_t i = 0; i < batch.size(); i++)
+	{
+		const CanvasDrawItem &item = items[batch[i]];
+		for (int j = 0; j < item.num_vertices; j++)
+			*(dest++) = deferred_vertices[item.first_vertex + j];
+	}
+}
+
+void RenderBatchLine::draw_recorded(GraphicContext &gc, CanvasRecordedBatch &batch)
+{
+	if (batch.prim_array.is_null())
+	{
+		VertexArrayVector<LineVertex> gpu_vertices(batch.gpu_vertices);
+		batch.prim_array = create_primitives_array(gc, gpu_vertices);
+	}
+
+	gc.set_program_object(program_color_only);
+	gc.draw_primitives(type_lines, batch.num_vertices, batch.prim_array);
+	gc.reset_program_object();
+}
+
+void RenderBatchLine::clear_deferred()
+{
+	deferred_vertices.clear();
+}
+
 }
@@ -33,18 +33,22 @@
 #include "API/Display/Render/graphic_context.h"
 #include "API/Display/Render/blend_state.h"
 #include "render_batch_buffer.h"
+#include "canvas_draw_list.h"
 
 namespace clan
 {
 class RenderBatchBuffer;
 
-class RenderBatchLine : public RenderBatcher
+class RenderBatchLine : public DeferredRenderBatcher
 {
 public:
 	RenderBatchLine(GraphicContext &gc, RenderBatchBuffer *batch_buffer);
 	void draw_line_strip(Canvas &canvas, const Vec2f *line_positions, const Vec4f &line_color, int num_vertices);
 	void draw_lines(Canvas &canvas, const Vec2f *line_positions, const Vec4f &line_color, int num_vertices);
 
+	/// \brief Records draw calls into the list instead of the vertex buffer. Pass null to draw immediately again.
+	void set_draw_list(CanvasDrawList *draw_list);
+
 private:
 	struct LineVertex
 	{
@@ -54,9 +58,20 @@ private:
 
 	inline Vec4f to_position(float x, float y) const;
 	void set_batcher_active(Canvas &canvas, int num_vertices);
+	void set_deferred_active(Canvas &canvas, int num_vertices, const Texture2D &texture);
 	void flush(GraphicContext &gc);
 	void matrix_changed(const Mat4f &modelview, const Mat4f &projection);
 
+	Rectf get_deferred_bounds(const CanvasDrawItem &item, const Sizef &pixel_size) const;
+	int get_max_deferred_textures() const { return 0; }
+	int get_max_deferred_vertices() const { return max_vertices; }
+	void draw_deferred(GraphicContext &gc, const std::vector<CanvasDrawItem> &items, const std::vector<int> &batch);
+	void record_deferred(const std::vector<CanvasDrawItem> &items, const std::vector<int> &batch, CanvasRecordedBatch &out);
+	void draw_recorded(GraphicContext &gc, CanvasRecordedBatch &batch);
+	void clear_deferred();
+
+	PrimitivesArray create_primitives_array(GraphicContext &gc, VertexArrayVector<LineVertex> &gpu_vertices);
+
 	enum { max_vertices = RenderBatchBuffer::vertex_buffer_size / sizeof(LineVertex) };
 	LineVertex *vertices;
 	RenderBatchBuffer *batch_buffer;
@@ -64,6 +79,9 @@ private:
 	int position;
 	Mat4f modelview_projection_matrix;
 
+	CanvasDrawList *draw_list;
+	std::vector<LineVertex> deferred_vertices;
+
 
 };
 
@@ -36,7 +36,7 @@ namespace clan
 {
 
 RenderBatchPoint::RenderBatchPoint(GraphicContext &gc, RenderBatchBuffer *batch_buffer)
-: position(0), batch_buffer(batch_buffer)
+: position(0), batch_buffer(batch_buffer), draw_list(0)
 {
 	vertices = (PointVertex *) batch_buffer->buffer;
 }
@@ -67,6 +67,12 @@ inline Vec4f RenderBatchPoint::to_position(float x, float y) const
 
 void RenderBatchPoint::set_batcher_active(Canvas &canvas, int num_vertices)
 {
+	if (draw_list)
+	{
+		set_deferred_active(canvas, num_vertices, Texture2D());
+		return;
+	}
+
 	if (position+num_vertices > max_vertices)
 		canvas.flush();
 
@@ -86,11 +92,7 @@ void RenderBatchPoint::flush(GraphicContext &gc)
 		VertexArrayVector<PointVertex> gpu_vertices(batch_buffer->get_vertex_buffer(gc, gpu_index));
 
 		if (prim_array[gpu_index].is_null())
-		{
-			prim_array[gpu_index] = PrimitivesArray(gc);
-			prim_array[gpu_index].set_attributes(0, gpu_vertices, cl_offsetof(PointVertex, position));
-			prim_array[gpu_index].set_attributes(1, gpu_vertices, cl_offsetof(PointVertex, color));
-		}
+			prim_array[gpu_index] = create_primitives_array(gc, gpu_vertices);
 
 		gpu_vertices.upload_data(gc, 0, vertices, position);
 
@@ -107,4 +109,98 @@ void RenderBatchPoint::matrix_changed(const Mat4f &new_modelview, const Mat4f &n
 	modelview_projection_matrix = new_projection * new_modelview;
 }
 
+void RenderBatchPoint::set_deferred_active(Canvas &canvas, int num_vertices, const Texture2D &texture)
+{
+	if (num_vertices > max_vertices)
+		throw Exception("Too many vertices for RenderBatchPoint");
+
+	// An empty item would have no vertex to take its bounds from
+	if (num_vertices == 0)
+		return;
+
+	canvas.set_batcher(this);
+
+	CanvasDrawItem item;
+	item.batcher = this;
+	item.texture = texture;
+	item.first_vertex = (int)deferred_vertices.size();
+	item.num_vertices = num_vertices;
+	draw_list->add(item);
+
+	deferred_vertices.resize(item.first_vertex + num_vertices);
+	vertices = &deferred_vertices[0];
+	position = item.first_vertex;
+}
+
+void RenderBatchPoint::set_draw_list(CanvasDrawList *new_draw_list)
+{
+	draw_list = new_draw_list;
+	deferred_vertices.clear();
+	vertices = (PointVertex *) batch_buffer->buffer;
+	position = 0;
+}
+
+Rectf RenderBatchPoint::get_deferred_bounds(const CanvasDrawItem &item, const Sizef &pixel_size) const
+{
+	Rectf bounds = CanvasDrawList::get_bounds(&deferred_vertices[item.first_vertex].position, sizeof(PointVertex), item.num_vertices);
+	return bounds.expand(pixel_size.width, pixel_size.height);
+}
+
+void RenderBatchPoint::draw_deferred(GraphicContext &gc, const std::vector<CanvasDrawItem> &items, const std::vector<int> &batch)
+{
+	vertices = (PointVertex *) batch_buffer->buffer;
+	position = 0;
+
+	for (size_t i = 0; i < batch.size(); i++)
+	{
+		const CanvasDrawItem &item = items[batch[i]];
+		for (int j = 0; j < item.num_vertices; j++)
+			vertices[position++] = deferred_vertices[item.first_vertex + j];
+	}
+
+	flush(gc);
+}
+
+PrimitivesArray RenderBatchPoint::create_primitives_array(GraphicContext &gc, VertexArrayVector<PointVertex> &gpu_vertices)
+{
+	PrimitivesArray prim_array(gc);
+	prim_array.set_attributes(0, gpu_vertices, cl_offsetof(PointVertex, position));
+	prim_array.set_attributes(1, gpu_vertices, cl_offsetof(PointVertex, color));
+	return prim_array;
+}
+
+void RenderBatchPoint::record_deferred(const std::vector<CanvasDrawItem> &items, const std::vector<int> &batch, CanvasRecordedBatch &out)
+{
+	out.num_vertices = 0;
+	for (size_t i = 0; i < batch.size(); i++)
+		out.num_vertices += items[batch[i]].num_vertices;
+	out.vertices.resize(out.num_vertices * sizeof(PointVertex));
+
+	PointVertex *dest = (PointVertex *) &out.vertices[0];
+	for (size_t i = 0; i < batch.size(); i++)
+	{
+		const CanvasDrawItem &item = items[batch[i]];
+		for (int j = 0; j < item.num_vertices; j++)
+			*(dest++) = deferred_vertices[item.first_vertex + j];
+	}
+}
+
+void RenderBatchPoint::draw_recorded(GraphicContext &gc, CanvasRecordedBatch &batch)
+{
+	if (batch.prim_array.is_null())
+	{
+		VertexArrayVector<PointVertex> gpu_vertices(batch.gpu_vertices);
+		batch.prim_array = create_primitives_array(gc, gpu_vertices);
+	}
+
+	gc.set_program_object(program_color_only);
+	gc.draw_primitives(type_points, batch.num_vertices, batch.prim_array);
+	gc.reset_program_object();
+}
+
+void RenderBatchPoint::clear_deferred()
+{
+	deferred_vertices.clear();
+}
+
 }
@@ -40,7 +40,7 @@ namespace clan
 int RenderBatchTriangle::max_textures = 4;	// For use by the GL1 target, so it can reduce the number of textures
 
 RenderBatchTriangle::RenderBatchTriangle(GraphicContext &gc, RenderBatchBuffer *batch_buffer)
-: position(0), num_current_textures(0), use_glyph_program(false), batch_buffer(batch_buffer)
+: position(0), num_current_textures(0), use_glyph_program(false), batch_buffer(batch_buffer), draw_list(0)
 {
 	vertices = (SpriteVertex *) batch_buffer->buffer;
 }
@@ -91,7 +91,7 @@ void RenderBatchTriangle::fill_triangle(Canvas &canvas, const Vec2f *triangle_po
 
 void RenderBatchTriangle::fill_triangles(Canvas &canvas, const Vec2f *positions, const Vec2f *texture_positions, int num_vertices, const Texture2D &texture, const Colorf &color)
 {
-	int texindex = set_batcher_active(canvas, texture);
+	int texindex = set_batcher_active(canvas, texture, false, Colorf::black, num_vertices);
 
 	for (; num_vertices > 0; num_vertices--)
 	{
@@ -107,7 +107,7 @@ void RenderBatchTriangle::fill_triangles(Canvas &canvas, const Vec2f *positions,
 
 void RenderBatchTriangle::fill_triangles(Canvas &canvas, const Vec2f *positions, const Vec2f *texture_positions, int num_vertices, const Texture2D &texture, const Colorf *colors)
 {
-	int texindex = set_batcher_active(canvas, texture);
+	int texindex = set_batcher_active(canvas, texture, false, Colorf::black, num_vertices);
 
 	for (; num_vertices > 0; num_vertices--)
 	{
@@ -241,8 +241,14 @@ inline Vec4f RenderBatchTriangle::to_position(float x, float y) const
 }
 
 
-int RenderBatchTriangle::set_batcher_active(Canvas &canvas, const Texture2D &texture, bool glyph_program, const Colorf &new_constant_color)
+int RenderBatchTriangle::set_batcher_active(Canvas &canvas, const Texture2D &texture, bool glyph_program, const Colorf &new_constant_color, int num_vertices)
 {
+	if (draw_list)
+		return set_deferred_active(canvas, texture, glyph_program, new_constant_color, num_vertices);
+
+	if (num_vertices > max_vertices)
+		throw Exception("Too many vertices for RenderBatchTriangle");
+
 	if (use_glyph_program != glyph_program || constant_color != new_constant_color)
 	{
 		canvas.flush();
@@ -266,7 +272,7 @@ int RenderBatchTriangle::set_batcher_active(Canvas &canvas, const Texture2D &tex
 		tex_sizes[texindex] = Sizef((float)current_textures[texindex].get_width(), (float)current_textures[texindex].get_height());
 	}
 
-	if (position == 0 || position+6 > max_vertices || texindex == -1)
+	if (position == 0 || position+num_vertices > max_vertices || texindex == -1)
 	{
 		canvas.flush();
 		texindex = 0;
@@ -280,6 +286,9 @@ int RenderBatchTriangle::set_batcher_active(Canvas &canvas, const Texture2D &tex
 
 int RenderBatchTriangle::set_batcher_active(Canvas &canvas)
 {
+	if (draw_list)
+		return set_deferred_active(canvas, Texture2D(), false, Colorf::black, 6);
+
 	if (use_glyph_program != false)
 	{
 		canvas.flush();
@@ -294,6 +303,9 @@ int RenderBatchTriangle::set_batcher_active(Canvas &canvas)
 
 int RenderBatchTriangle::set_batcher_active(Canvas &canvas, int num_vertices)
 {
+	if (draw_list)
+		return set_deferred_active(canvas, Texture2D(), false, Colorf::black, num_vertices);
+
 	if (use_glyph_program != false)
 	{
 		canvas.flush();
@@ -310,63 +322,202 @@ int RenderBatchTriangle::set_batcher_active(Canvas &canvas, int num_vertices)
 	return 4;
 }
 
+int RenderBatchTriangle::set_deferred_active(Canvas &canvas, const Texture2D &texture, bool glyph_program, const Colorf &new_constant_color, int num_vertices)
+{
+	if (num_vertices > max_vertices)
+		throw Exception("Too many vertices for RenderBatchTriangle");
+
+	// An empty item would have no vertex to take its bounds from. The caller writes no vertices either.
+	if (num_vertices == 0)
+		return texture.is_null() ? 4 : 0;
+
+	canvas.set_batcher(this);
+
+	CanvasDrawItem item;
+	item.batcher = this;
+	item.texture = texture;
+	item.glyph_program = glyph_program;
+	item.constant_color = new_constant_color;
+	item.first_vertex = (int)deferred_vertices.size();
+	item.num_vertices = num_vertices;
+	draw_list->add(item);
+
+	// The draw functions write to vertices[position] - point them at the recorded range.
+	// The texture index is patched when the item is replayed.
+	deferred_vertices.resize(item.first_vertex + num_vertices);
+	vertices = &deferred_vertices[0];
+	position = item.first_vertex;
+
+	if (texture.is_null())
+		return 4;
+
+	tex_sizes[0] = Sizef((float)texture.get_width(), (float)texture.get_height());
+	return 0;
+}
+
 void RenderBatchTriangle::flush(GraphicContext &gc)
 {
 	if (position > 0)
 	{
-		gc.set_program_object(program_sprite);
-
 		int gpu_index;
 		VertexArrayVector<SpriteVertex> gpu_vertices(batch_buffer->get_vertex_buffer(gc, gpu_index));
 
 		if (prim_array[gpu_index].is_null())
-		{
-			prim_array[gpu_index] = PrimitivesArray(gc);
-			prim_array[gpu_index].set_attributes(0, gpu_vertices, cl_offsetof(SpriteVertex, position));
-			prim_array[gpu_index].set_attributes(1, gpu_vertices, cl_offsetof(SpriteVertex, color));
-			prim_array[gpu_index].set_attributes(2, gpu_vertices, cl_offsetof(SpriteVertex, texcoord));
-			prim_array[gpu_index].set_attributes(3, gpu_vertices, cl_offsetof(SpriteVertex, texindex));
-
-			if (glyph_blend.is_null())
-			{
-				BlendStateDescription blend_desc;
-				blend_desc.set_blend_function(blend_constant_color, blend_one_minus_src_color, blend_zero, blend_one);
-				glyph_blend = BlendState(gc, blend_desc);
-			}
-		}
+			prim_array[gpu_index] = create_primitives_array(gc, gpu_vertices);
 
 		gpu_vertices.upload_data(gc, 0, vertices, position);
 
+		draw_primitives(gc, prim_array[gpu_index], position, current_textures, num_current_textures, use_glyph_program, constant_color);
+
+		position = 0;
 		for (int i = 0; i < num_current_textures; i++)
-			gc.set_texture(i, current_textures[i]);
+			current_textures[i] = Texture2D();
+		num_current_textures = 0;
+
+	}
+}
+
+PrimitivesArray RenderBatchTriangle::create_primitives_array(GraphicContext &gc, VertexArrayVector<SpriteVertex> &gpu_vertices)
+{
+	PrimitivesArray prim_array(gc);
+	prim_array.set_attributes(0, gpu_vertices, cl_offsetof(SpriteVertex, position));
+	prim_array.set_attributes(1, gpu_vertices, cl_offsetof(SpriteVertex, color));
+	prim_array.set_attributes(2, gpu_vertices, cl_offsetof(SpriteVertex, texcoord));
+	prim_array.set_attributes(3, gpu_vertices, cl_offsetof(SpriteVertex, texindex));
+	return prim_array;
+}
+
+void RenderBatchTriangle::draw_primitives(GraphicContext &gc, PrimitivesArray &primitives, int num_vertices, const Texture2D *textures, int num_textures, bool glyph_program, const Colorf &glyph_color)
+{
+	gc.set_program_object(program_sprite);
 
-		if (use_glyph_program)
+	for (int i = 0; i < num_textures; i++)
+		gc.set_texture(i, textures[i]);
+
+	if (glyph_program)
+	{
+		if (glyph_blend.is_null())
 		{
-			gc.set_blend_state(glyph_blend, constant_color);
-			gc.draw_primitives(type_triangles, position, prim_array[gpu_index]);
-			gc.reset_blend_state();
+			BlendStateDescription blend_desc;
+			blend_desc.set_blend_function(blend_constant_color, blend_one_minus_src_color, blend_zero, blend_one);
+			glyph_blend = BlendState(gc, blend_desc);
 		}
-		else
+
+		gc.set_blend_state(glyph_blend, glyph_color);
+		gc.draw_primitives(type_triangles, num_vertices, primitives);
+		gc.reset_blend_state();
+	}
+	else
+	{
+		gc.draw_primitives(type_triangles, num_vertices, primitives);
+	}
+
+	for (int i = 0; i < num_textures; i++)
+		gc.reset_texture(i);
+
+	gc.reset_program_object();
+}
+
+void RenderBatchTriangle::matrix_changed(const Mat4f &new_modelview, const Mat4f &new_projection)
+{
+	modelview_projection_matrix = new_projection * new_modelview;
+}
+
+void RenderBatchTriangle::set_draw_list(CanvasDrawList *new_draw_list)
+{
+	draw_list = new_draw_list;
+	deferred_vertices.clear();
+	vertices = (SpriteVertex *) batch_buffer->buffer;
+	position = 0;
+}
+
+Rectf RenderBatchTriangle::get_deferred_bounds(const CanvasDrawItem &item, const Sizef &pixel_size) const
+{
+	return CanvasDrawList::get_bounds(&deferred_vertices[item.first_vertex].position, sizeof(SpriteVertex), item.num_vertices);
+}
+
+void RenderBatchTriangle::draw_deferred(GraphicContext &gc, const std::vector<CanvasDrawItem> &items, const std::vector<int> &batch)
+{
+	vertices = (SpriteVertex *) batch_buffer->buffer;
+	position = 0;
+	num_current_textures = 0;
+	use_glyph_program = items[batch.front()].glyph_program;
+	constant_color = items[batch.front()].constant_color;
+
+	for (size_t i = 0; i < batch.size(); i++)
+	{
+		const CanvasDrawItem &item = items[batch[i]];
+
+		int texindex = 4;
+		if (!item.texture.is_null())
 		{
-			gc.draw_primitives(type_triangles, position, prim_array[gpu_index]);
+			for (texindex = 0; texindex < num_current_textures; texindex++)
+			{
+				if (current_textures[texindex] == item.texture)
+					break;
+			}
+			if (texindex == num_current_textures)
+				current_textures[num_current_textures++] = item.texture;
 		}
 
-		for (int i = 0; i < num_current_textures; i++)
-			gc.reset_texture(i);
+		const SpriteVertex *src = &deferred_vertices[item.first_vertex];
+		for (int j = 0; j < item.num_vertices; j++)
+		{
+			vertices[position] = src[j];
+			vertices[position].texindex = texindex;
+			position++;
+		}
+	}
 
-		gc.reset_program_object();
+	flush(gc);
+}
 
-		position = 0;
-		for (int i = 0; i < num_current_textures; i++)
-			current_textures[i] = Texture2D();
-		num_current_textures = 0;
+void RenderBatchTriangle::record_deferred(const std::vector<CanvasDrawItem> &items, const std::vector<int> &batch, CanvasRecordedBatch &out)
+{
+	out.num_vertices = 0;
+	for (size_t i = 0; i < batch.size(); i++)
+		out.num_vertices += items[batch[i]].num_vertices;
+	out.vertices.resize(out.num_vertices * sizeof(SpriteVertex));
+
+	SpriteVertex *dest = (SpriteVertex *) &out.vertices[0];
+	for (size_t i = 0; i < batch.size(); i++)
+	{
+		const CanvasDrawItem &item = items[batch[i]];
+
+		int texindex = 4;
+		if (!item.texture.is_null())
+		{
+			for (texindex = 0; texindex < (int)out.textures.size(); texindex++)
+			{
+				if (out.textures[texindex] == item.texture)
+					break;
+			}
+		}
 
+		const SpriteVertex *src = &deferred_vertices[item.first_vertex];
+		for (int j = 0; j < item.num_vertices; j++)
+		{
+			*dest = src[j];
+			dest->texindex = texindex;
+			dest++;
+		}
 	}
 }
 
-void RenderBatchTriangle::matrix_changed(const Mat4f &new_modelview, const Mat4f &new_projection)
+void RenderBatchTriangle::draw_recorded(GraphicContext &gc, CanvasRecordedBatch &batch)
 {
-	modelview_projection_matrix = new_projection * new_modelview;
+	if (batch.prim_array.is_null())
+	{
+		VertexArrayVector<SpriteVertex> gpu_vertices(batch.gpu_vertices);
+		batch.prim_array = create_primitives_array(gc, gpu_vertices);
+	}
+
+	draw_primitives(gc, batch.prim_array, batch.num_vertices, batch.textures.empty() ? 0 : &batch.textures[0], (int)batch.textures.size(), batch.glyph_program, batch.constant_color);
+}
+
+void RenderBatchTriangle::clear_deferred()
+{
+	deferred_vertices.clear();
 }
 
 }
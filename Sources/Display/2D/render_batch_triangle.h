@@ -35,6 +35,7 @@
 #include "API/Display/Render/render_batcher.h"
 #include "API/Display/Render/texture_2d.h"
 #include "render_batch_buffer.h"
+#include "canvas_draw_list.h"
 
 namespace clan
 {
@@ -43,7 +44,7 @@ struct Surface_DrawParams1;
 class RenderBatchBuffer;
 class Quadf;
 
-class RenderBatchTriangle : public RenderBatcher
+class RenderBatchTriangle : public DeferredRenderBatcher
 {
 public:
 	RenderBatchTriangle(GraphicContext &gc, RenderBatchBuffer *batch_buffer);
@@ -57,6 +58,9 @@ public:
 	void fill_triangles(Canvas &canvas, const Vec2f *positions, const Vec2f *texture_positions, int num_vertices, const Texture2D &texture, const Colorf *colors);
 	void fill(Canvas &canvas, float x1, float y1, float x2, float y2, const Colorf &color);
 
+	/// \brief Records draw calls into the list instead of the vertex buffer. Pass null to draw immediately again.
+	void set_draw_list(CanvasDrawList *draw_list);
+
 public:
 	static int max_textures;	// For use by the GL1 target, so it can reduce the number of textures
 
@@ -69,12 +73,24 @@ private:
 		int texindex;
 	};
 
-	int set_batcher_active(Canvas &canvas, const Texture2D &texture, bool glyph_program = false, const Colorf &constant_color = Colorf::black);
+	int set_batcher_active(Canvas &canvas, const Texture2D &texture, bool glyph_program = false, const Colorf &constant_color = Colorf::black, int num_vertices = 6);
 	int set_batcher_active(Canvas &canvas);
 	int set_batcher_active(Canvas &canvas, int num_vertices);
+	int set_deferred_active(Canvas &canvas, const Texture2D &texture, bool glyph_program, const Colorf &constant_color, int num_vertices);
 	void flush(GraphicContext &gc);
 	void matrix_changed(const Mat4f &modelview, const Mat4f &projection);
 
+	Rectf get_deferred_bounds(const CanvasDrawItem &item, const Sizef &pixel_size) const;
+	int get_max_deferred_textures() const { return max_textures; }
+	int get_max_deferred_vertices() const { return max_vertices; }
+	void draw_deferred(GraphicContext &gc, const std::vector<CanvasDrawItem> &items, const std::vector<int> &batch);
+	void record_deferred(const std::vector<CanvasDrawItem> &items, const std::vector<int> &batch, CanvasRecordedBatch &out);
+	void draw_recorded(GraphicContext &gc, CanvasRecordedBatch &batch);
+	void clear_deferred();
+
+	PrimitivesArray create_primitives_array(GraphicContext &gc, VertexArrayVector<SpriteVertex> &gpu_vertices);
+	void draw_primitives(GraphicContext &gc, PrimitivesArray &primitives, int num_vertices, const Texture2D *textures, int num_textures, bool glyph_program, const Colorf &glyph_color);
+
 	inline void to_sprite_vertex(const Pointf &texture_position, const Pointf &dest_position, RenderBatchTriangle::SpriteVertex &v, int texindex, const Colorf &color) const;
 	inline Vec4f to_position(float x, float y) const;
 
@@ -93,6 +109,9 @@ private:
 	bool use_glyph_program;
 	Colorf constant_color;
 	BlendState glyph_blend;
+
+	CanvasDrawList *draw_list;
+	std::vector<SpriteVertex> deferred_vertices;
 };
 
 }
@@ -487,13 +487,18 @@ void CollisionOutline_Impl::save(IODevice &output_source) const
 		// number of points in contours
 		output_source.write_uint32((*it_cont).get_points().size());
 		
+		// x,y of points
+		const std::vector<Pointf> &points = (*it_cont).get_points();
+		std::vector<float> coordinates;
+		coordinates.reserve(points.size() * 2);
 		std::vector<Pointf>::const_iterator it;
-		for( it = (*it_cont).get_points().begin(); it != (*it_cont).get_points().end(); ++it )
+		for( it = points.begin(); it != points.end(); ++it )
 		{
-			// x,y of points
-			output_source.write_float((float)(*it).x);
-			output_source.write_float((float)(*it).y);
+			coordinates.push_back((float)(*it).x);
+			coordinates.push_back((float)(*it).y);
 		}
+		if( !coordinates.empty() )
+			output_source.write_float_array(&coordinates[0], coordinates.size());
 	}
 }
 
@@ -85,14 +85,14 @@ void OutlineProviderFile_Impl::load(IODevice &input_source)
 
 		int num_points = input_source.read_uint32();
 
-		for( int pp=0; pp < num_points; ++pp )
-		{
-			Pointf point(0,0);
-			point.x = input_source.read_float();
-			point.y = input_source.read_float();
+		// x,y of all points in one read
+		std::vector<float> coordinates(num_points * 2);
+		if( num_points > 0 )
+			input_source.read_float_array(&coordinates[0], num_points * 2);
 
-			contour.get_points().push_back(point);
-		}
+		contour.get_points().reserve(num_points);
+		for( int pp=0; pp < num_points; ++pp )
+			contour.get_points().push_back(Pointf(coordinates[pp*2], coordinates[pp*2+1]));
 		
 		contours.push_back(contour);
 	}
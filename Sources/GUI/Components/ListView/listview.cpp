@@ -161,6 +161,16 @@ ListViewDisplayMode ListView::get_display_mode() const
 	return impl->display_mode;
 }
 
+std::shared_ptr<ListViewDataProvider> ListView::get_data_provider() const
+{
+	return impl->data_provider;
+}
+
+int ListView::get_selected_row() const
+{
+	return impl->selected_row;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // ListView Operations:
 
@@ -198,6 +208,9 @@ void ListView::set_display_mode(ListViewDisplayMode mode)
 {
 	impl->cancel_edit();
 
+	if (impl->data_provider && mode != listview_mode_details)
+		throw Exception("ListView only supports listview_mode_details when a data provider is set");
+
 	impl->display_mode = mode;
 	impl->header->set_display_mode(mode);
 
@@ -206,7 +219,10 @@ void ListView::set_display_mode(ListViewDisplayMode mode)
 
 	if (mode == listview_mode_details)
 	{
-		impl->layout = new ListViewLayoutDetails(this);
+		if (impl->data_provider)
+			impl->layout = new ListViewLayoutVirtual(this, impl->data_provider, impl->variable_row_heights);
+		else
+			impl->layout = new ListViewLayoutDetails(this);
 	}
 	else if (mode == listview_mode_icons)
 	{
@@ -303,6 +319,78 @@ ListViewItem ListView::find(int id, bool recursive)
 	return impl->find(it, id, recursive);
 }
 
+void ListView::set_data_provider(const std::shared_ptr<ListViewDataProvider> &provider, bool variable_row_heights)
+{
+	impl->cancel_edit();
+
+	impl->data_provider = provider;
+	impl->variable_row_heights = variable_row_heights;
+	impl->selected_row = -1;
+
+	set_display_mode(listview_mode_details);
+	impl->scrollbar->set_position(0);
+	impl->update_part_positions();
+	impl->on_scroll();
+}
+
+void ListView::data_changed()
+{
+	if (!impl->data_provider)
+		return;
+
+	impl->cancel_edit();
+
+	static_cast<ListViewLayoutVirtual*>(impl->layout)->update_row_index();
+	impl->update_part_positions();
+	impl->on_scroll();
+
+	if (impl->selected_row >= impl->get_row_count())
+		impl->select_row(-1);
+}
+
+void ListView::data_changed(int first_row, int count)
+{
+	if (!impl->data_provider)
+		return;
+
+	if (impl->data_provider->get_row_count() != impl->get_row_count())
+	{
+		data_changed();
+		return;
+	}
+
+	int end_row = min(first_row + count, impl->get_row_count());
+	first_row = max(first_row, 0);
+	if (first_row >= end_row)
+		return;
+
+	impl->cancel_edit();
+
+	static_cast<ListViewLayoutVirtual*>(impl->layout)->update_row_heights(first_row, end_row - first_row);
+	impl->update_part_positions();
+	impl->on_scroll();
+}
+
+void ListView::row_height_changed(int row)
+{
+	if (!impl->data_provider || !impl->variable_row_heights || row < 0 || row >= impl->get_row_count())
+		return;
+
+	static_cast<ListViewLayoutVirtual*>(impl->layout)->update_row_height(row);
+	impl->update_part_positions();
+	impl->on_scroll();
+}
+
+void ListView::set_selected_row(int row)
+{
+	impl->select_row(row);
+}
+
+void ListView::scroll_to_row(int row)
+{
+	impl->scroll_to_row(row);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // ListView Events:
 
@@ -353,6 +441,16 @@ Callback_v0 &ListView::func_begin_drag()
 	return impl->func_begin_drag;
 }
 
+Callback_v1<int> &ListView::func_row_selection_changed()
+{
+	return impl->func_row_selection_changed;
+}
+
+Callback_v1<int> &ListView::func_row_doubleclick()
+{
+	return impl->func_row_doubleclick;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // ListView Implementation:
 
@@ -447,6 +545,9 @@ void ListView_Impl::on_process_message(std::shared_ptr<GUIMessage> &msg)
 
 bool ListView_Impl::on_keyboard_pressed(InputEvent &event)
 {
+	if (data_provider)
+		return on_keyboard_pressed_virtual(event);
+
 	bool event_consumed = false;
 
 	if (document_item.get_child_count() == 0)
@@ -628,6 +729,39 @@ bool ListView_Impl::on_keyboard_pressed(InputEvent &event)
 	return event_consumed;
 }
 
+bool ListView_Impl::on_keyboard_pressed_virtual(InputEvent &event)
+{
+	int row_count = get_row_count();
+	if (row_count == 0)
+		return false;
+
+	int rows_per_page = max(rect_columns_content.get_height() / max(layout->get_row_height(), 1), 1);
+
+	int row = selected_row;
+	if (event.id == keycode_up)
+		row = max(row - 1, 0);
+	else if (event.id == keycode_down)
+		row = min(row + 1, row_count - 1);
+	else if (event.id == keycode_home)
+		row = 0;
+	else if (event.id == keycode_end)
+		row = row_count - 1;
+	else if (event.id == keycode_prior)
+		row = max(row - rows_per_page, 0);
+	else if (event.id == keycode_next)
+		row = min(row + rows_per_page, row_count - 1);
+	else
+	{
+		if (!func_key_pressed.is_null())
+			func_key_pressed.invoke(event);
+		return false;
+	}
+
+	select_row(row);
+	scroll_to_row(row);
+	return true;
+}
+
 bool ListView_Impl::on_keyboard_released(InputEvent &event)
 {
 	bool event_consumed = false;
@@ -679,6 +813,12 @@ void ListView_Impl::on_mouse_button_down(std::shared_ptr<GUIMessage> &msg, Input
 	if (si.valid == false)
 		return;
 
+	if (si.row >= 0)
+	{
+		select_row(si.row);
+		return;
+	}
+
 	// Check if opener rect is clicked.
 	if (si.rect_opener.contains(pos))
 	{
@@ -761,6 +901,13 @@ void ListView_Impl::on_mouse_lbutton_up(std::shared_ptr<GUIMessage> &msg, InputE
 
 void ListView_Impl::on_mouse_lbutton_doubleclick(std::shared_ptr<GUIMessage> &msg, InputEvent &input_event)
 {
+	if (data_provider)
+	{
+		if (selected_row >= 0 && !func_row_doubleclick.is_null())
+			func_row_doubleclick.invoke(selected_row);
+		return;
+	}
+
 	if(!selection.get_first().is_null())
 		if (!func_item_doubleclick.is_null())
 			func_item_doubleclick.invoke(selection.get_first().get_item());
@@ -955,6 +1102,51 @@ void ListView_Impl::on_scroll()
 	listview->request_repaint();
 }
 
+void ListView_Impl::select_row(int row)
+{
+	if (!data_provider || row >= get_row_count())
+		return;
+	if (row < 0)
+		row = -1;
+
+	if (row != selected_row)
+	{
+		selected_row = row;
+		if (!func_row_selection_changed.is_null())
+			func_row_selection_changed.invoke(selected_row);
+		listview->request_repaint();
+	}
+}
+
+void ListView_Impl::scroll_to_row(int row)
+{
+	if (!data_provider || row < 0 || row >= get_row_count())
+		return;
+
+	ListViewLayoutVirtual *virtual_layout = static_cast<ListViewLayoutVirtual*>(layout);
+	int row_top = virtual_layout->get_row_top(row);
+	int row_bottom = row_top + virtual_layout->get_row_height(row);
+	int view_height = rect_columns_content.get_height();
+
+	int scroll_pos = scrollbar->get_position();
+	if (row_top < scroll_pos)
+		scroll_pos = row_top;
+	else if (row_bottom > scroll_pos + view_height)
+		scroll_pos = row_bottom - view_height;
+	else
+		return;
+
+	scrollbar->set_position(scroll_pos);
+	on_scroll();
+}
+
+int ListView_Impl::get_row_count() const
+{
+	if (!data_provider)
+		return 0;
+	return static_cast<ListViewLayoutVirtual*>(layout)->get_row_count();
+}
+
 void ListView_Impl::on_item_added()
 {
 	layout->invalidate();
@@ -56,6 +56,7 @@
 #include "listview_renderer.h"
 #include "listview_layout_details.h"
 #include "listview_layout_icons.h"
+#include "listview_layout_virtual.h"
 
 namespace clan
 {
@@ -70,7 +71,7 @@ public:
 	  : display_mode(listview_mode_details), listview(0), layout(0), renderer(0), scrollbar(0),
 		  header(0), lineedit(0), drag_or_edit_started(false), multiple_selection(false), select_whole_row(false),
 		  context_menu(PopupMenu::create_null_object()), just_launched_lineedit(false),
-		  show_detail_icon(true), show_detail_opener(true)
+		  show_detail_icon(true), show_detail_opener(true), variable_row_heights(false), selected_row(-1)
 	{
 		std::shared_ptr<ListViewItem_Impl> item_impl(new ListViewItem_Impl());
 		document_item = ListViewItem(item_impl);
@@ -122,6 +123,9 @@ public:
 	ListViewItem find(ListViewItem &item, const std::shared_ptr<ListViewItemUserData> userdata, bool recursive);
 	ListViewItem find(ListViewItem &it, int id, bool recursive);
 	ListViewColumnHeader create_header_column(const std::string &column_id, const std::string &caption);
+	void select_row(int row);
+	void scroll_to_row(int row);
+	int get_row_count() const;
 
 	ListViewDisplayMode display_mode;
 	ListView *listview;
@@ -145,6 +149,9 @@ public:
 	Callback_v1<const ListViewItem &> func_item_closed;
 	Callback_v0 func_begin_drag;
 
+	Callback_v1<int> func_row_selection_changed;
+	Callback_v1<int> func_row_doubleclick;
+
 	ListViewSelection selection;
 	ListViewIconList icon_list;
 	ListViewItem edited_item;
@@ -172,10 +179,15 @@ public:
 	bool show_detail_icon;
 	bool show_detail_opener;
 
+	std::shared_ptr<ListViewDataProvider> data_provider;
+	bool variable_row_heights;
+	int selected_row;
+
 private:
 	// void update_shown_items();
 
 	void update_scrollbar();
+	bool on_keyboard_pressed_virtual(InputEvent &event);
 	void edit_item(ListViewShownItem &si);
 	void on_drag_or_edit_timeout();
 
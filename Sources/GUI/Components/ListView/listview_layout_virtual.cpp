@@ -0,0 +1,193 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "GUI/precomp.h"
+#include "API/GUI/gui_theme_part.h"
+#include "API/GUI/Components/listview.h"
+#include "API/GUI/Components/listview_header.h"
+#include "API/GUI/Components/listview_column_header.h"
+#include "API/Display/Font/font.h"
+#include "listview_layout_virtual.h"
+#include "listview_shown_item.h"
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// ListViewLayoutVirtual Construction:
+
+ListViewLayoutVirtual::ListViewLayoutVirtual(ListView *listview, const std::shared_ptr<ListViewDataProvider> &data_provider, bool variable_row_heights)
+: ListViewLayoutDetails(listview), data_provider(data_provider), variable_row_heights(variable_row_heights)
+{
+}
+
+ListViewLayoutVirtual::~ListViewLayoutVirtual()
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// ListViewLayoutVirtual Attributes:
+
+Size ListViewLayoutVirtual::get_total_size()
+{
+	return Size(rect_view.get_width(), row_index.get_total_height());
+}
+
+ListViewItem ListViewLayoutVirtual::get_neighbour(ListViewItem item, Neighbour neighbour)
+{
+	// Virtual rows have no items. The ListView navigates them by row index instead.
+	return item;
+}
+
+std::vector<ListViewShownItem> &ListViewLayoutVirtual::get_shown_items()
+{
+	if (valid)
+		return shown_items;
+
+	shown_items.clear();
+	rows.clear();
+
+	if (height_row <= 0)
+		return shown_items;
+
+	Font font = part_cell.get_font();
+
+	int row_count = row_index.get_row_count();
+	int row = row_index.find_row(scroll_y);
+	if (row >= 0)
+	{
+		int y = rect_view.top + row_index.get_row_top(row) - scroll_y;
+		while (row < row_count && y < rect_view.bottom)
+		{
+			int height = row_index.get_row_height(row);
+			add_shown_row(font, row, Rect(rect_view.left, y, rect_view.right, y + height));
+			y += height;
+			row++;
+		}
+	}
+
+	valid = true;
+	return shown_items;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// ListViewLayoutVirtual Operations:
+
+void ListViewLayoutVirtual::create_parts()
+{
+	ListViewLayoutDetails::create_parts();
+	update_row_index();
+}
+
+void ListViewLayoutVirtual::update_row_index()
+{
+	int row_count = data_provider->get_row_count();
+	row_index.reset(row_count, height_row);
+
+	if (variable_row_heights)
+	{
+		std::vector<int> heights(row_count);
+		for (int row = 0; row < row_count; row++)
+		{
+			int height = data_provider->get_row_height(row);
+			heights[row] = (height > 0) ? height : height_row;
+		}
+		row_index.set_row_heights(heights);
+	}
+
+	invalidate();
+}
+
+void ListViewLayoutVirtual::update_row_height(int row)
+{
+	int height = data_provider->get_row_height(row);
+	row_index.set_row_height(row, (height > 0) ? height : height_row);
+	invalidate();
+}
+
+void ListViewLayoutVirtual::update_row_heights(int first_row, int count)
+{
+	if (variable_row_heights)
+	{
+		for (int row = first_row; row < first_row + count; row++)
+		{
+			int height = data_provider->get_row_height(row);
+			row_index.set_row_height(row, (height > 0) ? height : height_row);
+		}
+	}
+	invalidate();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// ListViewLayoutVirtual Implementation:
+
+void ListViewLayoutVirtual::add_shown_row(Font &font, int row, const Rect &rect_row)
+{
+	shown_items.push_back(ListViewShownItem());
+	ListViewShownItem &si = shown_items.back();
+	si.valid = true;
+	si.row = row;
+	si.descent = descent;
+
+	int x = rect_row.left;
+	bool first_column = true;
+
+	ListViewColumnHeader col = header->get_first_column();
+	while (!col.is_null())
+	{
+		si.text.push_back(data_provider->get_cell_text(row, col.get_column_id()));
+
+		Rect rect_cell(x, rect_row.top, x + col.get_used_width(), rect_row.bottom);
+		if (col.get_next_sibling().is_null())
+			rect_cell.right = rect_view.right;
+		si.rect_cell.push_back(rect_cell);
+
+		Rect rect_cell_content = part_cell.get_content_box(rect_cell);
+		int text_x = rect_cell_content.left;
+		if (first_column && show_detail_icon)
+		{
+			si.rect_icon = get_icon_rect(rect_cell_content, ListViewItem(), text_x);
+			text_x = si.rect_icon.right + icon_gap;
+		}
+
+		Rect rect_text(Point(text_x, rect_cell_content.top), font.get_text_size(canvas, si.text.back()));
+		rect_text.right = min(rect_text.right, x + col.get_used_width());
+		si.rect_text.push_back(rect_text);
+
+		x += col.get_used_width();
+		col = col.get_next_sibling();
+		first_column = false;
+	}
+
+	ListViewRow list_row;
+	list_row.index = row;
+	list_row.rect = rect_row;
+	rows.push_back(list_row);
+}
+
+}
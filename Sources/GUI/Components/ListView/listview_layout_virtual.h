@@ -0,0 +1,93 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "listview_layout_details.h"
+#include "listview_row_index.h"
+#include "API/GUI/Components/listview_data_provider.h"
+#include <memory>
+
+namespace clan
+{
+/// \addtogroup clanGUI_Components clanGUI Components
+/// \{
+
+/// \brief Details layout for rows supplied by a ListViewDataProvider
+///
+/// Only the visible rows are laid out. The first visible row is found through the row index.
+class ListViewLayoutVirtual : public ListViewLayoutDetails
+{
+/// \name Construction
+/// \{
+public:
+	ListViewLayoutVirtual(ListView *listview, const std::shared_ptr<ListViewDataProvider> &data_provider, bool variable_row_heights);
+	virtual ~ListViewLayoutVirtual();
+
+/// \}
+/// \name Attributes
+/// \{
+public:
+	virtual Size get_total_size();
+	virtual ListViewItem get_neighbour(ListViewItem item, Neighbour neighbour);
+	virtual std::vector<ListViewShownItem> &get_shown_items();
+
+	int get_row_count() const { return row_index.get_row_count(); }
+	int get_row_top(int row) const { return row_index.get_row_top(row); }
+	int get_row_height(int row) const { return row_index.get_row_height(row); }
+
+/// \}
+/// \name Operations
+/// \{
+public:
+	virtual void create_parts();
+
+	/// \brief Fetches the row count (and row heights) from the data provider again
+	void update_row_index();
+
+	void update_row_height(int row);
+
+	/// \brief Fetches the heights of a range of rows from the data provider again
+	void update_row_heights(int first_row, int count);
+
+/// \}
+/// \name Implementation
+/// \{
+private:
+	void add_shown_row(Font &font, int row, const Rect &rect_row);
+
+	std::shared_ptr<ListViewDataProvider> data_provider;
+	bool variable_row_heights;
+	ListViewRowIndex row_index;
+/// \}
+};
+
+}
+
+/// \}
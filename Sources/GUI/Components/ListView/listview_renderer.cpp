@@ -102,6 +102,12 @@ void ListViewRenderer::render(
 	{
 		ListViewShownItem &si = (*it);
 
+		if (si.row >= 0)
+		{
+			render_virtual_row(canvas, si);
+			continue;
+		}
+
 		int x = rect_view.left;
 		bool first_column = true;
 		ListViewColumnHeader col = header->get_first_column();
@@ -270,4 +276,56 @@ void ListViewRenderer::set_display_mode(ListViewDisplayMode mode)
 /////////////////////////////////////////////////////////////////////////////
 // ListViewRenderer Implementation:
 
+void ListViewRenderer::render_virtual_row(Canvas &canvas, ListViewShownItem &si)
+{
+	bool selected = (si.row == listview->impl->selected_row);
+
+	part_cell.set_pseudo_class(CssStr::hover, si.mouse_over);
+	part_cell.set_pseudo_class(CssStr::normal, !si.mouse_over);
+	part_selection.set_pseudo_class(CssStr::hover, si.mouse_over);
+	part_selection.set_pseudo_class(CssStr::normal, !si.mouse_over);
+
+	for (size_t i = 0; i < si.rect_cell.size(); i++)
+	{
+		part_cell.render_box(canvas, si.rect_cell[i]);
+
+		if (i == 0)
+		{
+			int index = listview->impl->data_provider->get_icon(si.row);
+			if (index)
+			{
+				Colorf color = selected ? icon_list.get_selected_color() : icon_list.get_color();
+				if (color == Colorf::transparent)
+					color = selected ? color_icon : color_icon_selected;
+				ListViewIcon icon = icon_list.get_icon(index);
+				icon.draw(canvas, si.rect_icon, display_mode, color);
+			}
+
+			if (selected)
+			{
+				part_selection.set_pseudo_class(CssStr::unfocused, !listview->has_focus());
+
+				Rect selection_rect = si.rect_text[i];
+				selection_rect.top -= selection_margin.top;
+				selection_rect.left -= selection_margin.left;
+				selection_rect.right += selection_margin.right;
+				selection_rect.bottom += selection_margin.bottom;
+				part_selection.render_box(canvas, selection_rect);
+				part_selection.render_text(canvas, si.text[i], si.rect_text[i]);
+			}
+			else
+			{
+				part_cell.render_text(canvas, si.text[i], si.rect_text[i]);
+			}
+
+			part_cell.set_pseudo_class(CssStr::hover, false);
+			part_cell.set_pseudo_class(CssStr::normal, true);
+		}
+		else
+		{
+			part_cell.render_text(canvas, si.text[i], si.rect_text[i]);
+		}
+	}
+}
+
 }
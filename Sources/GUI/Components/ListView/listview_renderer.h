@@ -102,6 +102,8 @@ public:
 /// \{
 
 private:
+	void render_virtual_row(Canvas &canvas, ListViewShownItem &si);
+
 	ListView *listview;
 	GUIThemePart part_cell;
 	GUIThemePart part_row;
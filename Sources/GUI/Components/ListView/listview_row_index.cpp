@@ -0,0 +1,163 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "GUI/precomp.h"
+#include "listview_row_index.h"
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// ListViewRowIndex Construction:
+
+ListViewRowIndex::ListViewRowIndex()
+: row_count(0), default_height(0)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// ListViewRowIndex Attributes:
+
+int ListViewRowIndex::get_row_height(int row) const
+{
+	if (heights.empty())
+		return default_height;
+	else
+		return heights[row];
+}
+
+int ListViewRowIndex::get_total_height() const
+{
+	return get_row_top(row_count);
+}
+
+int ListViewRowIndex::get_row_top(int row) const
+{
+	if (heights.empty())
+		return row * default_height;
+
+	int top = 0;
+	for (int i = row; i > 0; i -= i & -i)
+		top += tree[i];
+	return top;
+}
+
+int ListViewRowIndex::find_row(int y) const
+{
+	if (row_count == 0)
+		return -1;
+	if (y < 0)
+		return 0;
+
+	int row;
+	if (heights.empty())
+	{
+		row = (default_height > 0) ? y / default_height : 0;
+	}
+	else
+	{
+		// Descend the tree to find the number of rows that end at or above y
+		int step = 1;
+		while (step * 2 <= row_count)
+			step *= 2;
+
+		row = 0;
+		int remaining = y;
+		for (; step > 0; step /= 2)
+		{
+			if (row + step <= row_count && tree[row + step] <= remaining)
+			{
+				row += step;
+				remaining -= tree[row];
+			}
+		}
+	}
+
+	return (row < row_count) ? row : row_count - 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// ListViewRowIndex Operations:
+
+void ListViewRowIndex::reset(int new_row_count, int new_default_height)
+{
+	row_count = new_row_count;
+	default_height = new_default_height;
+	heights.clear();
+	tree.clear();
+}
+
+void ListViewRowIndex::set_row_height(int row, int height)
+{
+	if (heights.empty())
+	{
+		if (height == default_height)
+			return;
+		heights.assign(row_count, default_height);
+		build_tree();
+	}
+
+	int delta = height - heights[row];
+	heights[row] = height;
+	for (int i = row + 1; i <= row_count; i += i & -i)
+		tree[i] += delta;
+}
+
+void ListViewRowIndex::set_row_heights(const std::vector<int> &new_heights)
+{
+	heights.clear();
+	tree.clear();
+
+	for (int row = 0; row < row_count; row++)
+	{
+		if (new_heights[row] != default_height)
+		{
+			heights = new_heights;
+			heights.resize(row_count, default_height);
+			build_tree();
+			break;
+		}
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// ListViewRowIndex Implementation:
+
+void ListViewRowIndex::build_tree()
+{
+	tree.assign(row_count + 1, 0);
+	for (int i = 1; i <= row_count; i++)
+	{
+		tree[i] += heights[i - 1];
+		int parent = i + (i & -i);
+		if (parent <= row_count)
+			tree[parent] += tree[i];
+	}
+}
+
+}
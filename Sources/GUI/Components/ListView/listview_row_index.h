@@ -0,0 +1,94 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <vector>
+
+namespace clan
+{
+/// \addtogroup clanGUI_Components clanGUI Components
+/// \{
+
+/// \brief Maps between row indices and vertical pixel offsets of a virtual ListView
+///
+/// While all rows have the default height the offsets are calculated directly. Once a row
+/// gets another height the heights are kept in a Fenwick tree, so that finding the offset
+/// of a row, finding the row at an offset and changing a row height are all O(log n).
+class ListViewRowIndex
+{
+/// \name Construction
+/// \{
+public:
+	ListViewRowIndex();
+
+/// \}
+/// \name Attributes
+/// \{
+public:
+	int get_row_count() const { return row_count; }
+	int get_row_height(int row) const;
+	int get_total_height() const;
+
+	/// \brief Returns the offset of the top of a row
+	int get_row_top(int row) const;
+
+	/// \brief Returns the row at an offset, clamped to the valid rows. Returns -1 if there are no rows.
+	int find_row(int y) const;
+
+/// \}
+/// \name Operations
+/// \{
+public:
+	/// \brief Sets the number of rows and gives all of them the default height
+	void reset(int row_count, int default_height);
+
+	void set_row_height(int row, int height);
+
+	/// \brief Sets the height of every row at once, in O(n)
+	///
+	/// \param heights = One height per row
+	void set_row_heights(const std::vector<int> &heights);
+
+/// \}
+/// \name Implementation
+/// \{
+private:
+	void build_tree();
+
+	int row_count;
+	int default_height;
+	std::vector<int> heights;	// Empty while all rows have the default height
+	std::vector<int> tree;		// Fenwick tree over heights, one-based
+/// \}
+};
+
+}
+
+/// \}
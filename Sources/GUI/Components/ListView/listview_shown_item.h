@@ -37,7 +37,7 @@ namespace clan
 
 struct ListViewShownItem
 {
-	ListViewShownItem() : valid(false), mouse_over(false), descent(0)
+	ListViewShownItem() : valid(false), mouse_over(false), descent(0), row(-1)
 	{
 	}
 
@@ -56,6 +56,8 @@ struct ListViewShownItem
 	std::vector<Rect> rect_text;
 	std::vector<Rect> rect_checker;
 	int descent;
+	int row;	// Row index when the rows come from a data provider, otherwise -1
+	std::vector<std::string> text;	// Cell texts when the rows come from a data provider
 };
 
 }
@@ -47,6 +47,7 @@
 #include "API/Display/Window/keys.h"
 #include "API/Display/2D/span_layout.h"
 #include "API/Display/Font/font.h"
+#include "API/Display/Font/font_metrics.h"
 #include "API/Display/Window/display_window.h"
 #include "../gui_css_strings.h"
 #include "textedit_impl.h"
@@ -121,42 +122,27 @@ int TextEdit::get_max_length() const
 
 std::string TextEdit::get_line_text(int line) const
 {
-	if (line >= 0 && line < (int)impl->lines.size())
-		return impl->lines[line].text;
+	if (line >= 0 && line < impl->buffer.get_line_count())
+		return impl->buffer.get_line_text(line);
 	else
 		return std::string();
 }
 
 std::string TextEdit::get_text() const
 {
-	std::string::size_type size = 0;
-	for (size_t i = 0; i < impl->lines.size(); i++)
-		size += impl->lines[i].text.size();
-	size += impl->lines.size() - 1;
-
-	std::string text;
-	text.reserve(size);
-
-	for (size_t i = 0; i < impl->lines.size(); i++)
-	{
-		if (i > 0)
-			text.push_back('\n');
-		text += impl->lines[i].text;
-	}
-
-	return text;
+	return impl->buffer.get_text();
 }
 
 int TextEdit::get_line_count() const
 {
-	return impl->lines.size();
+	return impl->buffer.get_line_count();
 }
 
 std::string TextEdit::get_selection() const
 {
 	std::string::size_type offset = impl->to_offset(impl->selection_start);
 	int start = min(offset, offset + impl->selection_length);
-	return get_text().substr(start, abs(impl->selection_length));
+	return impl->buffer.get_text(start, abs(impl->selection_length));
 }
 
 int TextEdit::get_selection_start() const
@@ -184,11 +170,7 @@ int TextEdit::get_cursor_line_number() const
 
 void TextEdit::select_all()
 {
-	std::string::size_type size = 0;
-	for (size_t i = 0; i < impl->lines.size(); i++)
-		size += impl->lines[i].text.size();
-	size += impl->lines.size() - 1;
-	set_selection(0, size);
+	set_selection(0, impl->buffer.get_length());
 }
 
 void TextEdit::set_read_only(bool enable)
@@ -224,10 +206,7 @@ void TextEdit::set_max_length(int length)
 	{
 		impl->max_length = length;
 
-		std::string::size_type size = 0;
-		for (size_t i = 0; i < impl->lines.size(); i++)
-			size += impl->lines[i].text.size();
-		size += impl->lines.size() - 1;
+		std::string::size_type size = impl->buffer.get_length();
 
 		if ((int)size > length)
 		{
@@ -245,20 +224,11 @@ void TextEdit::set_max_length(int length)
 
 void TextEdit::set_text(const std::string &text)
 {
-	impl->lines.clear();
-	std::string::size_type start = 0;
-	std::string::size_type end = text.find('\n');
-	while (end != std::string::npos)
-	{
-		TextEdit_Impl::Line line;
-		line.text = text.substr(start, end - start);
-		impl->lines.push_back(line);
-		start = end + 1;
-		end = text.find('\n', start);
-	}
-	TextEdit_Impl::Line line;
-	line.text = text.substr(start);
-	impl->lines.push_back(line);
+	impl->buffer.set_text(text);
+	impl->line_cache.clear();
+
+	// The undo pieces pointed into the text that was just discarded
+	impl->undo_info.undo_pieces.clear();
 
 	impl->clip_start_offset = 0;
 	set_cursor_pos(0);
@@ -268,19 +238,8 @@ void TextEdit::set_text(const std::string &text)
 
 void TextEdit::add_text(const std::string &text)
 {
-	std::string::size_type start = 0;
-	std::string::size_type end = text.find('\n');
-	while (end != std::string::npos)
-	{
-		TextEdit_Impl::Line line;
-		line.text = text.substr(start, end - start);
-		impl->lines.push_back(line);
-		start = end + 1;
-		end = text.find('\n', start);
-	}
-	TextEdit_Impl::Line line;
-	line.text = text.substr(start);
-	impl->lines.push_back(line);
+	// The text always starts a new line
+	impl->insert_buffer_text(impl->buffer.get_length(), "\n" + text);
 
 //	impl->clip_start_offset = 0;
 //	set_cursor_pos(0);
@@ -311,8 +270,7 @@ void TextEdit::delete_selected_text()
 	int length = abs(impl->selection_length);
 
 	clear_selection();
-	std::string text = get_text();
-	set_text(text.substr(0, start) + text.substr(start + length));
+	impl->erase_buffer_text(start, length);
 	set_cursor_pos(start);
 }
 
@@ -455,7 +413,7 @@ void TextEdit_Impl::on_process_message(std::shared_ptr<GUIMessage> &msg)
 					if (cursor_pos.y > 0)
 					{
 						cursor_pos.y--;
-						cursor_pos.x = min(lines[cursor_pos.y].text.size(), (size_t)cursor_pos.x);
+						cursor_pos.x = min(buffer.get_line_length(cursor_pos.y), (size_t)cursor_pos.x);
 					}
 
 					if (e.shift)
@@ -479,10 +437,10 @@ void TextEdit_Impl::on_process_message(std::shared_ptr<GUIMessage> &msg)
 					if (e.shift && selection_length == 0)
 						selection_start = cursor_pos;
 
-					if (cursor_pos.y < lines.size() - 1)
+					if (cursor_pos.y < buffer.get_line_count() - 1)
 					{
 						cursor_pos.y++;
-						cursor_pos.x = min(lines[cursor_pos.y].text.size(), (size_t)cursor_pos.x);
+						cursor_pos.x = min(buffer.get_line_length(cursor_pos.y), (size_t)cursor_pos.x);
 					}
 
 					if (e.shift)
@@ -539,9 +497,9 @@ void TextEdit_Impl::on_process_message(std::shared_ptr<GUIMessage> &msg)
 				else if (e.id == keycode_end)
 				{
 					if (e.ctrl)
-						cursor_pos = Vec2i(lines.back().text.length(), lines.size() - 1);
+						cursor_pos = buffer.from_offset(buffer.get_length());
 					else
-						cursor_pos.x = lines[cursor_pos.y].text.size();
+						cursor_pos.x = buffer.get_line_length(cursor_pos.y);
 
 					if (e.shift)
 						selection_length = to_offset(cursor_pos) - to_offset(selection_start);
@@ -614,9 +572,14 @@ void TextEdit_Impl::on_process_message(std::shared_ptr<GUIMessage> &msg)
 				{
 					if (!readonly)
 					{
-						std::string tmp = undo_info.undo_text;
-						undo_info.undo_text = textedit->get_text();
-						textedit->set_text(tmp);
+						std::vector<TextEditBuffer::Piece> pieces = buffer.get_pieces();
+						buffer.set_pieces(undo_info.undo_pieces);
+						undo_info.undo_pieces = pieces;
+						line_cache.clear();
+
+						clip_start_offset = 0;
+						textedit->set_cursor_pos(0);
+						textedit->clear_selection();
 						msg->consumed = true;
 					}
 				}
@@ -706,8 +669,7 @@ void TextEdit_Impl::on_process_message(std::shared_ptr<GUIMessage> &msg)
 				textedit->select_all();
 			ignore_mouse_events = true;
 			part_selection.set_pseudo_class(CssStr::unfocused, false);
-			cursor_pos.y = lines.size() - 1;
-			cursor_pos.x = lines[cursor_pos.y].text.length();
+			cursor_pos = buffer.from_offset(buffer.get_length());
 
 			textedit->request_repaint();
 
@@ -784,10 +746,10 @@ void TextEdit_Impl::update_vertical_scroll()
 
 	vert_scrollbar->set_geometry(rect);
 
-	size_t total_height = get_total_line_height();
-	int height_per_line = max((size_t)1,total_height / max((size_t)1,lines.size()));
-	bool visible = total_height > content_rect.get_height();
-	vert_scrollbar->calculate_ranges(content_rect.get_height() / height_per_line, total_height/height_per_line);
+	int line_count = buffer.get_line_count();
+	int height_per_line = get_line_height();
+	bool visible = line_count * height_per_line > content_rect.get_height();
+	vert_scrollbar->calculate_ranges(content_rect.get_height() / height_per_line, line_count);
 	vert_scrollbar->set_line_step(1);
 	vert_scrollbar->set_visible(visible);
 
@@ -799,9 +761,7 @@ void TextEdit_Impl::update_vertical_scroll()
 
 void TextEdit_Impl::move_vertical_scroll()
 {
-	size_t total_height = get_total_line_height();
-	int height_per_line = max((size_t)1,total_height / max((size_t)1,lines.size()));
-	int lines_fit = content_rect.get_height() / height_per_line;
+	int lines_fit = content_rect.get_height() / get_line_height();
 	if(cursor_pos.y >= vert_scrollbar->get_position() + lines_fit)
 	{
 		vert_scrollbar->set_position(cursor_pos.y -  lines_fit +1);
@@ -813,14 +773,40 @@ void TextEdit_Impl::move_vertical_scroll()
 }
 
 
-int TextEdit_Impl::get_total_line_height()
+int TextEdit_Impl::get_line_height()
 {
-        int total = 0;
-        for(std::vector<Line>::const_iterator iter = lines.begin(); iter != lines.end(); iter++)
-        {
-		total += iter->layout.get_size().height;
-        }
-	return total;
+	// Only the visible lines are laid out. Use their average height as the height of every line.
+	if (!line_cache.empty())
+	{
+		int total = 0;
+		for (std::map<int, Line>::const_iterator it = line_cache.begin(); it != line_cache.end(); ++it)
+			total += it->second.box.get_height();
+		return max(1, total / (int)line_cache.size());
+	}
+	return max(1, (int)textedit->get_font().get_font_metrics().get_height());
+}
+
+int TextEdit_Impl::get_text_height(Canvas &canvas, int first_line)
+{
+	int width = textedit->get_content_box().get_width();
+	int height = 0;
+	for (int i = max(first_line, 0); i < buffer.get_line_count(); i++)
+	{
+		std::map<int, Line>::const_iterator it = line_cache.find(i);
+		if (it != line_cache.end() && !it->second.invalidated && it->second.width == width)
+		{
+			height += it->second.box.get_height();
+		}
+		else
+		{
+			std::string text = buffer.get_line_text(i);
+			SpanLayout layout;
+			layout.add_text(text.empty() ? StringHelp::wchar_to_utf8(0xa0) : text, textedit->get_font(), Colorf::black);
+			layout.layout(canvas, width);
+			height += layout.get_size().height;
+		}
+	}
+	return height;
 }
 
 void TextEdit_Impl::move(int steps, bool shift, bool ctrl)
@@ -833,10 +819,10 @@ void TextEdit_Impl::move(int steps, bool shift, bool ctrl)
 	{
 		if (steps < 0 && cursor_pos.x == 0 && cursor_pos.y > 0)
 		{
-			cursor_pos.x = lines[cursor_pos.y - 1].text.size();
+			cursor_pos.x = buffer.get_line_length(cursor_pos.y - 1);
 			cursor_pos.y--;
 		}
-		else if (steps > 0 && cursor_pos.x == lines[cursor_pos.y].text.size() && cursor_pos.y + 1 < lines.size())
+		else if (steps > 0 && cursor_pos.x == buffer.get_line_length(cursor_pos.y) && cursor_pos.y + 1 < buffer.get_line_count())
 		{
 			cursor_pos.x = 0;
 			cursor_pos.y++;
@@ -852,17 +838,18 @@ void TextEdit_Impl::move(int steps, bool shift, bool ctrl)
 	}
 	else if (steps < 0 && cursor_pos.x == 0 && cursor_pos.y > 0)
 	{
-		cursor_pos.x = lines[cursor_pos.y - 1].text.size();
+		cursor_pos.x = buffer.get_line_length(cursor_pos.y - 1);
 		cursor_pos.y--;
 	}
-	else if (steps > 0 && cursor_pos.x == lines[cursor_pos.y].text.size() && cursor_pos.y + 1 < lines.size())
+	else if (steps > 0 && cursor_pos.x == buffer.get_line_length(cursor_pos.y) && cursor_pos.y + 1 < buffer.get_line_count())
 	{
 		cursor_pos.x = 0;
 		cursor_pos.y++;
 	}
 	else
 	{
-		UTF8_Reader utf8_reader(lines[cursor_pos.y].text.data(), lines[cursor_pos.y].text.length());
+		std::string text = buffer.get_line_text(cursor_pos.y);
+		UTF8_Reader utf8_reader(text.data(), text.length());
 		utf8_reader.set_position(cursor_pos.x);
 		if (steps > 0)
 		{
@@ -900,13 +887,14 @@ std::string TextEdit_Impl::break_characters = " ::;,.-";
 
 Vec2i TextEdit_Impl::find_next_break_character(Vec2i search_start)
 {
+	std::string text = buffer.get_line_text(search_start.y);
 	search_start.x++;
-	if (search_start.x >= int(lines[search_start.y].text.size())-1)
-		return Vec2i(lines[search_start.y].text.size(), search_start.y);
+	if (search_start.x >= int(text.size())-1)
+		return Vec2i(text.size(), search_start.y);
 
-	int pos = lines[search_start.y].text.find_first_of(break_characters, search_start.x);
+	int pos = text.find_first_of(break_characters, search_start.x);
 	if (pos == std::string::npos)
-		return Vec2i(lines[search_start.y].text.size(), search_start.y);
+		return Vec2i(text.size(), search_start.y);
 	return Vec2i(pos, search_start.y);
 }
 
@@ -915,7 +903,7 @@ Vec2i TextEdit_Impl::find_previous_break_character(Vec2i search_start)
 	search_start.x--;
 	if (search_start.x <= 0)
 		return Vec2i(0, search_start.y);
-	int pos = lines[search_start.y].text.find_last_of(break_characters, search_start.x);
+	int pos = buffer.get_line_text(search_start.y).find_last_of(break_characters, search_start.x);
 	if (pos == std::string::npos)
 		return Vec2i(0, search_start.y);
 	return Vec2i(pos, search_start.y);
@@ -926,42 +914,51 @@ void TextEdit_Impl::insert_text(Vec2i pos, const std::string &str)
 	undo_info.first_erase = false;
 	if (undo_info.first_text_insert)
 	{
-		undo_info.undo_text = textedit->get_text();
+		undo_info.undo_pieces = buffer.get_pieces();
 		undo_info.first_text_insert = false;
 	}
 
 	// checking if insert exceeds max length
-	if(to_offset(Vec2i(lines[lines.size()-1].text.size(), lines.size()-1)) + str.length() > max_length)
+	if(buffer.get_length() + str.length() > max_length)
 	{
 		return;
 	}
 
-	std::string::size_type start = 0;
-	while (true)
-	{
-		std::string::size_type next_newline = str.find('\n', start);
+	insert_buffer_text(to_offset(pos), str);
 
-		lines[pos.y].text.insert(pos.x, str.substr(start, next_newline - start));
-		lines[pos.y].invalidated = true;
+	move_vertical_scroll();
 
-		if (next_newline == std::string::npos)
-			break;
+	textedit->request_repaint();
+}
 
-		pos.x += next_newline - start;
+void TextEdit_Impl::insert_buffer_text(std::string::size_type offset, const std::string &str)
+{
+	int line = buffer.from_offset(offset).y;
+	int old_line_count = buffer.get_line_count();
+	buffer.insert(offset, str);
+	update_line_cache(line, line + 1, line + 1 + buffer.get_line_count() - old_line_count);
+}
 
-		Line line;
-		line.text = lines[pos.y].text.substr(pos.x);
-		lines.insert(lines.begin() + pos.y + 1, line);
-		lines[pos.y].text = lines[pos.y].text.substr(0, pos.x);
-		lines[pos.y].invalidated = true;
-		pos = Vec2i(0, pos.y + 1);
+void TextEdit_Impl::erase_buffer_text(std::string::size_type offset, std::string::size_type length)
+{
+	int first_line = buffer.from_offset(offset).y;
+	int last_line = buffer.from_offset(offset + length).y;
+	buffer.erase(offset, length);
+	update_line_cache(first_line, last_line + 1, first_line + 1);
+}
 
-		start = next_newline + 1;
+void TextEdit_Impl::update_line_cache(int first_line, int old_end_line, int new_end_line)
+{
+	// Lines in front of the edit keep their layout, lines after it are renumbered
+	std::map<int, Line> new_cache;
+	for (std::map<int, Line>::iterator it = line_cache.begin(); it != line_cache.end(); ++it)
+	{
+		if (it->first < first_line)
+			new_cache[it->first] = it->second;
+		else if (it->first >= old_end_line)
+			new_cache[it->first + new_end_line - old_end_line] = it->second;
 	}
-
-	move_vertical_scroll();
-
-	textedit->request_repaint();
+	line_cache.swap(new_cache);
 }
 
 void TextEdit_Impl::backspace()
@@ -969,7 +966,7 @@ void TextEdit_Impl::backspace()
 	if (undo_info.first_erase)
 	{
 		undo_info.first_erase = false;
-		undo_info.undo_text = textedit->get_text();
+		undo_info.undo_pieces = buffer.get_pieces();
 	}
 
 	if (textedit->get_selection_length() != 0)
@@ -982,18 +979,18 @@ void TextEdit_Impl::backspace()
 	{
 		if (cursor_pos.x > 0)
 		{
-			UTF8_Reader utf8_reader(lines[cursor_pos.y].text.data(), lines[cursor_pos.y].text.length());
+			std::string text = buffer.get_line_text(cursor_pos.y);
+			UTF8_Reader utf8_reader(text.data(), text.length());
 			utf8_reader.set_position(cursor_pos.x);
 			utf8_reader.prev();
 			int length = utf8_reader.get_char_length();
-			lines[cursor_pos.y].text.erase(cursor_pos.x-length, length);
-			lines[cursor_pos.y].invalidated = true;
+			erase_buffer_text(to_offset(cursor_pos) - length, length);
 			cursor_pos.x -= length;
 			textedit->request_repaint();
 		}
 		else if (cursor_pos.y > 0)
 		{
-			selection_start = Vec2i(lines[cursor_pos.y - 1].text.length(), cursor_pos.y - 1);
+			selection_start = Vec2i(buffer.get_line_length(cursor_pos.y - 1), cursor_pos.y - 1);
 			selection_length = 1;
 			textedit->delete_selected_text();
 		}
@@ -1006,7 +1003,7 @@ void TextEdit_Impl::del()
 	if (undo_info.first_erase)
 	{
 		undo_info.first_erase = false;
-		undo_info.undo_text = textedit->get_text();
+		undo_info.undo_pieces = buffer.get_pieces();
 	}
 
 	if (textedit->get_selection_length() != 0)
@@ -1017,18 +1014,18 @@ void TextEdit_Impl::del()
 	}
 	else
 	{
-		if (cursor_pos.x < (int)lines[cursor_pos.y].text.size())
+		if (cursor_pos.x < (int)buffer.get_line_length(cursor_pos.y))
 		{
-			UTF8_Reader utf8_reader(lines[cursor_pos.y].text.data(), lines[cursor_pos.y].text.length());
+			std::string text = buffer.get_line_text(cursor_pos.y);
+			UTF8_Reader utf8_reader(text.data(), text.length());
 			utf8_reader.set_position(cursor_pos.x);
 			int length = utf8_reader.get_char_length();
-			lines[cursor_pos.y].text.erase(cursor_pos.x,length);
-			lines[cursor_pos.y].invalidated = true;
+			erase_buffer_text(to_offset(cursor_pos), length);
 			textedit->request_repaint();
 		}
-		else if (cursor_pos.y + 1 < lines.size())
+		else if (cursor_pos.y + 1 < buffer.get_line_count())
 		{
-			selection_start = Vec2i(lines[cursor_pos.y].text.length(), cursor_pos.y);
+			selection_start = Vec2i(buffer.get_line_length(cursor_pos.y), cursor_pos.y);
 			selection_length = 1;
 			textedit->delete_selected_text();
 		}
@@ -1093,52 +1090,20 @@ bool TextEdit_Impl::input_mask_accepts_input(Vec2i cursor_pos, const std::string
 
 std::string::size_type TextEdit_Impl::to_offset(Vec2i pos) const
 {
-	if (pos.y < lines.size())
-	{
-		std::string::size_type offset = 0;
-		for (int line = 0; line < pos.y; line++)
-		{
-			offset += lines[line].text.size() + 1;
-		}
-		return offset + min((size_t)pos.x, lines[pos.y].text.size());
-	}
-	else
-	{
-		std::string::size_type offset = 0;
-		for (size_t line = 0; line < lines.size(); line++)
-		{
-			offset += lines[line].text.size() + 1;
-		}
-		return offset - 1;
-	}
+	return buffer.to_offset(pos);
 }
 
 Vec2i TextEdit_Impl::from_offset(std::string::size_type offset) const
 {
-	int line_offset = 0;
-	for (int line = 0; line < lines.size(); line++)
-	{
-		if (offset <= line_offset + lines[line].text.size())
-		{
-			return Vec2i(offset - line_offset, line);
-		}
-		line_offset += lines[line].text.size() + 1;
-	}
-	return Vec2i(lines.back().text.size(), lines.size() - 1);
+	return buffer.from_offset(offset);
 }
 
 int TextEdit::get_total_height()
 {
 	Canvas canvas = get_canvas();
 	impl->layout_lines(canvas);
-	if (!impl->lines.empty())
-	{
-		return impl->lines.back().box.bottom + impl->textedit->get_content_shrink_box().bottom;
-	}
-	else
-	{
-		return impl->textedit->get_height();
-	}
+	int text_height = impl->get_text_height(canvas, impl->vert_scrollbar->get_position());
+	return get_content_box().top + text_height + get_content_shrink_box().bottom;
 }
 
 void TextEdit_Impl::layout_lines(Canvas &canvas)
@@ -1159,25 +1124,32 @@ void TextEdit_Impl::layout_lines(Canvas &canvas)
 		sel_end = selection_start;
 	}
 
+	// Only lay out the lines inside the view. A line keeps its layout until it is edited or the width changes.
+	int first_line = vert_scrollbar->get_position();
+	int end_line = first_line;
+	int line_count = buffer.get_line_count();
+	int width = content_box.get_width();
 	Point draw_pos = content_box.get_top_left();
-	for (size_t i = vert_scrollbar->get_position(); i < lines.size(); i++)
+	for (int i = first_line; i < line_count && draw_pos.y < content_box.bottom; i++)
 	{
-		Line &line = lines[i];
-		if (line.invalidated)
+		Line &line = line_cache[i];
+		if (line.invalidated || line.width != width)
 		{
+			std::string text = buffer.get_line_text(i);
 			line.layout.clear();
-			if (!line.text.empty())
-				line.layout.add_text(line.text, textedit->get_font(), Colorf::black);
+			if (!text.empty())
+				line.layout.add_text(text, textedit->get_font(), Colorf::black);
 			else
 				line.layout.add_text(StringHelp::wchar_to_utf8(0xa0),  textedit->get_font(), Colorf::black); // Draw one NBSP character to get the correct height
-			line.layout.layout(canvas, content_box.get_width());
+			line.layout.layout(canvas, width);
 			line.box = Rect(draw_pos, line.layout.get_size());
+			line.width = width;
 			line.invalidated = false;
 		}
 
 		if (sel_start != sel_end && sel_start.y <= i && sel_end.y >= i)
 		{
-			line.layout.set_selection_range(sel_start.y < i ? 0 : sel_start.x, sel_end.y > i ? line.text.size() : sel_end.x);
+			line.layout.set_selection_range(sel_start.y < i ? 0 : sel_start.x, sel_end.y > i ? buffer.get_line_length(i) : sel_end.x);
 		}
 		else
 		{
@@ -1198,7 +1170,13 @@ void TextEdit_Impl::layout_lines(Canvas &canvas)
 		line.layout.set_position(line.box.get_top_left());
 
 		draw_pos = line.box.get_bottom_left();
+		end_line = i + 1;
 	}
+
+	// Forget the layouts of lines scrolled out of view
+	line_cache.erase(line_cache.begin(), line_cache.lower_bound(first_line));
+	line_cache.erase(line_cache.lower_bound(end_line), line_cache.end());
+
 	update_vertical_scroll();
 }
 
@@ -1209,33 +1187,34 @@ void TextEdit_Impl::on_render(Canvas &canvas, const Rect &update_rect)
 	Rect content_box = textedit->get_content_box();
 
 	textedit->set_cliprect(canvas, content_box);
-	for (size_t i = vert_scrollbar->get_position(); i < lines.size(); i++)
-		lines[i].layout.draw_layout(canvas);
+	for (std::map<int, Line>::iterator it = line_cache.begin(); it != line_cache.end(); ++it)
+		it->second.layout.draw_layout(canvas);
 	textedit->reset_cliprect(canvas);
 }
 
 Vec2i TextEdit_Impl::get_character_index(Point mouse_wincoords)
 {
 	Canvas canvas = textedit->get_canvas();
-	for (size_t i = 0; i < lines.size(); i++)
+	for (std::map<int, Line>::iterator it = line_cache.begin(); it != line_cache.end(); ++it)
 	{
-		Line &line = lines[i];
+		int i = it->first;
+		Line &line = it->second;
 		if (line.box.top <= mouse_wincoords.y && line.box.bottom > mouse_wincoords.y)
 		{
 			SpanLayout::HitTestResult result = line.layout.hit_test(canvas, mouse_wincoords);
 			switch (result.type)
 			{
 			case SpanLayout::HitTestResult::inside:
-				return Vec2i(clamp(result.offset, 0, line.text.size()), i);
+				return Vec2i(clamp(result.offset, 0, buffer.get_line_length(i)), i);
 			case SpanLayout::HitTestResult::outside_left:
 				return Vec2i(0, i);
 			case SpanLayout::HitTestResult::outside_right:
-				return Vec2i(line.text.size(), i);
+				return Vec2i(buffer.get_line_length(i), i);
 			}
 		}
 	}
 
-	return Vec2i(lines.back().text.size(), lines.size() - 1);
+	return buffer.from_offset(buffer.get_length());
 }
 
 }
@@ -0,0 +1,382 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "GUI/precomp.h"
+#include "textedit_buffer.h"
+#include <algorithm>
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// TextEditBuffer Construction:
+
+TextEditBuffer::TextEditBuffer()
+: root(0), random_seed(2463534242u)
+{
+}
+
+TextEditBuffer::~TextEditBuffer()
+{
+	destroy(root);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// TextEditBuffer Attributes:
+
+std::string::size_type TextEditBuffer::get_length() const
+{
+	return get_subtree_length(root);
+}
+
+int TextEditBuffer::get_line_count() const
+{
+	return get_subtree_newlines(root) + 1;
+}
+
+std::string::size_type TextEditBuffer::get_line_start(int line) const
+{
+	if (line <= 0)
+		return 0;
+	else if (line >= get_line_count())
+		return get_length();
+	else
+		return find_newline(line - 1) + 1;
+}
+
+std::string::size_type TextEditBuffer::get_line_length(int line) const
+{
+	std::string::size_type start = get_line_start(line);
+	if (line + 1 < get_line_count())
+		return find_newline(line) - start;
+	else
+		return get_length() - start;
+}
+
+std::string TextEditBuffer::get_line_text(int line) const
+{
+	return get_text(get_line_start(line), get_line_length(line));
+}
+
+std::string TextEditBuffer::get_text() const
+{
+	return get_text(0, get_length());
+}
+
+std::string TextEditBuffer::get_text(std::string::size_type offset, std::string::size_type length) const
+{
+	std::string::size_type end = offset + std::min(length, get_length() - std::min(offset, get_length()));
+
+	std::string text;
+	text.reserve(end - std::min(offset, end));
+	append_text(root, 0, offset, end, text);
+	return text;
+}
+
+std::string::size_type TextEditBuffer::to_offset(Vec2i pos) const
+{
+	if (pos.y < get_line_count())
+		return get_line_start(pos.y) + std::min((std::string::size_type)pos.x, get_line_length(pos.y));
+	else
+		return get_length();
+}
+
+Vec2i TextEditBuffer::from_offset(std::string::size_type offset) const
+{
+	offset = std::min(offset, get_length());
+
+	// Count the newlines in front of the offset
+	int line = 0;
+	std::string::size_type pos = offset;
+	const Node *node = root;
+	while (node)
+	{
+		std::string::size_type left_length = get_subtree_length(node->left);
+		if (pos < left_length)
+		{
+			node = node->left;
+			continue;
+		}
+
+		pos -= left_length;
+		line += get_subtree_newlines(node->left);
+		if (pos < node->length)
+		{
+			line += count_newlines(node->start, node->start + pos);
+			break;
+		}
+
+		pos -= node->length;
+		line += node->newlines;
+		node = node->right;
+	}
+
+	return Vec2i(offset - get_line_start(line), line);
+}
+
+std::vector<TextEditBuffer::Piece> TextEditBuffer::get_pieces() const
+{
+	std::vector<Piece> pieces;
+	append_pieces(root, pieces);
+	return pieces;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// TextEditBuffer Operations:
+
+void TextEditBuffer::set_text(const std::string &text)
+{
+	destroy(root);
+	root = 0;
+	storage.clear();
+	storage_newlines.clear();
+	insert(0, text);
+}
+
+void TextEditBuffer::set_pieces(const std::vector<Piece> &pieces)
+{
+	destroy(root);
+	root = 0;
+	for (size_t i = 0; i < pieces.size(); i++)
+	{
+		if (pieces[i].length > 0)
+			root = merge(root, create_node(pieces[i].start, pieces[i].length));
+	}
+}
+
+void TextEditBuffer::insert(std::string::size_type offset, const std::string &text)
+{
+	if (text.empty())
+		return;
+
+	std::string::size_type start = storage.length();
+	storage.append(text);
+	for (std::string::size_type pos = text.find('\n'); pos != std::string::npos; pos = text.find('\n', pos + 1))
+		storage_newlines.push_back(start + pos);
+
+	Node *left, *right;
+	split(root, std::min(offset, get_length()), left, right);
+
+	// When typing, the previous piece usually ends where the new text was appended to the storage
+	if (!extend_last(left, start, text.length()))
+		left = merge(left, create_node(start, text.length()));
+
+	root = merge(left, right);
+}
+
+void TextEditBuffer::erase(std::string::size_type offset, std::string::size_type length)
+{
+	if (length == 0 || offset >= get_length())
+		return;
+
+	Node *left, *middle, *right;
+	split(root, offset, left, right);
+	split(right, length, middle, right);
+	destroy(middle);
+	root = merge(left, right);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// TextEditBuffer Implementation:
+
+TextEditBuffer::Node *TextEditBuffer::create_node(std::string::size_type start, std::string::size_type length)
+{
+	// xorshift32
+	random_seed ^= random_seed << 13;
+	random_seed ^= random_seed >> 17;
+	random_seed ^= random_seed << 5;
+
+	Node *node = new Node;
+	node->start = start;
+	node->length = length;
+	node->newlines = count_newlines(start, start + length);
+	node->priority = random_seed;
+	node->left = 0;
+	node->right = 0;
+	update(node);
+	return node;
+}
+
+void TextEditBuffer::destroy(Node *node)
+{
+	if (node)
+	{
+		destroy(node->left);
+		destroy(node->right);
+		delete node;
+	}
+}
+
+void TextEditBuffer::update(Node *node)
+{
+	node->subtree_length = get_subtree_length(node->left) + node->length + get_subtree_length(node->right);
+	node->subtree_newlines = get_subtree_newlines(node->left) + node->newlines + get_subtree_newlines(node->right);
+}
+
+TextEditBuffer::Node *TextEditBuffer::merge(Node *left, Node *right)
+{
+	if (!left)
+		return right;
+	if (!right)
+		return left;
+
+	if (left->priority > right->priority)
+	{
+		left->right = merge(left->right, right);
+		update(left);
+		return left;
+	}
+	else
+	{
+		right->left = merge(left, right->left);
+		update(right);
+		return right;
+	}
+}
+
+void TextEditBuffer::split(Node *node, std::string::size_type offset, Node *&out_left, Node *&out_right)
+{
+	if (!node)
+	{
+		out_left = 0;
+		out_right = 0;
+		return;
+	}
+
+	std::string::size_type left_length = get_subtree_length(node->left);
+	if (offset <= left_length)
+	{
+		split(node->left, offset, out_left, node->left);
+		update(node);
+		out_right = node;
+	}
+	else if (offset >= left_length + node->length)
+	{
+		split(node->right, offset - left_length - node->length, node->right, out_right);
+		update(node);
+		out_left = node;
+	}
+	else
+	{
+		// The split point is inside this piece. Cut off the tail as a new piece.
+		std::string::size_type local_offset = offset - left_length;
+		Node *tail = create_node(node->start + local_offset, node->length - local_offset);
+		out_right = merge(tail, node->right);
+
+		node->length = local_offset;
+		node->newlines -= tail->newlines;
+		node->right = 0;
+		update(node);
+		out_left = node;
+	}
+}
+
+bool TextEditBuffer::extend_last(Node *node, std::string::size_type start, std::string::size_type length)
+{
+	if (!node)
+		return false;
+
+	if (node->right)
+	{
+		if (!extend_last(node->right, start, length))
+			return false;
+	}
+	else
+	{
+		if (node->start + node->length != start)
+			return false;
+		node->length += length;
+		node->newlines = count_newlines(node->start, node->start + node->length);
+	}
+
+	update(node);
+	return true;
+}
+
+void TextEditBuffer::append_text(const Node *node, std::string::size_type node_offset, std::string::size_type start, std::string::size_type end, std::string &out_text) const
+{
+	if (!node || start >= end || end <= node_offset || start >= node_offset + node->subtree_length)
+		return;
+
+	append_text(node->left, node_offset, start, end, out_text);
+
+	std::string::size_type piece_offset = node_offset + get_subtree_length(node->left);
+	std::string::size_type piece_start = std::max(start, piece_offset);
+	std::string::size_type piece_end = std::min(end, piece_offset + node->length);
+	if (piece_start < piece_end)
+		out_text.append(storage, node->start + piece_start - piece_offset, piece_end - piece_start);
+
+	append_text(node->right, piece_offset + node->length, start, end, out_text);
+}
+
+void TextEditBuffer::append_pieces(const Node *node, std::vector<Piece> &out_pieces) const
+{
+	if (node)
+	{
+		append_pieces(node->left, out_pieces);
+		out_pieces.push_back(Piece(node->start, node->length));
+		append_pieces(node->right, out_pieces);
+	}
+}
+
+std::string::size_type TextEditBuffer::find_newline(int index) const
+{
+	std::string::size_type offset = 0;
+	const Node *node = root;
+	while (node)
+	{
+		int left_newlines = get_subtree_newlines(node->left);
+		if (index < left_newlines)
+		{
+			node = node->left;
+			continue;
+		}
+
+		index -= left_newlines;
+		offset += get_subtree_length(node->left);
+		if (index < node->newlines)
+		{
+			std::vector<std::string::size_type>::const_iterator first = std::lower_bound(storage_newlines.begin(), storage_newlines.end(), node->start);
+			return offset + first[index] - node->start;
+		}
+
+		index -= node->newlines;
+		offset += node->length;
+		node = node->right;
+	}
+	return get_length();
+}
+
+int TextEditBuffer::count_newlines(std::string::size_type start, std::string::size_type end) const
+{
+	std::vector<std::string::size_type>::const_iterator first = std::lower_bound(storage_newlines.begin(), storage_newlines.end(), start);
+	std::vector<std::string::size_type>::const_iterator last = std::lower_bound(first, storage_newlines.end(), end);
+	return last - first;
+}
+
+}
@@ -0,0 +1,122 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Core/Math/vec2.h"
+#include <string>
+#include <vector>
+
+namespace clan
+{
+
+/// \brief Piece table holding the text of a TextEdit
+///
+/// All text ever inserted is appended to a single storage string. The document is a sequence
+/// of pieces pointing into that storage, kept in a treap ordered by document position. Every
+/// node knows the length and newline count of its subtree, so inserts, deletes and conversions
+/// between offsets and line/column positions are O(log n) in the number of pieces.
+class TextEditBuffer
+{
+public:
+	TextEditBuffer();
+	~TextEditBuffer();
+
+	/// \brief A span of the storage string. A list of pieces can restore an earlier state of the document.
+	struct Piece
+	{
+		Piece() : start(0), length(0) { }
+		Piece(std::string::size_type start, std::string::size_type length) : start(start), length(length) { }
+
+		std::string::size_type start;
+		std::string::size_type length;
+	};
+
+	std::string::size_type get_length() const;
+	int get_line_count() const;
+	std::string::size_type get_line_start(int line) const;
+	std::string::size_type get_line_length(int line) const;
+	std::string get_line_text(int line) const;
+	std::string get_text() const;
+	std::string get_text(std::string::size_type offset, std::string::size_type length) const;
+
+	/// \brief Converts a (column, line) position to an offset. Positions past the end are clamped.
+	std::string::size_type to_offset(Vec2i pos) const;
+
+	/// \brief Converts an offset to a (column, line) position. Offsets past the end are clamped.
+	Vec2i from_offset(std::string::size_type offset) const;
+
+	/// \brief Returns the pieces of the current document
+	std::vector<Piece> get_pieces() const;
+
+	/// \brief Replaces the document. Discards all storage, invalidating earlier piece lists.
+	void set_text(const std::string &text);
+
+	/// \brief Replaces the document with a piece list returned by get_pieces()
+	void set_pieces(const std::vector<Piece> &pieces);
+
+	void insert(std::string::size_type offset, const std::string &text);
+	void erase(std::string::size_type offset, std::string::size_type length);
+
+private:
+	TextEditBuffer(const TextEditBuffer &);
+	TextEditBuffer &operator=(const TextEditBuffer &);
+
+	struct Node
+	{
+		std::string::size_type start;
+		std::string::size_type length;
+		int newlines;
+		std::string::size_type subtree_length;
+		int subtree_newlines;
+		unsigned int priority;
+		Node *left;
+		Node *right;
+	};
+
+	Node *create_node(std::string::size_type start, std::string::size_type length);
+	void destroy(Node *node);
+	void update(Node *node);
+	Node *merge(Node *left, Node *right);
+	void split(Node *node, std::string::size_type offset, Node *&out_left, Node *&out_right);
+	bool extend_last(Node *node, std::string::size_type start, std::string::size_type length);
+	void append_text(const Node *node, std::string::size_type node_offset, std::string::size_type start, std::string::size_type end, std::string &out_text) const;
+	void append_pieces(const Node *node, std::vector<Piece> &out_pieces) const;
+	std::string::size_type find_newline(int index) const;
+	int count_newlines(std::string::size_type start, std::string::size_type end) const;
+
+	static std::string::size_type get_subtree_length(const Node *node) { return node ? node->subtree_length : 0; }
+	static int get_subtree_newlines(const Node *node) { return node ? node->subtree_newlines : 0; }
+
+	std::string storage;
+	std::vector<std::string::size_type> storage_newlines;
+	Node *root;
+	unsigned int random_seed;
+};
+
+}
@@ -30,6 +30,8 @@
 #pragma once
 
 #include "API/GUI/Components/scrollbar.h"
+#include "textedit_buffer.h"
+#include <map>
 
 namespace clan
 {
@@ -54,7 +56,6 @@ public:
 		cursor_drawing_enabled_when_parent_focused(false),
 		select_all_on_focus_gain(false)
 	{
-		lines.resize(1);
 	}
 
 	~TextEdit_Impl()
@@ -76,7 +77,8 @@ public:
 	void on_vertical_scroll();
 	void update_vertical_scroll();
 	void move_vertical_scroll();
-	int  get_total_line_height();
+	int  get_line_height();
+	int  get_text_height(Canvas &canvas, int first_line);
 
 	Callback_v1<InputEvent &> func_before_edit_changed;
 	Callback_v1<InputEvent &> func_after_edit_changed;
@@ -87,18 +89,19 @@ public:
 
 	struct Line
 	{
-		Line() : invalidated(true) { }
+		Line() : invalidated(true), width(0) { }
 
-		std::string text;
 		SpanLayout layout;
 		Rect box;
 		bool invalidated;
+		int width;
 	};
 
 	TextEdit *textedit;
 	ScrollBar *vert_scrollbar;
 	Timer timer;
-	std::vector<Line> lines;
+	TextEditBuffer buffer;
+	std::map<int, Line> line_cache;	// Layouts of the visible lines, keyed by line number
 	Vec2i cursor_pos;
 	int max_length;
 	bool mouse_selecting;
@@ -119,6 +122,9 @@ public:
 
 	void move(int steps, bool shift, bool ctrl);
 	void insert_text(Vec2i pos, const std::string &str);
+	void insert_buffer_text(std::string::size_type offset, const std::string &str);
+	void erase_buffer_text(std::string::size_type offset, std::string::size_type length);
+	void update_line_cache(int first_line, int old_end_line, int new_end_line);
 	void backspace();
 	void del();
 	Vec2i get_character_index(Point mouse_wincoords);
@@ -155,7 +161,7 @@ public:
 		*/
 
 		UndoInfo() : first_erase(0), first_text_insert(0) {}
-		std::string undo_text;
+		std::vector<TextEditBuffer::Piece> undo_pieces;
 		bool first_erase;
 		bool first_text_insert;
 	} undo_info;
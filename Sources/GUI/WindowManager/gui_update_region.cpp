@@ -0,0 +1,195 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "GUI/precomp.h"
+#include "gui_update_region.h"
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// GUIUpdateRegion Construction:
+
+GUIUpdateRegion::GUIUpdateRegion(int max_rects)
+: max_rects(max_rects)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GUIUpdateRegion Attributes:
+
+Rect GUIUpdateRegion::get_bounds() const
+{
+	if (rects.empty())
+		return Rect();
+
+	Rect bounds = rects[0];
+	for (size_t i = 1; i < rects.size(); i++)
+		bounds.bounding_rect(rects[i]);
+	return bounds;
+}
+
+int GUIUpdateRegion::get_area() const
+{
+	// The rectangles never overlap, so the area is simply the sum
+	int area = 0;
+	for (size_t i = 0; i < rects.size(); i++)
+		area += get_area(rects[i]);
+	return area;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GUIUpdateRegion Operations:
+
+void GUIUpdateRegion::add(const Rect &rect)
+{
+	if (rect.left >= rect.right || rect.top >= rect.bottom)
+		return;
+
+	for (size_t i = 0; i < rects.size(); i++)
+	{
+		if (rects[i].is_inside(rect))
+			return;
+	}
+
+	// Coalesce with neighbours as long as the bounding box is at most a quarter larger than the area covered
+	Rect merged = rect;
+	bool found;
+	do
+	{
+		found = false;
+		for (size_t i = 0; i < rects.size(); i++)
+		{
+			int covered = get_area(rects[i]) + get_area(merged);
+			if (merged.is_inside(rects[i]) || get_merge_waste(rects[i], merged) * 4 <= covered)
+			{
+				merged.bounding_rect(rects[i]);
+				rects.erase(rects.begin() + i);
+				found = true;
+				break;
+			}
+		}
+	} while (found);
+
+	// Keep the list disjoint by only adding the parts not already covered
+	std::vector<Rect> fragments;
+	fragments.push_back(merged);
+	for (size_t i = 0; i < rects.size(); i++)
+	{
+		std::vector<Rect> remaining;
+		for (size_t j = 0; j < fragments.size(); j++)
+		{
+			if (rects[i].is_overlapped(fragments[j]))
+				subtract(fragments[j], rects[i], remaining);
+			else
+				remaining.push_back(fragments[j]);
+		}
+		fragments.swap(remaining);
+	}
+	rects.insert(rects.end(), fragments.begin(), fragments.end());
+
+	while ((int)rects.size() > max_rects)
+		merge_cheapest_pair();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GUIUpdateRegion Implementation:
+
+void GUIUpdateRegion::merge_cheapest_pair()
+{
+	size_t best_a = 0, best_b = 1;
+	int best_waste = get_merge_waste(rects[0], rects[1]);
+	for (size_t a = 0; a < rects.size(); a++)
+	{
+		for (size_t b = a + 1; b < rects.size(); b++)
+		{
+			int waste = get_merge_waste(rects[a], rects[b]);
+			if (waste < best_waste)
+			{
+				best_waste = waste;
+				best_a = a;
+				best_b = b;
+			}
+		}
+	}
+
+	Rect merged = rects[best_a];
+	merged.bounding_rect(rects[best_b]);
+	rects.erase(rects.begin() + best_b);
+	rects.erase(rects.begin() + best_a);
+
+	// The bounding box may now overlap other rectangles. Absorb them to keep the list disjoint.
+	bool found;
+	do
+	{
+		found = false;
+		for (size_t i = 0; i < rects.size(); i++)
+		{
+			if (rects[i].is_overlapped(merged))
+			{
+				merged.bounding_rect(rects[i]);
+				rects.erase(rects.begin() + i);
+				found = true;
+				break;
+			}
+		}
+	} while (found);
+
+	rects.push_back(merged);
+}
+
+int GUIUpdateRegion::get_merge_waste(const Rect &a, const Rect &b)
+{
+	Rect bounds = a;
+	bounds.bounding_rect(b);
+	Rect intersection = a;
+	intersection.overlap(b);
+	return get_area(bounds) - (get_area(a) + get_area(b) - get_area(intersection));
+}
+
+void GUIUpdateRegion::subtract(const Rect &rect, const Rect &hole, std::vector<Rect> &out_fragments)
+{
+	// Split into up to four bands: above, below, left of and right of the hole
+	Rect middle = rect;
+	if (hole.top > rect.top)
+	{
+		out_fragments.push_back(Rect(rect.left, rect.top, rect.right, hole.top));
+		middle.top = hole.top;
+	}
+	if (hole.bottom < rect.bottom)
+	{
+		out_fragments.push_back(Rect(rect.left, hole.bottom, rect.right, rect.bottom));
+		middle.bottom = hole.bottom;
+	}
+	if (hole.left > rect.left)
+		out_fragments.push_back(Rect(rect.left, middle.top, hole.left, middle.bottom));
+	if (hole.right < rect.right)
+		out_fragments.push_back(Rect(hole.right, middle.top, rect.right, middle.bottom));
+}
+
+}
@@ -0,0 +1,66 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Core/Math/rect.h"
+#include <vector>
+
+namespace clan
+{
+
+/// \brief Damaged area of a window, kept as a short list of non-overlapping rectangles
+///
+/// Added rectangles are merged with their neighbours when the bounding box does not waste
+/// much area, and clipped against the existing rectangles otherwise. If the list grows beyond
+/// max_rects the two rectangles whose bounding box wastes the least area are merged.
+class GUIUpdateRegion
+{
+public:
+	GUIUpdateRegion(int max_rects = 8);
+
+	bool is_empty() const { return rects.empty(); }
+	const std::vector<Rect> &get_rects() const { return rects; }
+	Rect get_bounds() const;
+	int get_area() const;
+
+	void add(const Rect &rect);
+	void clear() { rects.clear(); }
+
+private:
+	void merge_cheapest_pair();
+
+	static int get_area(const Rect &rect) { return rect.get_width() * rect.get_height(); }
+	static int get_merge_waste(const Rect &a, const Rect &b);
+	static void subtract(const Rect &rect, const Rect &hole, std::vector<Rect> &out_fragments);
+
+	std::vector<Rect> rects;
+	int max_rects;
+};
+
+}
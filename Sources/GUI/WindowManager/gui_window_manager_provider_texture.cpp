@@ -52,9 +52,10 @@ namespace clan
 
 GUIWindowManagerProvider_Texture::GUIWindowManagerProvider_Texture(DisplayWindow &display_window)
 	: site(0), activated_window(0), capture_mouse_window(NULL), display_window(display_window), canvas_window(display_window),
-  frame_buffer_initial_setup(false), frame_buffer_stencil_attached(false), frame_buffer_depth_attached(false)
+  frame_buffer_initial_setup(false), frame_buffer_stencil_attached(false), frame_buffer_depth_attached(false), composite_dirty(true)
 {
 	slots.connect(display_window.sig_window_close(), this, &GUIWindowManagerProvider_Texture::on_displaywindow_window_close);
+	slots.connect(display_window.sig_paint(), this, &GUIWindowManagerProvider_Texture::on_displaywindow_paint);
 
 	InputContext ic = display_window.get_ic();
 	slots.connect(ic.get_mouse().sig_key_up(), this, &GUIWindowManagerProvider_Texture::on_input_mouse_up);
@@ -117,8 +118,9 @@ void GUIWindowManagerProvider_Texture::update_paint()
 		if (it->second->dirty)
 		{
 			it->second->dirty = false;
+			composite_dirty = true;
 			// Make a copy, since on_render() may call request_repaint()
-			std::vector<Rect> update_region_list = it->second->update_region_list;
+			std::vector<Rect> update_region_list = it->second->update_region.get_rects();
 			std::vector<Rect>::size_type size = update_region_list.size();
 			for (int i = 0; i < size; i++)
 			{
@@ -144,6 +146,11 @@ void GUIWindowManagerProvider_Texture::on_displaywindow_window_close()
 	site->func_close->invoke(activated_window);
 }
 
+void GUIWindowManagerProvider_Texture::on_displaywindow_paint(const Rect &rect)
+{
+	composite_dirty = true;
+}
+
 void GUIWindowManagerProvider_Texture::on_input(const InputEvent &input_event)
 {
 	if (activated_window == 0)
@@ -344,6 +351,7 @@ void GUIWindowManagerProvider_Texture::bring_to_front(GUITopLevelWindow *handle)
 			it = std::find(root_window_z_order.begin(), root_window_z_order.end(), root_texture);
 			root_window_z_order.erase(it);
 			root_window_z_order.insert(root_window_z_order.begin(), root_texture);
+			composite_dirty = true;
 		}
 
 		// Check owner window order
@@ -356,6 +364,7 @@ void GUIWindowManagerProvider_Texture::bring_to_front(GUITopLevelWindow *handle)
 				it = std::find(z_order.begin(), z_order.end(), texture);
 				z_order.erase(it);
 				z_order.insert(z_order.begin(), texture);
+				composite_dirty = true;
 			}
 		}
 	}
@@ -418,6 +427,7 @@ void GUIWindowManagerProvider_Texture::create_window(
 	}
 
 	activated_window = handle;
+	composite_dirty = true;
 
 	clear_frame_buffer(toplevel_window);
 
@@ -457,6 +467,7 @@ void GUIWindowManagerProvider_Texture::destroy_window(GUITopLevelWindow *handle)
 
 	delete toplevel_window;
 	window_map.erase(window_map.find(handle));
+	composite_dirty = true;
 }
 
 void GUIWindowManagerProvider_Texture::enable_window(GUITopLevelWindow *handle, bool enable)
@@ -474,6 +485,7 @@ void GUIWindowManagerProvider_Texture::set_visible(GUITopLevelWindow *handle, bo
 {
 	GUITopLevelWindowTexture *toplevel_window = get_window_texture(handle);
 	toplevel_window->visible = visible;
+	composite_dirty = true;
 	if (activate)
 		activated_window = handle;
 }
@@ -483,6 +495,7 @@ void GUIWindowManagerProvider_Texture::set_geometry(GUITopLevelWindow *handle, c
 	// to-do: convert client area rect to window area rect, if needed.
 
 	GUITopLevelWindowTexture *toplevel_window = get_window_texture(handle);
+	composite_dirty = true;
 
 	if ((toplevel_window->geometry.get_width() == geometry.get_width()) &&
 		(toplevel_window->geometry.get_height() == geometry.get_height()) )
@@ -623,39 +636,12 @@ void GUIWindowManagerProvider_Texture::request_repaint(GUITopLevelWindow *handle
 	}
 
 	GUITopLevelWindowTexture *wptr = get_window_texture(handle);
-	if (wptr->dirty)
-	{
-		// If the update region is already set, then check to see if it is a seperate rect or if it
-		// should be extended to include the new update region
-
-		bool updated = false;
-		std::vector<Rect>::size_type size = wptr->update_region_list.size();
-		for (int i = 0; i < size; i++)
-		{
-			if (wptr->update_region_list[i].is_overlapped(update_region))
-			{
-				// Found an overlapping section
-				wptr->update_region_list[i].bounding_rect(update_region);
-				updated = true;
-				break;
-			}
-		}
-
-		if (!updated)
-		{
-			wptr->update_region_list.push_back(update_region);
-		}
-		else
-		{
-			//TODO: Check for overlapping rects in the wptr->update_region_list
-		}
-	}
-	else
+	if (!wptr->dirty)
 	{
 		wptr->dirty = true;
-		wptr->update_region_list.clear();
-		wptr->update_region_list.push_back(update_region);
+		wptr->update_region.clear();
 	}
+	wptr->update_region.add(update_region);
 }
 
 void GUIWindowManagerProvider_Texture::update()
@@ -666,8 +652,10 @@ void GUIWindowManagerProvider_Texture::update()
 	{
 		func_repaint.invoke();
 	}
-	else
+	else if (composite_dirty)
 	{
+		// Nothing is drawn or flipped when no window texture changed since the last frame
+		composite_dirty = false;
 		canvas_window.clear(Colorf::black); // Do not change this to Colorf::transparent. It has unintended side effects on windows with an alpha channel.
 		draw_windows(canvas_window);
 		canvas_window.flush();
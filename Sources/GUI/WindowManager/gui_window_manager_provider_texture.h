@@ -44,6 +44,7 @@
 #include "API/Display/2D/subtexture.h"
 #include "API/GUI/gui_component.h"
 #include "API/GUI/Providers/gui_window_manager_provider.h"
+#include "gui_update_region.h"
 #include <map>
 #include "API/Display/2D/canvas.h"
 
@@ -75,7 +76,7 @@ public:
 	GUITopLevelWindowTexture *owner_window;
 	std::vector<GUITopLevelWindowTexture *> child_windows_zorder;	// Beginning is at the top
 
-	std::vector<Rect> update_region_list;		// Only valid when "dirty" is set to true
+	GUIUpdateRegion update_region;		// Only valid when "dirty" is set to true
 };
 
 class GUIWindowManagerProvider_Texture : public GUIWindowManagerProvider
@@ -115,6 +116,7 @@ public:
 	bool frame_buffer_stencil_attached;
 	bool frame_buffer_depth_attached;
 	Texture2D frame_buffer_texture_attached;	// A copy of the last texture that is attached to the frame buffer
+	bool composite_dirty;	// The window textures must be drawn to the display window again
 
 /// \}
 /// \name Operations
@@ -123,6 +125,7 @@ public:
 	void set_texture_group(TextureGroup &new_texture_group);
 
 	void on_displaywindow_window_close();
+	void on_displaywindow_paint(const Rect &rect);
 
 	void on_input(const InputEvent &event);
 	void on_input_mouse_up(const InputEvent &event);
@@ -31,10 +31,12 @@
 #include "API/Core/IOData/file_system.h"
 #include "API/Core/IOData/path_help.h"
 #include "API/Core/IOData/iodevice.h"
+#include "API/Core/IOData/iodevice_memory.h"
 #include "API/Core/XML/dom_document.h"
 #include "API/Core/XML/dom_element.h"
 #include "API/Core/XML/dom_text.h"
 #include "API/Core/Text/string_help.h"
+#include "API/Core/System/system.h"
 #include "API/Display/Render/graphic_context.h"
 #include "API/Display/Window/input_context.h"
 #include "API/Display/2D/canvas.h"
@@ -57,6 +59,7 @@
 #include "gui_manager_impl.h"
 #include "gui_component_description_impl.h"
 #include "gui_xml_loader_version_1_0.h"
+#include "gui_loader_node.h"
 #include "gui_component_select_node.h"
 #include "gui_element.h"
 
@@ -618,6 +621,11 @@ bool GUIComponent::get_constant_repaint() const
 	return impl->constant_repaint;
 }
 
+bool GUIComponent::get_cached_layer() const
+{
+	return impl->cached_layer;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // GUIComponent Events:
 
@@ -755,6 +763,12 @@ void GUIComponent::render(Canvas &canvas, const Rect &clip_rect, bool include_ch
 	if (!impl->visible)
 		return;
 
+	if (impl->cached_layer && include_children && !impl->rendering_layer)
+	{
+		impl->render_cached_layer(canvas);
+		return;
+	}
+
 	Rect viewport = get_top_level_component()->get_size();
 	CSSResourceCache *resource_cache = &impl->gui_manager_impl->resource_cache;
 	CSSLayoutGraphics graphics(canvas, resource_cache, viewport, 0);
@@ -777,6 +791,7 @@ void GUIComponent::render(Canvas &canvas, const Rect &clip_rect, bool include_ch
 
 	if (impl->func_render.is_null() == false)
 	{
+		GUIProfileScope profile_scope(impl->gui_manager_impl->profiler, GUIProfiler::category_render, this);
 		impl->func_render.invoke(canvas, clip_rect);
 	}
 	else
@@ -829,9 +844,16 @@ void GUIComponent::paint(const Rect &clip_rect)
 	GUIComponent *toplevel_component = get_top_level_component();
 	GUITopLevelWindow *toplevel_window = impl->gui_manager.lock()->get_toplevel_window(this);
 
+	ubyte64 start_time = System::get_microseconds();
+
 	Canvas canvas = impl->gui_manager.lock()->window_manager.begin_paint(toplevel_window, update_region);
 	toplevel_component->render(canvas, update_region, true);
 	impl->gui_manager.lock()->window_manager.end_paint(canvas, toplevel_window, update_region);
+
+	GUIPaintStatistics &statistics = impl->gui_manager_impl->paint_statistics;
+	statistics.paint_count++;
+	statistics.painted_pixels += update_region.get_width() * update_region.get_height();
+	statistics.paint_time += System::get_microseconds() - start_time;
 }
 
 int GUIComponent::exec()
@@ -1028,37 +1050,50 @@ GUIComponent *GUIComponent::get_named_item(const std::string &id)
 
 void GUIComponent::create_components(const DomDocument &gui_xml)
 {
-	DomDocument const_hack = gui_xml;
+	GUIXMLLoaderVersion_1_0 loader(this, impl->layout);
+	loader.set_create_custom_callback(&impl->func_create_custom_component);
+	loader.load(GUILoaderNode::from_gui_xml(gui_xml));
+}
 
-	// Check if loaded document uses namespaces and if its a clanlib resources xml document:
-	DomElement doc_element = const_hack.get_document_element();
-	if (doc_element.get_namespace_uri() == "http://clanlib.org/xmlns/gui-1.0")
+void GUIComponent::create_components(const std::string &filename, const FileSystem &fs)
+{
+	IODevice device;
+	device = fs.open_file(filename);
+	create_components(device);
+}
+
+void GUIComponent::create_components(IODevice &file)
+{
+	int size = file.get_size();
+	if (size < 0)
 	{
-		if (doc_element.get_local_name() != "gui")
-			throw Exception("ClanLib GUI XML documents must begin with a gui element.");
+		DomDocument doc;
+		doc.load(file);
+		create_components(doc);
+		return;
+	}
 
+	DataBuffer data(size);
+	file.read(data.get_data(), data.get_size());
+
+	if (GUILoaderNode::is_compiled(data))
+	{
 		GUIXMLLoaderVersion_1_0 loader(this, impl->layout);
 		loader.set_create_custom_callback(&impl->func_create_custom_component);
-		loader.load(const_hack);
+		loader.load(GUILoaderNode::read(data));
 	}
 	else
 	{
-		throw Exception("XML document is not a ClanLib GUI XML document.");
+		IODevice_Memory memory(data);
+		DomDocument doc;
+		doc.load(memory);
+		create_components(doc);
 	}
 }
 
-void GUIComponent::create_components(const std::string &filename, const FileSystem &fs)
-{
-	IODevice device;
-	device = fs.open_file(filename);
-	create_components(device);
-}
-
-void GUIComponent::create_components(IODevice &file)
+void GUIComponent::compile_components(const DomDocument &gui_xml, IODevice &output)
 {
-	DomDocument doc;
-	doc.load(file); 
-	create_components(doc);
+	GUILoaderNode::from_gui_xml(gui_xml).write(output);
 }
 
 void GUIComponent::create_components(const std::string &fullname)
@@ -1071,6 +1106,7 @@ void GUIComponent::create_components(const std::string &fullname)
 
 void GUIComponent::request_repaint(Rect request_repaint)
 {
+	impl->invalidate_cached_layers();
 	get_gui_manager().request_repaint(component_to_window_coords(request_repaint), get_top_level_component());
 }
 
@@ -1082,6 +1118,12 @@ void GUIComponent::request_repaint()
 void GUIComponent::set_cliprect(Canvas &canvas, const Rect &rect)
 {
 	Rect windcliprect = component_to_window_coords(rect);
+	if (impl->gui_manager_impl->active_layer)
+	{
+		canvas.set_cliprect(impl->window_to_layer_coords(windcliprect));
+		return;
+	}
+
 	GUIComponent *toplevel = get_top_level_component();
 	GUITopLevelWindow *window = impl->gui_manager_impl->get_toplevel_window(toplevel);
 	impl->gui_manager_impl->window_manager.set_cliprect(window, canvas, windcliprect);
@@ -1089,6 +1131,12 @@ void GUIComponent::set_cliprect(Canvas &canvas, const Rect &rect)
 
 void GUIComponent::reset_cliprect(Canvas &canvas)
 {
+	if (impl->gui_manager_impl->active_layer)
+	{
+		canvas.reset_cliprect();
+		return;
+	}
+
 	GUIComponent *toplevel = get_top_level_component();
 	GUITopLevelWindow *window = impl->gui_manager_impl->get_toplevel_window(toplevel);
 	impl->gui_manager_impl->window_manager.reset_cliprect(window, canvas);
@@ -1097,6 +1145,12 @@ void GUIComponent::reset_cliprect(Canvas &canvas)
 void GUIComponent::push_cliprect(Canvas &canvas, const Rect &rect)
 {
 	Rect windcliprect = component_to_window_coords(rect);
+	if (impl->gui_manager_impl->active_layer)
+	{
+		canvas.push_cliprect(impl->window_to_layer_coords(windcliprect));
+		return;
+	}
+
 	GUIComponent *toplevel = get_top_level_component();
 	GUITopLevelWindow *window = impl->gui_manager_impl->get_toplevel_window(toplevel);
 	impl->gui_manager_impl->window_manager.push_cliprect(window, canvas, windcliprect);
@@ -1104,6 +1158,12 @@ void GUIComponent::push_cliprect(Canvas &canvas, const Rect &rect)
 
 void GUIComponent::pop_cliprect(Canvas &canvas)
 {
+	if (impl->gui_manager_impl->active_layer)
+	{
+		canvas.pop_cliprect();
+		return;
+	}
+
 	GUIComponent *toplevel = get_top_level_component();
 	GUITopLevelWindow *window = impl->gui_manager_impl->get_toplevel_window(toplevel);
 	impl->gui_manager_impl->window_manager.pop_cliprect(window, canvas);
@@ -1358,6 +1418,20 @@ void GUIComponent::set_blocks_default_action(bool block)
 	impl->blocks_default_action_when_focused = block;
 }
 
+void GUIComponent::set_cached_layer(bool enable)
+{
+	if (impl->cached_layer != enable)
+	{
+		impl->cached_layer = enable;
+		impl->layer_dirty = true;
+		if (!enable)
+		{
+			impl->layer_texture = Texture2D();
+			impl->layer_frame_buffer = FrameBuffer();
+		}
+	}
+}
+
 void GUIComponent::set_constant_repaint(bool enable)
 {
 	impl->constant_repaint = enable;
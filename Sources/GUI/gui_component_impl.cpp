@@ -32,6 +32,8 @@
 #include "API/GUI/gui_component.h"
 #include "API/GUI/gui_message_pointer.h"
 #include "API/Display/2D/image.h"
+#include "API/Display/2D/canvas.h"
+#include "API/Display/Render/blend_state_description.h"
 #include "Layout/gui_css_box_visitor.h"
 #include "Layout/gui_layout_content.h"
 #include "gui_component_impl.h"
@@ -49,7 +51,7 @@ GUIComponent_Impl::GUIComponent_Impl(const std::shared_ptr<GUIManager_Impl> &ini
 : gui_manager(init_gui_manager), parent(0), prev_sibling(0), next_sibling(0), first_child(0), last_child(0),
   focus_policy(GUIComponent::focus_refuse), allow_resize(false), clip_children(false), enabled(true),
   visible(true), activated(false), default_handler(false), cancel_handler(false),
-  constant_repaint(false), blocks_default_action_when_focused(false), is_selected_in_group(false), use_auto_geometry(true), double_click_enabled(true), pointer_inside_component(false), element(&init_gui_manager->resource_cache)
+  constant_repaint(false), blocks_default_action_when_focused(false), is_selected_in_group(false), use_auto_geometry(true), double_click_enabled(true), pointer_inside_component(false), cached_layer(false), layer_dirty(true), rendering_layer(false), element(&init_gui_manager->resource_cache)
 {
 	if (parent_or_owner)
 		element.set_parent(&parent_or_owner->impl->element);
@@ -179,7 +181,10 @@ void GUIComponent_Impl::geometry_updated(bool geometry_was_resized)
 	if (geometry_was_resized)
 	{
 		if (!func_resized.is_null())
+		{
+			GUIProfileScope profile_scope(gui_manager_impl->profiler, GUIProfiler::category_layout, component);
 			func_resized.invoke();
+		}
 	}
 
 	component->request_repaint();
@@ -200,10 +205,80 @@ void GUIComponent_Impl::invoke_enablemode_changed()
 
 void GUIComponent_Impl::layout_content()
 {
+	GUIProfileScope profile_scope(gui_manager_impl->profiler, GUIProfiler::category_layout, component);
+
+	if (gui_manager_impl->style_work_queue)
+		element.update_style_tree(gui_manager_impl->style_work_queue.get());
+
 	GUILayoutContent visitor;
 	visitor.node(this);
 }
 
+void GUIComponent_Impl::render_cached_layer(Canvas &canvas)
+{
+	Size size = geometry.get_size();
+	if (size.width <= 0 || size.height <= 0)
+		return;
+
+	if (layer_texture.is_null() || layer_texture.get_size() != size)
+	{
+		layer_texture = Texture2D(canvas, size);
+		layer_frame_buffer = FrameBuffer(canvas);
+		layer_frame_buffer.attach_color(0, layer_texture);
+		layer_dirty = true;
+	}
+
+	if (layer_dirty)
+	{
+		canvas.flush();
+
+		Canvas layer_canvas(canvas, layer_frame_buffer);
+		layer_canvas.clear(Colorf::transparent);
+
+		GUIComponent *prev_active_layer = gui_manager_impl->active_layer;
+		gui_manager_impl->active_layer = component;
+		rendering_layer = true;
+		component->render(layer_canvas, Rect(Point(0, 0), size), true);
+		rendering_layer = false;
+		gui_manager_impl->active_layer = prev_active_layer;
+
+		layer_canvas.flush();
+		layer_dirty = false;
+		gui_manager_impl->paint_statistics.layer_updates++;
+	}
+	else
+	{
+		gui_manager_impl->paint_statistics.layer_hits++;
+	}
+
+	// The layer was rendered onto a transparent texture, so its colors are premultiplied by alpha
+	if (gui_manager_impl->layer_blend.is_null())
+	{
+		BlendStateDescription blend_desc;
+		blend_desc.set_blend_function(blend_one, blend_one_minus_src_alpha, blend_one, blend_one_minus_src_alpha);
+		gui_manager_impl->layer_blend = BlendState(canvas, blend_desc);
+	}
+
+	canvas.set_blend_state(gui_manager_impl->layer_blend);
+	Image(layer_texture, Rect(Point(0, 0), size)).draw(canvas, 0.0f, 0.0f);
+	canvas.reset_blend_state();
+}
+
+void GUIComponent_Impl::invalidate_cached_layers()
+{
+	for (GUIComponent *cur = component; cur; cur = cur->impl->parent)
+	{
+		if (cur->impl->cached_layer)
+			cur->impl->layer_dirty = true;
+	}
+}
+
+Rect GUIComponent_Impl::window_to_layer_coords(const Rect &window_rect) const
+{
+	Point layer_origin = gui_manager_impl->active_layer->component_to_window_coords(Point(0, 0));
+	return Rect(window_rect).translate(-layer_origin.x, -layer_origin.y);
+}
+
 void GUIComponent_Impl::visit_children(GUICSSBoxVisitor *visitor, bool recursive)
 {
 	for (GUIComponent *child = first_child; child != 0; child = child->get_next_sibling())
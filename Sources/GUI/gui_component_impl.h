@@ -35,6 +35,8 @@
 #include "API/GUI/gui_component.h"
 #include "API/CSSLayout/ComputedValues/css_computed_values.h"
 #include "API/CSSLayout/CSSTokenizer/css_token.h"
+#include "API/Display/Render/texture_2d.h"
+#include "API/Display/Render/frame_buffer.h"
 #include "Layout/gui_css_used_values.h"
 #include <vector>
 #include <map>
@@ -112,6 +114,12 @@ public:
 	std::string group_name;
 	bool double_click_enabled;
 
+	bool cached_layer;
+	bool layer_dirty;
+	bool rendering_layer;
+	Texture2D layer_texture;
+	FrameBuffer layer_frame_buffer;
+
 	Rect geometry;
 	bool use_auto_geometry;
 
@@ -133,6 +141,10 @@ public:
 	void visit_children(GUICSSBoxVisitor *visitor, bool recursive);
 	void layout_content();
 
+	void render_cached_layer(Canvas &canvas);
+	void invalidate_cached_layers();
+	Rect window_to_layer_coords(const Rect &window_rect) const;
+
 	void on_process_message(std::shared_ptr<GUIMessage> &msg);
 	static CSSToken next_token(size_t &pos, const std::vector<CSSToken> &tokens, bool skip_whitespace = true);
 
@@ -35,13 +35,27 @@
 #include "API/CSSLayout/CSSDocument/css_document.h"
 #include "API/CSSLayout/CSSTokenizer/css_token.h"
 #include "gui_component_select_node.h"
+#include "gui_component_impl.h"
 #include "API/Display/2D/span_layout.h"
 #include "API/Display/Font/font_metrics.h"
+#include "API/Core/System/work_queue.h"
 #include "../CSSLayout/Layout/LayoutTree/css_used_value.h"
 
 namespace clan
 {
 
+class GUIElementSubtreeStyleUpdate : public WorkItem
+{
+public:
+	GUIElementSubtreeStyleUpdate(GUIElement *subtree) : subtree(subtree) { }
+	void process_work() { subtree->update_descendant_styles(); }
+
+private:
+	GUIElement *subtree;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+
 GUIElement::GUIElement(CSSResourceCache *resource_cache) : component(0), parent(0), prev_sibling(0), next_sibling(0), first_child(0), last_child(0), style_needs_update(true), computed_values(resource_cache)
 {
 }
@@ -250,6 +264,10 @@ void GUIElement::set_style_needs_update()
 {
 	style_needs_update = true;
 
+	// Cached layers inside the subtree must be rendered again with the new style
+	if (component && component->impl)
+		component->impl->layer_dirty = true;
+
 	GUIElement *child = get_first_child();
 	while (child)
 	{
@@ -274,6 +292,55 @@ void GUIElement::update_style()
 	style_needs_update = false;
 }
 
+void GUIElement::update_style_tree(WorkQueue *work_queue)
+{
+	if (style_needs_update)
+		update_style();
+
+	if (work_queue == 0)
+	{
+		update_descendant_styles();
+	}
+	else
+	{
+		// Selection only writes to the element itself and its own descendants, so the subtrees can be
+		// handed to the workers once their roots have been selected here.
+		size_t min_subtrees = work_queue->get_thread_count() * 4;
+		std::vector<GUIElement *> subtrees(1, this);
+		while (!subtrees.empty() && subtrees.size() < min_subtrees)
+		{
+			std::vector<GUIElement *> next_level;
+			for (size_t i = 0; i < subtrees.size(); i++)
+			{
+				for (GUIElement *child = subtrees[i]->first_child; child; child = child->next_sibling)
+				{
+					if (child->style_needs_update)
+						child->update_style();
+					if (child->first_child)
+						next_level.push_back(child);
+				}
+			}
+			subtrees.swap(next_level);
+		}
+
+		for (size_t i = 0; i < subtrees.size(); i++)
+			work_queue->queue(new GUIElementSubtreeStyleUpdate(subtrees[i]));
+		work_queue->finish();
+	}
+
+	computed_values.update_tree(work_queue);
+}
+
+void GUIElement::update_descendant_styles()
+{
+	for (GUIElement *child = first_child; child; child = child->next_sibling)
+	{
+		if (child->style_needs_update)
+			child->update_style();
+		child->update_descendant_styles();
+	}
+}
+
 std::string GUIElement::get_property(const std::string &property, const std::string &default_value) const
 {
 	// TODO: Decode all token types
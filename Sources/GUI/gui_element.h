@@ -48,6 +48,7 @@ class Canvas;
 class Font;
 class Rect;
 class ResourceManager;
+class WorkQueue;
 
 /// \brief A GUI element
 class GUIElement
@@ -118,6 +119,11 @@ public:
 
 	Rect render_text( Canvas &canvas, Font &font, const std::string &text, const Rect &content_box, int baseline, bool calculate_text_rect_only );
 
+	/// \brief Selects and computes the styles of this element and all its descendants
+	///
+	/// With a work queue, independent subtrees are resolved on its worker threads.
+	void update_style_tree(WorkQueue *work_queue);
+
 /// \}
 /// \name Signals and callbacks
 /// \{
@@ -136,6 +142,11 @@ private:
 	/// \brief Re-evaluates which CSS selectors match this component
 	void update_style();
 
+	/// \brief Re-evaluates the CSS selectors of all descendants that need it
+	void update_descendant_styles();
+
+	friend class GUIElementSubtreeStyleUpdate;
+
 	GUIElement(const GUIElement &other); // Do not implement; copy construction not allowed
 	GUIElement &operator =(const GUIElement &other); // Do not implement; copy construction not allowed
 
@@ -0,0 +1,282 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "GUI/precomp.h"
+#include "gui_loader_node.h"
+#include "API/Core/XML/dom_document.h"
+#include "API/Core/XML/dom_element.h"
+#include "API/Core/XML/dom_named_node_map.h"
+#include "API/Core/IOData/iodevice.h"
+#include "API/Core/System/databuffer.h"
+#include "API/Core/Text/string_help.h"
+#include <map>
+#include <cstring>
+
+namespace clan
+{
+
+static const char gui_compiled_magic[8] = { 'C', 'L', 'G', 'U', 'I', 'B', 'I', '1' };
+
+// Compiled form: magic, string table, then the nodes depth first. Integers are stored
+// seven bits per byte, least significant group first, and strings are indexes into the table.
+class GUILoaderNodeWriter
+{
+public:
+	void write_node(const GUILoaderNode &node)
+	{
+		write_string(node.tag);
+		write_uint(node.attributes.size());
+		for (size_t i = 0; i < node.attributes.size(); i++)
+		{
+			write_string(node.attributes[i].first);
+			write_string(node.attributes[i].second);
+		}
+		write_uint(node.children.size());
+		for (size_t i = 0; i < node.children.size(); i++)
+			write_node(node.children[i]);
+	}
+
+	void save(IODevice &output)
+	{
+		std::string header(gui_compiled_magic, sizeof(gui_compiled_magic));
+		append_uint(header, strings.size());
+		for (size_t i = 0; i < strings.size(); i++)
+		{
+			append_uint(header, strings[i].length());
+			header.append(strings[i]);
+		}
+		output.write(header.data(), header.length());
+		output.write(data.data(), data.length());
+	}
+
+private:
+	void write_uint(unsigned int value)
+	{
+		append_uint(data, value);
+	}
+
+	void write_string(const std::string &value)
+	{
+		std::map<std::string, unsigned int>::iterator it = string_indexes.find(value);
+		if (it == string_indexes.end())
+		{
+			it = string_indexes.insert(std::make_pair(value, (unsigned int)strings.size())).first;
+			strings.push_back(value);
+		}
+		write_uint(it->second);
+	}
+
+	static void append_uint(std::string &buffer, unsigned int value)
+	{
+		while (value >= 0x80)
+		{
+			buffer.push_back((char)((value & 0x7f) | 0x80));
+			value >>= 7;
+		}
+		buffer.push_back((char)value);
+	}
+
+	std::string data;
+	std::vector<std::string> strings;
+	std::map<std::string, unsigned int> string_indexes;
+};
+
+class GUILoaderNodeReader
+{
+public:
+	GUILoaderNodeReader(const char *data, size_t size)
+	: pos(data + sizeof(gui_compiled_magic)), end(data + size)
+	{
+		unsigned int count = read_uint();
+		strings.reserve(count);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			unsigned int length = read_uint();
+			need(length);
+			strings.push_back(std::string(pos, length));
+			pos += length;
+		}
+	}
+
+	void read_node(GUILoaderNode &node)
+	{
+		node.tag = read_string();
+		node.attributes.resize(read_uint());
+		for (size_t i = 0; i < node.attributes.size(); i++)
+		{
+			node.attributes[i].first = read_string();
+			node.attributes[i].second = read_string();
+		}
+		node.children.resize(read_uint());
+		for (size_t i = 0; i < node.children.size(); i++)
+			read_node(node.children[i]);
+	}
+
+private:
+	unsigned int read_uint()
+	{
+		unsigned int value = 0;
+		for (int shift = 0; shift < 35; shift += 7)
+		{
+			need(1);
+			unsigned char c = (unsigned char)*(pos++);
+			value |= (unsigned int)(c & 0x7f) << shift;
+			if ((c & 0x80) == 0)
+				return value;
+		}
+		throw Exception("Invalid integer in compiled GUI definition");
+	}
+
+	const std::string &read_string()
+	{
+		unsigned int index = read_uint();
+		if (index >= strings.size())
+			throw Exception("Invalid string reference in compiled GUI definition");
+		return strings[index];
+	}
+
+	void need(size_t bytes)
+	{
+		if ((size_t)(end - pos) < bytes)
+			throw Exception("Compiled GUI definition is truncated");
+	}
+
+	const char *pos;
+	const char *end;
+	std::vector<std::string> strings;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// GUILoaderNode Attributes:
+
+bool GUILoaderNode::has_attribute(const std::string &name) const
+{
+	return find_attribute(name) != 0;
+}
+
+std::string GUILoaderNode::get_attribute(const std::string &name, const std::string &default_value) const
+{
+	const std::string *value = find_attribute(name);
+	return value ? *value : default_value;
+}
+
+int GUILoaderNode::get_attribute_int(const std::string &name, int default_value) const
+{
+	const std::string *value = find_attribute(name);
+	if (value && !value->empty())
+		return StringHelp::text_to_int(*value);
+	else
+		return default_value;
+}
+
+bool GUILoaderNode::get_attribute_bool(const std::string &name, bool default_value) const
+{
+	const std::string *value = find_attribute(name);
+	if (value && !value->empty())
+		return *value == "true";
+	else
+		return default_value;
+}
+
+bool GUILoaderNode::is_compiled(const DataBuffer &data)
+{
+	return data.get_size() >= (int)sizeof(gui_compiled_magic) && memcmp(data.get_data(), gui_compiled_magic, sizeof(gui_compiled_magic)) == 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GUILoaderNode Operations:
+
+GUILoaderNode GUILoaderNode::from_dom(const DomElement &element)
+{
+	GUILoaderNode node;
+	node.tag = element.get_tag_name();
+
+	DomNamedNodeMap attributes = element.get_attributes();
+	unsigned long num_attributes = attributes.get_length();
+	node.attributes.reserve(num_attributes);
+	for (unsigned long i = 0; i < num_attributes; i++)
+	{
+		DomNode attribute = attributes.item(i);
+		node.attributes.push_back(std::make_pair(attribute.get_node_name(), attribute.get_node_value()));
+	}
+
+	DomElement child = element.get_first_child_element();
+	while (!child.is_null())
+	{
+		node.children.push_back(from_dom(child));
+		child = child.get_next_sibling_element();
+	}
+	return node;
+}
+
+GUILoaderNode GUILoaderNode::from_gui_xml(const DomDocument &gui_xml)
+{
+	DomDocument const_hack = gui_xml;
+
+	// Check if loaded document uses namespaces and if its a clanlib gui xml document:
+	DomElement doc_element = const_hack.get_document_element();
+	if (doc_element.get_namespace_uri() != "http://clanlib.org/xmlns/gui-1.0")
+		throw Exception("XML document is not a ClanLib GUI XML document.");
+	if (doc_element.get_local_name() != "gui")
+		throw Exception("ClanLib GUI XML documents must begin with a gui element.");
+
+	return from_dom(doc_element);
+}
+
+void GUILoaderNode::write(IODevice &output) const
+{
+	GUILoaderNodeWriter writer;
+	writer.write_node(*this);
+	writer.save(output);
+}
+
+GUILoaderNode GUILoaderNode::read(const DataBuffer &data)
+{
+	if (!is_compiled(data))
+		throw Exception("Not a compiled GUI definition");
+
+	GUILoaderNode node;
+	GUILoaderNodeReader reader(data.get_data(), data.get_size());
+	reader.read_node(node);
+	return node;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GUILoaderNode Implementation:
+
+const std::string *GUILoaderNode::find_attribute(const std::string &name) const
+{
+	for (size_t i = 0; i < attributes.size(); i++)
+	{
+		if (attributes[i].first == name)
+			return &attributes[i].second;
+	}
+	return 0;
+}
+
+}
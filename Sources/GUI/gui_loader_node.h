@@ -0,0 +1,73 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <vector>
+
+namespace clan
+{
+
+class DomElement;
+class DomDocument;
+class IODevice;
+class DataBuffer;
+
+/// Element of a GUI definition, read either from GUI XML or from its compiled binary form.
+class GUILoaderNode
+{
+public:
+	std::string tag;
+	std::vector<std::pair<std::string, std::string> > attributes;
+	std::vector<GUILoaderNode> children;
+
+	bool has_attribute(const std::string &name) const;
+	std::string get_attribute(const std::string &name, const std::string &default_value = std::string()) const;
+	int get_attribute_int(const std::string &name, int default_value = 0) const;
+	bool get_attribute_bool(const std::string &name, bool default_value = false) const;
+
+	/// \brief Converts an element and its child elements
+	static GUILoaderNode from_dom(const DomElement &element);
+
+	/// \brief Converts the gui element of a ClanLib GUI XML document. Throws if it is not such a document.
+	static GUILoaderNode from_gui_xml(const DomDocument &gui_xml);
+
+	/// \brief Returns true if the data starts with the compiled GUI definition header
+	static bool is_compiled(const DataBuffer &data);
+
+	/// \brief Writes the node tree in the compiled binary form
+	void write(IODevice &output) const;
+
+	/// \brief Reads a node tree written by write
+	static GUILoaderNode read(const DataBuffer &data);
+
+private:
+	const std::string *find_attribute(const std::string &name) const;
+};
+
+}
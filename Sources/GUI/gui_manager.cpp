@@ -45,6 +45,7 @@
 #include "API/Core/Resources/xml_resource_document.h"
 #include "API/Core/Resources/xml_resource_manager.h"
 #include "API/Core/IOData/file_help.h"
+#include "API/Core/IOData/file.h"
 #include "gui_manager_impl.h"
 
 namespace clan
@@ -138,6 +139,26 @@ std::string GUIManager::get_clipboard_text() const
 	return impl->window_manager.get_display_window(cur).get_clipboard_text();
 }
 
+GUIPaintStatistics GUIManager::get_paint_statistics() const
+{
+	return impl->paint_statistics;
+}
+
+bool GUIManager::is_message_coalescing_enabled() const
+{
+	return impl->message_coalescing;
+}
+
+bool GUIManager::is_profiling_enabled() const
+{
+	return impl->profiler.is_enabled();
+}
+
+std::vector<GUIProfileEntry> GUIManager::get_profile() const
+{
+	return impl->profiler.get_entries();
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // GUIManager Events:
 
@@ -159,7 +180,12 @@ void GUIManager::add_theme(const std::string &path_to_theme)
 	FileSystem vfs(path_to_theme);
 
 	XMLResourceManager::get_doc(impl->resources).add_resources(XMLResourceDocument("resources.xml", vfs));
-	impl->css_document.add_sheet(author_sheet_origin, "theme.css", vfs);
+
+	// A compiled theme (see CSSDocument::compile_sheet) takes precedence over the CSS source:
+	if (vfs.has_file("theme.cssc"))
+		impl->css_document.add_sheet(author_sheet_origin, "theme.cssc", vfs);
+	else
+		impl->css_document.add_sheet(author_sheet_origin, "theme.css", vfs);
 }
 
 void GUIManager::set_css_document(CSSDocument css)
@@ -238,6 +264,7 @@ void GUIManager::set_tablet_proximity_component(GUIComponent *comp, bool state)
 void GUIManager::process_messages(int timeout)
 {
 	KeepAlive::process(timeout);
+	impl->flush_coalesced_messages();
 	impl->invalidate_constant_repaint_components();
 	impl->window_manager.update();
 }
@@ -302,6 +329,8 @@ void GUIManager::request_repaint(const Rect &rect, GUIComponent *root_component)
 
 void GUIManager::render_windows()
 {
+	impl->flush_coalesced_messages();
+
 	std::vector<GUITopLevelWindow>::size_type pos, size;
 	size = impl->root_components.size();
 
@@ -327,6 +356,44 @@ void GUIManager::set_accelerator_table( const AcceleratorTable &table )
 	impl->accel_table = table;
 }
 
+void GUIManager::set_parallel_style_resolution(bool enable, int max_threads)
+{
+	impl->style_work_queue.reset(enable ? new WorkQueue(max_threads) : 0);
+}
+
+void GUIManager::reset_paint_statistics()
+{
+	impl->paint_statistics = GUIPaintStatistics();
+}
+
+void GUIManager::set_message_coalescing(bool enable)
+{
+	impl->message_coalescing = enable;
+	if (!enable)
+		impl->flush_coalesced_messages();
+}
+
+void GUIManager::flush_coalesced_messages()
+{
+	impl->flush_coalesced_messages();
+}
+
+void GUIManager::set_profiling_enabled(bool enable)
+{
+	impl->profiler.set_enabled(enable);
+}
+
+void GUIManager::reset_profile()
+{
+	impl->profiler.reset();
+}
+
+void GUIManager::write_profile_trace(const std::string &filename) const
+{
+	File file(filename, File::create_always, File::access_write);
+	impl->profiler.write_trace(file);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // GUIManager Implementation:
 
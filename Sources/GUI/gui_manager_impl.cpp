@@ -56,7 +56,7 @@ namespace clan
 // GUIManager_Impl Construction:
 
 GUIManager_Impl::GUIManager_Impl()
-: mouse_capture_component(0), exit_flag(false), exit_code(0), window_manager(NULL)
+: mouse_capture_component(0), exit_flag(false), exit_code(0), window_manager(NULL), message_coalescing(false), active_layer(0)
 {
 	resources = XMLResourceManager::create(XMLResourceDocument());
 
@@ -334,6 +334,8 @@ const GUIComponent *GUIManager_Impl::get_owner_component(const GUIComponent *com
 
 void GUIManager_Impl::deliver_message(std::shared_ptr<GUIMessage> &m)
 {
+	GUIProfileScope profile_scope(profiler, GUIProfiler::category_message, m->target);
+
 	sig_filter_message.invoke(m);
 
 	if (!m->consumed)
@@ -489,6 +491,21 @@ void GUIManager_Impl::dispatch_message(std::shared_ptr<GUIMessage> message)
 		message->target = message_original_target;
 }
 
+void GUIManager_Impl::flush_coalesced_messages()
+{
+	// Message handlers may create or destroy windows
+	std::vector<GUITopLevelWindow *> windows = root_components;
+	std::vector<GUITopLevelWindow_Alive> windows_alive;
+	for (size_t i = 0; i < windows.size(); i++)
+		windows_alive.push_back(GUITopLevelWindow_Alive(windows[i]));
+
+	for (size_t i = 0; i < windows.size(); i++)
+	{
+		if (!windows_alive[i].is_null())
+			flush_coalesced_messages(windows[i]);
+	}
+}
+
 GUIComponent *GUIManager_Impl::get_focus_component()
 {
 	std::vector<GUITopLevelWindow>::size_type pos, size;
@@ -548,8 +565,34 @@ void GUIManager_Impl::invalidate_constant_repaint_components()
 /////////////////////////////////////////////////////////////////////////////
 // GUIManager_Impl Implementation:
 
+bool GUIManager_Impl::flush_coalesced_messages(GUITopLevelWindow *toplevel_window)
+{
+	GUITopLevelWindow_Alive toplevel_window_alive(toplevel_window);
+
+	if (toplevel_window->pending_resize)
+	{
+		toplevel_window->pending_resize = false;
+		process_resize(toplevel_window);
+		if (toplevel_window_alive.is_null())
+			return false;
+	}
+
+	if (toplevel_window->pending_pointer_move)
+	{
+		toplevel_window->pending_pointer_move = false;
+		process_input(toplevel_window, toplevel_window->pending_pointer_event);
+		if (toplevel_window_alive.is_null())
+			return false;
+	}
+
+	return true;
+}
+
 void GUIManager_Impl::on_focus_lost(GUITopLevelWindow *toplevel_window)
 {
+	if (!flush_coalesced_messages(toplevel_window))
+		return;
+
 	if (toplevel_window->focused_component)
 	{
 		GUITopLevelWindow_Alive toplevel_window_alive(toplevel_window);
@@ -574,6 +617,9 @@ void GUIManager_Impl::on_focus_lost(GUITopLevelWindow *toplevel_window)
 
 void GUIManager_Impl::on_focus_gained(GUITopLevelWindow *toplevel_window)
 {
+	if (!flush_coalesced_messages(toplevel_window))
+		return;
+
 	if (toplevel_window->focused_component == 0)
 		toplevel_window->focused_component = toplevel_window->component;
 
@@ -597,6 +643,15 @@ void GUIManager_Impl::on_focus_gained(GUITopLevelWindow *toplevel_window)
 }
 
 void GUIManager_Impl::on_resize(GUITopLevelWindow *toplevel_window, const Size &new_size)
+{
+	// The new size is read back from the window when the message is processed, so only the last resize matters
+	if (message_coalescing)
+		toplevel_window->pending_resize = true;
+	else
+		process_resize(toplevel_window);
+}
+
+void GUIManager_Impl::process_resize(GUITopLevelWindow *toplevel_window)
 {
 	GUIComponent *component = toplevel_window->component;
 	component->impl->window_resized();
@@ -609,11 +664,17 @@ void GUIManager_Impl::on_resize(GUITopLevelWindow *toplevel_window, const Size &
 
 void GUIManager_Impl::on_paint(GUITopLevelWindow *toplevel_window, const Rect &update_rect)
 {
+	if (!flush_coalesced_messages(toplevel_window))
+		return;
+
 	toplevel_window->component->paint(update_rect);
 }
 
 void GUIManager_Impl::on_close(GUITopLevelWindow *toplevel_window)
 {
+	if (!flush_coalesced_messages(toplevel_window))
+		return;
+
 	std::shared_ptr<GUIMessage_Close> message(new GUIMessage_Close());
 	message->target = toplevel_window->component;
 	dispatch_message(message);
@@ -627,6 +688,22 @@ void GUIManager_Impl::on_destroy(GUITopLevelWindow *toplevel_window)
 void GUIManager_Impl::on_input_received(
 	GUITopLevelWindow *toplevel_window,
 	const InputEvent &input_event)
+{
+	// Each pointer move walks the whole component tree. Only the last one before a frame is needed.
+	if (message_coalescing && input_event.type == InputEvent::pointer_moved && input_event.device.get_type() == InputDevice::pointer)
+	{
+		toplevel_window->pending_pointer_move = true;
+		toplevel_window->pending_pointer_event = input_event;
+		return;
+	}
+
+	if (!flush_coalesced_messages(toplevel_window))
+		return;
+
+	process_input(toplevel_window, input_event);
+}
+
+void GUIManager_Impl::process_input(GUITopLevelWindow *toplevel_window, const InputEvent &input_event)
 {
 	// Find target for input message:
 	GUIComponent *target = 0;
@@ -37,12 +37,17 @@
 #include "API/CSSLayout/CSSDocument/css_document.h"
 #include "API/CSSLayout/CSSDocument/css_property.h"
 #include "API/Core/System/timer.h"
+#include "API/Core/System/work_queue.h"
 #include "API/Display/Font/font.h"
 #include "API/Display/Font/font_description.h"
 #include "API/GUI/gui_component.h"
 #include "API/GUI/accelerator_table.h"
 #include "API/GUI/gui_window_manager.h"
+#include "API/GUI/gui_paint_statistics.h"
+#include "API/Display/Render/blend_state.h"
+#include "API/Display/Window/input_event.h"
 #include "CSSLayout/css_resource_cache.h"
+#include "gui_profiler.h"
 #include <vector>
 #include <map>
 
@@ -60,7 +65,7 @@ class GUITopLevelWindow_Alive;
 class GUITopLevelWindow
 {
 public:
-	GUITopLevelWindow() : alive(new int) {}
+	GUITopLevelWindow() : pending_pointer_move(false), pending_resize(false), alive(new int) {}
 
 	GUIComponent *component;
 	GUIComponent *focused_component;
@@ -68,6 +73,11 @@ public:
 	GUIComponent *proximity_component;
 	std::vector<Rect> update_regions;
 
+	// Messages held back by message coalescing:
+	bool pending_pointer_move;
+	InputEvent pending_pointer_event;
+	bool pending_resize;
+
 private:
 	std::shared_ptr<int> alive;	// Shared Pointer, used to determine if this class is active
 	friend class GUITopLevelWindow_Alive;
@@ -131,6 +141,12 @@ public:
 	bool exit_flag;
 	int exit_code;
 	AcceleratorTable accel_table;
+	std::unique_ptr<WorkQueue> style_work_queue;
+	GUIPaintStatistics paint_statistics;
+	GUIProfiler profiler;
+	bool message_coalescing;
+	GUIComponent *active_layer;	// Component whose cached layer is currently being rendered
+	BlendState layer_blend;
 	GUIWindowManagerSite wm_site;
 	Callback_v1<GUITopLevelWindow *> func_focus_lost;
 	Callback_v1<GUITopLevelWindow *> func_focus_gained;
@@ -150,6 +166,7 @@ public:
 	void loose_focus(GUIComponent *component);
 	void set_enabled(GUIComponent *component, bool enable);
 	void dispatch_message(std::shared_ptr<GUIMessage> message);
+	void flush_coalesced_messages();
 
 	bool is_constant_repaint_enabled() const;
 	bool is_constant_repaint_enabled(GUIComponent *component) const;
@@ -164,6 +181,9 @@ private:
 	void deliver_message(std::shared_ptr<GUIMessage> &message);
 	void dispatch_message_to_component(GUIComponent *target, const InputEvent &input_event);
 	void process_pointer_moved_at(GUIComponent *this_component, const Point &point, bool force_pointer_enter);
+	bool flush_coalesced_messages(GUITopLevelWindow *toplevel_window);
+	void process_resize(GUITopLevelWindow *toplevel_window);
+	void process_input(GUITopLevelWindow *toplevel_window, const InputEvent &input_event);
 
 	void on_focus_lost(GUITopLevelWindow *toplevel_window);
 	void on_focus_gained(GUITopLevelWindow *toplevel_window);
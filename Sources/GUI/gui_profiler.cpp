@@ -0,0 +1,192 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "GUI/precomp.h"
+#include "gui_profiler.h"
+#include "API/GUI/gui_component.h"
+#include "API/Core/IOData/iodevice.h"
+#include "API/Core/Text/string_format.h"
+#include "API/Core/Text/string_help.h"
+#include <algorithm>
+
+namespace clan
+{
+
+class GUIProfileEntrySort
+{
+public:
+	bool operator()(const GUIProfileEntry &a, const GUIProfileEntry &b) const
+	{
+		return a.get_total_time() > b.get_total_time();
+	}
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// GUIProfiler Construction:
+
+GUIProfiler::GUIProfiler()
+: enabled(false)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GUIProfiler Attributes:
+
+std::vector<GUIProfileEntry> GUIProfiler::get_entries() const
+{
+	std::vector<GUIProfileEntry> sorted_entries = entries;
+	std::stable_sort(sorted_entries.begin(), sorted_entries.end(), GUIProfileEntrySort());
+	return sorted_entries;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GUIProfiler Operations:
+
+void GUIProfiler::record(Category category, const std::string &component_name, ubyte64 start, ubyte64 end)
+{
+	// Components are identified by name rather than pointer, so the entries stay valid after a component is destroyed
+	std::map<std::string, unsigned int>::iterator it = entry_indexes.find(component_name);
+	if (it == entry_indexes.end())
+	{
+		it = entry_indexes.insert(std::make_pair(component_name, (unsigned int)entries.size())).first;
+		entries.push_back(GUIProfileEntry());
+		entries.back().component = component_name;
+	}
+
+	GUIProfileEntry &entry = entries[it->second];
+	ubyte64 duration = end - start;
+	switch (category)
+	{
+	case category_message:
+		entry.message_count++;
+		entry.message_time += duration;
+		break;
+	case category_layout:
+		entry.layout_count++;
+		entry.layout_time += duration;
+		break;
+	case category_render:
+		entry.render_count++;
+		entry.render_time += duration;
+		break;
+	}
+
+	if (trace_events.size() < max_trace_events)
+	{
+		GUIProfileTraceEvent event;
+		event.category = category;
+		event.entry_index = it->second;
+		event.start = start;
+		event.duration = duration;
+		trace_events.push_back(event);
+	}
+}
+
+void GUIProfiler::reset()
+{
+	entries.clear();
+	entry_indexes.clear();
+	trace_events.clear();
+}
+
+void GUIProfiler::write_trace(IODevice &output) const
+{
+	static const char *category_names[] = { "message", "layout", "render" };
+
+	// Events are recorded when they end. Sort by start time so nested events follow their parent.
+	std::vector<GUIProfileTraceEvent> events = trace_events;
+	std::vector<std::pair<ubyte64, size_t> > order;
+	order.reserve(events.size());
+	for (size_t i = 0; i < events.size(); i++)
+		order.push_back(std::make_pair(events[i].start, i));
+	std::stable_sort(order.begin(), order.end());
+
+	std::string text = "{\"traceEvents\":[\n";
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		const GUIProfileTraceEvent &event = events[order[i].second];
+		text += string_format("{\"name\":\"%1\",\"cat\":\"%2\",\"ph\":\"X\",\"ts\":%3,\"dur\":%4,\"pid\":1,\"tid\":1}%5\n",
+			escape_json(entries[event.entry_index].component),
+			category_names[event.category],
+			StringHelp::ull_to_text(event.start),
+			StringHelp::ull_to_text(event.duration),
+			i + 1 < order.size() ? "," : "");
+
+		// Flush now and then to keep memory usage down for large traces
+		if (text.size() > 64 * 1024)
+		{
+			output.write(text.data(), text.size());
+			text.clear();
+		}
+	}
+	text += "]}\n";
+	output.write(text.data(), text.size());
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GUIProfiler Implementation:
+
+std::string GUIProfiler::get_component_name(GUIComponent *component)
+{
+	if (component == 0)
+		return "(none)";
+
+	std::string id = component->get_id();
+	if (id.empty())
+		return component->get_tag_name();
+	else
+		return component->get_tag_name() + "#" + id;
+}
+
+std::string GUIProfiler::escape_json(const std::string &text)
+{
+	std::string escaped;
+	for (size_t i = 0; i < text.length(); i++)
+	{
+		unsigned char c = text[i];
+		if (c == '"' || c == '\\')
+		{
+			escaped.push_back('\\');
+			escaped.push_back(c);
+		}
+		else if (c < 0x20)
+		{
+			static const char hex[] = "0123456789abcdef";
+			escaped += "\\u00";
+			escaped.push_back(hex[c >> 4]);
+			escaped.push_back(hex[c & 15]);
+		}
+		else
+		{
+			escaped.push_back(c);
+		}
+	}
+	return escaped;
+}
+
+}
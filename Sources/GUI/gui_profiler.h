@@ -0,0 +1,122 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/GUI/gui_profile_entry.h"
+#include "API/Core/System/system.h"
+#include <map>
+#include <vector>
+
+namespace clan
+{
+
+class GUIComponent;
+class IODevice;
+
+class GUIProfileTraceEvent
+{
+public:
+	int category;
+	unsigned int entry_index;
+	ubyte64 start;
+	ubyte64 duration;
+};
+
+/// Records the time spent in message handlers, layout and render callbacks per component.
+class GUIProfiler
+{
+public:
+	GUIProfiler();
+
+	enum Category
+	{
+		category_message,
+		category_layout,
+		category_render
+	};
+
+	bool is_enabled() const { return enabled; }
+	void set_enabled(bool enable) { enabled = enable; }
+
+	/// \brief Returns the entries sorted by total time, most expensive first
+	std::vector<GUIProfileEntry> get_entries() const;
+
+	void record(Category category, const std::string &component_name, ubyte64 start, ubyte64 end);
+	void reset();
+
+	static std::string get_component_name(GUIComponent *component);
+
+	/// \brief Writes the recorded events in the Chrome trace event format
+	void write_trace(IODevice &output) const;
+
+private:
+	static std::string escape_json(const std::string &text);
+
+	bool enabled;
+	std::vector<GUIProfileEntry> entries;
+	std::map<std::string, unsigned int> entry_indexes;
+	std::vector<GUIProfileTraceEvent> trace_events;
+
+	// One million events is around 24 MB. Aggregated times keep being collected after the limit is reached.
+	enum { max_trace_events = 1024 * 1024 };
+};
+
+/// Measures the time from construction to destruction if the profiler is enabled.
+///
+/// The component name is looked up at construction, as the scope may outlive the component.
+class GUIProfileScope
+{
+public:
+	GUIProfileScope(GUIProfiler &profiler, GUIProfiler::Category category, GUIComponent *component)
+	: profiler(profiler.is_enabled() ? &profiler : 0), category(category), start(0)
+	{
+		if (this->profiler)
+		{
+			component_name = GUIProfiler::get_component_name(component);
+			start = System::get_microseconds();
+		}
+	}
+
+	~GUIProfileScope()
+	{
+		if (profiler)
+			profiler->record(category, component_name, start, System::get_microseconds());
+	}
+
+private:
+	GUIProfileScope(const GUIProfileScope &);
+	GUIProfileScope &operator=(const GUIProfileScope &);
+
+	GUIProfiler *profiler;
+	GUIProfiler::Category category;
+	std::string component_name;
+	ubyte64 start;
+};
+
+}
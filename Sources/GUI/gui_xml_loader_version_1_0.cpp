@@ -56,6 +56,7 @@
 #include "API/GUI/Components/imageview.h"
 
 #include "gui_xml_loader_version_1_0.h"
+#include "gui_loader_node.h"
 #include "Layout/gui_layout_provider_corners.h"
 
 namespace clan
@@ -83,10 +84,9 @@ GUIXMLLoaderVersion_1_0::~GUIXMLLoaderVersion_1_0()
 /////////////////////////////////////////////////////////////////////////////
 // GUIXMLLoaderVersion_1_0 Operations:
 
-void GUIXMLLoaderVersion_1_0::load(DomDocument &doc)
+void GUIXMLLoaderVersion_1_0::load(const GUILoaderNode &root)
 {
-	DomElement doc_element = doc.get_document_element();
-	load(doc_element, component);
+	load(root, component);
 
 	if (dialog_width != 0 || dialog_height != 0)
 	{
@@ -112,16 +112,15 @@ void GUIXMLLoaderVersion_1_0::set_create_custom_callback(Callback_2<GUIComponent
 /////////////////////////////////////////////////////////////////////////////
 // GUIXMLLoaderVersion_1_0 Implementation:
 
-void GUIXMLLoaderVersion_1_0::load(DomElement &element, GUIComponent *parent)
+void GUIXMLLoaderVersion_1_0::load(const GUILoaderNode &element, GUIComponent *parent)
 {
-	DomElement e = element.get_first_child().to_element();
-
 	dialog_width = 0;
 	dialog_height = 0;
 
-	while (e.is_element())
+	for (size_t child_index = 0; child_index < element.children.size(); child_index++)
 	{
-		std::string tag = e.get_tag_name();
+		const GUILoaderNode &e = element.children[child_index];
+		const std::string &tag = e.tag;
 		GUIComponent *new_comp = 0;
 
 		if (tag == "button")
@@ -194,17 +193,26 @@ void GUIXMLLoaderVersion_1_0::load(DomElement &element, GUIComponent *parent)
 			ListView *co = new ListView(parent);
 			ListViewHeader *header = co->get_header();
 
-			std::vector<DomNode> columns_nodes = e.select_nodes("listview_header/listview_column");
-			for(size_t i = 0; i < columns_nodes.size(); ++i)
+			for (size_t i = 0; i < e.children.size(); i++)
 			{
-				DomElement column_element = columns_nodes[i].to_element();
-				std::string id = column_element.get_attribute("col_id");
-				std::string caption = column_element.get_attribute("caption");
-				int width = column_element.get_attribute_int("width");
-
-				ListViewColumnHeader column = header->create_column(id, caption);
-				column.set_width(width);
-				header->append(column);
+				if (e.children[i].tag != "listview_header")
+					continue;
+
+				const std::vector<GUILoaderNode> &columns_nodes = e.children[i].children;
+				for (size_t j = 0; j < columns_nodes.size(); j++)
+				{
+					const GUILoaderNode &column_element = columns_nodes[j];
+					if (column_element.tag != "listview_column")
+						continue;
+
+					std::string id = column_element.get_attribute("col_id");
+					std::string caption = column_element.get_attribute("caption");
+					int width = column_element.get_attribute_int("width");
+
+					ListViewColumnHeader column = header->create_column(id, caption);
+					column.set_width(width);
+					header->append(column);
+				}
 			}
 
 			new_comp = co;
@@ -214,10 +222,10 @@ void GUIXMLLoaderVersion_1_0::load(DomElement &element, GUIComponent *parent)
 			Tab *co = new Tab(parent);
 			new_comp = co;
 
-			DomElement tab_child = e.get_first_child().to_element();
-			while (tab_child.is_element())
+			for (size_t i = 0; i < e.children.size(); i++)
 			{
-				if (tab_child.get_tag_name() == "tabpage")
+				const GUILoaderNode &tab_child = e.children[i];
+				if (tab_child.tag == "tabpage")
 				{
 					std::string label = tab_child.get_attribute("label", "Error: NO LABEL!");
 					int id = StringHelp::text_to_int(tab_child.get_attribute("id", "0"));
@@ -226,8 +234,6 @@ void GUIXMLLoaderVersion_1_0::load(DomElement &element, GUIComponent *parent)
 					tab_page->set_layout(tabpage_layout);
 					load(tab_child, tab_page);
 				}
-
-				tab_child = tab_child.get_next_sibling().to_element();
 			}
 		}
 		else if (tag == "statusbar")
@@ -337,8 +343,6 @@ void GUIXMLLoaderVersion_1_0::load(DomElement &element, GUIComponent *parent)
 					corner_provider_layout->add_component(new_comp, ap_tl, dist_tl_x, dist_tl_y, ap_br, dist_rb_x, dist_rb_y);
 			}
 		}
-
-		e = e.get_next_sibling().to_element();
 	}
 
 	GUILayout parent_layout = parent->get_layout();
@@ -41,6 +41,7 @@ class GUIMessage;
 class GUIWindowManager;
 class GUIComponent_Impl;
 class InputEvent;
+class GUILoaderNode;
 
 class GUIXMLLoaderVersion_1_0
 {
@@ -65,7 +66,7 @@ public:
 /// \{
 
 public:
-	void load(DomDocument &doc);
+	void load(const GUILoaderNode &root);
 
 	void set_create_custom_callback(Callback_2<GUIComponent*, GUIComponent*, std::string> *callback);
 
@@ -75,7 +76,7 @@ public:
 /// \{
 
 private:
-	void load(DomElement &element, GUIComponent *parent);
+	void load(const GUILoaderNode &element, GUIComponent *parent);
 
 	GUIComponent *component;
 	GUILayout layout;
@@ -53,9 +53,9 @@ public:
 
 //! Attributes:
 public:
-	int get_size() const { return impl.lock()->connection.get_size(); }
+	byte64 get_size() const { return impl.lock()->connection.get_size(); }
 	
-	int get_position() const { return impl.lock()->connection.get_position(); }
+	byte64 get_position() const { return impl.lock()->connection.get_position(); }
 
 //! Operations:
 public:
@@ -76,7 +76,7 @@ public:
 		return impl.lock()->connection.peek(data, len);
 	}
 
-	bool seek(int position, IODevice::SeekMode mode)
+	bool seek(byte64 position, IODevice::SeekMode mode)
 	{
 		return impl.lock()->connection.seek(position, mode);
 	}
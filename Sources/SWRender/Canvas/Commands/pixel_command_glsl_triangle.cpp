@@ -0,0 +1,292 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "SWRender/precomp.h"
+#include "pixel_command_glsl_triangle.h"
+#include "API/SWRender/pixel_thread_context.h"
+#include "../Pipeline/pixel_pipeline.h"
+
+namespace clan
+{
+
+PixelCommandGlslTriangle::PixelCommandGlslTriangle(PixelPipeline *pipeline, const std::shared_ptr<PixelGlslFragmentSetup> &setup, const std::shared_ptr<std::vector<float> > &register_image, const float *init_vertices, int num_vertices)
+: pipeline(pipeline), setup(setup), register_image(register_image), vertices(0), num_vertices(num_vertices)
+{
+	size_t size = sizeof(float) * setup->vertex_size * num_vertices;
+	vertices = static_cast<float *>(pipeline->alloc_command(size));
+	memcpy(vertices, init_vertices, size);
+}
+
+PixelCommandGlslTriangle::~PixelCommandGlslTriangle()
+{
+	pipeline->free_command(vertices);
+}
+
+void PixelCommandGlslTriangle::run(PixelThreadContext *context)
+{
+	if (context->colorbuffer0.data == 0)
+		return;
+
+	const GlslSimdProgram &program = *setup->program;
+	GlslSimdRegisters registers(program.num_registers);
+	memcpy(registers.get(0), &(*register_image)[0], sizeof(float) * GlslSimdRegisters::lanes * program.num_static_registers);
+
+	// Viewport transform of the clip space positions
+	float half_width = context->colorbuffer0.size.width * 0.5f;
+	float half_height = context->colorbuffer0.size.height * 0.5f;
+	ScreenVertex screen[max_vertices];
+	for (int i = 0; i < num_vertices; i++)
+	{
+		const float *vertex = vertices + i * setup->vertex_size;
+		float rcp_w = 1.0f / vertex[3];
+		screen[i].x = (vertex[0] * rcp_w + 1.0f) * half_width;
+		screen[i].y = (1.0f - vertex[1] * rcp_w) * half_height;
+		screen[i].z = vertex[2] * rcp_w;
+		screen[i].rcp_w = rcp_w;
+		screen[i].varyings = vertex + 4;
+	}
+
+	for (int i = 2; i < num_vertices; i++)
+	{
+		const ScreenVertex *v[3] = { &screen[0], &screen[i - 1], &screen[i] };
+		render_triangle(context, registers, v);
+	}
+}
+
+void PixelCommandGlslTriangle::render_triangle(PixelThreadContext *context, GlslSimdRegisters &registers, const ScreenVertex *v[3])
+{
+	float area = (v[1]->x - v[0]->x) * (v[2]->y - v[0]->y) - (v[2]->x - v[0]->x) * (v[1]->y - v[0]->y);
+	if (area == 0.0f)
+		return;
+	float rcp_area = 1.0f / area;
+
+	// Barycentric coordinates as linear functions of the pixel position: b = A * x + B * y + C
+	float a1 = -(v[2]->y - v[0]->y) * rcp_area;
+	float b1 = (v[2]->x - v[0]->x) * rcp_area;
+	float c1 = -(a1 * v[0]->x + b1 * v[0]->y);
+	float a2 = (v[1]->y - v[0]->y) * rcp_area;
+	float b2 = -(v[1]->x - v[0]->x) * rcp_area;
+	float c2 = -(a2 * v[0]->x + b2 * v[0]->y);
+	float a0 = -a1 - a2;
+	float b0 = -b1 - b2;
+	float c0 = 1.0f - c1 - c2;
+
+	float min_y = min(v[0]->y, min(v[1]->y, v[2]->y));
+	float max_y = max(v[0]->y, max(v[1]->y, v[2]->y));
+	int y_start = max((int)std::ceil(min_y - 0.5f), context->clip_rect.top);
+	int y_end = min((int)std::ceil(max_y - 0.5f), context->clip_rect.bottom);
+	y_start = find_first_line_for_core(y_start, context->core, context->num_cores);
+
+	for (int y = y_start; y < y_end; y += context->num_cores)
+	{
+		float py = y + 0.5f;
+
+		// Find the span where all three barycentric coordinates are positive
+		float span_left = -1e30f;
+		float span_right = 1e30f;
+		float a[3] = { a0, a1, a2 };
+		float c[3] = { b0 * py + c0, b1 * py + c1, b2 * py + c2 };
+		bool empty = false;
+		for (int k = 0; k < 3; k++)
+		{
+			if (a[k] > 0.0f)
+				span_left = max(span_left, -c[k] / a[k]);
+			else if (a[k] < 0.0f)
+				span_right = min(span_right, -c[k] / a[k]);
+			else if (c[k] < 0.0f)
+				empty = true;
+		}
+		if (empty || span_left >= span_right)
+			continue;
+
+		int x_start = (int)std::ceil(max(span_left, (float)context->clip_rect.left - 1.0f) - 0.5f);
+		int x_end = (int)std::ceil(min(span_right, (float)context->clip_rect.right + 1.0f) - 0.5f);
+		x_start = max(x_start, context->clip_rect.left);
+		x_end = min(x_end, context->clip_rect.right);
+
+		for (int x = x_start; x < x_end; x += GlslSimdRegisters::lanes)
+		{
+			int count = min(x_end - x, (int)GlslSimdRegisters::lanes);
+			float lane_b0[GlslSimdRegisters::lanes], lane_b1[GlslSimdRegisters::lanes], lane_b2[GlslSimdRegisters::lanes];
+			for (int i = 0; i < GlslSimdRegisters::lanes; i++)
+			{
+				float px = x + i + 0.5f;
+				lane_b1[i] = a1 * px + c[1];
+				lane_b2[i] = a2 * px + c[2];
+				lane_b0[i] = 1.0f - lane_b1[i] - lane_b2[i];
+			}
+			shade_block(context, registers, x, y, count, lane_b0, lane_b1, lane_b2, v);
+		}
+	}
+}
+
+void PixelCommandGlslTriangle::shade_block(PixelThreadContext *context, GlslSimdRegisters &registers, int x, int y, int count, const float b0[8], const float b1[8], const float b2[8], const ScreenVertex *v[3])
+{
+	const GlslSimdProgram &program = *setup->program;
+
+	float p0[GlslSimdRegisters::lanes], p1[GlslSimdRegisters::lanes], p2[GlslSimdRegisters::lanes], rcp_w[GlslSimdRegisters::lanes];
+	for (int i = 0; i < GlslSimdRegisters::lanes; i++)
+	{
+		rcp_w[i] = b0[i] * v[0]->rcp_w + b1[i] * v[1]->rcp_w + b2[i] * v[2]->rcp_w;
+		float w = 1.0f / rcp_w[i];
+		p0[i] = b0[i] * v[0]->rcp_w * w;
+		p1[i] = b1[i] * v[1]->rcp_w * w;
+		p2[i] = b2[i] * v[2]->rcp_w * w;
+	}
+
+	for (size_t j = 0; j < setup->varyings.size(); j++)
+	{
+		const PixelGlslFragmentSetup::Varying &varying = setup->varyings[j];
+		const float *w0 = p0, *w1 = p1, *w2 = p2;
+		if (varying.interpolation == GlslSimdSymbol::interpolate_noperspective)
+		{
+			w0 = b0;
+			w1 = b1;
+			w2 = b2;
+		}
+
+		for (int r = 0; r < varying.num_registers; r++)
+		{
+			float *dest = registers.get(varying.first_register + r);
+			float f0 = v[0]->varyings[varying.vertex_offset + r];
+			float f1 = v[1]->varyings[varying.vertex_offset + r];
+			float f2 = v[2]->varyings[varying.vertex_offset + r];
+			if (varying.interpolation == GlslSimdSymbol::interpolate_flat)
+			{
+				for (int i = 0; i < GlslSimdRegisters::lanes; i++)
+					dest[i] = f2;
+			}
+			else
+			{
+				for (int i = 0; i < GlslSimdRegisters::lanes; i++)
+					dest[i] = w0[i] * f0 + w1[i] * f1 + w2[i] * f2;
+			}
+		}
+	}
+
+	if (setup->frag_coord_register != -1)
+	{
+		for (int i = 0; i < GlslSimdRegisters::lanes; i++)
+		{
+			registers.set_lane(setup->frag_coord_register, i, x + i + 0.5f);
+			registers.set_lane(setup->frag_coord_register + 1, i, y + 0.5f);
+			registers.set_lane(setup->frag_coord_register + 2, i, b0[i] * v[0]->z + b1[i] * v[1]->z + b2[i] * v[2]->z);
+			registers.set_lane(setup->frag_coord_register + 3, i, rcp_w[i]);
+		}
+	}
+
+	unsigned int *mask = reinterpret_cast<unsigned int *>(registers.get(program.mask_register));
+	unsigned int *alive = reinterpret_cast<unsigned int *>(registers.get(program.alive_register));
+	for (int i = 0; i < GlslSimdRegisters::lanes; i++)
+	{
+		mask[i] = (i < count) ? 0xffffffff : 0;
+		alive[i] = mask[i];
+	}
+
+	program.run(registers, context->samplers, PixelThreadContext::max_samplers);
+
+	write_block(context, registers, x, y, count);
+}
+
+void PixelCommandGlslTriangle::write_block(PixelThreadContext *context, GlslSimdRegisters &registers, int x, int y, int count)
+{
+	if (setup->color_register == -1)
+		return;
+
+	const GlslSimdProgram &program = *setup->program;
+	const unsigned int *alive = reinterpret_cast<const unsigned int *>(registers.get(program.alive_register));
+	unsigned int *dest_pixels = context->colorbuffer0.data + x + y * context->colorbuffer0.size.width;
+	const float *color[4] =
+	{
+		registers.get(setup->color_register),
+		registers.get(setup->color_register + 1),
+		registers.get(setup->color_register + 2),
+		registers.get(setup->color_register + 3)
+	};
+
+	bool replace = (context->cur_blend_src == blend_one && context->cur_blend_dest == blend_zero && context->cur_blend_src_alpha == blend_one && context->cur_blend_dest_alpha == blend_zero);
+
+	for (int i = 0; i < count; i++)
+	{
+		if (alive[i] == 0)
+			continue;
+
+		float src[4] = { color[0][i], color[1][i], color[2][i], color[3][i] };
+		float result[4];
+		if (replace)
+		{
+			for (int c = 0; c < 4; c++)
+				result[c] = src[c];
+		}
+		else
+		{
+			unsigned int dest_pixel = dest_pixels[i];
+			float dest[4] =
+			{
+				((dest_pixel >> 16) & 0xff) * (1.0f / 255.0f),
+				((dest_pixel >> 8) & 0xff) * (1.0f / 255.0f),
+				(dest_pixel & 0xff) * (1.0f / 255.0f),
+				(dest_pixel >> 24) * (1.0f / 255.0f)
+			};
+			for (int c = 0; c < 3; c++)
+				result[c] = src[c] * blend_factor(context->cur_blend_src, c, src, dest, context->cur_blend_color) + dest[c] * blend_factor(context->cur_blend_dest, c, src, dest, context->cur_blend_color);
+			result[3] = src[3] * blend_factor(context->cur_blend_src_alpha, 3, src, dest, context->cur_blend_color) + dest[3] * blend_factor(context->cur_blend_dest_alpha, 3, src, dest, context->cur_blend_color);
+		}
+
+		unsigned int channels[4];
+		for (int c = 0; c < 4; c++)
+			channels[c] = (unsigned int)(clamp(result[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+		dest_pixels[i] = (channels[3] << 24) | (channels[0] << 16) | (channels[1] << 8) | channels[2];
+	}
+}
+
+float PixelCommandGlslTriangle::blend_factor(BlendFunc func, int channel, const float src[4], const float dest[4], const Colorf &constant)
+{
+	float constant_color[4] = { constant.r, constant.g, constant.b, constant.a };
+	switch (func)
+	{
+	case blend_zero: return 0.0f;
+	case blend_one: return 1.0f;
+	case blend_dest_color: return dest[channel];
+	case blend_src_color: return src[channel];
+	case blend_one_minus_dest_color: return 1.0f - dest[channel];
+	case blend_one_minus_src_color: return 1.0f - src[channel];
+	case blend_src_alpha: return src[3];
+	case blend_one_minus_src_alpha: return 1.0f - src[3];
+	case blend_dest_alpha: return dest[3];
+	case blend_one_minus_dest_alpha: return 1.0f - dest[3];
+	case blend_src_alpha_saturate: return channel == 3 ? 1.0f : min(src[3], 1.0f - dest[3]);
+	case blend_constant_color: return constant_color[channel];
+	case blend_one_minus_constant_color: return 1.0f - constant_color[channel];
+	case blend_constant_alpha: return constant.a;
+	case blend_one_minus_constant_alpha: return 1.0f - constant.a;
+	default: return 1.0f;
+	}
+}
+
+}
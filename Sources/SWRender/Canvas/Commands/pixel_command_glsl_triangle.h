@@ -0,0 +1,94 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/SWRender/pixel_command.h"
+#include "API/Display/Render/graphic_context.h"
+#include "../../GLSL/Simd/glsl_simd_program.h"
+
+namespace clan
+{
+
+class PixelPipeline;
+
+/// \brief Fragment shader and the vertex data layout it is fed with
+///
+/// Each vertex holds the clip space position followed by the components of the varyings.
+class PixelGlslFragmentSetup
+{
+public:
+	PixelGlslFragmentSetup() : vertex_size(4), frag_coord_register(-1), color_register(-1) { }
+
+	struct Varying
+	{
+		Varying() : first_register(0), num_registers(0), vertex_offset(0), interpolation(GlslSimdSymbol::interpolate_smooth) { }
+		int first_register;
+		int num_registers;
+		int vertex_offset;
+		GlslSimdSymbol::Interpolation interpolation;
+	};
+
+	std::shared_ptr<GlslSimdProgram> program;
+	std::vector<Varying> varyings;
+	int vertex_size;
+	int frag_coord_register;
+	int color_register;
+};
+
+/// \brief Rasterizes a triangle (or a quad left by near plane clipping) with a compiled GLSL fragment shader
+class PixelCommandGlslTriangle : public PixelCommand
+{
+public:
+	PixelCommandGlslTriangle(PixelPipeline *pipeline, const std::shared_ptr<PixelGlslFragmentSetup> &setup, const std::shared_ptr<std::vector<float> > &register_image, const float *vertices, int num_vertices);
+	~PixelCommandGlslTriangle();
+
+	void run(PixelThreadContext *context);
+
+	enum { max_vertices = 4 };
+
+private:
+	struct ScreenVertex
+	{
+		float x, y, z, rcp_w;
+		const float *varyings;
+	};
+
+	void render_triangle(PixelThreadContext *context, GlslSimdRegisters &registers, const ScreenVertex *v[3]);
+	void shade_block(PixelThreadContext *context, GlslSimdRegisters &registers, int x, int y, int count, const float b0[8], const float b1[8], const float b2[8], const ScreenVertex *v[3]);
+	void write_block(PixelThreadContext *context, GlslSimdRegisters &registers, int x, int y, int count);
+	static float blend_factor(BlendFunc func, int channel, const float src[4], const float dest[4], const Colorf &constant);
+
+	PixelPipeline *pipeline;
+	std::shared_ptr<PixelGlslFragmentSetup> setup;
+	std::shared_ptr<std::vector<float> > register_image;
+	float *vertices;
+	int num_vertices;
+};
+
+}
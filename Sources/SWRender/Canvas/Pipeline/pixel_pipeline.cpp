@@ -27,7 +27,6 @@
 */
 
 #include "SWRender/precomp.h"
-//#define PROFILE_PIPELINE
 #include "pixel_pipeline.h"
 #include "API/SWRender/pixel_thread_context.h"
 #include "API/SWRender/pixel_command.h"
@@ -39,24 +38,13 @@
 	#define cl_compiler_barrier()  __asm__ __volatile__("" : : : "memory")
 #endif
 
-#ifdef PROFILE_PIPELINE
-#include "API/Core/Text/string_format.h"
-#endif
-
 namespace clan
 {
 
 
 PixelPipeline::PixelPipeline()
-: active_cores(0), local_writer_index(0), local_reader_index(0), local_commands_written(0), cur_block(0)
+: active_cores(System::get_num_cores()), local_writer_index(0), local_reader_index(0), local_commands_written(0), cur_block(0), profiler(active_cores)
 {
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-	SetThreadIdealProcessor(GetCurrentThread(), 0);
-	SetThreadAffinityMask(GetCurrentThread(), 1);
-	profiler.start_time = __rdtsc();
-#endif
-
-	active_cores = System::get_num_cores();
 	for (size_t i = 0; i < queue_max; i++)
 		command_queue[i] = 0;
 	reader_indices.resize(active_cores);
@@ -78,9 +66,6 @@ PixelPipeline::PixelPipeline()
 PixelPipeline::~PixelPipeline()
 {
 	wait_for_workers();
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-	profiler.end_time = __rdtsc();
-#endif
 	event_stop.set();
 	for (std::vector<Thread>::size_type i = 0; i < worker_threads.size(); i++)
 		worker_threads[i].join();
@@ -93,16 +78,6 @@ PixelPipeline::~PixelPipeline()
 
 	if (cur_block && cur_block->refcount == 1)
 		delete[] (char*) cur_block;
-
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-	MessageBoxA(0, cl_format("Queue = %1\r\nSetEvent = %2\r\nWaitForWorkers = %3\r\nWaitForSpace = %4\r\nAllocFree = %5",
-		(int)(profiler.queue_time*100/(profiler.end_time-profiler.start_time)),
-		(int)(profiler.set_event_time*100/(profiler.end_time-profiler.start_time)),
-		(int)(profiler.wait_for_workers_time*100/(profiler.end_time-profiler.start_time)),
-		(int)(profiler.wait_for_space_time*100/(profiler.end_time-profiler.start_time)),
-		(int)(profiler.alloc_time*100/(profiler.end_time-profiler.start_time))).c_str(),
-		"DEBUG", MB_OK);
-#endif
 }
 
 void PixelPipeline::queue(std::unique_ptr<PixelCommand> &command)
@@ -110,9 +85,7 @@ void PixelPipeline::queue(std::unique_ptr<PixelCommand> &command)
 	wait_for_space();
 	delete command_queue[local_writer_index];
 
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-	unsigned __int64 start_time = __rdtsc();
-#endif
+	ubyte64 start_time = cl_pipeline_ticks();
 
 	command_queue[local_writer_index] = command.get();
 	command.release();
@@ -121,6 +94,7 @@ void PixelPipeline::queue(std::unique_ptr<PixelCommand> &command)
 	if (local_writer_index == queue_max)
 		local_writer_index = 0;
 	local_commands_written++;
+	profiler.commands_queued++;
 
 	if (local_commands_written == fragment_size)
 	{
@@ -128,57 +102,49 @@ void PixelPipeline::queue(std::unique_ptr<PixelCommand> &command)
 		writer_index.set(local_writer_index);
 		local_commands_written = 0;
 
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-		unsigned __int64 start_event_time = __rdtsc();
-#endif
+		ubyte64 start_event_time = cl_pipeline_ticks();
 		for (int i = 0; i < active_cores; i++)
 		{
 			if (reader_active[i].get() == 0)
 				event_more_commands[i].set();
 		}
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-		unsigned __int64 end_event_time = __rdtsc();
-		profiler.set_event_time += end_event_time-start_event_time;
-#endif
+		ubyte64 end_event_time = cl_pipeline_ticks();
+		profiler.set_event_ticks += end_event_time-start_event_time;
 	}
 
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-	unsigned __int64 end_time = __rdtsc();
-	profiler.queue_time += end_time-start_time;
-#endif
+	ubyte64 end_time = cl_pipeline_ticks();
+	profiler.queue_ticks += end_time-start_time;
 }
 
 void PixelPipeline::wait_for_space()
 {
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-	unsigned __int64 start_time = __rdtsc();
-#endif
-
 	int next_index = local_writer_index+1;
 	if (next_index == queue_max)
 		next_index = 0;
 	if (next_index == local_reader_index)
 	{
+		ubyte64 start_time = cl_pipeline_ticks();
+
 		update_local_reader_index();
+		if (next_index == local_reader_index)
+			profiler.wait_for_space_stalls++;
 		while (next_index == local_reader_index)
 		{
 			event_reader_done.wait();
 			event_reader_done.reset();
 			update_local_reader_index();
 		}
-	}
 
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-	unsigned __int64 end_time = __rdtsc();
-	profiler.wait_for_space_time += end_time-start_time;
-#endif
+		ubyte64 end_time = cl_pipeline_ticks();
+		profiler.wait_for_space_ticks += end_time-start_time;
+		if (profiler.is_tracing_enabled())
+			profiler.add_producer_event("wait_for_space", start_time, end_time);
+	}
 }
 
 void PixelPipeline::wait_for_workers()
 {
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-	unsigned __int64 start_time = __rdtsc();
-#endif
+	ubyte64 start_time = cl_pipeline_ticks();
 
 	if (local_commands_written > 0)
 	{
@@ -199,12 +165,12 @@ void PixelPipeline::wait_for_workers()
 			event_reader_done.reset();
 			update_local_reader_index();
 		}
-	}
 
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-	unsigned __int64 end_time = __rdtsc();
-	profiler.wait_for_workers_time += end_time-start_time;
-#endif
+		ubyte64 end_time = cl_pipeline_ticks();
+		profiler.wait_for_workers_ticks += end_time-start_time;
+		if (profiler.is_tracing_enabled())
+			profiler.add_producer_event("wait_for_workers", start_time, end_time);
+	}
 }
 
 void PixelPipeline::update_local_reader_index()
@@ -224,44 +190,25 @@ void PixelPipeline::update_local_reader_index()
 
 void PixelPipeline::worker_main(int core)
 {
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-	SetThreadIdealProcessor(GetCurrentThread(), core);
-	SetThreadAffinityMask(GetCurrentThread(), 1 << core);
-	unsigned __int64 ticks_waiting = 0;
-	unsigned __int64 ticks_working = 0;
-#endif
 	PixelThreadContext context(core, active_cores);
+	PixelPipelineWorkerBatch batch;
 	while (true)
 	{
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-		unsigned __int64 wait_start_time = __rdtsc();
-#endif
+		batch.wait_start = cl_pipeline_ticks();
 		int wakeup_reason = Event::wait(event_more_commands[core], event_stop);
 		if (wakeup_reason != 0)
 			break;
 		event_more_commands[core].reset();
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-		unsigned __int64 wait_end_time = __rdtsc();
-		ticks_waiting += wait_end_time-wait_start_time;
-#endif
-		process_commands(&context);
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-		unsigned __int64 commands_end_time = __rdtsc();
-		ticks_working += commands_end_time-wait_end_time;
-#endif
+		batch.busy_start = cl_pipeline_ticks();
+		process_commands(&context, batch);
+		batch.busy_end = cl_pipeline_ticks();
+		profiler.add_worker_batch(core, batch);
 	}
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-	MessageBoxA(
-		0,
-		cl_format("Pipeline core %1 spent %2 percent of its time waiting for commands",
-		core,
-		(int)(ticks_waiting*100/(ticks_working+ticks_waiting))).c_str(),
-		"DEBUG", MB_OK);
-#endif
 }
 
-void PixelPipeline::process_commands(PixelThreadContext *context)
+void PixelPipeline::process_commands(PixelThreadContext *context, PixelPipelineWorkerBatch &batch)
 {
+	bool profile_commands = profiler.is_command_profiling_enabled();
 	while (true)
 	{
 		int worker_reader_index = reader_indices[context->core].get();
@@ -274,7 +221,17 @@ void PixelPipeline::process_commands(PixelThreadContext *context)
 		while (worker_reader_index != worker_writer_index)
 		{
 			PixelCommand *command = command_queue[worker_reader_index];
-			command->run(context);
+			if (profile_commands)
+			{
+				ubyte64 start_time = cl_pipeline_ticks();
+				command->run(context);
+				batch.add_command(command, cl_pipeline_ticks() - start_time);
+			}
+			else
+			{
+				command->run(context);
+			}
+			batch.commands_processed++;
 
 			worker_reader_index++;
 			if (worker_reader_index == queue_max)
@@ -303,9 +260,7 @@ void PixelPipeline::process_commands(PixelThreadContext *context)
 
 void *PixelPipeline::alloc_command(size_t s)
 {
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-	unsigned __int64 start_time = __rdtsc();
-#endif
+	ubyte64 start_time = cl_pipeline_ticks();
 
 	s += sizeof(unsigned int);
 	s = ((s+63)/64)*64; // Place each command in its own cache line (is this really smart?)
@@ -326,6 +281,7 @@ void *PixelPipeline::alloc_command(size_t s)
 		cur_block->data = data + sizeof(AllocBlock);
 		cur_block->pos = 0;
 		cur_block->refcount = 1;
+		profiler.allocated_blocks++;
 	}
 
 	char *d = cur_block->data + cur_block->pos;
@@ -335,19 +291,15 @@ void *PixelPipeline::alloc_command(size_t s)
 	cur_block->pos += s;
 	cur_block->refcount++;
 
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-	unsigned __int64 end_time = __rdtsc();
-	profiler.alloc_time += end_time-start_time;
-#endif
+	ubyte64 end_time = cl_pipeline_ticks();
+	profiler.alloc_ticks += end_time-start_time;
 
 	return d;
 }
 
 void PixelPipeline::free_command(void *d)
 {
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-	unsigned __int64 start_time = __rdtsc();
-#endif
+	ubyte64 start_time = cl_pipeline_ticks();
 
 	char *data = (char *) d;
 	data -= sizeof(unsigned int);
@@ -357,10 +309,8 @@ void PixelPipeline::free_command(void *d)
 	if (block->refcount == 0)
 		delete[] (char*) block;
 
-#if defined(WIN32) && defined(PROFILE_PIPELINE)
-	unsigned __int64 end_time = __rdtsc();
-	profiler.alloc_time += end_time-start_time;
-#endif
+	ubyte64 end_time = cl_pipeline_ticks();
+	profiler.alloc_ticks += end_time-start_time;
 }
 
 }
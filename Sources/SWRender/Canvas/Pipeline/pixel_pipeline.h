@@ -35,6 +35,7 @@
 
 
 #include "API/SWRender/pixel_command.h"
+#include "pixel_pipeline_profiler.h"
 #include <memory>
 
 namespace clan
@@ -56,9 +57,11 @@ public:
 	void *alloc_command(size_t s);
 	void free_command(void *d);
 
+	PixelPipelineProfiler &get_profiler() { return profiler; }
+
 private:
 	void worker_main(int core);
-	void process_commands(PixelThreadContext *context);
+	void process_commands(PixelThreadContext *context, PixelPipelineWorkerBatch &batch);
 	void wait_for_space();
 	void update_local_reader_index();
 
@@ -88,19 +91,7 @@ private:
 	};
 	AllocBlock *cur_block;
 
-	#ifdef PROFILE_PIPELINE
-	struct PerformanceCounters
-	{
-		PerformanceCounters() : start_time(0), end_time(0), queue_time(0), set_event_time(0), wait_for_workers_time(0), wait_for_space_time(0), alloc_time(0) { }
-		unsigned __int64 start_time;
-		unsigned __int64 end_time;
-		unsigned __int64 queue_time;
-		unsigned __int64 set_event_time;
-		unsigned __int64 wait_for_workers_time;
-		unsigned __int64 wait_for_space_time;
-		unsigned __int64 alloc_time;
-	} profiler;
-	#endif
+	PixelPipelineProfiler profiler;
 };
 
 }
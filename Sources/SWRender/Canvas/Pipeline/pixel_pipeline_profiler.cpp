@@ -0,0 +1,271 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "SWRender/precomp.h"
+#include "pixel_pipeline_profiler.h"
+#include "API/SWRender/pixel_command.h"
+#include "API/Core/JSON/json_value.h"
+#include "API/Core/IOData/file.h"
+
+#ifndef WIN32
+#include <sys/time.h>
+#endif
+
+#ifdef __GNUC__
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// PixelPipelineWorkerBatch Operations:
+
+static int find_histogram_bucket(ubyte64 value)
+{
+	int bucket = 0;
+	while (value > 1 && bucket < PixelPipelineCommandStatistics::num_buckets - 1)
+	{
+		value >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+void PixelPipelineWorkerBatch::add_command(const PixelCommand *command, ubyte64 ticks)
+{
+	CommandCounters &counters = commands[&typeid(*command)];
+	counters.count++;
+	counters.ticks += ticks;
+	counters.histogram[find_histogram_bucket(ticks)]++;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// PixelPipelineProfiler Construction:
+
+PixelPipelineProfiler::PixelPipelineProfiler(int num_workers)
+: workers(num_workers), worker_busy_ticks(num_workers), worker_wait_ticks(num_workers)
+{
+	reset();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// PixelPipelineProfiler Attributes:
+
+PixelPipelineStatistics PixelPipelineProfiler::get_statistics()
+{
+	double ticks_per_microsecond = get_ticks_per_microsecond();
+
+	PixelPipelineStatistics statistics;
+	statistics.elapsed_microseconds = System::get_microseconds() - start_microseconds;
+	statistics.queue_microseconds = (ubyte64)(queue_ticks / ticks_per_microsecond);
+	statistics.set_event_microseconds = (ubyte64)(set_event_ticks / ticks_per_microsecond);
+	statistics.wait_for_space_microseconds = (ubyte64)(wait_for_space_ticks / ticks_per_microsecond);
+	statistics.wait_for_workers_microseconds = (ubyte64)(wait_for_workers_ticks / ticks_per_microsecond);
+	statistics.alloc_microseconds = (ubyte64)(alloc_ticks / ticks_per_microsecond);
+	statistics.commands_queued = commands_queued;
+	statistics.wait_for_space_stalls = wait_for_space_stalls;
+	statistics.allocated_blocks = allocated_blocks;
+
+	MutexSection mutex_lock(&mutex);
+
+	statistics.workers = workers;
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		statistics.workers[i].busy_microseconds = (ubyte64)(worker_busy_ticks[i] / ticks_per_microsecond);
+		statistics.workers[i].wait_microseconds = (ubyte64)(worker_wait_ticks[i] / ticks_per_microsecond);
+	}
+
+	// Histograms are recorded in log2(ticks) buckets. Shift them to log2(nanoseconds) buckets.
+	int bucket_shift = find_histogram_bucket((ubyte64)(ticks_per_microsecond + 0.5)) - find_histogram_bucket(1000);
+
+	std::map<const std::type_info *, PixelPipelineWorkerBatch::CommandCounters>::iterator it;
+	for (it = commands.begin(); it != commands.end(); ++it)
+	{
+		PixelPipelineCommandStatistics command;
+
+		command.name = it->first->name();
+#ifdef __GNUC__
+		int status = 0;
+		char *demangled_name = abi::__cxa_demangle(command.name.c_str(), 0, 0, &status);
+		if (demangled_name)
+		{
+			command.name = demangled_name;
+			free(demangled_name);
+		}
+#endif
+		command.count = it->second.count;
+		command.total_microseconds = (ubyte64)(it->second.ticks / ticks_per_microsecond);
+		command.histogram.resize(PixelPipelineCommandStatistics::num_buckets);
+		for (int bucket = 0; bucket < PixelPipelineCommandStatistics::num_buckets; bucket++)
+		{
+			int target_bucket = clamp(bucket - bucket_shift, 0, (int)PixelPipelineCommandStatistics::num_buckets - 1);
+			command.histogram[target_bucket] += it->second.histogram[bucket];
+		}
+		statistics.commands.push_back(command);
+	}
+
+	return statistics;
+}
+
+double PixelPipelineProfiler::get_ticks_per_microsecond() const
+{
+	ubyte64 elapsed_ticks = cl_pipeline_ticks() - start_ticks;
+	ubyte64 elapsed_microseconds = System::get_microseconds() - start_microseconds;
+	if (elapsed_microseconds == 0 || elapsed_ticks == 0)
+		return 1.0;
+	return elapsed_ticks / (double)elapsed_microseconds;
+}
+
+ubyte64 PixelPipelineProfiler::fallback_ticks()
+{
+	return System::get_microseconds();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// PixelPipelineProfiler Operations:
+
+void PixelPipelineProfiler::add_producer_event(const char *name, ubyte64 start, ubyte64 end)
+{
+	MutexSection mutex_lock(&mutex);
+	if (trace_events.size() < max_trace_events)
+		trace_events.push_back(TraceEvent(name, 0, start, end, 0));
+}
+
+void PixelPipelineProfiler::add_worker_batch(int core, PixelPipelineWorkerBatch &batch)
+{
+	MutexSection mutex_lock(&mutex);
+
+	// A batch started before the last reset only counts from the reset onwards. The reset may also
+	// have happened after the batch ended, so every span is clamped to be at least empty.
+	ubyte64 wait_start = max(batch.wait_start, start_ticks);
+	ubyte64 busy_start = max(batch.busy_start, start_ticks);
+	ubyte64 busy_end = max(batch.busy_end, busy_start);
+	wait_start = min(wait_start, busy_start);
+
+	worker_wait_ticks[core] += busy_start - wait_start;
+	worker_busy_ticks[core] += busy_end - busy_start;
+
+	// Commands are not time stamped, so those of a batch that started before the reset are dropped
+	if (batch.busy_start >= start_ticks)
+	{
+		workers[core].wakeups++;
+		workers[core].commands_processed += batch.commands_processed;
+
+		std::map<const std::type_info *, PixelPipelineWorkerBatch::CommandCounters>::iterator it;
+		for (it = batch.commands.begin(); it != batch.commands.end(); ++it)
+		{
+			PixelPipelineWorkerBatch::CommandCounters &counters = commands[it->first];
+			counters.count += it->second.count;
+			counters.ticks += it->second.ticks;
+			for (int bucket = 0; bucket < PixelPipelineCommandStatistics::num_buckets; bucket++)
+				counters.histogram[bucket] += it->second.histogram[bucket];
+		}
+	}
+
+	if (is_tracing_enabled() && trace_events.size() < max_trace_events && busy_end > busy_start)
+		trace_events.push_back(TraceEvent("process_commands", core + 1, busy_start, busy_end, batch.commands_processed));
+
+	batch.commands.clear();
+	batch.commands_processed = 0;
+}
+
+void PixelPipelineProfiler::reset()
+{
+	queue_ticks = 0;
+	set_event_ticks = 0;
+	wait_for_space_ticks = 0;
+	wait_for_workers_ticks = 0;
+	alloc_ticks = 0;
+	commands_queued = 0;
+	wait_for_space_stalls = 0;
+	allocated_blocks = 0;
+
+	MutexSection mutex_lock(&mutex);
+	start_ticks = cl_pipeline_ticks();
+	start_microseconds = System::get_microseconds();
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i] = PixelPipelineWorkerStatistics();
+		worker_busy_ticks[i] = 0;
+		worker_wait_ticks[i] = 0;
+	}
+	commands.clear();
+	trace_events.clear();
+}
+
+void PixelPipelineProfiler::save_trace(const std::string &filename)
+{
+	double ticks_per_microsecond = get_ticks_per_microsecond();
+
+	JsonValue events = JsonValue::array();
+
+	MutexSection mutex_lock(&mutex);
+
+	for (size_t i = 0; i < workers.size() + 1; i++)
+	{
+		JsonValue thread_name = JsonValue::object();
+		thread_name["name"] = std::string("thread_name");
+		thread_name["ph"] = std::string("M");
+		thread_name["pid"] = 1;
+		thread_name["tid"] = (int)i;
+		thread_name["args"] = JsonValue::object();
+		thread_name["args"]["name"] = (i == 0) ? std::string("Producer") : string_format("Worker %1", (int)i - 1);
+		events.get_items().push_back(thread_name);
+	}
+
+	for (size_t i = 0; i < trace_events.size(); i++)
+	{
+		const TraceEvent &trace_event = trace_events[i];
+
+		JsonValue event = JsonValue::object();
+		event["name"] = std::string(trace_event.name);
+		event["cat"] = std::string("PixelPipeline");
+		event["ph"] = std::string("X");
+		event["pid"] = 1;
+		event["tid"] = trace_event.thread;
+		event["ts"] = (trace_event.start - start_ticks) / ticks_per_microsecond;
+		event["dur"] = (trace_event.end - trace_event.start) / ticks_per_microsecond;
+		if (trace_event.commands > 0)
+		{
+			event["args"] = JsonValue::object();
+			event["args"]["commands"] = (double)trace_event.commands;
+		}
+		events.get_items().push_back(event);
+	}
+
+	mutex_lock.unlock();
+
+	JsonValue trace = JsonValue::object();
+	trace["traceEvents"] = events;
+	trace["displayTimeUnit"] = std::string("ns");
+	File::write_text(filename, trace.to_json());
+}
+
+}
@@ -0,0 +1,146 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/SWRender/pixel_pipeline_statistics.h"
+#include "API/Core/System/mutex.h"
+#include "API/Core/System/interlocked_variable.h"
+#include <typeinfo>
+#include <map>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#define cl_pipeline_ticks() ((ubyte64)__rdtsc())
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#include <x86intrin.h>
+#define cl_pipeline_ticks() ((ubyte64)__rdtsc())
+#else
+#define cl_pipeline_ticks() PixelPipelineProfiler::fallback_ticks()
+#endif
+
+namespace clan
+{
+
+class PixelCommand;
+
+/// \brief Counters collected by a worker thread between two wakeups
+///
+/// The worker fills this without any locking and hands it to the profiler when it goes back to sleep.
+class PixelPipelineWorkerBatch
+{
+public:
+	PixelPipelineWorkerBatch() : wait_start(0), busy_start(0), busy_end(0), commands_processed(0) { }
+
+	struct CommandCounters
+	{
+		CommandCounters() : count(0), ticks(0) { for (int i = 0; i < PixelPipelineCommandStatistics::num_buckets; i++) histogram[i] = 0; }
+		ubyte64 count;
+		ubyte64 ticks;
+		ubyte64 histogram[PixelPipelineCommandStatistics::num_buckets];
+	};
+
+	void add_command(const PixelCommand *command, ubyte64 ticks);
+
+	ubyte64 wait_start;
+	ubyte64 busy_start;
+	ubyte64 busy_end;
+	ubyte64 commands_processed;
+	std::map<const std::type_info *, CommandCounters> commands;
+};
+
+/// \brief Performance counters and trace recorder for PixelPipeline
+///
+/// All times are kept as raw ticks and converted to wall clock time when read, using the
+/// elapsed time since the last reset to calibrate the tick rate.
+class PixelPipelineProfiler
+{
+public:
+	PixelPipelineProfiler(int num_workers);
+
+	// Producer counters. Only touched by the thread queueing commands.
+	ubyte64 queue_ticks;
+	ubyte64 set_event_ticks;
+	ubyte64 wait_for_space_ticks;
+	ubyte64 wait_for_workers_ticks;
+	ubyte64 alloc_ticks;
+	ubyte64 commands_queued;
+	ubyte64 wait_for_space_stalls;
+	ubyte64 allocated_blocks;
+
+	bool is_command_profiling_enabled() const { return command_profiling.get() != 0; }
+	bool is_tracing_enabled() const { return tracing.get() != 0; }
+
+	void set_command_profiling_enabled(bool enable) { command_profiling.set(enable ? 1 : 0); }
+	void set_tracing_enabled(bool enable) { tracing.set(enable ? 1 : 0); }
+
+	/// \brief Records a producer side span in the trace (producer thread only)
+	void add_producer_event(const char *name, ubyte64 start, ubyte64 end);
+
+	/// \brief Merges the counters of a worker batch (called by the worker thread)
+	void add_worker_batch(int core, PixelPipelineWorkerBatch &batch);
+
+	PixelPipelineStatistics get_statistics();
+	void reset();
+
+	/// \brief Writes the recorded trace as a Chrome trace event JSON file
+	void save_trace(const std::string &filename);
+
+	static ubyte64 fallback_ticks();
+
+private:
+	struct TraceEvent
+	{
+		TraceEvent() : name(0), thread(0), start(0), end(0), commands(0) { }
+		TraceEvent(const char *name, int thread, ubyte64 start, ubyte64 end, ubyte64 commands) : name(name), thread(thread), start(start), end(end), commands(commands) { }
+		const char *name;
+		int thread;
+		ubyte64 start;
+		ubyte64 end;
+		ubyte64 commands;
+	};
+
+	double get_ticks_per_microsecond() const;
+
+	enum { max_trace_events = 256 * 1024 };
+
+	InterlockedVariable command_profiling;
+	InterlockedVariable tracing;
+
+	ubyte64 start_ticks;
+	ubyte64 start_microseconds;
+
+	Mutex mutex;
+	std::vector<PixelPipelineWorkerStatistics> workers;
+	std::vector<ubyte64> worker_busy_ticks;
+	std::vector<ubyte64> worker_wait_ticks;
+	std::map<const std::type_info *, PixelPipelineWorkerBatch::CommandCounters> commands;
+	std::vector<TraceEvent> trace_events;
+};
+
+}
@@ -0,0 +1,70 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "SWRender/precomp.h"
+#include "glsl_ast_garbage_collector.h"
+#include "glsl_ast_node.h"
+#include <exception>
+#include <algorithm>
+
+namespace clan
+{
+
+GlslAstGarbageCollector::~GlslAstGarbageCollector()
+{
+	for (size_t i = 0; i < gc_nodes.size(); i++)
+	{
+		gc_nodes[i]->~GlslAstNode();
+		free(gc_nodes[i]);
+		gc_nodes[i] = 0;
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void *GlslAstNode::operator new(size_t size, GlslAstGarbageCollector *gc)
+{
+	void *ptr = malloc(size);
+	gc->gc_nodes.push_back(static_cast<GlslAstNode*>(ptr));
+	return ptr;
+}
+
+void GlslAstNode::operator delete(void *ptr, GlslAstGarbageCollector *gc)
+{
+	std::vector<GlslAstNode *>::iterator it = std::find(gc->gc_nodes.begin(), gc->gc_nodes.end(), ptr);
+	if (it != gc->gc_nodes.end())
+		gc->gc_nodes.erase(it);
+	free(ptr);
+}
+
+void GlslAstNode::operator delete(void *ptr)
+{
+	std::terminate();
+}
+
+}
@@ -0,0 +1,122 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "glsl_ast_node.h"
+
+namespace clan
+{
+
+class GlslAstExpression;
+typedef GlslAstExpression GlslAstIntegralConstantExpression;
+class GlslAstType;
+class GlslAstLayoutQualifierId;
+
+enum GlslAstPrecision
+{
+	highp,
+	mediump,
+	lowp
+};
+
+class GlslAstVariable : public GlslAstNode
+{
+public:
+	GlslAstVariable() : type(), is_array(), array_size() { }
+
+	std::string name;
+	GlslAstType *type;
+	bool is_array;
+	GlslAstIntegralConstantExpression *array_size;
+};
+
+class GlslAstFunctionVariable : public GlslAstVariable
+{
+public:
+	GlslAstFunctionVariable() : is_const(), initial_value() { }
+
+	bool is_const;
+	GlslAstExpression *initial_value;
+};
+
+class GlslAstFunctionParameter : public GlslAstVariable
+{
+public:
+	GlslAstFunctionParameter() : is_in(), is_out(), precision() { }
+
+	bool is_in;
+	bool is_out;
+	// to do: memory qualifier missing
+	GlslAstPrecision precision;
+};
+
+class GlslAstGlobalVariable : public GlslAstVariable
+{
+public:
+	GlslAstGlobalVariable() : is_const(), is_in(), is_out(), is_centroid(), is_patch(), is_sample(), is_uniform(), is_varying(), interpolation(), is_invariant(), precision(), initial_value() { }
+
+	bool is_const;
+	bool is_in;
+	bool is_out;
+	bool is_centroid;
+	bool is_patch;
+	bool is_sample;
+	bool is_uniform;
+	bool is_varying; // GLSL 1.20 'varying': out in a vertex shader, in in a fragment shader
+	std::vector<GlslAstLayoutQualifierId *> layout_ids;
+	enum Interpolation
+	{
+		smooth,
+		flat,
+		perspective,
+		noperspective
+	};
+	Interpolation interpolation;
+	bool is_invariant;
+	GlslAstPrecision precision;
+	GlslAstExpression *initial_value;
+};
+
+// gl_Position, gl_FragColor, etc. The type depends on the shader stage and is resolved by the code generator.
+class GlslAstBuiltInVariable : public GlslAstVariable
+{
+public:
+};
+
+class GlslAstLayoutQualifierId : public GlslAstNode
+{
+public:
+	GlslAstLayoutQualifierId() : has_id(), id() { }
+
+	std::string name;
+	bool has_id;
+	int id;
+};
+
+}
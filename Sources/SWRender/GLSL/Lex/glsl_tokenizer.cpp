@@ -1,8 +1,36 @@
-
-#include "precomp.h"
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "SWRender/precomp.h"
 #include "glsl_tokenizer.h"
 
-using namespace clan;
+namespace clan
+{
 
 GlslTokenizer::GlslTokenizer(std::string data)
 : data(data), pos(0), saved_pos(0)
@@ -227,9 +255,9 @@ void GlslTokenizer::read_token(GlslToken &out_token, bool skip_whitespace_and_co
 GlslToken GlslTokenizer::peek_token(bool skip_whitespace_and_comments)
 {
 	GlslToken token;
-	save_position();
+	size_t peek_pos = pos;
 	read_token(token, skip_whitespace_and_comments);
-	restore_position();
+	pos = peek_pos;
 	return token;
 }
 
@@ -248,7 +276,7 @@ void GlslTokenizer::read_token(GlslToken &out_token)
 	{
 		out_token.type = GlslToken::type_eof;
 	}
-	else if ((data[pos] >= '0' && data[pos] <= '9') || (data[pos] == '.' && next_char >= '0' && next_char < '9'))
+	else if ((data[pos] >= '0' && data[pos] <= '9') || (data[pos] == '.' && next_char >= '0' && next_char <= '9'))
 	{
 		bool is_float = false;
 		bool is_double = false;
@@ -281,7 +309,7 @@ void GlslTokenizer::read_token(GlslToken &out_token)
 			number += read_digit_sequence(is_octal, is_hex);
 		}
 
-		if (pos != data.length() && (data[pos] == 'e' && data[pos] == 'E'))
+		if (!is_hex && pos != data.length() && (data[pos] == 'e' || data[pos] == 'E'))
 		{
 			next_char = 0;
 			third_char = 0;
@@ -297,6 +325,13 @@ void GlslTokenizer::read_token(GlslToken &out_token)
 				number += read_digit_sequence(is_octal, is_hex);
 				is_float = true;
 			}
+			else if (next_char >= '0' && next_char <= '9')
+			{
+				number.push_back(data[pos]);
+				pos++;
+				number += read_digit_sequence(is_octal, is_hex);
+				is_float = true;
+			}
 			else
 			{
 				throw Exception("Invalid number encountered");
@@ -317,7 +352,7 @@ void GlslTokenizer::read_token(GlslToken &out_token)
 				is_float = false;
 				is_double = true;
 			}
-			else if (data[pos] == 'u' && data[pos] == 'U')
+			else if (data[pos] == 'u' || data[pos] == 'U')
 			{
 				if (is_float)
 					throw Exception("Invalid number encountered");
@@ -395,6 +430,11 @@ void GlslTokenizer::read_token(GlslToken &out_token)
 			out_token.type = GlslToken::type_whitespace;
 			break;
 
+		case '#':
+			read_preprocessor_directive();
+			out_token.type = GlslToken::type_comment;
+			break;
+
 		case '.':
 			out_token.type = GlslToken::type_operator;
 			out_token.oper = GlslToken::operator_dot;
@@ -712,6 +752,23 @@ void GlslTokenizer::read_token(GlslToken &out_token)
 	}
 }
 
+void GlslTokenizer::read_preprocessor_directive()
+{
+	// There is no preprocessor. Directives that do not change the token stream are skipped.
+
+	size_t end_pos = data.find('\n', pos);
+	if (end_pos == std::string::npos)
+		end_pos = data.length();
+
+	std::string directive = StringHelp::trim(data.substr(pos + 1, end_pos - pos - 1));
+	std::string::size_type name_end = directive.find_first_of(" \t");
+	std::string name = directive.substr(0, name_end);
+	if (name != "version" && name != "extension" && name != "pragma" && name != "line" && !name.empty())
+		throw Exception(string_format("Preprocessor directive #%1 is not supported", name));
+
+	pos = end_pos;
+}
+
 std::string GlslTokenizer::read_digit_sequence(bool is_octal, bool is_hex)
 {
 	if (is_octal)
@@ -745,3 +802,5 @@ std::string GlslTokenizer::read_digit_sequence(bool is_octal, bool is_hex)
 		return digits;
 	}
 }
+
+}
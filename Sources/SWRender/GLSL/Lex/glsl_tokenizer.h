@@ -0,0 +1,60 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "glsl_token.h"
+#include <map>
+
+namespace clan
+{
+
+class GlslTokenizer
+{
+public:
+	GlslTokenizer(std::string data);
+
+	GlslToken read_token();
+	void read_token(GlslToken &out_token);
+	void read_token(GlslToken &out_token, bool skip_whitespace_and_comments);
+	GlslToken peek_token(bool skip_whitespace_and_comments);
+	void save_position() { saved_pos = pos; }
+	void restore_position() { pos = saved_pos; }
+
+private:
+	std::string read_digit_sequence(bool is_octal, bool is_hex);
+	void read_preprocessor_directive();
+
+	std::string data;
+	size_t pos;
+	size_t saved_pos;
+
+	std::map<std::string, GlslToken::Keyword> keywords;
+};
+
+}
@@ -1,8 +1,36 @@
-
-#include "precomp.h"
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "SWRender/precomp.h"
 #include "glsl_parser.h"
 
-using namespace clan;
+namespace clan
+{
 
 GlslParser::GlslParser(std::string source)
 : tokenizer(source)
@@ -20,28 +48,66 @@ std::unique_ptr<GlslAstTranslationUnit> GlslParser::parse()
 		if (token.type == GlslToken::type_eof)
 			break;
 
+		if (is_keyword(GlslToken::keyword_precision))
+		{
+			// Default precision statements have no effect on the software renderer
+			while (!is_type(GlslToken::type_semicolon))
+				next();
+			continue;
+		}
+
 		FunctionOrGlobalPreparse preparse = preparse_function_or_global();
 
-		if (is_type(GlslToken::type_semicolon))
+		if (is_type(GlslToken::type_semicolon) || is_operator(GlslToken::operator_assign) || is_operator(GlslToken::operator_comma))
 		{
-			GlslAstGlobalVariable *global = new(gc()) GlslAstGlobalVariable();
-			global->is_const = preparse.is_const;
-			global->is_in = preparse.is_in;
-			global->is_out = preparse.is_out;
-			global->is_centroid = preparse.is_centroid;
-			global->is_patch = preparse.is_patch;
-			global->is_sample = preparse.is_sample;
-			global->is_uniform = preparse.is_uniform;
-			global->layout_ids = preparse.layout_ids;
-			global->interpolation = preparse.interpolation;
-			global->is_invariant = preparse.is_invariant;
-			global->precision = preparse.precision;
-			global->type = preparse.type;
-			global->name = preparse.name;
-			global->is_array = preparse.is_array;
-			global->array_size = preparse.array_size;
-			ast->globals.push_back(global);
-			variable_scopes.back().push_back(global);
+			while (true)
+			{
+				GlslAstGlobalVariable *global = new(gc()) GlslAstGlobalVariable();
+				global->is_const = preparse.is_const;
+				global->is_in = preparse.is_in;
+				global->is_out = preparse.is_out;
+				global->is_centroid = preparse.is_centroid;
+				global->is_patch = preparse.is_patch;
+				global->is_sample = preparse.is_sample;
+				global->is_uniform = preparse.is_uniform;
+				global->is_varying = preparse.is_varying;
+				global->layout_ids = preparse.layout_ids;
+				global->interpolation = preparse.interpolation;
+				global->is_invariant = preparse.is_invariant;
+				global->precision = preparse.precision;
+				global->type = preparse.type;
+				global->name = preparse.name;
+				global->is_array = preparse.is_array;
+				global->array_size = preparse.array_size;
+				if (global->name.empty())
+					throw Exception("Syntax error");
+
+				if (is_operator(GlslToken::operator_assign))
+				{
+					next();
+					global->initial_value = parse_expression(semicolon_end | comma_end);
+				}
+
+				ast->globals.push_back(global);
+				variable_scopes.back().push_back(global);
+
+				if (is_type(GlslToken::type_semicolon))
+					break;
+
+				next(); // comma
+				if (!is_type(GlslToken::type_identifier))
+					throw Exception("Syntax error");
+				preparse.name = token.identifier;
+				preparse.is_array = false;
+				preparse.array_size = 0;
+				next();
+				if (is_operator(GlslToken::operator_bracket_begin))
+				{
+					preparse.is_array = true;
+					preparse.array_size = parse_array_size();
+					next();
+				}
+			}
 		}
 		else if (is_operator(GlslToken::operator_paranthesis_begin))
 		{
@@ -59,70 +125,78 @@ std::unique_ptr<GlslAstTranslationUnit> GlslParser::parse()
 GlslParser::FunctionOrGlobalPreparse GlslParser::preparse_function_or_global()
 {
 	FunctionOrGlobalPreparse preparse;
-	if (is_keyword(GlslToken::keyword_const))
-	{
-		preparse.is_const = true;
-		next();
-	}
-	if (is_keyword(GlslToken::keyword_in))
-	{
-		preparse.is_in = true;
-		next();
-	}
-	if (is_keyword(GlslToken::keyword_out))
-	{
-		preparse.is_out = true;
-		next();
-	}
-	if (is_keyword(GlslToken::keyword_inout))
-	{
-		preparse.is_in = true;
-		preparse.is_out = true;
-		next();
-	}
-	if (is_keyword(GlslToken::keyword_centroid))
-	{
-		preparse.is_centroid = true;
-		next();
-	}
-	if (is_keyword(GlslToken::keyword_patch))
-	{
-		preparse.is_patch = true;
-		next();
-	}
-	if (is_keyword(GlslToken::keyword_sample))
-	{
-		preparse.is_sample = true;
-		next();
-	}
-	if (is_keyword(GlslToken::keyword_uniform))
-	{
-		preparse.is_in = true;
-		next();
-	}
-	if (is_keyword(GlslToken::keyword_layout))
-	{
-		parse_layout(preparse.layout_ids);
-		next();
-	}
-	if (is_keyword(GlslToken::keyword_flat) || is_keyword(GlslToken::keyword_smooth))
-	{
-		preparse.interpolation = is_keyword(GlslToken::keyword_flat) ? GlslAstGlobalVariable::flat : GlslAstGlobalVariable::smooth;
-		next();
-	}
-	if (is_keyword(GlslToken::keyword_invariant))
-	{
-		preparse.is_invariant = true;
-		next();
-	}
-	if (is_keyword(GlslToken::keyword_lowp) || is_keyword(GlslToken::keyword_mediump) || is_keyword(GlslToken::keyword_highp))
+	while (true)
 	{
-		if (is_keyword(GlslToken::keyword_lowp))
+		if (is_keyword(GlslToken::keyword_const))
+		{
+			preparse.is_const = true;
+		}
+		else if (is_keyword(GlslToken::keyword_in) || is_keyword(GlslToken::keyword_attribute))
+		{
+			preparse.is_in = true;
+		}
+		else if (is_keyword(GlslToken::keyword_out))
+		{
+			preparse.is_out = true;
+		}
+		else if (is_keyword(GlslToken::keyword_inout))
+		{
+			preparse.is_in = true;
+			preparse.is_out = true;
+		}
+		else if (is_keyword(GlslToken::keyword_varying))
+		{
+			preparse.is_varying = true;
+		}
+		else if (is_keyword(GlslToken::keyword_centroid))
+		{
+			preparse.is_centroid = true;
+		}
+		else if (is_keyword(GlslToken::keyword_patch))
+		{
+			preparse.is_patch = true;
+		}
+		else if (is_keyword(GlslToken::keyword_sample))
+		{
+			preparse.is_sample = true;
+		}
+		else if (is_keyword(GlslToken::keyword_uniform))
+		{
+			preparse.is_uniform = true;
+		}
+		else if (is_keyword(GlslToken::keyword_layout))
+		{
+			parse_layout(preparse.layout_ids);
+		}
+		else if (is_keyword(GlslToken::keyword_flat) || is_keyword(GlslToken::keyword_smooth) || is_keyword(GlslToken::keyword_noperspective))
+		{
+			if (is_keyword(GlslToken::keyword_flat))
+				preparse.interpolation = GlslAstGlobalVariable::flat;
+			else if (is_keyword(GlslToken::keyword_smooth))
+				preparse.interpolation = GlslAstGlobalVariable::smooth;
+			else
+				preparse.interpolation = GlslAstGlobalVariable::noperspective;
+		}
+		else if (is_keyword(GlslToken::keyword_invariant))
+		{
+			preparse.is_invariant = true;
+		}
+		else if (is_keyword(GlslToken::keyword_lowp))
+		{
 			preparse.precision = lowp;
+		}
 		else if (is_keyword(GlslToken::keyword_mediump))
+		{
 			preparse.precision = mediump;
-		else
+		}
+		else if (is_keyword(GlslToken::keyword_highp))
+		{
 			preparse.precision = highp;
+		}
+		else
+		{
+			break;
+		}
 		next();
 	}
 
@@ -158,7 +232,34 @@ GlslParser::FunctionOrGlobalPreparse GlslParser::preparse_function_or_global()
 
 void GlslParser::parse_layout(std::vector<GlslAstLayoutQualifierId *> &layout_ids)
 {
-	throw Exception("layout keyword not yet supported");
+	next(); // layout keyword
+	if (!is_operator(GlslToken::operator_paranthesis_begin))
+		throw Exception("Syntax error");
+	next();
+	while (!is_operator(GlslToken::operator_paranthesis_end))
+	{
+		if (!is_type(GlslToken::type_identifier))
+			throw Exception("Syntax error");
+
+		GlslAstLayoutQualifierId *layout_id = new(gc()) GlslAstLayoutQualifierId();
+		layout_id->name = token.identifier;
+		next();
+		if (is_operator(GlslToken::operator_assign))
+		{
+			next();
+			if (!is_type(GlslToken::type_int_constant) && !is_type(GlslToken::type_uint_constant))
+				throw Exception("Syntax error");
+			layout_id->has_id = true;
+			layout_id->id = token.int_constant;
+			next();
+		}
+		layout_ids.push_back(layout_id);
+
+		if (is_operator(GlslToken::operator_comma))
+			next();
+		else if (!is_operator(GlslToken::operator_paranthesis_end))
+			throw Exception("Syntax error");
+	}
 }
 
 GlslAstType *GlslParser::find_type(const std::string &identifier)
@@ -172,11 +273,11 @@ GlslAstVariable *GlslParser::find_variable(const std::string &identifier)
 	for (size_t scope_index = variable_scopes.size(); scope_index > 0; scope_index--)
 	{
 		VariableScope &scope = variable_scopes[scope_index - 1];
-		for (size_t variable_index = 0; variable_index < scope.size(); variable_index++)
+		for (size_t variable_index = scope.size(); variable_index > 0; variable_index--)
 		{
-			if (scope[variable_index]->name == identifier)
+			if (scope[variable_index - 1]->name == identifier)
 			{
-				return scope[variable_index];
+				return scope[variable_index - 1];
 			}
 		}
 	}
@@ -361,7 +462,10 @@ GlslAstFunction *GlslParser::parse_function(const FunctionOrGlobalPreparse &prep
 		if (parameter->type == 0)
 			throw Exception("Syntax error");
 
-		function->parameters.push_back(parameter);
+		// A single unnamed void parameter is the same as an empty parameter list
+		bool is_void = dynamic_cast<GlslAstBuiltInType *>(parameter->type) && static_cast<GlslAstBuiltInType *>(parameter->type)->type == GlslToken::keyword_void;
+		if (!(is_void && parameter->name.empty()))
+			function->parameters.push_back(parameter);
 		if (is_operator(GlslToken::operator_comma))
 			next();
 	}
@@ -454,11 +558,13 @@ GlslAstCompoundStatement *GlslParser::parse_compound_statement()
 {
 	GlslAstCompoundStatement *statement = new(gc()) GlslAstCompoundStatement();
 	next(); // scope begin
+	variable_scopes.push_back(VariableScope());
 	while (!is_type(GlslToken::type_scope_end))
 	{
 		statement->statements.push_back(parse_statement());
 		next();
 	}
+	variable_scopes.pop_back();
 	return statement;
 }
 
@@ -508,7 +614,7 @@ GlslAstCaseLabelStatement *GlslParser::parse_case_label_statement()
 	GlslAstCaseLabelStatement *statement = new(gc()) GlslAstCaseLabelStatement();
 	if (is_keyword(GlslToken::keyword_default))
 	{
-		statement->is_default = false;
+		statement->is_default = true;
 		next();
 		if (!is_operator(GlslToken::operator_colon))
 			throw Exception("Syntax error");
@@ -529,6 +635,7 @@ GlslAstForStatement *GlslParser::parse_for_statement()
 	if (!is_operator(GlslToken::operator_paranthesis_begin))
 		throw Exception("Syntax error");
 	next();
+	variable_scopes.push_back(VariableScope());
 	if (!is_type(GlslToken::type_semicolon))
 		statement->init = parse_declaration_or_expression_statement(semicolon_end);
 	next();
@@ -539,6 +646,7 @@ GlslAstForStatement *GlslParser::parse_for_statement()
 		statement->loop = parse_expression(paranthesis_end);
 	next();
 	statement->body = parse_statement();
+	variable_scopes.pop_back();
 	return statement;
 }
 
@@ -614,6 +722,7 @@ GlslAstSimpleStatement *GlslParser::parse_declaration_or_expression_statement(Ex
 GlslAstDeclarationStatement *GlslParser::try_parse_declaration_statement(ExpressionEndCondition end_condition)
 {
 	tokenizer.save_position();
+	GlslToken saved_token = token;
 
 	bool is_const = false;
 	GlslAstType *type = 0;
@@ -632,6 +741,7 @@ GlslAstDeclarationStatement *GlslParser::try_parse_declaration_statement(Express
 	if (type == 0)
 	{
 		tokenizer.restore_position();
+		token = saved_token;
 		return 0;
 	}
 
@@ -651,6 +761,7 @@ GlslAstDeclarationStatement *GlslParser::try_parse_declaration_statement(Express
 		if (!is_type(GlslToken::type_identifier))
 		{
 			tokenizer.restore_position();
+			token = saved_token;
 			return 0;
 		}
 
@@ -662,17 +773,28 @@ GlslAstDeclarationStatement *GlslParser::try_parse_declaration_statement(Express
 			if (!is_operator(GlslToken::operator_paranthesis_end))
 			{
 				tokenizer.restore_position();
+				token = saved_token;
 				return 0;
 			}
 			next();
 		}
 
+		bool is_array = false;
+		GlslAstIntegralConstantExpression *array_size = 0;
+		if (is_operator(GlslToken::operator_bracket_begin))
+		{
+			is_array = true;
+			array_size = parse_array_size();
+			next();
+		}
+
 		if (statement->variables.empty() &&
 			!is_operator(GlslToken::operator_assign) &&
 			!is_operator(GlslToken::operator_comma) &&
 			!is_end_condition(end_condition))
 		{
 			tokenizer.restore_position();
+			token = saved_token;
 			return 0;
 		}
 
@@ -688,8 +810,8 @@ GlslAstDeclarationStatement *GlslParser::try_parse_declaration_statement(Express
 		variable->type = type;
 		variable->name = name;
 		variable->initial_value = initial_value;
-		variable->is_array = false; // to do: add support for arrays
-		variable->array_size = 0;
+		variable->is_array = is_array;
+		variable->array_size = array_size;
 		statement->variables.push_back(variable);
 		variable_scopes.back().push_back(variable);
 
@@ -719,7 +841,6 @@ GlslAstExpressionStatement *GlslParser::parse_expression_statement(ExpressionEnd
 
 GlslAstExpression *GlslParser::parse_expression(ExpressionEndCondition end_condition)
 {
-	// To do: add support for the trinary select (?:) operator
 	GlslAstExpression *lhs = parse_unary(end_condition);
 	next();
 	return parse_binary(0, lhs, end_condition);
@@ -838,6 +959,16 @@ GlslAstExpression *GlslParser::parse_unary_prefix(ExpressionEndCondition end_con
 		{
 			GlslAstVariableIdentifer *expression = new(gc()) GlslAstVariableIdentifer();
 			expression->variable = find_variable(token.identifier);
+			if (expression->variable == 0)
+			{
+				if (token.identifier.substr(0, 3) != "gl_")
+					throw Exception(string_format("Undeclared identifier '%1'", token.identifier));
+
+				GlslAstBuiltInVariable *variable = new(gc()) GlslAstBuiltInVariable();
+				variable->name = token.identifier;
+				variable_scopes.front().push_back(variable);
+				expression->variable = variable;
+			}
 			return expression;
 		}
 	}
@@ -895,6 +1026,20 @@ GlslAstExpression *GlslParser::parse_binary(int lhs_precendence, GlslAstExpressi
 		if (binary_precendence < lhs_precendence)
 			break;
 
+		if (is_operator(GlslToken::operator_questionmark))
+		{
+			GlslAstSelectExpression *expression = new(gc()) GlslAstSelectExpression();
+			next();
+			expression->operand1 = lhs;
+			expression->operand2 = parse_expression(colon_end);
+			next();
+			GlslAstExpression *rhs = parse_unary(end_condition);
+			next();
+			expression->operand3 = parse_binary(binary_precendence, rhs, end_condition);
+			lhs = expression;
+			continue;
+		}
+
 		GlslAstBinaryExpression *expression = create_token_expression();
 		next();
 
@@ -903,6 +1048,8 @@ GlslAstExpression *GlslParser::parse_binary(int lhs_precendence, GlslAstExpressi
 		int rhs_precendence = get_token_precendence();
 		if (binary_precendence < rhs_precendence)
 			rhs = parse_binary(binary_precendence + 1, rhs, end_condition);
+		else if (binary_precendence == assignment_precendence && rhs_precendence == assignment_precendence)
+			rhs = parse_binary(binary_precendence, rhs, end_condition); // Assignments are right associative
 
 		expression->operand1 = lhs;
 		expression->operand2 = rhs;
@@ -975,7 +1122,7 @@ int GlslParser::get_token_precendence()
 		case GlslToken::operator_bit_and_assign:
 		case GlslToken::operator_bit_xor_assign:
 		case GlslToken::operator_bit_or_assign:
-			return 2;
+			return assignment_precendence;
 		case GlslToken::operator_comma:
 			return 1; // lowest
 		}
@@ -1913,3 +2060,5 @@ bool GlslParser::variable_identifier()
 }
 
 #endif
+
+}
@@ -1,8 +1,38 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
 
 #pragma once
 
-#include "GLSL/Lex/glsl_tokenizer.h"
-#include "GLSL/AST/glsl_ast.h"
+#include "../Lex/glsl_tokenizer.h"
+#include "../AST/glsl_ast.h"
+
+namespace clan
+{
 
 class GlslParser
 {
@@ -17,7 +47,7 @@ private:
 	{
 		FunctionOrGlobalPreparse()
 		: is_const(false), is_in(false), is_out(false), is_centroid(false), is_patch(false), is_sample(false),
-		  is_uniform(false), interpolation(GlslAstGlobalVariable::perspective), is_invariant(false), precision(highp),
+		  is_uniform(false), is_varying(false), interpolation(GlslAstGlobalVariable::perspective), is_invariant(false), precision(highp),
 		  type(0), is_array(false), array_size(0)
 		{
 		}
@@ -29,6 +59,7 @@ private:
 		bool is_patch;
 		bool is_sample;
 		bool is_uniform;
+		bool is_varying;
 		std::vector<GlslAstLayoutQualifierId *> layout_ids;
 		GlslAstGlobalVariable::Interpolation interpolation;
 		bool is_invariant;
@@ -52,6 +83,8 @@ private:
 
 	typedef int ExpressionEndCondition;
 
+	enum { assignment_precendence = 2 };
+
 	FunctionOrGlobalPreparse preparse_function_or_global();
 	void parse_layout(std::vector<GlslAstLayoutQualifierId *> &layout_ids);
 	GlslAstType *find_type(const std::string &identifier);
@@ -98,3 +131,5 @@ private:
 	std::map<GlslToken::Keyword, GlslAstBuiltInType *> built_in_types;
 	std::vector<VariableScope> variable_scopes;
 };
+
+}
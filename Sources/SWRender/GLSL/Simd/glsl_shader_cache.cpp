@@ -0,0 +1,145 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "SWRender/precomp.h"
+#include "glsl_shader_cache.h"
+#include "glsl_simd_codegen.h"
+#include "../Parse/glsl_parser.h"
+#include "API/Core/IOData/file.h"
+#include "API/Core/IOData/file_help.h"
+#include "API/Core/IOData/path_help.h"
+#include "API/Core/IOData/directory.h"
+#include "API/Core/IOData/iodevice_memory.h"
+#include "API/Core/Crypto/hash_functions.h"
+
+namespace clan
+{
+
+Mutex GlslShaderCache::mutex;
+std::string GlslShaderCache::path;
+std::map<std::string, std::weak_ptr<GlslSimdProgram> > GlslShaderCache::programs;
+
+/////////////////////////////////////////////////////////////////////////////
+// GlslShaderCache Attributes:
+
+std::string GlslShaderCache::get_path()
+{
+	MutexSection mutex_lock(&mutex);
+	return path;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GlslShaderCache Operations:
+
+void GlslShaderCache::set_path(const std::string &new_path)
+{
+	MutexSection mutex_lock(&mutex);
+	path = new_path;
+	if (!path.empty())
+		Directory::create(path, true);
+}
+
+std::shared_ptr<GlslSimdProgram> GlslShaderCache::get_program(ShaderType type, const std::string &source)
+{
+	std::string key = HashFunctions::sha1(string_format("%1:%2:", (int)GlslSimdProgram::version, (int)type) + source);
+
+	MutexSection mutex_lock(&mutex);
+	std::shared_ptr<GlslSimdProgram> program = programs[key].lock();
+	if (program)
+		return program;
+
+	std::string filename;
+	if (!path.empty())
+		filename = PathHelp::combine(path, key + ".swrshader");
+	mutex_lock.unlock();
+
+	if (!filename.empty() && FileHelp::file_exists(filename))
+		program = load_file(filename, type);
+
+	if (!program)
+	{
+		program = compile(type, source);
+		if (!filename.empty())
+			save_file(filename, *program);
+	}
+
+	mutex_lock.lock();
+	programs[key] = program;
+	return program;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GlslShaderCache Implementation:
+
+std::shared_ptr<GlslSimdProgram> GlslShaderCache::compile(ShaderType type, const std::string &source)
+{
+	GlslParser parser(source);
+	std::unique_ptr<GlslAstTranslationUnit> unit = parser.parse();
+	GlslSimdCodegen codegen(type);
+	return codegen.generate(unit.get());
+}
+
+std::shared_ptr<GlslSimdProgram> GlslShaderCache::load_file(const std::string &filename, ShaderType type)
+{
+	try
+	{
+		DataBuffer data = File::read_bytes(filename);
+		IODevice_Memory device(data);
+		if (device.read_uint32() != file_magic || device.read_int32() != GlslSimdProgram::version)
+			return std::shared_ptr<GlslSimdProgram>();
+
+		std::shared_ptr<GlslSimdProgram> program(new GlslSimdProgram());
+		program->load(device);
+		if (program->type != type)
+			return std::shared_ptr<GlslSimdProgram>();
+		return program;
+	}
+	catch (...)
+	{
+		// A damaged cache file is not an error, the shader is simply compiled again
+		return std::shared_ptr<GlslSimdProgram>();
+	}
+}
+
+void GlslShaderCache::save_file(const std::string &filename, const GlslSimdProgram &program)
+{
+	try
+	{
+		IODevice_Memory device;
+		device.write_uint32(file_magic);
+		device.write_int32(GlslSimdProgram::version);
+		program.save(device);
+		File::write_bytes(filename, device.get_data());
+	}
+	catch (Exception &)
+	{
+		// The cache is an optimization. Failing to write it must not fail the compile.
+	}
+}
+
+}
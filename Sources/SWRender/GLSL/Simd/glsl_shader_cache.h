@@ -0,0 +1,66 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "glsl_simd_program.h"
+#include "API/Core/System/mutex.h"
+#include <map>
+
+namespace clan
+{
+
+/// \brief Compiles GLSL shaders, reusing programs compiled earlier
+///
+/// Identical shader sources share one program while it is alive. When a cache path has been set,
+/// compiled programs are also stored on disk so the next run can skip parsing and code generation.
+class GlslShaderCache
+{
+public:
+	/// \brief Returns the compiled program for a shader source
+	///
+	/// Throws an Exception if the source does not compile.
+	static std::shared_ptr<GlslSimdProgram> get_program(ShaderType type, const std::string &source);
+
+	/// \brief Sets the directory used for the disk cache. An empty path disables it.
+	static void set_path(const std::string &path);
+	static std::string get_path();
+
+private:
+	static std::shared_ptr<GlslSimdProgram> compile(ShaderType type, const std::string &source);
+	static std::shared_ptr<GlslSimdProgram> load_file(const std::string &filename, ShaderType type);
+	static void save_file(const std::string &filename, const GlslSimdProgram &program);
+
+	enum { file_magic = 0x47525753 }; // 'SWRG'
+
+	static Mutex mutex;
+	static std::string path;
+	static std::map<std::string, std::weak_ptr<GlslSimdProgram> > programs;
+};
+
+}
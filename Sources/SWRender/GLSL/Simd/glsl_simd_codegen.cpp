@@ -0,0 +1,1661 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "SWRender/precomp.h"
+#include "glsl_simd_codegen.h"
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// GlslSimdCodegen Construction:
+
+GlslSimdCodegen::GlslSimdCodegen(ShaderType type)
+: type(type), unit(0), num_static(0), temp_top(0), max_temp(0), zero_register(0), one_register(0), true_register(0)
+{
+	if (type != shadertype_vertex && type != shadertype_fragment)
+		throw Exception("Only vertex and fragment shaders are supported");
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GlslSimdCodegen Operations:
+
+std::shared_ptr<GlslSimdProgram> GlslSimdCodegen::generate(GlslAstTranslationUnit *new_unit)
+{
+	unit = new_unit;
+	program = std::shared_ptr<GlslSimdProgram>(new GlslSimdProgram());
+	program->type = type;
+	program->mask_register = alloc_static(1);
+	program->alive_register = alloc_static(1);
+	zero_register = constant(0.0f);
+	one_register = constant(1.0f);
+	true_register = constant_bits(0xffffffff);
+
+	GlslAstFunction *main_function = 0;
+	for (size_t i = 0; i < unit->functions.size(); i++)
+	{
+		if (unit->functions[i]->name == "main" && !unit->functions[i]->is_prototype)
+			main_function = unit->functions[i];
+	}
+	if (main_function == 0)
+		throw Exception("Shader has no main function");
+
+	functions.push_back(FunctionContext());
+	functions.back().function = main_function;
+	functions.back().return_mask = alloc_static(1);
+	emit(glsl_op_mov, functions.back().return_mask, zero_register);
+	active_functions.insert(main_function);
+
+	for (size_t i = 0; i < unit->globals.size(); i++)
+		declare_global(unit->globals[i]);
+
+	for (size_t i = 0; i < main_function->statements.size(); i++)
+		generate_statement(main_function->statements[i]);
+
+	patch_jumps(functions.back().end_jumps, program->instructions.size());
+	patch_jumps(program_end_jumps, program->instructions.size());
+	functions.pop_back();
+
+	// Temporaries were numbered downwards from -1 while generating the code. Place them after the permanent registers.
+	for (size_t i = 0; i < program->instructions.size(); i++)
+	{
+		GlslSimdInstruction &inst = program->instructions[i];
+		inst.dest = relocate(inst.dest);
+		inst.a = relocate(inst.a);
+		inst.b = relocate(inst.b);
+		if (inst.opcode != glsl_op_jmp && inst.opcode != glsl_op_jmp_if_none && inst.opcode != glsl_op_jmp_if_any)
+			inst.c = relocate(inst.c);
+	}
+
+	program->num_static_registers = num_static;
+	program->num_registers = num_static + max_temp;
+	return program;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GlslSimdCodegen Implementation:
+
+void GlslSimdCodegen::declare_global(GlslAstGlobalVariable *variable)
+{
+	Type var_type = get_type(variable->type, variable->is_array, variable->array_size);
+	if (var_type.is_void)
+		throw Exception(string_format("Variable '%1' declared void", variable->name));
+
+	GlslSimdSymbol symbol;
+	symbol.name = variable->name;
+	symbol.base_type = var_type.base;
+	symbol.components = var_type.components;
+	symbol.columns = var_type.columns;
+	symbol.array_size = var_type.array_size;
+	symbol.first_register = alloc_static(var_type.get_registers());
+	if (variable->interpolation == GlslAstGlobalVariable::flat)
+		symbol.interpolation = GlslSimdSymbol::interpolate_flat;
+	else if (variable->interpolation == GlslAstGlobalVariable::noperspective)
+		symbol.interpolation = GlslSimdSymbol::interpolate_noperspective;
+
+	std::vector<int> registers;
+	for (int i = 0; i < var_type.get_registers(); i++)
+		registers.push_back(symbol.first_register + i);
+
+	bool is_input = variable->is_in || (variable->is_varying && type == shadertype_fragment);
+	bool is_output = variable->is_out || (variable->is_varying && type == shadertype_vertex);
+
+	if (var_type.base == GlslSimdSymbol::type_sampler && !variable->is_uniform)
+		throw Exception(string_format("Sampler '%1' must be a uniform", variable->name));
+
+	if (variable->is_uniform)
+	{
+		program->uniforms.push_back(symbol);
+		variables[variable] = Value(var_type, registers, false);
+	}
+	else if (is_input)
+	{
+		program->inputs.push_back(symbol);
+		variables[variable] = Value(var_type, registers, false);
+	}
+	else if (is_output)
+	{
+		program->outputs.push_back(symbol);
+		variables[variable] = Value(var_type, registers, true);
+	}
+	else
+	{
+		Value value(var_type, registers, !variable->is_const);
+		variables[variable] = value;
+		if (variable->initial_value)
+		{
+			begin_statement();
+			Value dest = value;
+			dest.is_lvalue = true;
+			store(dest, load(evaluate(variable->initial_value)));
+			end_statement();
+		}
+	}
+}
+
+GlslSimdCodegen::Value GlslSimdCodegen::declare_builtin(const std::string &name)
+{
+	std::map<std::string, Value>::iterator it = builtins.find(name);
+	if (it != builtins.end())
+		return it->second;
+
+	GlslSimdSymbol symbol;
+	symbol.name = name;
+	Value value;
+
+	if (type == shadertype_vertex && (name == "gl_Position" || name == "gl_PointSize"))
+	{
+		symbol.components = (name == "gl_Position") ? 4 : 1;
+		symbol.first_register = alloc_static(symbol.components);
+		program->outputs.push_back(symbol);
+		value = Value(Type(GlslSimdSymbol::type_float, symbol.components), std::vector<int>(), true);
+	}
+	else if (type == shadertype_fragment && name == "gl_FragCoord")
+	{
+		symbol.components = 4;
+		symbol.interpolation = GlslSimdSymbol::interpolate_noperspective;
+		symbol.first_register = alloc_static(4);
+		program->inputs.push_back(symbol);
+		value = Value(Type(GlslSimdSymbol::type_float, 4), std::vector<int>(), false);
+	}
+	else if (type == shadertype_fragment && (name == "gl_FragColor" || name == "gl_FragData"))
+	{
+		// gl_FragData[0] is an alias for gl_FragColor
+		Value color = builtins["gl_FragColor"];
+		if (color.registers.empty())
+		{
+			symbol.name = "gl_FragColor";
+			symbol.components = 4;
+			symbol.first_register = alloc_static(4);
+			program->outputs.push_back(symbol);
+			color = Value(Type(GlslSimdSymbol::type_float, 4), std::vector<int>(), true);
+			for (int i = 0; i < 4; i++)
+				color.registers.push_back(symbol.first_register + i);
+			builtins["gl_FragColor"] = color;
+		}
+		if (name == "gl_FragColor")
+			return color;
+		value = color;
+		value.type.array_size = 1;
+		builtins[name] = value;
+		return value;
+	}
+	else if (type == shadertype_fragment && name == "gl_FrontFacing")
+	{
+		std::vector<int> registers(1, true_register);
+		value = Value(Type(GlslSimdSymbol::type_bool, 1), registers, false);
+		builtins[name] = value;
+		return value;
+	}
+	else
+	{
+		throw Exception(string_format("Built-in variable '%1' is not supported", name));
+	}
+
+	for (int i = 0; i < symbol.components; i++)
+		value.registers.push_back(symbol.first_register + i);
+	builtins[name] = value;
+	return value;
+}
+
+GlslSimdCodegen::Type GlslSimdCodegen::get_type(GlslAstType *ast_type, bool is_array, GlslAstExpression *array_size)
+{
+	GlslAstBuiltInType *built_in_type = dynamic_cast<GlslAstBuiltInType *>(ast_type);
+	if (built_in_type == 0)
+		throw Exception("Structs are not supported");
+
+	Type result;
+	switch (built_in_type->type)
+	{
+	case GlslToken::keyword_void: result.is_void = true; break;
+	case GlslToken::keyword_float: result = Type(GlslSimdSymbol::type_float, 1); break;
+	case GlslToken::keyword_int:
+	case GlslToken::keyword_uint: result = Type(GlslSimdSymbol::type_int, 1); break;
+	case GlslToken::keyword_bool: result = Type(GlslSimdSymbol::type_bool, 1); break;
+	case GlslToken::keyword_vec2: result = Type(GlslSimdSymbol::type_float, 2); break;
+	case GlslToken::keyword_vec3: result = Type(GlslSimdSymbol::type_float, 3); break;
+	case GlslToken::keyword_vec4: result = Type(GlslSimdSymbol::type_float, 4); break;
+	case GlslToken::keyword_ivec2:
+	case GlslToken::keyword_uvec2: result = Type(GlslSimdSymbol::type_int, 2); break;
+	case GlslToken::keyword_ivec3:
+	case GlslToken::keyword_uvec3: result = Type(GlslSimdSymbol::type_int, 3); break;
+	case GlslToken::keyword_ivec4:
+	case GlslToken::keyword_uvec4: result = Type(GlslSimdSymbol::type_int, 4); break;
+	case GlslToken::keyword_bvec2: result = Type(GlslSimdSymbol::type_bool, 2); break;
+	case GlslToken::keyword_bvec3: result = Type(GlslSimdSymbol::type_bool, 3); break;
+	case GlslToken::keyword_bvec4: result = Type(GlslSimdSymbol::type_bool, 4); break;
+	case GlslToken::keyword_mat2:
+	case GlslToken::keyword_mat2x2: result = Type(GlslSimdSymbol::type_float, 2, 2); break;
+	case GlslToken::keyword_mat3:
+	case GlslToken::keyword_mat3x3: result = Type(GlslSimdSymbol::type_float, 3, 3); break;
+	case GlslToken::keyword_mat4:
+	case GlslToken::keyword_mat4x4: result = Type(GlslSimdSymbol::type_float, 4, 4); break;
+	case GlslToken::keyword_mat2x3: result = Type(GlslSimdSymbol::type_float, 3, 2); break;
+	case GlslToken::keyword_mat2x4: result = Type(GlslSimdSymbol::type_float, 4, 2); break;
+	case GlslToken::keyword_mat3x2: result = Type(GlslSimdSymbol::type_float, 2, 3); break;
+	case GlslToken::keyword_mat3x4: result = Type(GlslSimdSymbol::type_float, 4, 3); break;
+	case GlslToken::keyword_mat4x2: result = Type(GlslSimdSymbol::type_float, 2, 4); break;
+	case GlslToken::keyword_mat4x3: result = Type(GlslSimdSymbol::type_float, 3, 4); break;
+	case GlslToken::keyword_sampler2D: result = Type(GlslSimdSymbol::type_sampler, 1); break;
+	default: throw Exception("Unsupported type");
+	}
+
+	if (is_array)
+	{
+		if (array_size == 0)
+			throw Exception("Unsized arrays are not supported");
+		result.array_size = get_constant_int(array_size);
+		if (result.array_size <= 0)
+			throw Exception("Array size must be greater than zero");
+	}
+	return result;
+}
+
+int GlslSimdCodegen::get_constant_int(GlslAstExpression *expression)
+{
+	GlslAstIntConstant *int_constant = dynamic_cast<GlslAstIntConstant *>(expression);
+	GlslAstUIntConstant *uint_constant = dynamic_cast<GlslAstUIntConstant *>(expression);
+	if (int_constant)
+		return int_constant->value;
+	else if (uint_constant)
+		return (int)uint_constant->value;
+	else
+		throw Exception("Expected an integral constant");
+}
+
+GlslAstFunction *GlslSimdCodegen::find_function(const std::string &name, const std::vector<Value> &arguments)
+{
+	GlslAstFunction *candidate = 0;
+	for (size_t i = 0; i < unit->functions.size(); i++)
+	{
+		GlslAstFunction *function = unit->functions[i];
+		if (function->name != name || function->is_prototype || function->parameters.size() != arguments.size())
+			continue;
+
+		bool exact_match = true;
+		for (size_t j = 0; j < arguments.size(); j++)
+		{
+			Type param_type = get_type(function->parameters[j]->type, function->parameters[j]->is_array, function->parameters[j]->array_size);
+			if (param_type.get_registers() != arguments[j].type.get_registers())
+			{
+				function = 0;
+				break;
+			}
+			exact_match = exact_match && (param_type == arguments[j].type);
+		}
+
+		if (function && exact_match)
+			return function;
+		else if (function && candidate == 0)
+			candidate = function;
+	}
+	return candidate;
+}
+
+GlslSimdCodegen::Value GlslSimdCodegen::inline_function(GlslAstFunction *function, const std::vector<Value> &arguments)
+{
+	if (active_functions.find(function) != active_functions.end())
+		throw Exception(string_format("Recursive call to '%1'", function->name));
+
+	bool masked = is_masked();
+
+	FunctionContext context;
+	context.function = function;
+	context.masked_at_entry = masked;
+	context.entry_mask = alloc_static(1);
+	context.return_mask = alloc_static(1);
+	emit(glsl_op_mov, context.entry_mask, program->mask_register);
+	emit(glsl_op_mov, context.return_mask, zero_register);
+
+	Type return_type = get_type(function->return_type);
+	if (!return_type.is_void)
+		context.return_value = Value(return_type, alloc_statics(return_type.get_registers()), true);
+
+	std::vector<Value> parameters;
+	for (size_t i = 0; i < function->parameters.size(); i++)
+	{
+		GlslAstFunctionParameter *parameter = function->parameters[i];
+		Type param_type = get_type(parameter->type, parameter->is_array, parameter->array_size);
+		Value param_value(param_type, alloc_statics(param_type.get_registers()), true);
+		if (parameter->is_in || !parameter->is_out)
+		{
+			std::vector<int> source = load(arguments[i]);
+			for (size_t j = 0; j < source.size(); j++)
+				emit(glsl_op_mov, param_value.registers[j], source[j]);
+		}
+		variables[parameter] = param_value;
+		parameters.push_back(param_value);
+	}
+
+	active_functions.insert(function);
+	functions.push_back(context);
+	for (size_t i = 0; i < function->statements.size(); i++)
+		generate_statement(function->statements[i]);
+	context = functions.back();
+	functions.pop_back();
+	active_functions.erase(function);
+
+	patch_jumps(context.end_jumps, program->instructions.size());
+	if (context.has_return_exit)
+		emit(glsl_op_and, program->mask_register, context.entry_mask, program->alive_register);
+
+	for (size_t i = 0; i < function->parameters.size(); i++)
+	{
+		if (function->parameters[i]->is_out)
+		{
+			if (!arguments[i].is_lvalue)
+				throw Exception(string_format("Argument %1 to '%2' must be an lvalue", (int)i + 1, function->name));
+			store(arguments[i], parameters[i].registers);
+		}
+	}
+
+	Value return_value = context.return_value;
+	return_value.is_lvalue = false;
+	return return_value;
+}
+
+GlslSimdCodegen::Value GlslSimdCodegen::evaluate(GlslAstExpression *expression)
+{
+	result = Value();
+	expression->codegen(this);
+	return result;
+}
+
+std::vector<int> GlslSimdCodegen::load(const Value &value)
+{
+	if (value.alternatives.empty())
+		return value.registers;
+
+	std::vector<int> dest = alloc_temps(value.alternatives[0].registers.size());
+	for (size_t j = 0; j < dest.size(); j++)
+		emit(glsl_op_mov, dest[j], value.alternatives[0].registers[j]);
+	for (size_t i = 1; i < value.alternatives.size(); i++)
+	{
+		for (size_t j = 0; j < dest.size(); j++)
+			emit(glsl_op_select, dest[j], value.alternatives[i].registers[j], dest[j], value.alternatives[i].condition);
+	}
+	return dest;
+}
+
+void GlslSimdCodegen::store(const Value &dest, const std::vector<int> &input_source)
+{
+	if (!dest.is_lvalue)
+		throw Exception("Assignment to a read-only value");
+
+	std::vector<int> source = input_source;
+	if (source.size() != (size_t)dest.type.get_registers())
+		throw Exception("Type mismatch in assignment");
+
+	bool masked = is_masked();
+
+	if (!dest.alternatives.empty())
+	{
+		for (size_t i = 0; i < dest.alternatives.size(); i++)
+		{
+			int condition = dest.alternatives[i].condition;
+			if (masked)
+			{
+				condition = alloc_temp();
+				emit(glsl_op_and, condition, dest.alternatives[i].condition, program->mask_register);
+			}
+			for (size_t j = 0; j < source.size(); j++)
+				emit(glsl_op_store_masked, dest.alternatives[i].registers[j], source[j], condition);
+		}
+		return;
+	}
+
+	// Copy through temporaries if a source register is overwritten before it is read
+	bool alias = false;
+	for (size_t j = 0; j < source.size() && !alias; j++)
+	{
+		for (size_t k = 0; k < j; k++)
+		{
+			if (source[j] == dest.registers[k])
+				alias = true;
+		}
+	}
+	if (alias)
+	{
+		std::vector<int> copy = alloc_temps(source.size());
+		for (size_t j = 0; j < source.size(); j++)
+			emit(glsl_op_mov, copy[j], source[j]);
+		source = copy;
+	}
+
+	for (size_t j = 0; j < source.size(); j++)
+	{
+		if (masked)
+			emit(glsl_op_store_masked, dest.registers[j], source[j], program->mask_register);
+		else if (dest.registers[j] != source[j])
+			emit(glsl_op_mov, dest.registers[j], source[j]);
+	}
+}
+
+GlslSimdCodegen::Value GlslSimdCodegen::select_element(const Value &value, int index)
+{
+	Value element = value;
+	int stride = 1;
+	if (value.type.array_size > 0)
+	{
+		element.type.array_size = 0;
+		stride = element.type.get_registers();
+	}
+	else if (value.type.columns > 1)
+	{
+		element.type.columns = 1;
+		stride = element.type.components;
+	}
+	else if (value.type.components > 1)
+	{
+		element.type.components = 1;
+	}
+	else
+	{
+		throw Exception("Subscripted value is not an array, matrix or vector");
+	}
+
+	int count = value.type.get_registers() / stride;
+	if (index < 0 || index >= count)
+		throw Exception("Array index out of range");
+
+	if (value.alternatives.empty())
+	{
+		element.registers = std::vector<int>(value.registers.begin() + index * stride, value.registers.begin() + (index + 1) * stride);
+	}
+	else
+	{
+		for (size_t i = 0; i < element.alternatives.size(); i++)
+		{
+			const std::vector<int> &registers = value.alternatives[i].registers;
+			element.alternatives[i].registers = std::vector<int>(registers.begin() + index * stride, registers.begin() + (index + 1) * stride);
+		}
+	}
+	return element;
+}
+
+GlslSimdCodegen::Value GlslSimdCodegen::select_element(const Value &value, const std::vector<int> &index)
+{
+	if (!value.alternatives.empty())
+		throw Exception("Nested dynamic indexing is not supported");
+
+	// Every element becomes a candidate, chosen per lane by comparing the index
+	Value element = select_element(value, 0);
+	element.registers.clear();
+	int count = value.type.array_size > 0 ? value.type.array_size : (value.type.columns > 1 ? value.type.columns : value.type.components);
+	for (int i = 0; i < count; i++)
+	{
+		Alternative alternative;
+		alternative.condition = alloc_temp();
+		alternative.registers = select_element(value, i).registers;
+		emit(glsl_op_cmp_eq, alternative.condition, index[0], constant((float)i));
+		element.alternatives.push_back(alternative);
+	}
+	return element;
+}
+
+GlslSimdCodegen::Value GlslSimdCodegen::convert(const Value &value, GlslSimdSymbol::BaseType base)
+{
+	if (value.type.base == base || (value.type.base != GlslSimdSymbol::type_bool && base != GlslSimdSymbol::type_bool && base != GlslSimdSymbol::type_int))
+	{
+		Value converted = value;
+		converted.type.base = base;
+		return converted;
+	}
+
+	std::vector<int> source = load(value);
+	Value converted(value.type, alloc_temps(source.size()));
+	converted.type.base = base;
+	for (size_t i = 0; i < source.size(); i++)
+	{
+		if (base == GlslSimdSymbol::type_bool)
+			emit(glsl_op_f2b, converted.registers[i], source[i]);
+		else if (value.type.base == GlslSimdSymbol::type_bool)
+			emit(glsl_op_b2f, converted.registers[i], source[i]);
+		else
+			emit(glsl_op_trunc, converted.registers[i], source[i]);
+	}
+	return converted;
+}
+
+GlslSimdCodegen::Value GlslSimdCodegen::arithmetic(GlslSimdOpcode opcode, const Value &a, const Value &b)
+{
+	if (a.type.array_size > 0 || b.type.array_size > 0)
+		throw Exception("Arithmetic on arrays is not allowed");
+	if (a.type.base == GlslSimdSymbol::type_bool || b.type.base == GlslSimdSymbol::type_bool || a.type.base == GlslSimdSymbol::type_sampler || b.type.base == GlslSimdSymbol::type_sampler)
+		throw Exception("Arithmetic operands must be numeric");
+
+	if (opcode == glsl_op_mul && (a.type.is_matrix() || b.type.is_matrix()) && !a.type.is_scalar() && !b.type.is_scalar())
+		return matrix_multiply(a, b);
+
+	std::vector<Value> arguments;
+	arguments.push_back(a);
+	arguments.push_back(b);
+	bool is_int = (a.type.base == GlslSimdSymbol::type_int && b.type.base == GlslSimdSymbol::type_int);
+	Value value = componentwise(opcode, arguments, is_int ? GlslSimdSymbol::type_int : GlslSimdSymbol::type_float);
+	if (is_int && opcode == glsl_op_div)
+	{
+		for (size_t i = 0; i < value.registers.size(); i++)
+			emit(glsl_op_trunc, value.registers[i], value.registers[i]);
+	}
+	return value;
+}
+
+GlslSimdCodegen::Value GlslSimdCodegen::matrix_multiply(const Value &a, const Value &b)
+{
+	std::vector<int> ra = load(a);
+	std::vector<int> rb = load(b);
+	int a_rows = a.type.components;
+	int a_columns = a.type.columns;
+	int b_rows = b.type.components;
+	int b_columns = b.type.columns;
+
+	if (!b.type.is_matrix())
+	{
+		// mat * vec
+		if (b_rows != a_columns)
+			throw Exception("Matrix and vector sizes do not match");
+		Value value(Type(GlslSimdSymbol::type_float, a_rows), alloc_temps(a_rows));
+		for (int row = 0; row < a_rows; row++)
+		{
+			emit(glsl_op_mul, value.registers[row], ra[row], rb[0]);
+			for (int col = 1; col < a_columns; col++)
+				emit(glsl_op_mad, value.registers[row], ra[col * a_rows + row], rb[col], value.registers[row]);
+		}
+		return value;
+	}
+	else if (!a.type.is_matrix())
+	{
+		// vec * mat
+		if (a_rows != b_rows)
+			throw Exception("Matrix and vector sizes do not match");
+		Value value(Type(GlslSimdSymbol::type_float, b_columns), alloc_temps(b_columns));
+		for (int col = 0; col < b_columns; col++)
+		{
+			emit(glsl_op_mul, value.registers[col], ra[0], rb[col * b_rows]);
+			for (int row = 1; row < b_rows; row++)
+				emit(glsl_op_mad, value.registers[col], ra[row], rb[col * b_rows + row], value.registers[col]);
+		}
+		return value;
+	}
+	else
+	{
+		// mat * mat
+		if (a_columns != b_rows)
+			throw Exception("Matrix sizes do not match");
+		Value value(Type(GlslSimdSymbol::type_float, a_rows, b_columns), alloc_temps(a_rows * b_columns));
+		for (int col = 0; col < b_columns; col++)
+		{
+			for (int row = 0; row < a_rows; row++)
+			{
+				int dest = value.registers[col * a_rows + row];
+				emit(glsl_op_mul, dest, ra[row], rb[col * b_rows]);
+				for (int k = 1; k < a_columns; k++)
+					emit(glsl_op_mad, dest, ra[k * a_rows + row], rb[col * b_rows + k], dest);
+			}
+		}
+		return value;
+	}
+}
+
+GlslSimdCodegen::Value GlslSimdCodegen::compare(GlslSimdOpcode opcode, const Value &a, const Value &b)
+{
+	std::vector<Value> arguments;
+	arguments.push_back(a);
+	arguments.push_back(b);
+	return componentwise(opcode, arguments, GlslSimdSymbol::type_bool);
+}
+
+GlslSimdCodegen::Value GlslSimdCodegen::compare_all(GlslSimdOpcode opcode, GlslSimdOpcode reduce_opcode, const Value &a, const Value &b)
+{
+	if (a.type.get_registers() != b.type.get_registers())
+		throw Exception("Type mismatch in comparison");
+
+	std::vector<int> ra = load(a);
+	std::vector<int> rb = load(b);
+	Value value(Type(GlslSimdSymbol::type_bool, 1), alloc_temps(1));
+	for (size_t i = 0; i < ra.size(); i++)
+	{
+		// Bools are masks, so compare their bits rather than their float value
+		GlslSimdOpcode op = opcode;
+		if (a.type.base == GlslSimdSymbol::type_bool)
+			op = glsl_op_xor;
+
+		if (i == 0)
+		{
+			emit(op, value.registers[0], ra[i], rb[i]);
+		}
+		else
+		{
+			int t = alloc_temp();
+			emit(op, t, ra[i], rb[i]);
+			emit(reduce_opcode, value.registers[0], value.registers[0], t);
+		}
+	}
+	if (a.type.base == GlslSimdSymbol::type_bool && opcode == glsl_op_cmp_eq)
+		emit(glsl_op_andnot, value.registers[0], value.registers[0], true_register);
+	return value;
+}
+
+GlslSimdCodegen::Value GlslSimdCodegen::componentwise(GlslSimdOpcode opcode, const std::vector<Value> &arguments, GlslSimdSymbol::BaseType result_base)
+{
+	int components = 1;
+	int columns = 1;
+	std::vector<std::vector<int> > sources;
+	for (size_t i = 0; i < arguments.size(); i++)
+	{
+		if (arguments[i].type.array_size > 0)
+			throw Exception("Operation not allowed on arrays");
+		if (!arguments[i].type.is_scalar())
+		{
+			if (components * columns > 1 && (components != arguments[i].type.components || columns != arguments[i].type.columns))
+				throw Exception("Operand sizes do not match");
+			components = arguments[i].type.components;
+			columns = arguments[i].type.columns;
+		}
+		sources.push_back(load(arguments[i]));
+	}
+
+	Value value(Type(result_base, components, columns), alloc_temps(components * columns));
+	for (int i = 0; i < components * columns; i++)
+	{
+		int operands[3] = { 0, 0, 0 };
+		for (size_t j = 0; j < sources.size() && j < 3; j++)
+			operands[j] = sources[j].size() == 1 ? sources[j][0] : sources[j][i];
+		emit(opcode, value.registers[i], operands[0], operands[1], operands[2]);
+	}
+	return value;
+}
+
+GlslSimdCodegen::Value GlslSimdCodegen::dot(const Value &a, const Value &b)
+{
+	if (a.type.components != b.type.components)
+		throw Exception("Operand sizes do not match");
+	std::vector<int> ra = load(a);
+	std::vector<int> rb = load(b);
+	Value value(Type(GlslSimdSymbol::type_float, 1), alloc_temps(1));
+	emit(glsl_op_mul, value.registers[0], ra[0], rb[0]);
+	for (size_t i = 1; i < ra.size(); i++)
+		emit(glsl_op_mad, value.registers[0], ra[i], rb[i], value.registers[0]);
+	return value;
+}
+
+GlslSimdCodegen::Value GlslSimdCodegen::call_builtin(const std::string &name, const std::vector<Value> &args, bool &found)
+{
+	static const struct { const char *name; GlslSimdOpcode opcode; } unary_functions[] =
+	{
+		{ "abs", glsl_op_abs }, { "sign", glsl_op_sign }, { "floor", glsl_op_floor }, { "ceil", glsl_op_ceil },
+		{ "fract", glsl_op_fract }, { "trunc", glsl_op_trunc }, { "sqrt", glsl_op_sqrt }, { "inversesqrt", glsl_op_rsqrt },
+		{ "exp", glsl_op_exp }, { "log", glsl_op_log }, { "exp2", glsl_op_exp2 }, { "log2", glsl_op_log2 },
+		{ "sin", glsl_op_sin }, { "cos", glsl_op_cos }, { "tan", glsl_op_tan }, { "asin", glsl_op_asin }, { "acos", glsl_op_acos }
+	};
+	static const struct { const char *name; GlslSimdOpcode opcode; } binary_functions[] =
+	{
+		{ "min", glsl_op_min }, { "max", glsl_op_max }, { "mod", glsl_op_mod }, { "pow", glsl_op_pow }, { "atan", glsl_op_atan2 }
+	};
+	static const struct { const char *name; GlslSimdOpcode opcode; } compare_functions[] =
+	{
+		{ "lessThan", glsl_op_cmp_lt }, { "lessThanEqual", glsl_op_cmp_le }, { "greaterThan", glsl_op_cmp_gt },
+		{ "greaterThanEqual", glsl_op_cmp_ge }, { "equal", glsl_op_cmp_eq }, { "notEqual", glsl_op_cmp_ne }
+	};
+
+	found = true;
+
+	if (args.size() == 1)
+	{
+		for (size_t i = 0; i < sizeof(unary_functions) / sizeof(unary_functions[0]); i++)
+		{
+			if (name == unary_functions[i].name)
+				return componentwise(unary_functions[i].opcode, args);
+		}
+		if (name == "atan")
+			return componentwise(glsl_op_atan, args);
+	}
+
+	if (args.size() == 2)
+	{
+		for (size_t i = 0; i < sizeof(binary_functions) / sizeof(binary_functions[0]); i++)
+		{
+			if (name == binary_functions[i].name)
+				return componentwise(binary_functions[i].opcode, args);
+		}
+		for (size_t i = 0; i < sizeof(compare_functions) / sizeof(compare_functions[0]); i++)
+		{
+			if (name == compare_functions[i].name)
+				return componentwise(compare_functions[i].opcode, args, GlslSimdSymbol::type_bool);
+		}
+	}
+
+	if (name == "radians" && args.size() == 1)
+	{
+		return arithmetic(glsl_op_mul, args[0], Value(Type(), std::vector<int>(1, constant(3.14159265f / 180.0f))));
+	}
+	else if (name == "degrees" && args.size() == 1)
+	{
+		return arithmetic(glsl_op_mul, args[0], Value(Type(), std::vector<int>(1, constant(180.0f / 3.14159265f))));
+	}
+	else if (name == "clamp" && args.size() == 3)
+	{
+		std::vector<Value> min_args;
+		min_args.push_back(args[0]);
+		min_args.push_back(args[1]);
+		std::vector<Value> max_args;
+		max_args.push_back(componentwise(glsl_op_max, min_args));
+		max_args.push_back(args[2]);
+		return componentwise(glsl_op_min, max_args);
+	}
+	else if (name == "mix" && args.size() == 3)
+	{
+		if (args[2].type.base == GlslSimdSymbol::type_bool)
+		{
+			std::vector<Value> select_args;
+			select_args.push_back(args[1]);
+			select_args.push_back(args[0]);
+			select_args.push_back(args[2]);
+			return componentwise(glsl_op_select, select_args);
+		}
+		Value delta = arithmetic(glsl_op_sub, args[1], args[0]);
+		std::vector<Value> mad_args;
+		mad_args.push_back(delta);
+		mad_args.push_back(args[2]);
+		mad_args.push_back(args[0]);
+		return componentwise(glsl_op_mad, mad_args);
+	}
+	else if (name == "step" && args.size() == 2)
+	{
+		std::vector<Value> cmp_args;
+		cmp_args.push_back(args[1]);
+		cmp_args.push_back(args[0]);
+		return convert(componentwise(glsl_op_cmp_ge, cmp_args, GlslSimdSymbol::type_bool), GlslSimdSymbol::type_float);
+	}
+	else if (name == "smoothstep" && args.size() == 3)
+	{
+		Value t = arithmetic(glsl_op_div, arithmetic(glsl_op_sub, args[2], args[0]), arithmetic(glsl_op_sub, args[1], args[0]));
+		std::vector<Value> clamp_args;
+		clamp_args.push_back(t);
+		clamp_args.push_back(Value(Type(), std::vector<int>(1, zero_register)));
+		clamp_args.push_back(Value(Type(), std::vector<int>(1, one_register)));
+		bool clamp_found;
+		t = call_builtin("clamp", clamp_args, clamp_found);
+		Value three_minus_two_t = arithmetic(glsl_op_sub, Value(Type(), std::vector<int>(1, constant(3.0f))), arithmetic(glsl_op_mul, Value(Type(), std::vector<int>(1, constant(2.0f))), t));
+		return arithmetic(glsl_op_mul, arithmetic(glsl_op_mul, t, t), three_minus_two_t);
+	}
+	else if (name == "dot" && args.size() == 2)
+	{
+		return dot(args[0], args[1]);
+	}
+	else if (name == "length" && args.size() == 1)
+	{
+		std::vector<Value> sqrt_args(1, dot(args[0], args[0]));
+		return componentwise(glsl_op_sqrt, sqrt_args);
+	}
+	else if (name == "distance" && args.size() == 2)
+	{
+		Value delta = arithmetic(glsl_op_sub, args[0], args[1]);
+		std::vector<Value> sqrt_args(1, dot(delta, delta));
+		return componentwise(glsl_op_sqrt, sqrt_args);
+	}
+	else if (name == "normalize" && args.size() == 1)
+	{
+		std::vector<Value> rsqrt_args(1, dot(args[0], args[0]));
+		return arithmetic(glsl_op_mul, args[0], componentwise(glsl_op_rsqrt, rsqrt_args));
+	}
+	else if (name == "cross" && args.size() == 2)
+	{
+		if (args[0].type.components != 3 || args[1].type.components != 3)
+			throw Exception("cross requires vec3 arguments");
+		std::vector<int> a = load(args[0]);
+		std::vector<int> b = load(args[1]);
+		Value value(Type(GlslSimdSymbol::type_float, 3), alloc_temps(3));
+		for (int i = 0; i < 3; i++)
+		{
+			int j = (i + 1) % 3;
+			int k = (i + 2) % 3;
+			int t = alloc_temp();
+			emit(glsl_op_mul, t, a[k], b[j]);
+			emit(glsl_op_mul, value.registers[i], a[j], b[k]);
+			emit(glsl_op_sub, value.registers[i], value.registers[i], t);
+		}
+		return value;
+	}
+	else if (name == "reflect" && args.size() == 2)
+	{
+		Value d = dot(args[1], args[0]);
+		Value scale = arithmetic(glsl_op_mul, Value(Type(), std::vector<int>(1, constant(2.0f))), d);
+		return arithmetic(glsl_op_sub, args[0], arithmetic(glsl_op_mul, scale, args[1]));
+	}
+	else if ((name == "any" || name == "all") && args.size() == 1)
+	{
+		std::vector<int> a = load(args[0]);
+		Value value(Type(GlslSimdSymbol::type_bool, 1), alloc_temps(1));
+		emit(glsl_op_mov, value.registers[0], a[0]);
+		for (size_t i = 1; i < a.size(); i++)
+			emit(name == "any" ? glsl_op_or : glsl_op_and, value.registers[0], value.registers[0], a[i]);
+		return value;
+	}
+	else if (name == "not" && args.size() == 1)
+	{
+		std::vector<Value> not_args;
+		not_args.push_back(args[0]);
+		not_args.push_back(Value(Type(GlslSimdSymbol::type_bool, 1), std::vector<int>(1, true_register)));
+		return componentwise(glsl_op_andnot, not_args, GlslSimdSymbol::type_bool);
+	}
+	else if ((name == "texture2D" || name == "texture" || name == "texture2DLod" || name == "textureLod") && args.size() >= 2)
+	{
+		if (args[0].type.base != GlslSimdSymbol::type_sampler || args[1].type.components < 2)
+			throw Exception(string_format("Invalid arguments to %1", name));
+		std::vector<int> sampler = load(args[0]);
+		std::vector<int> coords = load(args[1]);
+		std::vector<int> dest = alloc_temps(4);
+		emit(glsl_op_tex2d, dest[0], coords[0], coords[1], sampler[0]);
+		return Value(Type(GlslSimdSymbol::type_float, 4), dest);
+	}
+
+	found = false;
+	return Value();
+}
+
+GlslSimdCodegen::Value GlslSimdCodegen::condition_value(GlslAstSimpleStatement *statement)
+{
+	GlslAstExpressionStatement *expression_statement = dynamic_cast<GlslAstExpressionStatement *>(statement);
+	GlslAstDeclarationStatement *declaration_statement = dynamic_cast<GlslAstDeclarationStatement *>(statement);
+	Value value;
+	if (expression_statement)
+	{
+		value = evaluate(expression_statement->expression);
+	}
+	else if (declaration_statement && declaration_statement->variables.size() == 1)
+	{
+		statement->codegen(this);
+		value = variables[declaration_statement->variables[0]];
+	}
+	else
+	{
+		throw Exception("Invalid loop condition");
+	}
+
+	if (value.type.base != GlslSimdSymbol::type_bool || !value.type.is_scalar())
+		throw Exception("Condition must be a boolean expression");
+	return value;
+}
+
+bool GlslSimdCodegen::is_masked() const
+{
+	const FunctionContext &function = functions.back();
+	return function.control_depth > 0 || function.has_return_exit || function.masked_at_entry;
+}
+
+void GlslSimdCodegen::restore_mask(int saved_mask, bool in_loop_body, bool is_loop_exit)
+{
+	FunctionContext &function = functions.back();
+	emit(glsl_op_and, program->mask_register, saved_mask, program->alive_register);
+	if (!function.loops.empty() && !is_loop_exit)
+	{
+		emit(glsl_op_andnot, program->mask_register, function.loops.back().break_mask, program->mask_register);
+		if (in_loop_body)
+			emit(glsl_op_andnot, program->mask_register, function.loops.back().continue_mask, program->mask_register);
+	}
+	if (function.has_return_exit)
+		emit(glsl_op_andnot, program->mask_register, function.return_mask, program->mask_register);
+}
+
+void GlslSimdCodegen::begin_statement()
+{
+	statement_marks.push_back(temp_top);
+}
+
+void GlslSimdCodegen::end_statement()
+{
+	temp_top = statement_marks.back();
+	statement_marks.pop_back();
+}
+
+void GlslSimdCodegen::generate_statement(GlslAstStatement *statement)
+{
+	begin_statement();
+	statement->codegen(this);
+	end_statement();
+}
+
+int GlslSimdCodegen::alloc_static(int count)
+{
+	int reg = num_static;
+	num_static += count;
+	return reg;
+}
+
+std::vector<int> GlslSimdCodegen::alloc_statics(int count)
+{
+	int first = alloc_static(count);
+	std::vector<int> registers;
+	for (int i = 0; i < count; i++)
+		registers.push_back(first + i);
+	return registers;
+}
+
+int GlslSimdCodegen::alloc_temp()
+{
+	return alloc_temps(1)[0];
+}
+
+std::vector<int> GlslSimdCodegen::alloc_temps(int count)
+{
+	std::vector<int> registers;
+	for (int i = 0; i < count; i++)
+		registers.push_back(-1 - (temp_top + i));
+	temp_top += count;
+	max_temp = max(max_temp, temp_top);
+	return registers;
+}
+
+int GlslSimdCodegen::relocate(int reg) const
+{
+	return reg < 0 ? num_static - 1 - reg : reg;
+}
+
+int GlslSimdCodegen::constant(float value)
+{
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(float));
+	return constant_bits(bits);
+}
+
+int GlslSimdCodegen::constant_bits(unsigned int bits)
+{
+	std::map<unsigned int, int>::iterator it = constant_registers.find(bits);
+	if (it != constant_registers.end())
+		return it->second;
+
+	int reg = alloc_static(1);
+	constant_registers[bits] = reg;
+	program->constants.push_back(std::pair<int, unsigned int>(reg, bits));
+	return reg;
+}
+
+int GlslSimdCodegen::emit(GlslSimdOpcode opcode, int dest, int a, int b, int c)
+{
+	program->instructions.push_back(GlslSimdInstruction(opcode, dest, a, b, c));
+	return program->instructions.size() - 1;
+}
+
+void GlslSimdCodegen::patch_jumps(const std::vector<int> &jumps, int target)
+{
+	for (size_t i = 0; i < jumps.size(); i++)
+		program->instructions[jumps[i]].c = target;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GlslSimdCodegen Expressions:
+
+void GlslSimdCodegen::expression(GlslAstIntConstant *node)
+{
+	result = Value(Type(GlslSimdSymbol::type_int, 1), std::vector<int>(1, constant((float)node->value)));
+}
+
+void GlslSimdCodegen::expression(GlslAstUIntConstant *node)
+{
+	result = Value(Type(GlslSimdSymbol::type_int, 1), std::vector<int>(1, constant((float)node->value)));
+}
+
+void GlslSimdCodegen::expression(GlslAstFloatConstant *node)
+{
+	result = Value(Type(GlslSimdSymbol::type_float, 1), std::vector<int>(1, constant(node->value)));
+}
+
+void GlslSimdCodegen::expression(GlslAstDoubleConstant *node)
+{
+	result = Value(Type(GlslSimdSymbol::type_float, 1), std::vector<int>(1, constant((float)node->value)));
+}
+
+void GlslSimdCodegen::expression(GlslAstBoolConstant *node)
+{
+	result = Value(Type(GlslSimdSymbol::type_bool, 1), std::vector<int>(1, node->value ? true_register : zero_register));
+}
+
+void GlslSimdCodegen::expression(GlslAstVariableIdentifer *node)
+{
+	std::map<GlslAstVariable *, Value>::iterator it = variables.find(node->variable);
+	if (it != variables.end())
+		result = it->second;
+	else if (dynamic_cast<GlslAstBuiltInVariable *>(node->variable))
+		result = declare_builtin(node->variable->name);
+	else
+		throw Exception(string_format("Variable '%1' used before its declaration", node->variable->name));
+}
+
+void GlslSimdCodegen::expression(GlslAstFieldSelectorOrSwizzle *node)
+{
+	Value operand = evaluate(node->operand);
+	if (operand.type.array_size > 0 || operand.type.columns > 1)
+		throw Exception(string_format("Invalid field selector '%1'", node->name));
+	if (node->name.empty() || node->name.length() > 4)
+		throw Exception(string_format("Invalid swizzle '%1'", node->name));
+
+	std::vector<int> indices;
+	for (size_t i = 0; i < node->name.length(); i++)
+	{
+		int index = -1;
+		switch (node->name[i])
+		{
+		case 'x': case 'r': case 's': index = 0; break;
+		case 'y': case 'g': case 't': index = 1; break;
+		case 'z': case 'b': case 'p': index = 2; break;
+		case 'w': case 'a': case 'q': index = 3; break;
+		}
+		if (index < 0 || index >= operand.type.components)
+			throw Exception(string_format("Invalid swizzle '%1'", node->name));
+		indices.push_back(index);
+	}
+
+	Value swizzled = operand;
+	swizzled.type.components = indices.size();
+	swizzled.registers.clear();
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		if (operand.alternatives.empty())
+			swizzled.registers.push_back(operand.registers[indices[i]]);
+	}
+	for (size_t j = 0; j < swizzled.alternatives.size(); j++)
+	{
+		swizzled.alternatives[j].registers.clear();
+		for (size_t i = 0; i < indices.size(); i++)
+			swizzled.alternatives[j].registers.push_back(operand.alternatives[j].registers[indices[i]]);
+	}
+	result = swizzled;
+}
+
+void GlslSimdCodegen::expression(GlslAstArraySubscript *node)
+{
+	Value operand = evaluate(node->operand);
+	GlslAstIntConstant *constant_index = dynamic_cast<GlslAstIntConstant *>(node->index);
+	if (constant_index)
+	{
+		result = select_element(operand, constant_index->value);
+	}
+	else
+	{
+		Value index = evaluate(node->index);
+		if (!index.type.is_scalar() || index.type.base != GlslSimdSymbol::type_int)
+			throw Exception("Array index must be an integer");
+		result = select_element(operand, load(index));
+	}
+}
+
+void GlslSimdCodegen::expression(GlslAstFunctionCall *node)
+{
+	std::vector<Value> arguments;
+	for (size_t i = 0; i < node->parameters.size(); i++)
+		arguments.push_back(evaluate(node->parameters[i]));
+
+	GlslAstFunction *function = find_function(node->name, arguments);
+	if (function)
+	{
+		result = inline_function(function, arguments);
+		return;
+	}
+
+	bool found = false;
+	Value value = call_builtin(node->name, arguments, found);
+	if (!found)
+		throw Exception(string_format("No matching function for call to '%1'", node->name));
+	result = value;
+}
+
+void GlslSimdCodegen::expression(GlslAstConstructorCall *node)
+{
+	Type target = get_type(node->type);
+	if (target.is_void || target.base == GlslSimdSymbol::type_sampler)
+		throw Exception("Invalid constructor");
+
+	std::vector<Value> arguments;
+	std::vector<int> components;
+	for (size_t i = 0; i < node->parameters.size(); i++)
+	{
+		arguments.push_back(convert(evaluate(node->parameters[i]), target.base));
+		std::vector<int> registers = load(arguments.back());
+		components.insert(components.end(), registers.begin(), registers.end());
+	}
+	if (components.empty())
+		throw Exception("Constructor requires arguments");
+
+	Value value(target, alloc_temps(target.get_registers()));
+	if (target.is_matrix() && arguments.size() == 1 && arguments[0].type.is_scalar())
+	{
+		for (int col = 0; col < target.columns; col++)
+			for (int row = 0; row < target.components; row++)
+				emit(glsl_op_mov, value.registers[col * target.components + row], row == col ? components[0] : zero_register);
+	}
+	else if (target.is_matrix() && arguments.size() == 1 && arguments[0].type.is_matrix())
+	{
+		const Type &source = arguments[0].type;
+		for (int col = 0; col < target.columns; col++)
+		{
+			for (int row = 0; row < target.components; row++)
+			{
+				int reg = (row == col) ? one_register : zero_register;
+				if (col < source.columns && row < source.components)
+					reg = components[col * source.components + row];
+				emit(glsl_op_mov, value.registers[col * target.components + row], reg);
+			}
+		}
+	}
+	else if (components.size() == 1)
+	{
+		for (int i = 0; i < target.get_registers(); i++)
+			emit(glsl_op_mov, value.registers[i], components[0]);
+	}
+	else
+	{
+		if ((int)components.size() < target.get_registers())
+			throw Exception("Not enough data provided for constructor");
+		for (int i = 0; i < target.get_registers(); i++)
+			emit(glsl_op_mov, value.registers[i], components[i]);
+	}
+	result = value;
+}
+
+void GlslSimdCodegen::expression(GlslAstUnaryPrefixIncrementExpression *node)
+{
+	Value operand = evaluate(node->operand);
+	Value value = arithmetic(glsl_op_add, operand, Value(Type(), std::vector<int>(1, one_register)));
+	value.type = operand.type;
+	store(operand, value.registers);
+	result = value;
+}
+
+void GlslSimdCodegen::expression(GlslAstUnaryPrefixDecrementExpression *node)
+{
+	Value operand = evaluate(node->operand);
+	Value value = arithmetic(glsl_op_sub, operand, Value(Type(), std::vector<int>(1, one_register)));
+	value.type = operand.type;
+	store(operand, value.registers);
+	result = value;
+}
+
+void GlslSimdCodegen::expression(GlslAstUnaryPostfixIncrementExpression *node)
+{
+	Value operand = evaluate(node->operand);
+	std::vector<int> old_value = load(operand);
+	Value copy(operand.type, alloc_temps(old_value.size()));
+	for (size_t i = 0; i < old_value.size(); i++)
+		emit(glsl_op_mov, copy.registers[i], old_value[i]);
+	Value value = arithmetic(glsl_op_add, copy, Value(Type(), std::vector<int>(1, one_register)));
+	store(operand, value.registers);
+	result = copy;
+}
+
+void GlslSimdCodegen::expression(GlslAstUnaryPostfixDecrementExpression *node)
+{
+	Value operand = evaluate(node->operand);
+	std::vector<int> old_value = load(operand);
+	Value copy(operand.type, alloc_temps(old_value.size()));
+	for (size_t i = 0; i < old_value.size(); i++)
+		emit(glsl_op_mov, copy.registers[i], old_value[i]);
+	Value value = arithmetic(glsl_op_sub, copy, Value(Type(), std::vector<int>(1, one_register)));
+	store(operand, value.registers);
+	result = copy;
+}
+
+void GlslSimdCodegen::expression(GlslAstUnaryPlusExpression *node)
+{
+	result = evaluate(node->operand);
+	result.is_lvalue = false;
+}
+
+void GlslSimdCodegen::expression(GlslAstUnaryMinusExpression *node)
+{
+	Value operand = evaluate(node->operand);
+	std::vector<Value> arguments(1, operand);
+	result = componentwise(glsl_op_neg, arguments, operand.type.base);
+	result.type = operand.type;
+}
+
+void GlslSimdCodegen::expression(GlslAstUnaryBitNotExpression *node)
+{
+	throw Exception("Bitwise operators are not supported");
+}
+
+void GlslSimdCodegen::expression(GlslAstUnaryLogicalNotExpression *node)
+{
+	Value operand = evaluate(node->operand);
+	if (operand.type.base != GlslSimdSymbol::type_bool || !operand.type.is_scalar())
+		throw Exception("Operand to ! must be a boolean");
+	std::vector<int> a = load(operand);
+	result = Value(operand.type, alloc_temps(1));
+	emit(glsl_op_andnot, result.registers[0], a[0], true_register);
+}
+
+void GlslSimdCodegen::expression(GlslAstAssignmentExpression *node)
+{
+	Value dest = evaluate(node->operand1);
+	Value source = evaluate(node->operand2);
+
+	switch (node->assignment_type)
+	{
+	case GlslToken::operator_assign: break;
+	case GlslToken::operator_add_assign: source = arithmetic(glsl_op_add, dest, source); break;
+	case GlslToken::operator_sub_assign: source = arithmetic(glsl_op_sub, dest, source); break;
+	case GlslToken::operator_multiply_assign: source = arithmetic(glsl_op_mul, dest, source); break;
+	case GlslToken::operator_divide_assign: source = arithmetic(glsl_op_div, dest, source); break;
+	case GlslToken::operator_modulus_assign: source = arithmetic(glsl_op_mod, dest, source); break;
+	default: throw Exception("Bitwise operators are not supported");
+	}
+
+	if (source.type.base == GlslSimdSymbol::type_bool && dest.type.base != GlslSimdSymbol::type_bool)
+		throw Exception("Cannot assign a boolean to a numeric variable");
+
+	std::vector<int> registers = load(source);
+	store(dest, registers);
+	result = Value(dest.type, registers);
+}
+
+void GlslSimdCodegen::expression(GlslAstPlusExpression *node)
+{
+	Value a = evaluate(node->operand1);
+	result = arithmetic(glsl_op_add, a, evaluate(node->operand2));
+}
+
+void GlslSimdCodegen::expression(GlslAstMinusExpression *node)
+{
+	Value a = evaluate(node->operand1);
+	result = arithmetic(glsl_op_sub, a, evaluate(node->operand2));
+}
+
+void GlslSimdCodegen::expression(GlslAstMultiplyExpression *node)
+{
+	Value a = evaluate(node->operand1);
+	result = arithmetic(glsl_op_mul, a, evaluate(node->operand2));
+}
+
+void GlslSimdCodegen::expression(GlslAstDivideExpression *node)
+{
+	Value a = evaluate(node->operand1);
+	result = arithmetic(glsl_op_div, a, evaluate(node->operand2));
+}
+
+void GlslSimdCodegen::expression(GlslAstModulusExpression *node)
+{
+	Value a = evaluate(node->operand1);
+	result = arithmetic(glsl_op_mod, a, evaluate(node->operand2));
+}
+
+void GlslSimdCodegen::expression(GlslAstShiftLeftExpression *node)
+{
+	throw Exception("Bitwise operators are not supported");
+}
+
+void GlslSimdCodegen::expression(GlslAstShiftRightExpression *node)
+{
+	throw Exception("Bitwise operators are not supported");
+}
+
+void GlslSimdCodegen::expression(GlslAstLessExpression *node)
+{
+	Value a = evaluate(node->operand1);
+	result = compare(glsl_op_cmp_lt, a, evaluate(node->operand2));
+}
+
+void GlslSimdCodegen::expression(GlslAstLessEqualExpression *node)
+{
+	Value a = evaluate(node->operand1);
+	result = compare(glsl_op_cmp_le, a, evaluate(node->operand2));
+}
+
+void GlslSimdCodegen::expression(GlslAstGreaterExpression *node)
+{
+	Value a = evaluate(node->operand1);
+	result = compare(glsl_op_cmp_gt, a, evaluate(node->operand2));
+}
+
+void GlslSimdCodegen::expression(GlslAstGreaterEqualExpression *node)
+{
+	Value a = evaluate(node->operand1);
+	result = compare(glsl_op_cmp_ge, a, evaluate(node->operand2));
+}
+
+void GlslSimdCodegen::expression(GlslAstEqualExpression *node)
+{
+	Value a = evaluate(node->operand1);
+	result = compare_all(glsl_op_cmp_eq, glsl_op_and, a, evaluate(node->operand2));
+}
+
+void GlslSimdCodegen::expression(GlslAstNotEqualExpression *node)
+{
+	Value a = evaluate(node->operand1);
+	result = compare_all(glsl_op_cmp_ne, glsl_op_or, a, evaluate(node->operand2));
+}
+
+void GlslSimdCodegen::expression(GlslAstBitAndExpression *node)
+{
+	throw Exception("Bitwise operators are not supported");
+}
+
+void GlslSimdCodegen::expression(GlslAstBitXorExpression *node)
+{
+	throw Exception("Bitwise operators are not supported");
+}
+
+void GlslSimdCodegen::expression(GlslAstBitOrExpression *node)
+{
+	throw Exception("Bitwise operators are not supported");
+}
+
+void GlslSimdCodegen::expression(GlslAstLogicalAndExpression *node)
+{
+	Value a = evaluate(node->operand1);
+	result = compare(glsl_op_and, a, evaluate(node->operand2));
+}
+
+void GlslSimdCodegen::expression(GlslAstLogicalXorExpression *node)
+{
+	Value a = evaluate(node->operand1);
+	result = compare(glsl_op_xor, a, evaluate(node->operand2));
+}
+
+void GlslSimdCodegen::expression(GlslAstLogicalOrExpression *node)
+{
+	Value a = evaluate(node->operand1);
+	result = compare(glsl_op_or, a, evaluate(node->operand2));
+}
+
+void GlslSimdCodegen::expression(GlslAstSelectExpression *node)
+{
+	Value condition = evaluate(node->operand1);
+	if (condition.type.base != GlslSimdSymbol::type_bool || !condition.type.is_scalar())
+		throw Exception("Condition must be a boolean expression");
+	Value a = evaluate(node->operand2);
+	Value b = evaluate(node->operand3);
+	if (a.type.get_registers() != b.type.get_registers())
+		throw Exception("Type mismatch in ?: expression");
+
+	std::vector<int> c = load(condition);
+	std::vector<int> ra = load(a);
+	std::vector<int> rb = load(b);
+	Value value(a.type, alloc_temps(ra.size()));
+	for (size_t i = 0; i < ra.size(); i++)
+		emit(glsl_op_select, value.registers[i], ra[i], rb[i], c[0]);
+	result = value;
+}
+
+void GlslSimdCodegen::expression(GlslAstSequenceExpression *node)
+{
+	evaluate(node->operand1);
+	result = evaluate(node->operand2);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GlslSimdCodegen Statements:
+
+void GlslSimdCodegen::statement(GlslAstDeclarationStatement *node)
+{
+	for (size_t i = 0; i < node->variables.size(); i++)
+	{
+		GlslAstFunctionVariable *variable = node->variables[i];
+		Type var_type = get_type(variable->type, variable->is_array, variable->array_size);
+		if (var_type.is_void || var_type.base == GlslSimdSymbol::type_sampler)
+			throw Exception(string_format("Invalid type for variable '%1'", variable->name));
+
+		Value value(var_type, alloc_statics(var_type.get_registers()), true);
+		if (variable->initial_value)
+		{
+			Value initial_value = evaluate(variable->initial_value);
+			if (initial_value.type.get_registers() != var_type.get_registers())
+				throw Exception(string_format("Type mismatch in initialization of '%1'", variable->name));
+
+			// The variable is fresh, so all lanes can be written
+			std::vector<int> source = load(initial_value);
+			for (size_t j = 0; j < source.size(); j++)
+				emit(glsl_op_mov, value.registers[j], source[j]);
+		}
+		value.is_lvalue = !variable->is_const;
+		variables[variable] = value;
+	}
+}
+
+void GlslSimdCodegen::statement(GlslAstExpressionStatement *node)
+{
+	evaluate(node->expression);
+}
+
+void GlslSimdCodegen::statement(GlslAstIfStatement *node)
+{
+	Value condition = evaluate(node->condition);
+	if (condition.type.base != GlslSimdSymbol::type_bool || !condition.type.is_scalar())
+		throw Exception("Condition must be a boolean expression");
+	int c = load(condition)[0];
+
+	int saved_mask = alloc_static(1);
+	emit(glsl_op_mov, saved_mask, program->mask_register);
+
+	functions.back().control_depth++;
+
+	emit(glsl_op_and, program->mask_register, saved_mask, c);
+	int skip_then = emit(glsl_op_jmp_if_none, 0, program->mask_register);
+	generate_statement(node->then_statement);
+	program->instructions[skip_then].c = program->instructions.size();
+
+	if (node->else_statement)
+	{
+		// Lanes leaving through break, continue, return or discard in the then branch all had c set
+		emit(glsl_op_andnot, program->mask_register, c, saved_mask);
+		int skip_else = emit(glsl_op_jmp_if_none, 0, program->mask_register);
+		generate_statement(node->else_statement);
+		program->instructions[skip_else].c = program->instructions.size();
+	}
+
+	functions.back().control_depth--;
+	restore_mask(saved_mask, true, false);
+}
+
+void GlslSimdCodegen::statement(GlslAstSwitchStatement *node)
+{
+	throw Exception("switch statements are not supported");
+}
+
+void GlslSimdCodegen::statement(GlslAstCaseLabelStatement *node)
+{
+	throw Exception("case labels are not supported");
+}
+
+void GlslSimdCodegen::statement(GlslAstWhileStatement *node)
+{
+	LoopContext loop;
+	loop.saved_mask = alloc_static(1);
+	loop.break_mask = alloc_static(1);
+	loop.continue_mask = alloc_static(1);
+	emit(glsl_op_mov, loop.saved_mask, program->mask_register);
+	emit(glsl_op_mov, loop.break_mask, zero_register);
+
+	functions.back().control_depth++;
+	functions.back().loops.push_back(loop);
+
+	int loop_top = program->instructions.size();
+	emit(glsl_op_mov, loop.continue_mask, zero_register);
+
+	begin_statement();
+	int c = load(condition_value(node->condition))[0];
+	int t = alloc_temp();
+	emit(glsl_op_andnot, t, c, program->mask_register);
+	emit(glsl_op_or, loop.break_mask, loop.break_mask, t);
+	emit(glsl_op_and, program->mask_register, program->mask_register, c);
+	end_statement();
+	int exit_jump = emit(glsl_op_jmp_if_none, 0, program->mask_register);
+
+	generate_statement(node->body);
+
+	restore_mask(loop.saved_mask, false, false);
+	emit(glsl_op_jmp, 0, 0, 0, loop_top);
+
+	program->instructions[exit_jump].c = program->instructions.size();
+	functions.back().loops.pop_back();
+	functions.back().control_depth--;
+	restore_mask(loop.saved_mask, false, true);
+}
+
+void GlslSimdCodegen::statement(GlslAstDoStatement *node)
+{
+	LoopContext loop;
+	loop.saved_mask = alloc_static(1);
+	loop.break_mask = alloc_static(1);
+	loop.continue_mask = alloc_static(1);
+	emit(glsl_op_mov, loop.saved_mask, program->mask_register);
+	emit(glsl_op_mov, loop.break_mask, zero_register);
+
+	functions.back().control_depth++;
+	functions.back().loops.push_back(loop);
+
+	int loop_top = program->instructions.size();
+	emit(glsl_op_mov, loop.continue_mask, zero_register);
+
+	generate_statement(node->body);
+
+	restore_mask(loop.saved_mask, false, false);
+
+	begin_statement();
+	Value condition = evaluate(node->condition);
+	if (condition.type.base != GlslSimdSymbol::type_bool || !condition.type.is_scalar())
+		throw Exception("Condition must be a boolean expression");
+	int c = load(condition)[0];
+	int t = alloc_temp();
+	emit(glsl_op_andnot, t, c, program->mask_register);
+	emit(glsl_op_or, loop.break_mask, loop.break_mask, t);
+	emit(glsl_op_and, program->mask_register, program->mask_register, c);
+	end_statement();
+	emit(glsl_op_jmp_if_any, 0, program->mask_register, 0, loop_top);
+
+	functions.back().loops.pop_back();
+	functions.back().control_depth--;
+	restore_mask(loop.saved_mask, false, true);
+}
+
+void GlslSimdCodegen::statement(GlslAstForStatement *node)
+{
+	if (node->init)
+		generate_statement(node->init);
+
+	LoopContext loop;
+	loop.saved_mask = alloc_static(1);
+	loop.break_mask = alloc_static(1);
+	loop.continue_mask = alloc_static(1);
+	emit(glsl_op_mov, loop.saved_mask, program->mask_register);
+	emit(glsl_op_mov, loop.break_mask, zero_register);
+
+	functions.back().control_depth++;
+	functions.back().loops.push_back(loop);
+
+	int loop_top = program->instructions.size();
+	emit(glsl_op_mov, loop.continue_mask, zero_register);
+
+	int exit_jump = -1;
+	if (node->condition)
+	{
+		begin_statement();
+		Value condition = evaluate(node->condition);
+		if (condition.type.base != GlslSimdSymbol::type_bool || !condition.type.is_scalar())
+			throw Exception("Condition must be a boolean expression");
+		int c = load(condition)[0];
+		int t = alloc_temp();
+		emit(glsl_op_andnot, t, c, program->mask_register);
+		emit(glsl_op_or, loop.break_mask, loop.break_mask, t);
+		emit(glsl_op_and, program->mask_register, program->mask_register, c);
+		end_statement();
+	}
+	exit_jump = emit(glsl_op_jmp_if_none, 0, program->mask_register);
+
+	generate_statement(node->body);
+
+	restore_mask(loop.saved_mask, false, false);
+	if (node->loop)
+	{
+		begin_statement();
+		evaluate(node->loop);
+		end_statement();
+	}
+	emit(glsl_op_jmp, 0, 0, 0, loop_top);
+
+	program->instructions[exit_jump].c = program->instructions.size();
+	functions.back().loops.pop_back();
+	functions.back().control_depth--;
+	restore_mask(loop.saved_mask, false, true);
+}
+
+void GlslSimdCodegen::statement(GlslAstContinueStatement *node)
+{
+	if (functions.back().loops.empty())
+		throw Exception("continue statement not within a loop");
+	int continue_mask = functions.back().loops.back().continue_mask;
+	emit(glsl_op_or, continue_mask, continue_mask, program->mask_register);
+	emit(glsl_op_mov, program->mask_register, zero_register);
+}
+
+void GlslSimdCodegen::statement(GlslAstBreakStatement *node)
+{
+	if (functions.back().loops.empty())
+		throw Exception("break statement not within a loop");
+	int break_mask = functions.back().loops.back().break_mask;
+	emit(glsl_op_or, break_mask, break_mask, program->mask_register);
+	emit(glsl_op_mov, program->mask_register, zero_register);
+}
+
+void GlslSimdCodegen::statement(GlslAstReturnStatement *node)
+{
+	FunctionContext &function = functions.back();
+	if (node->expression)
+	{
+		if (function.return_value.registers.empty())
+			throw Exception(string_format("Function '%1' does not return a value", function.function->name));
+		Value value = evaluate(node->expression);
+		store(functions.back().return_value, load(value));
+	}
+	else if (!functions.back().return_value.registers.empty())
+	{
+		throw Exception(string_format("Function '%1' must return a value", functions.back().function->name));
+	}
+
+	if (functions.back().control_depth == 0)
+	{
+		functions.back().end_jumps.push_back(emit(glsl_op_jmp, 0));
+	}
+	else
+	{
+		int return_mask = functions.back().return_mask;
+		emit(glsl_op_or, return_mask, return_mask, program->mask_register);
+		emit(glsl_op_mov, program->mask_register, zero_register);
+		functions.back().has_return_exit = true;
+	}
+}
+
+void GlslSimdCodegen::statement(GlslAstDiscardStatement *node)
+{
+	if (type != shadertype_fragment)
+		throw Exception("discard is only allowed in fragment shaders");
+	emit(glsl_op_andnot, program->alive_register, program->mask_register, program->alive_register);
+	emit(glsl_op_mov, program->mask_register, zero_register);
+	program_end_jumps.push_back(emit(glsl_op_jmp_if_none, 0, program->alive_register));
+}
+
+}
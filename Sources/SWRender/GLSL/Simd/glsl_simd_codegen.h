@@ -0,0 +1,224 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "glsl_simd_program.h"
+#include "../AST/glsl_ast.h"
+#include <map>
+#include <set>
+
+namespace clan
+{
+
+/// \brief Generates a GlslSimdProgram from a parsed translation unit
+///
+/// All user functions are inlined into main. Control flow is executed with an execution mask,
+/// so divergent lanes run both sides of a branch with stores disabled for the inactive lanes.
+class GlslSimdCodegen : private GlslExpressionVisitor, private GlslStatementVisitor
+{
+public:
+	GlslSimdCodegen(ShaderType type);
+
+	std::shared_ptr<GlslSimdProgram> generate(GlslAstTranslationUnit *unit);
+
+private:
+	struct Type
+	{
+		Type() : base(GlslSimdSymbol::type_float), components(1), columns(1), array_size(0), is_void(false) { }
+		Type(GlslSimdSymbol::BaseType base, int components, int columns = 1) : base(base), components(components), columns(columns), array_size(0), is_void(false) { }
+
+		int get_element_registers() const { return components * columns; }
+		int get_registers() const { return get_element_registers() * (array_size > 0 ? array_size : 1); }
+		bool is_scalar() const { return components == 1 && columns == 1 && array_size == 0; }
+		bool is_matrix() const { return columns > 1 && array_size == 0; }
+		bool operator==(const Type &other) const { return base == other.base && components == other.components && columns == other.columns && array_size == other.array_size && is_void == other.is_void; }
+
+		GlslSimdSymbol::BaseType base;
+		int components;
+		int columns;
+		int array_size;
+		bool is_void;
+	};
+
+	// Candidate location of a dynamically indexed lvalue, used by the lanes where condition is set
+	struct Alternative
+	{
+		Alternative() : condition(0) { }
+		int condition;
+		std::vector<int> registers;
+	};
+
+	struct Value
+	{
+		Value() : is_lvalue(false) { }
+		Value(const Type &type, const std::vector<int> &registers, bool is_lvalue = false) : type(type), registers(registers), is_lvalue(is_lvalue) { }
+
+		Type type;
+		std::vector<int> registers;
+		std::vector<Alternative> alternatives;
+		bool is_lvalue;
+	};
+
+	struct LoopContext
+	{
+		LoopContext() : saved_mask(0), break_mask(0), continue_mask(0) { }
+		int saved_mask;
+		int break_mask;
+		int continue_mask;
+	};
+
+	struct FunctionContext
+	{
+		FunctionContext() : function(0), entry_mask(0), return_mask(0), has_return_exit(false), masked_at_entry(false), control_depth(0) { }
+		GlslAstFunction *function;
+		Value return_value;
+		int entry_mask;
+		int return_mask;
+		bool has_return_exit;
+		bool masked_at_entry;
+		int control_depth;
+		std::vector<int> end_jumps;
+		std::vector<LoopContext> loops;
+	};
+
+	void declare_global(GlslAstGlobalVariable *variable);
+	Value declare_builtin(const std::string &name);
+	Type get_type(GlslAstType *type, bool is_array = false, GlslAstExpression *array_size = 0);
+	int get_constant_int(GlslAstExpression *expression);
+	Value inline_function(GlslAstFunction *function, const std::vector<Value> &arguments);
+	GlslAstFunction *find_function(const std::string &name, const std::vector<Value> &arguments);
+
+	Value evaluate(GlslAstExpression *expression);
+	std::vector<int> load(const Value &value);
+	void store(const Value &dest, const std::vector<int> &source);
+	Value select_element(const Value &value, int index);
+	Value select_element(const Value &value, const std::vector<int> &index);
+	Value convert(const Value &value, GlslSimdSymbol::BaseType base);
+	Value arithmetic(GlslSimdOpcode opcode, const Value &a, const Value &b);
+	Value matrix_multiply(const Value &a, const Value &b);
+	Value compare(GlslSimdOpcode opcode, const Value &a, const Value &b);
+	Value compare_all(GlslSimdOpcode opcode, GlslSimdOpcode reduce_opcode, const Value &a, const Value &b);
+	Value componentwise(GlslSimdOpcode opcode, const std::vector<Value> &arguments, GlslSimdSymbol::BaseType result_base = GlslSimdSymbol::type_float);
+	Value dot(const Value &a, const Value &b);
+	Value call_builtin(const std::string &name, const std::vector<Value> &arguments, bool &found);
+	Value condition_value(GlslAstSimpleStatement *statement);
+
+	bool is_masked() const;
+	void restore_mask(int saved_mask, bool in_loop_body, bool is_loop_exit);
+	void begin_statement();
+	void end_statement();
+
+	int alloc_static(int count);
+	int alloc_temp();
+	std::vector<int> alloc_temps(int count);
+	std::vector<int> alloc_statics(int count);
+	int constant(float value);
+	int constant_bits(unsigned int bits);
+	int emit(GlslSimdOpcode opcode, int dest, int a = 0, int b = 0, int c = 0);
+	void patch_jumps(const std::vector<int> &jumps, int target);
+	int relocate(int reg) const;
+
+	void expression(GlslAstIntConstant *node);
+	void expression(GlslAstUIntConstant *node);
+	void expression(GlslAstFloatConstant *node);
+	void expression(GlslAstDoubleConstant *node);
+	void expression(GlslAstBoolConstant *node);
+	void expression(GlslAstVariableIdentifer *node);
+	void expression(GlslAstFieldSelectorOrSwizzle *node);
+	void expression(GlslAstArraySubscript *node);
+	void expression(GlslAstFunctionCall *node);
+	void expression(GlslAstConstructorCall *node);
+	void expression(GlslAstUnaryPrefixIncrementExpression *node);
+	void expression(GlslAstUnaryPrefixDecrementExpression *node);
+	void expression(GlslAstUnaryPostfixIncrementExpression *node);
+	void expression(GlslAstUnaryPostfixDecrementExpression *node);
+	void expression(GlslAstUnaryPlusExpression *node);
+	void expression(GlslAstUnaryMinusExpression *node);
+	void expression(GlslAstUnaryBitNotExpression *node);
+	void expression(GlslAstUnaryLogicalNotExpression *node);
+	void expression(GlslAstAssignmentExpression *node);
+	void expression(GlslAstPlusExpression *node);
+	void expression(GlslAstMinusExpression *node);
+	void expression(GlslAstMultiplyExpression *node);
+	void expression(GlslAstDivideExpression *node);
+	void expression(GlslAstModulusExpression *node);
+	void expression(GlslAstShiftLeftExpression *node);
+	void expression(GlslAstShiftRightExpression *node);
+	void expression(GlslAstLessExpression *node);
+	void expression(GlslAstLessEqualExpression *node);
+	void expression(GlslAstGreaterExpression *node);
+	void expression(GlslAstGreaterEqualExpression *node);
+	void expression(GlslAstEqualExpression *node);
+	void expression(GlslAstNotEqualExpression *node);
+	void expression(GlslAstBitAndExpression *node);
+	void expression(GlslAstBitXorExpression *node);
+	void expression(GlslAstBitOrExpression *node);
+	void expression(GlslAstLogicalAndExpression *node);
+	void expression(GlslAstLogicalXorExpression *node);
+	void expression(GlslAstLogicalOrExpression *node);
+	void expression(GlslAstSelectExpression *node);
+	void expression(GlslAstSequenceExpression *node);
+
+	void statement(GlslAstDeclarationStatement *node);
+	void statement(GlslAstExpressionStatement *node);
+	void statement(GlslAstIfStatement *node);
+	void statement(GlslAstSwitchStatement *node);
+	void statement(GlslAstCaseLabelStatement *node);
+	void statement(GlslAstWhileStatement *node);
+	void statement(GlslAstDoStatement *node);
+	void statement(GlslAstForStatement *node);
+	void statement(GlslAstContinueStatement *node);
+	void statement(GlslAstBreakStatement *node);
+	void statement(GlslAstReturnStatement *node);
+	void statement(GlslAstDiscardStatement *node);
+
+	void generate_statement(GlslAstStatement *statement);
+
+	ShaderType type;
+	std::shared_ptr<GlslSimdProgram> program;
+	GlslAstTranslationUnit *unit;
+
+	int num_static;
+	int temp_top;
+	int max_temp;
+	std::vector<int> statement_marks;
+	std::map<unsigned int, int> constant_registers;
+	int zero_register;
+	int one_register;
+	int true_register;
+
+	Value result;
+	std::map<GlslAstVariable *, Value> variables;
+	std::map<std::string, Value> builtins;
+	std::vector<FunctionContext> functions;
+	std::set<GlslAstFunction *> active_functions;
+	std::vector<int> program_end_jumps;
+};
+
+}
@@ -0,0 +1,351 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "SWRender/precomp.h"
+#include "glsl_simd_program.h"
+#include "API/SWRender/pixel_buffer_data.h"
+#include "API/Core/IOData/iodevice.h"
+#include <cmath>
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// GlslSimdProgram Construction:
+
+GlslSimdProgram::GlslSimdProgram()
+: type(shadertype_vertex), num_registers(0), num_static_registers(0), mask_register(0), alive_register(0)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GlslSimdProgram Attributes:
+
+static const GlslSimdSymbol *find_symbol(const std::vector<GlslSimdSymbol> &symbols, const std::string &name)
+{
+	for (size_t i = 0; i < symbols.size(); i++)
+	{
+		if (symbols[i].name == name)
+			return &symbols[i];
+	}
+	return 0;
+}
+
+const GlslSimdSymbol *GlslSimdProgram::find_input(const std::string &name) const
+{
+	return find_symbol(inputs, name);
+}
+
+const GlslSimdSymbol *GlslSimdProgram::find_output(const std::string &name) const
+{
+	return find_symbol(outputs, name);
+}
+
+const GlslSimdSymbol *GlslSimdProgram::find_uniform(const std::string &name) const
+{
+	return find_symbol(uniforms, name);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GlslSimdProgram Operations:
+
+void GlslSimdProgram::init_registers(GlslSimdRegisters &registers) const
+{
+	if (registers.get_count() != num_registers)
+		registers.resize(num_registers);
+
+	for (size_t i = 0; i < constants.size(); i++)
+	{
+		float value;
+		memcpy(&value, &constants[i].second, sizeof(float));
+		registers.set(constants[i].first, value);
+	}
+}
+
+#define GLSL_SIMD_LOOP(expr) \
+	for (int i = 0; i < GlslSimdRegisters::lanes; i += 4) \
+	{ \
+		__m128 a = _mm_load_ps(ra + i); \
+		__m128 b = _mm_load_ps(rb + i); \
+		__m128 c = _mm_load_ps(rc + i); \
+		(void)b; (void)c; \
+		_mm_store_ps(rd + i, (expr)); \
+	}
+
+#define GLSL_SIMD_SCALAR_LOOP(expr) \
+	for (int i = 0; i < GlslSimdRegisters::lanes; i++) \
+	{ \
+		float a = ra[i]; \
+		float b = rb[i]; \
+		(void)b; \
+		rd[i] = (expr); \
+	}
+
+static inline __m128 glsl_simd_floor(__m128 a)
+{
+	__m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+	return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a), _mm_set1_ps(1.0f)));
+}
+
+static inline __m128 glsl_simd_ceil(__m128 a)
+{
+	__m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+	return _mm_add_ps(t, _mm_and_ps(_mm_cmplt_ps(t, a), _mm_set1_ps(1.0f)));
+}
+
+void GlslSimdProgram::run(GlslSimdRegisters &registers, const PixelBufferData *samplers, int num_samplers) const
+{
+	float *regs = registers.get(0);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+
+	const GlslSimdInstruction *code = instructions.empty() ? 0 : &instructions[0];
+	int num_instructions = instructions.size();
+	int pc = 0;
+	while (pc < num_instructions)
+	{
+		const GlslSimdInstruction &inst = code[pc++];
+		float *rd = regs + inst.dest * GlslSimdRegisters::lanes;
+		const float *ra = regs + inst.a * GlslSimdRegisters::lanes;
+		const float *rb = regs + inst.b * GlslSimdRegisters::lanes;
+		const float *rc = regs + inst.c * GlslSimdRegisters::lanes;
+
+		switch (inst.opcode)
+		{
+		case glsl_op_mov: GLSL_SIMD_LOOP(a); break;
+		case glsl_op_add: GLSL_SIMD_LOOP(_mm_add_ps(a, b)); break;
+		case glsl_op_sub: GLSL_SIMD_LOOP(_mm_sub_ps(a, b)); break;
+		case glsl_op_mul: GLSL_SIMD_LOOP(_mm_mul_ps(a, b)); break;
+		case glsl_op_div: GLSL_SIMD_LOOP(_mm_div_ps(a, b)); break;
+		case glsl_op_mad: GLSL_SIMD_LOOP(_mm_add_ps(_mm_mul_ps(a, b), c)); break;
+		case glsl_op_neg: GLSL_SIMD_LOOP(_mm_xor_ps(a, sign_mask)); break;
+		case glsl_op_min: GLSL_SIMD_LOOP(_mm_min_ps(a, b)); break;
+		case glsl_op_max: GLSL_SIMD_LOOP(_mm_max_ps(a, b)); break;
+		case glsl_op_abs: GLSL_SIMD_LOOP(_mm_andnot_ps(sign_mask, a)); break;
+		case glsl_op_sign: GLSL_SIMD_LOOP(_mm_sub_ps(_mm_and_ps(_mm_cmpgt_ps(a, zero), one), _mm_and_ps(_mm_cmplt_ps(a, zero), one))); break;
+		case glsl_op_floor: GLSL_SIMD_LOOP(glsl_simd_floor(a)); break;
+		case glsl_op_ceil: GLSL_SIMD_LOOP(glsl_simd_ceil(a)); break;
+		case glsl_op_fract: GLSL_SIMD_LOOP(_mm_sub_ps(a, glsl_simd_floor(a))); break;
+		case glsl_op_trunc: GLSL_SIMD_LOOP(_mm_cvtepi32_ps(_mm_cvttps_epi32(a))); break;
+		case glsl_op_mod: GLSL_SIMD_LOOP(_mm_sub_ps(a, _mm_mul_ps(b, glsl_simd_floor(_mm_div_ps(a, b))))); break;
+		case glsl_op_sqrt: GLSL_SIMD_LOOP(_mm_sqrt_ps(a)); break;
+		case glsl_op_rsqrt: GLSL_SIMD_LOOP(_mm_div_ps(one, _mm_sqrt_ps(a))); break;
+		case glsl_op_exp: GLSL_SIMD_SCALAR_LOOP(std::exp(a)); break;
+		case glsl_op_log: GLSL_SIMD_SCALAR_LOOP(std::log(a)); break;
+		case glsl_op_exp2: GLSL_SIMD_SCALAR_LOOP(std::pow(2.0f, a)); break;
+		case glsl_op_log2: GLSL_SIMD_SCALAR_LOOP(std::log(a) * 1.44269504f); break;
+		case glsl_op_pow: GLSL_SIMD_SCALAR_LOOP(std::pow(a, b)); break;
+		case glsl_op_sin: GLSL_SIMD_SCALAR_LOOP(std::sin(a)); break;
+		case glsl_op_cos: GLSL_SIMD_SCALAR_LOOP(std::cos(a)); break;
+		case glsl_op_tan: GLSL_SIMD_SCALAR_LOOP(std::tan(a)); break;
+		case glsl_op_asin: GLSL_SIMD_SCALAR_LOOP(std::asin(a)); break;
+		case glsl_op_acos: GLSL_SIMD_SCALAR_LOOP(std::acos(a)); break;
+		case glsl_op_atan: GLSL_SIMD_SCALAR_LOOP(std::atan(a)); break;
+		case glsl_op_atan2: GLSL_SIMD_SCALAR_LOOP(std::atan2(a, b)); break;
+		case glsl_op_cmp_lt: GLSL_SIMD_LOOP(_mm_cmplt_ps(a, b)); break;
+		case glsl_op_cmp_le: GLSL_SIMD_LOOP(_mm_cmple_ps(a, b)); break;
+		case glsl_op_cmp_gt: GLSL_SIMD_LOOP(_mm_cmpgt_ps(a, b)); break;
+		case glsl_op_cmp_ge: GLSL_SIMD_LOOP(_mm_cmpge_ps(a, b)); break;
+		case glsl_op_cmp_eq: GLSL_SIMD_LOOP(_mm_cmpeq_ps(a, b)); break;
+		case glsl_op_cmp_ne: GLSL_SIMD_LOOP(_mm_cmpneq_ps(a, b)); break;
+		case glsl_op_and: GLSL_SIMD_LOOP(_mm_and_ps(a, b)); break;
+		case glsl_op_or: GLSL_SIMD_LOOP(_mm_or_ps(a, b)); break;
+		case glsl_op_xor: GLSL_SIMD_LOOP(_mm_xor_ps(a, b)); break;
+		case glsl_op_andnot: GLSL_SIMD_LOOP(_mm_andnot_ps(a, b)); break;
+		case glsl_op_select: GLSL_SIMD_LOOP(_mm_or_ps(_mm_and_ps(c, a), _mm_andnot_ps(c, b))); break;
+		case glsl_op_store_masked: GLSL_SIMD_LOOP(_mm_or_ps(_mm_and_ps(b, a), _mm_andnot_ps(b, _mm_load_ps(rd + i)))); break;
+		case glsl_op_b2f: GLSL_SIMD_LOOP(_mm_and_ps(a, one)); break;
+		case glsl_op_f2b: GLSL_SIMD_LOOP(_mm_cmpneq_ps(a, zero)); break;
+
+		case glsl_op_tex2d:
+			{
+				int sampler_index = (int)rc[0];
+				if (sampler_index >= 0 && sampler_index < num_samplers && samplers[sampler_index].data)
+				{
+					sample_nearest(rd, rd + GlslSimdRegisters::lanes, rd + 2 * GlslSimdRegisters::lanes, rd + 3 * GlslSimdRegisters::lanes, ra, rb, samplers[sampler_index]);
+				}
+				else
+				{
+					for (int i = 0; i < 4 * GlslSimdRegisters::lanes; i++)
+						rd[i] = 0.0f;
+				}
+			}
+			break;
+
+		case glsl_op_jmp:
+			pc = inst.c;
+			break;
+
+		case glsl_op_jmp_if_none:
+			if (_mm_movemask_ps(_mm_or_ps(_mm_load_ps(ra), _mm_load_ps(ra + 4))) == 0)
+				pc = inst.c;
+			break;
+
+		case glsl_op_jmp_if_any:
+			if (_mm_movemask_ps(_mm_or_ps(_mm_load_ps(ra), _mm_load_ps(ra + 4))) != 0)
+				pc = inst.c;
+			break;
+		}
+	}
+}
+
+void GlslSimdProgram::sample_nearest(float *dest_r, float *dest_g, float *dest_b, float *dest_a, const float *u, const float *v, const PixelBufferData &sampler)
+{
+	int width = sampler.size.width;
+	int height = sampler.size.height;
+	for (int i = 0; i < GlslSimdRegisters::lanes; i++)
+	{
+		int x = (int)std::floor(u[i] * width);
+		int y = (int)std::floor(v[i] * height);
+		x %= width;
+		y %= height;
+		if (x < 0)
+			x += width;
+		if (y < 0)
+			y += height;
+
+		unsigned int texel = sampler.data[x + y * width];
+		dest_r[i] = ((texel >> 16) & 0xff) * (1.0f / 255.0f);
+		dest_g[i] = ((texel >> 8) & 0xff) * (1.0f / 255.0f);
+		dest_b[i] = (texel & 0xff) * (1.0f / 255.0f);
+		dest_a[i] = (texel >> 24) * (1.0f / 255.0f);
+	}
+}
+
+static void save_symbols(IODevice &device, const std::vector<GlslSimdSymbol> &symbols)
+{
+	device.write_int32(symbols.size());
+	for (size_t i = 0; i < symbols.size(); i++)
+	{
+		device.write_string_a(symbols[i].name);
+		device.write_int32(symbols[i].base_type);
+		device.write_int32(symbols[i].components);
+		device.write_int32(symbols[i].columns);
+		device.write_int32(symbols[i].array_size);
+		device.write_int32(symbols[i].first_register);
+		device.write_int32(symbols[i].interpolation);
+	}
+}
+
+static void load_symbols(IODevice &device, std::vector<GlslSimdSymbol> &symbols, int num_registers)
+{
+	symbols.resize(device.read_int32());
+	for (size_t i = 0; i < symbols.size(); i++)
+	{
+		symbols[i].name = device.read_string_a();
+		symbols[i].base_type = (GlslSimdSymbol::BaseType)device.read_int32();
+		symbols[i].components = device.read_int32();
+		symbols[i].columns = device.read_int32();
+		symbols[i].array_size = device.read_int32();
+		symbols[i].first_register = device.read_int32();
+		symbols[i].interpolation = (GlslSimdSymbol::Interpolation)device.read_int32();
+
+		if (symbols[i].components < 1 || symbols[i].components > 4 || symbols[i].columns < 1 || symbols[i].columns > 4 || symbols[i].array_size < 0 ||
+			symbols[i].first_register < 0 || symbols[i].first_register + symbols[i].get_registers() > num_registers)
+			throw Exception("Invalid shader symbol");
+	}
+}
+
+void GlslSimdProgram::save(IODevice &device) const
+{
+	device.write_int32(type);
+	device.write_int32(num_registers);
+	device.write_int32(num_static_registers);
+	device.write_int32(mask_register);
+	device.write_int32(alive_register);
+
+	device.write_int32(instructions.size());
+	for (size_t i = 0; i < instructions.size(); i++)
+	{
+		device.write_int32(instructions[i].opcode);
+		device.write_int32(instructions[i].dest);
+		device.write_int32(instructions[i].a);
+		device.write_int32(instructions[i].b);
+		device.write_int32(instructions[i].c);
+	}
+
+	device.write_int32(constants.size());
+	for (size_t i = 0; i < constants.size(); i++)
+	{
+		device.write_int32(constants[i].first);
+		device.write_uint32(constants[i].second);
+	}
+
+	save_symbols(device, inputs);
+	save_symbols(device, outputs);
+	save_symbols(device, uniforms);
+}
+
+void GlslSimdProgram::load(IODevice &device)
+{
+	type = (ShaderType)device.read_int32();
+	num_registers = device.read_int32();
+	num_static_registers = device.read_int32();
+	mask_register = device.read_int32();
+	alive_register = device.read_int32();
+	if (num_registers < 0 || num_static_registers < 0 || num_static_registers > num_registers ||
+		mask_register < 0 || mask_register >= num_registers || alive_register < 0 || alive_register >= num_registers)
+		throw Exception("Invalid shader program header");
+
+	instructions.resize(device.read_int32());
+	for (size_t i = 0; i < instructions.size(); i++)
+	{
+		GlslSimdInstruction &inst = instructions[i];
+		inst.opcode = (GlslSimdOpcode)device.read_int32();
+		inst.dest = device.read_int32();
+		inst.a = device.read_int32();
+		inst.b = device.read_int32();
+		inst.c = device.read_int32();
+
+		// Validate everything so a damaged cache file can never make run() touch memory outside the register file
+		bool is_jump = (inst.opcode == glsl_op_jmp || inst.opcode == glsl_op_jmp_if_none || inst.opcode == glsl_op_jmp_if_any);
+		int dest_registers = (inst.opcode == glsl_op_tex2d) ? 4 : 1;
+		if (inst.opcode < glsl_op_mov || inst.opcode > glsl_op_jmp_if_any ||
+			inst.dest < 0 || inst.dest + dest_registers > num_registers ||
+			inst.a < 0 || inst.a >= num_registers ||
+			inst.b < 0 || inst.b >= num_registers ||
+			inst.c < 0 || (is_jump ? inst.c > (int)instructions.size() : inst.c >= num_registers))
+			throw Exception("Invalid shader instruction");
+	}
+
+	constants.resize(device.read_int32());
+	for (size_t i = 0; i < constants.size(); i++)
+	{
+		constants[i].first = device.read_int32();
+		constants[i].second = device.read_uint32();
+		if (constants[i].first < 0 || constants[i].first >= num_registers)
+			throw Exception("Invalid shader constant");
+	}
+
+	load_symbols(device, inputs, num_registers);
+	load_symbols(device, outputs, num_registers);
+	load_symbols(device, uniforms, num_registers);
+}
+
+}
@@ -0,0 +1,228 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Display/Render/shader_object.h"
+#include <emmintrin.h>
+#include <vector>
+
+namespace clan
+{
+
+class IODevice;
+class PixelBufferData;
+
+/// \brief Instructions understood by GlslSimdProgram
+///
+/// Every instruction operates on all lanes of its registers at once.
+enum GlslSimdOpcode
+{
+	glsl_op_mov,          // dest = a
+	glsl_op_add,          // dest = a + b
+	glsl_op_sub,          // dest = a - b
+	glsl_op_mul,          // dest = a * b
+	glsl_op_div,          // dest = a / b
+	glsl_op_mad,          // dest = a * b + c
+	glsl_op_neg,          // dest = -a
+	glsl_op_min,          // dest = min(a, b)
+	glsl_op_max,          // dest = max(a, b)
+	glsl_op_abs,          // dest = abs(a)
+	glsl_op_sign,         // dest = sign(a)
+	glsl_op_floor,        // dest = floor(a)
+	glsl_op_ceil,         // dest = ceil(a)
+	glsl_op_fract,        // dest = a - floor(a)
+	glsl_op_trunc,        // dest = a rounded towards zero
+	glsl_op_mod,          // dest = a - b * floor(a / b)
+	glsl_op_sqrt,         // dest = sqrt(a)
+	glsl_op_rsqrt,        // dest = 1 / sqrt(a)
+	glsl_op_exp,          // dest = exp(a)
+	glsl_op_log,          // dest = log(a)
+	glsl_op_exp2,         // dest = exp2(a)
+	glsl_op_log2,         // dest = log2(a)
+	glsl_op_pow,          // dest = pow(a, b)
+	glsl_op_sin,          // dest = sin(a)
+	glsl_op_cos,          // dest = cos(a)
+	glsl_op_tan,          // dest = tan(a)
+	glsl_op_asin,         // dest = asin(a)
+	glsl_op_acos,         // dest = acos(a)
+	glsl_op_atan,         // dest = atan(a)
+	glsl_op_atan2,        // dest = atan(a, b)
+	glsl_op_cmp_lt,       // dest = a < b ? ~0 : 0
+	glsl_op_cmp_le,       // dest = a <= b ? ~0 : 0
+	glsl_op_cmp_gt,       // dest = a > b ? ~0 : 0
+	glsl_op_cmp_ge,       // dest = a >= b ? ~0 : 0
+	glsl_op_cmp_eq,       // dest = a == b ? ~0 : 0
+	glsl_op_cmp_ne,       // dest = a != b ? ~0 : 0
+	glsl_op_and,          // dest = a & b
+	glsl_op_or,           // dest = a | b
+	glsl_op_xor,          // dest = a ^ b
+	glsl_op_andnot,       // dest = ~a & b
+	glsl_op_select,       // dest = c ? a : b
+	glsl_op_store_masked, // dest = b ? a : dest
+	glsl_op_b2f,          // dest = a ? 1.0 : 0.0
+	glsl_op_f2b,          // dest = a != 0.0 ? ~0 : 0
+	glsl_op_tex2d,        // dest..dest+3 = texture c sampled at (a, b)
+	glsl_op_jmp,          // goto c
+	glsl_op_jmp_if_none,  // if no lane in a is set, goto c
+	glsl_op_jmp_if_any    // if any lane in a is set, goto c
+};
+
+class GlslSimdInstruction
+{
+public:
+	GlslSimdInstruction() : opcode(glsl_op_mov), dest(0), a(0), b(0), c(0) { }
+	GlslSimdInstruction(GlslSimdOpcode opcode, int dest, int a = 0, int b = 0, int c = 0) : opcode(opcode), dest(dest), a(a), b(b), c(c) { }
+
+	GlslSimdOpcode opcode;
+	int dest;
+	int a;
+	int b;
+	int c;
+};
+
+/// \brief Input, output or uniform variable of a compiled shader
+class GlslSimdSymbol
+{
+public:
+	GlslSimdSymbol() : base_type(type_float), components(1), columns(1), array_size(0), first_register(0), interpolation(interpolate_smooth) { }
+
+	enum BaseType
+	{
+		type_float,
+		type_int,
+		type_bool,
+		type_sampler
+	};
+
+	enum Interpolation
+	{
+		interpolate_smooth,
+		interpolate_flat,
+		interpolate_noperspective
+	};
+
+	/// \brief Number of registers used by one array element
+	int get_element_registers() const { return components * columns; }
+
+	/// \brief Number of registers used by the variable
+	int get_registers() const { return get_element_registers() * (array_size > 0 ? array_size : 1); }
+
+	std::string name;
+	BaseType base_type;
+	int components;
+	int columns;
+	int array_size;
+	int first_register;
+	Interpolation interpolation;
+};
+
+/// \brief Register file for running a GlslSimdProgram
+///
+/// Each register holds one float (or mask) for each of the lanes.
+class GlslSimdRegisters
+{
+public:
+	GlslSimdRegisters() : registers(0), num_registers(0) { }
+	GlslSimdRegisters(int num_registers) : registers(0), num_registers(0) { resize(num_registers); }
+
+	enum { lanes = 8 };
+
+	void resize(int new_num_registers)
+	{
+		buffer.resize(new_num_registers * lanes + 4);
+		registers = reinterpret_cast<float *>((reinterpret_cast<size_t>(&buffer[0]) + 15) & ~(size_t)15);
+		num_registers = new_num_registers;
+	}
+
+	int get_count() const { return num_registers; }
+	float *get(int index) { return registers + index * lanes; }
+	const float *get(int index) const { return registers + index * lanes; }
+
+	void set(int index, float value) { float *r = get(index); for (int lane = 0; lane < lanes; lane++) r[lane] = value; }
+	void set_lane(int index, int lane, float value) { get(index)[lane] = value; }
+	float get_lane(int index, int lane) const { return get(index)[lane]; }
+
+private:
+	GlslSimdRegisters(const GlslSimdRegisters &); // do not implement
+	GlslSimdRegisters &operator=(const GlslSimdRegisters &); // do not implement
+
+	std::vector<float> buffer;
+	float *registers;
+	int num_registers;
+};
+
+/// \brief Shader compiled to SSE instructions operating on GlslSimdRegisters::lanes invocations at a time
+class GlslSimdProgram
+{
+public:
+	GlslSimdProgram();
+
+	/// \brief Increase when the instruction set or the code generator changes, to invalidate cached programs
+	enum { version = 1 };
+
+	ShaderType type;
+	std::vector<GlslSimdInstruction> instructions;
+
+	/// \brief Total number of registers needed to run the program
+	int num_registers;
+
+	/// \brief Registers below this index keep their value between runs (constants, uniforms, inputs and outputs)
+	int num_static_registers;
+
+	/// \brief Register with the lanes currently executing
+	int mask_register;
+
+	/// \brief Register with the lanes not discarded
+	int alive_register;
+
+	/// \brief Constant register values, stored as raw bits so masks survive
+	std::vector<std::pair<int, unsigned int> > constants;
+
+	std::vector<GlslSimdSymbol> inputs;
+	std::vector<GlslSimdSymbol> outputs;
+	std::vector<GlslSimdSymbol> uniforms;
+
+	const GlslSimdSymbol *find_input(const std::string &name) const;
+	const GlslSimdSymbol *find_output(const std::string &name) const;
+	const GlslSimdSymbol *find_uniform(const std::string &name) const;
+
+	/// \brief Writes the constants into the register file
+	void init_registers(GlslSimdRegisters &registers) const;
+
+	/// \brief Runs the program on all lanes enabled in mask_register
+	void run(GlslSimdRegisters &registers, const PixelBufferData *samplers, int num_samplers) const;
+
+	void save(IODevice &device) const;
+	void load(IODevice &device);
+
+private:
+	static void sample_nearest(float *dest_r, float *dest_g, float *dest_b, float *dest_a, const float *u, const float *v, const PixelBufferData &sampler);
+};
+
+}
@@ -0,0 +1,354 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "SWRender/precomp.h"
+#include "software_program_glsl.h"
+#include "Canvas/Pipeline/pixel_pipeline.h"
+#include "Canvas/Commands/pixel_command_glsl_triangle.h"
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// SoftwareProgram_GLSL Construction:
+
+SoftwareProgram_GLSL::SoftwareProgram_GLSL(const std::shared_ptr<GlslSimdProgram> &vertex_program, const std::shared_ptr<GlslSimdProgram> &fragment_program)
+: vertex_program(vertex_program), position_register(-1), fragment_setup(new PixelGlslFragmentSetup())
+{
+	if (vertex_program->type != shadertype_vertex || fragment_program->type != shadertype_fragment)
+		throw Exception("A program must have one vertex shader and one fragment shader");
+
+	for (size_t i = 0; i < vertex_program->inputs.size(); i++)
+	{
+		if (vertex_program->inputs[i].get_registers() > 4)
+			throw Exception(string_format("Vertex attribute '%1' is larger than a vec4", vertex_program->inputs[i].name));
+	}
+
+	const GlslSimdSymbol *position = vertex_program->find_output("gl_Position");
+	if (position == 0)
+		throw Exception("Vertex shader does not write gl_Position");
+	position_register = position->first_register;
+
+	fragment_setup->program = fragment_program;
+	link_varyings();
+
+	vertex_program->init_registers(vertex_registers);
+
+	GlslSimdRegisters fragment_registers;
+	fragment_program->init_registers(fragment_registers);
+	const float *fragment_data = fragment_registers.get(0);
+	fragment_image = std::shared_ptr<std::vector<float> >(new std::vector<float>(fragment_data, fragment_data + fragment_program->num_registers * GlslSimdRegisters::lanes));
+
+	add_uniforms(*vertex_program, true);
+	add_uniforms(*fragment_program, false);
+}
+
+SoftwareProgram_GLSL::~SoftwareProgram_GLSL()
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// SoftwareProgram_GLSL Attributes:
+
+int SoftwareProgram_GLSL::get_attribute_count() const
+{
+	return vertex_program->inputs.size();
+}
+
+int SoftwareProgram_GLSL::get_attribute_index(const std::string &name) const
+{
+	for (size_t i = 0; i < vertex_program->inputs.size(); i++)
+	{
+		if (vertex_program->inputs[i].name == name)
+			return i;
+	}
+	return -1;
+}
+
+Vec4f SoftwareProgram_GLSL::get_attribute_default(int index)
+{
+	return Vec4f(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+int SoftwareProgram_GLSL::get_uniform_location(const std::string &name) const
+{
+	std::map<std::string, int>::const_iterator it = uniform_names.find(name);
+	if (it != uniform_names.end())
+		return it->second;
+	else
+		return -1;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// SoftwareProgram_GLSL Operations:
+
+void SoftwareProgram_GLSL::set_uniform(int location, const Vec4f &vec)
+{
+	float values[4] = { vec.x, vec.y, vec.z, vec.w };
+	set_uniform_registers(location, values, 4);
+}
+
+void SoftwareProgram_GLSL::set_uniform_matrix(int location, const Mat4f &mat)
+{
+	if (location < 0 || location >= (int)uniform_locations.size())
+		return;
+
+	const UniformLocation &uniform = uniform_locations[location];
+	float values[16];
+	int count = 0;
+	for (int col = 0; col < uniform.columns; col++)
+	{
+		for (int row = 0; row < uniform.components; row++)
+			values[count++] = mat.matrix[col * 4 + row];
+	}
+	set_uniform_registers(location, values, count);
+}
+
+PixelCommand *SoftwareProgram_GLSL::draw_triangle(PixelPipeline *pipeline, const std::vector<Vec4f> &attribute_values)
+{
+	const GlslSimdProgram &program = *vertex_program;
+
+	for (size_t i = 0; i < program.inputs.size(); i++)
+	{
+		const GlslSimdSymbol &input = program.inputs[i];
+		for (int v = 0; v < 3; v++)
+		{
+			const Vec4f &value = attribute_values[i * 3 + v];
+			float components[4] = { value.x, value.y, value.z, value.w };
+			for (int r = 0; r < input.get_registers(); r++)
+				vertex_registers.set_lane(input.first_register + r, v, components[r]);
+		}
+	}
+
+	unsigned int *mask = reinterpret_cast<unsigned int *>(vertex_registers.get(program.mask_register));
+	unsigned int *alive = reinterpret_cast<unsigned int *>(vertex_registers.get(program.alive_register));
+	for (int i = 0; i < GlslSimdRegisters::lanes; i++)
+	{
+		mask[i] = (i < 3) ? 0xffffffff : 0;
+		alive[i] = mask[i];
+	}
+
+	program.run(vertex_registers, 0, 0);
+
+	const int vertex_size = fragment_setup->vertex_size;
+	float vertices[3 * 64];
+	float clipped[PixelCommandGlslTriangle::max_vertices * 64];
+	if (vertex_size > 64)
+		throw Exception("Too many varyings");
+
+	for (int v = 0; v < 3; v++)
+	{
+		float *vertex = vertices + v * vertex_size;
+		for (int c = 0; c < 4; c++)
+			vertex[c] = vertex_registers.get_lane(position_register + c, v);
+
+		for (size_t j = 0; j < fragment_setup->varyings.size(); j++)
+		{
+			const PixelGlslFragmentSetup::Varying &varying = fragment_setup->varyings[j];
+			for (int r = 0; r < varying.num_registers; r++)
+				vertex[4 + varying.vertex_offset + r] = vertex_registers.get_lane(varying_source_registers[j] + r, v);
+		}
+	}
+
+	// Trivially reject triangles completely outside one of the clip planes
+	for (int axis = 0; axis < 2; axis++)
+	{
+		bool all_outside_positive = true;
+		bool all_outside_negative = true;
+		for (int v = 0; v < 3; v++)
+		{
+			const float *vertex = vertices + v * vertex_size;
+			all_outside_positive = all_outside_positive && vertex[axis] > vertex[3];
+			all_outside_negative = all_outside_negative && vertex[axis] < -vertex[3];
+		}
+		if (all_outside_positive || all_outside_negative)
+			return 0;
+	}
+
+	int num_vertices = clip_near(vertices, 3, clipped);
+	if (num_vertices < 3)
+		return 0;
+
+	return new(pipeline) PixelCommandGlslTriangle(pipeline, fragment_setup, fragment_image, clipped, num_vertices);
+}
+
+PixelCommand *SoftwareProgram_GLSL::draw_sprite(PixelPipeline *pipeline, const std::vector<Vec4f> &attribute_values)
+{
+	return draw_triangle(pipeline, attribute_values);
+}
+
+PixelCommand *SoftwareProgram_GLSL::draw_line(PixelPipeline *pipeline, const std::vector<Vec4f> &attribute_values)
+{
+	return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// SoftwareProgram_GLSL Implementation:
+
+void SoftwareProgram_GLSL::link_varyings()
+{
+	const GlslSimdProgram &fragment_program = *fragment_setup->program;
+
+	int vertex_offset = 0;
+	for (size_t i = 0; i < fragment_program.inputs.size(); i++)
+	{
+		const GlslSimdSymbol &input = fragment_program.inputs[i];
+		if (input.name == "gl_FragCoord")
+		{
+			fragment_setup->frag_coord_register = input.first_register;
+			continue;
+		}
+
+		const GlslSimdSymbol *output = vertex_program->find_output(input.name);
+		if (output == 0)
+			throw Exception(string_format("Varying '%1' is not written by the vertex shader", input.name));
+		if (output->get_registers() != input.get_registers() || output->base_type != input.base_type)
+			throw Exception(string_format("Varying '%1' has different types in the vertex and fragment shaders", input.name));
+
+		PixelGlslFragmentSetup::Varying varying;
+		varying.first_register = input.first_register;
+		varying.num_registers = input.get_registers();
+		varying.vertex_offset = vertex_offset;
+		varying.interpolation = input.interpolation;
+		fragment_setup->varyings.push_back(varying);
+		varying_source_registers.push_back(output->first_register);
+		vertex_offset += varying.num_registers;
+	}
+	fragment_setup->vertex_size = 4 + vertex_offset;
+
+	const GlslSimdSymbol *color = fragment_program.find_output("gl_FragColor");
+	for (size_t i = 0; color == 0 && i < fragment_program.outputs.size(); i++)
+	{
+		if (fragment_program.outputs[i].get_registers() == 4)
+			color = &fragment_program.outputs[i];
+	}
+	if (color)
+		fragment_setup->color_register = color->first_register;
+}
+
+void SoftwareProgram_GLSL::add_uniforms(const GlslSimdProgram &program, bool is_vertex)
+{
+	for (size_t i = 0; i < program.uniforms.size(); i++)
+	{
+		const GlslSimdSymbol &symbol = program.uniforms[i];
+		int num_elements = symbol.array_size > 0 ? symbol.array_size : 1;
+
+		// Every array element gets its own location, so name[i] is found at location(name) + i
+		int location;
+		std::map<std::string, int>::iterator it = uniform_names.find(symbol.name);
+		if (it != uniform_names.end())
+		{
+			location = it->second;
+		}
+		else
+		{
+			location = uniform_locations.size();
+			uniform_locations.resize(location + num_elements);
+			uniform_names[symbol.name] = location;
+			if (symbol.array_size > 0)
+			{
+				for (int element = 0; element < num_elements; element++)
+					uniform_names[string_format("%1[%2]", symbol.name, element)] = location + element;
+			}
+		}
+
+		for (int element = 0; element < num_elements && location + element < (int)uniform_locations.size(); element++)
+		{
+			UniformLocation &uniform = uniform_locations[location + element];
+			uniform.components = symbol.components;
+			uniform.columns = symbol.columns;
+			int reg = symbol.first_register + element * symbol.get_element_registers();
+			if (is_vertex)
+				uniform.vertex_register = reg;
+			else
+				uniform.fragment_register = reg;
+		}
+	}
+}
+
+void SoftwareProgram_GLSL::set_uniform_registers(int location, const float *values, int count)
+{
+	if (location < 0 || location >= (int)uniform_locations.size())
+		return;
+
+	const UniformLocation &uniform = uniform_locations[location];
+	count = min(count, uniform.components * uniform.columns);
+
+	if (uniform.vertex_register != -1)
+	{
+		for (int i = 0; i < count; i++)
+			vertex_registers.set(uniform.vertex_register + i, values[i]);
+	}
+
+	if (uniform.fragment_register != -1)
+	{
+		// Queued commands may still be using the current image
+		if (!fragment_image.unique())
+			fragment_image = std::shared_ptr<std::vector<float> >(new std::vector<float>(*fragment_image));
+
+		for (int i = 0; i < count; i++)
+		{
+			float *reg = &(*fragment_image)[(uniform.fragment_register + i) * GlslSimdRegisters::lanes];
+			for (int lane = 0; lane < GlslSimdRegisters::lanes; lane++)
+				reg[lane] = values[i];
+		}
+	}
+}
+
+int SoftwareProgram_GLSL::clip_near(const float *input, int num_input, float *output) const
+{
+	// Clip against w = epsilon, keeping the vertices on the positive side (Sutherland-Hodgman)
+	const float epsilon = 1.0e-5f;
+	const int vertex_size = fragment_setup->vertex_size;
+	int num_output = 0;
+	for (int i = 0; i < num_input; i++)
+	{
+		const float *a = input + i * vertex_size;
+		const float *b = input + ((i + 1) % num_input) * vertex_size;
+		float da = a[3] - epsilon;
+		float db = b[3] - epsilon;
+
+		if (da >= 0.0f)
+		{
+			memcpy(output + num_output * vertex_size, a, sizeof(float) * vertex_size);
+			num_output++;
+		}
+
+		if ((da >= 0.0f) != (db >= 0.0f))
+		{
+			float t = da / (da - db);
+			float *dest = output + num_output * vertex_size;
+			for (int c = 0; c < vertex_size; c++)
+				dest[c] = a[c] + (b[c] - a[c]) * t;
+			num_output++;
+		}
+	}
+	return num_output;
+}
+
+}
@@ -0,0 +1,91 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/SWRender/software_program.h"
+#include "GLSL/Simd/glsl_simd_program.h"
+#include <map>
+
+namespace clan
+{
+
+class PixelGlslFragmentSetup;
+
+/// \brief Software program running compiled GLSL vertex and fragment shaders
+///
+/// The vertex shader runs on the thread submitting the primitives. The fragment shader runs
+/// in the pixel pipeline, processing GlslSimdRegisters::lanes pixels at a time.
+class SoftwareProgram_GLSL : public SoftwareProgram
+{
+public:
+	/// \brief Links the two programs. Throws an Exception if their interfaces do not match.
+	SoftwareProgram_GLSL(const std::shared_ptr<GlslSimdProgram> &vertex_program, const std::shared_ptr<GlslSimdProgram> &fragment_program);
+	~SoftwareProgram_GLSL();
+
+	int get_attribute_count() const;
+	int get_attribute_index(const std::string &name) const;
+	Vec4f get_attribute_default(int index);
+	int get_uniform_location(const std::string &name) const;
+	void set_uniform(int location, const Vec4f &vec);
+	void set_uniform_matrix(int location, const Mat4f &mat);
+
+	PixelCommand *draw_triangle(PixelPipeline *pipeline, const std::vector<Vec4f> &attribute_values);
+	PixelCommand *draw_sprite(PixelPipeline *pipeline, const std::vector<Vec4f> &attribute_values);
+
+	/// \brief Lines are not rasterized by GLSL programs yet
+	PixelCommand *draw_line(PixelPipeline *pipeline, const std::vector<Vec4f> &attribute_values);
+
+private:
+	struct UniformLocation
+	{
+		UniformLocation() : vertex_register(-1), fragment_register(-1), components(1), columns(1) { }
+		int vertex_register;
+		int fragment_register;
+		int components;
+		int columns;
+	};
+
+	void link_varyings();
+	void add_uniforms(const GlslSimdProgram &program, bool is_vertex);
+	void set_uniform_registers(int location, const float *values, int count);
+	int clip_near(const float *input, int num_input, float *output) const;
+
+	std::shared_ptr<GlslSimdProgram> vertex_program;
+	GlslSimdRegisters vertex_registers;
+	int position_register;
+	std::vector<int> varying_source_registers;
+
+	std::shared_ptr<PixelGlslFragmentSetup> fragment_setup;
+	std::shared_ptr<std::vector<float> > fragment_image;
+
+	std::map<std::string, int> uniform_names;
+	std::vector<UniformLocation> uniform_locations;
+};
+
+}
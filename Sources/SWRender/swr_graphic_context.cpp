@@ -31,6 +31,7 @@
 #include "API/SWRender/pixel_command.h"
 #include "swr_graphic_context_provider.h"
 #include "Canvas/pixel_canvas.h"
+#include "Canvas/Pipeline/pixel_pipeline.h"
 
 namespace clan
 {
@@ -83,6 +84,13 @@ PixelPipeline *GraphicContext_SWRender::get_pipeline() const
 	return impl->provider->get_canvas()->get_pipeline();
 }
 
+PixelPipelineStatistics GraphicContext_SWRender::get_pipeline_statistics() const
+{
+	PixelPipeline *pipeline = get_pipeline();
+	pipeline->wait_for_workers();
+	return pipeline->get_profiler().get_statistics();
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // GraphicContext_SWRender Operations:
 
@@ -101,6 +109,30 @@ void GraphicContext_SWRender::queue_command(std::unique_ptr<PixelCommand> &comma
 	impl->provider->queue_command(command);
 }
 
+void GraphicContext_SWRender::reset_pipeline_statistics()
+{
+	PixelPipeline *pipeline = get_pipeline();
+	pipeline->wait_for_workers();
+	pipeline->get_profiler().reset();
+}
+
+void GraphicContext_SWRender::set_pipeline_command_profiling(bool enable)
+{
+	get_pipeline()->get_profiler().set_command_profiling_enabled(enable);
+}
+
+void GraphicContext_SWRender::set_pipeline_tracing(bool enable)
+{
+	get_pipeline()->get_profiler().set_tracing_enabled(enable);
+}
+
+void GraphicContext_SWRender::save_pipeline_trace(const std::string &filename)
+{
+	PixelPipeline *pipeline = get_pipeline();
+	pipeline->wait_for_workers();
+	pipeline->get_profiler().save_trace(filename);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // GraphicContext_SWRender Implementation:
 }
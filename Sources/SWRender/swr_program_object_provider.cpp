@@ -30,6 +30,8 @@
 #include "swr_program_object_provider.h"
 #include "API/Display/Render/shader_object.h"
 #include "API/SWRender/software_program.h"
+#include "swr_shader_object_provider.h"
+#include "software_program_glsl.h"
 
 namespace clan
 {
@@ -37,7 +39,7 @@ namespace clan
 /////////////////////////////////////////////////////////////////////////////
 // SWRenderProgramObjectProvider Construction:
 
-SWRenderProgramObjectProvider::SWRenderProgramObjectProvider() : current_program(NULL), sprite_program(false)
+SWRenderProgramObjectProvider::SWRenderProgramObjectProvider() : current_program(NULL), sprite_program(false), link_status(false)
 {
 }
 
@@ -65,7 +67,7 @@ unsigned int SWRenderProgramObjectProvider::get_handle() const
 
 bool SWRenderProgramObjectProvider::get_link_status() const
 {
-	return false;
+	return link_status;
 }
 
 bool SWRenderProgramObjectProvider::get_validate_status() const
@@ -75,16 +77,19 @@ bool SWRenderProgramObjectProvider::get_validate_status() const
 
 std::string SWRenderProgramObjectProvider::get_info_log() const
 {
-	return std::string();
+	return info_log;
 }
 
 std::vector<ShaderObject> SWRenderProgramObjectProvider::get_shaders() const
 {
-	return std::vector<ShaderObject>();
+	return shaders;
 }
 
 int SWRenderProgramObjectProvider::get_attribute_location(const std::string &name) const
 {
+	if (current_program == 0)
+		return -1;
+
 	int attribute_index = current_program->get_attribute_index(name);
 	if (attribute_index >= 0 && attribute_index < (int)bind_locations.size())
 		return bind_locations[attribute_index];
@@ -94,7 +99,10 @@ int SWRenderProgramObjectProvider::get_attribute_location(const std::string &nam
 
 int SWRenderProgramObjectProvider::get_uniform_location(const std::string &name) const
 {
-	return 0;
+	if (current_program)
+		return current_program->get_uniform_location(name);
+	else
+		return -1;
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -112,6 +120,13 @@ void SWRenderProgramObjectProvider::set_program(SoftwareProgram *program)
 		bind_locations[i] = i;
 		attribute_defaults[i] = current_program->get_attribute_default(i);
 	}
+
+	for (size_t i = 0; i < attribute_binds.size(); i++)
+	{
+		int attribute_index = current_program->get_attribute_index(attribute_binds[i].second);
+		if (attribute_index >= 0 && attribute_index < (int)bind_locations.size())
+			bind_locations[attribute_index] = attribute_binds[i].first;
+	}
 }
 
 void SWRenderProgramObjectProvider::set_sprite_program(bool is_sprite_program_flag)
@@ -121,17 +136,32 @@ void SWRenderProgramObjectProvider::set_sprite_program(bool is_sprite_program_fl
 
 void SWRenderProgramObjectProvider::attach(const ShaderObject &obj)
 {
+	shaders.push_back(obj);
 }
 
 void SWRenderProgramObjectProvider::detach(const ShaderObject &obj)
 {
+	for (size_t i = 0; i < shaders.size(); i++)
+	{
+		if (shaders[i] == obj)
+		{
+			shaders.erase(shaders.begin() + i);
+			break;
+		}
+	}
 }
 
 void SWRenderProgramObjectProvider::bind_attribute_location(int index, const std::string &name)
 {
-	int attribute_index = current_program->get_attribute_index(name);
-	if (attribute_index >= 0 && attribute_index < (int)bind_locations.size())
-		bind_locations[attribute_index] = index;
+	// Binds made before linking are applied when the program is set
+	attribute_binds.push_back(std::pair<int, std::string>(index, name));
+
+	if (current_program)
+	{
+		int attribute_index = current_program->get_attribute_index(name);
+		if (attribute_index >= 0 && attribute_index < (int)bind_locations.size())
+			bind_locations[attribute_index] = index;
+	}
 }
 
 void SWRenderProgramObjectProvider::bind_frag_data_location(int color_number, const std::string &name)
@@ -140,6 +170,36 @@ void SWRenderProgramObjectProvider::bind_frag_data_location(int color_number, co
 
 void SWRenderProgramObjectProvider::link()
 {
+	try
+	{
+		std::shared_ptr<GlslSimdProgram> vertex_program;
+		std::shared_ptr<GlslSimdProgram> fragment_program;
+		for (size_t i = 0; i < shaders.size(); i++)
+		{
+			SWRenderShaderObjectProvider *shader_provider = dynamic_cast<SWRenderShaderObjectProvider *>(shaders[i].get_provider());
+			if (shader_provider == 0)
+				throw Exception("Shader object does not belong to SWRender");
+
+			if (shader_provider->get_shader_type() == shadertype_vertex)
+				vertex_program = shader_provider->get_program();
+			else if (shader_provider->get_shader_type() == shadertype_fragment)
+				fragment_program = shader_provider->get_program();
+			else
+				throw Exception("Only vertex and fragment shaders are supported by SWRender");
+		}
+		if (!vertex_program || !fragment_program)
+			throw Exception("A program must have a vertex shader and a fragment shader");
+
+		linked_program.reset(new SoftwareProgram_GLSL(vertex_program, fragment_program));
+		set_program(linked_program.get());
+		link_status = true;
+		info_log.clear();
+	}
+	catch (Exception &e)
+	{
+		link_status = false;
+		info_log = e.message;
+	}
 }
 
 void SWRenderProgramObjectProvider::validate()
@@ -168,6 +228,11 @@ void SWRenderProgramObjectProvider::set_uniform4i(int location, int v1, int v2,
 
 void SWRenderProgramObjectProvider::set_uniformiv(int location, int size, int count, const int *data)
 {
+	for (int i = 0; i < count; i++)
+	{
+		const int *v = data + i * size;
+		current_program->set_uniform(location + i, Vec4f(v[0], size > 1 ? v[1] : 0.0f, size > 2 ? v[2] : 1.0f, size > 3 ? v[3] : 1.0f));
+	}
 }
 
 void SWRenderProgramObjectProvider::set_uniform1f(int location, float v1)
@@ -192,14 +257,27 @@ void SWRenderProgramObjectProvider::set_uniform4f(int location, float v1, float
 
 void SWRenderProgramObjectProvider::set_uniformfv(int location, int size, int count, const float *data)
 {
+	for (int i = 0; i < count; i++)
+	{
+		const float *v = data + i * size;
+		current_program->set_uniform(location + i, Vec4f(v[0], size > 1 ? v[1] : 0.0f, size > 2 ? v[2] : 1.0f, size > 3 ? v[3] : 1.0f));
+	}
 }
 
 void SWRenderProgramObjectProvider::set_uniform_matrix(int location, int size, int count, bool transpose, const float *data)
 {
-	if (!transpose)
-		current_program->set_uniform_matrix(location, Mat4f(data));
-	else
-		current_program->set_uniform_matrix(location, Mat4f(data).transpose());
+	for (int i = 0; i < count; i++)
+	{
+		// mat2 and mat3 are placed in the upper left corner of a Mat4f
+		const float *m = data + i * size * size;
+		Mat4f matrix = Mat4f::identity();
+		for (int col = 0; col < size; col++)
+		{
+			for (int row = 0; row < size; row++)
+				matrix.matrix[col * 4 + row] = transpose ? m[row * size + col] : m[col * size + row];
+		}
+		current_program->set_uniform_matrix(location + i, matrix);
+	}
 }
 
 int SWRenderProgramObjectProvider::get_uniform_buffer_size(int block_index) const
@@ -32,6 +32,7 @@
 
 #include "API/Display/TargetProviders/program_object_provider.h"
 #include "API/Core/Math/vec4.h"
+#include "API/Display/Render/shader_object.h"
 
 namespace clan
 {
@@ -106,6 +107,12 @@ private:
 	std::vector<int> bind_locations;
 	std::vector<Vec4f> attribute_defaults;
 	std::vector<Vec4f> current_attribute_values;
+
+	std::vector<ShaderObject> shaders;
+	std::unique_ptr<SoftwareProgram> linked_program;
+	bool link_status;
+	std::string info_log;
+	std::vector<std::pair<int, std::string> > attribute_binds;
 /// \}
 };
 
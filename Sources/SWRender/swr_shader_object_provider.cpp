@@ -28,6 +28,7 @@
 
 #include "SWRender/precomp.h"
 #include "swr_shader_object_provider.h"
+#include "GLSL/Simd/glsl_shader_cache.h"
 
 namespace clan
 {
@@ -36,6 +37,7 @@ namespace clan
 // SWRenderShaderObjectProvider Construction:
 
 SWRenderShaderObjectProvider::SWRenderShaderObjectProvider()
+: type(shadertype_vertex), compile_status(false)
 {
 }
 
@@ -43,16 +45,24 @@ SWRenderShaderObjectProvider::~SWRenderShaderObjectProvider()
 {
 }
 
-void SWRenderShaderObjectProvider::create(ShaderType type, const std::string &source)
+void SWRenderShaderObjectProvider::create(ShaderType new_type, const std::string &new_source)
 {
+	type = new_type;
+	source = new_source;
 }
 
-void SWRenderShaderObjectProvider::create(ShaderType type, const std::vector<std::string> &sources)
+void SWRenderShaderObjectProvider::create(ShaderType new_type, const std::vector<std::string> &sources)
 {
+	type = new_type;
+	source.clear();
+	for (size_t i = 0; i < sources.size(); i++)
+		source += sources[i];
 }
 
-void SWRenderShaderObjectProvider::create(ShaderType type, const void *source, int source_size)
+void SWRenderShaderObjectProvider::create(ShaderType new_type, const void *new_source, int source_size)
 {
+	type = new_type;
+	source = std::string(static_cast<const char *>(new_source), source_size);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -65,22 +75,22 @@ unsigned int SWRenderShaderObjectProvider::get_handle() const
 
 bool SWRenderShaderObjectProvider::get_compile_status() const
 {
-	return false;
+	return compile_status;
 }
 
 ShaderType SWRenderShaderObjectProvider::get_shader_type() const
 {
-	return shadertype_vertex;
+	return type;
 }
 
 std::string SWRenderShaderObjectProvider::get_info_log() const
 {
-	return std::string();
+	return info_log;
 }
 
 std::string SWRenderShaderObjectProvider::get_shader_source() const
 {
-	return std::string();
+	return source;
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -88,6 +98,29 @@ std::string SWRenderShaderObjectProvider::get_shader_source() const
 
 void SWRenderShaderObjectProvider::compile()
 {
+	try
+	{
+		program = GlslShaderCache::get_program(type, source);
+		compile_status = true;
+		info_log.clear();
+	}
+	catch (Exception &e)
+	{
+		program.reset();
+		compile_status = false;
+		info_log = e.message;
+	}
+}
+
+std::shared_ptr<GlslSimdProgram> SWRenderShaderObjectProvider::get_program()
+{
+	if (!program)
+	{
+		compile();
+		if (!compile_status)
+			throw Exception(info_log);
+	}
+	return program;
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -30,10 +30,13 @@
 
 
 #include "API/Display/TargetProviders/shader_object_provider.h"
+#include "API/Display/Render/shader_object.h"
 
 namespace clan
 {
 
+class GlslSimdProgram;
+
 class SWRenderShaderObjectProvider : public ShaderObjectProvider
 {
 /// \name Construction
@@ -72,12 +75,22 @@ public:
 public:
 	void compile();
 
+	/// \brief Returns the compiled program, compiling the shader first if needed
+	///
+	/// Throws an Exception if the shader does not compile.
+	std::shared_ptr<GlslSimdProgram> get_program();
+
 
 /// \}
 /// \name Implementation
 /// \{
 
 private:
+	ShaderType type;
+	std::string source;
+	bool compile_status;
+	std::string info_log;
+	std::shared_ptr<GlslSimdProgram> program;
 /// \}
 };
 
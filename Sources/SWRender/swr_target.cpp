@@ -30,6 +30,7 @@
 #include "API/SWRender/swr_target.h"
 #include "swr_target_provider.h"
 #include "setup_swrender_impl.h"
+#include "GLSL/Simd/glsl_shader_cache.h"
 
 namespace clan
 {
@@ -58,6 +59,11 @@ bool SWRenderTarget::is_current()
 	SWRenderTargetProvider *provider = dynamic_cast<SWRenderTargetProvider*>(ptr);
 	return (provider != NULL);
 }
+
+std::string SWRenderTarget::get_shader_cache_path()
+{
+	return GlslShaderCache::get_path();
+}
 /////////////////////////////////////////////////////////////////////////////
 // SWRenderTarget Operations:
 void SWRenderTarget::set_current()
@@ -67,6 +73,11 @@ void SWRenderTarget::set_current()
 		throw Exception("clanSWRender has not been initialised");
 	SetupSWRender_Impl::cl_swrender_target->DisplayTarget::set_current();
 }
+
+void SWRenderTarget::set_shader_cache_path(const std::string &path)
+{
+	GlslShaderCache::set_path(path);
+}
 /////////////////////////////////////////////////////////////////////////////
 // SWRenderTarget Implementation:
 
@@ -0,0 +1,230 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+#include <ClanLib/csslayout.h>
+using namespace clan;
+
+// Compiles a large synthetic theme, checks that the compiled sheet selects the same
+// property values as the CSS source and compares how long each takes to load.
+// Also checks that truncated and corrupted compiled sheets are rejected with an exception.
+class TestApp
+{
+public:
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+
+		try
+		{
+			std::string sheet = create_stylesheet(4000);
+
+			DataBuffer source_buffer(sheet.data(), sheet.size());
+			IODevice_Memory source_device(source_buffer);
+			IODevice_Memory compiled_device;
+			CSSDocument::compile_sheet(source_device, "file:", compiled_device);
+			DataBuffer compiled = compiled_device.get_data();
+
+			CSSDocument source_document = load(source_buffer);
+			CSSDocument compiled_document = load(compiled);
+			verify(source_document, compiled_document);
+			verify_corrupted();
+
+			const int iterations = 5;
+			ubyte64 best_source_time = ~(ubyte64)0;
+			ubyte64 best_compiled_time = ~(ubyte64)0;
+			for (int i = 0; i < iterations; i++)
+			{
+				ubyte64 start = System::get_microseconds();
+				load(source_buffer);
+				ubyte64 middle = System::get_microseconds();
+				load(compiled);
+				ubyte64 end = System::get_microseconds();
+
+				best_source_time = min(best_source_time, middle - start);
+				best_compiled_time = min(best_compiled_time, end - middle);
+			}
+
+			Console::write_line("CSS source: %1 KB in %2 ms", (int)(sheet.size() / 1024), best_source_time / 1000.0);
+			Console::write_line("Compiled: %1 KB in %2 ms (%3x)", compiled.get_size() / 1024, best_compiled_time / 1000.0, best_source_time / (double)best_compiled_time);
+		}
+		catch (Exception error)
+		{
+			Console::write_line("Exception caught:");
+			Console::write_line(error.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	CSSDocument load(DataBuffer &buffer)
+	{
+		IODevice_Memory device(buffer);
+		CSSDocument document;
+		document.add_sheet(author_sheet_origin, device, "file:");
+		return document;
+	}
+
+	void verify(CSSDocument &source_document, CSSDocument &compiled_document)
+	{
+		DomDocument dom;
+		DomElement window = dom.create_element("window");
+		window.set_attribute("id", "main-window");
+		window.set_attribute("class", "dialog");
+		dom.append_child(window);
+
+		DomElement toolbar = dom.create_element("div");
+		toolbar.set_attribute("class", "toolbar odd");
+		window.append_child(toolbar);
+
+		std::vector<DomElement> elements;
+		elements.push_back(window);
+		elements.push_back(toolbar);
+		for (int i = 0; i < 20; i++)
+		{
+			DomElement element = dom.create_element(i % 2 ? "button" : "lineedit");
+			element.set_attribute("class", string_format("pressed rule%1", i * 197));
+			toolbar.append_child(element);
+			elements.push_back(element);
+		}
+
+		for (size_t i = 0; i < elements.size(); i++)
+		{
+			std::vector<CSSPropertyValue *> source_values = source_document.select(elements[i]).get_values();
+			std::vector<CSSPropertyValue *> compiled_values = compiled_document.select(elements[i]).get_values();
+			if (source_values.size() != compiled_values.size())
+				throw Exception(string_format("Element %1 selected %2 values from the CSS source but %3 from the compiled sheet", (int)i, (int)source_values.size(), (int)compiled_values.size()));
+
+			for (size_t j = 0; j < source_values.size(); j++)
+			{
+				if (source_values[j]->to_string() != compiled_values[j]->to_string())
+					throw Exception(string_format("Element %1 got '%2' from the compiled sheet instead of '%3'", (int)i, compiled_values[j]->to_string(), source_values[j]->to_string()));
+			}
+		}
+	}
+
+	void verify_corrupted()
+	{
+		std::string sheet = create_stylesheet(20);
+		DataBuffer source_buffer(sheet.data(), sheet.size());
+		IODevice_Memory source_device(source_buffer);
+		IODevice_Memory compiled_device;
+		CSSDocument::compile_sheet(source_device, "file:", compiled_device);
+		DataBuffer compiled = compiled_device.get_data();
+
+		// Anything shorter than the magic header is read as CSS text
+		const int header_size = 8;
+		int rejected = 0;
+		for (int size = header_size; size < compiled.get_size(); size++)
+		{
+			DataBuffer truncated(compiled.get_data(), size);
+			if (load_fails(truncated))
+				rejected++;
+			else
+				throw Exception(string_format("Compiled sheet truncated to %1 of %2 bytes was accepted", size, compiled.get_size()));
+		}
+
+		// Turn each byte into the largest single byte varint group, which inflates whatever count it is part of
+		for (int i = header_size; i < compiled.get_size(); i++)
+		{
+			DataBuffer corrupted(compiled.get_data(), compiled.get_size());
+			corrupted.get_data()[i] = (char)0x7f;
+			load_fails(corrupted);
+		}
+
+		// A string table count of 0xffffffff right after the header
+		DataBuffer huge_count(header_size + 5);
+		memcpy(huge_count.get_data(), compiled.get_data(), header_size);
+		memcpy(huge_count.get_data() + header_size, "\xff\xff\xff\xff\x0f", 5);
+		if (!load_fails(huge_count))
+			throw Exception("Compiled sheet with a huge string count was accepted");
+
+		Console::write_line("Rejected %1 truncated compiled sheets", rejected);
+	}
+
+	bool load_fails(DataBuffer &buffer)
+	{
+		try
+		{
+			load(buffer);
+			return false;
+		}
+		catch (Exception &)
+		{
+			return true;
+		}
+	}
+
+	std::string create_stylesheet(int num_rules)
+	{
+		static const char *declarations[] =
+		{
+			"display: flex; flex-direction: column;",
+			"margin: 2px 4px; padding: 1px 3px 1px 3px;",
+			"border: 1px solid #c0c0c0; border-radius: 3px;",
+			"background: #f0f0f0 url(images/button_normal.png) no-repeat left top;",
+			"font: bold 11px/1.5 Tahoma, \"Segoe UI\", sans-serif; color: rgb(32,32,32);",
+			"width: 120px; height: 22px; min-width: 20%; max-height: 40em;",
+			"position: absolute; left: 10px; top: 0; z-index: 3;",
+			"text-align: center; vertical-align: middle; white-space: nowrap !important;",
+			"-clan-background-border-left: 4px; -clan-background-border-right: 4px;",
+			"/* hover state */ background-color: #FFEECC; outline: 1px dotted black;"
+		};
+		static const char *selectors[] =
+		{
+			"button", "button:hover", ".toolbar > button.pressed", "#main-window lineedit", "listview .header .column:first-child",
+			"window.dialog button", "menu menuitem:disabled", "tab tabpage .label", "lineedit[class]", "* .odd"
+		};
+
+		std::string sheet;
+		for (int i = 0; i < num_rules; i++)
+		{
+			sheet += string_format("%1, .rule%2\n{\n\t%3\n\t%4\n}\n\n", selectors[i % 10], i, declarations[i % 10], declarations[(i * 7 + 3) % 10]);
+		}
+		sheet += "@media print { button { display: none } }\n";
+		return sheet;
+	}
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
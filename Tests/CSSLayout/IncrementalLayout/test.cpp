@@ -0,0 +1,168 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <ClanLib/gl.h>
+#include <ClanLib/csslayout.h>
+using namespace clan;
+
+// Runs the same edits against two layouts. The first is laid out incrementally,
+// the second is forced to do a full relayout each time. All element boxes must match.
+class TestApp
+{
+public:
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+
+		try
+		{
+			DisplayWindowDescription desc;
+			desc.set_size(Size(800, 600), true);
+			desc.set_title("Incremental Layout Test");
+			DisplayWindow window(desc);
+			Canvas canvas(window);
+
+			CSSLayout incremental;
+			CSSLayout full;
+			incremental.load_xml("test.xml", "test.css");
+			full.load_xml("test.xml", "test.css");
+
+			Rect viewport(0, 0, 800, 600);
+			compare(canvas, incremental, full, viewport, "initial layout");
+			compare(canvas, incremental, full, viewport, "unchanged relayout");
+
+			find_element(incremental, "p", 2).get_first_child().to_text().set_text("Pack my box with five dozen liquor jugs, and then some more words to force another line break.");
+			find_element(full, "p", 2).get_first_child().to_text().set_text("Pack my box with five dozen liquor jugs, and then some more words to force another line break.");
+			compare(canvas, incremental, full, viewport, "changed text");
+
+			for (int i = 0; i < 2; i++)
+			{
+				CSSLayout &layout = (i == 0) ? incremental : full;
+				CSSLayoutElement footer = find_element(layout, "p", 4);
+				CSSLayoutText text = footer.create_text(" with appended text");
+				footer.append_child(text);
+			}
+			compare(canvas, incremental, full, viewport, "appended text");
+
+			for (int i = 0; i < 2; i++)
+			{
+				CSSLayout &layout = (i == 0) ? incremental : full;
+				CSSLayoutElement span = find_element(layout, "span", 1);
+				span.get_parent().to_element().remove_child(span);
+			}
+			compare(canvas, incremental, full, viewport, "removed inline-block");
+
+			viewport = Rect(0, 0, 500, 600);
+			compare(canvas, incremental, full, viewport, "resized viewport");
+
+			Console::write_line("All tests passed");
+		}
+		catch (Exception error)
+		{
+			Console::write_line("Exception caught:");
+			Console::write_line(error.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	void compare(Canvas &canvas, CSSLayout &incremental, CSSLayout &full, const Rect &viewport, const std::string &test_name)
+	{
+		Console::write_line(" - %1", test_name);
+
+		incremental.layout(canvas, viewport);
+		full.set_dpi(96.0f);
+		full.layout(canvas, viewport);
+
+		std::vector<CSSLayoutElement> incremental_elements = get_elements(incremental);
+		std::vector<CSSLayoutElement> full_elements = get_elements(full);
+		if (incremental_elements.size() != full_elements.size())
+			fail(test_name);
+
+		for (size_t i = 0; i < full_elements.size(); i++)
+		{
+			if (incremental_elements[i].get_name() != full_elements[i].get_name())
+				fail(test_name);
+			if (incremental_elements[i].get_content_box() != full_elements[i].get_content_box())
+				fail(test_name);
+		}
+	}
+
+	std::vector<CSSLayoutElement> get_elements(CSSLayout &layout)
+	{
+		std::vector<CSSLayoutElement> elements;
+		add_elements(layout.get_root_element(), elements);
+		return elements;
+	}
+
+	void add_elements(CSSLayoutNode node, std::vector<CSSLayoutElement> &elements)
+	{
+		if (node.is_element())
+			elements.push_back(node.to_element());
+		for (CSSLayoutNode child = node.get_first_child(); !child.is_null(); child = child.get_next_sibling())
+			add_elements(child, elements);
+	}
+
+	CSSLayoutElement find_element(CSSLayout &layout, const std::string &name, int index)
+	{
+		std::vector<CSSLayoutElement> elements = get_elements(layout);
+		for (size_t i = 0; i < elements.size(); i++)
+		{
+			if (elements[i].get_name() == name && --index == 0)
+				return elements[i];
+		}
+		throw Exception(string_format("Element %1 not found", name));
+	}
+
+	void fail(const std::string &test_name)
+	{
+		throw Exception(string_format("Incremental layout does not match full layout after %1", test_name));
+	}
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+		SetupDisplay setup_display;
+		SetupGL setup_gl;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
@@ -0,0 +1,150 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+#include <ClanLib/csslayout.h>
+using namespace clan;
+
+// Measures how fast a large synthetic theme stylesheet and a set of inline style
+// attributes are tokenized and parsed into property values.
+class TestApp
+{
+public:
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+
+		try
+		{
+			std::string sheet = create_stylesheet(4000);
+			std::vector<std::string> styles = create_inline_styles(20000);
+
+			size_t style_bytes = 0;
+			for (size_t i = 0; i < styles.size(); i++)
+				style_bytes += styles[i].size();
+
+			const int iterations = 5;
+
+			ubyte64 best_sheet_time = ~(ubyte64)0;
+			for (int i = 0; i < iterations; i++)
+			{
+				ubyte64 start = System::get_microseconds();
+				DataBuffer buffer(sheet.data(), sheet.size());
+				IODevice_Memory device(buffer);
+				CSSDocument document;
+				document.add_sheet(author_sheet_origin, device, "file:");
+				best_sheet_time = min(best_sheet_time, System::get_microseconds() - start);
+			}
+
+			ubyte64 best_style_time = ~(ubyte64)0;
+			size_t num_values = 0;
+			for (int i = 0; i < iterations; i++)
+			{
+				num_values = 0;
+				ubyte64 start = System::get_microseconds();
+				for (size_t j = 0; j < styles.size(); j++)
+					num_values += CSSStyleProperties(styles[j]).get_values().size();
+				best_style_time = min(best_style_time, System::get_microseconds() - start);
+			}
+
+			Console::write_line("Stylesheet: %1 KB in %2 ms (%3 MB/s)", (int)(sheet.size() / 1024), best_sheet_time / 1000.0, sheet.size() / (double)best_sheet_time);
+			Console::write_line("Inline styles: %1 attributes, %2 values in %3 ms (%4 MB/s)", (int)styles.size(), (int)num_values, best_style_time / 1000.0, style_bytes / (double)best_style_time);
+		}
+		catch (Exception error)
+		{
+			Console::write_line("Exception caught:");
+			Console::write_line(error.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	std::string create_stylesheet(int num_rules)
+	{
+		static const char *declarations[] =
+		{
+			"display: flex; flex-direction: column;",
+			"margin: 2px 4px; padding: 1px 3px 1px 3px;",
+			"border: 1px solid #c0c0c0; border-radius: 3px;",
+			"background: #f0f0f0 url(images/button_normal.png) no-repeat left top;",
+			"font: bold 11px/1.5 Tahoma, \"Segoe UI\", sans-serif; color: rgb(32,32,32);",
+			"width: 120px; height: 22px; min-width: 20%; max-height: 40em;",
+			"position: absolute; left: 10px; top: 0; z-index: 3;",
+			"text-align: center; vertical-align: middle; white-space: nowrap !important;",
+			"-clan-background-border-left: 4px; -clan-background-border-right: 4px;",
+			"/* hover state */ background-color: #FFEECC; outline: 1px dotted black;"
+		};
+		static const char *selectors[] =
+		{
+			"button", "button:hover", ".toolbar > button.pressed", "#main-window lineedit", "listview .header .column:first-child",
+			"window.dialog pushbutton", "menu menuitem:disabled", "tab tabpage .label", "scrollbar[orientation=vertical] .thumb", "* .odd"
+		};
+
+		std::string sheet;
+		for (int i = 0; i < num_rules; i++)
+		{
+			sheet += string_format("%1, .rule%2\n{\n\t%3\n\t%4\n}\n\n", selectors[i % 10], i, declarations[i % 10], declarations[(i * 7 + 3) % 10]);
+		}
+		return sheet;
+	}
+
+	std::vector<std::string> create_inline_styles(int count)
+	{
+		static const char *styles[] =
+		{
+			"width: 100px; height: 20px",
+			"margin-left: 4px; color: red",
+			"display: none",
+			"flex: 1 1 auto; padding: 2px",
+			"background-color: #123456; border-bottom: 1px solid #000"
+		};
+
+		std::vector<std::string> result;
+		for (int i = 0; i < count; i++)
+			result.push_back(styles[i % 5]);
+		return result;
+	}
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
@@ -0,0 +1,204 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "API/core.h"
+#include "API/application.h"
+#include "API/csslayout.h"
+#include "CSSLayout/css_resource_cache.h"
+#include <set>
+using namespace clan;
+
+#ifdef WIN32
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+// Resolves the computed styles of a list with 10 000 rows of 4 cells each and reports the
+// memory used per element and the time it takes to restyle the whole list. Siblings with
+// the same selected values share their computed style, so only a handful of styles exist.
+class TestApp
+{
+public:
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+
+		try
+		{
+			const int rows = 10000;
+			const int cells = 4;
+
+			CSSDocument document;
+			std::string sheet = create_stylesheet();
+			DataBuffer sheet_buffer(sheet.data(), sheet.size());
+			IODevice_Memory sheet_device(sheet_buffer);
+			document.add_sheet(author_sheet_origin, sheet_device, "file:");
+
+			DomDocument dom;
+			DomElement list = dom.create_element("list");
+			dom.append_child(list);
+			for (int r = 0; r < rows; r++)
+			{
+				DomElement row = dom.create_element("row");
+				row.set_attribute("class", (r == 5) ? "odd selected" : (r % 2 ? "odd" : "even"));
+				list.append_child(row);
+				for (int c = 0; c < cells; c++)
+				{
+					DomElement cell = dom.create_element("cell");
+					cell.set_attribute("class", (c == 0) ? "first" : (c == cells - 1) ? "number" : "text");
+					row.append_child(cell);
+				}
+			}
+
+			// Selection is not part of the measurement, so all elements are selected up front
+			std::vector<CSSSelectResult> selected_values;
+			std::vector<int> parents;
+			select(document, list, -1, selected_values, parents);
+			int num_elements = selected_values.size();
+
+			CSSResourceCache resource_cache;
+			std::vector<CSSComputedValues> computed_values;
+			computed_values.reserve(num_elements);
+
+			int rss_before = get_peak_rss_kb();
+			ubyte64 start = System::get_microseconds();
+			for (int i = 0; i < num_elements; i++)
+			{
+				computed_values.push_back(CSSComputedValues(&resource_cache));
+				if (parents[i] != -1)
+					computed_values[i].set_parent(computed_values[parents[i]]);
+				computed_values[i].set_specified_values(selected_values[i]);
+			}
+			computed_values[0].update_tree();
+			ubyte64 first_time = System::get_microseconds() - start;
+			int rss_after = get_peak_rss_kb();
+
+			verify(computed_values, parents, rows, cells);
+
+			const int iterations = 5;
+			ubyte64 best_time = ~(ubyte64)0;
+			for (int i = 0; i < iterations; i++)
+			{
+				// Setting the specified values of the root invalidates the style of every element
+				start = System::get_microseconds();
+				computed_values[0].set_specified_values(selected_values[0]);
+				computed_values[0].update_tree();
+				best_time = min(best_time, System::get_microseconds() - start);
+			}
+
+			std::set<const CSSComputedFont *> styles;
+			for (int i = 0; i < num_elements; i++)
+				styles.insert(&computed_values[i].get_font());
+
+			Console::write_line("Elements: %1, computed styles: %2", num_elements, (int)styles.size());
+			Console::write_line("Memory: %1 bytes per element", (int)((rss_after - rss_before) * (ubyte64)1024 / num_elements));
+			Console::write_line("First resolve: %1 ms", first_time / 1000.0);
+			Console::write_line("Restyle: %1 ms", best_time / 1000.0);
+
+			computed_values.clear();
+		}
+		catch (Exception error)
+		{
+			Console::write_line("Exception caught:");
+			Console::write_line(error.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	std::string create_stylesheet()
+	{
+		return
+			"list { display: block; font: 12px/1.4 Tahoma, sans-serif; color: black; }\n"
+			"row { display: flex; height: 20px; padding: 2px 4px; border-bottom: 1px solid #e0e0e0; }\n"
+			"row.odd { background: #f4f4f4; }\n"
+			"row.selected { background: #3399ff; color: white; }\n"
+			"cell { display: block; width: 100px; margin: 0 2px; white-space: nowrap; overflow: hidden; }\n"
+			"cell.first { font-weight: bold; }\n"
+			"cell.number { text-align: right; }\n";
+	}
+
+	void select(CSSDocument &document, DomElement element, int parent, std::vector<CSSSelectResult> &selected_values, std::vector<int> &parents)
+	{
+		int index = selected_values.size();
+		selected_values.push_back(document.select(element));
+		parents.push_back(parent);
+		for (DomNode child = element.get_first_child(); !child.is_null(); child = child.get_next_sibling())
+		{
+			if (child.is_element())
+				select(document, child.to_element(), index, selected_values, parents);
+		}
+	}
+
+	// Styles must only be shared between siblings. The cells of the selected row inherit its color.
+	void verify(std::vector<CSSComputedValues> &computed_values, const std::vector<int> &parents, int rows, int cells)
+	{
+		for (size_t i = 0; i < computed_values.size(); i++)
+		{
+			if (parents[i] <= 0)
+				continue;
+
+			int row = (parents[i] - 1) / (cells + 1);
+			Colorf expected = (row == 5) ? Colorf::white : Colorf::black;
+			if (computed_values[i].get_text_inherit().color.color != expected)
+				throw Exception(string_format("Cell %1 of row %2 has the wrong color", (int)i, row));
+		}
+	}
+
+	int get_peak_rss_kb()
+	{
+#ifdef WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+		return (int)(counters.PeakWorkingSetSize / 1024);
+#else
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		return (int)usage.ru_maxrss;
+#endif
+	}
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
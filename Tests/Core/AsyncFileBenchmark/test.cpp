@@ -0,0 +1,323 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+using namespace clan;
+
+// Checks AsyncFileIO with both backends and measures random 4 KB reads per second
+// for blocking reads and for asynchronous reads at several queue depths.
+class TestApp
+{
+public:
+	TestApp() : io(0), num_reads(0), reads_issued(0), reads_completed(0), checksum(0), random_value(0), num_blocks(0)
+	{
+	}
+
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+
+		try
+		{
+			int size_mb = 1024;
+			if (args.size() > 1)
+				size_mb = StringHelp::text_to_int(args[1]);
+
+			std::string filename = "async_file_benchmark.out";
+			create_file(filename, size_mb);
+
+			test_backend(AsyncFileIO::backend_thread_pool, filename);
+			try
+			{
+				AsyncFileIO uring(8, AsyncFileIO::backend_io_uring);
+				test_backend(AsyncFileIO::backend_io_uring, filename);
+			}
+			catch (Exception &)
+			{
+				Console::write_line("io_uring is not available, skipping it");
+			}
+
+			Console::write_line("Random 4 KB reads from a %1 MB file (served from the page cache if it fits):", size_mb);
+			ubyte32 expected = random_blocking(filename);
+			int depths[] = { 1, 8, 32, 64 };
+			for (int i = 0; i < 4; i++)
+			{
+				if (random_async(AsyncFileIO::backend_thread_pool, depths[i], filename) != expected)
+					throw Exception("Thread pool reads gave a different result");
+			}
+			for (int i = 0; i < 4; i++)
+			{
+				AsyncFileIO probe(1);
+				if (probe.get_backend() != AsyncFileIO::backend_io_uring)
+					break;
+				if (random_async(AsyncFileIO::backend_io_uring, depths[i], filename) != expected)
+					throw Exception("io_uring reads gave a different result");
+			}
+
+			FileHelp::delete_file(filename);
+		}
+		catch (Exception error)
+		{
+			Console::write_line("Exception caught:");
+			Console::write_line(error.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	enum { block_size = 4096 };
+
+	// Every 32-bit word holds its own offset divided by four
+	void create_file(const std::string &filename, int size_mb)
+	{
+		File file(filename, File::create_always, File::access_write);
+		std::vector<ubyte32> block(64 * 1024 / 4);
+		ubyte32 value = 0;
+		for (int i = 0; i < size_mb * 16; i++)
+		{
+			for (size_t j = 0; j < block.size(); j++)
+				block[j] = value++;
+			file.write(&block[0], (int)block.size() * 4);
+		}
+	}
+
+	void check_block(const std::vector<ubyte32> &block, byte64 offset)
+	{
+		for (size_t i = 0; i < block.size(); i++)
+		{
+			if (block[i] != (ubyte32)(offset / 4 + i))
+				throw Exception("Asynchronous read returned the wrong data");
+		}
+	}
+
+	void test_backend(AsyncFileIO::Backend backend, const std::string &filename)
+	{
+		File file(filename, File::open_existing, File::access_read);
+		byte64 size = file.get_size();
+
+		// A batch of reads, more than the queue depth, some of them in the same place
+		{
+			AsyncFileIO async_io(4, backend);
+			if (async_io.get_backend() != backend)
+				throw Exception("Wrong backend selected");
+
+			std::vector<std::vector<ubyte32> > blocks(16, std::vector<ubyte32>(block_size / 4));
+			std::vector<AsyncFileRequest> requests;
+			for (size_t i = 0; i < blocks.size(); i++)
+				requests.push_back(AsyncFileRequest(file, ((i * 7919) % 64) * block_size, &blocks[i][0], block_size));
+			std::vector<AsyncFileOperation> operations = async_io.read(requests);
+
+			for (size_t i = 0; i < operations.size(); i++)
+			{
+				if (operations[i].get_bytes_transferred() != block_size)
+					throw Exception("Asynchronous read was short");
+				check_block(blocks[i], requests[i].offset);
+			}
+
+			async_io.wait_all();
+			if (async_io.get_pending_count() != 0)
+				throw Exception("Operations still pending after wait_all");
+		}
+
+		// Completion callbacks from KeepAlive, a read past the end, and a read from a file opened for writing
+		{
+			AsyncFileIO async_io(2, backend);
+			std::vector<ubyte32> block(block_size / 4);
+			File write_only("async_file_benchmark_write.out", File::create_always, File::access_write);
+
+			AsyncFileOperation tail = async_io.read(file, size - 100, &block[0], block_size);
+			AsyncFileOperation failed = async_io.read(write_only, 0, &block[0], block_size);
+			tail.func_completed().set(this, &TestApp::on_test_completed);
+			failed.func_completed().set(this, &TestApp::on_test_completed);
+			async_io.submit();
+
+			reads_completed = 0;
+			ubyte64 start = System::get_time();
+			while (reads_completed < 2)
+			{
+				KeepAlive::process(100);
+				if (System::get_time() - start > 10000)
+					throw Exception("Completion callbacks were not invoked");
+			}
+
+			if (tail.get_bytes_transferred() != 100)
+				throw Exception("Read past the end of the file was not short");
+			if (!failed.is_failed() || failed.get_error_code() == 0)
+				throw Exception("Read from a write only file did not fail");
+		}
+
+		// Writes at explicit offsets, read back through File
+		{
+			std::string write_filename = "async_file_benchmark_write.out";
+			File write_file(write_filename, File::create_always, File::access_read_write);
+			std::vector<std::vector<ubyte32> > blocks(8, std::vector<ubyte32>(block_size / 4));
+			{
+				AsyncFileIO async_io(8, backend);
+				for (size_t i = 0; i < blocks.size(); i++)
+				{
+					byte64 offset = (blocks.size() - 1 - i) * block_size;
+					for (size_t j = 0; j < blocks[i].size(); j++)
+						blocks[i][j] = (ubyte32)(offset / 4 + j);
+					async_io.write(write_file, offset, &blocks[i][0], block_size);
+				}
+				async_io.wait_all();
+			}
+
+			std::vector<ubyte32> block(block_size / 4);
+			for (size_t i = 0; i < blocks.size(); i++)
+			{
+				write_file.seek(i * block_size);
+				write_file.read(&block[0], block_size);
+				check_block(block, i * block_size);
+			}
+			write_file.close();
+			FileHelp::delete_file(write_filename);
+		}
+
+		Console::write_line("%1 backend: OK", backend == AsyncFileIO::backend_io_uring ? "io_uring" : "Thread pool");
+	}
+
+	void on_test_completed(AsyncFileOperation &operation)
+	{
+		reads_completed++;
+	}
+
+	byte64 next_offset()
+	{
+		random_value = random_value * 1664525 + 1013904223;
+		return (random_value % num_blocks) * block_size;
+	}
+
+	ubyte32 random_blocking(const std::string &filename)
+	{
+		File file(filename, File::open_existing, File::access_read, File::share_all, File::flag_random_access);
+		num_blocks = file.get_size() / block_size;
+		num_reads = 200000;
+		random_value = 12345;
+		checksum = 0;
+
+		std::vector<ubyte32> block(block_size / 4);
+		ubyte64 start = System::get_microseconds();
+		for (int i = 0; i < num_reads; i++)
+		{
+			byte64 offset = next_offset();
+			file.seek(offset);
+			if (file.read(&block[0], block_size) != block_size || block[0] != offset / 4)
+				throw Exception("Blocking read failed");
+			checksum += block[0];
+		}
+		report("Blocking read", 1, System::get_microseconds() - start);
+		return checksum;
+	}
+
+	// Keeps up to queue_depth reads in flight, queueing a new read from each completion callback
+	ubyte32 random_async(AsyncFileIO::Backend backend, int queue_depth, const std::string &filename)
+	{
+		File file(filename, File::open_existing, File::access_read, File::share_all, File::flag_random_access);
+		num_blocks = file.get_size() / block_size;
+		num_reads = 200000;
+		random_value = 12345;
+		checksum = 0;
+		reads_issued = 0;
+		reads_completed = 0;
+
+		AsyncFileIO async_io(queue_depth, backend);
+		io = &async_io;
+		random_file = file;
+		std::vector<std::vector<ubyte32> > blocks(queue_depth, std::vector<ubyte32>(block_size / 4));
+
+		ubyte64 start = System::get_microseconds();
+		for (int i = 0; i < queue_depth; i++)
+			issue_read(&blocks[i][0]);
+		async_io.submit();
+		while (reads_completed < num_reads)
+		{
+			// Callbacks queue the next reads, which go to the backend together
+			KeepAlive::process(-1);
+			async_io.submit();
+		}
+		ubyte64 time = System::get_microseconds() - start;
+
+		report(backend == AsyncFileIO::backend_io_uring ? "io_uring" : "Thread pool", queue_depth, time);
+		io = 0;
+		random_file = File();
+		return checksum;
+	}
+
+	void issue_read(void *buffer)
+	{
+		AsyncFileOperation operation = io->read(random_file, next_offset(), buffer, block_size);
+		operation.func_completed().set(this, &TestApp::on_random_read_completed);
+		reads_issued++;
+	}
+
+	void on_random_read_completed(AsyncFileOperation &operation)
+	{
+		const AsyncFileRequest &request = operation.get_request();
+		const ubyte32 *values = (const ubyte32 *)request.buffer;
+		if (operation.get_bytes_transferred() != block_size || values[0] != request.offset / 4)
+			throw Exception("Asynchronous random read failed");
+		checksum += values[0];
+		reads_completed++;
+
+		if (reads_issued < num_reads)
+			issue_read(request.buffer);
+	}
+
+	void report(const std::string &title, int queue_depth, ubyte64 time)
+	{
+		Console::write_line("  %1, queue depth %2: %3 ms (%4 reads/s)", title, queue_depth, (int)(time / 1000), (int)(num_reads * 1000000.0 / std::max(time, (ubyte64)1)));
+	}
+
+	AsyncFileIO *io;
+	File random_file;
+	int num_reads;
+	int reads_issued;
+	int reads_completed;
+	ubyte32 checksum;
+	ubyte32 random_value;
+	byte64 num_blocks;
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
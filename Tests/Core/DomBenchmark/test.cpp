@@ -0,0 +1,167 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+using namespace clan;
+
+#ifdef WIN32
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+// Loads a large synthetic XML export into a DomDocument and reports parse time,
+// peak memory and the time it takes to walk the resulting tree.
+class TestApp
+{
+public:
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+
+		try
+		{
+			int megabytes = 64;
+			if (args.size() > 1)
+				megabytes = StringHelp::text_to_int(args[1]);
+
+			std::string filename = "dom_benchmark.xml";
+			ubyte64 file_size = create_document(filename, megabytes);
+			int rss_before = get_peak_rss_kb();
+			Console::write_line("Document: %1 MB, peak RSS before loading: %2 MB", (int)(file_size / (1024*1024)), rss_before / 1024);
+
+			ubyte64 start = System::get_microseconds();
+			File file(filename);
+			DomDocument document(file);
+			file.close();
+			ubyte64 load_time = System::get_microseconds() - start;
+			int rss_after = get_peak_rss_kb();
+
+			start = System::get_microseconds();
+			int num_nodes = 0;
+			int num_attributes = 0;
+			size_t text_length = 0;
+			walk(document, num_nodes, num_attributes, text_length);
+			ubyte64 walk_time = System::get_microseconds() - start;
+
+			Console::write_line("Load: %1 ms (%2 MB/s), peak RSS %3 MB (%4 bytes per node)", (int)(load_time / 1000), file_size / (double)load_time, rss_after / 1024, (int)((rss_after - rss_before) * 1024.0 / (num_nodes + num_attributes)));
+			Console::write_line("Walk: %1 nodes, %2 attributes, %3 KB text in %4 ms", num_nodes, num_attributes, (int)(text_length / 1024), (int)(walk_time / 1000));
+
+			DomElement object = document.get_document_element().get_first_child_element();
+			if (object.get_attribute("flags") != "solid|static" || object.get_first_child_element().get_text() != "Crate & barrel #0")
+				throw Exception("Document content does not match the source");
+
+			FileHelp::delete_file(filename);
+		}
+		catch (Exception error)
+		{
+			Console::write_line("Exception caught:");
+			Console::write_line(error.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	void walk(const DomNode &node, int &num_nodes, int &num_attributes, size_t &text_length)
+	{
+		num_nodes++;
+		if (node.is_element())
+		{
+			DomNamedNodeMap attributes = node.get_attributes();
+			num_attributes += attributes.get_length();
+		}
+		else if (node.is_text())
+		{
+			text_length += node.get_node_value().length();
+		}
+
+		for (DomNode child = node.get_first_child(); !child.is_null(); child = child.get_next_sibling())
+			walk(child, num_nodes, num_attributes, text_length);
+	}
+
+	ubyte64 create_document(const std::string &filename, int megabytes)
+	{
+		File file(filename, File::create_always, File::access_write);
+
+		std::string header = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<resources xmlns=\"http://clanlib.org/xmlns/resources-1.0\">\n";
+		file.write(header.data(), header.size());
+		ubyte64 file_size = header.size();
+
+		std::string chunk;
+		int index = 0;
+		while (file_size < (ubyte64)megabytes * 1024 * 1024)
+		{
+			chunk.clear();
+			for (int i = 0; i < 1000; i++, index++)
+			{
+				chunk += string_format("\t<object id=\"%1\" type=\"prop\" x=\"%2\" y=\"%3\" flags='solid|static'>", index, index % 4096, index / 4096);
+				chunk += string_format("<name>Crate &amp; barrel #%1</name>", index);
+				chunk += "<transform rotation=\"0.25\" scale=\"1.0 1.0 1.0\"/>";
+				chunk += "<!-- generated --></object>\n";
+			}
+			file.write(chunk.data(), chunk.size());
+			file_size += chunk.size();
+		}
+
+		std::string footer = "</resources>\n";
+		file.write(footer.data(), footer.size());
+		return file_size + footer.size();
+	}
+
+	int get_peak_rss_kb()
+	{
+#ifdef WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+		return (int)(counters.PeakWorkingSetSize / 1024);
+#else
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		return (int)usage.ru_maxrss;
+#endif
+	}
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
@@ -0,0 +1,236 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+using namespace clan;
+
+// Counts the calls that reach a device. For a File each call is a system call.
+class CountingProvider : public IODeviceProvider
+{
+public:
+	CountingProvider(IODevice device, int &calls) : device(device), calls(calls) { }
+
+	byte64 get_size() const { return device.get_size(); }
+	byte64 get_position() const { calls++; return device.get_position(); }
+	int send(const void *data, int len, bool send_all) { calls++; return device.send(data, len, send_all); }
+	int receive(void *data, int len, bool receive_all) { calls++; return device.receive(data, len, receive_all); }
+	int peek(void *data, int len) { calls++; return device.peek(data, len); }
+	bool seek(byte64 position, IODevice::SeekMode mode) { calls++; return device.seek(position, mode); }
+	IODeviceProvider *duplicate() { return new CountingProvider(device.duplicate(), calls); }
+
+private:
+	IODevice device;
+	int &calls;
+};
+
+// Loads collision outline style assets (a header followed by contours of float
+// coordinates) field by field from a File, through IODevice_Buffered, and with
+// the bulk array readers, and reports device calls and time per asset.
+class TestApp
+{
+public:
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+
+		try
+		{
+			int num_assets = 50;
+			if (args.size() > 1)
+				num_assets = StringHelp::text_to_int(args[1]);
+
+			test_buffered_device();
+
+			std::vector<std::string> filenames;
+			for (int i = 0; i < num_assets; i++)
+			{
+				filenames.push_back(string_format("iodevice_benchmark_%1.out", i));
+				save_asset(filenames.back(), 20 + i % 5, 200);
+			}
+
+			float expected = benchmark("File, read_float", filenames, false, false);
+			if (benchmark("IODevice_Buffered, read_float", filenames, true, false) != expected)
+				throw Exception("Buffered loading gave a different result");
+			if (benchmark("File, read_float_array", filenames, false, true) != expected)
+				throw Exception("Bulk loading gave a different result");
+			if (benchmark("IODevice_Buffered, read_float_array", filenames, true, true) != expected)
+				throw Exception("Buffered bulk loading gave a different result");
+
+			for (size_t i = 0; i < filenames.size(); i++)
+				FileHelp::delete_file(filenames[i]);
+		}
+		catch (Exception error)
+		{
+			Console::write_line("Exception caught:");
+			Console::write_line(error.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	float benchmark(const std::string &title, const std::vector<std::string> &filenames, bool buffered, bool bulk)
+	{
+		int calls = 0;
+		float checksum = 0.0f;
+		ubyte64 start = System::get_microseconds();
+		for (size_t i = 0; i < filenames.size(); i++)
+		{
+			IODevice device(new CountingProvider(File(filenames[i]), calls));
+			if (buffered)
+			{
+				IODevice_Buffered buffered_device(device, 4096);
+				checksum += load_asset(buffered_device, bulk);
+			}
+			else
+			{
+				checksum += load_asset(device, bulk);
+			}
+		}
+		ubyte64 time = System::get_microseconds() - start;
+
+		Console::write_line("%1: %2 device calls and %3 us per asset", title, calls / (int)filenames.size(), (int)(time / filenames.size()));
+		return checksum;
+	}
+
+	void save_asset(const std::string &filename, int num_contours, int num_points)
+	{
+		File file(filename, File::create_always, File::access_write);
+		IODevice_Buffered output(file);
+		output.write_uint32(0x16082004);
+		output.write_uint8(1);
+		output.write_int32(256);
+		output.write_int32(256);
+		output.write_float(128.0f);
+		output.write_float(128.0f);
+		output.write_float(90.5f);
+		output.write_uint32(num_contours);
+		for (int contour = 0; contour < num_contours; contour++)
+		{
+			output.write_uint32(num_points);
+			for (int point = 0; point < num_points; point++)
+			{
+				output.write_float(contour + point * 0.5f);
+				output.write_float(point * 0.25f);
+			}
+		}
+	}
+
+	float load_asset(IODevice &input, bool bulk)
+	{
+		if (input.read_uint32() != 0x16082004 || input.read_uint8() != 1)
+			throw Exception("Not an outline asset");
+
+		float checksum = (float)input.read_int32() + input.read_int32();
+		checksum += input.read_float() + input.read_float() + input.read_float();
+
+		std::vector<float> coordinates;
+		int num_contours = input.read_uint32();
+		for (int contour = 0; contour < num_contours; contour++)
+		{
+			int num_points = input.read_uint32();
+			coordinates.resize(num_points * 2);
+			if (bulk)
+			{
+				input.read_float_array(&coordinates[0], num_points * 2);
+			}
+			else
+			{
+				for (int i = 0; i < num_points * 2; i++)
+					coordinates[i] = input.read_float();
+			}
+
+			for (int i = 0; i < num_points * 2; i++)
+				checksum += coordinates[i];
+		}
+		return checksum;
+	}
+
+	void test_buffered_device()
+	{
+		IODevice_Memory memory;
+		{
+			IODevice_Buffered output(memory, 16, 16);
+			output.set_big_endian_mode();
+			for (ubyte32 i = 0; i < 100; i++)
+				output.write_uint32(i * 0x01010101);
+			ubyte32 values[3] = { 1, 2, 0xdeadbeef };
+			output.write_uint32_array(values, 3);
+			if (output.get_position() != 412 || output.get_size() != 412)
+				throw Exception("Buffered position is wrong after writing");
+		}
+		if (memory.get_size() != 412 || (unsigned char)memory.get_data().get_data()[7] != 0x01)
+			throw Exception("Buffered data was not written to the device on destruction");
+
+		memory.seek(0);
+		IODevice_Buffered input(memory, 16, 16);
+		input.set_big_endian_mode();
+
+		char peeked[40];
+		if (input.peek(peeked, 40) != 40 || memcmp(peeked, memory.get_data().get_data(), 40) != 0)
+			throw Exception("Peek failed");
+		for (ubyte32 i = 0; i < 100; i++)
+		{
+			if (input.read_uint32() != i * 0x01010101)
+				throw Exception("Buffered read returned wrong data");
+		}
+		ubyte32 values[3];
+		input.read_uint32_array(values, 3);
+		if (values[0] != 1 || values[1] != 2 || values[2] != 0xdeadbeef)
+			throw Exception("read_uint32_array returned wrong data");
+
+		input.seek(-8, IODevice::seek_cur);
+		if (input.get_position() != 404 || input.read_uint32() != 2)
+			throw Exception("Seek within the read buffer failed");
+		input.seek(8);
+		if (input.read_uint32() != 0x02020202)
+			throw Exception("Seek outside the read buffer failed");
+
+		input.write_uint32(0xcafebabe);
+		input.seek(12);
+		if (input.read_uint32() != 0xcafebabe || input.read_uint32() != 0x04040404)
+			throw Exception("Write after read went to the wrong position");
+	}
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
@@ -0,0 +1,247 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+using namespace clan;
+
+// Generates a telemetry style JSON file and measures reading and writing it with
+// JsonValue, the streaming JsonReader and JsonWriter, and JsonDocument.
+class TestApp
+{
+public:
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+
+		try
+		{
+			int num_records = 50000;
+			if (args.size() > 1)
+				num_records = StringHelp::text_to_int(args[1]);
+
+			test_conformance();
+
+			std::string json = create_json(num_records);
+			double megabytes = json.length() / (1024.0 * 1024.0);
+			Console::write_line("JSON size: %1 MB, %2 records", (int)megabytes, num_records);
+
+			ubyte64 start = System::get_microseconds();
+			JsonValue value = JsonValue::from_json(json);
+			report("JsonValue::from_json", megabytes, System::get_microseconds() - start);
+
+			start = System::get_microseconds();
+			std::string value_json = value.to_json();
+			report("JsonValue::to_json", megabytes, System::get_microseconds() - start);
+
+			start = System::get_microseconds();
+			int num_events = count_events(json);
+			report("JsonReader events", megabytes, System::get_microseconds() - start);
+
+			start = System::get_microseconds();
+			JsonDocument document = load_document(json);
+			report("JsonDocument load", megabytes, System::get_microseconds() - start);
+
+			start = System::get_microseconds();
+			std::string document_json;
+			{
+				DataBuffer buffer;
+				IODevice_Memory device(buffer);
+				document.save(device);
+				document_json.assign(device.get_data().get_data(), device.get_size());
+			}
+			report("JsonDocument save", megabytes, System::get_microseconds() - start);
+
+			start = System::get_microseconds();
+			std::string writer_json = write_json(num_records);
+			report("JsonWriter", megabytes, System::get_microseconds() - start);
+
+			if (num_events != num_records * 21 + 5)
+				throw Exception("Unexpected number of reader events");
+			if (document_json != json || writer_json != json)
+				throw Exception("Written JSON does not match the input");
+			if (JsonValue::from_json(value_json).to_json() != value_json)
+				throw Exception("JsonValue did not survive a round trip");
+			if (document.get_root()["records"][num_records - 1]["position"][1].to_double() != (num_records - 1) * 0.25 + 0.1)
+				throw Exception("JsonDocument member lookup failed");
+			if (document.to_value().to_json() != value_json)
+				throw Exception("JsonDocument::to_value does not match JsonValue");
+		}
+		catch (Exception error)
+		{
+			Console::write_line("Exception caught:");
+			Console::write_line(error.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	void report(const std::string &title, double megabytes, ubyte64 time)
+	{
+		Console::write_line("  %1: %2 ms (%3 MB/s)", title, (int)(time / 1000), (int)(megabytes * 1000000 / std::max(time, (ubyte64)1)));
+	}
+
+	void test_conformance()
+	{
+		std::string escaped = JsonValue::string(std::string("quote\" slash\\ tab\t nul", 22) + std::string(1, '\0')).to_json();
+		if (escaped != "\"quote\\\" slash\\\\ tab\\t nul\\u0000\"")
+			throw Exception("String escaping failed: " + escaped);
+
+		if (JsonValue::from_json("\"\\u00e6\\u20ac\\ud83d\\ude00\"").to_string() != "\xc3\xa6\xe2\x82\xac\xf0\x9f\x98\x80")
+			throw Exception("Unicode escapes failed");
+
+		if (!JsonValue::from_json(" [ null ] ")[0].is_null())
+			throw Exception("Null value failed");
+
+		const char *numbers[] = { "0", "-0.5", "3.14159", "1e-7", "6.02214076e23", "0.1", "123456789012345678901", "2.2250738585072014e-308", "1.7976931348623157e308" };
+		for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++)
+		{
+			double value = 0.0;
+			if (!JsonReader::parse_number(numbers[i], strlen(numbers[i]), value) || value != strtod(numbers[i], 0))
+				throw Exception(string_format("Number parsing failed: %1", numbers[i]));
+
+			std::string text;
+			JsonWriter::format_number(value, text);
+			double read_back = 0.0;
+			if (!JsonReader::parse_number(text.data(), text.length(), read_back) || read_back != value)
+				throw Exception(string_format("Number formatting failed: %1", text));
+		}
+
+		const char *invalid[] = { "", "[1,]", "{\"a\" 1}", "[01]", "[1.]", "tru", "[1] 2", "{\"a\":1", "\"\\x\"" };
+		for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+		{
+			bool thrown = false;
+			try
+			{
+				JsonValue::from_json(invalid[i]);
+			}
+			catch (JsonException &)
+			{
+				thrown = true;
+			}
+			if (!thrown)
+				throw Exception(string_format("Invalid JSON was accepted: %1", invalid[i]));
+		}
+	}
+
+	int count_events(const std::string &json)
+	{
+		DataBuffer data(json.data(), json.length());
+		IODevice_Memory device(data);
+		JsonReader reader(device);
+		int num_events = 0;
+		while (reader.next() != JsonReader::event_end)
+			num_events++;
+		return num_events;
+	}
+
+	JsonDocument load_document(const std::string &json)
+	{
+		DataBuffer data(json.data(), json.length());
+		IODevice_Memory device(data);
+		return JsonDocument(device);
+	}
+
+	std::string create_json(int num_records)
+	{
+		std::string json = "{\"records\":[";
+		for (int index = 0; index < num_records; index++)
+		{
+			if (index > 0)
+				json += ",";
+			json += string_format("{\"id\":%1,\"name\":\"sensor-%2\",\"ok\":%3,", index, index % 97, (index % 7) ? "true" : "false");
+			json += string_format("\"position\":[%1,%2,%3],", index / 4, write_double(index * 0.25 + 0.1), write_double(-index * 1.5e-3));
+			json += string_format("\"note\":%1,\"tags\":[\"a\",\"b\\n\"]}", (index % 11) ? "null" : "\"check \\\"me\\\"\"");
+		}
+		json += "]}";
+		return json;
+	}
+
+	std::string write_json(int num_records)
+	{
+		std::string json;
+		JsonWriter writer(json);
+		writer.begin_object();
+		writer.write_key("records");
+		writer.begin_array();
+		for (int index = 0; index < num_records; index++)
+		{
+			writer.begin_object();
+			writer.write_key("id");
+			writer.write_number(index);
+			writer.write_key("name");
+			writer.write_string(string_format("sensor-%1", index % 97));
+			writer.write_key("ok");
+			writer.write_boolean((index % 7) != 0);
+			writer.write_key("position");
+			writer.begin_array();
+			writer.write_number(index / 4);
+			writer.write_number(index * 0.25 + 0.1);
+			writer.write_number(-index * 1.5e-3);
+			writer.end_array();
+			writer.write_key("note");
+			if (index % 11)
+				writer.write_null();
+			else
+				writer.write_string("check \"me\"");
+			writer.write_key("tags");
+			writer.begin_array();
+			writer.write_string("a");
+			writer.write_string("b\n");
+			writer.end_array();
+			writer.end_object();
+		}
+		writer.end_array();
+		writer.end_object();
+		return json;
+	}
+
+	std::string write_double(double value)
+	{
+		std::string text;
+		JsonWriter::format_number(value, text);
+		return text;
+	}
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
@@ -0,0 +1,208 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+using namespace clan;
+
+// Checks the LogQueue drop and wait policies, and measures how long log_event takes
+// for the calling thread with and without a LogQueue.
+class TestApp
+{
+public:
+	TestApp() : events_per_thread(0)
+	{
+	}
+
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+
+		try
+		{
+			test_wait_for_space();
+			test_drop_event();
+
+			Console::write_line("Caller side cost per log_event call, logging to a FileLogger:");
+			int thread_counts[] = { 1, 4 };
+			for (int i = 0; i < 2; i++)
+			{
+				benchmark("Synchronous", thread_counts[i], false, LogQueue::drop_event);
+				benchmark("LogQueue, drop event", thread_counts[i], true, LogQueue::drop_event);
+				benchmark("LogQueue, wait for space", thread_counts[i], true, LogQueue::wait_for_space);
+			}
+		}
+		catch (Exception error)
+		{
+			Console::write_line("Exception caught:");
+			Console::write_line(error.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	void producer_main(int thread_index)
+	{
+		std::string name = "producer";
+		for (int i = 0; i < events_per_thread; i++)
+			log_event("test", "%1 %2 event %3 value %4", name, thread_index, i, i * 0.5);
+	}
+
+	void run_producers(int num_threads)
+	{
+		std::vector<Thread> threads(num_threads);
+		for (int i = 0; i < num_threads; i++)
+			threads[i].start(this, &TestApp::producer_main, i);
+		for (int i = 0; i < num_threads; i++)
+			threads[i].join();
+	}
+
+	void remove_file(const std::string &filename)
+	{
+		if (FileHelp::file_exists(filename))
+			FileHelp::delete_file(filename);
+	}
+
+	std::vector<std::string> read_lines(const std::string &filename)
+	{
+		std::vector<std::string> lines = StringHelp::split_text(File::read_text(filename), "\n");
+		FileHelp::delete_file(filename);
+		return lines;
+	}
+
+	// A small queue that is often full, so that the producers have to wait. Nothing may be lost.
+	void test_wait_for_space()
+	{
+		const int num_threads = 4;
+		events_per_thread = 10000;
+		std::string filename = "log_queue_benchmark.log";
+		{
+			remove_file(filename);
+			FileLogger logger(filename);
+			LogQueue queue(64, LogQueue::wait_for_space, 10);
+			run_producers(num_threads);
+			queue.flush();
+
+			if (queue.get_queued_count() != num_threads * events_per_thread || queue.get_written_count() != queue.get_queued_count() || queue.get_dropped_count() != 0)
+				throw Exception("Wait for space policy lost events");
+			Console::write_line("Wait for space: %1 events written in %2 batches", queue.get_written_count(), queue.get_batch_count());
+		}
+
+		std::vector<std::string> lines = read_lines(filename);
+		if ((int)lines.size() != num_threads * events_per_thread)
+			throw Exception("Log file does not have one line per event");
+
+		// Events of one thread stay in order, and are formatted like log_event without a queue does it
+		std::vector<int> next_event(num_threads, 0);
+		for (size_t i = 0; i < lines.size(); i++)
+		{
+			std::string::size_type pos = lines[i].find("] producer ");
+			if (pos == std::string::npos)
+				throw Exception("Unexpected log line: " + lines[i]);
+			std::vector<std::string> words = StringHelp::split_text(lines[i].substr(pos + 2), " ");
+			int thread_index = StringHelp::text_to_int(words[1]);
+			int event = StringHelp::text_to_int(words[3]);
+			if (event != next_event[thread_index]++)
+				throw Exception("Events of a thread were reordered");
+			if (lines[i].substr(pos + 2) != string_format("producer %1 event %2 value %3", thread_index, event, event * 0.5))
+				throw Exception("Unexpected log line: " + lines[i]);
+		}
+	}
+
+	// A queue that is not emptied while one thread logs many events, so most of them are dropped
+	void test_drop_event()
+	{
+		std::string filename = "log_queue_benchmark.log";
+		events_per_thread = 1000;
+		int written;
+		{
+			remove_file(filename);
+			FileLogger logger(filename);
+			LogQueue queue(16, LogQueue::drop_event, 1000);
+			run_producers(1);
+			queue.flush();
+
+			if (queue.get_dropped_count() == 0 || queue.get_queued_count() + queue.get_dropped_count() != events_per_thread)
+				throw Exception("Drop policy counters are wrong");
+			if (queue.get_written_count() != queue.get_queued_count())
+				throw Exception("Queued events were not written");
+			written = queue.get_written_count();
+			Console::write_line("Drop event: %1 events written, %2 dropped", written, queue.get_dropped_count());
+		}
+
+		if ((int)read_lines(filename).size() != written)
+			throw Exception("Log file does not have one line per written event");
+	}
+
+	void benchmark(const std::string &title, int num_threads, bool use_queue, LogQueue::FullPolicy policy)
+	{
+		std::string filename = "log_queue_benchmark.log";
+		events_per_thread = 100000;
+		remove_file(filename);
+		FileLogger logger(filename);
+
+		std::unique_ptr<LogQueue> queue;
+		if (use_queue)
+			queue.reset(new LogQueue(1 << 16, policy));
+
+		ubyte64 start = System::get_microseconds();
+		run_producers(num_threads);
+		ubyte64 time = System::get_microseconds() - start;
+
+		int dropped = 0;
+		if (queue.get())
+		{
+			queue->flush();
+			dropped = queue->get_dropped_count();
+		}
+		queue.reset();
+
+		int calls = num_threads * events_per_thread;
+		Console::write_line("  %1, %2 threads: %3 ns per call (%4 dropped)", title, num_threads, (int)(time * 1000 / calls), dropped);
+		FileHelp::delete_file(filename);
+	}
+
+	int events_per_thread;
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
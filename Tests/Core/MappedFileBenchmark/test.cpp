@@ -0,0 +1,209 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+using namespace clan;
+
+// Reads a large file sequentially and at random offsets with normal file reads,
+// with reads from a memory mapped file, and directly from the mapping.
+class TestApp
+{
+public:
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+
+		try
+		{
+			int size_mb = 256;
+			if (args.size() > 1)
+				size_mb = StringHelp::text_to_int(args[1]);
+
+			std::string filename = "mapped_file_benchmark.out";
+			create_file(filename, size_mb);
+			test_large_offsets("mapped_file_benchmark_sparse.out");
+
+			ubyte32 expected = sequential("Sequential, read", filename, File::flag_sequential_scan, false);
+			if (sequential("Sequential, mapped read", filename, File::flag_sequential_scan | File::flag_memory_mapped, false) != expected)
+				throw Exception("Mapped sequential read gave a different result");
+			if (sequential("Sequential, mapped view", filename, File::flag_sequential_scan | File::flag_memory_mapped, true) != expected)
+				throw Exception("Mapped sequential view gave a different result");
+
+			expected = random("Random, read", filename, File::flag_random_access, false);
+			if (random("Random, mapped read", filename, File::flag_random_access | File::flag_memory_mapped, false) != expected)
+				throw Exception("Mapped random read gave a different result");
+			if (random("Random, mapped view", filename, File::flag_random_access | File::flag_memory_mapped, true) != expected)
+				throw Exception("Mapped random view gave a different result");
+
+			FileHelp::delete_file(filename);
+		}
+		catch (Exception error)
+		{
+			Console::write_line("Exception caught:");
+			Console::write_line(error.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	void create_file(const std::string &filename, int size_mb)
+	{
+		File file(filename, File::create_always, File::access_write);
+		std::vector<ubyte32> block(64 * 1024 / 4);
+		ubyte32 value = 1;
+		for (int i = 0; i < size_mb * 16; i++)
+		{
+			for (size_t j = 0; j < block.size(); j++)
+			{
+				value = value * 1664525 + 1013904223;
+				block[j] = value;
+			}
+			file.write(&block[0], (int)block.size() * 4);
+		}
+	}
+
+	ubyte32 sequential(const std::string &title, const std::string &filename, unsigned int flags, bool view)
+	{
+		ubyte64 start = System::get_microseconds();
+		File file(filename, File::open_existing, File::access_read, File::share_all, flags);
+		byte64 size = file.get_size();
+
+		ubyte32 checksum = 0;
+		if (view)
+		{
+			const ubyte32 *data = reinterpret_cast<const ubyte32 *>(file.get_mapped_data());
+			if (data == 0)
+				throw Exception("File was not memory mapped");
+			for (byte64 i = 0; i < size / 4; i++)
+				checksum += data[i];
+		}
+		else
+		{
+			std::vector<ubyte32> block(64 * 1024 / 4);
+			while (true)
+			{
+				int received = file.read(&block[0], (int)block.size() * 4);
+				if (received <= 0)
+					break;
+				for (int i = 0; i < received / 4; i++)
+					checksum += block[i];
+			}
+		}
+
+		report(title, (double)size, System::get_microseconds() - start);
+		return checksum;
+	}
+
+	ubyte32 random(const std::string &title, const std::string &filename, unsigned int flags, bool view)
+	{
+		const int num_reads = 200000;
+		const int read_size = 4096;
+
+		ubyte64 start = System::get_microseconds();
+		File file(filename, File::open_existing, File::access_read, File::share_all, flags);
+		byte64 num_blocks = file.get_size() / read_size;
+		const char *data = file.get_mapped_data();
+		if (view && data == 0)
+			throw Exception("File was not memory mapped");
+
+		ubyte32 checksum = 0;
+		ubyte32 value = 12345;
+		std::vector<ubyte32> block(read_size / 4);
+		for (int i = 0; i < num_reads; i++)
+		{
+			value = value * 1664525 + 1013904223;
+			byte64 offset = (value % num_blocks) * read_size;
+
+			const ubyte32 *values;
+			if (view)
+			{
+				values = reinterpret_cast<const ubyte32 *>(data + offset);
+			}
+			else
+			{
+				file.seek(offset);
+				if (file.read(&block[0], read_size) != read_size)
+					throw Exception("Random read failed");
+				values = &block[0];
+			}
+
+			for (int j = 0; j < read_size / 4; j += 16)
+				checksum += values[j];
+		}
+
+		report(title, (double)num_reads * read_size, System::get_microseconds() - start);
+		return checksum;
+	}
+
+	void report(const std::string &title, double bytes, ubyte64 time)
+	{
+		Console::write_line("%1: %2 ms (%3 MB/s)", title, (int)(time / 1000), (int)(bytes * 1000000 / (1024.0 * 1024.0) / std::max(time, (ubyte64)1)));
+	}
+
+	// Positions and sizes past 4 GB, using a sparse file
+	void test_large_offsets(const std::string &filename)
+	{
+		const byte64 offset = ((byte64)5) << 30;
+		{
+			File file(filename, File::create_always, File::access_write);
+			if (!file.seek(offset))
+				throw Exception("Unable to seek past 4 GB");
+			file.write_uint32(0x12345678);
+			if (file.get_position() != offset + 4)
+				throw Exception("Position past 4 GB is wrong");
+		}
+
+		File file(filename, File::open_existing, File::access_read, File::share_all, File::flag_memory_mapped);
+		if (file.get_size() != offset + 4)
+			throw Exception("Size past 4 GB is wrong");
+		file.seek(-4, File::seek_end);
+		if (file.get_position() != offset || file.read_uint32() != 0x12345678)
+			throw Exception("Reading past 4 GB failed");
+		file.close();
+
+		FileHelp::delete_file(filename);
+	}
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
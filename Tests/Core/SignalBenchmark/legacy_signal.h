@@ -0,0 +1,167 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+// The shared_ptr based Signal_v1 and Callback_v1 that ClanLib used before the callbacks
+// got inline storage, trimmed down to what the benchmark needs.
+namespace legacy
+{
+
+class SlotCallback
+{
+public:
+	SlotCallback() : valid(true), enabled(true) { }
+	virtual ~SlotCallback() { }
+	bool valid;
+	bool enabled;
+};
+
+class Slot_Impl
+{
+public:
+	~Slot_Impl() { if (callback) callback->valid = false; }
+	std::shared_ptr<SlotCallback> callback;
+};
+
+class Signal_Impl
+{
+public:
+	std::vector< std::shared_ptr<SlotCallback> > connected_slots;
+};
+
+class Slot
+{
+public:
+	Slot() { }
+	Slot(const std::shared_ptr<SlotCallback> &callback) : impl(new Slot_Impl) { impl->callback = callback; }
+	void destroy() { if (impl && impl->callback) impl->callback->valid = false; }
+	std::shared_ptr<Slot_Impl> impl;
+};
+
+template <class Param1>
+class SlotCallback_v1 : public SlotCallback
+{
+public:
+	virtual void invoke(Param1 param1) = 0;
+};
+
+template <class Param1, class InstanceClass>
+class SlotCallback_v1_member : public SlotCallback_v1<Param1>
+{
+public:
+	SlotCallback_v1_member(InstanceClass *instance, void (InstanceClass::*member_func)(Param1))
+	: instance(instance), member_func(member_func) { }
+	void invoke(Param1 param1) { (instance->*member_func)(param1); }
+	InstanceClass *instance;
+	void (InstanceClass::*member_func)(Param1);
+};
+
+template <class Param1>
+class Signal_v1
+{
+public:
+	Signal_v1() : impl(new Signal_Impl) { }
+
+	template<class InstanceClass>
+	Slot connect(InstanceClass *instance, void (InstanceClass::*function)(Param1))
+	{
+		clean_up();
+		std::shared_ptr<SlotCallback> callback(new SlotCallback_v1_member<Param1, InstanceClass>(instance, function));
+		impl->connected_slots.push_back(callback);
+		return Slot(callback);
+	}
+
+	void invoke(Param1 param1) const
+	{
+		std::vector< std::shared_ptr<SlotCallback> > callbacks = impl->connected_slots;
+		std::vector< std::shared_ptr<SlotCallback> >::size_type i, size;
+		size = callbacks.size();
+		for (i = 0; i < size; i++)
+			if (callbacks[i]->valid && callbacks[i]->enabled)
+				((SlotCallback_v1<Param1> *) callbacks[i].get())->invoke(param1);
+	}
+
+private:
+	void clean_up()
+	{
+		std::vector< std::shared_ptr<SlotCallback> >::size_type i, size;
+		size = impl->connected_slots.size();
+		for (i = 0; i < size; i++)
+		{
+			if (!impl->connected_slots[i]->valid)
+			{
+				impl->connected_slots.erase(impl->connected_slots.begin()+i);
+				i--;
+				size--;
+			}
+		}
+	}
+
+	std::shared_ptr<Signal_Impl> impl;
+};
+
+template <typename P1>
+class Callback_Impl_v1
+{
+public:
+	virtual ~Callback_Impl_v1() { }
+	virtual void invoke(P1 p1) const = 0;
+};
+
+template <typename P1, typename InstanceClass>
+class Callback_Impl_v1_member : public Callback_Impl_v1<P1>
+{
+public:
+	Callback_Impl_v1_member(InstanceClass *instance, void (InstanceClass::*member_func)(P1))
+	: instance(instance), member_func(member_func) { }
+	void invoke(P1 p1) const { (instance->*member_func)(p1); }
+	InstanceClass *instance;
+	void (InstanceClass::*member_func)(P1);
+};
+
+template <typename P1>
+class Callback_v1
+{
+public:
+	Callback_v1() { }
+
+	template<class InstanceClass>
+	Callback_v1(InstanceClass *instance, void (InstanceClass::*function)(P1))
+	: impl(new Callback_Impl_v1_member<P1, InstanceClass>(instance, function)) { }
+
+	void invoke(P1 p1) const { impl->invoke(p1); }
+
+private:
+	std::shared_ptr< Callback_Impl_v1<P1> > impl;
+};
+
+}
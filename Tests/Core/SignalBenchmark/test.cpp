@@ -0,0 +1,242 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+#include "legacy_signal.h"
+using namespace clan;
+
+class Receiver
+{
+public:
+	Receiver() : sum(0) { }
+	void on_event(int value) { sum += value; }
+	int sum;
+};
+
+// Measures connect, invoke and disconnect of Signal_v1 and Callback_v1, and compares
+// them with the previous shared_ptr based implementation in legacy_signal.h.
+class TestApp
+{
+public:
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+
+		try
+		{
+			test_invoke_reentrancy();
+
+			Console::write_line("Connect, 1000 slots:");
+			report("  legacy", bench_connect<legacy::Signal_v1<int>, legacy::Slot>(1000));
+			report("  current", bench_connect<Signal_v1<int>, Slot>(1000));
+
+			Console::write_line("Disconnect, 1000 slots:");
+			report("  legacy", bench_disconnect<legacy::Signal_v1<int>, legacy::Slot>(1000));
+			report("  current", bench_disconnect<Signal_v1<int>, Slot>(1000));
+
+			Console::write_line("Connect and disconnect with 100 other slots connected:");
+			report("  legacy", bench_churn<legacy::Signal_v1<int>, legacy::Slot>(100));
+			report("  current", bench_churn<Signal_v1<int>, Slot>(100));
+
+			Console::write_line("Invoke, 1 slot:");
+			report("  legacy", bench_invoke<legacy::Signal_v1<int>, legacy::Slot>(1));
+			report("  current", bench_invoke<Signal_v1<int>, Slot>(1));
+
+			Console::write_line("Invoke, 10 slots:");
+			report("  legacy", bench_invoke<legacy::Signal_v1<int>, legacy::Slot>(10));
+			report("  current", bench_invoke<Signal_v1<int>, Slot>(10));
+
+			Console::write_line("Callback construct and invoke:");
+			report("  legacy", bench_callback<legacy::Callback_v1<int> >());
+			report("  current", bench_callback<Callback_v1<int> >());
+		}
+		catch (Exception error)
+		{
+			Console::write_line("Exception caught:");
+			Console::write_line(error.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	template<class SignalType, class SlotType>
+	double bench_connect(int num_slots)
+	{
+		const int iterations = 200;
+		Receiver receiver;
+		ubyte64 start = System::get_microseconds();
+		for (int i = 0; i < iterations; i++)
+		{
+			SignalType signal;
+			std::vector<SlotType> slots;
+			slots.reserve(num_slots);
+			for (int j = 0; j < num_slots; j++)
+				slots.push_back(signal.connect(&receiver, &Receiver::on_event));
+		}
+		return (System::get_microseconds() - start) * 1000.0 / ((double)iterations * num_slots);
+	}
+
+	// Drops the slots in connect order and connects one more slot, so that an implementation
+	// that removes disconnected slots lazily pays for it too.
+	template<class SignalType, class SlotType>
+	double bench_disconnect(int num_slots)
+	{
+		const int iterations = 200;
+		Receiver receiver;
+		ubyte64 total = 0;
+		for (int i = 0; i < iterations; i++)
+		{
+			SignalType signal;
+			std::vector<SlotType> slots(num_slots);
+			for (int j = 0; j < num_slots; j++)
+				slots[j] = signal.connect(&receiver, &Receiver::on_event);
+
+			ubyte64 start = System::get_microseconds();
+			for (int j = 0; j < num_slots; j++)
+				slots[j] = SlotType();
+			SlotType last = signal.connect(&receiver, &Receiver::on_event);
+			total += System::get_microseconds() - start;
+		}
+		return total * 1000.0 / ((double)iterations * num_slots);
+	}
+
+	template<class SignalType, class SlotType>
+	double bench_churn(int num_other_slots)
+	{
+		const int iterations = 100000;
+		Receiver receiver;
+		SignalType signal;
+		std::vector<SlotType> slots;
+		for (int i = 0; i < num_other_slots; i++)
+			slots.push_back(signal.connect(&receiver, &Receiver::on_event));
+
+		ubyte64 start = System::get_microseconds();
+		for (int i = 0; i < iterations; i++)
+		{
+			SlotType slot = signal.connect(&receiver, &Receiver::on_event);
+		}
+		return (System::get_microseconds() - start) * 1000.0 / iterations;
+	}
+
+	template<class SignalType, class SlotType>
+	double bench_invoke(int num_slots)
+	{
+		const int iterations = 2000000 / num_slots;
+		Receiver receiver;
+		SignalType signal;
+		std::vector<SlotType> slots;
+		for (int i = 0; i < num_slots; i++)
+			slots.push_back(signal.connect(&receiver, &Receiver::on_event));
+
+		ubyte64 start = System::get_microseconds();
+		for (int i = 0; i < iterations; i++)
+			signal.invoke(i);
+		double time = (System::get_microseconds() - start) * 1000.0 / iterations;
+		if (receiver.sum == 12345)
+			Console::write_line("");
+		return time;
+	}
+
+	template<class CallbackType>
+	double bench_callback()
+	{
+		const int iterations = 2000000;
+		Receiver receiver;
+		ubyte64 start = System::get_microseconds();
+		for (int i = 0; i < iterations; i++)
+		{
+			CallbackType callback(&receiver, &Receiver::on_event);
+			callback.invoke(i);
+		}
+		double time = (System::get_microseconds() - start) * 1000.0 / iterations;
+		if (receiver.sum == 12345)
+			Console::write_line("");
+		return time;
+	}
+
+	void report(const std::string &title, double nanoseconds)
+	{
+		Console::write_line("%1: %2 ns", title, (int)(nanoseconds + 0.5));
+	}
+
+	// Slots disconnected or connected by a callback, and deleting the signal from a callback
+	void test_invoke_reentrancy()
+	{
+		ReentrancyTest test;
+		test.signal = new Signal_v1<int>();
+		test.slot_disconnect = test.signal->connect(&test, &ReentrancyTest::disconnect_next);
+		test.slot_next = test.signal->connect(&test, &ReentrancyTest::count);
+		test.slot_connect = test.signal->connect(&test, &ReentrancyTest::connect_another);
+
+		test.signal->invoke(1);
+		if (test.counter != 0)
+			throw Exception("Disconnected slot was invoked");
+		test.signal->invoke(1);
+		if (test.counter != 1)
+			throw Exception("Slot connected during invoke was not invoked afterwards");
+
+		test.slot_delete = test.signal->connect(&test, &ReentrancyTest::delete_signal);
+		test.signal->invoke(1);
+		if (test.signal != 0)
+			throw Exception("Signal was not deleted");
+	}
+
+	class ReentrancyTest
+	{
+	public:
+		ReentrancyTest() : signal(0), counter(0) { }
+
+		void disconnect_next(int) { slot_next.destroy(); }
+		void count(int value) { counter += value; }
+		void connect_another(int) { slots.push_back(signal->connect(this, &ReentrancyTest::count)); }
+		void delete_signal(int) { delete signal; signal = 0; }
+
+		Signal_v1<int> *signal;
+		Slot slot_disconnect, slot_next, slot_connect, slot_delete;
+		std::vector<Slot> slots;
+		int counter;
+	};
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
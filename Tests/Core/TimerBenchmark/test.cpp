@@ -0,0 +1,194 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+using namespace clan;
+
+// Starts, stops and destroys a million timers with timeouts spread over a minute,
+// then measures how late short timers expire through KeepAlive and a WorkQueue.
+class TestApp
+{
+public:
+	TestApp() : total_lateness(0) { }
+
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+
+		try
+		{
+			int num_timers = 1000000;
+			if (args.size() > 1)
+				num_timers = StringHelp::text_to_int(args[1]);
+
+			schedule_and_cancel(num_timers);
+			expire_keep_alive(100000, 500);
+			expire_work_queue(10000, 500);
+		}
+		catch (Exception error)
+		{
+			Console::write_line("Exception caught:");
+			Console::write_line(error.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	void schedule_and_cancel(int num_timers)
+	{
+		ubyte64 start = System::get_microseconds();
+		std::vector<Timer> timers(num_timers);
+		report("Create", num_timers, System::get_microseconds() - start);
+
+		start = System::get_microseconds();
+		ubyte32 value = 12345;
+		for (int i = 0; i < num_timers; i++)
+		{
+			value = value * 1664525 + 1013904223;
+			timers[i].start(1000 + (value >> 8) % 60000, false);
+		}
+		report("Start", num_timers, System::get_microseconds() - start);
+
+		start = System::get_microseconds();
+		for (int i = 0; i < num_timers; i++)
+			timers[i].stop();
+		report("Stop", num_timers, System::get_microseconds() - start);
+
+		for (int i = 0; i < num_timers; i++)
+		{
+			value = value * 1664525 + 1013904223;
+			timers[i].start(1000 + (value >> 8) % 60000, true);
+		}
+		start = System::get_microseconds();
+		timers.clear();
+		report("Destroy started", num_timers, System::get_microseconds() - start);
+	}
+
+	void expire_keep_alive(int num_timers, int max_timeout)
+	{
+		std::vector<Timer> timers(num_timers);
+		std::vector<ubyte64> expected(num_timers);
+		for (int i = 0; i < num_timers; i++)
+			timers[i].func_expired().set(this, &TestApp::on_expired, &expected[i]);
+
+		ubyte64 start = start_timers(timers, expected, max_timeout);
+		wait_expired(num_timers, max_timeout);
+		Console::write_line("KeepAlive, %1 timers: all expired after %2 ms, average lateness %3 ms", num_timers, (int)(System::get_time() - start), (int)(total_lateness / num_timers));
+	}
+
+	void expire_work_queue(int num_timers, int max_timeout)
+	{
+		WorkQueue work_queue(2);
+		std::vector<Timer> timers(num_timers);
+		std::vector<ubyte64> expected(num_timers);
+		for (int i = 0; i < num_timers; i++)
+		{
+			timers[i].set_work_queue(work_queue);
+			timers[i].func_expired().set(this, &TestApp::on_expired_worker, &expected[i]);
+		}
+
+		ubyte64 start = start_timers(timers, expected, max_timeout);
+		wait_expired(num_timers, max_timeout);
+		if (num_early.get() != 0)
+			throw Exception("Timer expired early");
+		Console::write_line("WorkQueue, %1 timers: all expired after %2 ms", num_timers, (int)(System::get_time() - start));
+	}
+
+	ubyte64 start_timers(std::vector<Timer> &timers, std::vector<ubyte64> &expected, int max_timeout)
+	{
+		num_expired.set(0);
+		num_early.set(0);
+		total_lateness = 0;
+
+		ubyte64 start = System::get_time();
+		ubyte32 value = 54321;
+		for (size_t i = 0; i < timers.size(); i++)
+		{
+			value = value * 1664525 + 1013904223;
+			unsigned int timeout = 1 + (value >> 8) % max_timeout;
+			expected[i] = System::get_time() + timeout;
+			timers[i].start(timeout, false);
+		}
+		return start;
+	}
+
+	void wait_expired(int num_timers, int max_timeout)
+	{
+		ubyte64 deadline = System::get_time() + max_timeout + 5000;
+		while (num_expired.get() < num_timers)
+		{
+			if (System::get_time() > deadline)
+				throw Exception(string_format("Only %1 of %2 timers expired", num_expired.get(), num_timers));
+			KeepAlive::process(10);
+		}
+	}
+
+	void on_expired(ubyte64 *expected)
+	{
+		ubyte64 time = System::get_time();
+		if (time < *expected)
+			throw Exception("Timer expired early");
+		total_lateness += time - *expected;
+		num_expired.increment();
+	}
+
+	// Exceptions cannot leave a worker thread, so early expirations are counted instead
+	void on_expired_worker(ubyte64 *expected)
+	{
+		if (System::get_time() < *expected)
+			num_early.increment();
+		num_expired.increment();
+	}
+
+	void report(const std::string &title, int count, ubyte64 time)
+	{
+		Console::write_line("%1 %2 timers: %3 ms (%4 ns per timer)", title, count, (int)(time / 1000), (int)(time * 1000 / std::max(count, 1)));
+	}
+
+	InterlockedVariable num_expired;
+	InterlockedVariable num_early;
+	ubyte64 total_lateness;
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
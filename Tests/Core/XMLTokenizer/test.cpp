@@ -0,0 +1,217 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+using namespace clan;
+
+#ifdef WIN32
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+// Writes a large synthetic XML export to disk and measures tokenizer throughput
+// and peak memory use for the view and the XMLToken interfaces.
+class TestApp
+{
+public:
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+
+		try
+		{
+			test_refill_boundaries();
+
+			int megabytes = 64;
+			if (args.size() > 1)
+				megabytes = StringHelp::text_to_int(args[1]);
+
+			std::string filename = "xml_tokenizer_benchmark.xml";
+			ubyte64 file_size = create_document(filename, megabytes);
+			Console::write_line("Document: %1 MB, peak RSS before tokenizing: %2 MB", (int)(file_size / (1024*1024)), get_peak_rss_kb() / 1024);
+
+			{
+				ubyte64 start = System::get_microseconds();
+				File file(filename);
+				XMLTokenizer tokenizer(file);
+				XMLTokenView token;
+				int num_tokens = 0;
+				while (true)
+				{
+					tokenizer.next(&token);
+					if (token.type == XMLToken::NULL_TOKEN)
+						break;
+					num_tokens++;
+				}
+				ubyte64 time = System::get_microseconds() - start;
+				Console::write_line("XMLTokenView: %1 tokens in %2 ms (%3 MB/s), peak RSS %4 MB", num_tokens, (int)(time / 1000), file_size / (double)time, get_peak_rss_kb() / 1024);
+			}
+
+			{
+				ubyte64 start = System::get_microseconds();
+				File file(filename);
+				XMLTokenizer tokenizer(file);
+				XMLToken token;
+				int num_tokens = 0;
+				while (true)
+				{
+					tokenizer.next(&token);
+					if (token.type == XMLToken::NULL_TOKEN)
+						break;
+					num_tokens++;
+				}
+				ubyte64 time = System::get_microseconds() - start;
+				Console::write_line("XMLToken: %1 tokens in %2 ms (%3 MB/s), peak RSS %4 MB", num_tokens, (int)(time / 1000), file_size / (double)time, get_peak_rss_kb() / 1024);
+			}
+
+			FileHelp::delete_file(filename);
+		}
+		catch (Exception error)
+		{
+			Console::write_line("Exception caught:");
+			Console::write_line(error.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	// Tokens must not depend on where the buffer happens to be refilled
+	void test_refill_boundaries()
+	{
+		std::string xml =
+			"\xEF\xBB\xBF<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+			"<!DOCTYPE level SYSTEM \"level.dtd\" [ <!ENTITY e \"x\"> ]>\n"
+			"<level name=\"Caves &amp; Tunnels\" id='12'>\n"
+			"\t<!-- spawn points &lt;here&gt; -->\n"
+			"\t<spawn x=\"1\" y=\"2\" label=\"a &gt; b\"/>\n"
+			"\t<script><![CDATA[if (a < b && c > d) run();]]></script>\n"
+			"\t<text>5 &lt; 6 &quot;quoted&quot; &apos;single&apos;</text>\n"
+			"\t<empty></empty>\n"
+			"</level>\n";
+
+		std::vector<XMLToken> expected = tokenize(xml, 64*1024);
+		if (expected.size() != 14)
+			throw Exception(string_format("Expected 14 tokens, got %1", (int)expected.size()));
+		if (expected[2].attributes[0].second != "Caves & Tunnels" || expected[3].value != "spawn points <here>" || expected[6].value != "if (a < b && c > d) run();")
+			throw Exception("Entities were not decoded correctly");
+
+		for (int buffer_size = 16; buffer_size < 64; buffer_size++)
+		{
+			std::vector<XMLToken> tokens = tokenize(xml, buffer_size);
+			if (tokens.size() != expected.size())
+				throw Exception(string_format("Token count differs with buffer size %1", buffer_size));
+			for (size_t i = 0; i < tokens.size(); i++)
+			{
+				if (tokens[i].type != expected[i].type || tokens[i].variant != expected[i].variant || tokens[i].name != expected[i].name || tokens[i].value != expected[i].value || tokens[i].attributes != expected[i].attributes)
+					throw Exception(string_format("Token %1 differs with buffer size %2", (int)i, buffer_size));
+			}
+		}
+		Console::write_line("Refill boundaries: OK");
+	}
+
+	std::vector<XMLToken> tokenize(const std::string &xml, int buffer_size)
+	{
+		DataBuffer data(xml.data(), xml.size());
+		IODevice_Memory device(data);
+		XMLTokenizer tokenizer(device, buffer_size);
+
+		std::vector<XMLToken> tokens;
+		while (true)
+		{
+			XMLToken token;
+			tokenizer.next(&token);
+			if (token.type == XMLToken::NULL_TOKEN)
+				break;
+			tokens.push_back(token);
+		}
+		return tokens;
+	}
+
+	ubyte64 create_document(const std::string &filename, int megabytes)
+	{
+		File file(filename, File::create_always, File::access_write);
+
+		std::string header = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<resources>\n";
+		file.write(header.data(), header.size());
+		ubyte64 file_size = header.size();
+
+		std::string chunk;
+		int index = 0;
+		while (file_size < (ubyte64)megabytes * 1024 * 1024)
+		{
+			chunk.clear();
+			for (int i = 0; i < 1000; i++, index++)
+			{
+				chunk += string_format("\t<object id=\"%1\" type=\"prop\" x=\"%2\" y=\"%3\" flags='solid|static'>\n", index, index % 4096, index / 4096);
+				chunk += string_format("\t\t<name>Crate &amp; barrel #%1</name>\n", index);
+				chunk += "\t\t<transform rotation=\"0.25\" scale=\"1.0 1.0 1.0\"/>\n";
+				chunk += "\t\t<!-- generated -->\n";
+				chunk += "\t</object>\n";
+			}
+			file.write(chunk.data(), chunk.size());
+			file_size += chunk.size();
+		}
+
+		std::string footer = "</resources>\n";
+		file.write(footer.data(), footer.size());
+		return file_size + footer.size();
+	}
+
+	int get_peak_rss_kb()
+	{
+#ifdef WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+		return (int)(counters.PeakWorkingSetSize / 1024);
+#else
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		return (int)usage.ru_maxrss;
+#endif
+	}
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
@@ -0,0 +1,200 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+using namespace clan;
+
+// Runs the same XPath queries many times against a resource style document and
+// compares evaluating expression strings with and without the compiled expression
+// cache, and evaluating CompiledXPath objects directly.
+class TestApp
+{
+public:
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+
+		try
+		{
+			int num_objects = 5000;
+			if (args.size() > 1)
+				num_objects = StringHelp::text_to_int(args[1]);
+
+			DomDocument document = create_document(num_objects);
+
+			// Searches over the whole document:
+			std::vector<std::string> document_queries;
+			document_queries.push_back("//name");
+			document_queries.push_back("count(//object[@type='prop'])");
+			document_queries.push_back("resources/section/object[@id='42']/name");
+			document_queries.push_back("resources/section[last()]/object[position() < 3]/transform/@scale");
+			document_queries.push_back("//section//transform");
+			document_queries.push_back("/resources/descendant::name[starts-with(., 'Crate')][1]");
+			benchmark("Document queries", std::vector<DomNode>(1, document), document_queries, 20);
+
+			// Small lookups relative to each object, like a resource manager reading its settings:
+			std::vector<std::string> object_queries;
+			object_queries.push_back("name");
+			object_queries.push_back("@id");
+			object_queries.push_back("transform/@scale");
+			object_queries.push_back("number(@x) + number(@y) * 4096");
+			std::vector<DomNode> objects = document.select_nodes("resources/section[1]/object");
+			benchmark("Object queries", objects, object_queries, 50);
+
+			// Modifying the document must be visible to the next query:
+			CompiledXPath all_names = XPathEvaluator::compile("//name");
+			DomElement section = document.get_document_element().get_first_child_element();
+			DomElement extra = document.create_element("name");
+			section.append_child(extra);
+			int count_after = (int)XPathEvaluator().evaluate(all_names, document).get_node_set().size();
+			section.remove_child(extra);
+			int count_restored = (int)XPathEvaluator().evaluate(all_names, document).get_node_set().size();
+			if (count_after != num_objects + 1 || count_restored != num_objects)
+				throw Exception("Name index was not updated after the document changed");
+		}
+		catch (Exception error)
+		{
+			Console::write_line("Exception caught:");
+			Console::write_line(error.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	void benchmark(const std::string &title, const std::vector<DomNode> &contexts, const std::vector<std::string> &queries, int iterations)
+	{
+		std::vector<CompiledXPath> compiled;
+		for (size_t i = 0; i < queries.size(); i++)
+			compiled.push_back(CompiledXPath(queries[i]));
+
+		std::vector<std::string> expected = run_queries(contexts, queries, compiled, 1, false);
+
+		XPathEvaluator::set_cache_size(0);
+		ubyte64 start = System::get_microseconds();
+		if (run_queries(contexts, queries, compiled, iterations, false) != expected)
+			throw Exception("Uncached results do not match");
+		ubyte64 uncached_time = System::get_microseconds() - start;
+
+		XPathEvaluator::set_cache_size(64);
+		start = System::get_microseconds();
+		if (run_queries(contexts, queries, compiled, iterations, false) != expected)
+			throw Exception("Cached results do not match");
+		ubyte64 cached_time = System::get_microseconds() - start;
+
+		start = System::get_microseconds();
+		if (run_queries(contexts, queries, compiled, iterations, true) != expected)
+			throw Exception("Compiled results do not match");
+		ubyte64 compiled_time = System::get_microseconds() - start;
+
+		double num_queries = (double)iterations * queries.size() * contexts.size();
+		Console::write_line("%1: %2 queries", title, (int)num_queries);
+		Console::write_line("  Uncached: %1 ms (%2 queries/s)", (int)(uncached_time / 1000), (int)(num_queries * 1000000 / uncached_time));
+		Console::write_line("  Cached:   %1 ms (%2 queries/s)", (int)(cached_time / 1000), (int)(num_queries * 1000000 / cached_time));
+		Console::write_line("  Compiled: %1 ms (%2 queries/s)", (int)(compiled_time / 1000), (int)(num_queries * 1000000 / compiled_time));
+	}
+
+	std::vector<std::string> run_queries(const std::vector<DomNode> &contexts, const std::vector<std::string> &queries, const std::vector<CompiledXPath> &compiled, int iterations, bool use_compiled)
+	{
+		XPathEvaluator evaluator;
+		std::vector<std::string> results;
+		for (int iteration = 0; iteration < iterations; iteration++)
+		{
+			results.clear();
+			for (size_t context_index = 0; context_index < contexts.size(); context_index++)
+			{
+				for (size_t i = 0; i < queries.size(); i++)
+				{
+					const DomNode &context = contexts[context_index];
+					XPathObject result = use_compiled ? evaluator.evaluate(compiled[i], context) : evaluator.evaluate(queries[i], context);
+					results.push_back(to_string(result));
+				}
+			}
+		}
+		return results;
+	}
+
+	std::string to_string(const XPathObject &result)
+	{
+		switch (result.get_type())
+		{
+		case XPathObject::type_node_set:
+		{
+			std::vector<DomNode> nodes = result.get_node_set();
+			std::string text = string_format("%1 nodes", (int)nodes.size());
+			if (!nodes.empty())
+				text += ": " + nodes.front().get_node_value() + nodes.front().to_element().get_text();
+			return text;
+		}
+		case XPathObject::type_number:
+			return StringHelp::double_to_text(result.get_number());
+		case XPathObject::type_string:
+			return result.get_string();
+		case XPathObject::type_boolean:
+			return result.get_boolean() ? "true" : "false";
+		default:
+			return std::string();
+		}
+	}
+
+	DomDocument create_document(int num_objects)
+	{
+		std::string xml = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<resources>\n";
+		for (int index = 0; index < num_objects; index++)
+		{
+			if (index % 100 == 0)
+				xml += index == 0 ? "<section>\n" : "</section>\n<section>\n";
+			xml += string_format("\t<object id=\"%1\" type=\"prop\" x=\"%2\" y=\"%3\">", index, index % 4096, index / 4096);
+			xml += string_format("<name>Crate #%1</name>", index);
+			xml += "<transform rotation=\"0.25\" scale=\"1.0 1.0 1.0\"/></object>\n";
+		}
+		xml += "</section>\n</resources>\n";
+
+		DataBuffer data(xml.data(), xml.size());
+		IODevice_Memory device(data);
+		return DomDocument(device);
+	}
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
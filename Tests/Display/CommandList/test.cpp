@@ -0,0 +1,166 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/application.h>
+#include <ClanLib/display.h>
+#include <ClanLib/gl.h>
+using namespace clan;
+
+// Records command lists containing draw calls without any vertices, which must be dropped
+// rather than recorded, and checks that the rest of the list still draws where it should.
+class TestApp
+{
+public:
+	int main(const std::vector<std::string> &args);
+
+private:
+	void test_empty_draws(Canvas &canvas);
+	void test_only_empty_draws(Canvas &canvas);
+
+	void draw_empty(Canvas &canvas);
+	void check_pixel(PixelBuffer &pixels, int x, int y, const Colorf &color);
+	void fail();
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+		SetupDisplay setup_display;
+		SetupGL setup_gl;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
+
+int TestApp::main(const std::vector<std::string> &args)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("Directory: API/Display/2D");
+		Console::write_line(" Header: canvas_command_list.h");
+		Console::write_line("  Class: CanvasCommandList");
+
+		DisplayWindow window("CanvasCommandList Test", 200, 200);
+		Canvas canvas(window);
+
+		test_empty_draws(canvas);
+		test_only_empty_draws(canvas);
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+	catch (Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::test_empty_draws(Canvas &canvas)
+{
+	Console::write_line("   Empty draws between regular ones");
+
+	CanvasCommandList list(canvas);
+	list.begin(canvas);
+	draw_empty(canvas);
+	canvas.fill_rect(10.0f, 10.0f, 50.0f, 50.0f, Colorf::red);
+	draw_empty(canvas);
+	list.end(canvas);
+
+	if (!list.is_recorded() || list.get_batch_count() != 1)
+		fail();
+
+	// Draw twice with different transforms, so the list is uploaded again for the moved copy
+	canvas.clear(Colorf::black);
+	list.draw(canvas);
+	canvas.push_translate(100.0f, 0.0f);
+	list.draw(canvas);
+	canvas.pop_modelview();
+	canvas.flush();
+
+	PixelBuffer pixels = canvas.get_pixeldata(Rect(0, 0, 200, 200));
+	check_pixel(pixels, 30, 30, Colorf::red);
+	check_pixel(pixels, 130, 30, Colorf::red);
+	check_pixel(pixels, 30, 130, Colorf::black);
+	check_pixel(pixels, 80, 30, Colorf::black);
+}
+
+void TestApp::test_only_empty_draws(Canvas &canvas)
+{
+	Console::write_line("   Only empty draws");
+
+	CanvasCommandList list(canvas);
+	list.begin(canvas);
+	draw_empty(canvas);
+	list.end(canvas);
+
+	if (!list.is_recorded() || list.get_batch_count() != 0)
+		fail();
+
+	canvas.clear(Colorf::black);
+	list.draw(canvas);
+	canvas.flush();
+
+	PixelBuffer pixels = canvas.get_pixeldata(Rect(0, 0, 200, 200));
+	check_pixel(pixels, 30, 30, Colorf::black);
+}
+
+void TestApp::draw_empty(Canvas &canvas)
+{
+	Vec2f positions[3] = { Vec2f(0.0f, 0.0f), Vec2f(100.0f, 0.0f), Vec2f(0.0f, 100.0f) };
+	canvas.fill_triangles(positions, 0, Colorf::white);
+	canvas.fill_triangles(std::vector<Vec2f>(), Colorf::white);
+	canvas.draw_lines(positions, 0, Colorf::white);
+}
+
+void TestApp::check_pixel(PixelBuffer &pixels, int x, int y, const Colorf &color)
+{
+	Colorf pixel = pixels.get_pixel(x, y);
+	if (std::abs(pixel.r - color.r) > 0.01f || std::abs(pixel.g - color.g) > 0.01f || std::abs(pixel.b - color.b) > 0.01f)
+		fail();
+}
+
+void TestApp::fail()
+{
+	throw Exception("Failed Test");
+}
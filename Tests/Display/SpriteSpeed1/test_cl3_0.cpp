@@ -23,6 +23,10 @@ private:
 	void draw_diff_tex_diff_sprites(Canvas &canvas, int sprite_count, int time_elapsed);
 	void draw_diff_tex_diff_sprites_batch(Canvas &canvas, int sprite_count, int time_elapsed);
 
+	void draw_command_list(Canvas &canvas, int sprite_count, bool moving);
+	void draw_threaded(Canvas &canvas, int sprite_count);
+	void record_sprites(int worker, int first_sprite, int last_sprite);
+
 private:
 	bool quit;
 
@@ -31,6 +35,11 @@ private:
 	std::vector<Sprite> explosions_same_tex;
 	std::vector<Sprite> explosions_diff_tex;
 
+	CanvasCommandList command_list;
+
+	std::vector<Canvas> worker_canvases;
+	std::vector<CanvasCommandList> worker_lists;
+
 	int running_test;
 };
 
@@ -69,7 +78,7 @@ int App::start(const std::vector<std::string> &args)
 	// Create a console window for text-output if not available
 	ConsoleWindow console("Console", 80, 200);
 	
-	Console::write_line("Press 1-5 for different tests! (Test 3 and 5 not applicable for ClanLib 0.8)");			
+	Console::write_line("Press 1-8 for different tests! (Test 3 and 5 not applicable for ClanLib 0.8)");			
 
 	try
 	{
@@ -89,6 +98,14 @@ int App::start(const std::vector<std::string> &args)
 		// Create the canvas
 		Canvas canvas(window);
 
+		command_list = CanvasCommandList(canvas);
+
+		for (int i = 0; i < System::get_num_cores(); i++)
+		{
+			worker_canvases.push_back(canvas.create_worker());
+			worker_lists.push_back(CanvasCommandList(worker_canvases.back()));
+		}
+
 		ResourceManager resources("resources.xml");
 
 		explosion1 = Sprite(canvas, "Explosion1", &resources);
@@ -124,6 +141,12 @@ int App::start(const std::vector<std::string> &args)
 				draw_diff_tex_diff_sprites(canvas, 10000, delta_time);
 			if(running_test == 5)
 				draw_diff_tex_diff_sprites_batch(canvas, 10000, delta_time);
+			if(running_test == 6)
+				draw_command_list(canvas, 10000, false);
+			if(running_test == 7)
+				draw_command_list(canvas, 10000, true);
+			if(running_test == 8)
+				draw_threaded(canvas, 10000);
 
 			canvas.flush();
 			// Flip the display, showing on the screen what we have drawed since last call to flip()
@@ -135,6 +158,9 @@ int App::start(const std::vector<std::string> &args)
 
 		explosions_same_tex.clear();
 		explosions_diff_tex.clear();
+		command_list = CanvasCommandList();
+		worker_lists.clear();
+		worker_canvases.clear();
 		explosion1 = Sprite();
 		explosion2 = Sprite();
 	}
@@ -193,6 +219,21 @@ void App::on_input_up(const InputEvent &key)
 		running_test = 5;
 		Console::write_line("Running test 5: draw_diff_tex_diff_sprites_batch");
 	}
+	if(key.id ==  keycode_6 && running_test != 6)
+	{
+		running_test = 6;
+		Console::write_line("Running test 6: draw_command_list (static)");
+	}
+	if(key.id ==  keycode_7 && running_test != 7)
+	{
+		running_test = 7;
+		Console::write_line("Running test 7: draw_command_list (moving)");
+	}
+	if(key.id ==  keycode_8 && running_test != 8)
+	{
+		running_test = 8;
+		Console::write_line(string_format("Running test 8: draw_threaded (%1 threads)", (int)worker_canvases.size()));
+	}
 }
 
 // The window was closed
@@ -301,4 +342,50 @@ void App::draw_diff_tex_diff_sprites_batch(Canvas &canvas, int sprite_count, int
 {
 	// Batching is builtin in 2.0..
 	draw_diff_tex_diff_sprites(canvas, sprite_count, time_elapsed);
-}
\ No newline at end of file
+}
+
+void App::draw_command_list(Canvas &canvas, int sprite_count, bool moving)
+{
+	// Record the scene of test 4 once, then replay the vertices every frame
+	if (!command_list.is_recorded())
+	{
+		command_list.begin(canvas);
+		draw_diff_tex_diff_sprites(canvas, sprite_count, 0);
+		command_list.end(canvas);
+	}
+
+	if (moving)
+	{
+		canvas.push_translate(sinf(System::get_time() / 500.0f) * 10.0f, 0.0f);
+		command_list.draw(canvas);
+		canvas.pop_modelview();
+	}
+	else
+	{
+		command_list.draw(canvas);
+	}
+}
+
+void App::draw_threaded(Canvas &canvas, int sprite_count)
+{
+	// Test 4 scene, with the vertices filled by one worker thread per core
+	int num_workers = worker_canvases.size();
+	std::vector<Thread> threads(num_workers);
+	for (int i = 0; i < num_workers; i++)
+		threads[i].start(this, &App::record_sprites, i, sprite_count * i / num_workers, sprite_count * (i + 1) / num_workers);
+
+	for (int i = 0; i < num_workers; i++)
+	{
+		threads[i].join();
+		worker_lists[i].draw(canvas);
+	}
+}
+
+void App::record_sprites(int worker, int first_sprite, int last_sprite)
+{
+	Canvas &worker_canvas = worker_canvases[worker];
+	worker_lists[worker].begin(worker_canvas);
+	for (int count = first_sprite; count < last_sprite; count++)
+		explosions_diff_tex[count].draw(worker_canvas, (count / 100) * 10.0f, (count % 100) * 10.0f);
+	worker_lists[worker].end(worker_canvas);
+}
@@ -0,0 +1,158 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <ClanLib/gl.h>
+#include <ClanLib/gui.h>
+using namespace clan;
+
+// Builds a window with a large static toolbar and a small status component that changes
+// every frame. The frames are painted first without and then with a cached layer for the
+// toolbar. Paint statistics are printed for both runs and the window contents must match.
+class App
+{
+public:
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+		try
+		{
+			DisplayWindowDescription desc;
+			desc.set_size(Size(1024, 768), true);
+			desc.set_title("Cached Layers Test");
+			DisplayWindow display_window(desc);
+			Canvas canvas(display_window);
+
+			GUIManager gui(display_window, ".");
+
+			GUITopLevelDescription window_desc;
+			window_desc.set_position(Rect(0, 0, 1024, 768), false);
+			GUIComponent *root = new GUIComponent(&gui, window_desc, "component");
+			root->set_class("root", true);
+
+			GUIComponent *toolbar = new GUIComponent(root);
+			toolbar->set_class("toolbar", true);
+			for (int row = 0; row < 20; row++)
+			{
+				GUIComponent *toolbar_row = new GUIComponent(toolbar);
+				toolbar_row->set_class("toolbar-row", true);
+				for (int i = 0; i < 40; i++)
+				{
+					GUIComponent *button = new GUIComponent(toolbar_row);
+					button->set_class("button", true);
+					button->set_class("checked", (row + i) % 7 == 0);
+				}
+			}
+
+			GUIComponent *status = new GUIComponent(root);
+			status->set_class("status", true);
+
+			PixelBuffer uncached_pixels = run(canvas, gui, status, "Without cached layer");
+			toolbar->set_cached_layer(true);
+			PixelBuffer cached_pixels = run(canvas, gui, status, "With cached layer");
+
+			if (!is_equal(uncached_pixels, cached_pixels))
+				throw Exception("Window contents with a cached layer do not match the uncached rendering");
+
+			Console::write_line("All tests passed");
+			delete root;
+		}
+		catch (Exception e)
+		{
+			Console::write_line(e.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	PixelBuffer run(Canvas &canvas, GUIManager &gui, GUIComponent *status, const std::string &name)
+	{
+		const int frames = 100;
+
+		gui.render_windows();
+		gui.reset_paint_statistics();
+		for (int i = 0; i < frames; i++)
+		{
+			status->set_class("busy", i % 2 == 0);
+			gui.process_messages(0);
+		}
+
+		GUIPaintStatistics statistics = gui.get_paint_statistics();
+		Console::write_line("%1: %2 paints, %3 pixels, %4 ms, %5 layer hits, %6 layer updates", name,
+			statistics.paint_count, (int)statistics.painted_pixels, statistics.paint_time / 1000.0,
+			statistics.layer_hits, statistics.layer_updates);
+
+		// Repaint everything so that the cached layer is drawn as well
+		gui.render_windows();
+		GUIWindowManagerTexture window_manager(gui.get_window_manager());
+		Subtexture window_texture = window_manager.get_windows()[0].get_texture();
+		return window_texture.get_texture().get_pixeldata(canvas, tf_rgba8).copy(window_texture.get_geometry());
+	}
+
+	bool is_equal(const PixelBuffer &a, const PixelBuffer &b)
+	{
+		if (a.get_size() != b.get_size())
+			return false;
+
+		// Premultiplied blending of the layer may round differently than drawing directly
+		for (int y = 0; y < a.get_height(); y++)
+		{
+			const unsigned char *line_a = a.get_data_uint8() + y * a.get_pitch();
+			const unsigned char *line_b = b.get_data_uint8() + y * b.get_pitch();
+			for (int x = 0; x < a.get_width() * 4; x++)
+			{
+				if (abs(line_a[x] - line_b[x]) > 2)
+					return false;
+			}
+		}
+		return true;
+	}
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+		SetupDisplay setup_display;
+		SetupGL setup_gl;
+		SetupGUI setup_gui;
+
+		App app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
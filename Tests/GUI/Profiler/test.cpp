@@ -0,0 +1,142 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <ClanLib/gl.h>
+#include <ClanLib/gui.h>
+using namespace clan;
+
+// Profiles a window full of buttons while it is laid out, rendered and receives input,
+// then lists the most expensive components and writes a trace for chrome://tracing.
+// Moving the mouse over the window shows the effect of message coalescing on the message counts.
+class App
+{
+public:
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+		try
+		{
+			GUIManager gui(".");
+			gui.set_message_coalescing(true);
+			gui.set_profiling_enabled(true);
+
+			GUITopLevelDescription window_desc;
+			window_desc.set_title("Profiler");
+			window_desc.set_size(Size(800, 600), false);
+
+			GUIComponent *root = new GUIComponent(&gui, window_desc, "component");
+			root->func_close().set(this, &App::on_close, root);
+			for (int i = 0; i < 200; i++)
+			{
+				PushButton *button = new PushButton(root);
+				button->set_text(string_format("Button %1", i));
+				if (i % 50 == 0)
+					button->set_id(string_format("button%1", i));
+			}
+
+			// Click every button once so the message handlers show up in the profile:
+			for (GUIComponent *child = root->get_first_child(); child; child = child->get_next_sibling())
+			{
+				send_input(gui, child, InputEvent::pressed);
+				send_input(gui, child, InputEvent::released);
+			}
+
+			ubyte64 end_time = System::get_microseconds() + 5000000;
+			while (System::get_microseconds() < end_time && !gui.get_exit_flag())
+			{
+				root->update_layout();
+				gui.process_messages(0);
+				gui.render_windows();
+			}
+
+			std::vector<GUIProfileEntry> profile = gui.get_profile();
+			Console::write_line("%1 components profiled", (int)profile.size());
+			for (size_t i = 0; i < profile.size() && i < 10; i++)
+			{
+				const GUIProfileEntry &entry = profile[i];
+				Console::write_line("%1: %2 messages in %3 ms, %4 layouts in %5 ms, %6 renders in %7 ms",
+					entry.component,
+					entry.message_count, entry.message_time / 1000.0,
+					entry.layout_count, entry.layout_time / 1000.0,
+					entry.render_count, entry.render_time / 1000.0);
+			}
+
+			gui.write_profile_trace("profile.json");
+			Console::write_line("Trace written to profile.json");
+
+			delete root;
+		}
+		catch (Exception e)
+		{
+			Console::write_line(e.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	bool on_close(GUIComponent *root)
+	{
+		root->exit_with_code(0);
+		return true;
+	}
+
+	void send_input(GUIManager &gui, GUIComponent *target, InputEvent::Type type)
+	{
+		InputEvent event;
+		event.type = type;
+		event.id = mouse_left;
+		event.mouse_pos = Point(2, 2);
+
+		std::shared_ptr<GUIMessage_Input> message(new GUIMessage_Input(event));
+		message->target = target;
+		gui.dispatch_message(message);
+	}
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+		SetupDisplay setup_display;
+		SetupGL setup_gl;
+		SetupGUI setup_gui;
+
+		App app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
@@ -0,0 +1,245 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "API/core.h"
+#include "API/application.h"
+#include "GUI/Components/ListView/listview_row_index.h"
+using namespace clan;
+
+// Headless checks of the row index used by virtual list views. Every index is compared
+// against offsets summed up directly from the row heights.
+class TestApp
+{
+public:
+	int main(const std::vector<std::string> &args);
+
+private:
+	void test_default_heights();
+	void test_set_row_height();
+	void test_set_row_heights();
+	void test_random();
+	void test_build_time();
+
+	void check(const ListViewRowIndex &index, const std::vector<int> &heights);
+	void fail();
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
+
+int TestApp::main(const std::vector<std::string> &args)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("Directory: GUI/Components/ListView");
+		Console::write_line(" Header: listview_row_index.h");
+		Console::write_line("  Class: ListViewRowIndex");
+
+		test_default_heights();
+		test_set_row_height();
+		test_set_row_heights();
+		test_random();
+		test_build_time();
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+	catch (Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::test_default_heights()
+{
+	Console::write_line("   Default heights");
+
+	ListViewRowIndex index;
+	if (index.get_row_count() != 0 || index.get_total_height() != 0 || index.find_row(10) != -1)
+		fail();
+
+	index.reset(100, 20);
+	check(index, std::vector<int>(100, 20));
+
+	// Rows with the default height keep the index in its direct form
+	index.set_row_height(10, 20);
+	index.set_row_heights(std::vector<int>(100, 20));
+	check(index, std::vector<int>(100, 20));
+}
+
+void TestApp::test_set_row_height()
+{
+	Console::write_line("   Single row heights");
+
+	ListViewRowIndex index;
+	index.reset(100, 20);
+	std::vector<int> heights(100, 20);
+
+	int rows[] = { 0, 1, 63, 64, 99 };
+	for (int i = 0; i < sizeof(rows) / sizeof(rows[0]); i++)
+	{
+		heights[rows[i]] = 5 + i * 11;
+		index.set_row_height(rows[i], heights[rows[i]]);
+		check(index, heights);
+	}
+}
+
+void TestApp::test_set_row_heights()
+{
+	Console::write_line("   All row heights at once");
+
+	ListViewRowIndex index;
+	for (int row_count = 0; row_count < 70; row_count++)
+	{
+		std::vector<int> heights(row_count);
+		for (int row = 0; row < row_count; row++)
+			heights[row] = (row % 3 == 0) ? 40 : 20;
+
+		index.reset(row_count, 20);
+		index.set_row_heights(heights);
+		check(index, heights);
+
+		// Point updates after a bulk update see the same tree
+		for (int row = 0; row < row_count; row += 5)
+		{
+			heights[row] = row + 1;
+			index.set_row_height(row, heights[row]);
+		}
+		check(index, heights);
+	}
+}
+
+void TestApp::test_random()
+{
+	Console::write_line("   Random row heights");
+
+	unsigned int seed = 12345;
+	for (int round = 0; round < 50; round++)
+	{
+		seed = seed * 1103515245 + 12345;
+		int row_count = 1 + (seed >> 16) % 500;
+
+		std::vector<int> heights(row_count);
+		for (int row = 0; row < row_count; row++)
+		{
+			seed = seed * 1103515245 + 12345;
+			heights[row] = (seed >> 16) % 50;
+		}
+
+		ListViewRowIndex index;
+		index.reset(row_count, 16);
+		if (round % 2)
+		{
+			index.set_row_heights(heights);
+		}
+		else
+		{
+			for (int row = 0; row < row_count; row++)
+				index.set_row_height(row, heights[row]);
+		}
+		check(index, heights);
+	}
+}
+
+void TestApp::test_build_time()
+{
+	Console::write_line("   Build time for 1 000 000 rows");
+
+	const int row_count = 1000000;
+	std::vector<int> heights(row_count);
+	for (int row = 0; row < row_count; row++)
+		heights[row] = (row % 1000 == 0) ? 40 : 20;
+
+	ListViewRowIndex bulk_index;
+	bulk_index.reset(row_count, 20);
+	ubyte64 start = System::get_microseconds();
+	bulk_index.set_row_heights(heights);
+	ubyte64 bulk_time = System::get_microseconds() - start;
+
+	ListViewRowIndex point_index;
+	point_index.reset(row_count, 20);
+	start = System::get_microseconds();
+	for (int row = 0; row < row_count; row++)
+		point_index.set_row_height(row, heights[row]);
+	ubyte64 point_time = System::get_microseconds() - start;
+
+	Console::write_line("      set_row_heights: %1 ms, set_row_height per row: %2 ms", bulk_time / 1000.0, point_time / 1000.0);
+
+	if (bulk_index.get_total_height() != point_index.get_total_height() || bulk_index.get_row_top(row_count - 1) != point_index.get_row_top(row_count - 1))
+		fail();
+}
+
+void TestApp::check(const ListViewRowIndex &index, const std::vector<int> &heights)
+{
+	int row_count = heights.size();
+	if (index.get_row_count() != row_count)
+		fail();
+
+	int top = 0;
+	for (int row = 0; row < row_count; row++)
+	{
+		if (index.get_row_top(row) != top || index.get_row_height(row) != heights[row])
+			fail();
+
+		// Rows with zero height are skipped by find_row, so only check rows that can be hit
+		if (heights[row] > 0 && (index.find_row(top) != row || index.find_row(top + heights[row] - 1) != row))
+			fail();
+
+		top += heights[row];
+	}
+
+	if (index.get_total_height() != top)
+		fail();
+	if (row_count > 0 && index.find_row(top + 100) != row_count - 1)
+		fail();
+}
+
+void TestApp::fail()
+{
+	throw Exception("Failed Test");
+}
@@ -0,0 +1,146 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <ClanLib/gl.h>
+#include <ClanLib/gui.h>
+using namespace clan;
+
+// Builds a large synthetic component tree (pages of rows of cells) and measures how long
+// it takes to restyle and lay it out, first on one thread and then with an increasing
+// number of style worker threads. The layout of every run must match the serial one.
+class App
+{
+public:
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+		try
+		{
+			GUIManager gui(".");
+
+			GUITopLevelDescription window_desc;
+			window_desc.set_title("Style Resolve Benchmark");
+			window_desc.set_size(Size(1024, 768), false);
+
+			GUIComponent *root = new GUIComponent(&gui, window_desc, "component");
+			root->set_class("root", true);
+			create_document(root, 32, 64, 8);
+
+			gui.set_parallel_style_resolution(false);
+			ubyte64 serial_time = benchmark(root);
+			std::vector<Rect> serial_geometry;
+			get_geometry(root, serial_geometry);
+			Console::write_line("Serial: %1 ms", serial_time / 1000.0);
+
+			for (int threads = 1; threads <= System::get_num_cores(); threads *= 2)
+			{
+				gui.set_parallel_style_resolution(true, threads);
+				ubyte64 time = benchmark(root);
+				std::vector<Rect> geometry;
+				get_geometry(root, geometry);
+				if (geometry != serial_geometry)
+					throw Exception(string_format("Layout with %1 threads does not match the serial layout", threads));
+				Console::write_line("%1 threads: %2 ms (%3x)", threads, time / 1000.0, serial_time / (double)time);
+			}
+
+			delete root;
+		}
+		catch (Exception e)
+		{
+			Console::write_line(e.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	void create_document(GUIComponent *root, int pages, int rows, int cells)
+	{
+		for (int p = 0; p < pages; p++)
+		{
+			GUIComponent *page = new GUIComponent(root);
+			page->set_class("page", true);
+			page->set_class("odd", p % 2 == 1);
+			for (int r = 0; r < rows; r++)
+			{
+				GUIComponent *row = new GUIComponent(page);
+				row->set_class("row", true);
+				for (int c = 0; c < cells; c++)
+				{
+					GUIComponent *cell = new GUIComponent(row);
+					cell->set_class("cell", true);
+					cell->set_class("first", c == 0);
+				}
+			}
+		}
+	}
+
+	ubyte64 benchmark(GUIComponent *root)
+	{
+		const int iterations = 10;
+		ubyte64 start = System::get_microseconds();
+		for (int i = 0; i < iterations; i++)
+		{
+			// Toggling a class on the root invalidates the style of every component
+			root->set_class("dark", i % 2 == 0);
+			root->update_layout();
+		}
+		root->set_class("dark", false);
+		root->update_layout();
+		return (System::get_microseconds() - start) / (iterations + 1);
+	}
+
+	void get_geometry(GUIComponent *component, std::vector<Rect> &geometry)
+	{
+		geometry.push_back(component->get_geometry());
+		for (GUIComponent *child = component->get_first_child(); child; child = child->get_next_sibling())
+			get_geometry(child, geometry);
+	}
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+		SetupDisplay setup_display;
+		SetupGL setup_gl;
+		SetupGUI setup_gui;
+
+		App app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
@@ -0,0 +1,130 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <ClanLib/gl.h>
+#include <ClanLib/gui.h>
+using namespace clan;
+
+// Loads a 10 MB document into a TextEdit and types characters at a few places in it.
+// Prints the average cost of a keystroke, including the repaint of the text edit.
+class App
+{
+public:
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+		try
+		{
+			GUIManager gui("../../../Resources/GUIThemeAero");
+
+			DisplayWindowDescription win_desc;
+			win_desc.set_title("TextEdit Benchmark");
+			win_desc.set_position(Rect(200, 200, 840, 680), false);
+			GUIComponent window(&gui, win_desc, "Window");
+
+			TextEdit textedit(&window);
+			textedit.set_geometry(Rect(10, 10, 630, 470));
+
+			std::string line = "The quick brown fox jumps over the lazy dog while the log keeps growing.\n";
+			std::string document;
+			document.reserve(10 * 1024 * 1024 + line.length());
+			while (document.length() < 10 * 1024 * 1024)
+				document += line;
+
+			ubyte64 start = System::get_microseconds();
+			textedit.set_text(document);
+			gui.render_windows();
+			Console::write_line("Loaded %1 lines in %2 ms", textedit.get_line_count(), (System::get_microseconds() - start) / 1000.0);
+
+			textedit.set_focus();
+			InputDevice keyboard = window.get_ic().get_keyboard();
+
+			const int keystrokes = 1000;
+			int positions[] = { 0, (int)document.length() / 2, (int)document.length() - 1 };
+			for (int i = 0; i < sizeof(positions) / sizeof(positions[0]); i++)
+			{
+				textedit.set_cursor_pos(positions[i]);
+				start = System::get_microseconds();
+				for (int j = 0; j < keystrokes; j++)
+				{
+					type(gui, textedit, keyboard, (j % 50 == 49) ? keycode_return : keycode_a, (j % 50 == 49) ? "\n" : "a");
+					gui.render_windows();
+				}
+				ubyte64 time = System::get_microseconds() - start;
+				Console::write_line("Offset %1: %2 us per keystroke", positions[i], time / (double)keystrokes);
+			}
+
+			if (textedit.get_text().length() != document.length() + 3 * keystrokes)
+				throw Exception("Text length does not match the number of keystrokes");
+
+			Console::write_line("All tests passed");
+		}
+		catch (Exception e)
+		{
+			Console::write_line(e.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+
+private:
+	void type(GUIManager &gui, TextEdit &textedit, InputDevice &keyboard, InputCode key, const std::string &str)
+	{
+		InputEvent e;
+		e.type = InputEvent::pressed;
+		e.device = keyboard;
+		e.id = key;
+		e.str = str;
+
+		std::shared_ptr<GUIMessage> message(new GUIMessage_Input(e));
+		message->target = &textedit;
+		gui.dispatch_message(message);
+	}
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+		SetupDisplay setup_display;
+		SetupGL setup_gl;
+		SetupGUI setup_gui;
+
+		App app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
@@ -0,0 +1,311 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "API/core.h"
+#include "API/application.h"
+#include "GUI/WindowManager/gui_update_region.h"
+using namespace clan;
+
+// Headless checks of the damage region used by the texture window manager. Every region is also
+// checked to hold disjoint rectangles that together cover everything added to it.
+class TestApp
+{
+public:
+	int main(const std::vector<std::string> &args);
+
+private:
+	void test_empty();
+	void test_contained();
+	void test_adjacent();
+	void test_overlapping();
+	void test_merge_threshold();
+	void test_max_rects();
+	void test_random();
+
+	void add(GUIUpdateRegion &region, std::vector<Rect> &added, const Rect &rect);
+	void check(const GUIUpdateRegion &region, const std::vector<Rect> &added, int max_rects);
+	void fail();
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
+
+int TestApp::main(const std::vector<std::string> &args)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("Directory: GUI/WindowManager");
+		Console::write_line(" Header: gui_update_region.h");
+		Console::write_line("  Class: GUIUpdateRegion");
+
+		test_empty();
+		test_contained();
+		test_adjacent();
+		test_overlapping();
+		test_merge_threshold();
+		test_max_rects();
+		test_random();
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+	catch (Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::test_empty()
+{
+	Console::write_line("   Empty rectangles");
+
+	GUIUpdateRegion region;
+	region.add(Rect(10, 10, 10, 20));
+	region.add(Rect(10, 10, 20, 10));
+	region.add(Rect(20, 20, 10, 10));
+	if (!region.is_empty() || region.get_area() != 0 || region.get_bounds() != Rect())
+		fail();
+
+	region.add(Rect(0, 0, 10, 10));
+	region.clear();
+	if (!region.is_empty())
+		fail();
+}
+
+void TestApp::test_contained()
+{
+	Console::write_line("   Contained rectangles");
+
+	GUIUpdateRegion region;
+	std::vector<Rect> added;
+
+	// A rectangle inside the region leaves it unchanged
+	add(region, added, Rect(0, 0, 100, 100));
+	add(region, added, Rect(10, 10, 20, 20));
+	add(region, added, Rect(0, 0, 100, 100));
+	if (region.get_rects().size() != 1 || region.get_rects()[0] != Rect(0, 0, 100, 100))
+		fail();
+	check(region, added, 8);
+
+	// A rectangle containing the region replaces it
+	region.clear();
+	added.clear();
+	add(region, added, Rect(40, 40, 50, 50));
+	add(region, added, Rect(200, 40, 210, 50));
+	add(region, added, Rect(0, 0, 300, 100));
+	if (region.get_rects().size() != 1 || region.get_rects()[0] != Rect(0, 0, 300, 100))
+		fail();
+	check(region, added, 8);
+}
+
+void TestApp::test_adjacent()
+{
+	Console::write_line("   Adjacent rectangles");
+
+	GUIUpdateRegion region;
+	std::vector<Rect> added;
+
+	// Rectangles sharing an edge merge without waste, in any order
+	add(region, added, Rect(0, 0, 50, 50));
+	add(region, added, Rect(50, 0, 100, 50));
+	add(region, added, Rect(0, 50, 100, 80));
+	if (region.get_rects().size() != 1 || region.get_rects()[0] != Rect(0, 0, 100, 80))
+		fail();
+	check(region, added, 8);
+
+	// Touching only at a corner wastes as much as it covers, so they stay apart
+	region.clear();
+	added.clear();
+	add(region, added, Rect(0, 0, 50, 50));
+	add(region, added, Rect(50, 50, 100, 100));
+	if (region.get_rects().size() != 2 || region.get_area() != 5000)
+		fail();
+	check(region, added, 8);
+}
+
+void TestApp::test_overlapping()
+{
+	Console::write_line("   Overlapping rectangles");
+
+	GUIUpdateRegion region;
+	std::vector<Rect> added;
+
+	// Overlap along the full height merges into the bounding box
+	add(region, added, Rect(0, 0, 100, 100));
+	add(region, added, Rect(50, 0, 150, 100));
+	if (region.get_rects().size() != 1 || region.get_rects()[0] != Rect(0, 0, 150, 100))
+		fail();
+	check(region, added, 8);
+
+	// An L shape would waste most of its bounding box, so the new rectangle is clipped instead
+	region.clear();
+	added.clear();
+	add(region, added, Rect(0, 0, 100, 10));
+	add(region, added, Rect(0, 0, 10, 100));
+	if (region.get_rects().size() != 2 || region.get_area() != 1900)
+		fail();
+	if (region.get_bounds() != Rect(0, 0, 100, 100))
+		fail();
+	check(region, added, 8);
+
+	// A cross splits the second bar around the first
+	region.clear();
+	added.clear();
+	add(region, added, Rect(40, 0, 60, 100));
+	add(region, added, Rect(0, 40, 100, 60));
+	if (region.get_rects().size() != 3 || region.get_area() != 3600)
+		fail();
+	check(region, added, 8);
+}
+
+void TestApp::test_merge_threshold()
+{
+	Console::write_line("   Merge threshold");
+
+	// Two 40x10 rectangles cover 800 pixels. They merge while the gap between them wastes
+	// at most a quarter of that, so a 20 pixel gap merges and a 21 pixel gap does not.
+	GUIUpdateRegion region;
+	std::vector<Rect> added;
+	add(region, added, Rect(0, 0, 40, 10));
+	add(region, added, Rect(60, 0, 100, 10));
+	if (region.get_rects().size() != 1 || region.get_rects()[0] != Rect(0, 0, 100, 10))
+		fail();
+	check(region, added, 8);
+
+	region.clear();
+	added.clear();
+	add(region, added, Rect(0, 0, 40, 10));
+	add(region, added, Rect(61, 0, 101, 10));
+	if (region.get_rects().size() != 2 || region.get_area() != 800)
+		fail();
+	check(region, added, 8);
+}
+
+void TestApp::test_max_rects()
+{
+	Console::write_line("   Rectangle limit");
+
+	GUIUpdateRegion region(4);
+	std::vector<Rect> added;
+	for (int i = 0; i < 6; i++)
+		add(region, added, Rect(i * 100, 0, i * 100 + 10, 10));
+	check(region, added, 4);
+
+	// The cheapest pairs to merge are the neighbours, so the result stays a single row
+	if (region.get_bounds() != Rect(0, 0, 510, 10))
+		fail();
+	if (region.get_area() >= 510 * 10)
+		fail();
+}
+
+void TestApp::test_random()
+{
+	Console::write_line("   Random rectangles");
+
+	unsigned int seed = 12345;
+	for (int round = 0; round < 200; round++)
+	{
+		int max_rects = 1 + round % 8;
+		GUIUpdateRegion region(max_rects);
+		std::vector<Rect> added;
+		for (int i = 0; i < 20; i++)
+		{
+			int values[4];
+			for (int j = 0; j < 4; j++)
+			{
+				seed = seed * 1103515245 + 12345;
+				values[j] = (seed >> 16) % 200;
+			}
+			add(region, added, Rect(values[0], values[1], values[0] + values[2] / 4, values[1] + values[3] / 4));
+			check(region, added, max_rects);
+		}
+	}
+}
+
+void TestApp::add(GUIUpdateRegion &region, std::vector<Rect> &added, const Rect &rect)
+{
+	region.add(rect);
+	added.push_back(rect);
+}
+
+void TestApp::check(const GUIUpdateRegion &region, const std::vector<Rect> &added, int max_rects)
+{
+	const std::vector<Rect> &rects = region.get_rects();
+	if ((int)rects.size() > max_rects)
+		fail();
+
+	for (size_t i = 0; i < rects.size(); i++)
+	{
+		if (rects[i].get_width() <= 0 || rects[i].get_height() <= 0)
+			fail();
+		for (size_t j = i + 1; j < rects.size(); j++)
+		{
+			if (rects[i].is_overlapped(rects[j]))
+				fail();
+		}
+	}
+
+	// As the rectangles are disjoint, an added rectangle is covered when its overlaps add up to its area
+	for (size_t i = 0; i < added.size(); i++)
+	{
+		int covered = 0;
+		for (size_t j = 0; j < rects.size(); j++)
+		{
+			Rect overlap = added[i];
+			overlap.overlap(rects[j]);
+			covered += overlap.get_width() * overlap.get_height();
+		}
+		if (covered != added[i].get_width() * added[i].get_height())
+			fail();
+	}
+}
+
+void TestApp::fail()
+{
+	throw Exception("Failed Test");
+}
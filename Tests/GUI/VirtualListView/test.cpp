@@ -0,0 +1,152 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/application.h>
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <ClanLib/gl.h>
+#include <ClanLib/gui.h>
+using namespace clan;
+
+// Generates the rows of a log view on demand. Every 1000th row is a taller "section" row.
+class LogDataProvider : public ListViewDataProvider
+{
+public:
+	LogDataProvider(int row_count) : row_count(row_count), cell_requests(0), height_requests(0) { }
+
+	int get_row_count() { return row_count; }
+
+	std::string get_cell_text(int row, const std::string &column_id)
+	{
+		cell_requests++;
+		if (column_id == "line")
+			return StringHelp::int_to_text(row + 1);
+		else if (column_id == "level")
+			return (row % 7 == 0) ? "warning" : "info";
+		else
+			return string_format("Message number %1 of the log", row);
+	}
+
+	int get_row_height(int row) { height_requests++; return (row % 1000 == 0) ? 40 : 0; }
+
+	int row_count;
+	int cell_requests;
+	int height_requests;
+};
+
+// Scrolls through a list view with 200 000 virtual rows and measures the cost of each
+// scroll and paint. The time and the number of cells fetched must not grow with the scroll offset.
+class App
+{
+public:
+	int main(const std::vector<std::string> &args)
+	{
+		ConsoleWindow console("Console");
+		try
+		{
+			GUIManager gui("../../../Resources/GUIThemeAero");
+
+			DisplayWindowDescription win_desc;
+			win_desc.set_title("Virtual ListView Test");
+			win_desc.set_position(Rect(200, 200, 840, 680), false);
+			GUIComponent window(&gui, win_desc, "Window");
+
+			ListView listview(&window);
+			listview.set_geometry(Rect(10, 10, 630, 470));
+			ListViewHeader *header = listview.get_header();
+			header->append(header->create_column("line", "Line")).set_width(80);
+			header->append(header->create_column("level", "Level")).set_width(80);
+			header->append(header->create_column("message", "Message")).set_width(400);
+
+			std::shared_ptr<LogDataProvider> provider(new LogDataProvider(200000));
+			ubyte64 start = System::get_microseconds();
+			listview.set_data_provider(provider, true);
+			Console::write_line("Row index built in %1 ms", (System::get_microseconds() - start) / 1000.0);
+
+			int rows[] = { 0, 10, 1000, 50000, 100000, 199999 };
+			int visible_cells = 0;
+			for (int i = 0; i < sizeof(rows) / sizeof(rows[0]); i++)
+			{
+				provider->cell_requests = 0;
+				start = System::get_microseconds();
+				listview.scroll_to_row(rows[i]);
+				listview.set_selected_row(rows[i]);
+				gui.render_windows();
+				ubyte64 time = System::get_microseconds() - start;
+				Console::write_line("Row %1: %2 ms, %3 cells fetched", rows[i], time / 1000.0, provider->cell_requests);
+
+				if (listview.get_selected_row() != rows[i])
+					throw Exception(string_format("Row %1 was not selected", rows[i]));
+				if (visible_cells == 0)
+					visible_cells = provider->cell_requests;
+				else if (provider->cell_requests > visible_cells * 2)
+					throw Exception(string_format("Too many cells fetched at row %1", rows[i]));
+			}
+
+			// Changing a range of rows only fetches the heights of that range
+			provider->height_requests = 0;
+			start = System::get_microseconds();
+			listview.data_changed(1000, 100);
+			Console::write_line("Range update: %1 ms, %2 heights fetched", (System::get_microseconds() - start) / 1000.0, provider->height_requests);
+			if (provider->height_requests != 100)
+				throw Exception(string_format("%1 heights fetched for a range of 100 rows", provider->height_requests));
+
+			provider->row_count = 10;
+			listview.data_changed();
+			if (listview.get_selected_row() != -1)
+				throw Exception("Selection was not cleared when the selected row was removed");
+
+			Console::write_line("All tests passed");
+		}
+		catch (Exception e)
+		{
+			Console::write_line(e.message);
+			console.display_close_message();
+			return -1;
+		}
+
+		return 0;
+	}
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+		SetupDisplay setup_display;
+		SetupGL setup_gl;
+		SetupGUI setup_gui;
+
+		App app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
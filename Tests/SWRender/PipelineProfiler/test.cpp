@@ -0,0 +1,208 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2013 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "API/core.h"
+#include "API/application.h"
+#include "API/SWRender/pixel_command.h"
+#include "SWRender/Canvas/Pipeline/pixel_pipeline_profiler.h"
+using namespace clan;
+
+// Feeds synthetic worker batches to the pixel pipeline profiler, including batches
+// that were running while the counters were reset.
+class TestApp
+{
+public:
+	int main(const std::vector<std::string> &args);
+
+private:
+	void test_batch();
+	void test_batch_across_reset();
+	void test_batch_ended_before_reset();
+
+	void check_sane(const PixelPipelineStatistics &statistics);
+	void fail();
+};
+
+class TestCommand : public PixelCommand
+{
+public:
+	void run(PixelThreadContext *context) { }
+};
+
+class Program
+{
+public:
+	static int main(const std::vector<std::string> &args)
+	{
+		SetupCore setup_core;
+
+		TestApp app;
+		return app.main(args);
+	}
+};
+
+Application app(&Program::main);
+
+int TestApp::main(const std::vector<std::string> &args)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("Directory: SWRender/Canvas/Pipeline");
+		Console::write_line(" Header: pixel_pipeline_profiler.h");
+		Console::write_line("  Class: PixelPipelineProfiler");
+
+		test_batch();
+		test_batch_across_reset();
+		test_batch_ended_before_reset();
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+	catch (Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::test_batch()
+{
+	Console::write_line("   Batch after the reset");
+
+	PixelPipelineProfiler profiler(2);
+	TestCommand command;
+
+	PixelPipelineWorkerBatch batch;
+	batch.wait_start = cl_pipeline_ticks();
+	System::sleep(20);
+	batch.busy_start = cl_pipeline_ticks();
+	batch.add_command(&command, 100);
+	batch.add_command(&command, 200);
+	batch.commands_processed = 2;
+	System::sleep(40);
+	batch.busy_end = cl_pipeline_ticks();
+	profiler.add_worker_batch(1, batch);
+
+	PixelPipelineStatistics statistics = profiler.get_statistics();
+	check_sane(statistics);
+
+	const PixelPipelineWorkerStatistics &worker = statistics.workers[1];
+	if (worker.wakeups != 1 || worker.commands_processed != 2)
+		fail();
+	if (worker.wait_microseconds < 10000 || worker.busy_microseconds < 30000)
+		fail();
+	if (statistics.workers[0].wakeups != 0 || statistics.workers[0].busy_microseconds != 0)
+		fail();
+	if (statistics.commands.size() != 1 || statistics.commands[0].count != 2)
+		fail();
+
+	// The batch hands its command counters over to the profiler
+	if (!batch.commands.empty() || batch.commands_processed != 0)
+		fail();
+}
+
+void TestApp::test_batch_across_reset()
+{
+	Console::write_line("   Batch running while the counters are reset");
+
+	PixelPipelineProfiler profiler(1);
+	TestCommand command;
+
+	PixelPipelineWorkerBatch batch;
+	batch.wait_start = cl_pipeline_ticks();
+	System::sleep(10);
+	batch.busy_start = cl_pipeline_ticks();
+	batch.add_command(&command, 100);
+	batch.commands_processed = 1;
+	System::sleep(10);
+	profiler.reset();
+	System::sleep(20);
+	batch.busy_end = cl_pipeline_ticks();
+	profiler.add_worker_batch(0, batch);
+
+	PixelPipelineStatistics statistics = profiler.get_statistics();
+	check_sane(statistics);
+
+	// Only the time after the reset is counted, and the commands sampled before it are dropped
+	const PixelPipelineWorkerStatistics &worker = statistics.workers[0];
+	if (worker.wait_microseconds != 0 || worker.busy_microseconds < 10000)
+		fail();
+	if (worker.commands_processed != 0 || !statistics.commands.empty())
+		fail();
+}
+
+void TestApp::test_batch_ended_before_reset()
+{
+	Console::write_line("   Batch ending before the reset it is reported after");
+
+	PixelPipelineProfiler profiler(1);
+	TestCommand command;
+
+	PixelPipelineWorkerBatch batch;
+	batch.wait_start = cl_pipeline_ticks();
+	batch.busy_start = cl_pipeline_ticks();
+	batch.add_command(&command, 100);
+	batch.commands_processed = 1;
+	batch.busy_end = cl_pipeline_ticks();
+	System::sleep(10);
+	profiler.reset();
+	System::sleep(10);
+	profiler.add_worker_batch(0, batch);
+
+	PixelPipelineStatistics statistics = profiler.get_statistics();
+	check_sane(statistics);
+
+	const PixelPipelineWorkerStatistics &worker = statistics.workers[0];
+	if (worker.wait_microseconds != 0 || worker.busy_microseconds != 0)
+		fail();
+	if (worker.wakeups != 0 || worker.commands_processed != 0 || !statistics.commands.empty())
+		fail();
+}
+
+void TestApp::check_sane(const PixelPipelineStatistics &statistics)
+{
+	// A worker can never be busy or waiting for longer than the time since the reset
+	for (size_t i = 0; i < statistics.workers.size(); i++)
+	{
+		if (statistics.workers[i].busy_microseconds + statistics.workers[i].wait_microseconds > statistics.elapsed_microseconds + 1000)
+			fail();
+	}
+}
+
+void TestApp::fail()
+{
+	throw Exception("Failed Test");
+}
@@ -1,10 +0,0 @@
-
-#pragma once
-
-#include "glsl_ast_translation_unit.h"
-#include "glsl_ast_type.h"
-#include "glsl_ast_variable.h"
-#include "glsl_ast_function.h"
-#include "glsl_ast_declaration.h"
-#include "glsl_ast_statement.h"
-#include "glsl_ast_expression.h"
@@ -1,16 +0,0 @@
-
-#pragma once
-
-#include <vector>
-
-class GlslAstNode;
-
-class GlslAstGarbageCollector
-{
-public:
-	~GlslAstGarbageCollector();
-
-private:
-	std::vector<GlslAstNode *> gc_nodes;
-	friend class GlslAstNode;
-};
@@ -2,4 +2,7 @@
 #pragma once
 
 #include <ClanLib/core.h>
+#include <ClanLib/display.h>
 #include "llvm_include.h"
+
+using namespace clan;